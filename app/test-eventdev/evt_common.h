@@ -66,7 +66,7 @@ evt_has_all_types_queue(uint8_t dev_id)
 }
 
 static inline int
-evt_service_setup(uint32_t service_id)
+evt_service_map_one(uint32_t service_id)
 {
 	int32_t core_cnt;
 	unsigned int lcore = 0;
@@ -99,4 +99,30 @@ evt_service_setup(uint32_t service_id)
 	return 0;
 }
 
+/*
+ * Map a service and its sibling instances, registered as "<name>_1",
+ * "<name>_2", ... by devices that split their work over several services.
+ */
+static inline int
+evt_service_setup(uint32_t service_id)
+{
+	char name[RTE_SERVICE_NAME_MAX];
+	uint32_t sibling_id;
+	int i;
+
+	if (evt_service_map_one(service_id))
+		return -ENOENT;
+
+	for (i = 1; ; i++) {
+		snprintf(name, sizeof(name), "%s_%d",
+				rte_service_get_name(service_id), i);
+		if (rte_service_get_by_name(name, &sibling_id))
+			break;
+		if (evt_service_map_one(sibling_id))
+			return -ENOENT;
+	}
+
+	return 0;
+}
+
 #endif /*  _EVT_COMMON_*/
@@ -33,6 +33,7 @@ evt_options_default(struct evt_options *opt)
 	opt->max_tmo_nsec = 1E5;  /* 100000ns ~100us */
 	opt->expiry_nsec = 1E4;   /* 10000ns ~10us */
 	opt->prod_type = EVT_PROD_TYPE_SYNT;
+	opt->crypto_adptr_nb_svc = 1;
 }
 
 typedef int (*option_parser_t)(struct evt_options *opt,
@@ -107,6 +108,14 @@ evt_parse_timer_prod_type_burst(struct evt_options *opt,
 	return 0;
 }
 
+static int
+evt_parse_crypto_prod_type(struct evt_options *opt,
+		const char *arg __rte_unused)
+{
+	opt->prod_type = EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR;
+	return 0;
+}
+
 static int
 evt_parse_test_name(struct evt_options *opt, const char *arg)
 {
@@ -190,6 +199,16 @@ evt_parse_nb_timer_adptrs(struct evt_options *opt, const char *arg)
 	return ret;
 }
 
+static int
+evt_parse_crypto_adptr_nb_svc(struct evt_options *opt, const char *arg)
+{
+	int ret;
+
+	ret = parser_read_uint8(&(opt->crypto_adptr_nb_svc), arg);
+
+	return ret;
+}
+
 static int
 evt_parse_pool_sz(struct evt_options *opt, const char *arg)
 {
@@ -251,6 +270,9 @@ usage(char *program)
 		"\t--timer_tick_nsec  : timer tick interval in ns.\n"
 		"\t--max_tmo_nsec     : max timeout interval in ns.\n"
 		"\t--expiry_nsec        : event timer expiry ns.\n"
+		"\t--prod_type_cryptodev : use crypto device as producer.\n"
+		"\t--crypto_adptr_nb_svc : number of crypto adapter service\n"
+		"\t                        functions to use.\n"
 		);
 	printf("available tests:\n");
 	evt_test_dump_names();
@@ -319,6 +341,8 @@ static struct option lgopts[] = {
 	{ EVT_TIMER_TICK_NSEC,     1, 0, 0 },
 	{ EVT_MAX_TMO_NSEC,        1, 0, 0 },
 	{ EVT_EXPIRY_NSEC,         1, 0, 0 },
+	{ EVT_PROD_CRYPTODEV,      0, 0, 0 },
+	{ EVT_CRYPTO_ADPTR_NB_SVC, 1, 0, 0 },
 	{ EVT_HELP,                0, 0, 0 },
 	{ NULL,                    0, 0, 0 }
 };
@@ -350,6 +374,8 @@ evt_opts_parse_long(int opt_idx, struct evt_options *opt)
 		{ EVT_TIMER_TICK_NSEC, evt_parse_timer_tick_nsec},
 		{ EVT_MAX_TMO_NSEC, evt_parse_max_tmo_nsec},
 		{ EVT_EXPIRY_NSEC, evt_parse_expiry_nsec},
+		{ EVT_PROD_CRYPTODEV, evt_parse_crypto_prod_type},
+		{ EVT_CRYPTO_ADPTR_NB_SVC, evt_parse_crypto_adptr_nb_svc},
 	};
 
 	for (i = 0; i < RTE_DIM(parsermap); i++) {
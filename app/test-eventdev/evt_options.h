@@ -9,6 +9,7 @@
 #include <stdbool.h>
 
 #include <rte_common.h>
+#include <rte_cryptodev.h>
 #include <rte_ethdev.h>
 #include <rte_eventdev.h>
 #include <rte_lcore.h>
@@ -39,6 +40,8 @@
 #define EVT_TIMER_TICK_NSEC      ("timer_tick_nsec")
 #define EVT_MAX_TMO_NSEC         ("max_tmo_nsec")
 #define EVT_EXPIRY_NSEC          ("expiry_nsec")
+#define EVT_PROD_CRYPTODEV       ("prod_type_cryptodev")
+#define EVT_CRYPTO_ADPTR_NB_SVC  ("crypto_adptr_nb_svc")
 #define EVT_HELP                 ("help")
 
 enum evt_prod_type {
@@ -46,6 +49,7 @@ enum evt_prod_type {
 	EVT_PROD_TYPE_SYNT,          /* Producer type Synthetic i.e. CPU. */
 	EVT_PROD_TYPE_ETH_RX_ADPTR,  /* Producer type Eth Rx Adapter. */
 	EVT_PROD_TYPE_EVENT_TIMER_ADPTR,  /* Producer type Timer Adapter. */
+	EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR, /* Producer type Crypto Adapter. */
 	EVT_PROD_TYPE_MAX,
 };
 
@@ -74,6 +78,7 @@ struct evt_options {
 	enum evt_prod_type prod_type;
 	uint8_t timdev_use_burst;
 	uint8_t timdev_cnt;
+	uint8_t crypto_adptr_nb_svc;
 };
 
 void evt_options_default(struct evt_options *opt);
@@ -298,6 +303,13 @@ evt_dump_producer_type(struct evt_options *opt)
 			evt_dump("timer_tick_nsec", "%"PRIu64"",
 					opt->timer_tick_nsec);
 		break;
+	case EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR:
+		snprintf(name, EVT_PROD_MAX_NAME_LEN,
+				"Event crypto adapter producers");
+		evt_dump("nb_cryptodev", "%d", rte_cryptodev_count());
+		evt_dump("crypto_adptr_nb_svc", "%d",
+				opt->crypto_adptr_nb_svc);
+		break;
 	}
 	evt_dump("prod_type", "%s", name);
 }
@@ -47,6 +47,10 @@ perf_atq_worker(void *arg, const int enable_fwd_latency)
 			rte_pause();
 			continue;
 		}
+		if (prod_crypto_type &&
+				ev.event_type == RTE_EVENT_TYPE_CRYPTODEV)
+			perf_crypto_ev_to_mbuf(&ev);
+
 
 		if (enable_fwd_latency && !prod_timer_type)
 		/* first stage in pipeline, mark ts to compute fwd latency */
@@ -87,6 +91,9 @@ perf_atq_worker_burst(void *arg, const int enable_fwd_latency)
 		}
 
 		for (i = 0; i < nb_rx; i++) {
+			if (prod_crypto_type &&
+				ev[i].event_type == RTE_EVENT_TYPE_CRYPTODEV)
+				perf_crypto_ev_to_mbuf(&ev[i]);
 			if (enable_fwd_latency && !prod_timer_type) {
 				rte_prefetch0(ev[i+1].event_ptr);
 				/* first stage in pipeline.
@@ -161,7 +168,8 @@ perf_atq_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 
 	nb_ports = evt_nr_active_lcores(opt->wlcores);
 	nb_ports += (opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR ||
-			opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR) ? 0 :
+			opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR ||
+			opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) ? 0 :
 		evt_nr_active_lcores(opt->plcores);
 
 	nb_queues = atq_nb_event_queues(opt);
@@ -275,12 +283,14 @@ static const struct evt_test_ops perf_atq =  {
 	.opt_dump           = perf_atq_opt_dump,
 	.test_setup         = perf_test_setup,
 	.ethdev_setup       = perf_ethdev_setup,
+	.cryptodev_setup    = perf_cryptodev_setup,
 	.mempool_setup      = perf_mempool_setup,
 	.eventdev_setup     = perf_atq_eventdev_setup,
 	.launch_lcores      = perf_atq_launch_lcores,
 	.eventdev_destroy   = perf_eventdev_destroy,
 	.mempool_destroy    = perf_mempool_destroy,
 	.ethdev_destroy     = perf_ethdev_destroy,
+	.cryptodev_destroy  = perf_cryptodev_destroy,
 	.test_result        = perf_test_result,
 	.test_destroy       = perf_test_destroy,
 };
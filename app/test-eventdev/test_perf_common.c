@@ -194,6 +194,66 @@ perf_event_timer_producer_burst(void *arg)
 	return 0;
 }
 
+static inline int
+perf_event_crypto_producer(void *arg)
+{
+	int i;
+	struct prod_data *p  = arg;
+	struct test_perf *t = p->t;
+	struct evt_options *opt = t->opt;
+	const uint8_t cdev_id = p->cdev_id;
+	const uint16_t qp_id = p->cdev_qp_id;
+	const uint64_t nb_pkts = t->nb_pkts;
+	struct rte_mempool *pool = t->pool;
+	struct rte_cryptodev_sym_session *sess = p->crypto_sess;
+	struct rte_crypto_op *ops[BURST_SIZE];
+	struct rte_mbuf *m[BURST_SIZE];
+	struct rte_crypto_sym_op *sym_op;
+	uint64_t count = 0;
+	uint16_t nb_enq;
+
+	if (opt->verbose_level > 1)
+		printf("%s(): lcore %d cdev_id %d qp %d queue %d\n", __func__,
+				rte_lcore_id(), cdev_id, qp_id, p->queue_id);
+
+	while (count < nb_pkts && t->done == false) {
+		if (rte_pktmbuf_alloc_bulk(pool, m, BURST_SIZE) < 0)
+			continue;
+		if (rte_crypto_op_bulk_alloc(t->ca_op_pool,
+				RTE_CRYPTO_OP_TYPE_SYMMETRIC, ops,
+				BURST_SIZE) == 0) {
+			for (i = 0; i < BURST_SIZE; i++)
+				rte_pktmbuf_free(m[i]);
+			continue;
+		}
+
+		for (i = 0; i < BURST_SIZE; i++) {
+			rte_pktmbuf_append(m[i], PERF_CRYPTO_PKT_LEN);
+			sym_op = ops[i]->sym;
+			sym_op->m_src = m[i];
+			sym_op->cipher.data.offset = 0;
+			sym_op->cipher.data.length = PERF_CRYPTO_PKT_LEN;
+			rte_crypto_op_attach_sym_session(ops[i], sess);
+		}
+
+		nb_enq = 0;
+		while (nb_enq < BURST_SIZE) {
+			nb_enq += rte_cryptodev_enqueue_burst(cdev_id, qp_id,
+					ops + nb_enq, BURST_SIZE - nb_enq);
+			if (t->done)
+				break;
+			rte_pause();
+		}
+		for (i = nb_enq; i < BURST_SIZE; i++) {
+			rte_pktmbuf_free(m[i]);
+			rte_crypto_op_free(ops[i]);
+		}
+		count += nb_enq;
+	}
+
+	return 0;
+}
+
 static int
 perf_producer_wrapper(void *arg)
 {
@@ -208,6 +268,8 @@ perf_producer_wrapper(void *arg)
 	else if (t->opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR &&
 			t->opt->timdev_use_burst)
 		return perf_event_timer_producer_burst(arg);
+	else if (t->opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
+		return perf_event_crypto_producer(arg);
 	return 0;
 }
 
@@ -318,7 +380,9 @@ perf_launch_lcores(struct evt_test *test, struct evt_options *opt,
 				t->result = EVT_TEST_SUCCESS;
 				if (opt->prod_type == EVT_PROD_TYPE_SYNT ||
 					opt->prod_type ==
-					EVT_PROD_TYPE_EVENT_TIMER_ADPTR) {
+					EVT_PROD_TYPE_EVENT_TIMER_ADPTR ||
+					opt->prod_type ==
+					EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) {
 					t->done = true;
 					rte_smp_wmb();
 					break;
@@ -471,6 +535,125 @@ perf_event_timer_adapter_setup(struct test_perf *t)
 	return 0;
 }
 
+static inline uint8_t
+perf_nb_cryptodevs(struct evt_options *opt)
+{
+	return RTE_MIN(rte_cryptodev_count(),
+			evt_nr_active_lcores(opt->plcores));
+}
+
+static int
+perf_event_crypto_adapter_setup(struct test_perf *t,
+		struct rte_event_port_conf port_conf)
+{
+	struct evt_options *opt = t->opt;
+	const uint8_t nb_cdevs = perf_nb_cryptodevs(opt);
+	union rte_event_crypto_metadata m_data;
+	struct rte_crypto_sym_xform cipher_xform;
+	struct rte_event ev;
+	uint8_t cdev_id;
+	uint16_t port;
+	uint32_t cap;
+	int ret;
+
+	ret = rte_event_crypto_adapter_create(PERF_CRYPTO_ADPTR_ID,
+			opt->dev_id, &port_conf,
+			RTE_EVENT_CRYPTO_ADAPTER_OP_NEW);
+	if (ret) {
+		evt_err("failed to create crypto adapter");
+		return ret;
+	}
+
+	ret = rte_event_crypto_adapter_nb_services_set(PERF_CRYPTO_ADPTR_ID,
+			opt->crypto_adptr_nb_svc);
+	if (ret) {
+		evt_err("failed to set %d crypto adapter services",
+				opt->crypto_adptr_nb_svc);
+		return ret;
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.sched_type = opt->sched_type_list[0];
+	cap = 0;
+	for (cdev_id = 0; cdev_id < nb_cdevs; cdev_id++) {
+		bool ev_bind;
+
+		ret = rte_event_crypto_adapter_caps_get(opt->dev_id, cdev_id,
+				&cap);
+		if (ret) {
+			evt_err("failed to get crypto adapter[%d] caps",
+					cdev_id);
+			return ret;
+		}
+
+		ev_bind = !!(cap &
+			RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_QP_EV_BIND);
+		ret = rte_event_crypto_adapter_queue_pair_add(
+				PERF_CRYPTO_ADPTR_ID, cdev_id, -1,
+				ev_bind ? &ev : NULL);
+		if (ret) {
+			evt_err("failed to add cdev %d to crypto adapter",
+					cdev_id);
+			return ret;
+		}
+	}
+
+	if (!(cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_NEW)) {
+		uint32_t service_id;
+
+		rte_event_crypto_adapter_service_id_get(PERF_CRYPTO_ADPTR_ID,
+				&service_id);
+		ret = evt_service_setup(service_id);
+		if (ret) {
+			evt_err("Failed to setup service core"
+					" for crypto adapter\n");
+			return ret;
+		}
+	}
+
+	memset(&cipher_xform, 0, sizeof(cipher_xform));
+	cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	cipher_xform.cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+	cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+
+	/* One session per producer, its completions form one flow */
+	for (port = evt_nr_active_lcores(opt->wlcores);
+			port < perf_nb_event_ports(opt); port++) {
+		struct prod_data *p = &t->prod[port];
+
+		p->crypto_sess = rte_cryptodev_sym_session_create(
+				t->ca_sess_pool);
+		if (p->crypto_sess == NULL) {
+			evt_err("failed to create crypto session");
+			return -ENOMEM;
+		}
+
+		memset(&m_data, 0, sizeof(m_data));
+		m_data.response_info.queue_id = p->queue_id;
+		m_data.response_info.sched_type = opt->sched_type_list[0];
+		m_data.response_info.priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+		m_data.response_info.flow_id = port;
+		rte_cryptodev_sym_session_set_user_data(p->crypto_sess,
+				&m_data, sizeof(m_data));
+
+		ret = rte_cryptodev_sym_session_init(p->cdev_id,
+				p->crypto_sess, &cipher_xform,
+				t->ca_sess_pool);
+		if (ret) {
+			evt_err("failed to init crypto session");
+			return ret;
+		}
+	}
+
+	ret = rte_event_crypto_adapter_start(PERF_CRYPTO_ADPTR_ID);
+	if (ret) {
+		evt_err("failed to start crypto adapter");
+		return ret;
+	}
+
+	return 0;
+}
+
 int
 perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
 				uint8_t stride, uint8_t nb_queues,
@@ -526,6 +709,23 @@ perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
 		ret = perf_event_timer_adapter_setup(t);
 		if (ret)
 			return ret;
+	} else if (opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) {
+		const uint8_t nb_cdevs = perf_nb_cryptodevs(opt);
+
+		prod = 0;
+		for ( ; port < perf_nb_event_ports(opt); port++) {
+			struct prod_data *p = &t->prod[port];
+
+			p->queue_id = prod * stride;
+			p->cdev_id = prod % nb_cdevs;
+			p->cdev_qp_id = prod / nb_cdevs;
+			p->t = t;
+			prod++;
+		}
+
+		ret = perf_event_crypto_adapter_setup(t, *port_conf);
+		if (ret)
+			return ret;
 	} else {
 		prod = 0;
 		for ( ; port < perf_nb_event_ports(opt); port++) {
@@ -557,7 +757,8 @@ perf_opt_check(struct evt_options *opt, uint64_t nb_queues)
 	/* N producer + N worker + 1 master when producer cores are used
 	 * Else N worker + 1 master when Rx adapter is used
 	 */
-	lcores = opt->prod_type == EVT_PROD_TYPE_SYNT ? 3 : 2;
+	lcores = opt->prod_type == EVT_PROD_TYPE_SYNT ||
+		opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR ? 3 : 2;
 
 	if (rte_lcore_count() < lcores) {
 		evt_err("test need minimum %d lcores", lcores);
@@ -582,7 +783,8 @@ perf_opt_check(struct evt_options *opt, uint64_t nb_queues)
 		return -1;
 	}
 
-	if (opt->prod_type == EVT_PROD_TYPE_SYNT) {
+	if (opt->prod_type == EVT_PROD_TYPE_SYNT ||
+			opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR) {
 		/* Validate producer lcores */
 		if (evt_lcores_has_overlap(opt->plcores,
 					rte_get_master_lcore())) {
@@ -622,6 +824,17 @@ perf_opt_check(struct evt_options *opt, uint64_t nb_queues)
 		opt->fwd_latency = 0;
 	}
 
+	if (opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR &&
+			opt->fwd_latency) {
+		evt_info("fwd_latency is not valid with cryptodev, disabling");
+		opt->fwd_latency = 0;
+	}
+
+	if (opt->crypto_adptr_nb_svc == 0) {
+		evt_err("minimum one crypto adapter service is required");
+		return -1;
+	}
+
 	if (opt->fwd_latency && !opt->q_priority) {
 		evt_info("enabled queue priority for latency measurement");
 		opt->q_priority = 1;
@@ -657,6 +870,8 @@ perf_eventdev_destroy(struct evt_test *test, struct evt_options *opt)
 		for (i = 0; i < opt->nb_timer_adptrs; i++)
 			rte_event_timer_adapter_stop(t->timer_adptr[i]);
 	}
+	if (opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
+		rte_event_crypto_adapter_stop(PERF_CRYPTO_ADPTR_ID);
 	rte_event_dev_stop(opt->dev_id);
 	rte_event_dev_close(opt->dev_id);
 }
@@ -690,7 +905,8 @@ perf_ethdev_setup(struct evt_test *test, struct evt_options *opt)
 	};
 
 	if (opt->prod_type == EVT_PROD_TYPE_SYNT ||
-			opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR)
+			opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR ||
+			opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
 		return 0;
 
 	if (!rte_eth_dev_count_avail()) {
@@ -753,6 +969,124 @@ void perf_ethdev_destroy(struct evt_test *test, struct evt_options *opt)
 	}
 }
 
+int
+perf_cryptodev_setup(struct evt_test *test, struct evt_options *opt)
+{
+	struct test_perf *t = evt_test_priv(test);
+	struct rte_cryptodev_qp_conf qp_conf;
+	struct rte_cryptodev_config conf;
+	struct rte_cryptodev_info info;
+	unsigned int session_size;
+	uint8_t nb_cdevs, cdev_id;
+	uint16_t nb_qps, qp_id;
+	int nb_prod;
+
+	if (opt->prod_type != EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
+		return 0;
+
+	nb_cdevs = perf_nb_cryptodevs(opt);
+	if (!nb_cdevs) {
+		evt_err("No crypto devices found.");
+		return -ENODEV;
+	}
+
+	nb_prod = evt_nr_active_lcores(opt->plcores);
+	t->ca_op_pool = rte_crypto_op_pool_create("perf_ca_op_pool",
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, opt->pool_sz, 512, 0,
+			opt->socket_id);
+	if (t->ca_op_pool == NULL) {
+		evt_err("failed to create crypto op pool");
+		return -ENOMEM;
+	}
+
+	/* Session header with adapter metadata and private data share a pool */
+	session_size = rte_cryptodev_sym_get_header_session_size() +
+		sizeof(union rte_event_crypto_metadata);
+	for (cdev_id = 0; cdev_id < nb_cdevs; cdev_id++)
+		session_size = RTE_MAX(session_size,
+			rte_cryptodev_sym_get_private_session_size(cdev_id));
+
+	t->ca_sess_pool = rte_mempool_create("perf_ca_sess_pool",
+			nb_prod * 2, session_size, 0, 0, NULL, NULL, NULL,
+			NULL, opt->socket_id, 0);
+	if (t->ca_sess_pool == NULL) {
+		evt_err("failed to create crypto session pool");
+		goto err;
+	}
+
+	nb_qps = (nb_prod + nb_cdevs - 1) / nb_cdevs;
+	for (cdev_id = 0; cdev_id < nb_cdevs; cdev_id++) {
+		rte_cryptodev_info_get(cdev_id, &info);
+		if (nb_qps > info.max_nb_queue_pairs) {
+			evt_err("cdev %d supports %d qps, need %d", cdev_id,
+					info.max_nb_queue_pairs, nb_qps);
+			goto err;
+		}
+
+		memset(&conf, 0, sizeof(conf));
+		conf.nb_queue_pairs = nb_qps;
+		conf.socket_id = SOCKET_ID_ANY;
+		if (rte_cryptodev_configure(cdev_id, &conf)) {
+			evt_err("Failed to configure cryptodev %d", cdev_id);
+			goto err;
+		}
+
+		qp_conf.nb_descriptors = NB_CRYPTODEV_DESCRIPTORS;
+		for (qp_id = 0; qp_id < nb_qps; qp_id++) {
+			if (rte_cryptodev_queue_pair_setup(cdev_id, qp_id,
+					&qp_conf,
+					rte_cryptodev_socket_id(cdev_id),
+					t->ca_sess_pool)) {
+				evt_err("Failed to setup cdev %d qp %d",
+						cdev_id, qp_id);
+				goto err;
+			}
+		}
+
+		if (rte_cryptodev_start(cdev_id)) {
+			evt_err("Failed to start cryptodev %d", cdev_id);
+			goto err;
+		}
+	}
+
+	return 0;
+err:
+	rte_mempool_free(t->ca_sess_pool);
+	rte_mempool_free(t->ca_op_pool);
+	return -EINVAL;
+}
+
+void
+perf_cryptodev_destroy(struct evt_test *test, struct evt_options *opt)
+{
+	struct test_perf *t = evt_test_priv(test);
+	uint8_t cdev_id;
+	uint16_t port;
+
+	if (opt->prod_type != EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR)
+		return;
+
+	for (port = evt_nr_active_lcores(opt->wlcores);
+			port < perf_nb_event_ports(opt); port++) {
+		struct prod_data *p = &t->prod[port];
+
+		if (p->crypto_sess == NULL)
+			continue;
+		rte_cryptodev_sym_session_clear(p->cdev_id, p->crypto_sess);
+		rte_cryptodev_sym_session_free(p->crypto_sess);
+	}
+
+	for (cdev_id = 0; cdev_id < perf_nb_cryptodevs(opt); cdev_id++) {
+		rte_event_crypto_adapter_queue_pair_del(PERF_CRYPTO_ADPTR_ID,
+				cdev_id, -1);
+		rte_cryptodev_stop(cdev_id);
+	}
+	rte_event_crypto_adapter_free(PERF_CRYPTO_ADPTR_ID);
+
+	rte_mempool_free(t->ca_sess_pool);
+	rte_mempool_free(t->ca_op_pool);
+}
+
 int
 perf_mempool_setup(struct evt_test *test, struct evt_options *opt)
 {
@@ -9,9 +9,12 @@
 #include <stdbool.h>
 #include <unistd.h>
 
+#include <rte_crypto.h>
+#include <rte_cryptodev.h>
 #include <rte_cycles.h>
 #include <rte_ethdev.h>
 #include <rte_eventdev.h>
+#include <rte_event_crypto_adapter.h>
 #include <rte_event_eth_rx_adapter.h>
 #include <rte_event_timer_adapter.h>
 #include <rte_lcore.h>
@@ -37,6 +40,9 @@ struct prod_data {
 	uint8_t dev_id;
 	uint8_t port_id;
 	uint8_t queue_id;
+	uint8_t cdev_id;
+	uint16_t cdev_qp_id;
+	struct rte_cryptodev_sym_session *crypto_sess;
 	struct test_perf *t;
 } __rte_cache_aligned;
 
@@ -58,6 +64,8 @@ struct test_perf {
 	uint8_t sched_type_list[EVT_MAX_STAGES] __rte_cache_aligned;
 	struct rte_event_timer_adapter *timer_adptr[
 		RTE_EVENT_TIMER_ADAPTER_NUM_MAX] __rte_cache_aligned;
+	struct rte_mempool *ca_op_pool;
+	struct rte_mempool *ca_sess_pool;
 } __rte_cache_aligned;
 
 struct perf_elt {
@@ -71,6 +79,9 @@ struct perf_elt {
 } __rte_cache_aligned;
 
 #define BURST_SIZE 16
+#define PERF_CRYPTO_ADPTR_ID 0
+#define PERF_CRYPTO_PKT_LEN 64
+#define NB_CRYPTODEV_DESCRIPTORS 1024
 
 #define PERF_WORKER_INIT\
 	struct worker_data *w  = arg;\
@@ -80,6 +91,8 @@ struct perf_elt {
 	const uint8_t port = w->port_id;\
 	const uint8_t prod_timer_type = \
 		opt->prod_type == EVT_PROD_TYPE_EVENT_TIMER_ADPTR;\
+	const uint8_t prod_crypto_type = \
+		opt->prod_type == EVT_PROD_TYPE_EVENT_CRYPTO_ADPTR;\
 	uint8_t *const sched_type_list = &t->sched_type_list[0];\
 	struct rte_mempool *const pool = t->pool;\
 	const uint8_t nb_stages = t->opt->nb_stages;\
@@ -91,6 +104,16 @@ struct perf_elt {
 		printf("%s(): lcore %d dev_id %d port=%d\n", __func__,\
 				rte_lcore_id(), dev, port)
 
+/* Crypto completions carry the op, hand the mbuf on to the pipeline. */
+static inline __attribute__((always_inline)) void
+perf_crypto_ev_to_mbuf(struct rte_event *const ev)
+{
+	struct rte_crypto_op *op = ev->event_ptr;
+
+	ev->event_ptr = op->sym->m_src;
+	rte_crypto_op_free(op);
+}
+
 static inline __attribute__((always_inline)) int
 perf_process_last_stage(struct rte_mempool *const pool,
 		struct rte_event *const ev, struct worker_data *const w,
@@ -143,6 +166,7 @@ int perf_test_result(struct evt_test *test, struct evt_options *opt);
 int perf_opt_check(struct evt_options *opt, uint64_t nb_queues);
 int perf_test_setup(struct evt_test *test, struct evt_options *opt);
 int perf_ethdev_setup(struct evt_test *test, struct evt_options *opt);
+int perf_cryptodev_setup(struct evt_test *test, struct evt_options *opt);
 int perf_mempool_setup(struct evt_test *test, struct evt_options *opt);
 int perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
 				uint8_t stride, uint8_t nb_queues,
@@ -154,6 +178,7 @@ void perf_opt_dump(struct evt_options *opt, uint8_t nb_queues);
 void perf_test_destroy(struct evt_test *test, struct evt_options *opt);
 void perf_eventdev_destroy(struct evt_test *test, struct evt_options *opt);
 void perf_ethdev_destroy(struct evt_test *test, struct evt_options *opt);
+void perf_cryptodev_destroy(struct evt_test *test, struct evt_options *opt);
 void perf_mempool_destroy(struct evt_test *test, struct evt_options *opt);
 
 #endif /* _TEST_PERF_COMMON_ */
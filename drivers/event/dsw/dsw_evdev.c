@@ -7,6 +7,7 @@
 #include <rte_cycles.h>
 #include <rte_eventdev_pmd.h>
 #include <rte_eventdev_pmd_vdev.h>
+#include <rte_malloc.h>
 #include <rte_random.h>
 
 #include "dsw_evdev.h"
@@ -221,16 +222,44 @@ dsw_info_get(struct rte_eventdev *dev __rte_unused,
 	};
 }
 
+static void
+dsw_free_flow_maps(struct dsw_evdev *dsw)
+{
+	uint8_t queue_id;
+
+	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++) {
+		rte_free(dsw->queues[queue_id].flow_to_port_map);
+		dsw->queues[queue_id].flow_to_port_map = NULL;
+	}
+}
+
 static int
 dsw_configure(const struct rte_eventdev *dev)
 {
 	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
 	const struct rte_event_dev_config *conf = &dev->data->dev_conf;
 	int32_t min_max_in_flight;
+	uint8_t queue_id;
+
+	dsw_free_flow_maps(dsw);
 
 	dsw->num_ports = conf->nb_event_ports;
 	dsw->num_queues = conf->nb_event_queues;
 
+	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++) {
+		struct dsw_queue *queue = &dsw->queues[queue_id];
+
+		queue->flow_to_port_map =
+			rte_zmalloc_socket(NULL, DSW_MAX_FLOWS,
+					   RTE_CACHE_LINE_SIZE,
+					   dev->data->socket_id);
+		if (queue->flow_to_port_map == NULL) {
+			dsw_free_flow_maps(dsw);
+			dsw->num_queues = 0;
+			return -ENOMEM;
+		}
+	}
+
 	/* Avoid a situation where consumer ports are holding all the
 	 * credits, without making use of them.
 	 */
@@ -248,7 +277,14 @@ initial_flow_to_port_assignment(struct dsw_evdev *dsw)
 	uint8_t queue_id;
 	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++) {
 		struct dsw_queue *queue = &dsw->queues[queue_id];
-		uint16_t flow_hash;
+		uint32_t flow_hash;
+
+		/* The map is only consulted for queues with more
+		 * than one serving port.
+		 */
+		if (queue->num_serving_ports < 2)
+			continue;
+
 		for (flow_hash = 0; flow_hash < DSW_MAX_FLOWS; flow_hash++) {
 			uint8_t port_idx =
 				rte_rand() % queue->num_serving_ports;
@@ -359,6 +395,8 @@ dsw_close(struct rte_eventdev *dev)
 {
 	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
 
+	dsw_free_flow_maps(dsw);
+
 	dsw->num_ports = 0;
 	dsw->num_queues = 0;
 
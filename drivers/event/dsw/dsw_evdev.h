@@ -16,12 +16,16 @@
 #define DSW_MAX_PORT_ENQUEUE_DEPTH (128)
 #define DSW_MAX_PORT_OUT_BUFFER (32)
 
-#define DSW_MAX_QUEUES (16)
+#define DSW_MAX_QUEUES (64)
 
 #define DSW_MAX_EVENTS (16384)
 
-/* Code changes are required to allow more flows than 32k. */
-#define DSW_MAX_FLOWS_BITS (15)
+/* The flow-to-port maps are allocated per configured queue, at one
+ * byte per flow. The flow hash must fit a control message, and the
+ * queue id and flow hash together must fit in an int (see
+ * DSW_QF_TO_INT()).
+ */
+#define DSW_MAX_FLOWS_BITS (20)
 #define DSW_MAX_FLOWS (1<<(DSW_MAX_FLOWS_BITS))
 #define DSW_MAX_FLOWS_MASK (DSW_MAX_FLOWS-1)
 
@@ -85,13 +89,26 @@
 
 #define DSW_MAX_EVENTS_RECORDED (128)
 
+/* The maximum number of flows moved away from a port in a single
+ * migration. Moving several flows at once allows an overloaded port
+ * to shed enough load within a single migration interval, rather
+ * than one flow per interval, which is important in the face of
+ * elephant flows or flow hash collisions.
+ */
+#define DSW_MAX_FLOWS_PER_MIGRATION (8)
+
 /* Only one outstanding migration per port is allowed */
-#define DSW_MAX_PAUSED_FLOWS (DSW_MAX_PORTS)
+#define DSW_MAX_PAUSED_FLOWS (DSW_MAX_PORTS*DSW_MAX_FLOWS_PER_MIGRATION)
+
+/* A control message occupies this many slots on the control ring. */
+#define DSW_CTL_MSG_SLOTS						\
+	((sizeof(struct dsw_ctl_msg) + sizeof(void *) - 1) / sizeof(void *))
 
 /* Enough room for paus request/confirm and unpaus request/confirm for
- * all possible senders.
+ * all possible senders, for all flows of a migration.
  */
-#define DSW_CTL_IN_RING_SIZE ((DSW_MAX_PORTS-1)*4)
+#define DSW_CTL_IN_RING_SIZE						\
+	((DSW_MAX_PORTS-1)*4*DSW_MAX_FLOWS_PER_MIGRATION*DSW_CTL_MSG_SLOTS)
 
 /* With DSW_SORT_DEQUEUED enabled, the scheduler will, at the point of
  * dequeue(), arrange events so that events with the same flow id on
@@ -106,7 +123,7 @@
 
 struct dsw_queue_flow {
 	uint8_t queue_id;
-	uint16_t flow_hash;
+	uint32_t flow_hash;
 };
 
 enum dsw_migration_state {
@@ -157,11 +174,16 @@ struct dsw_port {
 
 	uint64_t migration_start;
 	uint64_t migrations;
+	uint64_t migrated_flows;
 	uint64_t migration_latency;
+	uint64_t migration_latency_max;
+	/* Cycles spent selecting and moving flows. */
+	uint64_t migration_cycles;
 
-	uint8_t migration_target_port_id;
-	struct dsw_queue_flow migration_target_qf;
-	uint8_t cfm_cnt;
+	uint8_t migration_targets_len;
+	uint8_t migration_target_port_ids[DSW_MAX_FLOWS_PER_MIGRATION];
+	struct dsw_queue_flow migration_target_qfs[DSW_MAX_FLOWS_PER_MIGRATION];
+	uint16_t cfm_cnt;
 
 	uint16_t paused_flows_len;
 	struct dsw_queue_flow paused_flows[DSW_MAX_PAUSED_FLOWS];
@@ -207,7 +229,8 @@ struct dsw_queue {
 	uint8_t serving_ports[DSW_MAX_PORTS];
 	uint16_t num_serving_ports;
 
-	uint8_t flow_to_port_map[DSW_MAX_FLOWS] __rte_cache_aligned;
+	/* DSW_MAX_FLOWS entries, allocated at configure time. */
+	uint8_t *flow_to_port_map;
 };
 
 struct dsw_evdev {
@@ -226,14 +249,14 @@ struct dsw_evdev {
 #define DSW_CTL_UNPAUS_REQ (1)
 #define DSW_CTL_CFM (2)
 
-/* sizeof(struct dsw_ctl_msg) must be equal or less than
- * sizeof(void *), to fit on the control ring.
+/* A control message is carried in DSW_CTL_MSG_SLOTS consecutive
+ * control ring slots, which are enqueued and dequeued in bulk.
  */
 struct dsw_ctl_msg {
 	uint8_t type:2;
 	uint8_t originating_port_id:6;
 	uint8_t queue_id;
-	uint16_t flow_hash;
+	uint32_t flow_hash;
 } __rte_packed;
 
 uint16_t dsw_event_enqueue(void *port, const struct rte_event *event);
@@ -176,32 +176,33 @@ dsw_port_consider_load_update(struct dsw_port *port, uint64_t now)
 static void
 dsw_port_ctl_enqueue(struct dsw_port *port, struct dsw_ctl_msg *msg)
 {
-	void *raw_msg;
+	void *raw_msg[DSW_CTL_MSG_SLOTS];
 
-	memcpy(&raw_msg, msg, sizeof(*msg));
+	memcpy(raw_msg, msg, sizeof(*msg));
 
 	/* there's always room on the ring */
-	while (rte_ring_enqueue(port->ctl_in_ring, raw_msg) != 0)
+	while (rte_ring_enqueue_bulk(port->ctl_in_ring, raw_msg,
+				     DSW_CTL_MSG_SLOTS, NULL) == 0)
 		rte_pause();
 }
 
 static int
 dsw_port_ctl_dequeue(struct dsw_port *port, struct dsw_ctl_msg *msg)
 {
-	void *raw_msg;
-	int rc;
+	void *raw_msg[DSW_CTL_MSG_SLOTS];
 
-	rc = rte_ring_dequeue(port->ctl_in_ring, &raw_msg);
+	if (rte_ring_dequeue_bulk(port->ctl_in_ring, raw_msg,
+				  DSW_CTL_MSG_SLOTS, NULL) == 0)
+		return -ENOENT;
 
-	if (rc == 0)
-		memcpy(msg, &raw_msg, sizeof(*msg));
+	memcpy(msg, raw_msg, sizeof(*msg));
 
-	return rc;
+	return 0;
 }
 
 static void
 dsw_port_ctl_broadcast(struct dsw_evdev *dsw, struct dsw_port *source_port,
-		       uint8_t type, uint8_t queue_id, uint16_t flow_hash)
+		       uint8_t type, uint8_t queue_id, uint32_t flow_hash)
 {
 	uint16_t port_id;
 	struct dsw_ctl_msg msg = {
@@ -218,7 +219,7 @@ dsw_port_ctl_broadcast(struct dsw_evdev *dsw, struct dsw_port *source_port,
 
 static bool
 dsw_port_is_flow_paused(struct dsw_port *port, uint8_t queue_id,
-			uint16_t flow_hash)
+			uint32_t flow_hash)
 {
 	uint16_t i;
 
@@ -233,7 +234,7 @@ dsw_port_is_flow_paused(struct dsw_port *port, uint8_t queue_id,
 
 static void
 dsw_port_add_paused_flow(struct dsw_port *port, uint8_t queue_id,
-			 uint16_t paused_flow_hash)
+			 uint32_t paused_flow_hash)
 {
 	port->paused_flows[port->paused_flows_len] = (struct dsw_queue_flow) {
 		.queue_id = queue_id,
@@ -244,7 +245,7 @@ dsw_port_add_paused_flow(struct dsw_port *port, uint8_t queue_id,
 
 static void
 dsw_port_remove_paused_flow(struct dsw_port *port, uint8_t queue_id,
-			    uint16_t paused_flow_hash)
+			    uint32_t paused_flow_hash)
 {
 	uint16_t i;
 
@@ -269,7 +270,7 @@ dsw_port_flush_out_buffers(struct dsw_evdev *dsw, struct dsw_port *source_port);
 static void
 dsw_port_handle_pause_flow(struct dsw_evdev *dsw, struct dsw_port *port,
 			   uint8_t originating_port_id, uint8_t queue_id,
-			   uint16_t paused_flow_hash)
+			   uint32_t paused_flow_hash)
 {
 	struct dsw_ctl_msg cfm = {
 		.type = DSW_CTL_CFM,
@@ -338,7 +339,7 @@ dsw_cmp_burst(const void *v_burst_a, const void *v_burst_b)
 }
 
 #define DSW_QF_TO_INT(_qf)					\
-	((int)((((_qf)->queue_id)<<16)|((_qf)->flow_hash)))
+	((int)((((_qf)->queue_id)<<DSW_MAX_FLOWS_BITS)|((_qf)->flow_hash)))
 
 static inline int
 dsw_cmp_qf(const void *v_qf_a, const void *v_qf_b)
@@ -397,47 +398,93 @@ dsw_retrieve_port_loads(struct dsw_evdev *dsw, int16_t *port_loads,
 }
 
 static bool
-dsw_select_migration_target(struct dsw_evdev *dsw,
-			    struct dsw_port *source_port,
-			    struct dsw_queue_flow_burst *bursts,
-			    uint16_t num_bursts, int16_t *port_loads,
-			    int16_t max_load, struct dsw_queue_flow *target_qf,
-			    uint8_t *target_port_id)
+dsw_is_migration_target(struct dsw_port *source_port, uint8_t queue_id,
+			uint32_t flow_hash)
+{
+	uint16_t i;
+
+	for (i = 0; i < source_port->migration_targets_len; i++) {
+		struct dsw_queue_flow *qf = &source_port->migration_target_qfs[i];
+
+		if (qf->queue_id == queue_id && qf->flow_hash == flow_hash)
+			return true;
+	}
+	return false;
+}
+
+/* Adds flows to the port's migration target list, smallest first,
+ * until either the list is full, or enough load has been moved to
+ * bring the source port below the migration threshold. The flow's
+ * share of the source port load is estimated from its share of the
+ * recorded events, and is accounted to the selected target port, so
+ * that the next flow considered sees the effect of earlier
+ * selections, and all flows don't end up on the same port.
+ */
+static void
+dsw_select_migration_targets(struct dsw_evdev *dsw,
+			     struct dsw_port *source_port,
+			     struct dsw_queue_flow_burst *bursts,
+			     uint16_t num_bursts, uint16_t num_events,
+			     int16_t *port_loads, int16_t max_load)
 {
-	uint16_t source_load = port_loads[source_port->id];
+	int32_t source_load = port_loads[source_port->id];
 	uint16_t i;
 
 	for (i = 0; i < num_bursts; i++) {
 		struct dsw_queue_flow *qf = &bursts[i].queue_flow;
+		uint8_t target_port_id;
+		int16_t target_load;
+		int32_t flow_load;
+		uint8_t idx;
+
+		if (source_port->migration_targets_len ==
+		    DSW_MAX_FLOWS_PER_MIGRATION ||
+		    source_load < DSW_MIN_SOURCE_LOAD_FOR_MIGRATION)
+			break;
 
 		if (dsw_port_is_flow_paused(source_port, qf->queue_id,
+					    qf->flow_hash) ||
+		    dsw_is_migration_target(source_port, qf->queue_id,
 					    qf->flow_hash))
 			continue;
 
 		struct dsw_queue *queue = &dsw->queues[qf->queue_id];
-		int16_t target_load;
 
 		dsw_find_lowest_load_port(queue->serving_ports,
 					  queue->num_serving_ports,
 					  source_port->id, port_loads,
-					  target_port_id, &target_load);
+					  &target_port_id, &target_load);
 
-		if (target_load < source_load &&
-		    target_load < max_load) {
-			*target_qf = *qf;
-			return true;
-		}
+		flow_load = (source_load * bursts[i].count) / num_events;
+
+		/* Moving the flow should not just swap the roles of
+		 * the source and the target port.
+		 */
+		if (target_load + flow_load > source_load - flow_load ||
+		    target_load >= max_load)
+			continue;
+
+		idx = source_port->migration_targets_len;
+		source_port->migration_target_qfs[idx] = *qf;
+		source_port->migration_target_port_ids[idx] = target_port_id;
+		source_port->migration_targets_len++;
+
+		port_loads[target_port_id] =
+			RTE_MIN(target_load + flow_load, DSW_MAX_LOAD);
+		source_load -= flow_load;
 	}
 
-	DSW_LOG_DP_PORT(DEBUG, source_port->id, "For the %d flows considered, "
-			"no target port found with load less than %d.\n",
-			num_bursts, DSW_LOAD_TO_PERCENT(max_load));
+	port_loads[source_port->id] = source_load;
 
-	return false;
+	if (source_port->migration_targets_len == 0)
+		DSW_LOG_DP_PORT(DEBUG, source_port->id, "For the %d flows "
+				"considered, no target port found with load "
+				"less than %d.\n", num_bursts,
+				DSW_LOAD_TO_PERCENT(max_load));
 }
 
 static uint8_t
-dsw_schedule(struct dsw_evdev *dsw, uint8_t queue_id, uint16_t flow_hash)
+dsw_schedule(struct dsw_evdev *dsw, uint8_t queue_id, uint32_t flow_hash)
 {
 	struct dsw_queue *queue = &dsw->queues[queue_id];
 	uint8_t port_id;
@@ -517,10 +564,10 @@ dsw_port_buffer_non_paused(struct dsw_evdev *dsw, struct dsw_port *source_port,
 }
 
 #define DSW_FLOW_ID_BITS (24)
-static uint16_t
+static uint32_t
 dsw_flow_id_hash(uint32_t flow_id)
 {
-	uint16_t hash = 0;
+	uint32_t hash = 0;
 	uint16_t offset = 0;
 
 	do {
@@ -549,7 +596,7 @@ static void
 dsw_port_buffer_event(struct dsw_evdev *dsw, struct dsw_port *source_port,
 		      const struct rte_event *event)
 {
-	uint16_t flow_hash;
+	uint32_t flow_hash;
 	uint8_t dest_port_id;
 
 	if (unlikely(dsw->queues[event->queue_id].schedule_type ==
@@ -574,7 +621,7 @@ dsw_port_buffer_event(struct dsw_evdev *dsw, struct dsw_port *source_port,
 static void
 dsw_port_flush_paused_events(struct dsw_evdev *dsw,
 			     struct dsw_port *source_port,
-			     uint8_t queue_id, uint16_t paused_flow_hash)
+			     uint8_t queue_id, uint32_t paused_flow_hash)
 {
 	uint16_t paused_events_len = source_port->paused_events_len;
 	struct rte_event paused_events[paused_events_len];
@@ -596,7 +643,7 @@ dsw_port_flush_paused_events(struct dsw_evdev *dsw,
 
 	for (i = 0; i < paused_events_len; i++) {
 		struct rte_event *event = &paused_events[i];
-		uint16_t flow_hash;
+		uint32_t flow_hash;
 
 		flow_hash = dsw_flow_id_hash(event->flow_id);
 
@@ -616,27 +663,76 @@ dsw_port_migration_stats(struct dsw_port *port)
 
 	migration_latency = (rte_get_timer_cycles() - port->migration_start);
 	port->migration_latency += migration_latency;
+	port->migration_latency_max = RTE_MAX(port->migration_latency_max,
+					      migration_latency);
 	port->migrations++;
+	port->migrated_flows += port->migration_targets_len;
 }
 
 static void
 dsw_port_end_migration(struct dsw_evdev *dsw, struct dsw_port *port)
 {
-	uint8_t queue_id = port->migration_target_qf.queue_id;
-	uint16_t flow_hash = port->migration_target_qf.flow_hash;
+	uint16_t i;
 
 	port->migration_state = DSW_MIGRATION_STATE_IDLE;
 	port->seen_events_len = 0;
 
 	dsw_port_migration_stats(port);
 
-	if (dsw->queues[queue_id].schedule_type != RTE_SCHED_TYPE_PARALLEL) {
-		dsw_port_remove_paused_flow(port, queue_id, flow_hash);
-		dsw_port_flush_paused_events(dsw, port, queue_id, flow_hash);
+	for (i = 0; i < port->migration_targets_len; i++) {
+		uint8_t queue_id = port->migration_target_qfs[i].queue_id;
+		uint32_t flow_hash = port->migration_target_qfs[i].flow_hash;
+
+		if (dsw->queues[queue_id].schedule_type !=
+		    RTE_SCHED_TYPE_PARALLEL) {
+			dsw_port_remove_paused_flow(port, queue_id, flow_hash);
+			dsw_port_flush_paused_events(dsw, port, queue_id,
+						     flow_hash);
+		}
+
+		DSW_LOG_DP_PORT(DEBUG, port->id, "Migration completed for "
+				"queue_id %d flow_hash %d.\n", queue_id,
+				flow_hash);
+	}
+
+	port->migration_targets_len = 0;
+}
+
+/* Parallel flows need not go through the pause procedure, since
+ * there is no atomic/ordered semantics to maintain, so they are moved
+ * right away and taken off the target list.
+ */
+static void
+dsw_port_move_parallel_flows(struct dsw_evdev *dsw,
+			     struct dsw_port *source_port)
+{
+	uint16_t i = 0;
+
+	while (i < source_port->migration_targets_len) {
+		struct dsw_queue_flow *qf = &source_port->migration_target_qfs[i];
+		struct dsw_queue *queue = &dsw->queues[qf->queue_id];
+		uint8_t last_idx;
+
+		if (queue->schedule_type != RTE_SCHED_TYPE_PARALLEL) {
+			i++;
+			continue;
+		}
+
+		/* Single byte-sized stores are always atomic. */
+		queue->flow_to_port_map[qf->flow_hash] =
+			source_port->migration_target_port_ids[i];
+
+		source_port->migrated_flows++;
+
+		last_idx = source_port->migration_targets_len - 1;
+		source_port->migration_target_qfs[i] =
+			source_port->migration_target_qfs[last_idx];
+		source_port->migration_target_port_ids[i] =
+			source_port->migration_target_port_ids[last_idx];
+		source_port->migration_targets_len--;
 	}
 
-	DSW_LOG_DP_PORT(DEBUG, port->id, "Migration completed for queue_id "
-			"%d flow_hash %d.\n", queue_id, flow_hash);
+	rte_smp_wmb();
 }
 
 static void
@@ -651,6 +747,7 @@ dsw_port_consider_migration(struct dsw_evdev *dsw,
 	uint16_t num_bursts;
 	int16_t source_port_load;
 	int16_t port_loads[dsw->num_ports];
+	uint16_t i;
 
 	if (now < source_port->next_migration)
 		return;
@@ -727,54 +824,43 @@ dsw_port_consider_migration(struct dsw_evdev *dsw,
 		return;
 	}
 
-	/* The strategy is to first try to find a flow to move to a
-	 * port with low load (below the migration-attempt
-	 * threshold). If that fails, we try to find a port which is
-	 * below the max threshold, and also less loaded than this
+	/* The strategy is to first try to find flows to move to ports
+	 * with low load (below the migration-attempt threshold). If
+	 * that doesn't shed enough load, we try to find ports which
+	 * are below the max threshold, and also less loaded than this
 	 * port is.
 	 */
-	if (!dsw_select_migration_target(dsw, source_port, bursts, num_bursts,
-					 port_loads,
-					 DSW_MIN_SOURCE_LOAD_FOR_MIGRATION,
-					 &source_port->migration_target_qf,
-					 &source_port->migration_target_port_id)
-	    &&
-	    !dsw_select_migration_target(dsw, source_port, bursts, num_bursts,
-					 port_loads,
-					 DSW_MAX_TARGET_LOAD_FOR_MIGRATION,
-					 &source_port->migration_target_qf,
-				       &source_port->migration_target_port_id))
+	source_port->migration_targets_len = 0;
+
+	dsw_select_migration_targets(dsw, source_port, bursts, num_bursts,
+				     seen_events_len, port_loads,
+				     DSW_MIN_SOURCE_LOAD_FOR_MIGRATION);
+
+	dsw_select_migration_targets(dsw, source_port, bursts, num_bursts,
+				     seen_events_len, port_loads,
+				     DSW_MAX_TARGET_LOAD_FOR_MIGRATION);
+
+	if (source_port->migration_targets_len == 0)
 		return;
 
-	DSW_LOG_DP_PORT(DEBUG, source_port->id, "Migrating queue_id %d "
-			"flow_hash %d from port %d to port %d.\n",
-			source_port->migration_target_qf.queue_id,
-			source_port->migration_target_qf.flow_hash,
-			source_port->id, source_port->migration_target_port_id);
+	/* We have winners. */
 
-	/* We have a winner. */
+	for (i = 0; i < source_port->migration_targets_len; i++)
+		DSW_LOG_DP_PORT(DEBUG, source_port->id, "Migrating queue_id "
+				"%d flow_hash %d from port %d to port %d.\n",
+				source_port->migration_target_qfs[i].queue_id,
+				source_port->migration_target_qfs[i].flow_hash,
+				source_port->id,
+				source_port->migration_target_port_ids[i]);
 
 	source_port->migration_state = DSW_MIGRATION_STATE_PAUSING;
 	source_port->migration_start = rte_get_timer_cycles();
 
-	/* No need to go through the whole pause procedure for
-	 * parallel queues, since atomic/ordered semantics need not to
-	 * be maintained.
-	 */
-
-	if (dsw->queues[source_port->migration_target_qf.queue_id].schedule_type
-	    == RTE_SCHED_TYPE_PARALLEL) {
-		uint8_t queue_id = source_port->migration_target_qf.queue_id;
-		uint16_t flow_hash = source_port->migration_target_qf.flow_hash;
-		uint8_t dest_port_id = source_port->migration_target_port_id;
-
-		/* Single byte-sized stores are always atomic. */
-		dsw->queues[queue_id].flow_to_port_map[flow_hash] =
-			dest_port_id;
-		rte_smp_wmb();
+	dsw_port_move_parallel_flows(dsw, source_port);
 
+	if (source_port->migration_targets_len == 0) {
 		dsw_port_end_migration(dsw, source_port);
-
+		source_port->migration_cycles += rte_get_timer_cycles() - now;
 		return;
 	}
 
@@ -783,25 +869,30 @@ dsw_port_consider_migration(struct dsw_evdev *dsw,
 	 */
 	dsw_port_flush_out_buffers(dsw, source_port);
 
-	dsw_port_add_paused_flow(source_port,
-				 source_port->migration_target_qf.queue_id,
-				 source_port->migration_target_qf.flow_hash);
+	for (i = 0; i < source_port->migration_targets_len; i++) {
+		struct dsw_queue_flow *qf =
+			&source_port->migration_target_qfs[i];
+
+		dsw_port_add_paused_flow(source_port, qf->queue_id,
+					 qf->flow_hash);
 
-	dsw_port_ctl_broadcast(dsw, source_port, DSW_CTL_PAUS_REQ,
-			       source_port->migration_target_qf.queue_id,
-			       source_port->migration_target_qf.flow_hash);
+		dsw_port_ctl_broadcast(dsw, source_port, DSW_CTL_PAUS_REQ,
+				       qf->queue_id, qf->flow_hash);
+	}
 	source_port->cfm_cnt = 0;
+
+	source_port->migration_cycles += rte_get_timer_cycles() - now;
 }
 
 static void
 dsw_port_flush_paused_events(struct dsw_evdev *dsw,
 			     struct dsw_port *source_port,
-			     uint8_t queue_id, uint16_t paused_flow_hash);
+			     uint8_t queue_id, uint32_t paused_flow_hash);
 
 static void
 dsw_port_handle_unpause_flow(struct dsw_evdev *dsw, struct dsw_port *port,
 			     uint8_t originating_port_id, uint8_t queue_id,
-			     uint16_t paused_flow_hash)
+			     uint32_t paused_flow_hash)
 {
 	struct dsw_ctl_msg cfm = {
 		.type = DSW_CTL_CFM,
@@ -825,10 +916,8 @@ dsw_port_handle_unpause_flow(struct dsw_evdev *dsw, struct dsw_port *port,
 #define FORWARD_BURST_SIZE (32)
 
 static void
-dsw_port_forward_migrated_flow(struct dsw_port *source_port,
-			       struct rte_event_ring *dest_ring,
-			       uint8_t queue_id,
-			       uint16_t flow_hash)
+dsw_port_forward_migrated_flows(struct dsw_evdev *dsw,
+				struct dsw_port *source_port)
 {
 	uint16_t events_left;
 
@@ -856,8 +945,27 @@ dsw_port_forward_migrated_flow(struct dsw_port *source_port,
 		 */
 		for (i = 0; i < in_len; i++) {
 			struct rte_event *e = &in_burst[i];
-			if (e->queue_id == queue_id &&
-			    dsw_flow_id_hash(e->flow_id) == flow_hash) {
+			uint32_t flow_hash = dsw_flow_id_hash(e->flow_id);
+			struct rte_event_ring *dest_ring = NULL;
+			uint16_t j;
+
+			for (j = 0; j < source_port->migration_targets_len;
+			     j++) {
+				struct dsw_queue_flow *qf =
+					&source_port->migration_target_qfs[j];
+				uint8_t dest_port_id;
+
+				if (e->queue_id != qf->queue_id ||
+				    flow_hash != qf->flow_hash)
+					continue;
+
+				dest_port_id =
+				     source_port->migration_target_port_ids[j];
+				dest_ring = dsw->ports[dest_port_id].in_ring;
+				break;
+			}
+
+			if (dest_ring != NULL) {
 				while (rte_event_ring_enqueue_burst(dest_ring,
 								    e, 1,
 								    NULL) != 1)
@@ -874,33 +982,42 @@ dsw_port_forward_migrated_flow(struct dsw_port *source_port,
 }
 
 static void
-dsw_port_move_migrating_flow(struct dsw_evdev *dsw,
-			     struct dsw_port *source_port)
+dsw_port_move_migrating_flows(struct dsw_evdev *dsw,
+			      struct dsw_port *source_port)
 {
-	uint8_t queue_id = source_port->migration_target_qf.queue_id;
-	uint16_t flow_hash = source_port->migration_target_qf.flow_hash;
-	uint8_t dest_port_id = source_port->migration_target_port_id;
-	struct dsw_port *dest_port = &dsw->ports[dest_port_id];
+	uint64_t start = rte_get_timer_cycles();
+	uint16_t i;
 
 	dsw_port_flush_out_buffers(dsw, source_port);
 
 	rte_smp_wmb();
 
-	dsw->queues[queue_id].flow_to_port_map[flow_hash] =
-		dest_port_id;
+	for (i = 0; i < source_port->migration_targets_len; i++) {
+		struct dsw_queue_flow *qf =
+			&source_port->migration_target_qfs[i];
+
+		dsw->queues[qf->queue_id].flow_to_port_map[qf->flow_hash] =
+			source_port->migration_target_port_ids[i];
+	}
 
-	dsw_port_forward_migrated_flow(source_port, dest_port->in_ring,
-				       queue_id, flow_hash);
+	dsw_port_forward_migrated_flows(dsw, source_port);
 
 	/* Flow table update and migration destination port's enqueues
 	 * must be seen before the control message.
 	 */
 	rte_smp_wmb();
 
-	dsw_port_ctl_broadcast(dsw, source_port, DSW_CTL_UNPAUS_REQ, queue_id,
-			       flow_hash);
+	for (i = 0; i < source_port->migration_targets_len; i++) {
+		struct dsw_queue_flow *qf =
+			&source_port->migration_target_qfs[i];
+
+		dsw_port_ctl_broadcast(dsw, source_port, DSW_CTL_UNPAUS_REQ,
+				       qf->queue_id, qf->flow_hash);
+	}
 	source_port->cfm_cnt = 0;
 	source_port->migration_state = DSW_MIGRATION_STATE_UNPAUSING;
+
+	source_port->migration_cycles += rte_get_timer_cycles() - start;
 }
 
 static void
@@ -908,7 +1025,8 @@ dsw_port_handle_confirm(struct dsw_evdev *dsw, struct dsw_port *port)
 {
 	port->cfm_cnt++;
 
-	if (port->cfm_cnt == (dsw->num_ports-1)) {
+	if (port->cfm_cnt ==
+	    (dsw->num_ports-1) * port->migration_targets_len) {
 		switch (port->migration_state) {
 		case DSW_MIGRATION_STATE_PAUSING:
 			DSW_LOG_DP_PORT(DEBUG, port->id, "Going into forwarding "
@@ -969,7 +1087,7 @@ dsw_port_bg_process(struct dsw_evdev *dsw, struct dsw_port *port)
 {
 	if (unlikely(port->migration_state == DSW_MIGRATION_STATE_FORWARDING &&
 		     port->pending_releases == 0))
-		dsw_port_move_migrating_flow(dsw, port);
+		dsw_port_move_migrating_flows(dsw, port);
 
 	/* Polling the control ring is relatively inexpensive, and
 	 * polling it often helps bringing down migration latency, so
@@ -86,6 +86,8 @@ dsw_xstats_port_get_queue_dequeued(struct dsw_evdev *dsw, uint8_t port_id,
 
 DSW_GEN_PORT_ACCESS_FN(migrations)
 
+DSW_GEN_PORT_ACCESS_FN(migrated_flows)
+
 static uint64_t
 dsw_xstats_port_get_migration_latency(struct dsw_evdev *dsw, uint8_t port_id,
 				      uint8_t queue_id __rte_unused)
@@ -96,6 +98,18 @@ dsw_xstats_port_get_migration_latency(struct dsw_evdev *dsw, uint8_t port_id,
 	return num_migrations > 0 ? total_latency / num_migrations : 0;
 }
 
+DSW_GEN_PORT_ACCESS_FN(migration_latency_max)
+
+static uint64_t
+dsw_xstats_port_get_migration_cost(struct dsw_evdev *dsw, uint8_t port_id,
+				   uint8_t queue_id __rte_unused)
+{
+	uint64_t total_cycles = dsw->ports[port_id].migration_cycles;
+	uint64_t num_migrations = dsw->ports[port_id].migrations;
+
+	return num_migrations > 0 ? total_cycles / num_migrations : 0;
+}
+
 static uint64_t
 dsw_xstats_port_get_event_proc_latency(struct dsw_evdev *dsw, uint8_t port_id,
 				       uint8_t queue_id __rte_unused)
@@ -138,8 +152,14 @@ static struct dsw_xstats_port dsw_port_xstats[] = {
 	  true },
 	{ "port_%u_migrations", dsw_xstats_port_get_migrations,
 	  false },
+	{ "port_%u_migrated_flows", dsw_xstats_port_get_migrated_flows,
+	  false },
 	{ "port_%u_migration_latency", dsw_xstats_port_get_migration_latency,
 	  false },
+	{ "port_%u_migration_latency_max",
+	  dsw_xstats_port_get_migration_latency_max, false },
+	{ "port_%u_migration_cost", dsw_xstats_port_get_migration_cost,
+	  false },
 	{ "port_%u_event_proc_latency", dsw_xstats_port_get_event_proc_latency,
 	  false },
 	{ "port_%u_inflight_credits", dsw_xstats_port_get_inflight_credits,
@@ -20,6 +20,7 @@
 #define NUMA_NODE_ARG "numa_node"
 #define DO_VALIDATION_ARG "do_validation"
 #define DO_TEST_ARG "self_test"
+#define STAGE_INSTANCES_ARG "stage_instances"
 
 
 static void
@@ -84,6 +85,33 @@ opdl_event_dequeue(void *port,
 	return p->deq(p, ev, 1);
 }
 
+/* Only worker queues, which have stage instances that can be handed from port
+ * to port, can be relinked while the device is running.
+ */
+static int
+opdl_runtime_relink_check(struct rte_eventdev *dev,
+			  struct opdl_port *p,
+			  uint8_t queue_id)
+{
+	struct opdl_evdev *device = opdl_pmd_priv(dev);
+	struct opdl_queue *queue =
+		&device->queue[device->q_map_ex_to_in[queue_id]];
+
+	if ((p->p_type != OPDL_REGULAR_PORT &&
+	     p->p_type != OPDL_PURE_RX_PORT) ||
+	    queue->q_pos != OPDL_Q_POS_MIDDLE ||
+	    queue->nb_insts == 0) {
+		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
+			     "Attempt to relink queue (%u) and port %d while device started, only worker queues and ports can be relinked\n",
+			     dev->data->dev_id,
+			     queue_id,
+			     p->id);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static int
 opdl_port_link(struct rte_eventdev *dev,
 	       void *port,
@@ -96,16 +124,6 @@ opdl_port_link(struct rte_eventdev *dev,
 	RTE_SET_USED(priorities);
 	RTE_SET_USED(dev);
 
-	if (unlikely(dev->data->dev_started)) {
-		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
-			     "Attempt to link queue (%u) to port %d while device started\n",
-			     dev->data->dev_id,
-				queues[0],
-				p->id);
-		rte_errno = -EINVAL;
-		return 0;
-	}
-
 	/* Max of 1 queue per port */
 	if (num > 1) {
 		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
@@ -138,6 +156,20 @@ opdl_port_link(struct rte_eventdev *dev,
 		return 0;
 	}
 
+	if (unlikely(dev->data->dev_started)) {
+		struct opdl_evdev *device = opdl_pmd_priv(dev);
+
+		if (opdl_runtime_relink_check(dev, p, queues[0]) < 0) {
+			rte_errno = -EINVAL;
+			return 0;
+		}
+
+		p->external_qid = queues[0];
+		rebalance_stage_instances(dev,
+				device->q_map_ex_to_in[queues[0]]);
+		return 1;
+	}
+
 	p->external_qid = queues[0];
 
 	return 1;
@@ -155,13 +187,35 @@ opdl_port_unlink(struct rte_eventdev *dev,
 	RTE_SET_USED(nb_unlinks);
 
 	if (unlikely(dev->data->dev_started)) {
-		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
-			     "Attempt to unlink queue (%u) to port %d while device started\n",
-			     dev->data->dev_id,
-			     queues[0],
-			     p->id);
-		rte_errno = -EINVAL;
-		return 0;
+		struct opdl_evdev *device = opdl_pmd_priv(dev);
+		uint8_t queue_id = p->external_qid;
+
+		if (nb_unlinks == 0 || queue_id == OPDL_INVALID_QID ||
+				queues[0] != queue_id)
+			return 0;
+
+		if (opdl_runtime_relink_check(dev, p, queue_id) < 0) {
+			rte_errno = -EINVAL;
+			return 0;
+		}
+
+		/* The instances of the port go to the other linked ports,
+		 * there must be one left.
+		 */
+		p->external_qid = OPDL_INVALID_QID;
+		if (rebalance_stage_instances(dev,
+				device->q_map_ex_to_in[queue_id]) < 0) {
+			PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
+				     "Attempt to unlink the last port %d of queue (%u) while device started\n",
+				     dev->data->dev_id,
+				     p->id,
+				     queue_id);
+			p->external_qid = queue_id;
+			rte_errno = -EINVAL;
+			return 0;
+		}
+
+		return 1;
 	}
 	RTE_SET_USED(nb_unlinks);
 
@@ -174,6 +228,26 @@ opdl_port_unlink(struct rte_eventdev *dev,
 	return 0;
 }
 
+static int
+opdl_port_unlinks_in_progress(struct rte_eventdev *dev, void *port)
+{
+	struct opdl_evdev *device = opdl_pmd_priv(dev);
+	struct opdl_port *p = port;
+	uint32_t i;
+
+	/* Instances are handed over when the port is next dequeued from */
+	for (i = 0; i < device->nb_insts; i++) {
+		struct opdl_stage_inst *inst = &device->insts[i];
+
+		if (__atomic_load_n(&inst->owner, __ATOMIC_ACQUIRE) == p->id &&
+		    __atomic_load_n(&inst->next_owner, __ATOMIC_ACQUIRE) !=
+				p->id)
+			return 1;
+	}
+
+	return 0;
+}
+
 static int
 opdl_port_setup(struct rte_eventdev *dev,
 		uint8_t port_id,
@@ -260,10 +334,7 @@ opdl_queue_setup(struct rte_eventdev *dev,
 
 	if (RTE_EVENT_QUEUE_CFG_ALL_TYPES
 	    & conf->event_queue_cfg) {
-		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
-			     "QUEUE_CFG_ALL_TYPES not supported\n",
-			     dev->data->dev_id);
-		return -ENOTSUP;
+		type = OPDL_Q_TYPE_HYBRID;
 	} else if (RTE_EVENT_QUEUE_CFG_SINGLE_LINK
 		   & conf->event_queue_cfg) {
 		type = OPDL_Q_TYPE_SINGLE_LINK;
@@ -374,7 +445,9 @@ opdl_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
 		.max_event_port_dequeue_depth = MAX_OPDL_CONS_Q_DEPTH,
 		.max_event_port_enqueue_depth = MAX_OPDL_CONS_Q_DEPTH,
 		.max_num_events = OPDL_INFLIGHT_EVENTS_TOTAL,
-		.event_dev_cap = RTE_EVENT_DEV_CAP_BURST_MODE,
+		.event_dev_cap = RTE_EVENT_DEV_CAP_BURST_MODE |
+				 RTE_EVENT_DEV_CAP_QUEUE_ALL_TYPES |
+				 RTE_EVENT_DEV_CAP_RUNTIME_PORT_LINK,
 	};
 
 	*info = evdev_opdl_info;
@@ -493,6 +566,10 @@ opdl_start(struct rte_eventdev *dev)
 		err = initialise_all_other_ports(dev);
 
 
+	if (!err)
+		err = assign_stage_instances(dev);
+
+
 	if (!err)
 		err = check_queues_linked(dev);
 
@@ -604,6 +681,20 @@ set_do_test(const char *key __rte_unused, const char *value, void *opaque)
 	return 0;
 }
 
+static int
+set_stage_instances(const char *key __rte_unused, const char *value,
+		void *opaque)
+{
+	uint32_t *stage_instances = opaque;
+	int n = atoi(value);
+
+	if (n < 0 || n > OPDL_PORTS_MAX)
+		return -1;
+
+	*stage_instances = n;
+	return 0;
+}
+
 static int
 opdl_probe(struct rte_vdev_device *vdev)
 {
@@ -623,6 +714,7 @@ opdl_probe(struct rte_vdev_device *vdev)
 		.port_release = opdl_port_release,
 		.port_link = opdl_port_link,
 		.port_unlink = opdl_port_unlink,
+		.port_unlinks_in_progress = opdl_port_unlinks_in_progress,
 
 
 		.xstats_get = opdl_xstats_get,
@@ -635,6 +727,7 @@ opdl_probe(struct rte_vdev_device *vdev)
 		NUMA_NODE_ARG,
 		DO_VALIDATION_ARG,
 		DO_TEST_ARG,
+		STAGE_INSTANCES_ARG,
 		NULL
 	};
 	const char *name;
@@ -644,6 +737,7 @@ opdl_probe(struct rte_vdev_device *vdev)
 	int socket_id = rte_socket_id();
 	int do_validation = 0;
 	int do_test = 0;
+	uint32_t stage_instances = 0;
 	int str_len;
 	int test_result = 0;
 
@@ -688,6 +782,16 @@ opdl_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, STAGE_INSTANCES_ARG,
+					set_stage_instances, &stage_instances);
+			if (ret != 0) {
+				PMD_DRV_LOG(ERR,
+					"%s: Error parsing stage instances parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
@@ -725,6 +829,7 @@ opdl_probe(struct rte_vdev_device *vdev)
 	opdl->socket = socket_id;
 	opdl->do_validation = do_validation;
 	opdl->do_test = do_test;
+	opdl->stage_instances = stage_instances;
 	str_len = strlen(name);
 	memcpy(opdl->service_name, name, str_len);
 
@@ -763,4 +868,5 @@ RTE_INIT(opdl_init_log)
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_OPDL_PMD, evdev_opdl_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_opdl, NUMA_NODE_ARG "=<int>"
-			      DO_VALIDATION_ARG "=<int>" DO_TEST_ARG "=<int>");
+			      DO_VALIDATION_ARG "=<int>" DO_TEST_ARG "=<int>"
+			      STAGE_INSTANCES_ARG "=<int>");
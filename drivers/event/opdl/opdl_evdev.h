@@ -36,6 +36,12 @@
 #define OPDL_PMD_NAME_MAX 64
 
 #define OPDL_INVALID_QID 255
+#define OPDL_INVALID_PORT_ID 255
+
+/* Stage instances of the worker queues of a device, that the ports can be
+ * relinked to at runtime
+ */
+#define OPDL_STAGE_INSTS_MAX (OPDL_PORTS_MAX * 2)
 
 #define OPDL_SCHED_TYPE_DIRECT (RTE_SCHED_TYPE_PARALLEL + 1)
 
@@ -61,7 +67,9 @@ enum queue_type {
 	OPDL_Q_TYPE_INVALID = 0,
 	OPDL_Q_TYPE_SINGLE_LINK = 1,
 	OPDL_Q_TYPE_ATOMIC,
-	OPDL_Q_TYPE_ORDERED
+	OPDL_Q_TYPE_ORDERED,
+	/* atomic or ordered, chosen by the sched_type of each event */
+	OPDL_Q_TYPE_HYBRID
 };
 
 enum queue_pos {
@@ -161,11 +169,41 @@ struct opdl_port {
 	/* instance ID of this stage*/
 	uint32_t instance_id;
 
+	/* Worker stage instances owned by this port, as indexes in the device
+	 * instance table, and the one to claim from next. Only updated by the
+	 * thread polling the port.
+	 */
+	uint8_t insts[OPDL_STAGE_INSTS_MAX];
+	uint8_t nb_insts;
+	uint8_t cur_inst;
+
+	/* Relink generation of the device the instances were last synced to */
+	uint32_t relink_gen;
+
 	/* track packets in and out of this port */
 	uint64_t port_stat[max_num_port_xstat];
 	uint64_t start_cycles;
 };
 
+/* A stage instance of a worker queue. Each instance is processed by exactly
+ * one port at a time, and is handed over from port to port when they are
+ * relinked at runtime.
+ */
+struct opdl_stage_inst {
+	struct opdl_stage *stage;
+
+	/* Internal queue the instance belongs to */
+	uint8_t queue_id;
+
+	/* Port currently processing the instance */
+	uint8_t owner;
+
+	/* Port the instance has been assigned to. The owner hands the instance
+	 * over once it has disclaimed all the entries it claimed.
+	 */
+	uint8_t next_owner;
+};
+
 struct opdl_queue_meta_data {
 	uint8_t         ext_id;
 	enum queue_type type;
@@ -201,6 +239,9 @@ struct opdl_queue {
 	struct opdl_port *ports[OPDL_PORTS_MAX];
 	uint32_t nb_ports;
 
+	/* number of stage instances, for worker queues */
+	uint32_t nb_insts;
+
 	/* priority, reserved for future */
 	uint8_t priority;
 };
@@ -247,6 +288,13 @@ struct opdl_evdev {
 
 	uint8_t q_map_ex_to_in[OPDL_INVALID_QID];
 
+	/* Stage instances of all worker queues */
+	struct opdl_stage_inst insts[OPDL_STAGE_INSTS_MAX];
+	uint32_t nb_insts;
+
+	/* Bumped each time ports are relinked while the device is running */
+	uint32_t relink_gen __rte_cache_aligned;
+
 	/* Stats */
 	struct opdl_xstats_entry port_xstat[OPDL_MAX_PORT_XSTAT_NUM];
 
@@ -254,6 +302,8 @@ struct opdl_evdev {
 	int socket;
 	int do_validation;
 	int do_test;
+	/* Minimum number of stage instances per worker queue */
+	uint32_t stage_instances;
 };
 
 
@@ -308,6 +358,8 @@ int create_queues_and_rings(struct rte_eventdev *dev);
 int initialise_all_other_ports(struct rte_eventdev *dev);
 int initialise_queue_zero_ports(struct rte_eventdev *dev);
 int assign_internal_queue_ids(struct rte_eventdev *dev);
+int assign_stage_instances(struct rte_eventdev *dev);
+int rebalance_stage_instances(struct rte_eventdev *dev, uint8_t queue_id);
 void destroy_queues_and_rings(struct rte_eventdev *dev);
 int opdl_selftest(void);
 
@@ -225,15 +225,92 @@ opdl_tx_dequeue_multi_inst(struct opdl_port *p,
 }
 
 
+static uint16_t
+opdl_claim(struct opdl_port *p, struct rte_event ev[], uint16_t num);
+static uint16_t
+opdl_disclaim(struct opdl_port *p, const struct rte_event ev[], uint16_t num);
+
+/*
+ * Worker relink sync
+ *
+ * Runs on the thread polling the port, between a disclaim and the next claim,
+ * after ports were relinked at runtime. Hands over the stage instances that
+ * were assigned to other ports and picks up the ones assigned to this port,
+ * once their previous owner has let go of them.
+ */
+
+static void
+opdl_port_relink_sync(struct opdl_port *p)
+{
+	struct opdl_evdev *device = p->opdl;
+	uint32_t gen = __atomic_load_n(&device->relink_gen, __ATOMIC_ACQUIRE);
+	bool settled = true;
+	uint32_t i;
+
+	p->nb_insts = 0;
+	p->cur_inst = 0;
+
+	for (i = 0; i < device->nb_insts; i++) {
+		struct opdl_stage_inst *inst = &device->insts[i];
+		uint8_t owner = __atomic_load_n(&inst->owner,
+				__ATOMIC_ACQUIRE);
+		uint8_t next_owner = __atomic_load_n(&inst->next_owner,
+				__ATOMIC_ACQUIRE);
+
+		if (owner == p->id && next_owner != p->id)
+			__atomic_store_n(&inst->owner, next_owner,
+					__ATOMIC_RELEASE);
+		else if (owner == p->id)
+			p->insts[p->nb_insts++] = i;
+		else if (next_owner == p->id)
+			settled = false;
+	}
+
+	if (p->nb_insts > 0) {
+		struct opdl_stage_inst *inst = &device->insts[p->insts[0]];
+		struct opdl_queue *queue = &device->queue[inst->queue_id];
+
+		p->queue_id = inst->queue_id;
+		p->next_external_qid =
+			device->queue[inst->queue_id + 1].external_qid;
+		p->atomic_claim = queue->q_type == OPDL_Q_TYPE_ATOMIC ||
+				queue->q_type == OPDL_Q_TYPE_HYBRID;
+		p->num_instance = queue->nb_insts;
+		p->deq_stage_inst = inst->stage;
+		p->enq_stage_inst = inst->stage;
+
+		/* An input port enlisted as a worker */
+		if (p->p_type == OPDL_PURE_RX_PORT) {
+			p->p_type = OPDL_REGULAR_PORT;
+			p->enq = opdl_disclaim;
+			p->deq = opdl_claim;
+		}
+	}
+
+	/* Keep syncing until all instances assigned to us were handed over */
+	if (settled)
+		p->relink_gen = gen;
+}
+
+static __rte_always_inline bool
+opdl_port_relink_pending(const struct opdl_port *p)
+{
+	return p->relink_gen != __atomic_load_n(&p->opdl->relink_gen,
+			__ATOMIC_ACQUIRE);
+}
+
 /*
  * Worker thread claim
  *
+ * Tries the stage instances owned by the port in turn, starting after the
+ * one claimed from last time, until one of them has events.
  */
 
 static uint16_t
 opdl_claim(struct opdl_port *p, struct rte_event ev[], uint16_t num)
 {
 	uint32_t num_events = 0;
+	uint32_t i;
 
 	if (unlikely(num > MAX_OPDL_CONS_Q_DEPTH)) {
 		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
@@ -244,13 +321,28 @@ opdl_claim(struct opdl_port *p, struct rte_event ev[], uint16_t num)
 		return 0;
 	}
 
+	if (unlikely(opdl_port_relink_pending(p)))
+		opdl_port_relink_sync(p);
 
-	num_events = opdl_stage_claim(p->deq_stage_inst,
-			(void *)ev,
-			num,
-			NULL,
-			false,
-			p->atomic_claim);
+	for (i = 0; i < p->nb_insts; i++) {
+		struct opdl_stage *stage_inst =
+			p->opdl->insts[p->insts[p->cur_inst]].stage;
+
+		if (++p->cur_inst == p->nb_insts)
+			p->cur_inst = 0;
+
+		p->deq_stage_inst = stage_inst;
+		p->enq_stage_inst = stage_inst;
+
+		num_events = opdl_stage_claim(stage_inst,
+				(void *)ev,
+				num,
+				NULL,
+				false,
+				p->atomic_claim);
+		if (num_events)
+			break;
+	}
 
 
 	update_on_dequeue(p, ev, num, num_events);
@@ -258,6 +350,25 @@ opdl_claim(struct opdl_port *p, struct rte_event ev[], uint16_t num)
 	return num_events;
 }
 
+/*
+ * RX port dequeue
+ *
+ * Input ports have nothing to dequeue, unless they were linked to a worker
+ * queue while the device is running.
+ */
+
+static uint16_t
+opdl_rx_dequeue(struct opdl_port *p, struct rte_event ev[], uint16_t num)
+{
+	if (unlikely(opdl_port_relink_pending(p))) {
+		opdl_port_relink_sync(p);
+		if (p->p_type == OPDL_REGULAR_PORT)
+			return opdl_claim(p, ev, num);
+	}
+
+	return opdl_tx_error_dequeue(p, ev, num);
+}
+
 /*
  * Worker thread disclaim
  */
@@ -289,6 +400,29 @@ stage_for_port(struct opdl_queue *q, unsigned int i)
 		return q->ports[i]->deq_stage_inst;
 }
 
+/* Gather the stage instances of a queue: those in the instance table for
+ * worker queues, one per port otherwise.
+ */
+static uint32_t
+stages_for_queue(struct opdl_evdev *device, int q_id,
+		struct opdl_stage *stages[])
+{
+	struct opdl_queue *queue = &device->queue[q_id];
+	uint32_t i, n = 0;
+
+	if (queue->nb_insts == 0) {
+		for (i = 0; i < queue->nb_ports; i++)
+			stages[n++] = stage_for_port(queue, i);
+		return n;
+	}
+
+	for (i = 0; i < device->nb_insts; i++)
+		if (device->insts[i].queue_id == q_id)
+			stages[n++] = device->insts[i].stage;
+
+	return n;
+}
+
 static int opdl_add_deps(struct opdl_evdev *device,
 			 int q_id,
 			 int deps_q_id)
@@ -296,18 +430,18 @@ static int opdl_add_deps(struct opdl_evdev *device,
 	unsigned int i, j;
 	int status;
 	struct opdl_ring  *ring;
-	struct opdl_queue *queue = &device->queue[q_id];
-	struct opdl_queue *queue_deps = &device->queue[deps_q_id];
-	struct opdl_stage *dep_stages[OPDL_PORTS_MAX];
+	struct opdl_stage *stages[OPDL_STAGE_INSTS_MAX];
+	struct opdl_stage *dep_stages[OPDL_STAGE_INSTS_MAX];
+	uint32_t nb_stages = stages_for_queue(device, q_id, stages);
+	uint32_t nb_dep_stages = stages_for_queue(device, deps_q_id,
+			dep_stages);
 
 	/* sanity check that all stages are for same opdl ring */
-	for (i = 0; i < queue->nb_ports; i++) {
-		struct opdl_ring *r =
-			opdl_stage_get_opdl_ring(stage_for_port(queue, i));
-		for (j = 0; j < queue_deps->nb_ports; j++) {
+	for (i = 0; i < nb_stages; i++) {
+		struct opdl_ring *r = opdl_stage_get_opdl_ring(stages[i]);
+		for (j = 0; j < nb_dep_stages; j++) {
 			struct opdl_ring *rj =
-				opdl_stage_get_opdl_ring(
-						stage_for_port(queue_deps, j));
+				opdl_stage_get_opdl_ring(dep_stages[j]);
 			if (r != rj) {
 				PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
 					     "Stages and dependents"
@@ -323,22 +457,17 @@ static int opdl_add_deps(struct opdl_evdev *device,
 		}
 	}
 
-	/* Gather all stages instance in deps */
-	for (i = 0; i < queue_deps->nb_ports; i++)
-		dep_stages[i] = stage_for_port(queue_deps, i);
-
+	/* Add all deps for each stage_inst in this queue */
+	for (i = 0; i < nb_stages; i++) {
 
-	/* Add all deps for each port->stage_inst in this queue */
-	for (i = 0; i < queue->nb_ports; i++) {
-
-		ring = opdl_stage_get_opdl_ring(stage_for_port(queue, i));
+		ring = opdl_stage_get_opdl_ring(stages[i]);
 
 		status = opdl_stage_deps_add(ring,
-				stage_for_port(queue, i),
-				queue->ports[i]->num_instance,
-				queue->ports[i]->instance_id,
+				stages[i],
+				nb_stages,
+				i,
 				dep_stages,
-				queue_deps->nb_ports);
+				nb_dep_stages);
 		if (status < 0)
 			return -EINVAL;
 	}
@@ -361,7 +490,7 @@ opdl_add_event_handlers(struct rte_eventdev *dev)
 		if (port->configured) {
 			if (port->p_type == OPDL_PURE_RX_PORT) {
 				port->enq = opdl_rx_enqueue;
-				port->deq = opdl_tx_error_dequeue;
+				port->deq = opdl_rx_dequeue;
 
 			} else if (port->p_type == OPDL_PURE_TX_PORT) {
 
@@ -558,7 +687,8 @@ create_opdl(struct opdl_evdev *device)
 		opdl_ring_create(name,
 				device->nb_events_limit,
 				sizeof(struct rte_event),
-				device->max_port_nb * 2,
+				device->max_port_nb * 2 +
+				device->stage_instances * device->max_queue_nb,
 				device->socket);
 
 	if (!device->opdl[device->nb_opdls]) {
@@ -618,6 +748,16 @@ create_queues_and_rings(struct rte_eventdev *dev)
 	struct opdl_evdev *device = opdl_pmd_priv(dev);
 
 	device->nb_queues = 0;
+	device->nb_insts = 0;
+
+	uint32_t i;
+	for (i = 0; i < device->nb_ports; i++) {
+		struct opdl_port *port = &device->ports[i];
+
+		port->nb_insts = 0;
+		port->cur_inst = 0;
+		port->relink_gen = device->relink_gen;
+	}
 
 	if (device->nb_ports != device->max_port_nb) {
 		PMD_DRV_LOG(ERR, "Number ports setup:%u NOT EQUAL to max port"
@@ -639,7 +779,6 @@ create_queues_and_rings(struct rte_eventdev *dev)
 				 OPDL_Q_POS_START,
 				 -1);
 
-		uint32_t i;
 		for (i = 0; i < device->nb_q_md; i++) {
 
 			/* Check */
@@ -655,7 +794,11 @@ create_queues_and_rings(struct rte_eventdev *dev)
 			} else if (device->q_md[i].type !=
 					OPDL_Q_TYPE_SINGLE_LINK) {
 
-				if (!device->q_md[i + 1].setup) {
+				/* Slots past nb_q_md may hold stale
+				 * meta data from a previous configuration
+				 */
+				if (i + 1 == device->nb_q_md ||
+						!device->q_md[i + 1].setup) {
 					/* Create a simple ORDERED/ATOMIC
 					 * queue at the end
 					 */
@@ -695,6 +838,41 @@ create_queues_and_rings(struct rte_eventdev *dev)
 }
 
 
+/* Add a stage instance of a worker queue to the device instance table */
+static int
+add_stage_inst(struct opdl_evdev *device, uint8_t queue_id,
+		struct opdl_stage *stage_inst, struct opdl_port *owner)
+{
+	struct opdl_queue *queue = &device->queue[queue_id];
+	struct opdl_stage_inst *inst;
+
+	if (stage_inst == NULL ||
+			device->nb_insts == OPDL_STAGE_INSTS_MAX) {
+		PMD_DRV_LOG(ERR, "DEV_ID:[%02d] : "
+			     "queue %u: cannot add stage instance %u",
+			     opdl_pmd_dev_id(device),
+			     queue->external_qid,
+			     device->nb_insts);
+		return -EINVAL;
+	}
+
+	opdl_stage_set_queue_id(stage_inst, queue_id);
+	opdl_stage_set_hybrid(stage_inst,
+			queue->q_type == OPDL_Q_TYPE_HYBRID);
+
+	inst = &device->insts[device->nb_insts];
+	inst->stage = stage_inst;
+	inst->queue_id = queue_id;
+	inst->owner = owner->id;
+	inst->next_owner = owner->id;
+
+	owner->insts[owner->nb_insts++] = device->nb_insts;
+	device->nb_insts++;
+	queue->nb_insts++;
+
+	return 0;
+}
+
 int
 initialise_all_other_ports(struct rte_eventdev *dev)
 {
@@ -722,7 +900,9 @@ initialise_all_other_ports(struct rte_eventdev *dev)
 				port->deq_stage_inst = stage_inst;
 				port->enq_stage_inst = stage_inst;
 
-				if (queue->q_type == OPDL_Q_TYPE_ATOMIC)
+				if (queue->q_type == OPDL_Q_TYPE_ATOMIC ||
+						queue->q_type ==
+						OPDL_Q_TYPE_HYBRID)
 					port->atomic_claim = true;
 				else
 					port->atomic_claim = false;
@@ -733,8 +913,11 @@ initialise_all_other_ports(struct rte_eventdev *dev)
 				queue->ports[queue->nb_ports] = port;
 				port->instance_id = queue->nb_ports;
 				queue->nb_ports++;
-				opdl_stage_set_queue_id(stage_inst,
-						port->queue_id);
+
+				err = add_stage_inst(device, port->queue_id,
+						stage_inst, port);
+				if (err)
+					break;
 
 			} else if (queue->q_pos == OPDL_Q_POS_END) {
 
@@ -866,6 +1049,132 @@ initialise_all_other_ports(struct rte_eventdev *dev)
 	return err;
 }
 
+int
+assign_stage_instances(struct rte_eventdev *dev)
+{
+	int err = 0;
+	struct opdl_evdev *device = opdl_pmd_priv(dev);
+	uint32_t i;
+
+	/* Over-provision worker queues, so that ports can be linked to them
+	 * at runtime. The extra instances are spread over the linked ports.
+	 */
+	for (i = 0; i < device->nb_queues && !err; i++) {
+		struct opdl_queue *queue = &device->queue[i];
+
+		while (queue->nb_insts > 0 &&
+				queue->nb_insts < device->stage_instances) {
+			struct opdl_port *owner =
+				queue->ports[queue->nb_insts % queue->nb_ports];
+			struct opdl_stage *stage_inst = opdl_stage_add(
+					device->opdl[queue->opdl_id],
+					false,
+					false);
+
+			err = add_stage_inst(device, i, stage_inst, owner);
+			if (err)
+				break;
+		}
+
+		if (queue->nb_insts > 0) {
+			uint32_t j;
+
+			for (j = 0; j < queue->nb_ports; j++)
+				queue->ports[j]->num_instance =
+					queue->nb_insts;
+		}
+	}
+
+	return err;
+}
+
+int
+rebalance_stage_instances(struct rte_eventdev *dev, uint8_t queue_id)
+{
+	struct opdl_evdev *device = opdl_pmd_priv(dev);
+	struct opdl_queue *queue = &device->queue[queue_id];
+	uint32_t nb_assigned[OPDL_PORTS_MAX] = {0};
+	uint8_t linked[OPDL_PORTS_MAX];
+	uint8_t orphans[OPDL_STAGE_INSTS_MAX];
+	uint32_t nb_linked = 0, nb_orphans = 0;
+	uint32_t quota, nb_extra;
+	uint32_t i, j;
+
+	for (i = 0; i < device->nb_ports; i++) {
+		struct opdl_port *port = &device->ports[i];
+
+		if (port->external_qid == queue->external_qid)
+			linked[nb_linked++] = port->id;
+	}
+
+	if (nb_linked == 0 || queue->nb_insts == 0)
+		return -EINVAL;
+
+	/* Each linked port gets the same share of the instances, give or
+	 * take one. Instances stay where they were assigned if possible.
+	 */
+	quota = queue->nb_insts / nb_linked;
+	nb_extra = queue->nb_insts % nb_linked;
+
+	for (i = 0; i < device->nb_insts; i++) {
+		struct opdl_stage_inst *inst = &device->insts[i];
+		uint8_t port_id = inst->next_owner;
+		bool keep = false;
+
+		if (inst->queue_id != queue_id)
+			continue;
+
+		for (j = 0; j < nb_linked; j++)
+			if (linked[j] == port_id)
+				break;
+
+		if (j < nb_linked) {
+			if (nb_assigned[port_id] < quota) {
+				keep = true;
+			} else if (nb_assigned[port_id] == quota &&
+					nb_extra > 0) {
+				nb_extra--;
+				keep = true;
+			}
+		}
+
+		if (keep)
+			nb_assigned[port_id]++;
+		else
+			orphans[nb_orphans++] = i;
+	}
+
+	for (i = 0; i < nb_orphans; i++) {
+		uint8_t port_id = OPDL_INVALID_PORT_ID;
+
+		for (j = 0; j < nb_linked; j++) {
+			if (nb_assigned[linked[j]] < quota) {
+				port_id = linked[j];
+				break;
+			}
+		}
+
+		if (port_id == OPDL_INVALID_PORT_ID) {
+			for (j = 0; j < nb_linked; j++) {
+				if (nb_assigned[linked[j]] == quota) {
+					port_id = linked[j];
+					break;
+				}
+			}
+			nb_extra--;
+		}
+
+		nb_assigned[port_id]++;
+		__atomic_store_n(&device->insts[orphans[i]].next_owner,
+				port_id, __ATOMIC_RELEASE);
+	}
+
+	/* Tell the ports to sync with the new assignment */
+	__atomic_add_fetch(&device->relink_gen, 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
 int
 initialise_queue_zero_ports(struct rte_eventdev *dev)
 {
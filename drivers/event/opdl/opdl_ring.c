@@ -29,6 +29,11 @@
 #define OPDL_FLOWID_MASK (0xFFFFF)
 #define OPDL_OPA_MASK    (0xFF)
 #define OPDL_OPA_OFFSET  (0x38)
+#define OPDL_SCHED_TYPE_MASK   (0x3)
+#define OPDL_SCHED_TYPE_OFFSET (0x26)
+/* Fields that decide which instance of a hybrid stage owns an event */
+#define OPDL_HYBRID_EVENT_MASK (OPDL_EVENT_MASK | \
+		((uint64_t)OPDL_SCHED_TYPE_MASK << OPDL_SCHED_TYPE_OFFSET))
 
 int opdl_logtype_driver;
 
@@ -107,6 +112,7 @@ struct opdl_stage {
 	uint32_t shadow_head;  /* Shadow head for single-thread operation */
 	uint32_t queue_id;     /* ID of Queue which is assigned to this stage */
 	uint32_t pos;		/* Atomic scan position */
+	bool hybrid;		/* Atomic claim honours event sched type */
 } __rte_cache_aligned;
 
 /* Context for opdl_ring */
@@ -493,6 +499,20 @@ opdl_first_entry_id(uint32_t start_seq, uint8_t nb_p_lcores,
 			nb_p_lcores);
 }
 
+/* Check if an event found by the atomic claim belongs to this instance. Seq
+ * is the sequence number of the event's slot relative to the stage.
+ */
+static __rte_always_inline bool
+opdl_stage_owns_event(const struct opdl_stage *s, uint64_t event, uint32_t seq)
+{
+	if (s->hybrid && ((event >> OPDL_SCHED_TYPE_OFFSET) &
+			OPDL_SCHED_TYPE_MASK) != RTE_SCHED_TYPE_ATOMIC)
+		return (seq % s->nb_instance) == s->instance_id;
+
+	return ((OPDL_FLOWID_MASK & event) % s->nb_instance) ==
+			s->instance_id;
+}
+
 /* Claim slots to process, optimised for single-thread operation */
 static __rte_always_inline uint32_t
 opdl_stage_claim_singlethread(struct opdl_stage *s, void *entries,
@@ -500,7 +520,6 @@ opdl_stage_claim_singlethread(struct opdl_stage *s, void *entries,
 {
 	uint32_t i = 0, j = 0,  offset;
 	uint32_t opa_id   = 0;
-	uint32_t flow_id  = 0;
 	uint64_t event    = 0;
 	void *get_slots;
 	struct rte_event *ev;
@@ -533,12 +552,11 @@ opdl_stage_claim_singlethread(struct opdl_stage *s, void *entries,
 					__ATOMIC_ACQUIRE);
 
 			opa_id = OPDL_OPA_MASK & (event >> OPDL_OPA_OFFSET);
-			flow_id  = OPDL_FLOWID_MASK & event;
 
 			if (opa_id >= s->queue_id)
 				continue;
 
-			if ((flow_id % s->nb_instance) == s->instance_id) {
+			if (opdl_stage_owns_event(s, event, s->seq + j)) {
 				memcpy(entries_offset, ev, t->slot_size);
 				entries_offset += t->slot_size;
 				i++;
@@ -983,15 +1001,16 @@ opdl_ring_cas_slot(struct opdl_stage *s, const struct rte_event *ev,
 	uint64_t ev_update  = 0;
 
 	uint32_t opa_id   = 0;
-	uint32_t flow_id  = 0;
 	uint64_t event    = 0;
+	uint64_t ev_mask  = s->hybrid ? OPDL_HYBRID_EVENT_MASK :
+			OPDL_EVENT_MASK;
 
 	if (index > s->num_event) {
 		PMD_DRV_LOG(ERR, "index is overflow");
 		return ev_updated;
 	}
 
-	ev_temp = ev->event & OPDL_EVENT_MASK;
+	ev_temp = ev->event & ev_mask;
 
 	if (!atomic) {
 		offset = opdl_first_entry_id(s->seq, s->nb_instance,
@@ -1016,20 +1035,22 @@ opdl_ring_cas_slot(struct opdl_stage *s, const struct rte_event *ev,
 					__ATOMIC_ACQUIRE);
 
 			opa_id = OPDL_OPA_MASK & (event >> OPDL_OPA_OFFSET);
-			flow_id  = OPDL_FLOWID_MASK & event;
 
 			if (opa_id >= s->queue_id)
 				continue;
 
-			if ((flow_id % s->nb_instance) == s->instance_id) {
+			if (opdl_stage_owns_event(s, event, s->seq + i)) {
 				ev_update = s->queue_id;
 				ev_update = (ev_update << OPDL_OPA_OFFSET)
 					| ev->event;
 
 				s->pos = i + 1;
 
-				if ((event & OPDL_EVENT_MASK) !=
-						ev_temp) {
+				/* Tag the event as processed by this queue
+				 * when its owner changes, so that the other
+				 * instances don't claim it too.
+				 */
+				if ((event & ev_mask) != ev_temp) {
 					__atomic_store_n(&(ev_orig->event),
 							ev_update,
 							__ATOMIC_RELEASE);
@@ -1192,6 +1213,12 @@ opdl_stage_set_queue_id(struct opdl_stage *s,
 	s->queue_id = queue_id;
 }
 
+void
+opdl_stage_set_hybrid(struct opdl_stage *s, bool hybrid)
+{
+	s->hybrid = hybrid;
+}
+
 void
 opdl_ring_dump(const struct opdl_ring *t, FILE *f)
 {
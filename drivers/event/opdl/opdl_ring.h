@@ -532,6 +532,20 @@ void
 opdl_stage_set_queue_id(struct opdl_stage *s,
 		uint32_t queue_id);
 
+/**
+ * Make the atomic claim of a stage instance honour the schedule type of each
+ * event: RTE_SCHED_TYPE_ATOMIC events are distributed among the instances of
+ * the stage by flow id, all other events by their position in the ring.
+ *
+ * @param s
+ *   The pointer of  stage instance.
+ *
+ * @param hybrid
+ *    Distribute events by their schedule type or not.
+ */
+void
+opdl_stage_set_hybrid(struct opdl_stage *s, bool hybrid);
+
 /**
  * Prints information on opdl_ring instance and all its stages
  *
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <errno.h>
 #include <unistd.h>
 #include <sys/queue.h>
@@ -148,7 +149,9 @@ create_queues_type(struct test *t, int num_qids, enum queue_type flags)
 	const struct rte_event_queue_conf conf = {
 		.event_queue_cfg =
 		(flags == OPDL_Q_TYPE_SINGLE_LINK ?
-		 RTE_EVENT_QUEUE_CFG_SINGLE_LINK : 0),
+		 RTE_EVENT_QUEUE_CFG_SINGLE_LINK :
+		 flags == OPDL_Q_TYPE_HYBRID ?
+		 RTE_EVENT_QUEUE_CFG_ALL_TYPES : 0),
 		.schedule_type = type,
 		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
 		.nb_atomic_flows = 1024,
@@ -753,6 +756,452 @@ single_link(struct test *t)
 }
 
 
+#define HYBRID_NUM_EVENTS 6
+
+static int
+hybrid_basic(struct test *t)
+{
+	const uint8_t rx_port = 0;
+	const uint8_t w1_port = 1;
+	const uint8_t w2_port = 2;
+	const uint8_t w3_port = 3;
+	const uint8_t tx_port = 4;
+	/* Ordered events are spread by position, atomic ones by flow */
+	const uint32_t expected[] = {[w1_port] = 1, [w2_port] = 4,
+				     [w3_port] = 1};
+	struct rte_event deq_ev[w3_port + 1][HYBRID_NUM_EVENTS];
+	uint32_t deq_pkts[w3_port + 1];
+	struct rte_event ev[HYBRID_NUM_EVENTS];
+	uint32_t i, j;
+	int err;
+
+	/* Create instance with 5 ports */
+	if (init(t, 2, tx_port+1) < 0 ||
+	    create_ports(t, tx_port+1) < 0 ||
+	    create_queues_type(t, 1, OPDL_Q_TYPE_HYBRID) < 0 ||
+	    create_queues_type(t, 1, OPDL_Q_TYPE_ORDERED) < 0) {
+		PMD_DRV_LOG(ERR, "%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	/*
+	 * Simplified test setup diagram:
+	 *
+	 * rx_port        w1_port
+	 *        \     /         \
+	 *         qid0 - w2_port - qid1
+	 *   (all types)\         /     \
+	 *                w3_port        tx_port
+	 */
+	for (i = w1_port; i <= w3_port; i++) {
+		err = rte_event_port_link(evdev, t->port[i], &t->qid[0], NULL,
+				1);
+		if (err != 1) {
+			PMD_DRV_LOG(ERR, "%d: error mapping lb qid\n",
+					__LINE__);
+			cleanup(t);
+			return -1;
+		}
+	}
+
+	err = rte_event_port_link(evdev, t->port[tx_port], &t->qid[1], NULL,
+			1);
+	if (err != 1) {
+		PMD_DRV_LOG(ERR, "%d: error mapping TX  qid\n", __LINE__);
+		cleanup(t);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		PMD_DRV_LOG(ERR, "%d: Error with start call\n", __LINE__);
+		cleanup(t);
+		return -1;
+	}
+
+	/* Alternate ordered and atomic events, all atomic ones on flow 1 */
+	memset(ev, 0, sizeof(ev));
+	for (i = 0; i < HYBRID_NUM_EVENTS; i++) {
+		ev[i].queue_id = t->qid[0];
+		ev[i].op = RTE_EVENT_OP_NEW;
+		ev[i].sched_type = (i & 1) ? RTE_SCHED_TYPE_ATOMIC :
+					     RTE_SCHED_TYPE_ORDERED;
+		ev[i].flow_id = (i & 1) ? 1 : i;
+		ev[i].u64 = i;
+	}
+
+	err = rte_event_enqueue_burst(evdev, t->port[rx_port], ev,
+			HYBRID_NUM_EVENTS);
+	if (err != HYBRID_NUM_EVENTS) {
+		PMD_DRV_LOG(ERR, "%d: Failed to enqueue, retval = %d\n",
+				__LINE__, err);
+		cleanup(t);
+		return -1;
+	}
+
+	for (i = w1_port; i <= w3_port; i++) {
+		deq_pkts[i] = rte_event_dequeue_burst(evdev, t->port[i],
+				deq_ev[i], HYBRID_NUM_EVENTS, 0);
+		if (deq_pkts[i] != expected[i]) {
+			PMD_DRV_LOG(ERR, "%d: port %u dequeued %u events, expected %u\n",
+					__LINE__, i, deq_pkts[i], expected[i]);
+			rte_event_dev_dump(evdev, stdout);
+			cleanup(t);
+			return -1;
+		}
+
+		/* All atomic events of the flow go to the same port */
+		for (j = 0; j < deq_pkts[i]; j++) {
+			if (deq_ev[i][j].sched_type == RTE_SCHED_TYPE_ATOMIC &&
+					i != w2_port) {
+				PMD_DRV_LOG(ERR, "%d: atomic event %"PRIu64" on port %u\n",
+						__LINE__, deq_ev[i][j].u64, i);
+				cleanup(t);
+				return -1;
+			}
+		}
+	}
+
+	/* Forward in reverse port order */
+	for (i = w3_port; i >= w1_port; i--) {
+		for (j = 0; j < deq_pkts[i]; j++) {
+			deq_ev[i][j].op = RTE_EVENT_OP_FORWARD;
+			deq_ev[i][j].queue_id = t->qid[1];
+		}
+
+		err = rte_event_enqueue_burst(evdev, t->port[i], deq_ev[i],
+				deq_pkts[i]);
+		if (err != (int)deq_pkts[i]) {
+			PMD_DRV_LOG(ERR, "%d: Failed to enqueue\n", __LINE__);
+			cleanup(t);
+			return -1;
+		}
+	}
+
+	/* All events reach the tx port, in their original order */
+	err = rte_event_dequeue_burst(evdev, t->port[tx_port], ev,
+			HYBRID_NUM_EVENTS, 0);
+	if (err != HYBRID_NUM_EVENTS) {
+		PMD_DRV_LOG(ERR, "%d: expected %u pkts at tx port got %d\n",
+				__LINE__, HYBRID_NUM_EVENTS, err);
+		rte_event_dev_dump(evdev, stdout);
+		cleanup(t);
+		return -1;
+	}
+
+	for (i = 0; i < HYBRID_NUM_EVENTS; i++) {
+		if (ev[i].u64 != i) {
+			PMD_DRV_LOG(ERR, "%d: event %"PRIu64" out of order at %u\n",
+					__LINE__, ev[i].u64, i);
+			cleanup(t);
+			return -1;
+		}
+	}
+
+	cleanup(t);
+
+	return 0;
+}
+
+#define RELINK_RX_PORT 0
+#define RELINK_W1_PORT 1
+#define RELINK_W2_PORT 2
+#define RELINK_W3_PORT 3
+#define RELINK_W4_PORT 4
+#define RELINK_TX_PORT 5
+#define RELINK_SPARE_PORT 6
+#define RELINK_NUM_PORTS 7
+#define RELINK_BURST 32
+#define RELINK_NUM_EVENTS (1 << 14)
+#define RELINK_MAX_POLLS (1 << 20)
+
+struct relink_state {
+	/* Sequence number of the next event injected at the rx port */
+	uint64_t next_seq;
+	/* Sequence number of the next event expected at the tx port */
+	uint64_t tx_seq;
+	/* Events forwarded by each port */
+	uint64_t processed[RELINK_NUM_PORTS];
+};
+
+/* Forward the events dequeued from a worker port to the next queue */
+static int
+relink_worker(struct test *t, struct relink_state *s, uint8_t port)
+{
+	struct rte_event ev[RELINK_BURST];
+	uint16_t nb, i;
+
+	nb = rte_event_dequeue_burst(evdev, t->port[port], ev, RELINK_BURST,
+			0);
+	if (nb == 0)
+		return 0;
+
+	for (i = 0; i < nb; i++) {
+		ev[i].queue_id = ev[0].queue_id + 1;
+		ev[i].op = RTE_EVENT_OP_FORWARD;
+	}
+
+	if (rte_event_enqueue_burst(evdev, t->port[port], ev, nb) != nb) {
+		PMD_DRV_LOG(ERR, "%d: port %u failed to forward\n",
+				__LINE__, port);
+		return -1;
+	}
+
+	s->processed[port] += nb;
+
+	return 0;
+}
+
+/* Inject a burst of events numbered in sequence at the rx port */
+static void
+relink_inject(struct test *t, struct relink_state *s, uint16_t nb)
+{
+	struct rte_event ev[RELINK_BURST];
+	uint16_t i;
+
+	memset(ev, 0, sizeof(ev));
+	for (i = 0; i < nb; i++) {
+		ev[i].queue_id = t->qid[0];
+		ev[i].op = RTE_EVENT_OP_NEW;
+		ev[i].sched_type = (i & 1) ? RTE_SCHED_TYPE_ATOMIC :
+					     RTE_SCHED_TYPE_ORDERED;
+		ev[i].flow_id = s->next_seq + i;
+		ev[i].u64 = s->next_seq + i;
+	}
+
+	s->next_seq += rte_event_enqueue_burst(evdev, t->port[RELINK_RX_PORT],
+			ev, nb);
+}
+
+/* Inject events, and poll every port until all of them, and those already in
+ * flight, got through the pipeline in order.
+ */
+static int
+relink_pump(struct test *t, struct relink_state *s, uint32_t nb_events)
+{
+	uint64_t target = s->next_seq + nb_events;
+	struct rte_event ev[RELINK_BURST];
+	uint32_t polls = 0;
+	uint16_t nb, i;
+	uint8_t port;
+
+	while (s->tx_seq < target) {
+		if (s->next_seq < target)
+			relink_inject(t, s, RTE_MIN(target - s->next_seq,
+						    (uint64_t)RELINK_BURST));
+
+		for (port = RELINK_W1_PORT; port < RELINK_NUM_PORTS; port++) {
+			if (port == RELINK_TX_PORT)
+				continue;
+			if (relink_worker(t, s, port) < 0)
+				return -1;
+		}
+
+		nb = rte_event_dequeue_burst(evdev, t->port[RELINK_TX_PORT],
+				ev, RELINK_BURST, 0);
+		for (i = 0; i < nb; i++) {
+			if (ev[i].u64 != s->tx_seq) {
+				PMD_DRV_LOG(ERR, "%d: got event %"PRIu64" at tx port, expected %"PRIu64"\n",
+						__LINE__, ev[i].u64, s->tx_seq);
+				return -1;
+			}
+			s->tx_seq++;
+		}
+
+		if (++polls == RELINK_MAX_POLLS) {
+			PMD_DRV_LOG(ERR, "%d: pipeline stalled at event %"PRIu64"\n",
+					__LINE__, s->tx_seq);
+			rte_event_dev_dump(evdev, stdout);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* Poll a port until the queue it was unlinked from has been handed over */
+static int
+relink_handover(struct test *t, struct relink_state *s, uint8_t port,
+		uint32_t *polls)
+{
+	*polls = 0;
+
+	while (rte_event_port_unlinks_in_progress(evdev, t->port[port]) > 0) {
+		if (relink_worker(t, s, port) < 0)
+			return -1;
+		if (++(*polls) == RELINK_MAX_POLLS) {
+			PMD_DRV_LOG(ERR, "%d: port %u never released its queue\n",
+					__LINE__, port);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+runtime_relink(struct test *t)
+{
+	struct relink_state s = {0};
+	uint64_t start, base_cycles, unlink_cycles, link_cycles;
+	uint64_t handover_cycles, relinked_cycles;
+	uint64_t w3_processed, w4_processed;
+	uint32_t handover_polls, polls;
+	uint8_t q_id;
+	int err = 0;
+	int ret;
+
+	/* Create instance with 7 ports */
+	if (init(t, 3, RELINK_NUM_PORTS) < 0 ||
+	    create_ports(t, RELINK_NUM_PORTS) < 0 ||
+	    create_queues_type(t, 1, OPDL_Q_TYPE_ORDERED) < 0 ||
+	    create_queues_type(t, 1, OPDL_Q_TYPE_HYBRID) < 0 ||
+	    create_queues_type(t, 1, OPDL_Q_TYPE_ORDERED) < 0) {
+		PMD_DRV_LOG(ERR, "%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	/*
+	 * Simplified test setup diagram, the spare port starts as a second
+	 * rx port:
+	 *
+	 *                 w1_port
+	 *                /       \
+	 * rx_port - qid0 - w2_port - qid1 - w4_port - qid2 - tx_port
+	 *                \       /
+	 *                 w3_port
+	 */
+	for (q_id = 0; q_id < 3; q_id++) {
+		static const uint8_t first[] = {RELINK_W1_PORT, RELINK_W4_PORT,
+						RELINK_TX_PORT};
+		static const uint8_t last[] = {RELINK_W3_PORT, RELINK_W4_PORT,
+					       RELINK_TX_PORT};
+		uint8_t port;
+
+		for (port = first[q_id]; port <= last[q_id]; port++) {
+			if (rte_event_port_link(evdev, t->port[port],
+						&t->qid[q_id], NULL, 1) != 1) {
+				PMD_DRV_LOG(ERR, "%d: error linking port %u\n",
+						__LINE__, port);
+				cleanup(t);
+				return -1;
+			}
+		}
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		PMD_DRV_LOG(ERR, "%d: Error with start call\n", __LINE__);
+		cleanup(t);
+		return -1;
+	}
+
+	start = rte_rdtsc();
+	err = relink_pump(t, &s, RELINK_NUM_EVENTS);
+	base_cycles = rte_rdtsc() - start;
+
+	/* The tx queue and the last port of a worker queue stay put */
+	if (!err &&
+	    (rte_event_port_link(evdev, t->port[RELINK_SPARE_PORT],
+				 &t->qid[2], NULL, 1) != 0 ||
+	     rte_event_port_unlink(evdev, t->port[RELINK_W4_PORT],
+				   &t->qid[1], 1) != 0)) {
+		PMD_DRV_LOG(ERR, "%d: invalid relink DID NOT fail\n",
+				__LINE__);
+		err = -1;
+	}
+
+	/* Scale qid0 down, with events in flight */
+	if (!err) {
+		relink_inject(t, &s, RELINK_BURST);
+		relink_inject(t, &s, RELINK_BURST);
+
+		start = rte_rdtsc();
+		ret = rte_event_port_unlink(evdev, t->port[RELINK_W3_PORT],
+				&t->qid[0], 1);
+		unlink_cycles = rte_rdtsc() - start;
+		if (ret != 1 || rte_event_port_unlinks_in_progress(evdev,
+					t->port[RELINK_W3_PORT]) != 1) {
+			PMD_DRV_LOG(ERR, "%d: error unlinking port %u\n",
+					__LINE__, RELINK_W3_PORT);
+			err = -1;
+		}
+	}
+
+	if (!err) {
+		start = rte_rdtsc();
+		err = relink_handover(t, &s, RELINK_W3_PORT, &handover_polls);
+		handover_cycles = rte_rdtsc() - start;
+	}
+
+	/* Scale it back up with the spare port, and move w3 to qid1 */
+	if (!err) {
+		start = rte_rdtsc();
+		ret = rte_event_port_link(evdev, t->port[RELINK_SPARE_PORT],
+				&t->qid[0], NULL, 1);
+		link_cycles = rte_rdtsc() - start;
+		if (ret != 1 || rte_event_port_link(evdev,
+					t->port[RELINK_W3_PORT], &t->qid[1],
+					NULL, 1) != 1) {
+			PMD_DRV_LOG(ERR, "%d: error relinking ports\n",
+					__LINE__);
+			err = -1;
+		}
+	}
+
+	if (!err) {
+		w3_processed = s.processed[RELINK_W3_PORT];
+		start = rte_rdtsc();
+		err = relink_pump(t, &s, RELINK_NUM_EVENTS);
+		relinked_cycles = rte_rdtsc() - start;
+	}
+
+	if (!err && s.processed[RELINK_SPARE_PORT] == 0) {
+		PMD_DRV_LOG(ERR, "%d: spare port processed no events\n",
+				__LINE__);
+		err = -1;
+	}
+
+	/* Hand all of qid1 over to w3 */
+	if (!err) {
+		if (rte_event_port_unlink(evdev, t->port[RELINK_W4_PORT],
+					&t->qid[1], 1) != 1) {
+			PMD_DRV_LOG(ERR, "%d: error unlinking port %u\n",
+					__LINE__, RELINK_W4_PORT);
+			err = -1;
+		}
+	}
+
+	if (!err)
+		err = relink_handover(t, &s, RELINK_W4_PORT, &polls);
+
+	if (!err) {
+		w4_processed = s.processed[RELINK_W4_PORT];
+		w3_processed = s.processed[RELINK_W3_PORT];
+		err = relink_pump(t, &s, RELINK_NUM_EVENTS);
+	}
+
+	if (!err && (s.processed[RELINK_W4_PORT] != w4_processed ||
+		     s.processed[RELINK_W3_PORT] - w3_processed !=
+				RELINK_NUM_EVENTS)) {
+		PMD_DRV_LOG(ERR, "%d: qid1 not handed over to port %u\n",
+				__LINE__, RELINK_W3_PORT);
+		err = -1;
+	}
+
+	if (!err)
+		printf("Runtime relink: %"PRIu64" cycles/event before, "
+		       "%"PRIu64" after; unlink %"PRIu64" cycles, "
+		       "link %"PRIu64" cycles, handover %u polls in "
+		       "%"PRIu64" cycles\n",
+		       base_cycles / RELINK_NUM_EVENTS,
+		       relinked_cycles / RELINK_NUM_EVENTS,
+		       unlink_cycles, link_cycles, handover_polls,
+		       handover_cycles);
+
+	cleanup(t);
+
+	return err;
+}
+
 static __rte_always_inline void
 populate_event_burst(struct rte_event ev[],
 		     uint8_t qid,
@@ -1035,6 +1484,12 @@ opdl_selftest(void)
 	ret = atomic_basic(t);
 
 
+	PMD_DRV_LOG(ERR, "*** Running Hybrid Basic test...\n");
+	ret = hybrid_basic(t);
+
+	PMD_DRV_LOG(ERR, "*** Running Runtime Relink test...\n");
+	ret = runtime_relink(t);
+
 	PMD_DRV_LOG(ERR, "*** Running QID  Basic test...\n");
 	ret = qid_basic(t);
 
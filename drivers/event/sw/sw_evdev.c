@@ -9,6 +9,7 @@
 #include <rte_kvargs.h>
 #include <rte_ring.h>
 #include <rte_errno.h>
+#include <rte_string_fns.h>
 #include <rte_event_ring.h>
 #include <rte_service_component.h>
 
@@ -19,10 +20,15 @@
 #define NUMA_NODE_ARG "numa_node"
 #define SCHED_QUANTA_ARG "sched_quanta"
 #define CREDIT_QUANTA_ARG "credit_quanta"
+#define SCHED_SHARDS_ARG "sched_shards"
+#define MAX_INFLIGHT_ARG "max_inflight"
 
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info);
 
+static void
+sw_port_release(void *port);
+
 static int
 sw_port_link(struct rte_eventdev *dev, void *port, const uint8_t queues[],
 		const uint8_t priorities[], uint16_t num)
@@ -114,7 +120,8 @@ sw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
 		}
 	}
 
-	p->unlinks_in_progress += unlinked;
+	for (i = 0; i < sw->sched_shards; i++)
+		p->unlinks_in_progress[i] += unlinked;
 	rte_smp_mb();
 
 	return unlinked;
@@ -123,9 +130,16 @@ sw_port_unlink(struct rte_eventdev *dev, void *port, uint8_t queues[],
 static int
 sw_port_unlinks_in_progress(struct rte_eventdev *dev, void *port)
 {
-	RTE_SET_USED(dev);
+	struct sw_evdev *sw = sw_pmd_priv(dev);
 	struct sw_port *p = port;
-	return p->unlinks_in_progress;
+	int unlinks = 0;
+	unsigned int i;
+
+	/* unlinks are in progress until all shards have acked them */
+	for (i = 0; i < sw->sched_shards; i++)
+		unlinks = RTE_MAX(unlinks, p->unlinks_in_progress[i]);
+
+	return unlinks;
 }
 
 static int
@@ -135,7 +149,8 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	struct sw_port *p = &sw->ports[port_id];
 	char buf[RTE_RING_NAMESIZE];
-	unsigned int i;
+	unsigned int cq_flags;
+	unsigned int i, j;
 
 	struct rte_event_dev_info info;
 	sw_info_get(dev, &info);
@@ -147,13 +162,17 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		 * available in the port (p->inflight_credits). We must return
 		 * the sum to no leak credits
 		 */
-		int possible_inflights = p->inflight_credits + p->inflights;
+		int possible_inflights = p->inflight_credits;
+		for (i = 0; i < sw->sched_shards; i++)
+			possible_inflights +=
+				sw->shards[i].ports[port_id].inflights;
 		rte_atomic32_sub(&sw->inflights, possible_inflights);
 	}
 
 	*p = (struct sw_port){0}; /* zero entire structure */
 	p->id = port_id;
 	p->sw = sw;
+	p->home_shard = port_id % sw->sched_shards;
 
 	/* check to see if rings exists - port_setup() can be called multiple
 	 * times legally (assuming device is stopped). If ring exists, free it
@@ -184,21 +203,55 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	if (existing_ring)
 		rte_event_ring_free(existing_ring);
 
+	/* all scheduler shards push events to the CQ */
+	cq_flags = RING_F_SC_DEQ | RING_F_EXACT_SZ;
+	if (sw->sched_shards == 1)
+		cq_flags |= RING_F_SP_ENQ;
+
 	p->cq_worker_ring = rte_event_ring_create(buf, conf->dequeue_depth,
-			dev->data->socket_id,
-			RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ);
+			dev->data->socket_id, cq_flags);
 	if (p->cq_worker_ring == NULL) {
 		rte_event_ring_free(p->rx_worker_ring);
 		SW_LOG_ERR("Error creating CQ worker ring for port %d\n",
 				port_id);
 		return -1;
 	}
-	sw->cq_ring_space[port_id] = conf->dequeue_depth;
 
-	/* set hist list contents to empty */
-	for (i = 0; i < SW_PORT_HIST_LIST; i++) {
-		p->hist_list[i].fid = -1;
-		p->hist_list[i].qid = -1;
+	for (i = 0; i < sw->sched_shards; i++) {
+		struct sw_sched_shard *shard = &sw->shards[i];
+		struct sw_shard_port *sp = &shard->ports[port_id];
+
+		rte_event_ring_free(sp->cmpl_ring);
+		memset(sp, 0, sizeof(*sp));
+		shard->cq_ring_space[port_id] = conf->dequeue_depth;
+
+		/* set hist list contents to empty */
+		sp->hist_list = &sw->hist_lists[(port_id * sw->sched_shards +
+				i) * shard->hist_size];
+		for (j = 0; j < shard->hist_size; j++) {
+			sp->hist_list[j].fid = -1;
+			sp->hist_list[j].qid = -1;
+		}
+
+		if (i == p->home_shard)
+			continue;
+
+		/* completions routed to this shard by the home shard */
+		snprintf(buf, sizeof(buf), "sw%d_p%u_s%u_cmpl",
+				dev->data->dev_id, port_id, i);
+		existing_ring = rte_event_ring_lookup(buf);
+		if (existing_ring)
+			rte_event_ring_free(existing_ring);
+
+		sp->cmpl_ring = rte_event_ring_create(buf, SW_SHARD_RING_SIZE,
+				dev->data->socket_id,
+				RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (sp->cmpl_ring == NULL) {
+			SW_LOG_ERR("Error creating completion ring for port %d\n",
+					port_id);
+			sw_port_release(p);
+			return -1;
+		}
 	}
 	dev->data->ports[port_id] = p;
 
@@ -211,9 +264,18 @@ static void
 sw_port_release(void *port)
 {
 	struct sw_port *p = (void *)port;
+	unsigned int i;
+
 	if (p == NULL)
 		return;
 
+	for (i = 0; p->sw != NULL && i < p->sw->sched_shards; i++) {
+		struct sw_shard_port *sp = &p->sw->shards[i].ports[p->id];
+
+		rte_event_ring_free(sp->cmpl_ring);
+		sp->cmpl_ring = NULL;
+	}
+
 	rte_event_ring_free(p->rx_worker_ring);
 	rte_event_ring_free(p->cq_worker_ring);
 	memset(p, 0, sizeof(*p));
@@ -237,6 +299,7 @@ qid_init(struct sw_evdev *sw, unsigned int idx, int type,
 	qid->id = idx;
 	qid->type = type;
 	qid->priority = queue_conf->priority;
+	qid->shard = idx % sw->sched_shards;
 
 	if (qid->type == RTE_SCHED_TYPE_ORDERED) {
 		char ring_name[RTE_RING_NAMESIZE];
@@ -369,7 +432,7 @@ sw_init_qid_iqs(struct sw_evdev *sw)
 			continue;
 
 		for (j = 0; j < SW_IQS_MAX; j++)
-			iq_init(sw, &qid->iq[j]);
+			iq_init(&sw->shards[qid->shard], &qid->iq[j]);
 	}
 }
 
@@ -385,18 +448,41 @@ sw_qids_empty(struct sw_evdev *sw)
 		}
 	}
 
+	/* events handed over to the shard owning their QID */
+	for (i = 0; i < sw->sched_shards; i++) {
+		for (j = 0; j < sw->sched_shards; j++) {
+			struct rte_event_ring *r = sw->shards[i].in_rings[j];
+
+			if (r != NULL && rte_event_ring_count(r))
+				return 0;
+		}
+	}
+
 	return 1;
 }
 
 static int
 sw_ports_empty(struct sw_evdev *sw)
 {
-	unsigned int i;
+	unsigned int i, s;
 
 	for (i = 0; i < sw->port_count; i++) {
 		if ((rte_event_ring_count(sw->ports[i].rx_worker_ring)) ||
-		     rte_event_ring_count(sw->ports[i].cq_worker_ring))
+		     rte_event_ring_count(sw->ports[i].cq_worker_ring) ||
+		     sw->ports[i].pp_buf_count)
 			return 0;
+
+		/* completions waiting for the shard that scheduled them, and
+		 * events buffered by a shard for the CQ
+		 */
+		for (s = 0; s < sw->sched_shards; s++) {
+			struct sw_shard_port *p = &sw->shards[s].ports[i];
+
+			if (p->cq_buf_count || p->pp_buf_count ||
+			    (p->cmpl_ring != NULL &&
+			     rte_event_ring_count(p->cmpl_ring)))
+				return 0;
+		}
 	}
 
 	return 1;
@@ -429,9 +515,9 @@ sw_drain_ports(struct rte_eventdev *dev)
 }
 
 static void
-sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
+sw_drain_queue(struct rte_eventdev *dev, struct sw_sched_shard *shard,
+		struct sw_iq *iq)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
 	eventdev_stop_flush_t flush;
 	uint8_t dev_id;
 	void *arg;
@@ -443,7 +529,7 @@ sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
 	while (iq_count(iq) > 0) {
 		struct rte_event ev;
 
-		iq_dequeue_burst(sw, iq, &ev, 1);
+		iq_dequeue_burst(shard, iq, &ev, 1);
 
 		if (flush)
 			flush(dev_id, ev, arg);
@@ -457,8 +543,11 @@ sw_drain_queues(struct rte_eventdev *dev)
 	unsigned int i, j;
 
 	for (i = 0; i < sw->qid_count; i++) {
+		struct sw_qid *qid = &sw->qids[i];
+
 		for (j = 0; j < SW_IQS_MAX; j++)
-			sw_drain_queue(dev, &sw->qids[i].iq[j]);
+			sw_drain_queue(dev, &sw->shards[qid->shard],
+					&qid->iq[j]);
 	}
 }
 
@@ -475,7 +564,8 @@ sw_clean_qid_iqs(struct rte_eventdev *dev)
 		for (j = 0; j < SW_IQS_MAX; j++) {
 			if (!qid->iq[j].head)
 				continue;
-			iq_free_chunk_list(sw, qid->iq[j].head);
+			iq_free_chunk_list(&sw->shards[qid->shard],
+					qid->iq[j].head);
 			qid->iq[j].head = NULL;
 		}
 	}
@@ -517,35 +607,73 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	const struct rte_eventdev_data *data = dev->data;
 	const struct rte_event_dev_config *conf = &data->dev_conf;
+	char buf[RTE_RING_NAMESIZE];
 	int num_chunks, i;
+	unsigned int s, j;
 
 	sw->qid_count = conf->nb_event_queues;
 	sw->port_count = conf->nb_event_ports;
 	sw->nb_events_limit = conf->nb_events_limit;
 	rte_atomic32_set(&sw->inflights, 0);
 
-	/* Number of chunks sized for worst-case spread of events across IQs */
-	num_chunks = ((SW_INFLIGHT_EVENTS_TOTAL/SW_EVS_PER_Q_CHUNK)+1) +
-			sw->qid_count*SW_IQS_MAX*2;
-
-	/* If this is a reconfiguration, free the previous IQ allocation. All
-	 * IQ chunk references were cleaned out of the QIDs in sw_stop(), and
-	 * will be reinitialized in sw_start().
+	/* Number of chunks sized for worst-case spread of events across IQs,
+	 * which for each shard is all events inflight in its own QIDs.
 	 */
-	if (sw->chunks)
-		rte_free(sw->chunks);
+	num_chunks = ((sw->nb_events_limit/SW_EVS_PER_Q_CHUNK)+1) +
+			((sw->qid_count + sw->sched_shards - 1) /
+			 sw->sched_shards)*SW_IQS_MAX*2;
+
+	if (sw->hist_lists == NULL) {
+		sw->hist_lists = rte_malloc_socket(NULL,
+				sizeof(sw->hist_lists[0]) * SW_PORTS_MAX *
+				SW_PORT_HIST_LIST, 0, sw->data->socket_id);
+		if (sw->hist_lists == NULL)
+			return -ENOMEM;
+	}
 
-	sw->chunks = rte_malloc_socket(NULL,
-				       sizeof(struct sw_queue_chunk) *
-				       num_chunks,
-				       0,
-				       sw->data->socket_id);
-	if (!sw->chunks)
-		return -ENOMEM;
+	for (s = 0; s < sw->sched_shards; s++) {
+		struct sw_sched_shard *shard = &sw->shards[s];
+
+		/* If this is a reconfiguration, free the previous IQ
+		 * allocation. All IQ chunk references were cleaned out of the
+		 * QIDs in sw_stop(), and will be reinitialized in sw_start().
+		 */
+		if (shard->chunks)
+			rte_free(shard->chunks);
+
+		shard->chunks = rte_malloc_socket(NULL,
+					       sizeof(struct sw_queue_chunk) *
+					       num_chunks,
+					       0,
+					       sw->data->socket_id);
+		if (!shard->chunks)
+			return -ENOMEM;
+
+		shard->chunk_list_head = NULL;
+		for (i = 0; i < num_chunks; i++)
+			iq_free_chunk(shard, &shard->chunks[i]);
+
+		/* each shard gets an equal share of the port history */
+		shard->hist_size = SW_PORT_HIST_LIST / sw->sched_shards;
+
+		for (j = 0; j < sw->sched_shards; j++) {
+			if (j == s)
+				continue;
 
-	sw->chunk_list_head = NULL;
-	for (i = 0; i < num_chunks; i++)
-		iq_free_chunk(sw, &sw->chunks[i]);
+			snprintf(buf, sizeof(buf), "sw%d_s%u_in%u",
+					data->dev_id, s, j);
+			shard->in_rings[j] = rte_event_ring_lookup(buf);
+			if (shard->in_rings[j] != NULL)
+				rte_event_ring_free(shard->in_rings[j]);
+
+			shard->in_rings[j] = rte_event_ring_create(buf,
+					SW_SHARD_RING_SIZE,
+					sw->data->socket_id,
+					RING_F_SP_ENQ | RING_F_SC_DEQ);
+			if (shard->in_rings[j] == NULL)
+				return -ENOMEM;
+		}
+	}
 
 	if (conf->event_dev_cfg & RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT)
 		return -ENOTSUP;
@@ -596,7 +724,7 @@ sw_crypto_adapter_caps_get(const struct rte_eventdev *dev,
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
 {
-	RTE_SET_USED(dev);
+	const struct sw_evdev *sw = sw_pmd_priv_const(dev);
 
 	static const struct rte_event_dev_info evdev_sw_info = {
 			.driver_name = SW_PMD_NAME,
@@ -607,7 +735,7 @@ sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
 			.max_event_ports = SW_PORTS_MAX,
 			.max_event_port_dequeue_depth = MAX_SW_CONS_Q_DEPTH,
 			.max_event_port_enqueue_depth = MAX_SW_PROD_Q_DEPTH,
-			.max_num_events = SW_INFLIGHT_EVENTS_TOTAL,
+			.max_num_events = SW_DEFAULT_INFLIGHT_EVENTS,
 			.event_dev_cap = (
 				RTE_EVENT_DEV_CAP_QUEUE_QOS |
 				RTE_EVENT_DEV_CAP_BURST_MODE |
@@ -619,6 +747,7 @@ sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
 	};
 
 	*info = evdev_sw_info;
+	info->max_num_events = sw->max_inflight;
 }
 
 static void
@@ -629,16 +758,28 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	static const char * const q_type_strings[] = {
 			"Ordered", "Atomic", "Parallel", "Directed"
 	};
-	uint32_t i;
-	fprintf(f, "EventDev %s: ports %d, qids %d\n", "todo-fix-name",
-			sw->port_count, sw->qid_count);
-
-	fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64"\n",
-		sw->stats.rx_pkts, sw->stats.rx_dropped, sw->stats.tx_pkts);
-	fprintf(f, "\tsched calls: %"PRIu64"\n", sw->sched_called);
-	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n", sw->sched_cq_qid_called);
-	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n", sw->sched_no_iq_enqueues);
-	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n", sw->sched_no_cq_enqueues);
+	uint32_t i, s;
+	fprintf(f, "EventDev %s: ports %d, qids %d, shards %d\n",
+			"todo-fix-name", sw->port_count, sw->qid_count,
+			sw->sched_shards);
+
+	for (s = 0; s < sw->sched_shards; s++) {
+		const struct sw_sched_shard *shard = &sw->shards[s];
+
+		fprintf(f, "  Shard %d (%s)\n", s, shard->service_name);
+		fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64
+			"\n", shard->stats.rx_pkts, shard->stats.rx_dropped,
+			shard->stats.tx_pkts);
+		fprintf(f, "\tsched calls: %"PRIu64"\n", shard->sched_called);
+		fprintf(f, "\tsched cq/qid call: %"PRIu64"\n",
+				shard->sched_cq_qid_called);
+		fprintf(f, "\tsched no IQ enq: %"PRIu64"\n",
+				shard->sched_no_iq_enqueues);
+		fprintf(f, "\tsched no CQ enq: %"PRIu64"\n",
+				shard->sched_no_cq_enqueues);
+		fprintf(f, "\tsched handoffs: %"PRIu64"\n",
+				shard->sched_handoffs);
+	}
 	uint32_t inflights = rte_atomic32_read(&sw->inflights);
 	uint32_t credits = sw->nb_events_limit - inflights;
 	fprintf(f, "\tinflight %d, credits: %d\n", inflights, credits);
@@ -649,20 +790,25 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	for (i = 0; i < sw->port_count; i++) {
 		int max, j;
 		const struct sw_port *p = &sw->ports[i];
+		uint64_t tx_pkts = 0;
+		uint32_t port_inflights = 0;
 		if (!p->initialized) {
 			fprintf(f, "  %sPort %d not initialized.%s\n",
 				COL_RED, i, COL_RESET);
 			continue;
 		}
+		for (s = 0; s < sw->sched_shards; s++) {
+			tx_pkts += sw->shards[s].ports[i].tx_pkts;
+			port_inflights += sw->shards[s].ports[i].inflights;
+		}
 		fprintf(f, "  Port %d %s\n", i,
 			p->is_directed ? " (SingleCons)" : "");
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64
 			"\t%sinflight %d%s\n", sw->ports[i].stats.rx_pkts,
-			sw->ports[i].stats.rx_dropped,
-			sw->ports[i].stats.tx_pkts,
-			(p->inflights == p->inflight_max) ?
+			sw->ports[i].stats.rx_dropped, tx_pkts,
+			(port_inflights == p->inflight_max) ?
 				COL_RED : COL_RESET,
-			sw->ports[i].inflights, COL_RESET);
+			port_inflights, COL_RESET);
 
 		fprintf(f, "\tMax New: %u"
 			"\tAvg cycles PP: %"PRIu64"\tCredits: %u\n",
@@ -719,7 +865,8 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 		int affinities_per_port[SW_PORTS_MAX] = {0};
 		uint32_t inflights = 0;
 
-		fprintf(f, "  Queue %d (%s)\n", i, q_type_strings[qid->type]);
+		fprintf(f, "  Queue %d (%s), shard %d\n", i,
+				q_type_strings[qid->type], qid->shard);
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64"\n",
 			qid->stats.rx_pkts, qid->stats.rx_dropped,
 			qid->stats.tx_pkts);
@@ -773,16 +920,20 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 static int
 sw_start(struct rte_eventdev *dev)
 {
-	unsigned int i, j;
+	unsigned int i, j, s;
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 
-	rte_service_component_runstate_set(sw->service_id, 1);
+	for (s = 0; s < sw->sched_shards; s++) {
+		struct sw_sched_shard *shard = &sw->shards[s];
+
+		rte_service_component_runstate_set(shard->service_id, 1);
 
-	/* check a service core is mapped to this service */
-	if (!rte_service_runstate_get(sw->service_id)) {
-		SW_LOG_ERR("Warning: No Service core enabled on service %s\n",
-				sw->service_name);
-		return -ENOENT;
+		/* check a service core is mapped to this service */
+		if (!rte_service_runstate_get(shard->service_id)) {
+			SW_LOG_ERR("Warning: No Service core enabled on service %s\n",
+					shard->service_name);
+			return -ENOENT;
+		}
 	}
 
 	/* check all ports are set up */
@@ -800,18 +951,21 @@ sw_start(struct rte_eventdev *dev)
 			return -ENOLINK;
 		}
 
-	/* build up our prioritized array of qids */
+	/* build up our prioritized array of qids, for each shard */
 	/* We don't use qsort here, as if all/multiple entries have the same
 	 * priority, the result is non-deterministic. From "man 3 qsort":
 	 * "If two members compare as equal, their order in the sorted
 	 * array is undefined."
 	 */
-	uint32_t qidx = 0;
+	for (s = 0; s < sw->sched_shards; s++)
+		sw->shards[s].qid_count = 0;
 	for (j = 0; j <= RTE_EVENT_DEV_PRIORITY_LOWEST; j++) {
 		for (i = 0; i < sw->qid_count; i++) {
 			if (sw->qids[i].priority == j) {
-				sw->qids_prioritized[qidx] = &sw->qids[i];
-				qidx++;
+				struct sw_sched_shard *shard =
+					&sw->shards[sw->qids[i].shard];
+				shard->qids_prioritized[shard->qid_count++] =
+					&sw->qids[i];
 			}
 		}
 	}
@@ -831,19 +985,25 @@ static void
 sw_stop(struct rte_eventdev *dev)
 {
 	struct sw_evdev *sw = sw_pmd_priv(dev);
-	int32_t runstate;
+	int32_t runstate[SW_SCHED_SHARDS_MAX];
+	unsigned int s;
+
+	/* Stop the schedulers if they're running */
+	for (s = 0; s < sw->sched_shards; s++) {
+		uint32_t service_id = sw->shards[s].service_id;
 
-	/* Stop the scheduler if it's running */
-	runstate = rte_service_runstate_get(sw->service_id);
-	if (runstate == 1)
-		rte_service_runstate_set(sw->service_id, 0);
+		runstate[s] = rte_service_runstate_get(service_id);
+		if (runstate[s] == 1)
+			rte_service_runstate_set(service_id, 0);
 
-	while (rte_service_may_be_active(sw->service_id))
-		rte_pause();
+		while (rte_service_may_be_active(service_id))
+			rte_pause();
+	}
 
 	/* Flush all events out of the device */
 	while (!(sw_qids_empty(sw) && sw_ports_empty(sw))) {
-		sw_event_schedule(dev);
+		for (s = 0; s < sw->sched_shards; s++)
+			sw_event_schedule(&sw->shards[s]);
 		sw_drain_ports(dev);
 		sw_drain_queues(dev);
 	}
@@ -853,8 +1013,9 @@ sw_stop(struct rte_eventdev *dev)
 	sw->started = 0;
 	rte_smp_wmb();
 
-	if (runstate == 1)
-		rte_service_runstate_set(sw->service_id, 1);
+	for (s = 0; s < sw->sched_shards; s++)
+		if (runstate[s] == 1)
+			rte_service_runstate_set(sw->shards[s].service_id, 1);
 }
 
 static int
@@ -871,11 +1032,29 @@ sw_close(struct rte_eventdev *dev)
 		sw_port_release(&sw->ports[i]);
 	sw->port_count = 0;
 
-	memset(&sw->stats, 0, sizeof(sw->stats));
-	sw->sched_called = 0;
-	sw->sched_no_iq_enqueues = 0;
-	sw->sched_no_cq_enqueues = 0;
-	sw->sched_cq_qid_called = 0;
+	for (i = 0; i < sw->sched_shards; i++) {
+		struct sw_sched_shard *shard = &sw->shards[i];
+		uint32_t j;
+
+		/* release the rings and chunks of sw_dev_configure() */
+		for (j = 0; j < sw->sched_shards; j++) {
+			rte_event_ring_free(shard->in_rings[j]);
+			shard->in_rings[j] = NULL;
+		}
+		rte_free(shard->chunks);
+		shard->chunks = NULL;
+		shard->chunk_list_head = NULL;
+
+		memset(&shard->stats, 0, sizeof(shard->stats));
+		shard->sched_called = 0;
+		shard->sched_no_iq_enqueues = 0;
+		shard->sched_no_cq_enqueues = 0;
+		shard->sched_cq_qid_called = 0;
+		shard->sched_handoffs = 0;
+	}
+
+	rte_free(sw->hist_lists);
+	sw->hist_lists = NULL;
 
 	return 0;
 }
@@ -910,11 +1089,32 @@ set_credit_quanta(const char *key __rte_unused, const char *value, void *opaque)
 	return 0;
 }
 
+static int
+set_sched_shards(const char *key __rte_unused, const char *value, void *opaque)
+{
+	int *shards = opaque;
+	*shards = atoi(value);
+	if (*shards < 1 || *shards > SW_SCHED_SHARDS_MAX ||
+			!rte_is_power_of_2(*shards))
+		return -1;
+	return 0;
+}
+
+static int
+set_max_inflight(const char *key __rte_unused, const char *value, void *opaque)
+{
+	int *max_inflight = opaque;
+	*max_inflight = atoi(value);
+	if (*max_inflight <= 0 || *max_inflight > SW_INFLIGHT_EVENTS_MAX)
+		return -1;
+	return 0;
+}
+
 
 static int32_t sw_sched_service_func(void *args)
 {
-	struct rte_eventdev *dev = args;
-	sw_event_schedule(dev);
+	struct sw_sched_shard *shard = args;
+	sw_event_schedule(shard);
 	return 0;
 }
 
@@ -957,6 +1157,8 @@ sw_probe(struct rte_vdev_device *vdev)
 		NUMA_NODE_ARG,
 		SCHED_QUANTA_ARG,
 		CREDIT_QUANTA_ARG,
+		SCHED_SHARDS_ARG,
+		MAX_INFLIGHT_ARG,
 		NULL
 	};
 	const char *name;
@@ -966,6 +1168,9 @@ sw_probe(struct rte_vdev_device *vdev)
 	int socket_id = rte_socket_id();
 	int sched_quanta  = SW_DEFAULT_SCHED_QUANTA;
 	int credit_quanta = SW_DEFAULT_CREDIT_QUANTA;
+	int sched_shards = SW_DEFAULT_SCHED_SHARDS;
+	int max_inflight = SW_DEFAULT_INFLIGHT_EVENTS;
+	int i;
 
 	name = rte_vdev_device_name(vdev);
 	params = rte_vdev_device_args(vdev);
@@ -1007,13 +1212,34 @@ sw_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, SCHED_SHARDS_ARG,
+					set_sched_shards, &sched_shards);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing sched shards parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
+			ret = rte_kvargs_process(kvlist, MAX_INFLIGHT_ARG,
+					set_max_inflight, &max_inflight);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing max inflight parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
 
 	SW_LOG_INFO(
-			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d\n",
-			name, socket_id, sched_quanta, credit_quanta);
+			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d, sched_shards=%d, max_inflight=%d\n",
+			name, socket_id, sched_quanta, credit_quanta,
+			sched_shards, max_inflight);
 
 	dev = rte_event_pmd_vdev_init(name,
 			sizeof(struct sw_evdev), socket_id);
@@ -1038,25 +1264,44 @@ sw_probe(struct rte_vdev_device *vdev)
 	/* copy values passed from vdev command line to instance */
 	sw->credit_update_quanta = credit_quanta;
 	sw->sched_quanta = sched_quanta;
+	sw->sched_shards = sched_shards;
+	sw->max_inflight = max_inflight;
 
-	/* register service with EAL */
-	struct rte_service_spec service;
-	memset(&service, 0, sizeof(struct rte_service_spec));
-	snprintf(service.name, sizeof(service.name), "%s_service", name);
-	snprintf(sw->service_name, sizeof(sw->service_name), "%s_service",
-			name);
-	service.socket_id = socket_id;
-	service.callback = sw_sched_service_func;
-	service.callback_userdata = (void *)dev;
-
-	int32_t ret = rte_service_component_register(&service, &sw->service_id);
-	if (ret) {
-		SW_LOG_ERR("service register() failed");
-		return -ENOEXEC;
+	/* register a service with EAL for each scheduler shard. The first
+	 * one is the eventdev service, the others are named after it.
+	 */
+	for (i = 0; i < sched_shards; i++) {
+		struct sw_sched_shard *shard = &sw->shards[i];
+		struct rte_service_spec service;
+
+		shard->sw = sw;
+		shard->id = i;
+
+		memset(&service, 0, sizeof(struct rte_service_spec));
+		if (i == 0)
+			snprintf(shard->service_name,
+					sizeof(shard->service_name),
+					"%s_service", name);
+		else
+			snprintf(shard->service_name,
+					sizeof(shard->service_name),
+					"%s_service_%d", name, i);
+		strlcpy(service.name, shard->service_name,
+				sizeof(service.name));
+		service.socket_id = socket_id;
+		service.callback = sw_sched_service_func;
+		service.callback_userdata = (void *)shard;
+
+		int32_t ret = rte_service_component_register(&service,
+				&shard->service_id);
+		if (ret) {
+			SW_LOG_ERR("service register() failed");
+			return -ENOEXEC;
+		}
 	}
 
 	dev->data->service_inited = 1;
-	dev->data->service_id = sw->service_id;
+	dev->data->service_id = sw->shards[0].service_id;
 
 	return 0;
 }
@@ -1082,7 +1327,8 @@ static struct rte_vdev_driver evdev_sw_pmd_drv = {
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_SW_PMD, evdev_sw_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_sw, NUMA_NODE_ARG "=<int> "
-		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>");
+		SCHED_QUANTA_ARG "=<int> " CREDIT_QUANTA_ARG "=<int> "
+		SCHED_SHARDS_ARG "=<int> " MAX_INFLIGHT_ARG "=<int>");
 
 /* declared extern in header, for access from other .c files */
 int eventdev_sw_log_level;
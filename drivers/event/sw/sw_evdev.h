@@ -17,10 +17,16 @@
 #define SW_Q_PRIORITY_MAX 255
 #define SW_PORTS_MAX 64
 #define MAX_SW_CONS_Q_DEPTH 128
-#define SW_INFLIGHT_EVENTS_TOTAL 4096
+#define SW_DEFAULT_INFLIGHT_EVENTS 4096
+#define SW_INFLIGHT_EVENTS_MAX (1 << 20)
 /* allow for lots of over-provisioning */
 #define MAX_SW_PROD_Q_DEPTH 4096
 #define SW_FRAGMENTS_MAX 16
+/* scheduler service instances, each owning a subset of the QIDs */
+#define SW_SCHED_SHARDS_MAX 8
+#define SW_DEFAULT_SCHED_SHARDS 1
+/* size of the rings used to hand events over between shards */
+#define SW_SHARD_RING_SIZE 1024
 
 /* Should be power-of-two minus one, to leave room for the next pointer */
 #define SW_EVS_PER_Q_CHUNK 255
@@ -127,6 +133,8 @@ struct sw_qid {
 	uint32_t window_size;          /* Used to wrap reorder_buffer_index */
 
 	uint8_t priority;
+	/* scheduler shard this QID is owned by */
+	uint8_t shard;
 };
 
 struct sw_hist_list_entry {
@@ -147,14 +155,17 @@ struct sw_port {
 	uint8_t initialized;
 	/* A numeric ID for the port */
 	uint8_t id;
+	/* The scheduler shard pulling events from this port's rx ring */
+	uint8_t home_shard;
 
 	/* An atomic counter for when the port has been unlinked, and the
 	 * scheduler has not yet acked this unlink - hence there may still be
 	 * events in the buffers going to the port. When the unlinks in
 	 * progress is read by the scheduler, no more events will be pushed to
-	 * the port - hence the scheduler core can just assign zero.
+	 * the port - hence the scheduler core can just assign zero. There is
+	 * one counter per scheduler shard, as each shard acks separately.
 	 */
-	uint8_t unlinks_in_progress;
+	uint8_t unlinks_in_progress[SW_SCHED_SHARDS_MAX];
 
 	int16_t is_directed; /** Takes from a single directed QID */
 	/**
@@ -184,23 +195,82 @@ struct sw_port {
 	uint32_t poll_buckets[SW_NUM_POLL_BUCKETS];
 		/* bucket values in 4s for shorter reporting */
 
-	/* History list structs, containing info on pkts egressed to worker */
-	uint16_t hist_head __rte_cache_aligned;
-	uint16_t hist_tail;
-	uint16_t inflights;
-	struct sw_hist_list_entry hist_list[SW_PORT_HIST_LIST];
+	/* Shard that scheduled each event dequeued and not yet released, so
+	 * the completion can be routed back to it. Only used with more than
+	 * one scheduler shard.
+	 */
+	uint16_t shard_hist_head;
+	uint16_t shard_hist_tail;
+	uint8_t shard_hist[SW_PORT_HIST_LIST];
 
 	/* track packets in and out of this port */
-	struct sw_point_stats stats;
+	struct sw_point_stats stats __rte_cache_aligned;
 
 
 	uint32_t pp_buf_start;
 	uint32_t pp_buf_count;
+	struct rte_event pp_buf[SCHED_DEQUEUE_BURST_SIZE];
+
+	uint8_t num_qids_mapped;
+};
+
+/* Scheduler state of a port that is private to one shard */
+struct sw_shard_port {
+	/* History list, containing info on pkts egressed to worker */
+	uint16_t hist_head;
+	uint16_t hist_tail;
+	uint16_t inflights;
 	uint16_t cq_buf_count;
+	struct sw_hist_list_entry *hist_list;
+
+	/* Completions handed over by the port's home shard */
+	struct rte_event_ring *cmpl_ring;
+	uint32_t pp_buf_start;
+	uint32_t pp_buf_count;
 	struct rte_event pp_buf[SCHED_DEQUEUE_BURST_SIZE];
+
+	uint64_t tx_pkts;
 	struct rte_event cq_buf[MAX_SW_CONS_Q_DEPTH];
+} __rte_cache_aligned;
 
-	uint8_t num_qids_mapped;
+/* A scheduler service instance. Each shard owns a subset of the QIDs and
+ * schedules them independently of the other shards: events enqueued to a
+ * QID of another shard, and completions of events scheduled by another
+ * shard, are handed over through single-producer single-consumer rings.
+ */
+struct sw_sched_shard {
+	struct sw_evdev *sw;
+	uint8_t id;
+
+	/* number of QIDs owned by this shard */
+	uint32_t qid_count;
+	/* max events pushed to a port and not yet completed */
+	uint16_t hist_size;
+
+	struct sw_queue_chunk *chunk_list_head;
+	struct sw_queue_chunk *chunks;
+
+	/* Rings receiving new events from each of the other shards */
+	struct rte_event_ring *in_rings[SW_SCHED_SHARDS_MAX];
+
+	/* Cache how many packets are in each cq */
+	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
+
+	/* Array of pointers to the QIDs of this shard sorted by priority */
+	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+
+	struct sw_shard_port ports[SW_PORTS_MAX];
+
+	/* Stats */
+	struct sw_point_stats stats __rte_cache_aligned;
+	uint64_t sched_called;
+	uint64_t sched_no_iq_enqueues;
+	uint64_t sched_no_cq_enqueues;
+	uint64_t sched_cq_qid_called;
+	uint64_t sched_handoffs;
+
+	uint32_t service_id;
+	char service_name[SW_PMD_NAME_MAX];
 };
 
 struct sw_evdev {
@@ -227,25 +297,15 @@ struct sw_evdev {
 
 	/* Internal queues - one per logical queue */
 	struct sw_qid qids[RTE_EVENT_MAX_QUEUES_PER_DEV] __rte_cache_aligned;
-	struct sw_queue_chunk *chunk_list_head;
-	struct sw_queue_chunk *chunks;
 
-	/* Cache how many packets are in each cq */
-	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
-
-	/* Array of pointers to load-balanced QIDs sorted by priority level */
-	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
-
-	/* Stats */
-	struct sw_point_stats stats __rte_cache_aligned;
-	uint64_t sched_called;
-	int32_t sched_quanta;
-	uint64_t sched_no_iq_enqueues;
-	uint64_t sched_no_cq_enqueues;
-	uint64_t sched_cq_qid_called;
+	/* History lists of all ports, for all shards */
+	struct sw_hist_list_entry *hist_lists;
 
 	uint8_t started;
+	uint8_t sched_shards;
+	int32_t sched_quanta;
 	uint32_t credit_update_quanta;
+	uint32_t max_inflight;
 
 	/* store num stats and offset of the stats for each port */
 	uint16_t xstats_count_per_port[SW_PORTS_MAX];
@@ -254,8 +314,7 @@ struct sw_evdev {
 	uint16_t xstats_count_per_qid[RTE_EVENT_MAX_QUEUES_PER_DEV];
 	uint16_t xstats_offset_for_qid[RTE_EVENT_MAX_QUEUES_PER_DEV];
 
-	uint32_t service_id;
-	char service_name[SW_PMD_NAME_MAX];
+	struct sw_sched_shard shards[SW_SCHED_SHARDS_MAX];
 };
 
 static inline struct sw_evdev *
@@ -277,7 +336,7 @@ uint16_t sw_event_enqueue_burst(void *port, const struct rte_event ev[],
 uint16_t sw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait);
 uint16_t sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 			uint64_t wait);
-void sw_event_schedule(struct rte_eventdev *dev);
+void sw_event_schedule(struct sw_sched_shard *shard);
 int sw_xstats_init(struct sw_evdev *dev);
 int sw_xstats_uninit(struct sw_evdev *dev);
 int sw_xstats_get_names(const struct rte_eventdev *dev,
@@ -26,9 +26,53 @@
 /* use cheap bit mixing, we only need to lose a few bits */
 #define SW_HASH_FLOWID(f) (((f) ^ (f >> 10)) & FLOWID_MASK)
 
+/* Push the events buffered for a CQ to the worker. With several shards the
+ * CQ ring is written by all of them, so the enqueue can come up short: the
+ * events left over are kept in order for the next flush. Events are tagged
+ * with the shard that scheduled them, for the worker to route completions.
+ */
+static __rte_always_inline void
+sw_flush_cq_buf(struct sw_sched_shard *shard, uint32_t port_id)
+{
+	struct sw_shard_port *p = &shard->ports[port_id];
+	struct rte_event_ring *worker = shard->sw->ports[port_id].cq_worker_ring;
+	uint32_t n, i;
+
+	if (shard->sw->sched_shards > 1)
+		for (i = 0; i < p->cq_buf_count; i++)
+			p->cq_buf[i].impl_opaque = shard->id;
+
+	n = rte_event_ring_enqueue_burst(worker, p->cq_buf, p->cq_buf_count,
+			&shard->cq_ring_space[port_id]);
+	if (unlikely(n != p->cq_buf_count)) {
+		p->cq_buf_count -= n;
+		memmove(p->cq_buf, &p->cq_buf[n],
+				p->cq_buf_count * sizeof(p->cq_buf[0]));
+		shard->cq_ring_space[port_id] = 0;
+		return;
+	}
+	p->cq_buf_count = 0;
+}
+
+/* Hand a new event over to the shard owning its QID. Each ring between two
+ * shards has a single producer, so a free slot seen here cannot be taken.
+ */
+static __rte_always_inline int
+sw_handoff(struct sw_sched_shard *shard, uint8_t dest,
+		const struct rte_event *qe)
+{
+	struct rte_event_ring *r = shard->sw->shards[dest].in_rings[shard->id];
+
+	if (rte_event_ring_enqueue_burst(r, qe, 1, NULL) != 1)
+		return 0;
+
+	shard->sched_handoffs++;
+	return 1;
+}
+
 static inline uint32_t
-sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count)
+sw_schedule_atomic_to_cq(struct sw_sched_shard *shard,
+		struct sw_qid * const qid, uint32_t iq_num, unsigned int count)
 {
 	struct rte_event qes[MAX_PER_IQ_DEQUEUE]; /* count <= MAX */
 	struct rte_event blocked_qes[MAX_PER_IQ_DEQUEUE];
@@ -43,7 +87,7 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	 */
 	uint32_t qid_id = qid->id;
 
-	iq_dequeue_burst(sw, &qid->iq[iq_num], qes, count);
+	iq_dequeue_burst(shard, &qid->iq[iq_num], qes, count);
 	for (i = 0; i < count; i++) {
 		const struct rte_event *qe = &qes[i];
 		const uint16_t flow_id = SW_HASH_FLOWID(qes[i].flow_id);
@@ -59,11 +103,11 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			cq = qid->cq_map[cq_idx];
 
 			/* find least used */
-			int cq_free_cnt = sw->cq_ring_space[cq];
+			int cq_free_cnt = shard->cq_ring_space[cq];
 			for (cq_idx = 0; cq_idx < qid->cq_num_mapped_cqs;
 					cq_idx++) {
 				int test_cq = qid->cq_map[cq_idx];
-				int test_cq_free = sw->cq_ring_space[test_cq];
+				int test_cq_free = shard->cq_ring_space[test_cq];
 				if (test_cq_free > cq_free_cnt) {
 					cq = test_cq;
 					cq_free_cnt = test_cq_free;
@@ -73,46 +117,43 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			fid->cq = cq; /* this pins early */
 		}
 
-		if (sw->cq_ring_space[cq] == 0 ||
-				sw->ports[cq].inflights == SW_PORT_HIST_LIST) {
+		if (shard->cq_ring_space[cq] == 0 ||
+				shard->ports[cq].inflights == shard->hist_size) {
 			blocked_qes[nb_blocked++] = *qe;
 			continue;
 		}
 
-		struct sw_port *p = &sw->ports[cq];
+		struct sw_shard_port *p = &shard->ports[cq];
 
 		/* at this point we can queue up the packet on the cq_buf */
 		fid->pcount++;
 		p->cq_buf[p->cq_buf_count++] = *qe;
 		p->inflights++;
-		sw->cq_ring_space[cq]--;
+		shard->cq_ring_space[cq]--;
 
-		int head = (p->hist_head++ & (SW_PORT_HIST_LIST-1));
+		int head = (p->hist_head++ & (shard->hist_size - 1));
 		p->hist_list[head].fid = flow_id;
 		p->hist_list[head].qid = qid_id;
 
-		p->stats.tx_pkts++;
+		p->tx_pkts++;
 		qid->stats.tx_pkts++;
 		qid->to_port[cq]++;
 
 		/* if we just filled in the last slot, flush the buffer */
-		if (sw->cq_ring_space[cq] == 0) {
-			struct rte_event_ring *worker = p->cq_worker_ring;
-			rte_event_ring_enqueue_burst(worker, p->cq_buf,
-					p->cq_buf_count,
-					&sw->cq_ring_space[cq]);
-			p->cq_buf_count = 0;
-		}
+		if (shard->cq_ring_space[cq] == 0)
+			sw_flush_cq_buf(shard, cq);
 	}
-	iq_put_back(sw, &qid->iq[iq_num], blocked_qes, nb_blocked);
+	iq_put_back(shard, &qid->iq[iq_num], blocked_qes, nb_blocked);
 
 	return count - nb_blocked;
 }
 
 static inline uint32_t
-sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count, int keep_order)
+sw_schedule_parallel_to_cq(struct sw_sched_shard *shard,
+		struct sw_qid * const qid, uint32_t iq_num, unsigned int count,
+		int keep_order)
 {
+	struct sw_evdev *sw = shard->sw;
 	uint32_t i;
 	uint32_t cq_idx = qid->cq_next_tx;
 
@@ -148,18 +189,18 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 
 		} while (rte_event_ring_free_count(
 				sw->ports[cq].cq_worker_ring) == 0 ||
-				sw->ports[cq].inflights == SW_PORT_HIST_LIST);
+				shard->ports[cq].inflights == shard->hist_size);
 
-		struct sw_port *p = &sw->ports[cq];
-		if (sw->cq_ring_space[cq] == 0 ||
-				p->inflights == SW_PORT_HIST_LIST)
+		struct sw_shard_port *p = &shard->ports[cq];
+		if (shard->cq_ring_space[cq] == 0 ||
+				p->inflights == shard->hist_size)
 			break;
 
-		sw->cq_ring_space[cq]--;
+		shard->cq_ring_space[cq]--;
 
 		qid->stats.tx_pkts++;
 
-		const int head = (p->hist_head & (SW_PORT_HIST_LIST-1));
+		const int head = (p->hist_head & (shard->hist_size - 1));
 		p->hist_list[head].fid = SW_HASH_FLOWID(qe->flow_id);
 		p->hist_list[head].qid = qid_id;
 
@@ -167,12 +208,12 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			rte_ring_sc_dequeue(qid->reorder_buffer_freelist,
 					(void *)&p->hist_list[head].rob_entry);
 
-		sw->ports[cq].cq_buf[sw->ports[cq].cq_buf_count++] = *qe;
-		iq_pop(sw, &qid->iq[iq_num]);
+		p->cq_buf[p->cq_buf_count++] = *qe;
+		iq_pop(shard, &qid->iq[iq_num]);
 
 		rte_compiler_barrier();
 		p->inflights++;
-		p->stats.tx_pkts++;
+		p->tx_pkts++;
 		p->hist_head++;
 	}
 exit:
@@ -181,43 +222,43 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 }
 
 static uint32_t
-sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
+sw_schedule_dir_to_cq(struct sw_sched_shard *shard, struct sw_qid * const qid,
 		uint32_t iq_num, unsigned int count __rte_unused)
 {
 	uint32_t cq_id = qid->cq_map[0];
-	struct sw_port *port = &sw->ports[cq_id];
+	struct sw_shard_port *port = &shard->ports[cq_id];
 
 	/* get max burst enq size for cq_ring */
-	uint32_t count_free = sw->cq_ring_space[cq_id];
+	uint32_t count_free = shard->cq_ring_space[cq_id];
 	if (count_free == 0)
 		return 0;
 
 	/* burst dequeue from the QID IQ ring */
 	struct sw_iq *iq = &qid->iq[iq_num];
-	uint32_t ret = iq_dequeue_burst(sw, iq,
+	uint32_t ret = iq_dequeue_burst(shard, iq,
 			&port->cq_buf[port->cq_buf_count], count_free);
 	port->cq_buf_count += ret;
 
 	/* Update QID, Port and Total TX stats */
 	qid->stats.tx_pkts += ret;
-	port->stats.tx_pkts += ret;
+	port->tx_pkts += ret;
 
 	/* Subtract credits from cached value */
-	sw->cq_ring_space[cq_id] -= ret;
+	shard->cq_ring_space[cq_id] -= ret;
 
 	return ret;
 }
 
 static uint32_t
-sw_schedule_qid_to_cq(struct sw_evdev *sw)
+sw_schedule_qid_to_cq(struct sw_sched_shard *shard)
 {
 	uint32_t pkts = 0;
 	uint32_t qid_idx;
 
-	sw->sched_cq_qid_called++;
+	shard->sched_cq_qid_called++;
 
-	for (qid_idx = 0; qid_idx < sw->qid_count; qid_idx++) {
-		struct sw_qid *qid = sw->qids_prioritized[qid_idx];
+	for (qid_idx = 0; qid_idx < shard->qid_count; qid_idx++) {
+		struct sw_qid *qid = shard->qids_prioritized[qid_idx];
 
 		int type = qid->type;
 		int iq_num = PKT_MASK_TO_IQ(qid->iq_pkt_mask);
@@ -231,14 +272,14 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 
 		if (count > 0) {
 			if (type == SW_SCHED_TYPE_DIRECT)
-				pkts_done += sw_schedule_dir_to_cq(sw, qid,
+				pkts_done += sw_schedule_dir_to_cq(shard, qid,
 						iq_num, count);
 			else if (type == RTE_SCHED_TYPE_ATOMIC)
-				pkts_done += sw_schedule_atomic_to_cq(sw, qid,
-						iq_num, count);
+				pkts_done += sw_schedule_atomic_to_cq(shard,
+						qid, iq_num, count);
 			else
-				pkts_done += sw_schedule_parallel_to_cq(sw, qid,
-						iq_num, count,
+				pkts_done += sw_schedule_parallel_to_cq(shard,
+						qid, iq_num, count,
 						type == RTE_SCHED_TYPE_ORDERED);
 		}
 
@@ -255,18 +296,20 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 }
 
 /* This function will perform re-ordering of packets, and injecting into
- * the appropriate QID IQ. As LB and DIR QIDs are in the same array, but *NOT*
- * contiguous in that array, this function accepts a "range" of QIDs to scan.
+ * the appropriate QID IQ. Only the ordered QIDs owned by the shard are
+ * scanned; events re-ordered into a QID of another shard are handed over.
  */
 static uint16_t
-sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
+sw_schedule_reorder(struct sw_sched_shard *shard)
 {
 	/* Perform egress reordering */
+	struct sw_evdev *sw = shard->sw;
 	struct rte_event *qe;
 	uint32_t pkts_iter = 0;
+	uint32_t qid_idx;
 
-	for (; qid_start < qid_end; qid_start++) {
-		struct sw_qid *qid = &sw->qids[qid_start];
+	for (qid_idx = 0; qid_idx < shard->qid_count; qid_idx++) {
+		struct sw_qid *qid = shard->qids_prioritized[qid_idx];
 		int i, num_entries_in_use;
 
 		if (qid->type != RTE_SCHED_TYPE_ORDERED)
@@ -295,19 +338,29 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 				dest_iq  = PRIO_TO_IQ(qe->priority);
 
 				if (dest_qid >= sw->qid_count) {
-					sw->stats.rx_dropped++;
+					shard->stats.rx_dropped++;
+					continue;
+				}
+
+				struct sw_qid *q = &sw->qids[dest_qid];
+
+				/* stop at the first fragment that can't be
+				 * handed over, to keep the order
+				 */
+				if (q->shard != shard->id) {
+					if (!sw_handoff(shard, q->shard, qe))
+						break;
 					continue;
 				}
 
 				pkts_iter++;
 
-				struct sw_qid *q = &sw->qids[dest_qid];
 				struct sw_iq *iq = &q->iq[dest_iq];
 
 				/* we checked for space above, so enqueue must
 				 * succeed
 				 */
-				iq_enqueue(sw, iq, qe);
+				iq_enqueue(shard, iq, qe);
 				q->iq_pkt_mask |= (1 << (dest_iq));
 				q->iq_pkt_count[dest_iq]++;
 				q->stats.rx_pkts++;
@@ -317,16 +370,16 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 			entry->num_fragments -= j;
 			entry->fragment_index += j;
 
-			if (!entry->ready) {
-				entry->fragment_index = 0;
+			if (entry->ready)
+				break;
 
-				rte_ring_sp_enqueue(
-						qid->reorder_buffer_freelist,
-						entry);
+			entry->fragment_index = 0;
 
-				qid->reorder_buffer_index++;
-				qid->reorder_buffer_index %= qid->window_size;
-			}
+			rte_ring_sp_enqueue(qid->reorder_buffer_freelist,
+					entry);
+
+			qid->reorder_buffer_index++;
+			qid->reorder_buffer_index %= qid->window_size;
 		}
 	}
 	return pkts_iter;
@@ -342,106 +395,184 @@ sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
 			RTE_DIM(port->pp_buf), NULL);
 }
 
-static __rte_always_inline uint32_t
-__pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
+/* Process one event pulled from a load balanced port: complete the event at
+ * the tail of the port history, then enqueue the new event to its QID.
+ * Returns the number of events enqueued to an IQ of this shard, or -ENOSPC if
+ * the shard owning the destination QID has no room for the event yet. In that
+ * case the event is left untouched, and the caller has to keep it and retry.
+ */
+static __rte_always_inline int
+sw_schedule_qe(struct sw_sched_shard *shard, uint32_t port_id,
+		const struct rte_event *qe, int allow_reorder)
 {
 	static struct reorder_buffer_entry dummy_rob;
-	uint32_t pkts_iter = 0;
-	struct sw_port *port = &sw->ports[port_id];
+	struct sw_evdev *sw = shard->sw;
+	struct sw_shard_port *port = &shard->ports[port_id];
+	struct sw_hist_list_entry *hist_entry = NULL;
+	uint8_t flags = qe->op;
+	const uint16_t eop = !(flags & QE_FLAG_NOT_EOP);
+	int needs_reorder = 0;
+	/* if no-reordering, having PARTIAL == NEW */
+	if (!allow_reorder && !eop)
+		flags = QE_FLAG_VALID;
+
+	/*
+	 * if we don't have space for this packet in an IQ,
+	 * then move on to next queue. Technically, for a
+	 * packet that needs reordering, we don't need to check
+	 * here, but it simplifies things not to special-case
+	 */
+	uint32_t iq_num = PRIO_TO_IQ(qe->priority);
+	struct sw_qid *qid = &sw->qids[qe->queue_id];
 
-	/* If shadow ring has 0 pkts, pull from worker ring */
-	if (port->pp_buf_count == 0)
-		sw_refill_pp_buf(sw, port);
+	/* the event can only be completed here if it can also be handed
+	 * over to the shard owning its destination QID
+	 */
+	if ((flags & QE_FLAG_VALID) && qid->shard != shard->id &&
+			rte_event_ring_free_count(
+			sw->shards[qid->shard].in_rings[shard->id]) == 0)
+		return -ENOSPC;
+
+	/* now process based on flags. Note that for directed
+	 * queues, the enqueue_flush masks off all but the
+	 * valid flag. This makes FWD and PARTIAL enqueues just
+	 * NEW type, and makes DROPS no-op calls.
+	 */
+	if ((flags & QE_FLAG_COMPLETE) && port->inflights > 0) {
+		const uint32_t hist_tail = port->hist_tail &
+				(shard->hist_size - 1);
+
+		hist_entry = &port->hist_list[hist_tail];
+		const uint32_t hist_qid = hist_entry->qid;
+		const uint32_t hist_fid = hist_entry->fid;
+
+		struct sw_fid_t *fid =
+			&sw->qids[hist_qid].fids[hist_fid];
+		fid->pcount -= eop;
+		if (fid->pcount == 0)
+			fid->cq = -1;
+
+		if (allow_reorder) {
+			/* set reorder ready if an ordered QID */
+			uintptr_t rob_ptr =
+				(uintptr_t)hist_entry->rob_entry;
+			const uintptr_t valid = (rob_ptr != 0);
+			needs_reorder = valid;
+			rob_ptr |=
+				((valid - 1) & (uintptr_t)&dummy_rob);
+			struct reorder_buffer_entry *tmp_rob_ptr =
+				(struct reorder_buffer_entry *)rob_ptr;
+			tmp_rob_ptr->ready = eop * needs_reorder;
+		}
 
-	while (port->pp_buf_count) {
-		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
-		struct sw_hist_list_entry *hist_entry = NULL;
-		uint8_t flags = qe->op;
-		const uint16_t eop = !(flags & QE_FLAG_NOT_EOP);
-		int needs_reorder = 0;
-		/* if no-reordering, having PARTIAL == NEW */
-		if (!allow_reorder && !eop)
-			flags = QE_FLAG_VALID;
+		port->inflights -= eop;
+		port->hist_tail += eop;
+	}
+	if (flags & QE_FLAG_VALID) {
+		if (allow_reorder && needs_reorder) {
+			struct reorder_buffer_entry *rob_entry =
+					hist_entry->rob_entry;
+
+			hist_entry->rob_entry = NULL;
+			/* Although fragmentation not currently
+			 * supported by eventdev API, we support it
+			 * here. Open: How do we alert the user that
+			 * they've exceeded max frags?
+			 */
+			int num_frag = rob_entry->num_fragments;
+			if (num_frag == SW_FRAGMENTS_MAX)
+				shard->stats.rx_dropped++;
+			else {
+				int idx = rob_entry->num_fragments++;
+				rob_entry->fragments[idx] = *qe;
+			}
+			return 0;
+		}
 
-		/*
-		 * if we don't have space for this packet in an IQ,
-		 * then move on to next queue. Technically, for a
-		 * packet that needs reordering, we don't need to check
-		 * here, but it simplifies things not to special-case
+		/* room was checked above and this shard is the only producer
+		 * of the ring, so the handoff cannot fail
 		 */
-		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
-		struct sw_qid *qid = &sw->qids[qe->queue_id];
+		if (qid->shard != shard->id) {
+			if (unlikely(!sw_handoff(shard, qid->shard, qe)))
+				shard->stats.rx_dropped++;
+			return 0;
+		}
 
-		/* now process based on flags. Note that for directed
-		 * queues, the enqueue_flush masks off all but the
-		 * valid flag. This makes FWD and PARTIAL enqueues just
-		 * NEW type, and makes DROPS no-op calls.
+		/* Use the iq_num from above to push the QE
+		 * into the qid at the right priority
 		 */
-		if ((flags & QE_FLAG_COMPLETE) && port->inflights > 0) {
-			const uint32_t hist_tail = port->hist_tail &
-					(SW_PORT_HIST_LIST - 1);
-
-			hist_entry = &port->hist_list[hist_tail];
-			const uint32_t hist_qid = hist_entry->qid;
-			const uint32_t hist_fid = hist_entry->fid;
-
-			struct sw_fid_t *fid =
-				&sw->qids[hist_qid].fids[hist_fid];
-			fid->pcount -= eop;
-			if (fid->pcount == 0)
-				fid->cq = -1;
-
-			if (allow_reorder) {
-				/* set reorder ready if an ordered QID */
-				uintptr_t rob_ptr =
-					(uintptr_t)hist_entry->rob_entry;
-				const uintptr_t valid = (rob_ptr != 0);
-				needs_reorder = valid;
-				rob_ptr |=
-					((valid - 1) & (uintptr_t)&dummy_rob);
-				struct reorder_buffer_entry *tmp_rob_ptr =
-					(struct reorder_buffer_entry *)rob_ptr;
-				tmp_rob_ptr->ready = eop * needs_reorder;
-			}
 
-			port->inflights -= eop;
-			port->hist_tail += eop;
-		}
-		if (flags & QE_FLAG_VALID) {
-			port->stats.rx_pkts++;
+		qid->iq_pkt_mask |= (1 << (iq_num));
+		iq_enqueue(shard, &qid->iq[iq_num], qe);
+		qid->iq_pkt_count[iq_num]++;
+		qid->stats.rx_pkts++;
+		return 1;
+	}
 
-			if (allow_reorder && needs_reorder) {
-				struct reorder_buffer_entry *rob_entry =
-						hist_entry->rob_entry;
+	return 0;
+}
 
-				hist_entry->rob_entry = NULL;
-				/* Although fragmentation not currently
-				 * supported by eventdev API, we support it
-				 * here. Open: How do we alert the user that
-				 * they've exceeded max frags?
-				 */
-				int num_frag = rob_entry->num_fragments;
-				if (num_frag == SW_FRAGMENTS_MAX)
-					sw->stats.rx_dropped++;
-				else {
-					int idx = rob_entry->num_fragments++;
-					rob_entry->fragments[idx] = *qe;
-				}
-				goto end_qe;
-			}
+/* With several shards, an event pulled from a port is processed by the shard
+ * that scheduled the event it completes, or else by the shard owning its
+ * destination QID. Returns 1 if the event was handed over to another shard,
+ * 0 if it is to be processed here, -ENOSPC if the other shard has no room.
+ */
+static __rte_always_inline int
+sw_route_qe(struct sw_sched_shard *shard, uint32_t port_id,
+		const struct rte_event *qe)
+{
+	struct sw_evdev *sw = shard->sw;
+	uint8_t dest;
+
+	if (qe->op & QE_FLAG_COMPLETE) {
+		dest = qe->impl_opaque;
+		if (dest == shard->id)
+			return 0;
+		if (rte_event_ring_enqueue_burst(
+				sw->shards[dest].ports[port_id].cmpl_ring,
+				qe, 1, NULL) != 1)
+			return -ENOSPC;
+		shard->sched_handoffs++;
+		return 1;
+	}
 
-			/* Use the iq_num from above to push the QE
-			 * into the qid at the right priority
-			 */
+	dest = sw->qids[qe->queue_id].shard;
+	if (dest == shard->id || !(qe->op & QE_FLAG_VALID))
+		return 0;
 
-			qid->iq_pkt_mask |= (1 << (iq_num));
-			iq_enqueue(sw, &qid->iq[iq_num], qe);
-			qid->iq_pkt_count[iq_num]++;
-			qid->stats.rx_pkts++;
-			pkts_iter++;
+	return sw_handoff(shard, dest, qe) ? 1 : -ENOSPC;
+}
+
+static __rte_always_inline uint32_t
+__pull_port_lb(struct sw_sched_shard *shard, uint32_t port_id,
+		int allow_reorder)
+{
+	struct sw_evdev *sw = shard->sw;
+	uint32_t pkts_iter = 0;
+	struct sw_port *port = &sw->ports[port_id];
+	int ret;
+
+	/* If shadow ring has 0 pkts, pull from worker ring */
+	if (port->pp_buf_count == 0)
+		sw_refill_pp_buf(sw, port);
+
+	while (port->pp_buf_count) {
+		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
+
+		ret = 0;
+		if (sw->sched_shards > 1)
+			ret = sw_route_qe(shard, port_id, qe);
+		if (ret == 0) {
+			ret = sw_schedule_qe(shard, port_id, qe,
+					allow_reorder);
+			if (ret > 0)
+				pkts_iter += ret;
 		}
+		/* the event stays in pp_buf, to be retried on the next call */
+		if (ret < 0)
+			break;
 
-end_qe:
+		port->stats.rx_pkts += !!(qe->op & QE_FLAG_VALID);
 		port->pp_buf_start++;
 		port->pp_buf_count--;
 	} /* while (avail_qes) */
@@ -450,20 +581,22 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 }
 
 static uint32_t
-sw_schedule_pull_port_lb(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_lb(struct sw_sched_shard *shard, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 1);
+	return __pull_port_lb(shard, port_id, 1);
 }
 
 static uint32_t
-sw_schedule_pull_port_no_reorder(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_no_reorder(struct sw_sched_shard *shard,
+		uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 0);
+	return __pull_port_lb(shard, port_id, 0);
 }
 
 static uint32_t
-sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_dir(struct sw_sched_shard *shard, uint32_t port_id)
 {
+	struct sw_evdev *sw = shard->sw;
 	uint32_t pkts_iter = 0;
 	struct sw_port *port = &sw->ports[port_id];
 
@@ -482,13 +615,20 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 		struct sw_qid *qid = &sw->qids[qe->queue_id];
 		struct sw_iq *iq = &qid->iq[iq_num];
 
+		if (qid->shard != shard->id) {
+			if (!sw_handoff(shard, qid->shard, qe))
+				break;
+			port->stats.rx_pkts++;
+			goto end_qe;
+		}
+
 		port->stats.rx_pkts++;
 
 		/* Use the iq_num from above to push the QE
 		 * into the qid at the right priority
 		 */
 		qid->iq_pkt_mask |= (1 << (iq_num));
-		iq_enqueue(sw, iq, qe);
+		iq_enqueue(shard, iq, qe);
 		qid->iq_pkt_count[iq_num]++;
 		qid->stats.rx_pkts++;
 		pkts_iter++;
@@ -501,16 +641,81 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 	return pkts_iter;
 }
 
+/* Process the completions of events this shard scheduled to a port that is
+ * pulled by another shard.
+ */
+static uint32_t
+sw_schedule_pull_port_cmpl(struct sw_sched_shard *shard, uint32_t port_id)
+{
+	struct sw_shard_port *port = &shard->ports[port_id];
+	int allow_reorder = shard->sw->ports[port_id].num_ordered_qids > 0;
+	uint32_t pkts_iter = 0;
+	int ret;
+
+	if (port->pp_buf_count == 0) {
+		port->pp_buf_start = 0;
+		port->pp_buf_count = rte_event_ring_dequeue_burst(
+				port->cmpl_ring, port->pp_buf,
+				RTE_DIM(port->pp_buf), NULL);
+	}
+
+	while (port->pp_buf_count) {
+		ret = sw_schedule_qe(shard, port_id,
+				&port->pp_buf[port->pp_buf_start],
+				allow_reorder);
+		/* the event stays in pp_buf, to be retried on the next call */
+		if (ret < 0)
+			break;
+
+		pkts_iter += ret;
+		port->pp_buf_start++;
+		port->pp_buf_count--;
+	}
+
+	return pkts_iter;
+}
+
+/* Enqueue the events handed over by the other shards to the IQs */
+static uint32_t
+sw_schedule_pull_shards(struct sw_sched_shard *shard)
+{
+	struct sw_evdev *sw = shard->sw;
+	struct rte_event qes[SCHED_DEQUEUE_BURST_SIZE];
+	uint32_t pkts_iter = 0;
+	uint32_t i, j, n;
+
+	for (i = 0; i < sw->sched_shards; i++) {
+		if (i == shard->id)
+			continue;
+
+		n = rte_event_ring_dequeue_burst(shard->in_rings[i], qes,
+				RTE_DIM(qes), NULL);
+		for (j = 0; j < n; j++) {
+			const struct rte_event *qe = &qes[j];
+			uint32_t iq_num = PRIO_TO_IQ(qe->priority);
+			struct sw_qid *qid = &sw->qids[qe->queue_id];
+
+			qid->iq_pkt_mask |= (1 << (iq_num));
+			iq_enqueue(shard, &qid->iq[iq_num], qe);
+			qid->iq_pkt_count[iq_num]++;
+			qid->stats.rx_pkts++;
+		}
+		pkts_iter += n;
+	}
+
+	return pkts_iter;
+}
+
 void
-sw_event_schedule(struct rte_eventdev *dev)
+sw_event_schedule(struct sw_sched_shard *shard)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_evdev *sw = shard->sw;
 	uint32_t in_pkts, out_pkts;
 	uint32_t out_pkts_total = 0, in_pkts_total = 0;
 	int32_t sched_quanta = sw->sched_quanta;
 	uint32_t i;
 
-	sw->sched_called++;
+	shard->sched_called++;
 	if (unlikely(!sw->started))
 		return;
 
@@ -521,26 +726,38 @@ sw_event_schedule(struct rte_eventdev *dev)
 		do {
 			in_pkts = 0;
 			for (i = 0; i < sw->port_count; i++) {
+				struct sw_port *port = &sw->ports[i];
+
 				/* ack the unlinks in progress as done */
-				if (sw->ports[i].unlinks_in_progress)
-					sw->ports[i].unlinks_in_progress = 0;
+				if (port->unlinks_in_progress[shard->id])
+					port->unlinks_in_progress[shard->id] = 0;
+
+				if (shard->ports[i].cmpl_ring != NULL)
+					in_pkts += sw_schedule_pull_port_cmpl(
+							shard, i);
 
-				if (sw->ports[i].is_directed)
-					in_pkts += sw_schedule_pull_port_dir(sw, i);
-				else if (sw->ports[i].num_ordered_qids > 0)
-					in_pkts += sw_schedule_pull_port_lb(sw, i);
+				if (port->home_shard != shard->id)
+					continue;
+
+				if (port->is_directed)
+					in_pkts += sw_schedule_pull_port_dir(shard, i);
+				else if (port->num_ordered_qids > 0)
+					in_pkts += sw_schedule_pull_port_lb(shard, i);
 				else
-					in_pkts += sw_schedule_pull_port_no_reorder(sw, i);
+					in_pkts += sw_schedule_pull_port_no_reorder(shard, i);
 			}
 
+			/* events handed over by the other shards */
+			if (sw->sched_shards > 1)
+				in_pkts += sw_schedule_pull_shards(shard);
+
 			/* QID scan for re-ordered */
-			in_pkts += sw_schedule_reorder(sw, 0,
-					sw->qid_count);
+			in_pkts += sw_schedule_reorder(shard);
 			in_pkts_this_iteration += in_pkts;
 		} while (in_pkts > 4 &&
 				(int)in_pkts_this_iteration < sched_quanta);
 
-		out_pkts = sw_schedule_qid_to_cq(sw);
+		out_pkts = sw_schedule_qid_to_cq(shard);
 		out_pkts_total += out_pkts;
 		in_pkts_total += in_pkts_this_iteration;
 
@@ -548,21 +765,16 @@ sw_event_schedule(struct rte_eventdev *dev)
 			break;
 	} while ((int)out_pkts_total < sched_quanta);
 
-	sw->stats.tx_pkts += out_pkts_total;
-	sw->stats.rx_pkts += in_pkts_total;
+	shard->stats.tx_pkts += out_pkts_total;
+	shard->stats.rx_pkts += in_pkts_total;
 
-	sw->sched_no_iq_enqueues += (in_pkts_total == 0);
-	sw->sched_no_cq_enqueues += (out_pkts_total == 0);
+	shard->sched_no_iq_enqueues += (in_pkts_total == 0);
+	shard->sched_no_cq_enqueues += (out_pkts_total == 0);
 
 	/* push all the internal buffered QEs in port->cq_ring to the
 	 * worker cores: aka, do the ring transfers batched.
 	 */
-	for (i = 0; i < sw->port_count; i++) {
-		struct rte_event_ring *worker = sw->ports[i].cq_worker_ring;
-		rte_event_ring_enqueue_burst(worker, sw->ports[i].cq_buf,
-				sw->ports[i].cq_buf_count,
-				&sw->cq_ring_space[i]);
-		sw->ports[i].cq_buf_count = 0;
-	}
+	for (i = 0; i < sw->port_count; i++)
+		sw_flush_cq_buf(shard, i);
 
 }
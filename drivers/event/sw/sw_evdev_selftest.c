@@ -2951,6 +2951,331 @@ dev_stop_flush(struct test *t) /* test to check we can properly flush events */
 	return -1;
 }
 
+/* Get the ID of an eventdev with two scheduler shards, creating it the first
+ * time, and the service IDs of its shards.
+ */
+static int
+sharded_evdev_get(uint32_t service_ids[2])
+{
+	const char *eventdev_name = "event_sw_shards";
+	struct rte_event_dev_info info;
+	int dev_id, i;
+
+	dev_id = rte_event_dev_get_dev_id(eventdev_name);
+	if (dev_id < 0) {
+		if (rte_vdev_init(eventdev_name,
+				"sched_shards=2,max_inflight=8192") < 0) {
+			printf("%d: Error creating sharded eventdev\n",
+					__LINE__);
+			return -1;
+		}
+		dev_id = rte_event_dev_get_dev_id(eventdev_name);
+		if (dev_id < 0) {
+			printf("%d: Error finding sharded eventdev\n",
+					__LINE__);
+			return -1;
+		}
+	}
+
+	rte_event_dev_info_get(dev_id, &info);
+	if (info.max_num_events != 8192) {
+		printf("%d: max_num_events %d, expected 8192\n", __LINE__,
+				info.max_num_events);
+		return -1;
+	}
+
+	if (rte_event_dev_service_id_get(dev_id, &service_ids[0]) < 0 ||
+			rte_service_get_by_name("event_sw_shards_service_1",
+				&service_ids[1]) < 0) {
+		printf("%d: Error getting shard service IDs\n", __LINE__);
+		return -1;
+	}
+	for (i = 0; i < 2; i++) {
+		rte_service_runstate_set(service_ids[i], 1);
+		rte_service_set_runstate_mapped_check(service_ids[i], 0);
+	}
+
+	return dev_id;
+}
+
+static int
+sharded_pipeline(struct test *t)
+{
+	/* A 4 stage pipeline with the stages spread over two scheduler
+	 * shards: q0 (atomic) and q2 (atomic) live on shard 0, q1 (ordered)
+	 * and q3 (directed) on shard 1, so every hop crosses shards.
+	 */
+	const unsigned int num_events = 512;
+	const int saved_evdev = evdev;
+	uint32_t service_ids[2];
+	struct rte_event ev[64];
+	uint64_t total_tx = 0, total_rx = 0, dev_rx, dev_tx;
+	unsigned int enq = 0, deq = 0, iter;
+	int i, ret = -1;
+
+	evdev = sharded_evdev_get(service_ids);
+	if (evdev < 0) {
+		evdev = saved_evdev;
+		return -1;
+	}
+
+	if (init(t, 4, 4) < 0 ||
+			create_ports(t, 4) < 0 ||
+			create_atomic_qids(t, 1) < 0 ||
+			create_ordered_qids(t, 1) < 0 ||
+			create_atomic_qids(t, 1) < 0 ||
+			create_directed_qids(t, 1, &t->port[3]) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		goto out;
+	}
+
+	/* ports 1 and 2 are workers with different home shards */
+	for (i = 1; i <= 2; i++) {
+		if (rte_event_port_link(evdev, t->port[i], t->qid, NULL, 3)
+				!= 3) {
+			printf("%d: Error linking port %d\n", __LINE__, i);
+			goto out;
+		}
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		goto out;
+	}
+
+	for (iter = 0; iter < 10000 && deq < num_events; iter++) {
+		unsigned int n = RTE_MIN(RTE_DIM(ev), num_events - enq);
+		unsigned int j;
+
+		for (j = 0; j < n; j++) {
+			ev[j] = (struct rte_event){
+				.op = RTE_EVENT_OP_NEW,
+				.queue_id = t->qid[0],
+				.sched_type = RTE_SCHED_TYPE_ATOMIC,
+				.flow_id = 0,
+				.u64 = enq + j,
+			};
+		}
+		enq += rte_event_enqueue_burst(evdev, t->port[0], ev, n);
+
+		rte_service_run_iter_on_app_lcore(service_ids[0], 1);
+		rte_service_run_iter_on_app_lcore(service_ids[1], 1);
+
+		for (i = 1; i <= 2; i++) {
+			uint16_t nb = rte_event_dequeue_burst(evdev,
+					t->port[i], ev, RTE_DIM(ev), 0);
+			uint16_t sent = 0;
+
+			for (j = 0; j < nb; j++) {
+				ev[j].queue_id++;
+				ev[j].op = RTE_EVENT_OP_FORWARD;
+			}
+			while (sent < nb)
+				sent += rte_event_enqueue_burst(evdev,
+						t->port[i], &ev[sent],
+						nb - sent);
+		}
+
+		uint16_t nb = rte_event_dequeue_burst(evdev, t->port[3], ev,
+				RTE_DIM(ev), 0);
+		for (j = 0; j < nb; j++, deq++) {
+			if (ev[j].u64 != deq) {
+				printf("%d: event %u out of order, expected %u\n",
+						__LINE__, (unsigned int)ev[j].u64,
+						deq);
+				rte_event_dev_dump(evdev, stdout);
+				goto out;
+			}
+		}
+	}
+
+	if (deq != num_events) {
+		printf("%d: received %u of %u events\n", __LINE__, deq,
+				num_events);
+		rte_event_dev_dump(evdev, stdout);
+		goto out;
+	}
+
+	/* the worker tx counters are spread over both shards */
+	for (i = 1; i <= 2; i++) {
+		char name[RTE_EVENT_DEV_XSTATS_NAME_SIZE];
+		unsigned int id;
+
+		snprintf(name, sizeof(name), "port_%d_tx", i);
+		total_tx += rte_event_dev_xstats_by_name_get(evdev, name, &id);
+	}
+	if (total_tx != 3 * num_events) {
+		printf("%d: worker tx %"PRIu64", expected %u\n", __LINE__,
+				total_tx, 3 * num_events);
+		goto out;
+	}
+
+	/* every hop crosses shards, yet each event is counted once per
+	 * stage, by the shard owning the QID of the stage
+	 */
+	for (i = 0; i < 4; i++) {
+		char name[RTE_EVENT_DEV_XSTATS_NAME_SIZE];
+		unsigned int id;
+
+		snprintf(name, sizeof(name), "port_%d_rx", i);
+		total_rx += rte_event_dev_xstats_by_name_get(evdev, name, &id);
+	}
+	dev_rx = rte_event_dev_xstats_by_name_get(evdev, "dev_rx", NULL);
+	dev_tx = rte_event_dev_xstats_by_name_get(evdev, "dev_tx", NULL);
+	if (total_rx != 4 * num_events || dev_rx != total_rx ||
+			dev_tx != 4 * num_events) {
+		printf("%d: port rx %"PRIu64", dev rx %"PRIu64", dev tx %"
+				PRIu64", expected %u\n", __LINE__, total_rx,
+				dev_rx, dev_tx, 4 * num_events);
+		goto out;
+	}
+
+	ret = 0;
+out:
+	cleanup(t);
+	evdev = saved_evdev;
+	return ret;
+}
+
+/* stop the device, check that all the events were flushed and that none of
+ * them is still counted as inflight after a restart
+ */
+static int
+sharded_stop_check(struct test *t, uint8_t *count, unsigned int expected)
+{
+	char name[RTE_EVENT_DEV_XSTATS_NAME_SIZE];
+	unsigned int i, id;
+
+	rte_event_dev_stop(evdev);
+
+	if (*count != expected) {
+		printf("%d: flushed %u of %u events\n", __LINE__, *count,
+				expected);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i < 2; i++) {
+		snprintf(name, sizeof(name), "port_%u_inflight", t->port[i]);
+		if (rte_event_dev_xstats_by_name_get(evdev, name, &id) != 0) {
+			printf("%d: %s is not 0 after restart\n", __LINE__,
+					name);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+sharded_dev_stop_flush(struct test *t)
+{
+	/* q0 lives on shard 0 and q1 on shard 1, port 0 is homed on shard 0
+	 * and port 1 on shard 1. Stop the device while the only events left
+	 * are in the shard rings: first completions routed from shard 1 back
+	 * to shard 0, then new events handed over from shard 0 to shard 1.
+	 */
+	const int saved_evdev = evdev;
+	uint32_t service_ids[2];
+	struct rte_event ev[8];
+	const unsigned int num_events = RTE_DIM(ev);
+	uint8_t count = 0;
+	unsigned int i;
+	uint16_t nb;
+	int ret = -1;
+
+	evdev = sharded_evdev_get(service_ids);
+	if (evdev < 0) {
+		evdev = saved_evdev;
+		return -1;
+	}
+
+	if (init(t, 2, 2) < 0 ||
+			create_ports(t, 2) < 0 ||
+			create_atomic_qids(t, 2) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		goto out;
+	}
+
+	if (rte_event_port_link(evdev, t->port[1], t->qid, NULL, 2) != 2) {
+		printf("%d: Error linking port 1\n", __LINE__);
+		goto out;
+	}
+
+	if (rte_event_dev_stop_flush_callback_register(evdev, flush, &count)) {
+		printf("%d: Error installing the flush callback\n", __LINE__);
+		goto out;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		goto out;
+	}
+
+	/* scheduled by shard 0 to port 1 and forwarded by port 1: shard 1
+	 * routes the completions to shard 0
+	 */
+	for (i = 0; i < num_events; i++)
+		ev[i] = (struct rte_event){
+			.op = RTE_EVENT_OP_NEW,
+			.queue_id = t->qid[0],
+			.sched_type = RTE_SCHED_TYPE_ATOMIC,
+			.u64 = 0xCA11BACC,
+		};
+	if (rte_event_enqueue_burst(evdev, t->port[0], ev, num_events) !=
+			num_events) {
+		printf("%d: Error enqueuing events\n", __LINE__);
+		goto out;
+	}
+	rte_service_run_iter_on_app_lcore(service_ids[0], 1);
+
+	nb = rte_event_dequeue_burst(evdev, t->port[1], ev, RTE_DIM(ev), 0);
+	if (nb != num_events) {
+		printf("%d: dequeued %u of %u events\n", __LINE__, nb,
+				num_events);
+		goto out;
+	}
+	for (i = 0; i < nb; i++)
+		ev[i].op = RTE_EVENT_OP_FORWARD;
+	if (rte_event_enqueue_burst(evdev, t->port[1], ev, nb) != nb) {
+		printf("%d: Error forwarding events\n", __LINE__);
+		goto out;
+	}
+	rte_service_run_iter_on_app_lcore(service_ids[1], 1);
+
+	if (sharded_stop_check(t, &count, num_events) < 0)
+		goto out;
+
+	/* handed over by shard 0 to shard 1 */
+	for (i = 0; i < num_events; i++)
+		ev[i] = (struct rte_event){
+			.op = RTE_EVENT_OP_NEW,
+			.queue_id = t->qid[1],
+			.sched_type = RTE_SCHED_TYPE_ATOMIC,
+			.u64 = 0xCA11BACC,
+		};
+	if (rte_event_enqueue_burst(evdev, t->port[0], ev, num_events) !=
+			num_events) {
+		printf("%d: Error enqueuing events\n", __LINE__);
+		goto out;
+	}
+	rte_service_run_iter_on_app_lcore(service_ids[0], 1);
+
+	if (sharded_stop_check(t, &count, 2 * num_events) < 0)
+		goto out;
+
+	ret = 0;
+out:
+	rte_event_dev_stop_flush_callback_register(evdev, NULL, NULL);
+	cleanup(t);
+	evdev = saved_evdev;
+	return ret;
+}
+
 static int
 worker_loopback_worker_fn(void *arg)
 {
@@ -3367,6 +3692,18 @@ test_sw_eventdev(void)
 		printf("ERROR - Stop Flush test FAILED.\n");
 		goto test_fail;
 	}
+	printf("*** Running Sharded Pipeline test...\n");
+	ret = sharded_pipeline(t);
+	if (ret != 0) {
+		printf("ERROR - Sharded Pipeline test FAILED.\n");
+		goto test_fail;
+	}
+	printf("*** Running Sharded Dev Stop Flush test...\n");
+	ret = sharded_dev_stop_flush(t);
+	if (ret != 0) {
+		printf("ERROR - Sharded Dev Stop Flush test FAILED.\n");
+		goto test_fail;
+	}
 	if (rte_lcore_count() >= 3) {
 		printf("*** Running Worker loopback test...\n");
 		ret = worker_loopback(t, 0);
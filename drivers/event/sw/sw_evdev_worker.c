@@ -22,6 +22,9 @@ sw_event_release(struct sw_port *p, uint8_t index)
 	/* create drop message */
 	struct rte_event ev;
 	ev.op = sw_qe_flag_map[RTE_EVENT_OP_RELEASE];
+	if (p->sw->sched_shards > 1)
+		ev.impl_opaque = p->shard_hist[p->shard_hist_tail++ &
+				(SW_PORT_HIST_LIST - 1)];
 
 	uint16_t free_count;
 	rte_event_ring_enqueue_burst(p->rx_worker_ring, &ev, 1, &free_count);
@@ -33,18 +36,22 @@ sw_event_release(struct sw_port *p, uint8_t index)
 
 /*
  * special-case of rte_event_ring enqueue, with overriding the ops member on
- * the events that get written to the ring.
+ * the events that get written to the ring, and the shard each completion is
+ * for when shards is not NULL.
  */
 static inline unsigned int
 enqueue_burst_with_ops(struct rte_event_ring *r, const struct rte_event *events,
-		unsigned int n, uint8_t *ops)
+		unsigned int n, uint8_t *ops, uint8_t *shards)
 {
 	struct rte_event tmp_evs[PORT_ENQUEUE_MAX_BURST_SIZE];
 	unsigned int i;
 
 	memcpy(tmp_evs, events, n * sizeof(events[0]));
-	for (i = 0; i < n; i++)
+	for (i = 0; i < n; i++) {
 		tmp_evs[i].op = ops[i];
+		if (shards != NULL)
+			tmp_evs[i].impl_opaque = shards[i];
+	}
 
 	return rte_event_ring_enqueue_burst(r, tmp_evs, n, NULL);
 }
@@ -54,10 +61,12 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 {
 	int32_t i;
 	uint8_t new_ops[PORT_ENQUEUE_MAX_BURST_SIZE];
+	uint8_t shards[PORT_ENQUEUE_MAX_BURST_SIZE];
 	struct sw_port *p = port;
 	struct sw_evdev *sw = (void *)p->sw;
 	uint32_t sw_inflights = rte_atomic32_read(&sw->inflights);
 	uint32_t credit_update_quanta = sw->credit_update_quanta;
+	const int sharded = sw->sched_shards > 1;
 	int new = 0;
 
 	if (num > PORT_ENQUEUE_MAX_BURST_SIZE)
@@ -99,8 +108,16 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 		 * correct usage of the API), providing very high correct
 		 * prediction rate.
 		 */
-		if ((new_ops[i] & QE_FLAG_COMPLETE) && outstanding)
+		if ((new_ops[i] & QE_FLAG_COMPLETE) && outstanding) {
 			p->outstanding_releases--;
+			/* route the completion to the shard that scheduled
+			 * the oldest outstanding event
+			 */
+			if (sharded)
+				shards[i] = p->shard_hist[p->shard_hist_tail++ &
+						(SW_PORT_HIST_LIST - 1)];
+		} else if (sharded)
+			new_ops[i] &= ~QE_FLAG_COMPLETE;
 
 		/* error case: branch to avoid touching p->stats */
 		if (unlikely(invalid_qid && op != RTE_EVENT_OP_RELEASE)) {
@@ -111,7 +128,7 @@ sw_event_enqueue_burst(void *port, const struct rte_event ev[], uint16_t num)
 
 	/* returns number of events actually enqueued */
 	uint32_t enq = enqueue_burst_with_ops(p->rx_worker_ring, ev, i,
-					     new_ops);
+					     new_ops, sharded ? shards : NULL);
 	if (p->outstanding_releases == 0 && p->last_dequeue_burst_sz != 0) {
 		uint64_t burst_ticks = rte_get_timer_cycles() -
 				p->last_dequeue_ticks;
@@ -169,6 +186,14 @@ sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 		goto end;
 	}
 
+	if (p->sw->sched_shards > 1) {
+		uint16_t i;
+		for (i = 0; i < ndeq; i++)
+			p->shard_hist[p->shard_hist_head++ &
+					(SW_PORT_HIST_LIST - 1)] =
+				ev[i].impl_opaque;
+	}
+
 	p->outstanding_releases += ndeq;
 	p->last_dequeue_burst_sz = ndeq;
 	p->last_dequeue_ticks = rte_get_timer_cycles();
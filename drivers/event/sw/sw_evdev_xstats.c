@@ -47,31 +47,52 @@ struct sw_xstats_entry {
 };
 
 static uint64_t
-get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
-		enum xstats_type type, int extra_arg __rte_unused)
+get_shard_stat(const struct sw_sched_shard *shard, enum xstats_type type)
 {
 	switch (type) {
-	case rx: return sw->stats.rx_pkts;
-	case tx: return sw->stats.tx_pkts;
-	case dropped: return sw->stats.rx_dropped;
-	case calls: return sw->sched_called;
-	case no_iq_enq: return sw->sched_no_iq_enqueues;
-	case no_cq_enq: return sw->sched_no_cq_enqueues;
+	case rx: return shard->stats.rx_pkts;
+	case tx: return shard->stats.tx_pkts;
+	case dropped: return shard->stats.rx_dropped;
+	case calls: return shard->sched_called;
+	case no_iq_enq: return shard->sched_no_iq_enqueues;
+	case no_cq_enq: return shard->sched_no_cq_enqueues;
 	default: return -1;
 	}
 }
 
+static uint64_t
+get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
+		enum xstats_type type, int extra_arg __rte_unused)
+{
+	uint64_t val = 0;
+	unsigned int i;
+
+	/* device stats are the sum of the stats of all shards */
+	for (i = 0; i < sw->sched_shards; i++)
+		val += get_shard_stat(&sw->shards[i], type);
+
+	return val;
+}
+
 static uint64_t
 get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		enum xstats_type type, int extra_arg __rte_unused)
 {
 	const struct sw_port *p = &sw->ports[obj_idx];
+	uint64_t val = 0;
+	unsigned int i;
 
 	switch (type) {
 	case rx: return p->stats.rx_pkts;
-	case tx: return p->stats.tx_pkts;
+	case tx:
+		for (i = 0; i < sw->sched_shards; i++)
+			val += sw->shards[i].ports[obj_idx].tx_pkts;
+		return val;
 	case dropped: return p->stats.rx_dropped;
-	case inflight: return p->inflights;
+	case inflight:
+		for (i = 0; i < sw->sched_shards; i++)
+			val += sw->shards[i].ports[obj_idx].inflights;
+		return val;
 	case pkt_cycles: return p->avg_pkt_ticks;
 	case calls: return p->total_polls;
 	case credits: return p->inflight_credits;
@@ -618,5 +618,7 @@ rte_pmd_softnic_manage(uint16_t port_id)
 
 	softnic_conn_poll_for_msg(softnic->conn);
 
+	softnic_thread_balance_auto(softnic);
+
 	return 0;
 }
@@ -2,6 +2,7 @@
  * Copyright(c) 2010-2018 Intel Corporation
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -28,6 +29,7 @@
 #define MSG_FILE_ERR        "Error in file \"%s\" at line %u.\n"
 #define MSG_FILE_NOT_ENOUGH "Not enough rules in file \"%s\".\n"
 #define MSG_CMD_FAIL        "Command \"%s\" failed.\n"
+#define MSG_LOAD_DISABLED   "Thread load measurement is disabled.\n"
 
 static int
 is_comment(char *in)
@@ -4869,6 +4871,135 @@ cmd_softnic_thread_pipeline_disable(struct pmd_internals *softnic,
 	}
 }
 
+/**
+ * thread load [period <period_ms>]
+ */
+static void
+cmd_softnic_thread_load(struct pmd_internals *softnic,
+	char **tokens,
+	uint32_t n_tokens,
+	char *out,
+	size_t out_size)
+{
+	uint64_t hz = rte_get_tsc_hz();
+	uint32_t thread_id, period_ms;
+	int status;
+
+	if ((n_tokens != 2) && (n_tokens != 4)) {
+		snprintf(out, out_size, MSG_ARG_MISMATCH, tokens[0]);
+		return;
+	}
+
+	if (n_tokens == 4) {
+		if (strcmp(tokens[2], "period") != 0) {
+			snprintf(out, out_size, MSG_ARG_NOT_FOUND, "period");
+			return;
+		}
+
+		if (softnic_parser_read_uint32(&period_ms, tokens[3]) != 0) {
+			snprintf(out, out_size, MSG_ARG_INVALID, "period_ms");
+			return;
+		}
+
+		status = softnic_thread_load_period_set(softnic,
+			period_ms,
+			softnic->balance.enabled);
+		if (status)
+			snprintf(out, out_size, MSG_CMD_FAIL,
+				"thread load period");
+		return;
+	}
+
+	/* Show the load of the last measurement period, do not restart it */
+	if (softnic->balance.period == 0) {
+		snprintf(out, out_size, MSG_LOAD_DISABLED);
+		return;
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(thread_id) {
+		struct softnic_thread *t = &softnic->thread[thread_id];
+		struct pipeline *p;
+		uint64_t period = RTE_MAX(t->period, 1LLU);
+
+		if (t->enabled == 0)
+			continue;
+
+		snprintf(out, out_size,
+			"Thread %u (%s): load %" PRIu64 "%%, %" PRIu64 " pkts/s\n",
+			thread_id,
+			t->active ? "active" : "inactive",
+			(t->n_cycles * 100) / period,
+			(uint64_t)((double)t->n_pkts * hz / period));
+		out_size -= strlen(out);
+		out += strlen(out);
+
+		TAILQ_FOREACH(p, &softnic->pipeline_list, node) {
+			if ((p->enabled == 0) || (p->thread_id != thread_id))
+				continue;
+
+			snprintf(out, out_size,
+				"\tPipeline %s: load %" PRIu64 "%%, %" PRIu64
+				" pkts/s\n",
+				p->name,
+				(p->n_cycles * 100) / period,
+				(uint64_t)((double)p->n_pkts * hz / period));
+			out_size -= strlen(out);
+			out += strlen(out);
+		}
+	}
+}
+
+/**
+ * thread balance [auto <period_ms>]
+ */
+static void
+cmd_softnic_thread_balance(struct pmd_internals *softnic,
+	char **tokens,
+	uint32_t n_tokens,
+	char *out,
+	size_t out_size)
+{
+	uint32_t n_moves, period_ms;
+	int status;
+
+	if ((n_tokens != 2) && (n_tokens != 4)) {
+		snprintf(out, out_size, MSG_ARG_MISMATCH, tokens[0]);
+		return;
+	}
+
+	if (n_tokens == 4) {
+		if (strcmp(tokens[2], "auto") != 0) {
+			snprintf(out, out_size, MSG_ARG_NOT_FOUND, "auto");
+			return;
+		}
+
+		if (softnic_parser_read_uint32(&period_ms, tokens[3]) != 0) {
+			snprintf(out, out_size, MSG_ARG_INVALID, "period_ms");
+			return;
+		}
+
+		status = softnic_thread_load_period_set(softnic, period_ms, 1);
+		if (status)
+			snprintf(out, out_size, MSG_CMD_FAIL,
+				"thread balance auto");
+		return;
+	}
+
+	/* Balance based on the load of the last measurement period */
+	if (softnic->balance.period == 0) {
+		snprintf(out, out_size, MSG_LOAD_DISABLED);
+		return;
+	}
+
+	status = softnic_thread_pipeline_balance(softnic, &n_moves);
+	if (status) {
+		snprintf(out, out_size, MSG_CMD_FAIL, "thread balance");
+		return;
+	}
+
+	snprintf(out, out_size, "%u pipeline(s) moved.\n", n_moves);
+}
+
 /**
  * flowapi map
  *  group <group_id>
@@ -5221,6 +5352,20 @@ softnic_cli_process(char *in, char *out, size_t out_size, void *arg)
 	}
 
 	if (strcmp(tokens[0], "thread") == 0) {
+		if (n_tokens >= 2 &&
+			(strcmp(tokens[1], "load") == 0)) {
+			cmd_softnic_thread_load(softnic, tokens, n_tokens,
+				out, out_size);
+			return;
+		}
+
+		if (n_tokens >= 2 &&
+			(strcmp(tokens[1], "balance") == 0)) {
+			cmd_softnic_thread_balance(softnic, tokens, n_tokens,
+				out, out_size);
+			return;
+		}
+
 		if (n_tokens >= 5 &&
 			(strcmp(tokens[4], "enable") == 0)) {
 			cmd_softnic_thread_pipeline_enable(softnic, tokens, n_tokens,
@@ -488,6 +488,14 @@ struct pipeline {
 	int enabled;
 	uint32_t thread_id;
 	uint32_t cpu_id;
+
+	/* Load: data plane thread counters at the last read and their increase
+	 * during the last measurement period.
+	 */
+	uint64_t n_pkts_last;
+	uint64_t n_cycles_last;
+	uint64_t n_pkts;
+	uint64_t n_cycles;
 };
 
 TAILQ_HEAD(pipeline_list, pipeline);
@@ -507,6 +515,13 @@ TAILQ_HEAD(pipeline_list, pipeline);
 #define THREAD_TIMER_PERIOD_MS                             100
 #endif
 
+/** Minimum load difference between two data plane threads that triggers a
+ * pipeline migration, as percentage of the CPU cycles.
+ */
+#ifndef THREAD_BALANCE_THRESHOLD
+#define THREAD_BALANCE_THRESHOLD                           10
+#endif
+
 /**
  * Master thead: data plane thread context
  */
@@ -515,6 +530,16 @@ struct softnic_thread {
 	struct rte_ring *msgq_rsp;
 
 	uint32_t enabled;
+
+	/* Load: the thread is active when it ran the data plane during the last
+	 * measurement period, which lasted for *period* CPU cycles.
+	 */
+	uint64_t iter_last;
+	uint64_t time_last;
+	uint64_t period;
+	uint64_t n_pkts;
+	uint64_t n_cycles;
+	int active;
 };
 
 /**
@@ -538,6 +563,9 @@ struct pipeline_data {
 	uint64_t timer_period; /* Measured in CPU cycles. */
 	uint64_t time_next;
 
+	uint64_t n_pkts;
+	uint64_t n_cycles; /* Spent on the pipeline runs that found packets. */
+
 	uint8_t buffer[TABLE_RULE_ACTION_SIZE_MAX];
 };
 
@@ -579,6 +607,12 @@ struct pmd_internals {
 	struct pipeline_list pipeline_list;
 	struct softnic_thread thread[RTE_MAX_LCORE];
 	struct softnic_thread_data thread_data[RTE_MAX_LCORE];
+
+	struct {
+		uint64_t period; /* Measured in CPU cycles, 0 = disabled. */
+		uint64_t time_next;
+		int enabled; /* Automatic pipeline balancing. */
+	} balance;
 };
 
 static inline struct rte_eth_dev *
@@ -1040,6 +1074,21 @@ softnic_thread_pipeline_disable(struct pmd_internals *p,
 	uint32_t thread_id,
 	const char *pipeline_name);
 
+int
+softnic_thread_load_update(struct pmd_internals *p);
+
+int
+softnic_thread_pipeline_balance(struct pmd_internals *p,
+	uint32_t *n_moves);
+
+int
+softnic_thread_load_period_set(struct pmd_internals *p,
+	uint32_t period_ms,
+	int balance_auto);
+
+void
+softnic_thread_balance_auto(struct pmd_internals *p);
+
 /**
  * CLI
  */
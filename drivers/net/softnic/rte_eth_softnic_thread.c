@@ -81,6 +81,7 @@ softnic_thread_init(struct pmd_internals *softnic)
 		t->msgq_req = msgq_req;
 		t->msgq_rsp = msgq_rsp;
 		t->enabled = 1;
+		t->time_last = rte_get_tsc_cycles();
 
 		/* Data plane thread records */
 		t_data->n_pipelines = 0;
@@ -124,6 +125,7 @@ pipeline_is_running(struct pipeline *p)
 enum thread_req_type {
 	THREAD_REQ_PIPELINE_ENABLE = 0,
 	THREAD_REQ_PIPELINE_DISABLE,
+	THREAD_REQ_STATS_READ,
 	THREAD_REQ_MAX
 };
 
@@ -148,10 +150,43 @@ struct thread_msg_req {
 	};
 };
 
+struct thread_stats {
+	uint64_t iter;
+	uint32_t n_pipelines;
+
+	struct {
+		struct rte_pipeline *p;
+		uint64_t n_pkts;
+		uint64_t n_cycles;
+	} pipeline[THREAD_PIPELINES_MAX];
+};
+
 struct thread_msg_rsp {
 	int status;
+
+	union {
+		struct thread_stats stats_read;
+	};
 };
 
+static void
+thread_stats_get(struct softnic_thread_data *t,
+	struct thread_stats *stats)
+{
+	uint32_t i;
+
+	stats->iter = t->iter;
+	stats->n_pipelines = t->n_pipelines;
+
+	for (i = 0; i < t->n_pipelines; i++) {
+		struct pipeline_data *p = &t->pipeline_data[i];
+
+		stats->pipeline[i].p = p->p;
+		stats->pipeline[i].n_pkts = p->n_pkts;
+		stats->pipeline[i].n_cycles = p->n_cycles;
+	}
+}
+
 /**
  * Master thread
  */
@@ -239,12 +274,16 @@ softnic_thread_pipeline_enable(struct pmd_internals *softnic,
 		tdp->msgq_rsp = p->msgq_rsp;
 		tdp->timer_period = (rte_get_tsc_hz() * p->timer_period_ms) / 1000;
 		tdp->time_next = rte_get_tsc_cycles() + tdp->timer_period;
+		tdp->n_pkts = 0;
+		tdp->n_cycles = 0;
 
 		td->n_pipelines++;
 
 		/* Pipeline */
 		p->thread_id = thread_id;
 		p->enabled = 1;
+		p->n_pkts_last = 0;
+		p->n_cycles_last = 0;
 
 		return 0;
 	}
@@ -282,6 +321,8 @@ softnic_thread_pipeline_enable(struct pmd_internals *softnic,
 
 	p->thread_id = thread_id;
 	p->enabled = 1;
+	p->n_pkts_last = 0;
+	p->n_cycles_last = 0;
 
 	return 0;
 }
@@ -373,6 +414,253 @@ softnic_thread_pipeline_disable(struct pmd_internals *softnic,
 	return 0;
 }
 
+static int
+thread_stats_read(struct pmd_internals *softnic,
+	uint32_t thread_id,
+	struct thread_stats *stats)
+{
+	struct thread_msg_req *req;
+	struct thread_msg_rsp *rsp;
+	int status;
+
+	if (!thread_is_running(thread_id)) {
+		thread_stats_get(&softnic->thread_data[thread_id], stats);
+		return 0;
+	}
+
+	/* Allocate request */
+	req = thread_msg_alloc();
+	if (req == NULL)
+		return -1;
+
+	/* Write request */
+	req->type = THREAD_REQ_STATS_READ;
+
+	/* Send request and wait for response */
+	rsp = thread_msg_send_recv(softnic, thread_id, req);
+	if (rsp == NULL)
+		return -1;
+
+	/* Read response */
+	status = rsp->status;
+	if (status == 0)
+		memcpy(stats, &rsp->stats_read, sizeof(*stats));
+
+	/* Free response */
+	thread_msg_free(rsp);
+
+	return status;
+}
+
+static struct pipeline *
+pipeline_find_by_ptr(struct pmd_internals *softnic,
+	struct rte_pipeline *p)
+{
+	struct pipeline *pipeline;
+
+	TAILQ_FOREACH(pipeline, &softnic->pipeline_list, node)
+		if (pipeline->p == p)
+			return pipeline;
+
+	return NULL;
+}
+
+/**
+ * Load of each data plane thread and pipeline since the previous update: the
+ * CPU cycles spent on the pipeline runs that found input packets and the
+ * number of packets.
+ */
+int
+softnic_thread_load_update(struct pmd_internals *softnic)
+{
+	struct thread_stats *stats;
+	uint32_t thread_id;
+
+	stats = malloc(sizeof(*stats));
+	if (stats == NULL)
+		return -1;
+
+	RTE_LCORE_FOREACH_SLAVE(thread_id) {
+		struct softnic_thread *t = &softnic->thread[thread_id];
+		uint64_t time;
+		uint32_t i;
+		int status;
+
+		if (t->enabled == 0)
+			continue;
+
+		status = thread_stats_read(softnic, thread_id, stats);
+		if (status) {
+			free(stats);
+			return status;
+		}
+
+		time = rte_get_tsc_cycles();
+		t->period = time - t->time_last;
+		t->time_last = time;
+		t->active = thread_is_running(thread_id) &&
+			(stats->iter != t->iter_last);
+		t->iter_last = stats->iter;
+		t->n_pkts = 0;
+		t->n_cycles = 0;
+
+		for (i = 0; i < stats->n_pipelines; i++) {
+			struct pipeline *p =
+				pipeline_find_by_ptr(softnic, stats->pipeline[i].p);
+
+			if (p == NULL)
+				continue;
+
+			p->n_pkts = stats->pipeline[i].n_pkts - p->n_pkts_last;
+			p->n_cycles = stats->pipeline[i].n_cycles -
+				p->n_cycles_last;
+			p->n_pkts_last = stats->pipeline[i].n_pkts;
+			p->n_cycles_last = stats->pipeline[i].n_cycles;
+
+			t->n_pkts += p->n_pkts;
+			t->n_cycles += p->n_cycles;
+		}
+	}
+
+	free(stats);
+	return 0;
+}
+
+/**
+ * Move pipelines from the most loaded to the least loaded active data plane
+ * thread, based on the load measured by the last softnic_thread_load_update(),
+ * until their load difference drops below THREAD_BALANCE_THRESHOLD. Each move
+ * picks the pipeline whose load is the closest to half of this difference, out
+ * of those smaller than the difference, so that every move strictly reduces
+ * the imbalance.
+ */
+int
+softnic_thread_pipeline_balance(struct pmd_internals *softnic,
+	uint32_t *n_moves)
+{
+	*n_moves = 0;
+
+	for ( ; ; ) {
+		struct softnic_thread *t_max = NULL, *t_min = NULL;
+		struct pipeline *p, *p_move = NULL;
+		uint32_t thread_id, id_max = 0, id_min = 0;
+		uint64_t gap, dist_min = UINT64_MAX;
+		int status;
+
+		RTE_LCORE_FOREACH_SLAVE(thread_id) {
+			struct softnic_thread *t = &softnic->thread[thread_id];
+
+			if ((t->enabled == 0) || (t->active == 0))
+				continue;
+
+			if ((t_max == NULL) || (t->n_cycles > t_max->n_cycles)) {
+				t_max = t;
+				id_max = thread_id;
+			}
+
+			if ((t_min == NULL) || (t->n_cycles < t_min->n_cycles)) {
+				t_min = t;
+				id_min = thread_id;
+			}
+		}
+
+		if ((t_max == NULL) || (t_max == t_min))
+			return 0;
+
+		gap = t_max->n_cycles - t_min->n_cycles;
+		if (gap * 100 < t_max->period * THREAD_BALANCE_THRESHOLD)
+			return 0;
+
+		TAILQ_FOREACH(p, &softnic->pipeline_list, node) {
+			uint64_t dist;
+
+			if ((p->enabled == 0) ||
+				(p->thread_id != id_max) ||
+				(p->n_cycles == 0) ||
+				(p->n_cycles >= gap))
+				continue;
+
+			dist = (2 * p->n_cycles > gap) ?
+				2 * p->n_cycles - gap : gap - 2 * p->n_cycles;
+			if (dist < dist_min) {
+				p_move = p;
+				dist_min = dist;
+			}
+		}
+
+		if (p_move == NULL)
+			return 0;
+
+		/* Migrate */
+		status = softnic_thread_pipeline_disable(softnic,
+			id_max,
+			p_move->name);
+		if (status)
+			return status;
+
+		status = softnic_thread_pipeline_enable(softnic,
+			id_min,
+			p_move->name);
+		if (status) {
+			softnic_thread_pipeline_enable(softnic,
+				id_max,
+				p_move->name);
+			return status;
+		}
+
+		t_max->n_pkts -= p_move->n_pkts;
+		t_max->n_cycles -= p_move->n_cycles;
+		t_min->n_pkts += p_move->n_pkts;
+		t_min->n_cycles += p_move->n_cycles;
+		(*n_moves)++;
+	}
+}
+
+/**
+ * Set the load measurement period (0 = disabled), optionally followed by the
+ * automatic pipeline balancing at the end of each period. The data plane
+ * threads read the CPU cycles of each pipeline run only while this period is
+ * not zero.
+ */
+int
+softnic_thread_load_period_set(struct pmd_internals *softnic,
+	uint32_t period_ms,
+	int balance_auto)
+{
+	uint64_t period = (rte_get_tsc_hz() * period_ms) / 1000;
+	int status = 0;
+
+	/* Start a new measurement window */
+	if ((period != 0) && (softnic->balance.period == 0))
+		status = softnic_thread_load_update(softnic);
+
+	softnic->balance.period = period;
+	softnic->balance.time_next = rte_get_tsc_cycles() + period;
+	softnic->balance.enabled = (period != 0) && balance_auto;
+
+	return status;
+}
+
+void
+softnic_thread_balance_auto(struct pmd_internals *softnic)
+{
+	uint64_t time;
+	uint32_t n_moves;
+
+	if (softnic->balance.period == 0)
+		return;
+
+	time = rte_get_tsc_cycles();
+	if (time < softnic->balance.time_next)
+		return;
+
+	softnic->balance.time_next = time + softnic->balance.period;
+
+	if ((softnic_thread_load_update(softnic) == 0) &&
+		softnic->balance.enabled)
+		softnic_thread_pipeline_balance(softnic, &n_moves);
+}
+
 /**
  * Data plane threads: message handling
  */
@@ -428,6 +716,8 @@ thread_msg_handle_pipeline_enable(struct softnic_thread_data *t,
 	p->timer_period =
 		(rte_get_tsc_hz() * req->pipeline_enable.timer_period_ms) / 1000;
 	p->time_next = rte_get_tsc_cycles() + p->timer_period;
+	p->n_pkts = 0;
+	p->n_cycles = 0;
 
 	t->n_pipelines++;
 
@@ -473,6 +763,18 @@ thread_msg_handle_pipeline_disable(struct softnic_thread_data *t,
 	return rsp;
 }
 
+static struct thread_msg_rsp *
+thread_msg_handle_stats_read(struct softnic_thread_data *t,
+	struct thread_msg_req *req)
+{
+	struct thread_msg_rsp *rsp = (struct thread_msg_rsp *)req;
+
+	thread_stats_get(t, &rsp->stats_read);
+
+	rsp->status = 0;
+	return rsp;
+}
+
 static void
 thread_msg_handle(struct softnic_thread_data *t)
 {
@@ -493,6 +795,10 @@ thread_msg_handle(struct softnic_thread_data *t)
 			rsp = thread_msg_handle_pipeline_disable(t, req);
 			break;
 
+		case THREAD_REQ_STATS_READ:
+			rsp = thread_msg_handle_stats_read(t, req);
+			break;
+
 		default:
 			rsp = (struct thread_msg_rsp *)req;
 			rsp->status = -1;
@@ -2946,8 +3252,25 @@ rte_pmd_softnic_run(uint16_t port_id)
 	t->iter++;
 
 	/* Data Plane */
-	for (j = 0; j < t->n_pipelines; j++)
-		rte_pipeline_run(t->p[j]);
+	if (softnic->balance.period == 0) {
+		for (j = 0; j < t->n_pipelines; j++)
+			rte_pipeline_run(t->p[j]);
+	} else {
+		uint64_t time = rte_rdtsc();
+
+		for (j = 0; j < t->n_pipelines; j++) {
+			struct pipeline_data *p = &t->pipeline_data[j];
+			int n_pkts = rte_pipeline_run(t->p[j]);
+			uint64_t time_end = rte_rdtsc();
+
+			if (n_pkts > 0) {
+				p->n_pkts += n_pkts;
+				p->n_cycles += time_end - time;
+			}
+
+			time = time_end;
+		}
+	}
 
 	/* Control Plane */
 	if ((t->iter & 0xFLLU) == 0) {
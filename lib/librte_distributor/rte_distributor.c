@@ -10,6 +10,7 @@
 #include <rte_cycles.h>
 #include <rte_compat.h>
 #include <rte_memzone.h>
+#include <rte_malloc.h>
 #include <rte_errno.h>
 #include <rte_string_fns.h>
 #include <rte_eal_memconfig.h>
@@ -62,7 +63,7 @@ rte_distributor_request_pkt_v1705(struct rte_distributor *d,
 	 * handshake bits. Populate the retptrs with returning packets.
 	 */
 
-	for (i = count; i < RTE_DIST_BURST_SIZE; i++)
+	for (i = count; i < buf->burst_size; i++)
 		buf->retptr64[i] = 0;
 
 	/* Set Return bit for each packet returned */
@@ -102,7 +103,7 @@ rte_distributor_poll_pkt_v1705(struct rte_distributor *d,
 		return -1;
 
 	/* since bufptr64 is signed, this should be an arithmetic shift */
-	for (i = 0; i < RTE_DIST_BURST_SIZE; i++) {
+	for (i = 0; i < buf->burst_size; i++) {
 		if (likely(buf->bufptr64[i] & RTE_DISTRIB_VALID_BUF)) {
 			ret = buf->bufptr64[i] >> RTE_DISTRIB_FLAG_BITS;
 			pkts[count++] = (struct rte_mbuf *)((uintptr_t)(ret));
@@ -173,7 +174,7 @@ rte_distributor_return_pkt_v1705(struct rte_distributor *d,
 			return -EINVAL;
 	}
 
-	for (i = 0; i < RTE_DIST_BURST_SIZE; i++)
+	for (i = 0; i < buf->burst_size; i++)
 		/* Switch off the return bit first */
 		buf->retptr64[i] &= ~RTE_DISTRIB_RETURN_BUF;
 
@@ -191,6 +192,30 @@ MAP_STATIC_SYMBOL(int rte_distributor_return_pkt(struct rte_distributor *d,
 		unsigned int worker_id, struct rte_mbuf **oldpkt, int num),
 		rte_distributor_return_pkt_v1705);
 
+int __rte_experimental
+rte_distributor_burst_size_set(struct rte_distributor *d,
+		unsigned int worker_id, unsigned int burst_size)
+{
+	if (d == NULL)
+		return -EINVAL;
+
+	if (d->alg_type == RTE_DIST_ALG_SINGLE)
+		return -ENOTSUP;
+
+	if (worker_id >= d->num_workers || burst_size == 0 ||
+			burst_size > RTE_DIST_MAX_BURST_SIZE)
+		return -EINVAL;
+
+	if (d->alg_type != RTE_DIST_ALG_BURST_HASH &&
+			burst_size != RTE_DIST_BURST_SIZE)
+		return -ENOTSUP;
+
+	d->bufs[worker_id].burst_size = burst_size;
+	rte_smp_wmb();
+
+	return 0;
+}
+
 /**** APIs called on distributor core ***/
 
 /* stores a packet returned from a worker inside the returns array */
@@ -273,7 +298,7 @@ handle_returns(struct rte_distributor *d, unsigned int wkr)
 	unsigned int i;
 
 	if (buf->retptr64[0] & RTE_DISTRIB_GET_BUF) {
-		for (i = 0; i < RTE_DIST_BURST_SIZE; i++) {
+		for (i = 0; i < buf->burst_size; i++) {
 			if (buf->retptr64[i] & RTE_DISTRIB_RETURN_BUF) {
 				oldbuf = ((uintptr_t)(buf->retptr64[i] >>
 					RTE_DISTRIB_FLAG_BITS));
@@ -311,6 +336,13 @@ release(struct rte_distributor *d, unsigned int wkr)
 
 	handle_returns(d, wkr);
 
+	/* The worker is done with its last burst, so are those flows */
+	if (d->flows != NULL) {
+		for (i = 0; i < buf->burst_size; i++)
+			if (d->in_flight_tags[wkr][i] != 0)
+				d->flows[d->in_flight_tags[wkr][i] >> 1].count--;
+	}
+
 	buf->count = 0;
 
 	for (i = 0; i < d->backlog[wkr].count; i++) {
@@ -319,7 +351,7 @@ release(struct rte_distributor *d, unsigned int wkr)
 		d->in_flight_tags[wkr][i] = d->backlog[wkr].tags[i];
 	}
 	buf->count = i;
-	for ( ; i < RTE_DIST_BURST_SIZE ; i++) {
+	for ( ; i < buf->burst_size ; i++) {
 		buf->bufptr64[i] = RTE_DISTRIB_GET_BUF;
 		d->in_flight_tags[wkr][i] = 0;
 	}
@@ -332,6 +364,54 @@ release(struct rte_distributor *d, unsigned int wkr)
 
 }
 
+/*
+ * Distribute packets using the flow table: a packet goes to the worker
+ * already holding packets of its flow, either queued or in flight, and
+ * packets of new flows go to the worker currently being filled.
+ */
+static int
+process_flow_table(struct rte_distributor *d,
+		struct rte_mbuf **mbufs, unsigned int num_mbufs)
+{
+	struct rte_distributor_backlog *bl;
+	struct rte_distributor_flow *flow;
+	unsigned int wkr = d->next_wkr;
+	unsigned int i, wid;
+	uint16_t tag;
+
+	for (i = 0; i < num_mbufs; i++) {
+		/* Tags must be non-zero, so set the LSB */
+		tag = (uint16_t)mbufs[i]->hash.usr | 1;
+		flow = &d->flows[tag >> 1];
+
+		if (flow->count == 0)
+			flow->wkr = wkr;
+		wid = flow->wkr;
+
+		bl = &d->backlog[wid];
+		if (unlikely(bl->count == d->bufs[wid].burst_size))
+			release(d, wid);
+
+		bl->tags[bl->count] = tag;
+		bl->pkts[bl->count++] = (((int64_t)(uintptr_t)mbufs[i]) <<
+				RTE_DISTRIB_FLAG_BITS);
+		flow->count++;
+
+		/* Move new flows on once a full burst is queued */
+		if (d->backlog[wkr].count == d->bufs[wkr].burst_size) {
+			if (++wkr == d->num_workers)
+				wkr = 0;
+		}
+	}
+	d->next_wkr = wkr;
+
+	/* Flush out all non-full cache-lines to workers. */
+	for (wid = 0 ; wid < d->num_workers; wid++)
+		if ((d->bufs[wid].bufptr64[0] & RTE_DISTRIB_GET_BUF))
+			release(d, wid);
+
+	return num_mbufs;
+}
 
 /* process a set of packets to distribute them to workers */
 int
@@ -362,6 +442,9 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 		return 0;
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_BURST_HASH)
+		return process_flow_table(d, mbufs, num_mbufs);
+
 	while (next_idx < num_mbufs) {
 		uint16_t matches[RTE_DIST_BURST_SIZE];
 		unsigned int pkts;
@@ -587,6 +670,7 @@ rte_distributor_create_v1705(const char *name,
 	struct rte_dist_burst_list *dist_burst_list;
 	char mz_name[RTE_MEMZONE_NAMESIZE];
 	const struct rte_memzone *mz;
+	struct rte_distributor_flow *flows = NULL;
 	unsigned int i;
 
 	/* TODO Reorganise function properly around RTE_DIST_ALG_SINGLE/BURST */
@@ -612,14 +696,32 @@ rte_distributor_create_v1705(const char *name,
 		return d;
 	}
 
-	if (name == NULL || num_workers >= RTE_DISTRIB_MAX_WORKERS) {
+	if (name == NULL || alg_type >= RTE_DIST_NUM_ALG_TYPES) {
 		rte_errno = EINVAL;
 		return NULL;
 	}
 
+	if (alg_type == RTE_DIST_ALG_BURST_HASH ?
+			num_workers > RTE_DIST_HASH_MAX_WORKERS :
+			num_workers >= RTE_DISTRIB_MAX_WORKERS) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	if (alg_type == RTE_DIST_ALG_BURST_HASH) {
+		flows = rte_zmalloc_socket(NULL,
+				RTE_DIST_FLOW_TABLE_SIZE * sizeof(*flows),
+				RTE_CACHE_LINE_SIZE, socket_id);
+		if (flows == NULL) {
+			rte_errno = ENOMEM;
+			return NULL;
+		}
+	}
+
 	snprintf(mz_name, sizeof(mz_name), RTE_DISTRIB_PREFIX"%s", name);
 	mz = rte_memzone_reserve(mz_name, sizeof(*d), socket_id, NO_FLAGS);
 	if (mz == NULL) {
+		rte_free(flows);
 		rte_errno = ENOMEM;
 		return NULL;
 	}
@@ -628,6 +730,8 @@ rte_distributor_create_v1705(const char *name,
 	snprintf(d->name, sizeof(d->name), "%s", name);
 	d->num_workers = num_workers;
 	d->alg_type = alg_type;
+	d->flows = flows;
+	d->next_wkr = 0;
 
 	d->dist_match_fn = RTE_DIST_MATCH_SCALAR;
 #if defined(RTE_ARCH_X86)
@@ -638,8 +742,11 @@ rte_distributor_create_v1705(const char *name,
 	 * Set up the backlog tags so they're pointing at the second cache
 	 * line for performance during flow matching
 	 */
-	for (i = 0 ; i < num_workers ; i++)
-		d->backlog[i].tags = &d->in_flight_tags[i][RTE_DIST_BURST_SIZE];
+	for (i = 0 ; i < num_workers ; i++) {
+		d->backlog[i].tags =
+				&d->in_flight_tags[i][RTE_DIST_MAX_BURST_SIZE];
+		d->bufs[i].burst_size = RTE_DIST_BURST_SIZE;
+	}
 
 	dist_burst_list = RTE_TAILQ_CAST(rte_dist_burst_tailq.head,
 					  rte_dist_burst_list);
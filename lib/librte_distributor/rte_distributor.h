@@ -13,6 +13,8 @@
  * one-at-a-time to workers, with dynamic load balancing.
  */
 
+#include <rte_compat.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -21,9 +23,16 @@ extern "C" {
 enum rte_distributor_alg_type {
 	RTE_DIST_ALG_BURST = 0,
 	RTE_DIST_ALG_SINGLE,
+	RTE_DIST_ALG_BURST_HASH, /**< burst API tracking flows in a table */
 	RTE_DIST_NUM_ALG_TYPES
 };
 
+/** Maximum number of workers of a RTE_DIST_ALG_BURST_HASH distributor */
+#define RTE_DIST_HASH_MAX_WORKERS 256
+
+/** Largest burst a worker can request, see rte_distributor_burst_size_set() */
+#define RTE_DIST_MAX_BURST_SIZE 32
+
 struct rte_distributor;
 struct rte_mbuf;
 
@@ -44,6 +53,8 @@ struct rte_mbuf;
  *   Call the legacy API, or use the new burst API. legacy uses 32-bit
  *   flow ID, and works on a single packet at a time. Latest uses 15-
  *   bit flow ID and works on up to 8 packets at a time to workers.
+ *   RTE_DIST_ALG_BURST_HASH is the burst API with a flow table, it
+ *   scales to more workers and lets them request larger bursts.
  * @return
  *   The newly created distributor instance
  */
@@ -153,7 +164,8 @@ rte_distributor_clear_returns(struct rte_distributor *d);
  *   The worker instance number to use - must be less that num_workers passed
  *   at distributor creation time.
  * @param pkts
- *   The mbufs pointer array to be filled in (up to 8 packets)
+ *   The mbufs pointer array to be filled in (up to 8 packets, or up to
+ *   the burst size set with rte_distributor_burst_size_set())
  * @param oldpkt
  *   The previous packet, if any, being processed by the worker
  * @param retcount
@@ -234,6 +246,32 @@ int
 rte_distributor_poll_pkt(struct rte_distributor *d,
 		unsigned int worker_id, struct rte_mbuf **mbufs);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * API called by a worker to set the number of packets it receives and
+ * returns per burst. It must be called before the worker first requests
+ * packets. The pkts and oldpkt arrays the worker passes afterwards must
+ * hold burst_size entries.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param burst_size
+ *   Packets per burst, up to RTE_DIST_MAX_BURST_SIZE. Only
+ *   RTE_DIST_ALG_BURST_HASH distributors support sizes other than 8.
+ * @return
+ *   - 0: Success
+ *   - -EINVAL: Invalid worker or burst size
+ *   - -ENOTSUP: Burst size not supported by the distributor type
+ */
+int __rte_experimental
+rte_distributor_burst_size_set(struct rte_distributor *d,
+		unsigned int worker_id, unsigned int burst_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,6 +13,8 @@
  * one-at-a-time to workers, with dynamic load balancing.
  */
 
+#include "rte_distributor.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -66,13 +68,28 @@ union rte_distributor_buffer_v20 {
  */
 #define RTE_DIST_BURST_SIZE 8
 
+/*
+ * Number of distinct burst mode tags. Tags always have their lowest bit set,
+ * so the flow table is indexed by the upper 15 bits.
+ */
+#define RTE_DIST_FLOW_TABLE_SIZE (1 << 15)
+
 struct rte_distributor_backlog {
 	unsigned int start;
 	unsigned int count;
-	int64_t pkts[RTE_DIST_BURST_SIZE] __rte_cache_aligned;
+	int64_t pkts[RTE_DIST_MAX_BURST_SIZE] __rte_cache_aligned;
 	uint16_t *tags; /* will point to second cacheline of inflights */
 } __rte_cache_aligned;
 
+/*
+ * Flow table entry, used by RTE_DIST_ALG_BURST_HASH in place of scanning the
+ * in-flight and backlog tags of every worker.
+ */
+struct rte_distributor_flow {
+	uint16_t wkr;   /**< Worker the flow is pinned to while count != 0 */
+	uint16_t count; /**< Packets of the flow in backlog or in flight */
+};
+
 
 struct rte_distributor_returned_pkts {
 	unsigned int start;
@@ -113,21 +130,23 @@ enum rte_distributor_match_function {
  * line aligned, but to improve performance and prevent adjacent cache-line
  * prefetches of buffers for other workers, e.g. when worker 1's buffer is on
  * the next cache line to worker 0, we pad this out to two cache lines.
- * We can pass up to 8 mbufs at a time in one cacheline.
- * There is a separate cacheline for returns in the burst API.
+ * We can pass up to 8 mbufs at a time in one cacheline, workers which
+ * requested a larger burst use as many cachelines as their burst needs.
+ * There is a separate set of cachelines for returns in the burst API.
  */
 struct rte_distributor_buffer {
-	volatile int64_t bufptr64[RTE_DIST_BURST_SIZE]
+	volatile int64_t bufptr64[RTE_DIST_MAX_BURST_SIZE]
 		__rte_cache_aligned; /* <= outgoing to worker */
 
 	int64_t pad1 __rte_cache_aligned;    /* <= one cache line  */
 
-	volatile int64_t retptr64[RTE_DIST_BURST_SIZE]
+	volatile int64_t retptr64[RTE_DIST_MAX_BURST_SIZE]
 		__rte_cache_aligned; /* <= incoming from worker */
 
 	int64_t pad2 __rte_cache_aligned;    /* <= one cache line  */
 
 	int count __rte_cache_aligned;       /* <= number of current mbufs */
+	unsigned int burst_size;             /* <= mbufs per burst */
 };
 
 struct rte_distributor {
@@ -142,18 +161,22 @@ struct rte_distributor {
 	 * on the worker core. Second cache line are the backlog
 	 * that are going to go to the worker core.
 	 */
-	uint16_t in_flight_tags[RTE_DISTRIB_MAX_WORKERS][RTE_DIST_BURST_SIZE*2]
-			__rte_cache_aligned;
+	uint16_t in_flight_tags[RTE_DIST_HASH_MAX_WORKERS]
+			[RTE_DIST_MAX_BURST_SIZE*2] __rte_cache_aligned;
 
-	struct rte_distributor_backlog backlog[RTE_DISTRIB_MAX_WORKERS]
+	struct rte_distributor_backlog backlog[RTE_DIST_HASH_MAX_WORKERS]
 			__rte_cache_aligned;
 
-	struct rte_distributor_buffer bufs[RTE_DISTRIB_MAX_WORKERS];
+	struct rte_distributor_buffer bufs[RTE_DIST_HASH_MAX_WORKERS];
 
 	struct rte_distributor_returned_pkts returns;
 
 	enum rte_distributor_match_function dist_match_fn;
 
+	/* Tag to worker table, only used by RTE_DIST_ALG_BURST_HASH */
+	struct rte_distributor_flow *flows;
+	unsigned int next_wkr; /**< Worker new flows are assigned to */
+
 	struct rte_distributor_v20 *d_v20;
 };
 
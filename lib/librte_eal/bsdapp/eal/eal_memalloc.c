@@ -19,6 +19,15 @@ eal_memalloc_alloc_seg_bulk(struct rte_memseg **ms __rte_unused,
 	return -1;
 }
 
+int
+eal_memalloc_prefault_segs(size_t __rte_unused page_sz,
+		const unsigned int __rte_unused *n_segs,
+		unsigned int __rte_unused n_threads)
+{
+	RTE_LOG(ERR, EAL, "Memory hotplug not supported on FreeBSD\n");
+	return -1;
+}
+
 struct rte_memseg *
 eal_memalloc_alloc_seg(size_t __rte_unused page_sz, int __rte_unused socket)
 {
@@ -78,6 +78,7 @@ eal_long_options[] = {
 	{OPT_VMWARE_TSC_MAP,    0, NULL, OPT_VMWARE_TSC_MAP_NUM   },
 	{OPT_LEGACY_MEM,        0, NULL, OPT_LEGACY_MEM_NUM       },
 	{OPT_SINGLE_FILE_SEGMENTS, 0, NULL, OPT_SINGLE_FILE_SEGMENTS_NUM},
+	{OPT_HUGE_PREFAULT,     1, NULL, OPT_HUGE_PREFAULT_NUM    },
 	{0,                     0, NULL, 0                        }
 };
 
@@ -182,6 +183,7 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 	for (i = 0; i < RTE_MAX_NUMA_NODES; i++)
 		internal_cfg->socket_mem[i] = 0;
 	internal_cfg->force_socket_limits = 0;
+	internal_cfg->huge_prefault_threads = 0;
 	/* zero out the NUMA limits config */
 	for (i = 0; i < RTE_MAX_NUMA_NODES; i++)
 		internal_cfg->socket_limit[i] = 0;
@@ -1390,6 +1392,13 @@ eal_check_common_options(struct internal_config *internal_cfg)
 			"not compatible with --"OPT_HUGE_UNLINK"\n");
 		return -1;
 	}
+	if (internal_cfg->huge_prefault_threads != 0 &&
+			(internal_cfg->legacy_mem ||
+			 internal_cfg->no_hugetlbfs)) {
+		RTE_LOG(ERR, EAL, "Option --"OPT_HUGE_PREFAULT" is only "
+			"supported in non-legacy hugepage memory mode\n");
+		return -1;
+	}
 	if (internal_cfg->legacy_mem &&
 			internal_cfg->in_memory) {
 		RTE_LOG(ERR, EAL, "Option --"OPT_LEGACY_MEM" is not compatible "
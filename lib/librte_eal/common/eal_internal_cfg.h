@@ -52,6 +52,10 @@ struct internal_config {
 	volatile uint64_t socket_mem[RTE_MAX_NUMA_NODES]; /**< amount of memory per socket */
 	volatile unsigned force_socket_limits;
 	volatile uint64_t socket_limit[RTE_MAX_NUMA_NODES]; /**< limit amount of memory per socket */
+	volatile unsigned int huge_prefault_threads;
+	/**< number of threads per socket allocating the memory requested
+	 * with --socket-mem at init, 0 to allocate it from the master thread.
+	 */
 	uintptr_t base_virtaddr;          /**< base address to try and reserve memory from */
 	volatile unsigned legacy_mem;
 	/**< true to enable legacy memory behavior (no dynamic allocation,
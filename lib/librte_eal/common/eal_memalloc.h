@@ -29,6 +29,21 @@ int
 eal_memalloc_alloc_seg_bulk(struct rte_memseg **ms, int n_segs, size_t page_sz,
 		int socket, bool exact);
 
+/*
+ * Allocate `n_segs[socket]` segments of page size `page_sz` on each socket,
+ * using `n_threads` threads per socket to map and fault in the pages in
+ * parallel. Placement of the pages on the requested sockets is verified.
+ *
+ * Allocation is exact: on failure, no segment is left allocated. Allocated
+ * segments are marked as not freeable, as this is meant for the memory
+ * preallocated at initialization.
+ *
+ * Returns 0 on success, -1 on failure.
+ */
+int
+eal_memalloc_prefault_segs(size_t page_sz, const unsigned int *n_segs,
+		unsigned int n_threads);
+
 /*
  * Deallocate segment
  */
@@ -63,6 +63,8 @@ enum {
 	OPT_LEGACY_MEM_NUM,
 #define OPT_SINGLE_FILE_SEGMENTS    "single-file-segments"
 	OPT_SINGLE_FILE_SEGMENTS_NUM,
+#define OPT_HUGE_PREFAULT     "huge-prefault"
+	OPT_HUGE_PREFAULT_NUM,
 	OPT_LONG_MAX_NUM
 };
 
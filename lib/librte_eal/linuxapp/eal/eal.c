@@ -428,6 +428,8 @@ eal_usage(const char *prgname)
 	       "  --"OPT_VFIO_INTR"         Interrupt mode for VFIO (legacy|msi|msix)\n"
 	       "  --"OPT_LEGACY_MEM"        Legacy memory mode (no dynamic allocation, contiguous segments)\n"
 	       "  --"OPT_SINGLE_FILE_SEGMENTS" Put all hugepage memory in single files\n"
+	       "  --"OPT_HUGE_PREFAULT" N     Allocate and pre-fault --"OPT_SOCKET_MEM" memory\n"
+	       "                      with N threads per socket (dynamic memory mode only)\n"
 	       "\n");
 	/* Allow the application to print its usage message too if hook is set */
 	if ( rte_application_usage_hook ) {
@@ -527,6 +529,23 @@ eal_parse_base_virtaddr(const char *arg)
 	return 0;
 }
 
+static int
+eal_parse_huge_prefault(const char *arg)
+{
+	char *end;
+	unsigned long n;
+
+	errno = 0;
+	n = strtoul(arg, &end, 10);
+	if (errno != 0 || arg[0] == '\0' || end == NULL || *end != '\0')
+		return -1;
+	if (n == 0 || n > RTE_MAX_LCORE)
+		return -1;
+
+	internal_config.huge_prefault_threads = n;
+	return 0;
+}
+
 static int
 eal_parse_vfio_intr(const char *mode)
 {
@@ -683,6 +702,16 @@ eal_parse_args(int argc, char **argv)
 			internal_config.create_uio_dev = 1;
 			break;
 
+		case OPT_HUGE_PREFAULT_NUM:
+			if (eal_parse_huge_prefault(optarg) < 0) {
+				RTE_LOG(ERR, EAL, "invalid parameter for --"
+						OPT_HUGE_PREFAULT "\n");
+				eal_usage(prgname);
+				ret = -1;
+				goto out;
+			}
+			break;
+
 		case OPT_MBUF_POOL_OPS_NAME_NUM:
 			internal_config.user_mbuf_pool_ops_name =
 			    strdup(optarg);
@@ -23,6 +23,8 @@
 #include <sys/time.h>
 #include <signal.h>
 #include <setjmp.h>
+#include <pthread.h>
+#include <time.h>
 #ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
 #include <numa.h>
 #include <numaif.h>
@@ -106,7 +108,8 @@ static struct {
 /** local copy of a memory map, used to synchronize memory hotplug in MP */
 static struct rte_memseg_list local_memsegs[RTE_MAX_MEMSEG_LISTS];
 
-static sigjmp_buf huge_jmpenv;
+/* per-thread, as segments may be allocated in parallel at init */
+static __thread sigjmp_buf huge_jmpenv;
 
 static void __rte_unused huge_sigbus_handler(int signo __rte_unused)
 {
@@ -1112,6 +1115,309 @@ eal_memalloc_alloc_seg(size_t page_sz, int socket)
 	return ms;
 }
 
+struct prefault_walk_param {
+	size_t page_sz;
+	unsigned int n_segs;
+	int socket;
+	int msl_idx;
+	int start_idx;
+};
+static int
+prefault_find_walk(const struct rte_memseg_list *msl, void *arg)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct prefault_walk_param *wa = arg;
+	int msl_idx, idx;
+
+	if (msl->page_sz != wa->page_sz)
+		return 0;
+	if (msl->socket_id != wa->socket)
+		return 0;
+
+	msl_idx = msl - mcfg->memsegs;
+	idx = rte_fbarray_find_next_n_free(&mcfg->memsegs[msl_idx].memseg_arr,
+			0, wa->n_segs);
+	if (idx < 0)
+		return 0;
+
+	wa->msl_idx = msl_idx;
+	wa->start_idx = idx;
+	return 1;
+}
+
+/* a range of segments of a memseg list, allocated by one thread */
+struct prefault_param {
+	pthread_t tid;
+	bool started;
+	struct hugepage_info *hi;
+	struct rte_memseg_list *msl;
+	unsigned int msl_idx;
+	unsigned int start_idx;
+	unsigned int n_segs;
+	unsigned int segs_allocated;
+	int socket;
+	struct timespec end;
+};
+
+static void *
+prefault_thread(void *arg)
+{
+	struct prefault_param *p = arg;
+	size_t page_sz = p->msl->page_sz;
+	unsigned int i;
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+	bool have_numa = false;
+	int oldpolicy;
+	struct bitmask *oldmask;
+
+	/* memory policy is per-thread */
+	if (check_numa()) {
+		oldmask = numa_allocate_nodemask();
+		prepare_numa(&oldpolicy, oldmask, p->socket);
+		have_numa = true;
+	}
+#endif
+
+	for (i = 0; i < p->n_segs; i++) {
+		unsigned int seg_idx = p->start_idx + i;
+		struct rte_memseg *cur;
+		void *map_addr;
+
+		cur = rte_fbarray_get(&p->msl->memseg_arr, seg_idx);
+		map_addr = RTE_PTR_ADD(p->msl->base_va, seg_idx * page_sz);
+
+		if (alloc_seg(cur, map_addr, p->socket, p->hi, p->msl_idx,
+				seg_idx))
+			break;
+	}
+	p->segs_allocated = i;
+	clock_gettime(CLOCK_MONOTONIC, &p->end);
+
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+	if (have_numa)
+		restore_numa(&oldpolicy, oldmask);
+#endif
+	return NULL;
+}
+
+/* count the pages of a range of segments that are not on the socket */
+static unsigned int
+prefault_verify_numa(struct rte_memseg_list *msl, unsigned int start_idx,
+		unsigned int n_segs, int socket)
+{
+	unsigned int misplaced = 0;
+#ifdef RTE_EAL_NUMA_AWARE_HUGEPAGES
+	void **addrs;
+	int *status;
+	unsigned int i;
+
+	if (!check_numa())
+		return 0;
+
+	addrs = malloc(sizeof(*addrs) * n_segs);
+	status = malloc(sizeof(*status) * n_segs);
+	if (addrs == NULL || status == NULL) {
+		RTE_LOG(ERR, EAL, "%s(): cannot allocate memory\n", __func__);
+		misplaced = n_segs;
+		goto out;
+	}
+	for (i = 0; i < n_segs; i++)
+		addrs[i] = RTE_PTR_ADD(msl->base_va,
+				(size_t)(start_idx + i) * msl->page_sz);
+
+	/* with no target nodes, move_pages() only reports page placement */
+	if (move_pages(0, n_segs, addrs, NULL, status, 0) < 0) {
+		RTE_LOG(ERR, EAL, "%s(): move_pages() failed: %s\n",
+			__func__, strerror(errno));
+		misplaced = n_segs;
+		goto out;
+	}
+	for (i = 0; i < n_segs; i++)
+		if (status[i] != socket)
+			misplaced++;
+out:
+	free(addrs);
+	free(status);
+#else
+	RTE_SET_USED(msl);
+	RTE_SET_USED(start_idx);
+	RTE_SET_USED(n_segs);
+	RTE_SET_USED(socket);
+#endif
+	return misplaced;
+}
+
+int
+eal_memalloc_prefault_segs(size_t page_sz, const unsigned int *n_segs,
+		unsigned int n_threads)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct prefault_param *params;
+	struct hugepage_info *hi = NULL;
+	unsigned int first[RTE_MAX_NUMA_NODES];
+	unsigned int n_workers[RTE_MAX_NUMA_NODES];
+	struct timespec start;
+	unsigned int total = 0, i, w;
+	int socket, ret = 0;
+
+	/* dynamic allocation not supported in legacy mode */
+	if (internal_config.legacy_mem || n_threads == 0)
+		return -1;
+
+	for (i = 0; i < RTE_DIM(internal_config.hugepage_info); i++) {
+		if (page_sz ==
+				internal_config.hugepage_info[i].hugepage_sz) {
+			hi = &internal_config.hugepage_info[i];
+			break;
+		}
+	}
+	if (!hi) {
+		RTE_LOG(ERR, EAL, "%s(): can't find relevant hugepage_info entry\n",
+			__func__);
+		return -1;
+	}
+
+	/* with single-file segments, the file of a memseg list is resized
+	 * for each page, so pages of one list can't be allocated in parallel.
+	 */
+	if (internal_config.single_file_segments)
+		n_threads = 1;
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		first[socket] = total;
+		n_workers[socket] = RTE_MIN(n_threads, n_segs[socket]);
+		total += n_workers[socket];
+	}
+	if (total == 0)
+		return 0;
+
+	params = calloc(total, sizeof(*params));
+	if (params == NULL) {
+		RTE_LOG(ERR, EAL, "%s(): cannot allocate memory\n", __func__);
+		return -1;
+	}
+
+	/* split the segments of each socket among its workers */
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		struct prefault_walk_param wa;
+		unsigned int start_idx;
+
+		if (n_workers[socket] == 0)
+			continue;
+
+		wa.page_sz = page_sz;
+		wa.n_segs = n_segs[socket];
+		wa.socket = socket;
+		/* memalloc is locked, so it's safe to use thread-unsafe version */
+		if (rte_memseg_list_walk_thread_unsafe(prefault_find_walk,
+				&wa) <= 0) {
+			RTE_LOG(ERR, EAL, "%s(): couldn't find suitable memseg_list for %u pages on socket %d\n",
+				__func__, n_segs[socket], socket);
+			free(params);
+			return -1;
+		}
+
+		start_idx = wa.start_idx;
+		for (w = 0; w < n_workers[socket]; w++) {
+			struct prefault_param *p = &params[first[socket] + w];
+
+			p->hi = hi;
+			p->msl = &mcfg->memsegs[wa.msl_idx];
+			p->msl_idx = wa.msl_idx;
+			p->socket = socket;
+			p->start_idx = start_idx;
+			p->n_segs = n_segs[socket] / n_workers[socket] +
+				(w < n_segs[socket] % n_workers[socket]);
+			start_idx += p->n_segs;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < total; i++) {
+		if (pthread_create(&params[i].tid, NULL, prefault_thread,
+				&params[i]) == 0)
+			params[i].started = true;
+		else
+			RTE_LOG(DEBUG, EAL, "%s(): cannot create thread, allocating from caller\n",
+				__func__);
+	}
+	/* ranges that did not get a thread are allocated from here */
+	for (i = 0; i < total; i++) {
+		if (!params[i].started)
+			prefault_thread(&params[i]);
+	}
+	for (i = 0; i < total; i++) {
+		if (params[i].started)
+			pthread_join(params[i].tid, NULL);
+	}
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		struct prefault_param *p = &params[first[socket]];
+		struct timespec end = start;
+		unsigned int allocated = 0, misplaced;
+		uint64_t elapsed_ms;
+
+		if (n_workers[socket] == 0)
+			continue;
+
+		for (w = 0; w < n_workers[socket]; w++) {
+			allocated += p[w].segs_allocated;
+			if (p[w].end.tv_sec > end.tv_sec ||
+					(p[w].end.tv_sec == end.tv_sec &&
+					 p[w].end.tv_nsec > end.tv_nsec))
+				end = p[w].end;
+		}
+		elapsed_ms = (uint64_t)(end.tv_sec - start.tv_sec) * 1000 +
+			(end.tv_nsec - start.tv_nsec) / 1000000;
+
+		if (allocated != n_segs[socket]) {
+			RTE_LOG(ERR, EAL, "Allocated %u of %u pages of size %zuM on socket %d\n",
+				allocated, n_segs[socket], page_sz >> 20,
+				socket);
+			ret = -1;
+			continue;
+		}
+
+		misplaced = prefault_verify_numa(p->msl, p->start_idx,
+				n_segs[socket], socket);
+		if (misplaced != 0) {
+			RTE_LOG(ERR, EAL, "%u of %u pages of size %zuM are not on socket %d\n",
+				misplaced, n_segs[socket], page_sz >> 20,
+				socket);
+			ret = -1;
+		}
+
+		RTE_LOG(INFO, EAL, "Prefaulted %u pages of size %zuM on socket %d with %u threads in %" PRIu64 " ms\n",
+			n_segs[socket], page_sz >> 20, socket,
+			n_workers[socket], elapsed_ms);
+	}
+
+	/* on success, mark all segments as used, otherwise free them */
+	for (i = 0; i < total; i++) {
+		struct prefault_param *p = &params[i];
+		unsigned int j;
+
+		for (j = 0; j < p->segs_allocated; j++) {
+			unsigned int seg_idx = p->start_idx + j;
+			struct rte_memseg *ms;
+
+			ms = rte_fbarray_get(&p->msl->memseg_arr, seg_idx);
+			if (ret == 0) {
+				ms->flags |= RTE_MEMSEG_FLAG_DO_NOT_FREE;
+				rte_fbarray_set_used(&p->msl->memseg_arr,
+						seg_idx);
+			} else if (free_seg(ms, hi, p->msl_idx, seg_idx)) {
+				RTE_LOG(DEBUG, EAL, "Cannot free page\n");
+			}
+		}
+		if (ret == 0 && p->segs_allocated > 0)
+			p->msl->version++;
+	}
+
+	free(params);
+	return ret;
+}
+
 int
 eal_memalloc_free_seg_bulk(struct rte_memseg **ms, int n_segs)
 {
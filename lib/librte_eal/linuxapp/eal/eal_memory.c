@@ -1711,6 +1711,18 @@ eal_hugepage_init(void)
 	for (hp_sz_idx = 0;
 			hp_sz_idx < (int)internal_config.num_hugepage_sizes;
 			hp_sz_idx++) {
+		/* allocate and fault in the pages of all sockets in parallel */
+		if (internal_config.huge_prefault_threads != 0) {
+			struct hugepage_info *hpi = &used_hp[hp_sz_idx];
+
+			if (eal_memalloc_prefault_segs(hpi->hugepage_sz,
+					hpi->num_pages,
+					internal_config.huge_prefault_threads)
+					< 0)
+				return -1;
+			continue;
+		}
+
 		for (socket_id = 0; socket_id < RTE_MAX_NUMA_NODES;
 				socket_id++) {
 			struct rte_memseg **pages;
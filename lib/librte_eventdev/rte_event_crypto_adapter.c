@@ -6,12 +6,14 @@
 #include <string.h>
 #include <stdbool.h>
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_dev.h>
 #include <rte_errno.h>
 #include <rte_cryptodev.h>
 #include <rte_cryptodev_pmd.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
+#include <rte_ring.h>
 #include <rte_service_component.h>
 
 #include "rte_eventdev.h"
@@ -22,32 +24,82 @@
 #define DEFAULT_MAX_NB 128
 #define CRYPTO_ADAPTER_NAME_LEN 32
 #define CRYPTO_ADAPTER_MEM_NAME_LEN 32
-#define CRYPTO_ADAPTER_MAX_EV_ENQ_RETRIES 100
 
-/* Flush an instance's enqueue buffers every CRYPTO_ENQ_FLUSH_THRESHOLD
- * iterations of eca_crypto_adapter_enq_run()
+/* Crypto ops buffered per queue pair, a full batch plus the ops left
+ * behind by a short cryptodev enqueue
  */
-#define CRYPTO_ENQ_FLUSH_THRESHOLD 1024
+#define CRYPTO_ADAPTER_OPS_BUFFER_SZ (2 * BATCH_SIZE)
+/* Completion events buffered per service function */
+#define CRYPTO_ADAPTER_EVENT_BUFFER_SZ (4 * BATCH_SIZE)
+/* Max time a crypto op is held in a queue pair buffer waiting for a
+ * full batch
+ */
+#define CRYPTO_ADAPTER_OPS_FLUSH_US 10
+/* Size of the ring used to hand over crypto ops to the service function
+ * a queue pair is assigned to
+ */
+#define CRYPTO_ADAPTER_OP_RING_SZ 1024
 
-struct rte_event_crypto_adapter {
-	/* Event device identifier */
-	uint8_t eventdev_id;
+struct rte_event_crypto_adapter;
+
+/* Queue pair serviced by a service function */
+struct eca_qp_entry {
+	uint8_t cdev_id;
+	uint16_t qp_id;
+};
+
+/* Per service function information, the queue pairs of the adapter
+ * are partitioned across its service functions
+ */
+struct eca_service {
+	/* Adapter the service function belongs to */
+	struct rte_event_crypto_adapter *adapter;
+	/* Index of the service function within the adapter */
+	uint8_t idx;
 	/* Event port identifier */
 	uint8_t event_port_id;
-	/* Store event device's implicit release capability */
-	uint8_t implicit_release_disabled;
 	/* Max crypto ops processed in any service function invocation */
 	uint32_t max_nb;
 	/* Lock to serialize config updates with service function */
 	rte_spinlock_t lock;
-	/* Next crypto device to be processed */
-	uint16_t next_cdev_id;
+	/* EAL service identifier */
+	uint32_t service_id;
+	/* Queue pairs assigned to this service function */
+	struct eca_qp_entry *qps;
+	/* Number of queue pairs assigned to this service function */
+	uint16_t nb_qps;
+	/* Next queue pair to dequeue completions from */
+	uint16_t next_qp;
+	/* Crypto ops received on another service function's event port
+	 * for one of this service function's queue pairs
+	 */
+	struct rte_ring *op_ring;
+	/* Events dequeued from the event port whose ops are in flight on
+	 * this service function's queue pairs and that are yet to be
+	 * released, only used if implicit release is disabled
+	 */
+	uint32_t nb_fwd_pending;
+	/* Count of completion events in events[] */
+	uint16_t nb_events;
+	/* Number of buffered completion events that triggers an enqueue */
+	uint16_t ev_flush_threshold;
+	/* Per service function stats */
+	struct rte_event_crypto_adapter_stats crypto_stats;
+	/* Completion events waiting to be enqueued */
+	struct rte_event events[CRYPTO_ADAPTER_EVENT_BUFFER_SZ];
+} __rte_cache_aligned;
+
+struct rte_event_crypto_adapter {
+	/* Event device identifier */
+	uint8_t eventdev_id;
 	/* Per crypto device structure */
 	struct crypto_device_info *cdevs;
-	/* Loop counter to flush crypto ops */
-	uint16_t transmit_loop_count;
-	/* Per instance stats structure */
-	struct rte_event_crypto_adapter_stats crypto_stats;
+	/* Number of service functions */
+	uint8_t nb_services;
+	/* Per service function structure */
+	struct eca_service *services;
+	/* Cycles after which a partially filled op buffer is flushed */
+	uint64_t flush_cycles;
 	/* Configuration callback for rte_service configuration */
 	rte_event_crypto_adapter_conf_cb conf_cb;
 	/* Configuration callback argument */
@@ -60,12 +112,12 @@ struct rte_event_crypto_adapter {
 	char mem_name[CRYPTO_ADAPTER_MEM_NAME_LEN];
 	/* Socket identifier cached from eventdev */
 	int socket_id;
-	/* Per adapter EAL service */
-	uint32_t service_id;
 	/* No. of queue pairs configured */
 	uint16_t nb_qps;
 	/* Adapter mode */
 	enum rte_event_crypto_adapter_mode mode;
+	/* Store event device's implicit release capability */
+	uint8_t implicit_release_disabled;
 } __rte_cache_aligned;
 
 /* Per crypto device information */
@@ -74,8 +126,6 @@ struct crypto_device_info {
 	struct rte_cryptodev *dev;
 	/* Pointer to queue pair info */
 	struct crypto_queue_pair_info *qpairs;
-	/* Next queue pair to be processed */
-	uint16_t next_queue_pair_id;
 	/* Set to indicate cryptodev->eventdev packet
 	 * transfer uses a hardware mechanism
 	 */
@@ -92,10 +142,16 @@ struct crypto_device_info {
 struct crypto_queue_pair_info {
 	/* Set to indicate queue pair is enabled */
 	bool qp_enabled;
-	/* Pointer to hold rte_crypto_ops for batching */
+	/* Service function the queue pair is assigned to */
+	uint8_t service_idx;
+	/* Pointer to hold rte_crypto_ops for batching, only allocated
+	 * for queue pairs serviced by a service function
+	 */
 	struct rte_crypto_op **op_buffer;
 	/* No of crypto ops accumulated */
-	uint8_t len;
+	uint16_t len;
+	/* TSC at which the oldest op in op_buffer was added */
+	uint64_t tsc;
 } __rte_cache_aligned;
 
 static struct rte_event_crypto_adapter **event_crypto_adapter;
@@ -240,13 +296,14 @@ rte_event_crypto_adapter_create_ext(uint8_t id, uint8_t dev_id,
 		return ret;
 	}
 
-	adapter->implicit_release_disabled = (dev_info.event_dev_cap &
-			RTE_EVENT_DEV_CAP_IMPLICIT_RELEASE_DISABLE);
 	adapter->eventdev_id = dev_id;
 	adapter->socket_id = socket_id;
 	adapter->conf_cb = conf_cb;
 	adapter->conf_arg = conf_arg;
 	adapter->mode = mode;
+	adapter->nb_services = 1;
+	adapter->implicit_release_disabled = (dev_info.event_dev_cap &
+			RTE_EVENT_DEV_CAP_IMPLICIT_RELEASE_DISABLE);
 	strcpy(adapter->mem_name, mem_name);
 	adapter->cdevs = rte_zmalloc_socket(adapter->mem_name,
 					rte_cryptodev_count() *
@@ -258,7 +315,6 @@ rte_event_crypto_adapter_create_ext(uint8_t id, uint8_t dev_id,
 		return -ENOMEM;
 	}
 
-	rte_spinlock_init(&adapter->lock);
 	for (i = 0; i < rte_cryptodev_count(); i++)
 		adapter->cdevs[i].dev = rte_cryptodev_pmd_get_dev(i);
 
@@ -294,10 +350,19 @@ rte_event_crypto_adapter_create(uint8_t id, uint8_t dev_id,
 	return ret;
 }
 
+static void
+eca_uninit_service(struct eca_service *svc)
+{
+	rte_service_component_unregister(svc->service_id);
+	rte_ring_free(svc->op_ring);
+	rte_free(svc->qps);
+}
+
 int __rte_experimental
 rte_event_crypto_adapter_free(uint8_t id)
 {
 	struct rte_event_crypto_adapter *adapter;
+	uint8_t i;
 
 	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
 
@@ -311,6 +376,11 @@ rte_event_crypto_adapter_free(uint8_t id)
 		return -EBUSY;
 	}
 
+	if (adapter->service_inited) {
+		for (i = 0; i < adapter->nb_services; i++)
+			eca_uninit_service(&adapter->services[i]);
+		rte_free(adapter->services);
+	}
 	if (adapter->default_cb_arg)
 		rte_free(adapter->conf_arg);
 	rte_free(adapter->cdevs);
@@ -320,159 +390,233 @@ rte_event_crypto_adapter_free(uint8_t id)
 	return 0;
 }
 
-static inline unsigned int
-eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
-		 struct rte_event *ev, unsigned int cnt)
+static inline void
+eca_op_free(struct rte_crypto_op *op)
 {
-	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
-	union rte_event_crypto_metadata *m_data = NULL;
-	struct crypto_queue_pair_info *qp_info = NULL;
-	struct rte_crypto_op *crypto_op;
-	unsigned int i, n;
-	uint16_t qp_id, len, ret;
+	rte_pktmbuf_free(op->sym->m_src);
+	rte_crypto_op_free(op);
+}
+
+static inline union rte_event_crypto_metadata *
+eca_op_metadata(struct rte_crypto_op *op)
+{
+	if (op->sess_type == RTE_CRYPTO_OP_WITH_SESSION)
+		return rte_cryptodev_sym_session_get_user_data(
+					op->sym->session);
+	if (op->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
+			op->private_data_offset)
+		return (union rte_event_crypto_metadata *)
+			((uint8_t *)op + op->private_data_offset);
+	return NULL;
+}
+
+/* Enqueue the ops buffered for a queue pair to the cryptodev, ops
+ * the cryptodev did not accept are kept at the head of the buffer
+ */
+static inline uint16_t
+eca_qp_flush(struct eca_service *svc, uint8_t cdev_id, uint16_t qp_id,
+	struct crypto_queue_pair_info *qp_info)
+{
+	struct rte_event_crypto_adapter_stats *stats = &svc->crypto_stats;
+	struct rte_crypto_op **op_buffer = qp_info->op_buffer;
+	uint16_t n;
+
+	n = rte_cryptodev_enqueue_burst(cdev_id, qp_id, op_buffer,
+					qp_info->len);
+	stats->crypto_enq_count += n;
+	if (n < qp_info->len)
+		memmove(op_buffer, &op_buffer[n],
+			(qp_info->len - n) * sizeof(*op_buffer));
+	qp_info->len -= n;
+
+	return n;
+}
+
+/* Returns 0 if the op was buffered, -ENOSPC if it was dropped */
+static inline int
+eca_qp_buffer_op(struct eca_service *svc, uint8_t cdev_id, uint16_t qp_id,
+	struct crypto_queue_pair_info *qp_info, struct rte_crypto_op *op)
+{
+	if (unlikely(qp_info->len == CRYPTO_ADAPTER_OPS_BUFFER_SZ)) {
+		eca_qp_flush(svc, cdev_id, qp_id, qp_info);
+		if (qp_info->len == CRYPTO_ADAPTER_OPS_BUFFER_SZ) {
+			svc->crypto_stats.crypto_enq_fail++;
+			eca_op_free(op);
+			return -ENOSPC;
+		}
+	}
+
+	if (qp_info->len == 0)
+		qp_info->tsc = rte_get_tsc_cycles();
+	qp_info->op_buffer[qp_info->len++] = op;
+	if (qp_info->len >= BATCH_SIZE)
+		eca_qp_flush(svc, cdev_id, qp_id, qp_info);
+
+	return 0;
+}
+
+/* Buffer a crypto op for its queue pair, ops for a queue pair assigned to
+ * another service function are handed over to that service function.
+ * Returns 0 if the op was buffered by this service function, 1 if it was
+ * handed over and a negative value if it was dropped
+ */
+static inline int
+eca_enq_op(struct eca_service *svc, struct rte_crypto_op *op)
+{
+	struct rte_event_crypto_adapter *adapter = svc->adapter;
+	union rte_event_crypto_metadata *m_data;
+	struct crypto_queue_pair_info *qp_info;
+	struct crypto_device_info *dev_info;
+	struct eca_service *owner;
+	uint16_t qp_id;
 	uint8_t cdev_id;
 
-	len = 0;
-	ret = 0;
-	n = 0;
+	m_data = eca_op_metadata(op);
+	if (m_data == NULL)
+		goto drop;
+
+	cdev_id = m_data->request_info.cdev_id;
+	qp_id = m_data->request_info.queue_pair_id;
+	dev_info = &adapter->cdevs[cdev_id];
+	if (dev_info->qpairs == NULL ||
+			qp_id >= dev_info->dev->data->nb_queue_pairs)
+		goto drop;
+
+	qp_info = &dev_info->qpairs[qp_id];
+	if (!qp_info->qp_enabled || qp_info->op_buffer == NULL)
+		goto drop;
+
+	if (qp_info->service_idx != svc->idx) {
+		owner = &adapter->services[qp_info->service_idx];
+		if (rte_ring_mp_enqueue(owner->op_ring, op) == 0)
+			return 1;
+		svc->crypto_stats.crypto_enq_fail++;
+		goto drop;
+	}
+
+	return eca_qp_buffer_op(svc, cdev_id, qp_id, qp_info, op);
+
+drop:
+	eca_op_free(op);
+	return -EINVAL;
+}
+
+/* Release events dequeued from the event port of a service function */
+static inline void
+eca_release_events(struct eca_service *svc, uint16_t nb_rel)
+{
+	struct rte_event ev[BATCH_SIZE];
+	uint16_t i, n;
+
+	for (i = 0; i < nb_rel; i++)
+		ev[i].op = RTE_EVENT_OP_RELEASE;
+
+	/* Releases don't take credits, the event port only pushes back
+	 * while its ring toward the scheduler is full
+	 */
+	for (i = 0; i < nb_rel; i += n)
+		n = rte_event_enqueue_burst(svc->adapter->eventdev_id,
+					svc->event_port_id, &ev[i],
+					nb_rel - i);
+}
+
+/* Submit the crypto ops of the events dequeued from the event port. If
+ * implicit release is disabled, each dequeued event is resolved exactly
+ * once: events whose op is handed over to another service function or
+ * dropped are released right away, the others are resolved by forwarding
+ * a completion event from the same event port
+ */
+static inline void
+eca_enq_to_cryptodev(struct eca_service *svc, struct rte_event *ev,
+	unsigned int cnt)
+{
+	struct rte_event_crypto_adapter_stats *stats = &svc->crypto_stats;
+	struct rte_crypto_op *crypto_op;
+	uint16_t nb_rel;
+	unsigned int i;
+	int ret;
+
 	stats->event_deq_count += cnt;
 
+	nb_rel = 0;
 	for (i = 0; i < cnt; i++) {
 		crypto_op = ev[i].event_ptr;
-		if (crypto_op == NULL)
+		ret = crypto_op == NULL ? -EINVAL : eca_enq_op(svc, crypto_op);
+		if (!svc->adapter->implicit_release_disabled)
 			continue;
-		if (crypto_op->sess_type == RTE_CRYPTO_OP_WITH_SESSION) {
-			m_data = rte_cryptodev_sym_session_get_user_data(
-					crypto_op->sym->session);
-			if (m_data == NULL) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
+		if (ret == 0)
+			svc->nb_fwd_pending++;
+		else
+			nb_rel++;
+	}
 
-			cdev_id = m_data->request_info.cdev_id;
-			qp_id = m_data->request_info.queue_pair_id;
-			qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
-			if (qp_info == NULL) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-			len = qp_info->len;
-			qp_info->op_buffer[len] = crypto_op;
-			len++;
-		} else if (crypto_op->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
-				crypto_op->private_data_offset) {
-			m_data = (union rte_event_crypto_metadata *)
-				 ((uint8_t *)crypto_op +
-					crypto_op->private_data_offset);
-			cdev_id = m_data->request_info.cdev_id;
-			qp_id = m_data->request_info.queue_pair_id;
-			qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
-			if (qp_info == NULL) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-			len = qp_info->len;
-			qp_info->op_buffer[len] = crypto_op;
-			len++;
-		} else {
-			rte_pktmbuf_free(crypto_op->sym->m_src);
-			rte_crypto_op_free(crypto_op);
-			continue;
-		}
+	if (nb_rel)
+		eca_release_events(svc, nb_rel);
+}
 
-		if (len == BATCH_SIZE) {
-			struct rte_crypto_op **op_buffer = qp_info->op_buffer;
-			ret = rte_cryptodev_enqueue_burst(cdev_id,
-							  qp_id,
-							  op_buffer,
-							  BATCH_SIZE);
-
-			stats->crypto_enq_count += ret;
-
-			while (ret < len) {
-				struct rte_crypto_op *op;
-				op = op_buffer[ret++];
-				stats->crypto_enq_fail++;
-				rte_pktmbuf_free(op->sym->m_src);
-				rte_crypto_op_free(op);
-			}
+/* Process the crypto ops handed over by the other service functions */
+static inline unsigned int
+eca_op_ring_dequeue(struct eca_service *svc)
+{
+	struct rte_crypto_op *ops[BATCH_SIZE];
+	unsigned int i, n;
 
-			len = 0;
-		}
+	if (svc->op_ring == NULL)
+		return 0;
 
-		if (qp_info)
-			qp_info->len = len;
-		n += ret;
-	}
+	n = rte_ring_sc_dequeue_burst(svc->op_ring, (void **)ops, BATCH_SIZE,
+				NULL);
+	for (i = 0; i < n; i++)
+		eca_enq_op(svc, ops[i]);
 
 	return n;
 }
 
+/* Flush the op buffers of the queue pairs of a service function, unless
+ * force is set only buffers holding ops older than flush_cycles are
+ * flushed
+ */
 static unsigned int
-eca_crypto_enq_flush(struct rte_event_crypto_adapter *adapter)
+eca_crypto_enq_flush(struct eca_service *svc, bool force)
 {
-	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
-	struct crypto_device_info *curr_dev;
-	struct crypto_queue_pair_info *curr_queue;
-	struct rte_crypto_op **op_buffer;
-	struct rte_cryptodev *dev;
-	uint8_t cdev_id;
-	uint16_t qp;
-	uint16_t ret;
-	uint16_t num_cdev = rte_cryptodev_count();
+	struct rte_event_crypto_adapter *adapter = svc->adapter;
+	struct crypto_queue_pair_info *qp_info;
+	struct eca_qp_entry *qp;
+	unsigned int ret;
+	uint64_t now;
+	uint16_t i;
 
 	ret = 0;
-	for (cdev_id = 0; cdev_id < num_cdev; cdev_id++) {
-		curr_dev = &adapter->cdevs[cdev_id];
-		if (curr_dev == NULL)
+	now = rte_get_tsc_cycles();
+	for (i = 0; i < svc->nb_qps; i++) {
+		qp = &svc->qps[i];
+		qp_info = &adapter->cdevs[qp->cdev_id].qpairs[qp->qp_id];
+		if (qp_info->len == 0)
 			continue;
-		dev = curr_dev->dev;
-
-		for (qp = 0; qp < dev->data->nb_queue_pairs; qp++) {
-
-			curr_queue = &curr_dev->qpairs[qp];
-			if (!curr_queue->qp_enabled)
-				continue;
-
-			op_buffer = curr_queue->op_buffer;
-			ret = rte_cryptodev_enqueue_burst(cdev_id,
-							  qp,
-							  op_buffer,
-							  curr_queue->len);
-			stats->crypto_enq_count += ret;
-
-			while (ret < curr_queue->len) {
-				struct rte_crypto_op *op;
-				op = op_buffer[ret++];
-				stats->crypto_enq_fail++;
-				rte_pktmbuf_free(op->sym->m_src);
-				rte_crypto_op_free(op);
-			}
-			curr_queue->len = 0;
-		}
+		if (!force && now - qp_info->tsc < adapter->flush_cycles)
+			continue;
+		ret += eca_qp_flush(svc, qp->cdev_id, qp->qp_id, qp_info);
 	}
 
 	return ret;
 }
 
 static int
-eca_crypto_adapter_enq_run(struct rte_event_crypto_adapter *adapter,
-			unsigned int max_enq)
+eca_crypto_adapter_enq_run(struct eca_service *svc, unsigned int max_enq)
 {
-	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
+	struct rte_event_crypto_adapter *adapter = svc->adapter;
+	struct rte_event_crypto_adapter_stats *stats = &svc->crypto_stats;
 	struct rte_event ev[BATCH_SIZE];
-	unsigned int nb_enq, nb_enqueued;
+	unsigned int nb_enq, nb_ring;
 	uint16_t n;
 	uint8_t event_dev_id = adapter->eventdev_id;
-	uint8_t event_port_id = adapter->event_port_id;
+	uint8_t event_port_id = svc->event_port_id;
 
-	nb_enqueued = 0;
 	if (adapter->mode == RTE_EVENT_CRYPTO_ADAPTER_OP_NEW)
 		return 0;
 
+	nb_ring = eca_op_ring_dequeue(svc);
+
 	for (nb_enq = 0; nb_enq < max_enq; nb_enq += n) {
 		stats->event_poll_count++;
 		n = rte_event_dequeue_burst(event_dev_id,
@@ -481,195 +625,229 @@ eca_crypto_adapter_enq_run(struct rte_event_crypto_adapter *adapter,
 		if (!n)
 			break;
 
-		nb_enqueued += eca_enq_to_cryptodev(adapter, ev, n);
+		eca_enq_to_cryptodev(svc, ev, n);
 	}
 
-	if ((++adapter->transmit_loop_count &
-		(CRYPTO_ENQ_FLUSH_THRESHOLD - 1)) == 0) {
-		nb_enqueued += eca_crypto_enq_flush(adapter);
-	}
+	/* Partial batches are submitted once the event port runs dry or
+	 * they have aged
+	 */
+	eca_crypto_enq_flush(svc, nb_enq == 0);
 
-	return nb_enqueued;
+	return nb_enq + nb_ring;
 }
 
 static inline void
-eca_ops_enqueue_burst(struct rte_event_crypto_adapter *adapter,
-		  struct rte_crypto_op **ops, uint16_t num)
+eca_flush_event_buffer(struct eca_service *svc)
 {
-	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
-	union rte_event_crypto_metadata *m_data = NULL;
-	uint8_t event_dev_id = adapter->eventdev_id;
-	uint8_t event_port_id = adapter->event_port_id;
-	struct rte_event events[BATCH_SIZE];
-	uint16_t nb_enqueued, nb_ev;
-	uint8_t retry;
-	uint8_t i;
+	struct rte_event_crypto_adapter_stats *stats = &svc->crypto_stats;
+	uint16_t n;
 
-	nb_ev = 0;
-	retry = 0;
-	nb_enqueued = 0;
-	num = RTE_MIN(num, BATCH_SIZE);
-	for (i = 0; i < num; i++) {
-		struct rte_event *ev = &events[nb_ev++];
-		if (ops[i]->sess_type == RTE_CRYPTO_OP_WITH_SESSION) {
-			m_data = rte_cryptodev_sym_session_get_user_data(
-					ops[i]->sym->session);
-		} else if (ops[i]->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
-				ops[i]->private_data_offset) {
-			m_data = (union rte_event_crypto_metadata *)
-				 ((uint8_t *)ops[i] +
-				  ops[i]->private_data_offset);
-		}
+	n = rte_event_enqueue_burst(svc->adapter->eventdev_id,
+				    svc->event_port_id,
+				    svc->events,
+				    svc->nb_events);
+	stats->event_enq_count += n;
+	if (n < svc->nb_events) {
+		stats->event_enq_retry_count++;
+		memmove(svc->events, &svc->events[n],
+			(svc->nb_events - n) * sizeof(struct rte_event));
+	}
+	svc->nb_events -= n;
+}
+
+/* Convert crypto completions to events, the events are enqueued once
+ * ev_flush_threshold of them are buffered or at the end of the service
+ * function invocation, so completions from several queue pairs are
+ * coalesced into a single event enqueue. While events dequeued from the
+ * event port are pending release, completions are forwarded in their
+ * place so they reuse their credits
+ */
+static inline void
+eca_ops_buffer_events(struct eca_service *svc, struct rte_crypto_op **ops,
+	uint16_t num)
+{
+	union rte_event_crypto_metadata *m_data;
+	struct rte_event *ev;
+	uint16_t i;
 
+	for (i = 0; i < num; i++) {
+		m_data = eca_op_metadata(ops[i]);
 		if (unlikely(m_data == NULL)) {
-			rte_pktmbuf_free(ops[i]->sym->m_src);
-			rte_crypto_op_free(ops[i]);
+			eca_op_free(ops[i]);
+			if (svc->nb_fwd_pending) {
+				svc->nb_fwd_pending--;
+				ev = &svc->events[svc->nb_events++];
+				ev->op = RTE_EVENT_OP_RELEASE;
+			}
 			continue;
 		}
 
+		ev = &svc->events[svc->nb_events++];
 		rte_memcpy(ev, &m_data->response_info, sizeof(*ev));
 		ev->event_ptr = ops[i];
 		ev->event_type = RTE_EVENT_TYPE_CRYPTODEV;
-		if (adapter->implicit_release_disabled)
+		if (svc->nb_fwd_pending) {
+			svc->nb_fwd_pending--;
 			ev->op = RTE_EVENT_OP_FORWARD;
-		else
+		} else {
 			ev->op = RTE_EVENT_OP_NEW;
+		}
 	}
 
-	do {
-		nb_enqueued += rte_event_enqueue_burst(event_dev_id,
-						  event_port_id,
-						  &events[nb_enqueued],
-						  nb_ev - nb_enqueued);
-	} while (retry++ < CRYPTO_ADAPTER_MAX_EV_ENQ_RETRIES &&
-		 nb_enqueued < nb_ev);
-
-	/* Free mbufs and rte_crypto_ops for failed events */
-	for (i = nb_enqueued; i < nb_ev; i++) {
-		struct rte_crypto_op *op = events[i].event_ptr;
-		rte_pktmbuf_free(op->sym->m_src);
-		rte_crypto_op_free(op);
-	}
-
-	stats->event_enq_fail_count += nb_ev - nb_enqueued;
-	stats->event_enq_count += nb_enqueued;
-	stats->event_enq_retry_count += retry - 1;
+	if (svc->nb_events >= svc->ev_flush_threshold)
+		eca_flush_event_buffer(svc);
 }
 
 static inline unsigned int
-eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
-			unsigned int max_deq)
+eca_crypto_adapter_deq_run(struct eca_service *svc, unsigned int max_deq)
 {
-	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
-	struct crypto_device_info *curr_dev;
-	struct crypto_queue_pair_info *curr_queue;
+	struct rte_event_crypto_adapter_stats *stats = &svc->crypto_stats;
 	struct rte_crypto_op *ops[BATCH_SIZE];
-	uint16_t n, nb_deq;
-	struct rte_cryptodev *dev;
-	uint8_t cdev_id;
-	uint16_t qp, dev_qps;
+	struct eca_qp_entry *qp;
+	unsigned int nb_deq;
+	uint16_t i, n;
 	bool done;
-	uint16_t num_cdev = rte_cryptodev_count();
 
 	nb_deq = 0;
+	if (svc->nb_qps == 0)
+		return 0;
+
 	do {
-		uint16_t queues = 0;
 		done = true;
 
-		for (cdev_id = adapter->next_cdev_id;
-			cdev_id < num_cdev; cdev_id++) {
-			curr_dev = &adapter->cdevs[cdev_id];
-			if (curr_dev == NULL)
-				continue;
-			dev = curr_dev->dev;
-			dev_qps = dev->data->nb_queue_pairs;
-
-			for (qp = curr_dev->next_queue_pair_id;
-				queues < dev_qps; qp = (qp + 1) % dev_qps,
-				queues++) {
+		for (i = 0; i < svc->nb_qps; i++) {
+			/* No room for a burst of completions, leave them in
+			 * the cryptodev until the eventdev catches up
+			 */
+			if (svc->nb_events > CRYPTO_ADAPTER_EVENT_BUFFER_SZ -
+					BATCH_SIZE) {
+				eca_flush_event_buffer(svc);
+				if (svc->nb_events >
+					CRYPTO_ADAPTER_EVENT_BUFFER_SZ -
+					BATCH_SIZE)
+					return nb_deq;
+			}
 
-				curr_queue = &curr_dev->qpairs[qp];
-				if (!curr_queue->qp_enabled)
-					continue;
+			qp = &svc->qps[svc->next_qp];
+			if (++svc->next_qp == svc->nb_qps)
+				svc->next_qp = 0;
 
-				n = rte_cryptodev_dequeue_burst(cdev_id, qp,
+			n = rte_cryptodev_dequeue_burst(qp->cdev_id, qp->qp_id,
 					ops, BATCH_SIZE);
-				if (!n)
-					continue;
-
-				done = false;
-				stats->crypto_deq_count += n;
-				eca_ops_enqueue_burst(adapter, ops, n);
-				nb_deq += n;
-
-				if (nb_deq > max_deq) {
-					if ((qp + 1) == dev_qps) {
-						adapter->next_cdev_id =
-							(cdev_id + 1)
-							% num_cdev;
-					}
-					curr_dev->next_queue_pair_id = (qp + 1)
-						% dev->data->nb_queue_pairs;
+			if (!n)
+				continue;
 
-					return nb_deq;
-				}
-			}
+			done = false;
+			stats->crypto_deq_count += n;
+			eca_ops_buffer_events(svc, ops, n);
+			nb_deq += n;
+
+			if (nb_deq > max_deq)
+				return nb_deq;
 		}
 	} while (done == false);
 	return nb_deq;
 }
 
 static void
-eca_crypto_adapter_run(struct rte_event_crypto_adapter *adapter,
-			unsigned int max_ops)
+eca_crypto_adapter_run(struct eca_service *svc, unsigned int max_ops)
 {
 	while (max_ops) {
 		unsigned int e_cnt, d_cnt;
 
-		e_cnt = eca_crypto_adapter_deq_run(adapter, max_ops);
+		e_cnt = eca_crypto_adapter_deq_run(svc, max_ops);
 		max_ops -= RTE_MIN(max_ops, e_cnt);
 
-		d_cnt = eca_crypto_adapter_enq_run(adapter, max_ops);
+		d_cnt = eca_crypto_adapter_enq_run(svc, max_ops);
 		max_ops -= RTE_MIN(max_ops, d_cnt);
 
 		if (e_cnt == 0 && d_cnt == 0)
 			break;
 
 	}
+
+	if (svc->nb_events)
+		eca_flush_event_buffer(svc);
 }
 
 static int
 eca_service_func(void *args)
 {
-	struct rte_event_crypto_adapter *adapter = args;
+	struct eca_service *svc = args;
 
-	if (rte_spinlock_trylock(&adapter->lock) == 0)
+	if (rte_spinlock_trylock(&svc->lock) == 0)
 		return 0;
-	eca_crypto_adapter_run(adapter, adapter->max_nb);
-	rte_spinlock_unlock(&adapter->lock);
+	eca_crypto_adapter_run(svc, svc->max_nb);
+	rte_spinlock_unlock(&svc->lock);
 
 	return 0;
 }
 
+static void
+eca_lock_services(struct rte_event_crypto_adapter *adapter)
+{
+	uint8_t i;
+
+	for (i = 0; i < adapter->nb_services; i++)
+		rte_spinlock_lock(&adapter->services[i].lock);
+}
+
+static void
+eca_unlock_services(struct rte_event_crypto_adapter *adapter)
+{
+	uint8_t i;
+
+	for (i = 0; i < adapter->nb_services; i++)
+		rte_spinlock_unlock(&adapter->services[i].lock);
+}
+
+static void
+eca_runstate_set(struct rte_event_crypto_adapter *adapter, int runstate,
+	int component)
+{
+	uint8_t i;
+
+	for (i = 0; i < adapter->nb_services; i++) {
+		if (component)
+			rte_service_component_runstate_set(
+				adapter->services[i].service_id, runstate);
+		else
+			rte_service_runstate_set(
+				adapter->services[i].service_id, runstate);
+	}
+}
+
 static int
-eca_init_service(struct rte_event_crypto_adapter *adapter, uint8_t id)
+eca_init_one_service(struct rte_event_crypto_adapter *adapter, uint8_t id,
+	uint8_t idx)
 {
+	struct eca_service *svc = &adapter->services[idx];
 	struct rte_event_crypto_adapter_conf adapter_conf;
+	char ring_name[RTE_RING_NAMESIZE];
 	struct rte_service_spec service;
+	uint32_t enq_depth;
 	int ret;
 
-	if (adapter->service_inited)
-		return 0;
+	svc->adapter = adapter;
+	svc->idx = idx;
+	rte_spinlock_init(&svc->lock);
 
+	/* Service functions after the first one are registered as
+	 * "<name>_<idx>" so that they can be looked up from the first one
+	 */
 	memset(&service, 0, sizeof(service));
-	snprintf(service.name, CRYPTO_ADAPTER_NAME_LEN,
-		"rte_event_crypto_adapter_%d", id);
+	if (idx == 0)
+		snprintf(service.name, CRYPTO_ADAPTER_NAME_LEN,
+			"rte_event_crypto_adapter_%d", id);
+	else
+		snprintf(service.name, CRYPTO_ADAPTER_NAME_LEN,
+			"rte_event_crypto_adapter_%d_%d", id, idx);
 	service.socket_id = adapter->socket_id;
 	service.callback = eca_service_func;
-	service.callback_userdata = adapter;
+	service.callback_userdata = svc;
 	/* Service function handles locking for queue add/del updates */
 	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
-	ret = rte_service_component_register(&service, &adapter->service_id);
+	ret = rte_service_component_register(&service, &svc->service_id);
 	if (ret) {
 		RTE_EDEV_LOG_ERR("failed to register service %s err = %" PRId32,
 			service.name, ret);
@@ -681,14 +859,69 @@ eca_init_service(struct rte_event_crypto_adapter *adapter, uint8_t id)
 	if (ret) {
 		RTE_EDEV_LOG_ERR("configuration callback failed err = %" PRId32,
 			ret);
+		rte_service_component_unregister(svc->service_id);
 		return ret;
 	}
 
-	adapter->max_nb = adapter_conf.max_nb;
-	adapter->event_port_id = adapter_conf.event_port_id;
+	if (adapter->nb_services > 1) {
+		snprintf(ring_name, sizeof(ring_name), "eca_op_ring_%d_%d",
+			id, idx);
+		svc->op_ring = rte_ring_create(ring_name,
+					CRYPTO_ADAPTER_OP_RING_SZ,
+					adapter->socket_id, RING_F_SC_DEQ);
+		if (svc->op_ring == NULL) {
+			RTE_EDEV_LOG_ERR("failed to create ring %s err = %"
+				PRId32, ring_name, rte_errno);
+			rte_service_component_unregister(svc->service_id);
+			return -rte_errno;
+		}
+	}
+
+	svc->max_nb = adapter_conf.max_nb;
+	svc->event_port_id = adapter_conf.event_port_id;
+	if (rte_event_port_attr_get(adapter->eventdev_id,
+				svc->event_port_id,
+				RTE_EVENT_PORT_ATTR_ENQ_DEPTH,
+				&enq_depth) || enq_depth == 0)
+		enq_depth = BATCH_SIZE;
+	svc->ev_flush_threshold = RTE_MIN(enq_depth, (uint32_t)
+			(CRYPTO_ADAPTER_EVENT_BUFFER_SZ - BATCH_SIZE));
+
+	return 0;
+}
+
+static int
+eca_init_service(struct rte_event_crypto_adapter *adapter, uint8_t id)
+{
+	uint8_t i;
+	int ret;
+
+	if (adapter->service_inited)
+		return 0;
+
+	adapter->services = rte_zmalloc_socket(adapter->mem_name,
+				adapter->nb_services *
+				sizeof(struct eca_service),
+				RTE_CACHE_LINE_SIZE, adapter->socket_id);
+	if (adapter->services == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < adapter->nb_services; i++) {
+		ret = eca_init_one_service(adapter, id, i);
+		if (ret) {
+			while (i--)
+				eca_uninit_service(&adapter->services[i]);
+			rte_free(adapter->services);
+			adapter->services = NULL;
+			return ret;
+		}
+	}
+
+	adapter->flush_cycles = rte_get_tsc_hz() *
+				CRYPTO_ADAPTER_OPS_FLUSH_US / US_PER_S;
 	adapter->service_inited = 1;
 
-	return ret;
+	return 0;
 }
 
 static void
@@ -721,14 +954,113 @@ eca_update_qp_info(struct rte_event_crypto_adapter *adapter,
 	}
 }
 
+/* Rebuild the queue pair lists of the service functions, called with
+ * all the service function locks held
+ */
+static int
+eca_update_service_qps(struct rte_event_crypto_adapter *adapter)
+{
+	uint16_t nb_qps[RTE_EVENT_CRYPTO_ADAPTER_MAX_SERVICES];
+	struct crypto_queue_pair_info *qp_info;
+	struct crypto_device_info *dev_info;
+	struct eca_qp_entry *qps;
+	struct eca_service *svc;
+	uint16_t cdev_id;
+	uint16_t qp;
+	uint8_t i;
+
+	memset(nb_qps, 0, sizeof(nb_qps));
+	for (cdev_id = 0; cdev_id < rte_cryptodev_count(); cdev_id++) {
+		dev_info = &adapter->cdevs[cdev_id];
+		if (dev_info->qpairs == NULL)
+			continue;
+		for (qp = 0; qp < dev_info->dev->data->nb_queue_pairs; qp++) {
+			qp_info = &dev_info->qpairs[qp];
+			if (qp_info->qp_enabled && qp_info->op_buffer != NULL)
+				nb_qps[qp_info->service_idx]++;
+		}
+	}
+
+	for (i = 0; i < adapter->nb_services; i++) {
+		svc = &adapter->services[i];
+		qps = rte_realloc(svc->qps,
+				RTE_MAX(nb_qps[i], 1) * sizeof(*qps), 0);
+		if (qps == NULL)
+			return -ENOMEM;
+		svc->qps = qps;
+		svc->nb_qps = 0;
+	}
+
+	for (cdev_id = 0; cdev_id < rte_cryptodev_count(); cdev_id++) {
+		dev_info = &adapter->cdevs[cdev_id];
+		if (dev_info->qpairs == NULL)
+			continue;
+		for (qp = 0; qp < dev_info->dev->data->nb_queue_pairs; qp++) {
+			qp_info = &dev_info->qpairs[qp];
+			if (!qp_info->qp_enabled || qp_info->op_buffer == NULL)
+				continue;
+			svc = &adapter->services[qp_info->service_idx];
+			svc->qps[svc->nb_qps].cdev_id = cdev_id;
+			svc->qps[svc->nb_qps].qp_id = qp;
+			svc->nb_qps++;
+		}
+	}
+
+	for (i = 0; i < adapter->nb_services; i++) {
+		svc = &adapter->services[i];
+		if (svc->next_qp >= svc->nb_qps)
+			svc->next_qp = 0;
+	}
+
+	return 0;
+}
+
+/* Service function with the least queue pairs */
+static uint8_t
+eca_least_loaded_service(struct rte_event_crypto_adapter *adapter)
+{
+	uint8_t i, idx;
+
+	idx = 0;
+	for (i = 1; i < adapter->nb_services; i++)
+		if (adapter->services[i].nb_qps < adapter->services[idx].nb_qps)
+			idx = i;
+
+	return idx;
+}
+
+static int
+eca_add_one_queue_pair(struct rte_event_crypto_adapter *adapter,
+		struct crypto_device_info *dev_info,
+		uint16_t queue_pair_id)
+{
+	struct crypto_queue_pair_info *qp_info;
+
+	qp_info = &dev_info->qpairs[queue_pair_id];
+	if (qp_info->op_buffer == NULL) {
+		qp_info->op_buffer = rte_zmalloc_socket(adapter->mem_name,
+					CRYPTO_ADAPTER_OPS_BUFFER_SZ *
+					sizeof(struct rte_crypto_op *),
+					0, adapter->socket_id);
+		if (qp_info->op_buffer == NULL)
+			return -ENOMEM;
+		qp_info->len = 0;
+		qp_info->service_idx = eca_least_loaded_service(adapter);
+	}
+
+	eca_update_qp_info(adapter, dev_info, queue_pair_id, 1);
+
+	return eca_update_service_qps(adapter);
+}
+
 static int
 eca_add_queue_pair(struct rte_event_crypto_adapter *adapter,
 		uint8_t cdev_id,
 		int queue_pair_id)
 {
 	struct crypto_device_info *dev_info = &adapter->cdevs[cdev_id];
-	struct crypto_queue_pair_info *qpairs;
-	uint32_t i;
+	uint16_t i;
+	int ret;
 
 	if (dev_info->qpairs == NULL) {
 		dev_info->qpairs =
@@ -738,26 +1070,49 @@ eca_add_queue_pair(struct rte_event_crypto_adapter *adapter,
 					0, adapter->socket_id);
 		if (dev_info->qpairs == NULL)
 			return -ENOMEM;
+	}
 
-		qpairs = dev_info->qpairs;
-		qpairs->op_buffer = rte_zmalloc_socket(adapter->mem_name,
-					BATCH_SIZE *
-					sizeof(struct rte_crypto_op *),
-					0, adapter->socket_id);
-		if (!qpairs->op_buffer) {
-			rte_free(qpairs);
-			return -ENOMEM;
+	if (queue_pair_id == -1) {
+		for (i = 0; i < dev_info->dev->data->nb_queue_pairs; i++) {
+			ret = eca_add_one_queue_pair(adapter, dev_info, i);
+			if (ret)
+				return ret;
 		}
+		return 0;
 	}
 
-	if (queue_pair_id == -1) {
-		for (i = 0; i < dev_info->dev->data->nb_queue_pairs; i++)
-			eca_update_qp_info(adapter, dev_info, i, 1);
-	} else
-		eca_update_qp_info(adapter, dev_info,
-					(uint16_t)queue_pair_id, 1);
+	return eca_add_one_queue_pair(adapter, dev_info,
+				(uint16_t)queue_pair_id);
+}
 
-	return 0;
+/* Submit the ops still buffered for a queue pair that is deleted, ops
+ * the cryptodev does not accept are freed
+ */
+static void
+eca_del_one_queue_pair(struct rte_event_crypto_adapter *adapter,
+		uint8_t cdev_id,
+		uint16_t queue_pair_id)
+{
+	struct crypto_device_info *dev_info = &adapter->cdevs[cdev_id];
+	struct crypto_queue_pair_info *qp_info;
+	struct eca_service *svc;
+	uint16_t i;
+
+	qp_info = &dev_info->qpairs[queue_pair_id];
+	if (qp_info->op_buffer != NULL) {
+		svc = &adapter->services[qp_info->service_idx];
+		if (qp_info->len)
+			eca_qp_flush(svc, cdev_id, queue_pair_id, qp_info);
+		for (i = 0; i < qp_info->len; i++) {
+			svc->crypto_stats.crypto_enq_fail++;
+			eca_op_free(qp_info->op_buffer[i]);
+		}
+		rte_free(qp_info->op_buffer);
+		qp_info->op_buffer = NULL;
+		qp_info->len = 0;
+	}
+
+	eca_update_qp_info(adapter, dev_info, queue_pair_id, 0);
 }
 
 int __rte_experimental
@@ -859,17 +1214,18 @@ rte_event_crypto_adapter_queue_pair_add(uint8_t id,
 	      !(cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_FWD) &&
 	      !(cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_QP_EV_BIND) &&
 	       (cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_SESSION_PRIVATE_DATA))) {
-		rte_spinlock_lock(&adapter->lock);
 		ret = eca_init_service(adapter, id);
-		if (ret == 0)
-			ret = eca_add_queue_pair(adapter, cdev_id,
-						 queue_pair_id);
-		rte_spinlock_unlock(&adapter->lock);
+		if (ret)
+			return ret;
+
+		eca_lock_services(adapter);
+		ret = eca_add_queue_pair(adapter, cdev_id, queue_pair_id);
+		eca_unlock_services(adapter);
 
 		if (ret)
 			return ret;
 
-		rte_service_component_runstate_set(adapter->service_id, 1);
+		eca_runstate_set(adapter, 1, 1);
 	}
 
 	return 0;
@@ -933,18 +1289,17 @@ rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
 			}
 		}
 	} else {
-		if (adapter->nb_qps == 0)
+		if (adapter->nb_qps == 0 || dev_info->qpairs == NULL)
 			return 0;
 
-		rte_spinlock_lock(&adapter->lock);
+		eca_lock_services(adapter);
 		if (queue_pair_id == -1) {
 			for (i = 0; i < dev_info->dev->data->nb_queue_pairs;
 				i++)
-				eca_update_qp_info(adapter, dev_info,
-							queue_pair_id, 0);
+				eca_del_one_queue_pair(adapter, cdev_id, i);
 		} else {
-			eca_update_qp_info(adapter, dev_info,
-						(uint16_t)queue_pair_id, 0);
+			eca_del_one_queue_pair(adapter, cdev_id,
+						(uint16_t)queue_pair_id);
 		}
 
 		if (dev_info->num_qpairs == 0) {
@@ -952,9 +1307,9 @@ rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
 			dev_info->qpairs = NULL;
 		}
 
-		rte_spinlock_unlock(&adapter->lock);
-		rte_service_component_runstate_set(adapter->service_id,
-				adapter->nb_qps);
+		ret = eca_update_service_qps(adapter);
+		eca_unlock_services(adapter);
+		eca_runstate_set(adapter, !!adapter->nb_qps, 1);
 	}
 
 	return ret;
@@ -997,7 +1352,7 @@ eca_adapter_ctrl(uint8_t id, int start)
 	}
 
 	if (use_service)
-		rte_service_runstate_set(adapter->service_id, start);
+		eca_runstate_set(adapter, start, 0);
 
 	return 0;
 }
@@ -1057,8 +1412,21 @@ rte_event_crypto_adapter_stats_get(uint8_t id,
 			dev_stats.event_enq_count;
 	}
 
-	if (adapter->service_inited)
-		*stats = adapter->crypto_stats;
+	for (i = 0; adapter->service_inited && i < adapter->nb_services;
+			i++) {
+		struct rte_event_crypto_adapter_stats *svc_stats =
+			&adapter->services[i].crypto_stats;
+
+		stats->event_poll_count += svc_stats->event_poll_count;
+		stats->event_deq_count += svc_stats->event_deq_count;
+		stats->crypto_enq_count += svc_stats->crypto_enq_count;
+		stats->crypto_enq_fail += svc_stats->crypto_enq_fail;
+		stats->crypto_deq_count += svc_stats->crypto_deq_count;
+		stats->event_enq_count += svc_stats->event_enq_count;
+		stats->event_enq_retry_count +=
+			svc_stats->event_enq_retry_count;
+		stats->event_enq_fail_count += svc_stats->event_enq_fail_count;
+	}
 
 	stats->crypto_deq_count += dev_stats_sum.crypto_deq_count;
 	stats->event_enq_count += dev_stats_sum.event_enq_count;
@@ -1090,7 +1458,9 @@ rte_event_crypto_adapter_stats_reset(uint8_t id)
 						dev_info->dev);
 	}
 
-	memset(&adapter->crypto_stats, 0, sizeof(adapter->crypto_stats));
+	for (i = 0; adapter->service_inited && i < adapter->nb_services; i++)
+		memset(&adapter->services[i].crypto_stats, 0,
+			sizeof(adapter->services[i].crypto_stats));
 	return 0;
 }
 
@@ -1106,7 +1476,7 @@ rte_event_crypto_adapter_service_id_get(uint8_t id, uint32_t *service_id)
 		return -EINVAL;
 
 	if (adapter->service_inited)
-		*service_id = adapter->service_id;
+		*service_id = adapter->services[0].service_id;
 
 	return adapter->service_inited ? 0 : -ESRCH;
 }
@@ -1122,7 +1492,54 @@ rte_event_crypto_adapter_event_port_get(uint8_t id, uint8_t *event_port_id)
 	if (adapter == NULL || event_port_id == NULL)
 		return -EINVAL;
 
-	*event_port_id = adapter->event_port_id;
+	*event_port_id = adapter->service_inited ?
+			adapter->services[0].event_port_id : 0;
+
+	return 0;
+}
+
+int __rte_experimental
+rte_event_crypto_adapter_nb_services_set(uint8_t id, uint8_t nb_services)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL || nb_services == 0 ||
+	    nb_services > RTE_EVENT_CRYPTO_ADAPTER_MAX_SERVICES)
+		return -EINVAL;
+
+	if (adapter->service_inited) {
+		RTE_EDEV_LOG_ERR("Adapter %" PRIu8 " service functions are"
+			" already initialized", id);
+		return -EBUSY;
+	}
+
+	adapter->nb_services = nb_services;
+
+	return 0;
+}
+
+int __rte_experimental
+rte_event_crypto_adapter_service_event_port_get(uint8_t id,
+		uint8_t service_idx, uint8_t *event_port_id)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL || event_port_id == NULL)
+		return -EINVAL;
+
+	if (!adapter->service_inited)
+		return -ESRCH;
+
+	if (service_idx >= adapter->nb_services)
+		return -EINVAL;
+
+	*event_port_id = adapter->services[service_idx].event_port_id;
 
 	return 0;
 }
@@ -274,6 +274,10 @@ struct rte_event_crypto_adapter_conf {
  * cryptodev queue pair to the event device. The SW service is created within
  * the rte_event_crypto_adapter_queue_pair_add() function if SW based packet
  * transfers from cryptodev queue pair to the event device are required.
+ * The callback is invoked once per SW service function, each service
+ * function needs its own event port.
+ *
+ * @see rte_event_crypto_adapter_nb_services_set()
  *
  * @param id
  *  Adapter identifier.
@@ -569,6 +573,69 @@ rte_event_crypto_adapter_service_id_get(uint8_t id, uint32_t *service_id);
 int __rte_experimental
 rte_event_crypto_adapter_event_port_get(uint8_t id, uint8_t *event_port_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the number of SW service functions of an adapter. The queue pairs
+ * of the adapter are partitioned across its service functions, each one
+ * dequeuing completions from and enqueuing crypto ops to its own queue
+ * pairs, so that the adapter can scale to several service cores.
+ *
+ * The first service function is the one returned by
+ * rte_event_crypto_adapter_service_id_get(), the others are registered
+ * with the name of the first one suffixed with "_<index>".
+ *
+ * In RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD mode, each service function
+ * dequeues crypto request events from its own event port, ops for a queue
+ * pair assigned to another service function are handed over to it.
+ *
+ * This function must be called before the first queue pair serviced by a
+ * SW service function is added to the adapter, the default is a single
+ * service function.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param nb_services
+ *  Number of service functions, from 1 to
+ *  RTE_EVENT_CRYPTO_ADAPTER_MAX_SERVICES.
+ *
+ * @return
+ *  - 0: Success
+ *  - -EINVAL: Invalid adapter identifier or number of service functions.
+ *  - -EBUSY: The service functions are already initialized.
+ */
+int __rte_experimental
+rte_event_crypto_adapter_nb_services_set(uint8_t id, uint8_t nb_services);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve the event port of one of the service functions of an adapter.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param service_idx
+ *  Index of the service function.
+ *
+ * @param [out] event_port_id
+ *  Application links its event queue to the event ports of all the
+ *  service functions in RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD mode.
+ *
+ * @return
+ *  - 0: Success
+ *  - -EINVAL: Invalid adapter identifier or service function index.
+ *  - -ESRCH: The adapter doesn't use service functions.
+ *
+ * @see rte_event_crypto_adapter_nb_services_set()
+ */
+int __rte_experimental
+rte_event_crypto_adapter_service_event_port_get(uint8_t id,
+		uint8_t service_idx, uint8_t *event_port_id);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,6 +14,7 @@
 #include <rte_ethdev.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
+#include <rte_mempool.h>
 #include <rte_service_component.h>
 #include <rte_thash.h>
 #include <rte_interrupts.h>
@@ -25,6 +26,10 @@
 #define BATCH_SIZE		32
 #define BLOCK_CNT_THRESHOLD	10
 #define ETH_EVENT_BUFFER_SIZE	(4*BATCH_SIZE)
+/* Max time an event is held in the event buffer waiting for a full burst */
+#define ETH_EVENT_BUFFER_FLUSH_US	10
+/* Consecutive empty polls before an adaptive Rx queue is put to sleep */
+#define ETH_RX_ADAPTIVE_IDLE_POLLS	1024
 
 #define ETH_RX_ADAPTER_SERVICE_NAME_LEN	32
 #define ETH_RX_ADAPTER_MEM_NAME_LEN	32
@@ -58,10 +63,37 @@ struct eth_rx_poll_entry {
 	uint16_t eth_rx_qid;
 };
 
+/*
+ * Event vector aggregation state, there is an instance of this struct per
+ * Rx queue added with RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR
+ */
+struct eth_rx_vector_data {
+	/* Entry in the adapter's list of partially filled vectors */
+	TAILQ_ENTRY(eth_rx_vector_data) next;
+	/* Partially filled event vector, NULL if none */
+	struct rte_event_vector *vector_ev;
+	/* Mempool the vectors are allocated from */
+	struct rte_mempool *vector_pool;
+	/* Event word0 of the vector events */
+	uint64_t event;
+	/* TSC at which vector_ev was allocated */
+	uint64_t ts;
+	/* Cycles after which a partially filled vector is enqueued */
+	uint64_t vector_timeout_ticks;
+	/* Max elements per vector */
+	uint16_t max_vector_count;
+	uint16_t port;
+	uint16_t queue;
+};
+
+TAILQ_HEAD(eth_rx_vector_data_list, eth_rx_vector_data);
+
 /* Instance per adapter */
 struct rte_eth_event_enqueue_buffer {
 	/* Count of events in this buffer */
 	uint16_t count;
+	/* TSC at which the oldest event in this buffer was added */
+	uint64_t tsc;
 	/* Array of events in this buffer */
 	struct rte_event events[ETH_EVENT_BUFFER_SIZE];
 };
@@ -79,10 +111,18 @@ struct rte_event_eth_rx_adapter {
 	rte_spinlock_t rx_lock;
 	/* Max mbufs processed in any service function invocation */
 	uint32_t max_nb_rx;
+	/* Event buffer count at which events are enqueued to the event
+	 * device, the enqueue depth of the adapter's event port
+	 */
+	uint16_t flush_threshold;
+	/* Cycles after which a partially filled event buffer is flushed */
+	uint64_t flush_cycles;
 	/* Receive queues that need to be polled */
 	struct eth_rx_poll_entry *eth_rx_poll;
 	/* Size of the eth_rx_poll array */
 	uint16_t num_rx_polled;
+	/* Rx queues with a partially filled event vector */
+	struct eth_rx_vector_data_list vector_list;
 	/* Weighted round robin schedule */
 	uint32_t *wrr_sched;
 	/* wrr_sched[] size */
@@ -101,6 +141,8 @@ struct rte_event_eth_rx_adapter {
 	int epd;
 	/* Num of interrupt driven interrupt queues */
 	uint32_t num_rx_intr;
+	/* Num of polled queues that switch to interrupt mode when idle */
+	uint32_t num_rx_adaptive;
 	/* Used to send <dev id, queue id> of interrupting Rx queues from
 	 * the interrupt thread to the Rx thread
 	 */
@@ -175,6 +217,8 @@ struct eth_device_info {
 	uint16_t nb_rx_intr;
 	/* Number of queues that use the shared interrupt */
 	uint16_t nb_shared_intr;
+	/* Number of polled queues that switch to interrupt mode when idle */
+	uint16_t nb_rx_adaptive;
 	/* sum(wrr(q)) for all queues within the device
 	 * useful when deleting all device queues
 	 */
@@ -197,12 +241,19 @@ struct eth_device_info {
 struct eth_rx_queue_info {
 	int queue_enabled;	/* True if added */
 	int intr_enabled;
+	uint8_t adaptive;	/* Switch to interrupt mode when idle */
+	uint8_t intr_armed;	/* Adaptive queue waiting for an interrupt */
+	uint16_t empty_polls;	/* Consecutive empty polls of adaptive queue */
 	uint16_t wt;		/* Polling weight */
+	uint16_t burst_size;	/* Max packets per poll, 0 if unlimited */
+	uint8_t ena_vector;	/* Aggregate mbufs into event vectors */
 	uint8_t event_queue_id;	/* Event queue to enqueue packets to */
 	uint8_t sched_type;	/* Sched type for events */
 	uint8_t priority;	/* Event priority */
 	uint32_t flow_id;	/* App provided flow identifier */
 	uint32_t flow_id_mask;	/* Set to ~0 if app provides flow id else 0 */
+	struct rte_event_eth_rx_adapter_queue_stats stats;
+	struct eth_rx_vector_data vector_data;
 };
 
 static struct rte_event_eth_rx_adapter **event_eth_rx_adapter;
@@ -305,6 +356,14 @@ rxa_polled_queue(struct eth_device_info *dev_info,
 		queue_info->queue_enabled && queue_info->wt != 0;
 }
 
+static inline int
+rxa_adaptive_queue(struct eth_device_info *dev_info,
+	int rx_queue_id)
+{
+	return rxa_polled_queue(dev_info, rx_queue_id) &&
+		dev_info->rx_queue[rx_queue_id].adaptive;
+}
+
 /* Calculate change in number of vectors after Rx queue ID is add/deleted */
 static int
 rxa_nb_intr_vect(struct eth_device_info *dev_info, int rx_queue_id, int add)
@@ -755,6 +814,162 @@ rxa_flush_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter)
 	return n;
 }
 
+/* Enqueue buffered events once they make up a full event port burst,
+ * returns 0 if the buffer doesn't have room for another Rx burst
+ */
+static inline int
+rxa_flush_event_buffer_full(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	struct rte_eth_event_enqueue_buffer *buf =
+	    &rx_adapter->event_enqueue_buffer;
+
+	if (buf->count >= rx_adapter->flush_threshold)
+		rxa_flush_event_buffer(rx_adapter);
+
+	return BATCH_SIZE <= ETH_EVENT_BUFFER_SIZE - buf->count;
+}
+
+/* Enqueue a partial burst of buffered events if no packets were received
+ * in the last service function invocation or the oldest event has been
+ * buffered for more than ETH_EVENT_BUFFER_FLUSH_US
+ */
+static inline void
+rxa_flush_event_buffer_timeout(struct rte_event_eth_rx_adapter *rx_adapter,
+			uint32_t nb_rx)
+{
+	struct rte_eth_event_enqueue_buffer *buf =
+	    &rx_adapter->event_enqueue_buffer;
+
+	if (buf->count == 0)
+		return;
+
+	if (nb_rx == 0 ||
+		rte_get_tsc_cycles() - buf->tsc >= rx_adapter->flush_cycles)
+		rxa_flush_event_buffer(rx_adapter);
+}
+
+/* Move the event vector of an Rx queue to the event buffer, free space
+ * check is done prior to calling this function
+ */
+static inline void
+rxa_vector_expire(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_rx_vector_data *vec)
+{
+	struct rte_eth_event_enqueue_buffer *buf =
+	    &rx_adapter->event_enqueue_buffer;
+	struct rte_event *ev;
+
+	if (buf->count == 0)
+		buf->tsc = rte_get_tsc_cycles();
+
+	ev = &buf->events[buf->count++];
+	ev->event = vec->event;
+	ev->vec = vec->vector_ev;
+
+	vec->vector_ev = NULL;
+	TAILQ_REMOVE(&rx_adapter->vector_list, vec, next);
+}
+
+/* Aggregate mbufs into the event vector of the Rx queue, full vectors
+ * are moved to the event buffer. Returns the number of mbufs aggregated,
+ * less than num if no event vector could be allocated
+ */
+static inline uint16_t
+rxa_create_event_vector(struct rte_event_eth_rx_adapter *rx_adapter,
+			struct eth_rx_queue_info *queue_info,
+			struct rte_mbuf **mbufs,
+			uint16_t num)
+{
+	struct eth_rx_vector_data *vec = &queue_info->vector_data;
+	struct rte_event_vector *v;
+	uint16_t done = 0;
+	uint16_t n;
+
+	while (done < num) {
+		if (vec->vector_ev == NULL) {
+			if (unlikely(rte_mempool_get(vec->vector_pool,
+					(void **)&vec->vector_ev) < 0)) {
+				vec->vector_ev = NULL;
+				break;
+			}
+			v = vec->vector_ev;
+			v->nb_elem = 0;
+			v->attr_valid = 1;
+			v->port = vec->port;
+			v->queue = vec->queue;
+			vec->ts = rte_get_tsc_cycles();
+			TAILQ_INSERT_TAIL(&rx_adapter->vector_list, vec, next);
+		}
+
+		v = vec->vector_ev;
+		n = RTE_MIN((uint16_t)(num - done),
+			(uint16_t)(vec->max_vector_count - v->nb_elem));
+		rte_memcpy(&v->mbufs[v->nb_elem], &mbufs[done],
+			n * sizeof(struct rte_mbuf *));
+		v->nb_elem += n;
+		done += n;
+
+		if (v->nb_elem == vec->max_vector_count)
+			rxa_vector_expire(rx_adapter, vec);
+	}
+
+	return done;
+}
+
+/* Enqueue partially filled event vectors that have timed out */
+static inline void
+rxa_vector_timeout(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	struct rte_eth_event_enqueue_buffer *buf =
+	    &rx_adapter->event_enqueue_buffer;
+	struct eth_rx_vector_data *vec, *next;
+	uint64_t now;
+
+	if (TAILQ_EMPTY(&rx_adapter->vector_list))
+		return;
+
+	now = rte_get_tsc_cycles();
+	for (vec = TAILQ_FIRST(&rx_adapter->vector_list); vec != NULL;
+			vec = next) {
+		next = TAILQ_NEXT(vec, next);
+		if (now - vec->ts < vec->vector_timeout_ticks)
+			continue;
+		if (buf->count == ETH_EVENT_BUFFER_SIZE) {
+			rxa_flush_event_buffer(rx_adapter);
+			if (buf->count == ETH_EVENT_BUFFER_SIZE)
+				break;
+		}
+		rxa_vector_expire(rx_adapter, vec);
+	}
+}
+
+/* Release the partially filled event vector of an Rx queue that is
+ * deleted or reconfigured
+ */
+static void
+rxa_vector_release(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_rx_queue_info *queue_info)
+{
+	struct rte_eth_event_enqueue_buffer *buf =
+	    &rx_adapter->event_enqueue_buffer;
+	struct eth_rx_vector_data *vec = &queue_info->vector_data;
+	uint16_t i;
+
+	if (vec->vector_ev == NULL)
+		return;
+
+	if (buf->count < ETH_EVENT_BUFFER_SIZE) {
+		rxa_vector_expire(rx_adapter, vec);
+		return;
+	}
+
+	for (i = 0; i < vec->vector_ev->nb_elem; i++)
+		rte_pktmbuf_free(vec->vector_ev->mbufs[i]);
+	rte_mempool_put(vec->vector_pool, vec->vector_ev);
+	vec->vector_ev = NULL;
+	TAILQ_REMOVE(&rx_adapter->vector_list, vec, next);
+}
+
 static inline void
 rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 		uint16_t eth_dev_id,
@@ -809,6 +1024,23 @@ rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 		num = nb_cb;
 	}
 
+	if (eth_rx_queue_info->ena_vector) {
+		uint16_t nb_vec;
+
+		nb_vec = rxa_create_event_vector(rx_adapter, eth_rx_queue_info,
+						mbufs, num);
+		if (likely(nb_vec == num))
+			return;
+		/* Out of event vectors, the remaining mbufs are enqueued
+		 * as individual events
+		 */
+		mbufs += nb_vec;
+		num -= nb_vec;
+	}
+
+	if (buf->count == 0)
+		buf->tsc = rte_get_tsc_cycles();
+
 	for (i = 0; i < num; i++) {
 		m = mbufs[i];
 		struct rte_event *ev = &events[i];
@@ -833,20 +1065,24 @@ rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 	}
 }
 
-/* Enqueue packets from  <port, q>  to event buffer */
+/* Enqueue packets from  <port, q>  to event buffer, at most burst_size
+ * packets are dequeued from the Rx queue if burst_size is non zero
+ */
 static inline uint32_t
 rxa_eth_rx(struct rte_event_eth_rx_adapter *rx_adapter,
 	uint16_t port_id,
 	uint16_t queue_id,
 	uint32_t rx_count,
 	uint32_t max_rx,
+	uint16_t burst_size,
 	int *rxq_empty)
 {
 	struct rte_mbuf *mbufs[BATCH_SIZE];
-	struct rte_eth_event_enqueue_buffer *buf =
-					&rx_adapter->event_enqueue_buffer;
 	struct rte_event_eth_rx_adapter_stats *stats =
 					&rx_adapter->stats;
+	struct rte_event_eth_rx_adapter_queue_stats *q_stats =
+		&rx_adapter->eth_devices[port_id].rx_queue[queue_id].stats;
+	uint16_t nb_pkts;
 	uint16_t n;
 	uint32_t nb_rx = 0;
 
@@ -855,25 +1091,34 @@ rxa_eth_rx(struct rte_event_eth_rx_adapter *rx_adapter,
 	/* Don't do a batch dequeue from the rx queue if there isn't
 	 * enough space in the enqueue buffer.
 	 */
-	while (BATCH_SIZE <= (RTE_DIM(buf->events) - buf->count)) {
-		if (buf->count >= BATCH_SIZE)
-			rxa_flush_event_buffer(rx_adapter);
+	while (1) {
+		if (!rxa_flush_event_buffer_full(rx_adapter)) {
+			q_stats->rx_enq_retry++;
+			break;
+		}
+
+		nb_pkts = BATCH_SIZE;
+		if (burst_size && burst_size - nb_rx < BATCH_SIZE)
+			nb_pkts = burst_size - nb_rx;
 
 		stats->rx_poll_count++;
-		n = rte_eth_rx_burst(port_id, queue_id, mbufs, BATCH_SIZE);
+		q_stats->rx_poll_count++;
+		n = rte_eth_rx_burst(port_id, queue_id, mbufs, nb_pkts);
 		if (unlikely(!n)) {
+			q_stats->rx_empty_poll_count++;
 			if (rxq_empty)
 				*rxq_empty = 1;
 			break;
 		}
 		rxa_buffer_mbufs(rx_adapter, port_id, queue_id, mbufs, n);
 		nb_rx += n;
-		if (rx_count + nb_rx > max_rx)
+		if (rx_count + nb_rx > max_rx ||
+			(burst_size && nb_rx >= burst_size))
 			break;
 	}
 
-	if (buf->count >= BATCH_SIZE)
-		rxa_flush_event_buffer(rx_adapter);
+	q_stats->rx_packets += nb_rx;
+	rxa_flush_event_buffer_full(rx_adapter);
 
 	return nb_rx;
 }
@@ -1003,7 +1248,7 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 	rte_spinlock_t *ring_lock;
 	uint8_t max_done = 0;
 
-	if (rx_adapter->num_rx_intr == 0)
+	if (rx_adapter->num_rx_intr == 0 && rx_adapter->num_rx_adaptive == 0)
 		return 0;
 
 	if (rte_ring_count(rx_adapter->intr_ring) == 0
@@ -1013,16 +1258,23 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 	buf = &rx_adapter->event_enqueue_buffer;
 	ring_lock = &rx_adapter->intr_ring_lock;
 
-	if (buf->count >= BATCH_SIZE)
-		rxa_flush_event_buffer(rx_adapter);
+	rxa_flush_event_buffer_full(rx_adapter);
 
-	while (BATCH_SIZE <= (RTE_DIM(buf->events) - buf->count)) {
+	while (1) {
 		struct eth_device_info *dev_info;
 		uint16_t port;
 		uint16_t queue;
 		union queue_data qd  = rx_adapter->qd;
 		int err;
 
+		/* The interrupting queue, if any, is serviced next time */
+		if (BATCH_SIZE > (RTE_DIM(buf->events) - buf->count)) {
+			if (rx_adapter->qd_valid)
+				rx_adapter->eth_devices[qd.port].rx_queue[
+					qd.queue].stats.rx_enq_retry++;
+			break;
+		}
+
 		if (!rx_adapter->qd_valid) {
 			struct eth_rx_queue_info *queue_info;
 
@@ -1035,15 +1287,24 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 
 			port = qd.port;
 			queue = qd.queue;
+			dev_info = &rx_adapter->eth_devices[port];
+			queue_info = &dev_info->rx_queue[queue];
+			if (queue_info->adaptive) {
+				/* Traffic resumed, hand the queue back to
+				 * rxa_poll() with its interrupt disabled
+				 */
+				queue_info->intr_armed = 0;
+				queue_info->empty_polls = 0;
+				rx_adapter->stats.rx_adaptive_wakeups++;
+				rte_spinlock_unlock(ring_lock);
+				continue;
+			}
 			rx_adapter->qd = qd;
 			rx_adapter->qd_valid = 1;
-			dev_info = &rx_adapter->eth_devices[port];
 			if (rxa_shared_intr(dev_info, queue))
 				dev_info->shared_intr_enabled = 1;
-			else {
-				queue_info = &dev_info->rx_queue[queue];
+			else
 				queue_info->intr_enabled = 1;
-			}
 			rte_eth_dev_rx_intr_enable(port, queue);
 			rte_spinlock_unlock(ring_lock);
 		} else {
@@ -1065,7 +1326,7 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 				if (!rxa_intr_queue(dev_info, i))
 					continue;
 				n = rxa_eth_rx(rx_adapter, port, i, nb_rx,
-					rx_adapter->max_nb_rx,
+					rx_adapter->max_nb_rx, 0,
 					&rxq_empty);
 				nb_rx += n;
 
@@ -1086,7 +1347,7 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 						0;
 		} else {
 			n = rxa_eth_rx(rx_adapter, port, queue, nb_rx,
-				rx_adapter->max_nb_rx,
+				rx_adapter->max_nb_rx, 0,
 				&rxq_empty);
 			rx_adapter->qd_valid = !rxq_empty;
 			nb_rx += n;
@@ -1100,12 +1361,68 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 	return nb_rx;
 }
 
+/* Counts consecutive empty polls of an adaptive Rx queue, returns 1 if
+ * the queue has been idle long enough for its interrupt to be armed
+ */
+static inline int
+rxa_adaptive_sleep(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_rx_queue_info *queue_info,
+		uint16_t port_id,
+		uint16_t queue_id,
+		int idle)
+{
+	int err;
+
+	if (!idle) {
+		queue_info->empty_polls = 0;
+		return 0;
+	}
+
+	if (++queue_info->empty_polls < ETH_RX_ADAPTIVE_IDLE_POLLS)
+		return 0;
+
+	queue_info->empty_polls = 0;
+	rte_spinlock_lock(&rx_adapter->intr_ring_lock);
+	err = rte_eth_dev_rx_intr_enable(port_id, queue_id);
+	if (!err) {
+		queue_info->intr_enabled = 1;
+		queue_info->intr_armed = 1;
+	}
+	rte_spinlock_unlock(&rx_adapter->intr_ring_lock);
+	if (err)
+		return 0;
+
+	rx_adapter->stats.rx_adaptive_sleeps++;
+	return 1;
+}
+
+/* Switches an armed adaptive Rx queue back to poll mode */
+static inline void
+rxa_adaptive_wakeup(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_rx_queue_info *queue_info,
+		uint16_t port_id,
+		uint16_t queue_id)
+{
+	rte_spinlock_lock(&rx_adapter->intr_ring_lock);
+	/* If the interrupt has already fired the ring entry left behind by
+	 * the interrupt thread is consumed as a no-op wakeup
+	 */
+	if (queue_info->intr_enabled) {
+		queue_info->intr_enabled = 0;
+		rte_eth_dev_rx_intr_disable(port_id, queue_id);
+	}
+	queue_info->intr_armed = 0;
+	rte_spinlock_unlock(&rx_adapter->intr_ring_lock);
+}
+
 /*
  * Polls receive queues added to the event adapter and enqueues received
  * packets to the event device.
  *
  * The receive code enqueues initially to a temporary buffer, the
- * temporary buffer is drained anytime it holds >= BATCH_SIZE packets
+ * temporary buffer is drained anytime it holds a full event port enqueue
+ * burst, partial bursts are drained by the service function once the
+ * adapter is idle or the burst has been held for ETH_EVENT_BUFFER_FLUSH_US
  *
  * If there isn't space available in the temporary buffer, packets from the
  * Rx queue aren't dequeued from the eth device, this back pressures the
@@ -1118,13 +1435,13 @@ rxa_poll(struct rte_event_eth_rx_adapter *rx_adapter)
 {
 	uint32_t num_queue;
 	uint32_t nb_rx = 0;
-	struct rte_eth_event_enqueue_buffer *buf;
 	uint32_t wrr_pos;
 	uint32_t max_nb_rx;
+	uint32_t n;
+	int rxq_empty;
 
 	wrr_pos = rx_adapter->wrr_pos;
 	max_nb_rx = rx_adapter->max_nb_rx;
-	buf = &rx_adapter->event_enqueue_buffer;
 	stats = &rx_adapter->stats;
 
 	/* Iterate through a WRR sequence */
@@ -1132,25 +1449,43 @@ rxa_poll(struct rte_event_eth_rx_adapter *rx_adapter)
 		unsigned int poll_idx = rx_adapter->wrr_sched[wrr_pos];
 		uint16_t qid = rx_adapter->eth_rx_poll[poll_idx].eth_rx_qid;
 		uint16_t d = rx_adapter->eth_rx_poll[poll_idx].eth_dev_id;
+		struct eth_rx_queue_info *queue_info =
+			&rx_adapter->eth_devices[d].rx_queue[qid];
+
+		/* Idle adaptive queues are serviced from the interrupt ring */
+		if (unlikely(queue_info->intr_armed))
+			goto next;
 
 		/* Don't do a batch dequeue from the rx queue if there isn't
 		 * enough space in the enqueue buffer.
 		 */
-		if (buf->count >= BATCH_SIZE)
-			rxa_flush_event_buffer(rx_adapter);
-		if (BATCH_SIZE > (ETH_EVENT_BUFFER_SIZE - buf->count)) {
+		if (!rxa_flush_event_buffer_full(rx_adapter)) {
+			queue_info->stats.rx_enq_retry++;
 			rx_adapter->wrr_pos = wrr_pos;
 			return nb_rx;
 		}
 
-		nb_rx += rxa_eth_rx(rx_adapter, d, qid, nb_rx, max_nb_rx,
-				NULL);
+		n = rxa_eth_rx(rx_adapter, d, qid, nb_rx, max_nb_rx,
+				queue_info->burst_size, &rxq_empty);
+		if (unlikely(queue_info->adaptive) &&
+			rxa_adaptive_sleep(rx_adapter, queue_info, d, qid,
+					n == 0 && rxq_empty)) {
+			/* Packets received before the interrupt was enabled
+			 * don't raise it, poll once more before sleeping
+			 */
+			n = rxa_eth_rx(rx_adapter, d, qid, nb_rx, max_nb_rx,
+				queue_info->burst_size, &rxq_empty);
+			if (n != 0)
+				rxa_adaptive_wakeup(rx_adapter, queue_info,
+						d, qid);
+		}
+		nb_rx += n;
 		if (nb_rx > max_nb_rx) {
 			rx_adapter->wrr_pos =
 				    (wrr_pos + 1) % rx_adapter->wrr_len;
 			break;
 		}
-
+next:
 		if (++wrr_pos == rx_adapter->wrr_len)
 			wrr_pos = 0;
 	}
@@ -1162,6 +1497,7 @@ rxa_service_func(void *args)
 {
 	struct rte_event_eth_rx_adapter *rx_adapter = args;
 	struct rte_event_eth_rx_adapter_stats *stats;
+	uint32_t nb_rx;
 
 	if (rte_spinlock_trylock(&rx_adapter->rx_lock) == 0)
 		return 0;
@@ -1171,8 +1507,11 @@ rxa_service_func(void *args)
 	}
 
 	stats = &rx_adapter->stats;
-	stats->rx_packets += rxa_intr_ring_dequeue(rx_adapter);
-	stats->rx_packets += rxa_poll(rx_adapter);
+	nb_rx = rxa_intr_ring_dequeue(rx_adapter);
+	nb_rx += rxa_poll(rx_adapter);
+	rxa_vector_timeout(rx_adapter);
+	rxa_flush_event_buffer_timeout(rx_adapter, nb_rx);
+	stats->rx_packets += nb_rx;
 	rte_spinlock_unlock(&rx_adapter->rx_lock);
 	return 0;
 }
@@ -1356,7 +1695,7 @@ rxa_free_intr_resources(struct rte_event_eth_rx_adapter *rx_adapter)
 {
 	int ret;
 
-	if (rx_adapter->num_rx_intr == 0)
+	if (rx_adapter->intr_ring == NULL)
 		return 0;
 
 	ret = rxa_destroy_intr_thread(rx_adapter);
@@ -1599,6 +1938,153 @@ rxa_add_intr_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 	return err;
 }
 
+/* Register an adaptive Rx queue with the epoll fd, the interrupt stays
+ * disabled until the queue is found idle by rxa_poll()
+ */
+static int
+rxa_config_adaptive(struct rte_event_eth_rx_adapter *rx_adapter,
+	struct eth_device_info *dev_info,
+	uint16_t rx_queue_id)
+{
+	int err, err1;
+	uint16_t eth_dev_id = dev_info->dev->data->port_id;
+	struct eth_rx_queue_info *queue_info;
+	union queue_data qd;
+	int init_fd;
+
+	init_fd = rx_adapter->epd;
+	err = rxa_init_epd(rx_adapter);
+	if (err)
+		return err;
+
+	qd.port = eth_dev_id;
+	qd.queue = rx_queue_id;
+
+	err = rte_eth_dev_rx_intr_ctl_q(eth_dev_id, rx_queue_id,
+					rx_adapter->epd,
+					RTE_INTR_EVENT_ADD,
+					qd.ptr);
+	if (err) {
+		RTE_EDEV_LOG_ERR("Failed to add interrupt event for"
+			" Rx Queue %u err %d", rx_queue_id, err);
+		goto err_del_fd;
+	}
+
+	err = rxa_create_intr_thread(rx_adapter);
+	if (!err) {
+		queue_info = &dev_info->rx_queue[rx_queue_id];
+		queue_info->intr_enabled = 0;
+		queue_info->intr_armed = 0;
+		queue_info->empty_polls = 0;
+		return 0;
+	}
+
+	err1 = rte_eth_dev_rx_intr_ctl_q(eth_dev_id, rx_queue_id,
+					rx_adapter->epd,
+					RTE_INTR_EVENT_DEL,
+					0);
+	if (err1) {
+		RTE_EDEV_LOG_ERR("Could not delete event for"
+				" Rx Queue %u err %d", rx_queue_id, err1);
+	}
+err_del_fd:
+	if (init_fd == INIT_FD) {
+		close(rx_adapter->epd);
+		rx_adapter->epd = INIT_FD;
+	}
+
+	return err;
+}
+
+static void
+rxa_unconfig_adaptive(struct rte_event_eth_rx_adapter *rx_adapter,
+	struct eth_device_info *dev_info,
+	uint16_t rx_queue_id)
+{
+	int err;
+	uint16_t eth_dev_id = dev_info->dev->data->port_id;
+	struct eth_rx_queue_info *queue_info;
+
+	queue_info = &dev_info->rx_queue[rx_queue_id];
+	rte_spinlock_lock(&rx_adapter->intr_ring_lock);
+	if (queue_info->intr_enabled)
+		rte_eth_dev_rx_intr_disable(eth_dev_id, rx_queue_id);
+	queue_info->intr_enabled = 0;
+	queue_info->intr_armed = 0;
+	rte_spinlock_unlock(&rx_adapter->intr_ring_lock);
+
+	err = rte_eth_dev_rx_intr_ctl_q(eth_dev_id, rx_queue_id,
+					rx_adapter->epd,
+					RTE_INTR_EVENT_DEL,
+					0);
+	if (err)
+		RTE_EDEV_LOG_ERR("Interrupt event deletion failed %d", err);
+
+	rxa_intr_ring_del_entries(rx_adapter, dev_info, rx_queue_id);
+}
+
+static int
+rxa_add_adaptive_queue(struct rte_event_eth_rx_adapter *rx_adapter,
+	struct eth_device_info *dev_info,
+	int rx_queue_id)
+{
+	uint16_t nb_rx_queues = dev_info->dev->data->nb_rx_queues;
+	uint16_t first, last, i;
+	int err;
+
+	first = rx_queue_id == -1 ? 0 : rx_queue_id;
+	last = rx_queue_id == -1 ? nb_rx_queues : rx_queue_id + 1;
+
+	err = rxa_intr_ring_check_avail(rx_adapter, last - first);
+	if (err)
+		return err;
+
+	for (i = first; i < last; i++) {
+		err = rxa_config_adaptive(rx_adapter, dev_info, i);
+		if (err)
+			break;
+	}
+
+	if (err == 0) {
+		rx_adapter->num_intr_vec += last - first;
+		return 0;
+	}
+
+	while (i-- > first)
+		rxa_unconfig_adaptive(rx_adapter, dev_info, i);
+
+	return err;
+}
+
+/* Undo the interrupt configuration of adaptive Rx queues, the queues are
+ * left as plain polled queues
+ */
+static void
+rxa_del_adaptive_queue(struct rte_event_eth_rx_adapter *rx_adapter,
+	struct eth_device_info *dev_info,
+	int rx_queue_id)
+{
+	uint16_t nb_rx_queues = dev_info->dev->data->nb_rx_queues;
+	uint16_t i;
+
+	if (dev_info->nb_rx_adaptive == 0)
+		return;
+
+	if (rx_queue_id == -1) {
+		for (i = 0; i < nb_rx_queues; i++)
+			rxa_del_adaptive_queue(rx_adapter, dev_info, i);
+		return;
+	}
+
+	if (!rxa_adaptive_queue(dev_info, rx_queue_id))
+		return;
+
+	rxa_unconfig_adaptive(rx_adapter, dev_info, rx_queue_id);
+	dev_info->rx_queue[rx_queue_id].adaptive = 0;
+	dev_info->nb_rx_adaptive--;
+	rx_adapter->num_rx_adaptive--;
+	rx_adapter->num_intr_vec--;
+}
 
 static int
 rxa_init_service(struct rte_event_eth_rx_adapter *rx_adapter, uint8_t id)
@@ -1606,6 +2092,7 @@ rxa_init_service(struct rte_event_eth_rx_adapter *rx_adapter, uint8_t id)
 	int ret;
 	struct rte_service_spec service;
 	struct rte_event_eth_rx_adapter_conf rx_adapter_conf;
+	uint32_t enq_depth;
 
 	if (rx_adapter->service_inited)
 		return 0;
@@ -1634,6 +2121,15 @@ rxa_init_service(struct rte_event_eth_rx_adapter *rx_adapter, uint8_t id)
 	}
 	rx_adapter->event_port_id = rx_adapter_conf.event_port_id;
 	rx_adapter->max_nb_rx = rx_adapter_conf.max_nb_rx;
+	if (rte_event_port_attr_get(rx_adapter->eventdev_id,
+				rx_adapter->event_port_id,
+				RTE_EVENT_PORT_ATTR_ENQ_DEPTH,
+				&enq_depth) || enq_depth == 0)
+		enq_depth = BATCH_SIZE;
+	rx_adapter->flush_threshold = RTE_MIN(enq_depth,
+				(uint32_t)(ETH_EVENT_BUFFER_SIZE - BATCH_SIZE));
+	rx_adapter->flush_cycles = rte_get_tsc_hz() *
+				ETH_EVENT_BUFFER_FLUSH_US / US_PER_S;
 	rx_adapter->service_inited = 1;
 	rx_adapter->epd = INIT_FD;
 	return 0;
@@ -1699,6 +2195,10 @@ rxa_sw_del(struct rte_event_eth_rx_adapter *rx_adapter,
 	pollq = rxa_polled_queue(dev_info, rx_queue_id);
 	intrq = rxa_intr_queue(dev_info, rx_queue_id);
 	sintrq = rxa_shared_intr(dev_info, rx_queue_id);
+	if (dev_info->rx_queue[rx_queue_id].ena_vector) {
+		rxa_vector_release(rx_adapter, &dev_info->rx_queue[rx_queue_id]);
+		dev_info->rx_queue[rx_queue_id].ena_vector = 0;
+	}
 	rxa_update_queue(rx_adapter, dev_info, rx_queue_id, 0);
 	rx_adapter->num_rx_polled -= pollq;
 	dev_info->nb_rx_poll -= pollq;
@@ -1707,6 +2207,46 @@ rxa_sw_del(struct rte_event_eth_rx_adapter *rx_adapter,
 	dev_info->nb_shared_intr -= intrq && sintrq;
 }
 
+/* Vector timeout in TSC cycles, computed in floating point as
+ * vector_timeout_ns * tsc_hz may not fit in 64 bits
+ */
+static inline double
+rxa_vector_timeout_cycles(uint64_t timeout_ns)
+{
+	return (double)timeout_ns * rte_get_tsc_hz() / 1E9;
+}
+
+static void
+rxa_set_vector_data(struct eth_rx_queue_info *queue_info,
+	const struct rte_event_eth_rx_adapter_queue_conf *conf,
+	uint16_t port_id,
+	uint16_t rx_queue_id)
+{
+	struct eth_rx_vector_data *vec = &queue_info->vector_data;
+	struct rte_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.event_type = RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR;
+	ev.op = RTE_EVENT_OP_NEW;
+	ev.sched_type = conf->ev.sched_type;
+	ev.queue_id = conf->ev.queue_id;
+	ev.priority = conf->ev.priority;
+	if (conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID)
+		ev.flow_id = conf->ev.flow_id;
+	else
+		ev.flow_id = (port_id & 0xFF) << 12 | (rx_queue_id & 0xFFF);
+
+	vec->event = ev.event;
+	vec->vector_pool = conf->vector_mp;
+	vec->max_vector_count = conf->vector_sz;
+	vec->vector_timeout_ticks =
+		(uint64_t)rxa_vector_timeout_cycles(conf->vector_timeout_ns);
+	vec->port = port_id;
+	vec->queue = rx_queue_id;
+	vec->vector_ev = NULL;
+}
+
 static void
 rxa_add_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 	struct eth_device_info *dev_info,
@@ -1734,10 +2274,31 @@ rxa_add_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 	sintrq = rxa_shared_intr(dev_info, rx_queue_id);
 
 	queue_info = &dev_info->rx_queue[rx_queue_id];
+	if (!queue_info->queue_enabled)
+		memset(&queue_info->stats, 0, sizeof(queue_info->stats));
 	queue_info->event_queue_id = ev->queue_id;
 	queue_info->sched_type = ev->sched_type;
 	queue_info->priority = ev->priority;
 	queue_info->wt = conf->servicing_weight;
+	queue_info->burst_size = conf->burst_size;
+
+	if (queue_info->ena_vector) {
+		rxa_vector_release(rx_adapter, queue_info);
+		queue_info->ena_vector = 0;
+	}
+	if (queue_info->wt != 0 && (conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR)) {
+		rxa_set_vector_data(queue_info, conf,
+				dev_info->dev->data->port_id, rx_queue_id);
+		queue_info->ena_vector = 1;
+	}
+
+	if (queue_info->wt != 0 && (conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_INTR_ADAPTIVE)) {
+		queue_info->adaptive = 1;
+		dev_info->nb_rx_adaptive++;
+		rx_adapter->num_rx_adaptive++;
+	}
 
 	if (conf->rx_queue_flags &
 			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID) {
@@ -1770,6 +2331,75 @@ rxa_add_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 	}
 }
 
+static int
+rxa_vector_check(const struct rte_event_eth_rx_adapter_queue_conf *conf,
+	uint32_t cap)
+{
+	struct rte_mempool *mp = conf->vector_mp;
+	size_t max_elem;
+
+	if ((cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR) == 0) {
+		RTE_EDEV_LOG_ERR("Event vectors are not supported");
+		return -ENOTSUP;
+	}
+
+	if (mp == NULL || conf->vector_sz == 0) {
+		RTE_EDEV_LOG_ERR("Event vectors need a mempool and a non zero"
+			" vector size");
+		return -EINVAL;
+	}
+
+	max_elem = 0;
+	if (mp->elt_size > sizeof(struct rte_event_vector))
+		max_elem = (mp->elt_size - sizeof(struct rte_event_vector)) /
+				sizeof(uintptr_t);
+	if (conf->vector_sz > max_elem) {
+		RTE_EDEV_LOG_ERR("Vector size %" PRIu16 " exceeds the %zu"
+			" elements of mempool %s", conf->vector_sz, max_elem,
+			mp->name);
+		return -EINVAL;
+	}
+
+	/* UINT64_MAX rounds up to 2^64 as a double */
+	if (rxa_vector_timeout_cycles(conf->vector_timeout_ns) >=
+			(double)UINT64_MAX) {
+		RTE_EDEV_LOG_ERR("Vector timeout %" PRIu64 " ns out of range",
+			conf->vector_timeout_ns);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+rxa_adaptive_check(struct eth_device_info *dev_info,
+	int rx_queue_id,
+	uint16_t wt)
+{
+	uint16_t nb_rx_queues = dev_info->dev->data->nb_rx_queues;
+	uint16_t i;
+
+	if (wt == 0 || !dev_info->dev->data->dev_conf.intr_conf.rxq) {
+		RTE_EDEV_LOG_ERR("Adaptive Rx queues need a non zero servicing"
+			" weight and Rx interrupts enabled, eth port: %" PRIu16,
+			dev_info->dev->data->port_id);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < nb_rx_queues; i++) {
+		if (rx_queue_id != -1 && i != rx_queue_id)
+			continue;
+		if (rxa_shared_intr(dev_info, i)) {
+			RTE_EDEV_LOG_ERR("Rx queue %" PRIu16 " uses a shared"
+				" interrupt, adaptive mode is not supported",
+				i);
+			return -ENOTSUP;
+		}
+	}
+
+	return 0;
+}
+
 static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 		uint16_t eth_dev_id,
 		int rx_queue_id,
@@ -1786,6 +2416,16 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 	uint32_t nb_rx_intr;
 	int num_intr_vec;
 	uint16_t wt;
+	int adaptive;
+
+	adaptive = !!(queue_conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_INTR_ADAPTIVE);
+	if (adaptive) {
+		ret = rxa_adaptive_check(dev_info, rx_queue_id,
+					queue_conf->servicing_weight);
+		if (ret)
+			return ret;
+	}
 
 	if (queue_conf->servicing_weight == 0) {
 		struct rte_eth_dev_data *data = dev_info->dev->data;
@@ -1827,6 +2467,9 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 	if (ret)
 		goto err_free_rxqueue;
 
+	/* Queues that were adaptive are reconfigured below */
+	rxa_del_adaptive_queue(rx_adapter, dev_info, rx_queue_id);
+
 	if (wt == 0) {
 		num_intr_vec = rxa_nb_intr_vect(dev_info, rx_queue_id, 1);
 
@@ -1854,7 +2497,15 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 		}
 	}
 
-	if (nb_rx_intr == 0) {
+	if (adaptive) {
+		ret = rxa_add_adaptive_queue(rx_adapter, dev_info,
+					rx_queue_id);
+		if (ret)
+			goto err_free_rxqueue;
+	}
+
+	if (nb_rx_intr == 0 && !adaptive &&
+		rx_adapter->num_rx_adaptive == 0) {
 		ret = rxa_free_intr_resources(rx_adapter);
 		if (ret)
 			goto err_free_rxqueue;
@@ -1896,7 +2547,7 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 	rte_free(rx_poll);
 	rte_free(rx_wrr);
 
-	return 0;
+	return ret;
 }
 
 static int
@@ -2011,6 +2662,7 @@ rte_event_eth_rx_adapter_create_ext(uint8_t id, uint8_t dev_id,
 		return -ENOMEM;
 	}
 	rte_spinlock_init(&rx_adapter->rx_lock);
+	TAILQ_INIT(&rx_adapter->vector_list);
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++)
 		rx_adapter->eth_devices[i].dev = &rte_eth_devices[i];
 
@@ -2107,6 +2759,13 @@ rte_event_eth_rx_adapter_queue_add(uint8_t id,
 		return -EINVAL;
 	}
 
+	if (queue_conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR) {
+		ret = rxa_vector_check(queue_conf, cap);
+		if (ret)
+			return ret;
+	}
+
 	if ((cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_MULTI_EVENTQ) == 0 &&
 		(rx_queue_id != -1)) {
 		RTE_EDEV_LOG_ERR("Rx queues can only be connected to single "
@@ -2244,7 +2903,9 @@ rte_event_eth_rx_adapter_queue_del(uint8_t id, uint16_t eth_dev_id,
 				goto unlock_ret;
 		}
 
-		if (nb_rx_intr == 0) {
+		rxa_del_adaptive_queue(rx_adapter, dev_info, rx_queue_id);
+
+		if (nb_rx_intr == 0 && rx_adapter->num_rx_adaptive == 0) {
 			ret = rxa_free_intr_resources(rx_adapter);
 			if (ret)
 				goto unlock_ret;
@@ -2346,6 +3007,7 @@ rte_event_eth_rx_adapter_stats_reset(uint8_t id)
 	struct rte_eventdev *dev;
 	struct eth_device_info *dev_info;
 	uint32_t i;
+	uint16_t q;
 
 	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
 
@@ -2363,7 +3025,52 @@ rte_event_eth_rx_adapter_stats_reset(uint8_t id)
 							&rte_eth_devices[i]);
 	}
 
+	rte_spinlock_lock(&rx_adapter->rx_lock);
 	memset(&rx_adapter->stats, 0, sizeof(rx_adapter->stats));
+	RTE_ETH_FOREACH_DEV(i) {
+		dev_info = &rx_adapter->eth_devices[i];
+		if (dev_info->internal_event_port || dev_info->rx_queue == NULL)
+			continue;
+		for (q = 0; q < dev_info->dev->data->nb_rx_queues; q++)
+			memset(&dev_info->rx_queue[q].stats, 0,
+				sizeof(dev_info->rx_queue[q].stats));
+	}
+	rte_spinlock_unlock(&rx_adapter->rx_lock);
+	return 0;
+}
+
+int __rte_experimental
+rte_event_eth_rx_adapter_queue_stats_get(uint8_t id,
+			uint16_t eth_dev_id,
+			uint16_t rx_queue_id,
+			struct rte_event_eth_rx_adapter_queue_stats *stats)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter;
+	struct eth_device_info *dev_info;
+	struct eth_rx_queue_info *queue_info;
+
+	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(eth_dev_id, -EINVAL);
+
+	rx_adapter = rxa_id_to_adapter(id);
+	if (rx_adapter == NULL || stats == NULL)
+		return -EINVAL;
+
+	if (rx_queue_id >= rte_eth_devices[eth_dev_id].data->nb_rx_queues) {
+		RTE_EDEV_LOG_ERR("Invalid rx queue_id %" PRIu16, rx_queue_id);
+		return -EINVAL;
+	}
+
+	dev_info = &rx_adapter->eth_devices[eth_dev_id];
+	if (dev_info->internal_event_port)
+		return -ENOTSUP;
+
+	queue_info = dev_info->rx_queue ? &dev_info->rx_queue[rx_queue_id] :
+					NULL;
+	if (queue_info == NULL || !queue_info->queue_enabled)
+		return -EINVAL;
+
+	*stats = queue_info->stats;
 	return 0;
 }
 
@@ -37,6 +37,7 @@
  *  - rte_event_eth_rx_adapter_stop()
  *  - rte_event_eth_rx_adapter_stats_get()
  *  - rte_event_eth_rx_adapter_stats_reset()
+ *  - rte_event_eth_rx_adapter_queue_stats_get()
  *
  * The application creates an ethernet to event adapter using
  * rte_event_eth_rx_adapter_create_ext() or rte_event_eth_rx_adapter_create()
@@ -54,6 +55,9 @@
  * lower priority queues completely. If this parameter is zero and the receive
  * interrupt is enabled when configuring the device, the receive queue is
  * interrupt driven; else, the queue is assigned a servicing weight of one.
+ * A polled queue added with the RTE_EVENT_ETH_RX_ADAPTER_QUEUE_INTR_ADAPTIVE
+ * flag is interrupt driven while it is idle and polled while it receives
+ * traffic.
  *
  * The application can start/stop the adapter using the
  * rte_event_eth_rx_adapter_start() and the rte_event_eth_rx_adapter_stop()
@@ -95,6 +99,26 @@ extern "C" {
 /**< This flag indicates the flow identifier is valid
  * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
  */
+#define RTE_EVENT_ETH_RX_ADAPTER_QUEUE_INTR_ADAPTIVE	0x2
+/**< This flag makes a polled Rx queue switch to interrupt mode while it is
+ * idle. The queue is polled according to its servicing weight; once it has
+ * returned no packets for a number of consecutive polls its Rx interrupt is
+ * armed and the adapter stops polling it until the interrupt fires. Requires
+ * a non zero servicing weight and Rx queue interrupts to be enabled for the
+ * ethernet device. Not supported for Rx queues that share an interrupt
+ * vector.
+ * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+ */
+#define RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR	0x4
+/**< This flag makes the adapter aggregate the mbufs received on the Rx queue
+ * into event vectors of type RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR instead of
+ * enqueueing an event per mbuf. A vector is enqueued once it holds vector_sz
+ * mbufs or once vector_timeout_ns has elapsed since its first mbuf was
+ * added. Only applies to polled Rx queues, i.e., queues with a non zero
+ * servicing weight.
+ * @see rte_event_eth_rx_adapter_queue_conf::vector_sz
+ * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+ */
 
 /**
  * @warning
@@ -149,11 +173,17 @@ typedef int (*rte_event_eth_rx_adapter_conf_cb) (uint8_t id, uint8_t dev_id,
  * @b EXPERIMENTAL: this API may change without prior notice
  *
  * Rx queue configuration structure
+ *
+ * Callers must zero the structure, e.g. with memset(), before setting the
+ * members they use, so that members added in later releases, such as
+ * burst_size, keep their default behaviour.
  */
 struct rte_event_eth_rx_adapter_queue_conf {
 	uint32_t rx_queue_flags;
 	 /**< Flags for handling received packets
 	  * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID
+	  * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_INTR_ADAPTIVE
+	  * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR
 	  */
 	uint16_t servicing_weight;
 	/**< Relative polling frequency of ethernet receive queue when the
@@ -162,6 +192,15 @@ struct rte_event_eth_rx_adapter_queue_conf {
 	 * (unless rx queue interrupts are not enabled for the ethernet
 	 * device).
 	 */
+	uint16_t burst_size;
+	/**< Maximum number of packets dequeued from a polled Rx queue each
+	 * time the adapter's service function visits the queue in its
+	 * polling sequence. Zero means the queue is polled until it is empty
+	 * or the adapter has processed max_nb_rx mbufs. A limit allows high
+	 * rate queues to be interleaved with other queues rather than
+	 * monopolizing the service function.
+	 * @see rte_event_eth_rx_adapter_conf::max_nb_rx
+	 */
 	struct rte_event ev;
 	/**<
 	 *  The values from the following event fields will be used when
@@ -178,6 +217,24 @@ struct rte_event_eth_rx_adapter_queue_conf {
 	 *
 	 * The event adapter sets ev.event_type to RTE_EVENT_TYPE_ETHDEV in the
 	 * enqueued event.
+	 *
+	 * For event vectors, the flow_id is the one provided in this field if
+	 * RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID is set, otherwise it is
+	 * derived from the ethernet port and Rx queue identifiers.
+	 */
+	uint16_t vector_sz;
+	/**< Maximum number of mbufs aggregated into an event vector, only
+	 * valid if RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR is set. Must
+	 * not exceed the number of elements of the vectors of *vector_mp*.
+	 */
+	uint64_t vector_timeout_ns;
+	/**< Maximum time in nanoseconds a partially filled event vector is
+	 * held by the adapter before it is enqueued to the event device.
+	 * Must not exceed UINT64_MAX TSC cycles.
+	 */
+	struct rte_mempool *vector_mp;
+	/**< Mempool the event vectors are allocated from.
+	 * @see rte_event_vector_pool_create()
 	 */
 };
 
@@ -210,6 +267,34 @@ struct rte_event_eth_rx_adapter_stats {
 	 */
 	uint64_t rx_intr_packets;
 	/**< Received packet count for interrupt mode Rx queues */
+	uint64_t rx_adaptive_sleeps;
+	/**< Number of times an idle adaptive Rx queue switched to interrupt
+	 * mode
+	 */
+	uint64_t rx_adaptive_wakeups;
+	/**< Number of Rx interrupts that switched an adaptive Rx queue back to
+	 * poll mode
+	 */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * A structure used to retrieve statistics for an Rx queue serviced by the
+ * SW adapter.
+ */
+struct rte_event_eth_rx_adapter_queue_stats {
+	uint64_t rx_poll_count;
+	/**< Receive queue poll count */
+	uint64_t rx_empty_poll_count;
+	/**< Receive queue polls that returned no packets */
+	uint64_t rx_packets;
+	/**< Received packet count */
+	uint64_t rx_enq_retry;
+	/**< Count of Rx queue polls deferred because the event buffer was
+	 * full, i.e., the event device did not accept the buffered events.
+	 */
 };
 
 /**
@@ -457,6 +542,37 @@ int rte_event_eth_rx_adapter_stats_get(uint8_t id,
  */
 int rte_event_eth_rx_adapter_stats_reset(uint8_t id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve statistics for an Rx queue serviced by the adapter's service
+ * function. The counters are reset by rte_event_eth_rx_adapter_stats_reset().
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param eth_dev_id
+ *  Port identifier of Ethernet device.
+ *
+ * @param rx_queue_id
+ *  Ethernet device receive queue index.
+ *
+ * @param [out] stats
+ *  A pointer to structure used to retrieve statistics for the Rx queue.
+ *
+ * @return
+ *  - 0: Success, retrieved successfully.
+ *  - -ENOTSUP: The Rx queue is not serviced by the adapter's service
+ *    function, i.e., RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT is set.
+ *  - <0: Error code on failure.
+ */
+int __rte_experimental
+rte_event_eth_rx_adapter_queue_stats_get(uint8_t id,
+				uint16_t eth_dev_id,
+				uint16_t rx_queue_id,
+				struct rte_event_eth_rx_adapter_queue_stats *stats);
+
 /**
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice
@@ -16,7 +16,7 @@
 #include <rte_ring.h>
 #include <rte_mempool.h>
 #include <rte_common.h>
-#include <rte_timer.h>
+#include <rte_spinlock.h>
 #include <rte_service_component.h>
 #include <rte_cycles.h>
 
@@ -503,150 +503,245 @@ event_buffer_flush(struct event_buffer *bufp, uint8_t dev_id, uint8_t port_id,
 
 /*
  * Software event timer adapter implementation
+ *
+ * Every lcore that arms timers owns a timer wheel: an array of slot lists
+ * indexed by expiry tick. Arm and cancel only touch the wheel of the lcore
+ * that armed the timer, so producers on different lcores never contend with
+ * each other. The service walks the current slot of every non-empty wheel
+ * once per adapter tick and buffers the expiry events into bursts for the
+ * event device.
+ */
+
+/* Wheel used by threads that are not EAL lcores */
+#define SWTIM_NON_EAL_WHEEL RTE_MAX_LCORE
+#define SWTIM_NB_WHEELS (RTE_MAX_LCORE + 1)
+/* Timers further out than the wheel span wait for additional revolutions */
+#define SWTIM_MAX_SLOTS 1024
+/* Expired wheel entries are returned to the mempool in bursts of this size */
+#define SWTIM_FREE_BURST 32
+
+/* Expiry latency histogram: log-linear in timer cycles, with
+ * 2^SWTIM_LAT_SUB_BITS buckets per power of 2.
  */
+#define SWTIM_LAT_SUB_BITS 2
+#define SWTIM_LAT_NB_BUCKETS (64 << SWTIM_LAT_SUB_BITS)
+
+struct swtim_entry {
+	/* Event timer this entry arms */
+	struct rte_event_timer *evtim;
+	/* Adapter tick at which the timer expires */
+	uint64_t expiry_tick;
+	/* Timer cycle count at which the timer was due */
+	uint64_t deadline_cycles;
+	/* Wheel the entry is linked into */
+	unsigned int wheel_id;
+	LIST_ENTRY(swtim_entry) next;
+};
+
+LIST_HEAD(swtim_list, swtim_entry);
+
+struct swtim_wheel {
+	/* Guards the slot lists and the armed count. Only contended when the
+	 * service expires a slot of this wheel, or when a timer is canceled
+	 * from another lcore than the one that armed it.
+	 */
+	rte_spinlock_t lock;
+	/* Number of timers armed in this wheel; read without the lock by the
+	 * service to skip idle wheels.
+	 */
+	uint32_t nb_armed;
+	/* Slot lists, indexed by expiry tick modulo the number of slots */
+	struct swtim_list *slots;
+} __rte_cache_aligned;
 
 struct rte_event_timer_adapter_sw_data {
-	/* List of messages for outstanding timers */
-	TAILQ_HEAD(, msg) msgs_tailq_head;
-	/* Lock to guard tailq and armed count */
-	rte_spinlock_t msgs_tailq_sl;
 	/* Identifier of service executing timer management logic. */
 	uint32_t service_id;
-	/* The cycle count at which the adapter should next tick */
-	uint64_t next_tick_cycles;
-	/* Incremented as the service moves through phases of an iteration */
-	volatile int service_phase;
+	/* The number of timer cycles in an adapter tick */
+	uint64_t cycles_per_tick;
+	/* Last adapter tick expired by the service. Ticks are counted from
+	 * the timer cycle counter, so producers derive the current tick from
+	 * the clock and never read this.
+	 */
+	uint64_t cur_tick;
 	/* The tick resolution used by adapter instance. May have been
 	 * adjusted from what user requested
 	 */
 	uint64_t timer_tick_ns;
 	/* Maximum timeout in nanoseconds allowed by adapter instance. */
 	uint64_t max_tmo_ns;
-	/* Ring containing messages to arm or cancel event timers */
-	struct rte_ring *msg_ring;
-	/* Mempool containing msg objects */
-	struct rte_mempool *msg_pool;
+	/* Number of slots in each wheel, minus one */
+	uint64_t slot_mask;
+	/* Mempool containing wheel entry objects */
+	struct rte_mempool *entry_pool;
 	/* Buffered timer expiry events to be enqueued to an event device. */
 	struct event_buffer buffer;
 	/* Statistics */
 	struct rte_event_timer_adapter_stats stats;
-	/* The number of threads currently adding to the message ring */
-	rte_atomic16_t message_producer_count;
+	/* Expiry latency histogram and maximum, in timer cycles */
+	uint64_t lat_hist[SWTIM_LAT_NB_BUCKETS];
+	uint64_t lat_max_cycles;
+	/* Per lcore timer wheels */
+	struct swtim_wheel wheels[SWTIM_NB_WHEELS];
 };
 
-enum msg_type {MSG_TYPE_ARM, MSG_TYPE_CANCEL};
+static inline unsigned int
+swtim_lat_bucket(uint64_t cycles)
+{
+	unsigned int msb;
 
-struct msg {
-	enum msg_type type;
-	struct rte_event_timer *evtim;
-	struct rte_timer tim;
-	TAILQ_ENTRY(msg) msgs;
-};
+	if (cycles < (1 << SWTIM_LAT_SUB_BITS))
+		return cycles;
 
-static void
-sw_event_timer_cb(struct rte_timer *tim, void *arg)
+	msb = 63 - __builtin_clzll(cycles);
+	return ((msb - SWTIM_LAT_SUB_BITS + 1) << SWTIM_LAT_SUB_BITS) +
+		((cycles >> (msb - SWTIM_LAT_SUB_BITS)) &
+		 ((1 << SWTIM_LAT_SUB_BITS) - 1));
+}
+
+/* Largest cycle count that falls into a histogram bucket */
+static inline uint64_t
+swtim_lat_bucket_max(unsigned int bucket)
 {
-	int ret;
-	uint16_t nb_evs_flushed = 0;
-	uint16_t nb_evs_invalid = 0;
-	uint64_t opaque;
-	struct rte_event_timer *evtim;
-	struct rte_event_timer_adapter *adapter;
-	struct rte_event_timer_adapter_sw_data *sw_data;
+	unsigned int shift, sub;
 
-	evtim = arg;
-	opaque = evtim->impl_opaque[1];
-	adapter = (struct rte_event_timer_adapter *)(uintptr_t)opaque;
-	sw_data = adapter->data->adapter_priv;
+	if (bucket < (1 << SWTIM_LAT_SUB_BITS))
+		return bucket;
 
-	ret = event_buffer_add(&sw_data->buffer, &evtim->ev);
-	if (ret < 0) {
-		/* If event buffer is full, put timer back in list with
-		 * immediate expiry value, so that we process it again on the
-		 * next iteration.
-		 */
-		rte_timer_reset_sync(tim, 0, SINGLE, rte_lcore_id(),
-				     sw_event_timer_cb, evtim);
-
-		sw_data->stats.evtim_retry_count++;
-		EVTIM_LOG_DBG("event buffer full, resetting rte_timer with "
-			      "immediate expiry value");
-	} else {
-		struct msg *m = container_of(tim, struct msg, tim);
-		TAILQ_REMOVE(&sw_data->msgs_tailq_head, m, msgs);
-		EVTIM_BUF_LOG_DBG("buffered an event timer expiry event");
-		evtim->state = RTE_EVENT_TIMER_NOT_ARMED;
+	shift = (bucket >> SWTIM_LAT_SUB_BITS) - 1;
+	sub = bucket & ((1 << SWTIM_LAT_SUB_BITS) - 1);
+	return (((uint64_t)((1 << SWTIM_LAT_SUB_BITS) + sub)) << shift) +
+		((UINT64_C(1) << shift) - 1);
+}
 
-		/* Free the msg object containing the rte_timer now that
-		 * we've buffered its event successfully.
-		 */
-		rte_mempool_put(sw_data->msg_pool, m);
+static inline uint64_t
+swtim_cycles_to_ns(uint64_t cycles)
+{
+	return (uint64_t)(cycles * NSECPERSEC / rte_get_timer_hz());
+}
 
-		/* Bump the count when we successfully add an expiry event to
-		 * the buffer.
-		 */
-		sw_data->stats.evtim_exp_count++;
-	}
+/* Return the expiry latency, in nanoseconds, below which the given number of
+ * thousandths of the recorded expirations fall.
+ */
+static uint64_t
+swtim_lat_percentile(const struct rte_event_timer_adapter_sw_data *sw_data,
+		     uint64_t total, unsigned int per_mille)
+{
+	uint64_t target, sum = 0;
+	unsigned int i;
 
-	if (event_buffer_batch_ready(&sw_data->buffer)) {
-		event_buffer_flush(&sw_data->buffer,
-				   adapter->data->event_dev_id,
-				   adapter->data->event_port_id,
-				   &nb_evs_flushed,
-				   &nb_evs_invalid);
+	if (total == 0)
+		return 0;
 
-		sw_data->stats.ev_enq_count += nb_evs_flushed;
-		sw_data->stats.ev_inv_count += nb_evs_invalid;
+	target = RTE_MAX((total * per_mille + 999) / 1000, UINT64_C(1));
+	for (i = 0; i < SWTIM_LAT_NB_BUCKETS; i++) {
+		sum += sw_data->lat_hist[i];
+		if (sum >= target)
+			break;
 	}
+
+	return swtim_cycles_to_ns(RTE_MIN(swtim_lat_bucket_max(i),
+					  sw_data->lat_max_cycles));
 }
 
-static __rte_always_inline uint64_t
-get_timeout_cycles(struct rte_event_timer *evtim,
-		   struct rte_event_timer_adapter *adapter)
+static inline unsigned int
+swtim_wheel_id(void)
 {
-	uint64_t timeout_ns;
-	struct rte_event_timer_adapter_sw_data *sw_data;
-
-	sw_data = adapter->data->adapter_priv;
-	timeout_ns = evtim->timeout_ticks * sw_data->timer_tick_ns;
-	return timeout_ns * rte_get_timer_hz() / NSECPERSEC;
+	unsigned int lcore_id = rte_lcore_id();
 
+	return lcore_id < RTE_MAX_LCORE ? lcore_id : SWTIM_NON_EAL_WHEEL;
 }
 
-/* This function returns true if one or more (adapter) ticks have occurred since
- * the last time it was called.
- */
-static inline bool
-adapter_did_tick(struct rte_event_timer_adapter *adapter)
+static inline void
+swtim_buffer_flush(struct rte_event_timer_adapter *adapter,
+		   struct rte_event_timer_adapter_sw_data *sw_data)
 {
-	uint64_t cycles_per_adapter_tick, start_cycles;
-	uint64_t *next_tick_cyclesp;
-	struct rte_event_timer_adapter_sw_data *sw_data;
+	uint16_t nb_evs_flushed = 0;
+	uint16_t nb_evs_invalid = 0;
 
-	sw_data = adapter->data->adapter_priv;
-	next_tick_cyclesp = &sw_data->next_tick_cycles;
+	event_buffer_flush(&sw_data->buffer,
+			   adapter->data->event_dev_id,
+			   adapter->data->event_port_id,
+			   &nb_evs_flushed, &nb_evs_invalid);
 
-	cycles_per_adapter_tick = sw_data->timer_tick_ns *
-			(rte_get_timer_hz() / NSECPERSEC);
+	sw_data->stats.ev_enq_count += nb_evs_flushed;
+	sw_data->stats.ev_inv_count += nb_evs_invalid;
+}
 
-	start_cycles = rte_get_timer_cycles();
+/* Expire the timers of one wheel that are due at the given tick. */
+static void
+swtim_expire_slot(struct rte_event_timer_adapter *adapter,
+		  struct rte_event_timer_adapter_sw_data *sw_data,
+		  struct swtim_wheel *wheel, uint64_t tick, uint64_t now)
+{
+	struct swtim_entry *entry, *next;
+	struct swtim_entry *done[SWTIM_FREE_BURST];
+	struct rte_event_timer *evtim;
+	unsigned int nb_done = 0;
+	uint64_t latency;
+
+	rte_spinlock_lock(&wheel->lock);
+
+	for (entry = LIST_FIRST(&wheel->slots[tick & sw_data->slot_mask]);
+	     entry != NULL; entry = next) {
+		next = LIST_NEXT(entry, next);
+
+		/* Due on a later revolution of the wheel */
+		if (entry->expiry_tick > tick)
+			continue;
+
+		LIST_REMOVE(entry, next);
+		evtim = entry->evtim;
+
+		if (event_buffer_full(&sw_data->buffer))
+			swtim_buffer_flush(adapter, sw_data);
+
+		if (event_buffer_add(&sw_data->buffer, &evtim->ev) < 0) {
+			/* The event device is backed up; move the timer to
+			 * the next slot so that it is retried on the next
+			 * tick.
+			 */
+			LIST_INSERT_HEAD(
+				&wheel->slots[(tick + 1) & sw_data->slot_mask],
+				entry, next);
+			sw_data->stats.evtim_retry_count++;
+			EVTIM_LOG_DBG("event buffer full, retrying timer on "
+				      "next tick");
+			continue;
+		}
 
-	/* Note: initially, *next_tick_cyclesp == 0, so the clause below will
-	 * execute, and set things going.
-	 */
+		EVTIM_BUF_LOG_DBG("buffered an event timer expiry event");
+		evtim->impl_opaque[0] = 0;
+		evtim->state = RTE_EVENT_TIMER_NOT_ARMED;
+		wheel->nb_armed--;
+
+		latency = now > entry->deadline_cycles ?
+				now - entry->deadline_cycles : 0;
+		sw_data->lat_hist[swtim_lat_bucket(latency)]++;
+		if (latency > sw_data->lat_max_cycles)
+			sw_data->lat_max_cycles = latency;
 
-	if (start_cycles >= *next_tick_cyclesp) {
-		/* Snap the current cycle count to the preceding adapter tick
-		 * boundary.
+		/* Bump the count when we successfully add an expiry event to
+		 * the buffer.
 		 */
-		start_cycles -= start_cycles % cycles_per_adapter_tick;
+		sw_data->stats.evtim_exp_count++;
 
-		*next_tick_cyclesp = start_cycles + cycles_per_adapter_tick;
+		done[nb_done++] = entry;
+		if (nb_done == SWTIM_FREE_BURST) {
+			rte_mempool_put_bulk(sw_data->entry_pool,
+					     (void **)done, nb_done);
+			nb_done = 0;
+		}
 
-		return true;
+		if (event_buffer_batch_ready(&sw_data->buffer))
+			swtim_buffer_flush(adapter, sw_data);
 	}
 
-	return false;
+	rte_spinlock_unlock(&wheel->lock);
+
+	if (nb_done > 0)
+		rte_mempool_put_bulk(sw_data->entry_pool, (void **)done,
+				     nb_done);
 }
 
 /* Check that event timer timeout value is in range */
@@ -690,110 +785,57 @@ check_destination_event_queue(struct rte_event_timer *evtim,
 
 	return 0;
 }
+static inline int32_t
+get_mapped_count_for_service(uint32_t service_id)
+{
+	int32_t core_count, i, mapped_count = 0;
+	uint32_t lcore_arr[RTE_MAX_LCORE];
+
+	core_count = rte_service_lcore_list(lcore_arr, RTE_MAX_LCORE);
+
+	for (i = 0; i < core_count; i++)
+		if (rte_service_map_lcore_get(service_id, lcore_arr[i]) == 1)
+			mapped_count++;
+
+	return mapped_count;
+}
 
-#define NB_OBJS 32
 static int
 sw_event_timer_adapter_service_func(void *arg)
 {
-	int i, num_msgs;
-	uint64_t cycles, opaque;
-	uint16_t nb_evs_flushed = 0;
-	uint16_t nb_evs_invalid = 0;
+	unsigned int i;
+	uint64_t now, tick, target_tick;
 	struct rte_event_timer_adapter *adapter;
 	struct rte_event_timer_adapter_sw_data *sw_data;
-	struct rte_event_timer *evtim = NULL;
-	struct rte_timer *tim = NULL;
-	struct msg *msg, *msgs[NB_OBJS];
 
 	adapter = arg;
 	sw_data = adapter->data->adapter_priv;
 
-	sw_data->service_phase = 1;
-	rte_smp_wmb();
-
-	while (rte_atomic16_read(&sw_data->message_producer_count) > 0 ||
-	       !rte_ring_empty(sw_data->msg_ring)) {
-
-		num_msgs = rte_ring_dequeue_burst(sw_data->msg_ring,
-						  (void **)msgs, NB_OBJS, NULL);
-
-		for (i = 0; i < num_msgs; i++) {
-			int ret = 0;
-
-			RTE_SET_USED(ret);
-
-			msg = msgs[i];
-			evtim = msg->evtim;
-
-			switch (msg->type) {
-			case MSG_TYPE_ARM:
-				EVTIM_SVC_LOG_DBG("dequeued ARM message from "
-						  "ring");
-				tim = &msg->tim;
-				rte_timer_init(tim);
-				cycles = get_timeout_cycles(evtim,
-							    adapter);
-				ret = rte_timer_reset(tim, cycles, SINGLE,
-						      rte_lcore_id(),
-						      sw_event_timer_cb,
-						      evtim);
-				RTE_ASSERT(ret == 0);
-
-				evtim->impl_opaque[0] = (uintptr_t)tim;
-				evtim->impl_opaque[1] = (uintptr_t)adapter;
-
-				TAILQ_INSERT_TAIL(&sw_data->msgs_tailq_head,
-						  msg,
-						  msgs);
-				break;
-			case MSG_TYPE_CANCEL:
-				EVTIM_SVC_LOG_DBG("dequeued CANCEL message "
-						  "from ring");
-				opaque = evtim->impl_opaque[0];
-				tim = (struct rte_timer *)(uintptr_t)opaque;
-				RTE_ASSERT(tim != NULL);
-
-				ret = rte_timer_stop(tim);
-				RTE_ASSERT(ret == 0);
-
-				/* Free the msg object for the original arm
-				 * request.
-				 */
-				struct msg *m;
-				m = container_of(tim, struct msg, tim);
-				TAILQ_REMOVE(&sw_data->msgs_tailq_head, m,
-					     msgs);
-				rte_mempool_put(sw_data->msg_pool, m);
-
-				/* Free the msg object for the current msg */
-				rte_mempool_put(sw_data->msg_pool, msg);
-
-				evtim->impl_opaque[0] = 0;
-				evtim->impl_opaque[1] = 0;
-
-				break;
-			}
-		}
-	}
+	now = rte_get_timer_cycles();
+	target_tick = now / sw_data->cycles_per_tick;
 
-	sw_data->service_phase = 2;
-	rte_smp_wmb();
+	/* Catch up on every tick that has elapsed, so that no wheel slot is
+	 * skipped if the service core was busy elsewhere. One revolution
+	 * visits every slot, so there is no point in going further back.
+	 */
+	if (target_tick - sw_data->cur_tick > sw_data->slot_mask + 1)
+		sw_data->cur_tick = target_tick - (sw_data->slot_mask + 1);
 
-	if (adapter_did_tick(adapter)) {
-		rte_timer_manage();
+	while (sw_data->cur_tick < target_tick) {
+		tick = ++sw_data->cur_tick;
 
-		event_buffer_flush(&sw_data->buffer,
-				   adapter->data->event_dev_id,
-				   adapter->data->event_port_id,
-				   &nb_evs_flushed, &nb_evs_invalid);
+		for (i = 0; i < SWTIM_NB_WHEELS; i++) {
+			if (sw_data->wheels[i].nb_armed == 0)
+				continue;
+
+			swtim_expire_slot(adapter, sw_data, &sw_data->wheels[i],
+					  tick, now);
+		}
 
-		sw_data->stats.ev_enq_count += nb_evs_flushed;
-		sw_data->stats.ev_inv_count += nb_evs_invalid;
 		sw_data->stats.adapter_tick_count++;
 	}
 
-	sw_data->service_phase = 0;
-	rte_smp_wmb();
+	swtim_buffer_flush(adapter, sw_data);
 
 	return 0;
 }
@@ -808,7 +850,7 @@ sw_event_timer_adapter_service_func(void *arg)
  * of 2 to see what the largest cache size we can use is.
  */
 static int
-compute_msg_mempool_cache_size(uint64_t nb_requested, uint64_t nb_actual)
+compute_entry_mempool_cache_size(uint64_t nb_requested, uint64_t nb_actual)
 {
 	int i;
 	int size;
@@ -834,11 +876,12 @@ static int
 sw_event_timer_adapter_init(struct rte_event_timer_adapter *adapter)
 {
 	int ret;
+	unsigned int i;
 	struct rte_event_timer_adapter_sw_data *sw_data;
-	uint64_t nb_timers;
+	struct swtim_list *slots;
+	uint64_t nb_timers, nb_slots;
 	unsigned int flags;
 	struct rte_service_spec service;
-	static bool timer_subsystem_inited; // static initialized to false
 
 	/* Allocate storage for SW implementation data */
 	char priv_data_name[RTE_RING_NAMESIZE];
@@ -866,30 +909,42 @@ sw_event_timer_adapter_init(struct rte_event_timer_adapter *adapter)
 
 	sw_data->timer_tick_ns = adapter->data->conf.timer_tick_ns;
 	sw_data->max_tmo_ns = adapter->data->conf.max_tmo_ns;
+	sw_data->cycles_per_tick = RTE_MAX((uint64_t)(sw_data->timer_tick_ns *
+				rte_get_timer_hz() / NSECPERSEC), UINT64_C(1));
 
-	TAILQ_INIT(&sw_data->msgs_tailq_head);
-	rte_spinlock_init(&sw_data->msgs_tailq_sl);
-	rte_atomic16_init(&sw_data->message_producer_count);
-
-	/* Rings require power of 2, so round up to next such value */
-	nb_timers = rte_align64pow2(adapter->data->conf.nb_timers);
+	/* Size the wheels to cover the maximum timeout, plus the slot being
+	 * expired and the partial tick in which a timer is armed.
+	 */
+	nb_slots = rte_align64pow2(sw_data->max_tmo_ns /
+				   sw_data->timer_tick_ns + 2);
+	nb_slots = RTE_MIN(nb_slots, (uint64_t)SWTIM_MAX_SLOTS);
+	sw_data->slot_mask = nb_slots - 1;
 
-	char msg_ring_name[RTE_RING_NAMESIZE];
-	snprintf(msg_ring_name, RTE_RING_NAMESIZE,
-		 "sw_evtim_adap_msg_ring_%"PRIu8, adapter->data->id);
-	flags = adapter->data->conf.flags & RTE_EVENT_TIMER_ADAPTER_F_SP_PUT ?
-		RING_F_SP_ENQ | RING_F_SC_DEQ :
-		RING_F_SC_DEQ;
-	sw_data->msg_ring = rte_ring_create(msg_ring_name, nb_timers,
-					    adapter->data->socket_id, flags);
-	if (sw_data->msg_ring == NULL) {
-		EVTIM_LOG_ERR("failed to create message ring");
+	char slots_name[RTE_RING_NAMESIZE];
+	snprintf(slots_name, RTE_RING_NAMESIZE, "sw_evtim_adap_slots_%"PRIu8,
+		 adapter->data->id);
+	slots = rte_zmalloc_socket(slots_name,
+				   sizeof(*slots) * nb_slots * SWTIM_NB_WHEELS,
+				   RTE_CACHE_LINE_SIZE,
+				   adapter->data->socket_id);
+	if (slots == NULL) {
+		EVTIM_LOG_ERR("failed to allocate timer wheels");
 		rte_errno = ENOMEM;
 		goto free_priv_data;
 	}
 
+	for (i = 0; i < SWTIM_NB_WHEELS; i++) {
+		rte_spinlock_init(&sw_data->wheels[i].lock);
+		sw_data->wheels[i].slots = &slots[i * nb_slots];
+	}
+
+	/* Round the number of wheel entries up to a power of 2, and use the
+	 * difference for mempool caches.
+	 */
+	nb_timers = rte_align64pow2(adapter->data->conf.nb_timers);
+
 	char pool_name[RTE_RING_NAMESIZE];
-	snprintf(pool_name, RTE_RING_NAMESIZE, "sw_evtim_adap_msg_pool_%"PRIu8,
+	snprintf(pool_name, RTE_RING_NAMESIZE, "sw_evtim_adap_pool_%"PRIu8,
 		 adapter->data->id);
 
 	/* Both the arming/canceling thread and the service thread will do puts
@@ -903,16 +958,18 @@ sw_event_timer_adapter_init(struct rte_event_timer_adapter *adapter)
 	 * make the counts agree.
 	 */
 	int pool_size = nb_timers - 1;
-	int cache_size = compute_msg_mempool_cache_size(
+	int cache_size = compute_entry_mempool_cache_size(
 				adapter->data->conf.nb_timers, nb_timers);
-	sw_data->msg_pool = rte_mempool_create(pool_name, pool_size,
-					       sizeof(struct msg), cache_size,
-					       0, NULL, NULL, NULL, NULL,
-					       adapter->data->socket_id, flags);
-	if (sw_data->msg_pool == NULL) {
-		EVTIM_LOG_ERR("failed to create message object mempool");
+	sw_data->entry_pool = rte_mempool_create(pool_name, pool_size,
+						 sizeof(struct swtim_entry),
+						 cache_size, 0, NULL, NULL,
+						 NULL, NULL,
+						 adapter->data->socket_id,
+						 flags);
+	if (sw_data->entry_pool == NULL) {
+		EVTIM_LOG_ERR("failed to create wheel entry mempool");
 		rte_errno = ENOMEM;
-		goto free_msg_ring;
+		goto free_slots;
 	}
 
 	event_buffer_init(&sw_data->buffer);
@@ -932,7 +989,7 @@ sw_event_timer_adapter_init(struct rte_event_timer_adapter *adapter)
 			      ret);
 
 		rte_errno = ENOSPC;
-		goto free_msg_pool;
+		goto free_entry_pool;
 	}
 
 	EVTIM_LOG_DBG("registered service %s with id %"PRIu32, service.name,
@@ -941,17 +998,12 @@ sw_event_timer_adapter_init(struct rte_event_timer_adapter *adapter)
 	adapter->data->service_id = sw_data->service_id;
 	adapter->data->service_inited = 1;
 
-	if (!timer_subsystem_inited) {
-		rte_timer_subsystem_init();
-		timer_subsystem_inited = true;
-	}
-
 	return 0;
 
-free_msg_pool:
-	rte_mempool_free(sw_data->msg_pool);
-free_msg_ring:
-	rte_ring_free(sw_data->msg_ring);
+free_entry_pool:
+	rte_mempool_free(sw_data->entry_pool);
+free_slots:
+	rte_free(slots);
 free_priv_data:
 	rte_free(sw_data);
 	return -1;
@@ -961,62 +1013,66 @@ static int
 sw_event_timer_adapter_uninit(struct rte_event_timer_adapter *adapter)
 {
 	int ret;
-	struct msg *m1, *m2;
+	unsigned int i;
+	uint64_t slot;
+	struct swtim_entry *entry;
+	struct swtim_wheel *wheel;
 	struct rte_event_timer_adapter_sw_data *sw_data =
 						adapter->data->adapter_priv;
 
-	rte_spinlock_lock(&sw_data->msgs_tailq_sl);
-
-	/* Cancel outstanding rte_timers and free msg objects */
-	m1 = TAILQ_FIRST(&sw_data->msgs_tailq_head);
-	while (m1 != NULL) {
-		EVTIM_LOG_DBG("freeing outstanding timer");
-		m2 = TAILQ_NEXT(m1, msgs);
-
-		rte_timer_stop_sync(&m1->tim);
-		rte_mempool_put(sw_data->msg_pool, m1);
+	/* Free the wheel entries of outstanding timers */
+	for (i = 0; i < SWTIM_NB_WHEELS; i++) {
+		wheel = &sw_data->wheels[i];
+		rte_spinlock_lock(&wheel->lock);
+
+		for (slot = 0; wheel->nb_armed > 0 &&
+		     slot <= sw_data->slot_mask; slot++) {
+			while ((entry = LIST_FIRST(&wheel->slots[slot]))) {
+				EVTIM_LOG_DBG("freeing outstanding timer");
+				LIST_REMOVE(entry, next);
+				wheel->nb_armed--;
+				rte_mempool_put(sw_data->entry_pool, entry);
+			}
+		}
 
-		m1 = m2;
+		rte_spinlock_unlock(&wheel->lock);
 	}
 
-	rte_spinlock_unlock(&sw_data->msgs_tailq_sl);
-
 	ret = rte_service_component_unregister(sw_data->service_id);
 	if (ret < 0) {
 		EVTIM_LOG_ERR("failed to unregister service component");
 		return ret;
 	}
 
-	rte_ring_free(sw_data->msg_ring);
-	rte_mempool_free(sw_data->msg_pool);
+	rte_mempool_free(sw_data->entry_pool);
+	rte_free(sw_data->wheels[0].slots);
 	rte_free(adapter->data->adapter_priv);
 
 	return 0;
 }
 
-static inline int32_t
-get_mapped_count_for_service(uint32_t service_id)
-{
-	int32_t core_count, i, mapped_count = 0;
-	uint32_t lcore_arr[RTE_MAX_LCORE];
-
-	core_count = rte_service_lcore_list(lcore_arr, RTE_MAX_LCORE);
-
-	for (i = 0; i < core_count; i++)
-		if (rte_service_map_lcore_get(service_id, lcore_arr[i]) == 1)
-			mapped_count++;
-
-	return mapped_count;
-}
 
 static int
 sw_event_timer_adapter_start(const struct rte_event_timer_adapter *adapter)
 {
 	int mapped_count;
+	unsigned int i;
+	uint64_t nb_armed = 0;
 	struct rte_event_timer_adapter_sw_data *sw_data;
 
 	sw_data = adapter->data->adapter_priv;
 
+	/* Timers are placed relative to the clock, so the service has to
+	 * expire the slots from the tick the adapter starts at, however late
+	 * its first run is. Timers left armed across a stop are caught up
+	 * with from the last tick expired instead.
+	 */
+	for (i = 0; i < SWTIM_NB_WHEELS; i++)
+		nb_armed += sw_data->wheels[i].nb_armed;
+	if (sw_data->cur_tick == 0 || nb_armed == 0)
+		sw_data->cur_tick = rte_get_timer_cycles() /
+				    sw_data->cycles_per_tick;
+
 	/* Mapping the service to more than one service core can introduce
 	 * delays while one thread is waiting to acquire a lock, so only allow
 	 * one core to be mapped to the service.
@@ -1042,9 +1098,9 @@ sw_event_timer_adapter_stop(const struct rte_event_timer_adapter *adapter)
 		return ret;
 
 	/* Wait for the service to complete its final iteration before
-	 * stopping.
+	 * stopping; the adapter may be freed right after this returns.
 	 */
-	while (sw_data->service_phase != 0)
+	while (rte_service_may_be_active(sw_data->service_id) == 1)
 		rte_pause();
 
 	rte_smp_rmb();
@@ -1067,9 +1123,21 @@ static int
 sw_event_timer_adapter_stats_get(const struct rte_event_timer_adapter *adapter,
 				 struct rte_event_timer_adapter_stats *stats)
 {
+	unsigned int i;
+	uint64_t total = 0;
 	struct rte_event_timer_adapter_sw_data *sw_data;
 	sw_data = adapter->data->adapter_priv;
 	*stats = sw_data->stats;
+
+	for (i = 0; i < SWTIM_LAT_NB_BUCKETS; i++)
+		total += sw_data->lat_hist[i];
+
+	stats->evtim_exp_lat_p50_ns = swtim_lat_percentile(sw_data, total, 500);
+	stats->evtim_exp_lat_p99_ns = swtim_lat_percentile(sw_data, total, 990);
+	stats->evtim_exp_lat_p999_ns = swtim_lat_percentile(sw_data, total,
+							    999);
+	stats->evtim_exp_lat_max_ns = swtim_cycles_to_ns(
+						sw_data->lat_max_cycles);
 	return 0;
 }
 
@@ -1080,6 +1148,8 @@ sw_event_timer_adapter_stats_reset(
 	struct rte_event_timer_adapter_sw_data *sw_data;
 	sw_data = adapter->data->adapter_priv;
 	memset(&sw_data->stats, 0, sizeof(sw_data->stats));
+	memset(sw_data->lat_hist, 0, sizeof(sw_data->lat_hist));
+	sw_data->lat_max_cycles = 0;
 	return 0;
 }
 
@@ -1090,8 +1160,11 @@ __sw_event_timer_arm_burst(const struct rte_event_timer_adapter *adapter,
 {
 	uint16_t i;
 	int ret;
+	unsigned int wheel_id;
+	uint64_t now, now_tick;
 	struct rte_event_timer_adapter_sw_data *sw_data;
-	struct msg *msgs[nb_evtims];
+	struct swtim_wheel *wheel;
+	struct swtim_entry *entries[nb_evtims];
 
 #ifdef RTE_LIBRTE_EVENTDEV_DEBUG
 	/* Check that the service is running. */
@@ -1103,20 +1176,26 @@ __sw_event_timer_arm_burst(const struct rte_event_timer_adapter *adapter,
 
 	sw_data = adapter->data->adapter_priv;
 
-	ret = rte_mempool_get_bulk(sw_data->msg_pool, (void **)msgs, nb_evtims);
+	ret = rte_mempool_get_bulk(sw_data->entry_pool, (void **)entries,
+				   nb_evtims);
 	if (ret < 0) {
 		rte_errno = ENOSPC;
 		return 0;
 	}
 
-	/* Let the service know we're producing messages for it to process */
-	rte_atomic16_inc(&sw_data->message_producer_count);
+	wheel_id = swtim_wheel_id();
+	wheel = &sw_data->wheels[wheel_id];
 
-	/* If the service is managing timers, wait for it to finish */
-	while (sw_data->service_phase == 2)
-		rte_pause();
+	rte_spinlock_lock(&wheel->lock);
 
-	rte_smp_rmb();
+	/* Read the clock with the lock held: the service cannot have expired
+	 * any slot of this wheel past the current tick, so expiring on the
+	 * first tick boundary at or after the deadline never lands in a slot
+	 * it has already visited.
+	 */
+	now = rte_get_timer_cycles();
+	now_tick = (now + sw_data->cycles_per_tick - 1) /
+		   sw_data->cycles_per_tick;
 
 	for (i = 0; i < nb_evtims; i++) {
 		/* Don't modify the event timer state in these cases */
@@ -1147,33 +1226,33 @@ __sw_event_timer_arm_burst(const struct rte_event_timer_adapter *adapter,
 			break;
 		}
 
-		/* Checks passed, set up a message to enqueue */
-		msgs[i]->type = MSG_TYPE_ARM;
-		msgs[i]->evtim = evtims[i];
-
 		/* Set the payload pointer if not set. */
 		if (evtims[i]->ev.event_ptr == NULL)
 			evtims[i]->ev.event_ptr = evtims[i];
 
-		/* msg objects that get enqueued successfully will be freed
-		 * either by a future cancel operation or by the timer
-		 * expiration callback.
+		/* Entries linked into the wheel are freed either by a future
+		 * cancel operation or by the service when the timer expires.
 		 */
-		if (rte_ring_enqueue(sw_data->msg_ring, msgs[i]) < 0) {
-			rte_errno = ENOSPC;
-			break;
-		}
-
-		EVTIM_LOG_DBG("enqueued ARM message to ring");
-
+		entries[i]->evtim = evtims[i];
+		entries[i]->expiry_tick = now_tick + evtims[i]->timeout_ticks;
+		entries[i]->deadline_cycles = now + evtims[i]->timeout_ticks *
+					      sw_data->cycles_per_tick;
+		entries[i]->wheel_id = wheel_id;
+		LIST_INSERT_HEAD(&wheel->slots[entries[i]->expiry_tick &
+					       sw_data->slot_mask],
+				 entries[i], next);
+
+		evtims[i]->impl_opaque[0] = (uintptr_t)entries[i];
+		evtims[i]->impl_opaque[1] = (uintptr_t)adapter;
 		evtims[i]->state = RTE_EVENT_TIMER_ARMED;
 	}
 
-	/* Let the service know we're done producing messages */
-	rte_atomic16_dec(&sw_data->message_producer_count);
+	wheel->nb_armed += i;
+
+	rte_spinlock_unlock(&wheel->lock);
 
 	if (i < nb_evtims)
-		rte_mempool_put_bulk(sw_data->msg_pool, (void **)&msgs[i],
+		rte_mempool_put_bulk(sw_data->entry_pool, (void **)&entries[i],
 				     nb_evtims - i);
 
 	return i;
@@ -1193,9 +1272,10 @@ sw_event_timer_cancel_burst(const struct rte_event_timer_adapter *adapter,
 			    uint16_t nb_evtims)
 {
 	uint16_t i;
-	int ret;
+	uint64_t opaque;
 	struct rte_event_timer_adapter_sw_data *sw_data;
-	struct msg *msgs[nb_evtims];
+	struct swtim_wheel *wheel, *locked = NULL;
+	struct swtim_entry *entry;
 
 #ifdef RTE_LIBRTE_EVENTDEV_DEBUG
 	/* Check that the service is running. */
@@ -1207,21 +1287,6 @@ sw_event_timer_cancel_burst(const struct rte_event_timer_adapter *adapter,
 
 	sw_data = adapter->data->adapter_priv;
 
-	ret = rte_mempool_get_bulk(sw_data->msg_pool, (void **)msgs, nb_evtims);
-	if (ret < 0) {
-		rte_errno = ENOSPC;
-		return 0;
-	}
-
-	/* Let the service know we're producing messages for it to process */
-	rte_atomic16_inc(&sw_data->message_producer_count);
-
-	/* If the service could be modifying event timer states, wait */
-	while (sw_data->service_phase == 2)
-		rte_pause();
-
-	rte_smp_rmb();
-
 	for (i = 0; i < nb_evtims; i++) {
 		/* Don't modify the event timer state in these cases */
 		if (evtims[i]->state == RTE_EVENT_TIMER_CANCELED) {
@@ -1232,25 +1297,53 @@ sw_event_timer_cancel_burst(const struct rte_event_timer_adapter *adapter,
 			break;
 		}
 
-		msgs[i]->type = MSG_TYPE_CANCEL;
-		msgs[i]->evtim = evtims[i];
+retry:
+		opaque = evtims[i]->impl_opaque[0];
+		if (opaque == 0) {
+			rte_errno = EINVAL;
+			break;
+		}
+
+		entry = (struct swtim_entry *)(uintptr_t)opaque;
+		wheel = &sw_data->wheels[entry->wheel_id];
+
+		/* Consecutive timers armed on the same lcore share a lock
+		 * acquisition.
+		 */
+		if (wheel != locked) {
+			if (locked != NULL)
+				rte_spinlock_unlock(&locked->lock);
+			rte_spinlock_lock(&wheel->lock);
+			locked = wheel;
+		}
 
-		if (rte_ring_enqueue(sw_data->msg_ring, msgs[i]) < 0) {
-			rte_errno = ENOSPC;
+		/* The timer may have expired, and its entry been reused,
+		 * before we took the lock.
+		 */
+		if (evtims[i]->state != RTE_EVENT_TIMER_ARMED ||
+		    evtims[i]->impl_opaque[0] != opaque ||
+		    entry->evtim != evtims[i]) {
+			rte_errno = EINVAL;
 			break;
 		}
 
-		EVTIM_LOG_DBG("enqueued CANCEL message to ring");
+		/* Re-armed from another lcore in the meantime */
+		if (&sw_data->wheels[entry->wheel_id] != wheel)
+			goto retry;
+
+		LIST_REMOVE(entry, next);
+		wheel->nb_armed--;
+		rte_mempool_put(sw_data->entry_pool, entry);
 
+		EVTIM_LOG_DBG("canceled event timer");
+
+		evtims[i]->impl_opaque[0] = 0;
+		evtims[i]->impl_opaque[1] = 0;
 		evtims[i]->state = RTE_EVENT_TIMER_CANCELED;
 	}
 
-	/* Let the service know we're done producing messages */
-	rte_atomic16_dec(&sw_data->message_producer_count);
-
-	if (i < nb_evtims)
-		rte_mempool_put_bulk(sw_data->msg_pool, (void **)&msgs[i],
-				     nb_evtims - i);
+	if (locked != NULL)
+		rte_spinlock_unlock(&locked->lock);
 
 	return i;
 }
@@ -1282,6 +1375,7 @@ static const struct rte_event_timer_adapter_ops sw_event_adapter_timer_ops = {
 	.cancel_burst = sw_event_timer_cancel_burst,
 };
 
+
 RTE_INIT(event_timer_adapter_init_log)
 {
 	evtim_logtype = rte_log_register("lib.eventdev.adapter.timer");
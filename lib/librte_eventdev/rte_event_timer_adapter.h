@@ -195,6 +195,16 @@ struct rte_event_timer_adapter_stats {
 	/**< Event timer retry count */
 	uint64_t adapter_tick_count;
 	/**< Tick count for the adapter, at its resolution */
+	uint64_t evtim_exp_lat_p50_ns;
+	/**< Median delay between an event timer's deadline and its expiry
+	 * event being buffered for enqueue, in nanoseconds
+	 */
+	uint64_t evtim_exp_lat_p99_ns;
+	/**< 99th percentile of the event timer expiry latency */
+	uint64_t evtim_exp_lat_p999_ns;
+	/**< 99.9th percentile of the event timer expiry latency */
+	uint64_t evtim_exp_lat_max_ns;
+	/**< Maximum event timer expiry latency */
 };
 
 struct rte_event_timer_adapter;
@@ -27,6 +27,7 @@
 #include <rte_branch_prediction.h>
 #include <rte_common.h>
 #include <rte_malloc.h>
+#include <rte_mempool.h>
 #include <rte_errno.h>
 #include <rte_ethdev.h>
 #include <rte_cryptodev.h>
@@ -1195,6 +1196,25 @@ int rte_event_dev_selftest(uint8_t dev_id)
 	return -ENOTSUP;
 }
 
+struct rte_mempool * __rte_experimental
+rte_event_vector_pool_create(const char *name, unsigned int n,
+			     unsigned int cache_size, uint16_t nb_elem,
+			     int socket_id)
+{
+	unsigned int elt_sz;
+
+	if (nb_elem == 0) {
+		RTE_EDEV_LOG_ERR("Invalid number of elements=%d", nb_elem);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	elt_sz = sizeof(struct rte_event_vector) +
+		nb_elem * sizeof(uintptr_t);
+	return rte_mempool_create(name, n, elt_sz, cache_size, 0,
+				NULL, NULL, NULL, NULL, socket_id, 0);
+}
+
 int
 rte_event_dev_start(uint8_t dev_id)
 {
@@ -950,6 +950,22 @@ rte_event_dev_close(uint8_t dev_id);
  */
 #define RTE_EVENT_TYPE_ETH_RX_ADAPTER   0x4
 /**< The event generated from event eth Rx adapter */
+#define RTE_EVENT_TYPE_VECTOR           0x8
+/**< Indicates that the event is a vector, the event points to a
+ * struct rte_event_vector instead of a single object.
+ * All vector event types are a logical OR of RTE_EVENT_TYPE_VECTOR and
+ * the event type of the objects aggregated in the vector, so that
+ * workers can split vector and non vector processing as follows:
+ *
+ *	if (ev.event_type & RTE_EVENT_TYPE_VECTOR) {
+ *		// Process ev.vec->mbufs[0 .. ev.vec->nb_elem - 1]
+ *	} else {
+ *		// Process ev.mbuf
+ *	}
+ */
+#define RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR \
+	(RTE_EVENT_TYPE_VECTOR | RTE_EVENT_TYPE_ETH_RX_ADAPTER)
+/**< The event vector generated from event eth Rx adapter */
 #define RTE_EVENT_TYPE_MAX              0x10
 /**< Maximum number of event types */
 
@@ -999,6 +1015,55 @@ rte_event_dev_close(uint8_t dev_id);
  *
  */
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice
+ *
+ * Event vector structure, an event of type RTE_EVENT_TYPE_VECTOR carries a
+ * pointer to an event vector in its *vec* member. Event vectors are
+ * allocated from a mempool created with rte_event_vector_pool_create(),
+ * the consumer of the event returns the vector to its mempool once the
+ * objects of the vector have been processed.
+ */
+struct rte_event_vector {
+	uint16_t nb_elem;
+	/**< Number of elements in this event vector. */
+	uint16_t rsvd : 15;
+	/**< Reserved for future use */
+	uint16_t attr_valid : 1;
+	/**< Set if the *port* and *queue* attributes are valid, i.e., all
+	 * the mbufs of the vector were received on the same ethdev Rx queue.
+	 */
+	union {
+		/* Used by Rx adapter.
+		 * Indicates that all elements in this vector belong to the
+		 * same port and queue pair when originating from Rx adapter,
+		 * valid only when event type is
+		 * RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR and attr_valid is set.
+		 */
+		struct {
+			uint16_t port;
+			/**< Ethernet device port identifier */
+			uint16_t queue;
+			/**< Ethernet device Rx queue index */
+		};
+		uint32_t rsvd_u32;
+	};
+	uint64_t impl_opaque;
+	/**< Implementation specific opaque value, the application should not
+	 * modify this field.
+	 */
+	union {
+		struct rte_mbuf *mbufs[0];
+		void *ptrs[0];
+		uint64_t u64s[0];
+	} __rte_aligned(16);
+	/**< Start of the vector array union. Depending upon the event type the
+	 * vector array can be an array of mbufs or pointers or opaque u64
+	 * values.
+	 */
+} __rte_aligned(16);
+
 /**
  * The generic *rte_event* structure to hold the event attributes
  * for dequeue and enqueue operation
@@ -1072,6 +1137,10 @@ struct rte_event {
 		/**< Opaque event pointer */
 		struct rte_mbuf *mbuf;
 		/**< mbuf pointer if dequeued event is associated with mbuf */
+		struct rte_event_vector *vec;
+		/**< Event vector pointer if the event type has the
+		 * RTE_EVENT_TYPE_VECTOR flag set
+		 */
 	};
 };
 
@@ -1091,6 +1160,12 @@ struct rte_event {
  * @see struct rte_event_eth_rx_adapter_queue_conf::ev
  * @see struct rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
  */
+#define RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR	0x8
+/**< Adapter supports aggregating the mbufs received on an ethdev Rx queue
+ * into event vectors.
+ * @see struct rte_event_vector
+ * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR
+ */
 
 /**
  * Retrieve the event device's ethdev Rx adapter capabilities for the
@@ -1971,6 +2046,37 @@ rte_event_dev_xstats_reset(uint8_t dev_id,
  */
 int rte_event_dev_selftest(uint8_t dev_id);
 
+struct rte_mempool;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a mempool of event vectors, each able to hold up to *nb_elem*
+ * objects.
+ *
+ * @param name
+ *   The name of the mempool.
+ * @param n
+ *   The number of event vectors in the mempool.
+ * @param cache_size
+ *   Size of the per-core object cache, see rte_mempool_create().
+ * @param nb_elem
+ *   The maximum number of elements of an event vector.
+ * @param socket_id
+ *   The socket identifier where the memory should be allocated, or
+ *   SOCKET_ID_ANY if there is no NUMA constraint.
+ * @return
+ *   The pointer to the new allocated mempool, on success. NULL on error
+ *   with rte_errno set appropriately:
+ *   - EINVAL: *nb_elem* is zero.
+ *   - other values set by rte_mempool_create().
+ */
+struct rte_mempool * __rte_experimental
+rte_event_vector_pool_create(const char *name, unsigned int n,
+			     unsigned int cache_size, uint16_t nb_elem,
+			     int socket_id);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,6 +31,7 @@
 #include <rte_hexdump.h>
 #include <rte_errno.h>
 #include <rte_memcpy.h>
+#include <rte_vect.h>
 
 /*
  * pktmbuf pool constructor, given as a callback function to
@@ -167,6 +168,256 @@ rte_pktmbuf_pool_create(const char *name, unsigned int n,
 			data_room_size, socket_id, NULL);
 }
 
+/* build a chain of nb_segs segments for a packet of pkt_len bytes */
+static inline struct rte_mbuf *
+pktmbuf_chain_build(struct rte_mbuf **segs, unsigned int nb_segs,
+	uint32_t pkt_len)
+{
+	struct rte_mbuf *m;
+	uint32_t remain = pkt_len;
+	uint16_t seg_len;
+	unsigned int i;
+
+	for (i = 0; i < nb_segs; i++) {
+		m = segs[i];
+		if (i + 1 < nb_segs)
+			rte_prefetch0(segs[i + 1]);
+
+		MBUF_RAW_ALLOC_CHECK(m);
+		rte_pktmbuf_reset(m);
+
+		seg_len = (uint16_t)RTE_MIN(remain,
+			(uint32_t)rte_pktmbuf_tailroom(m));
+		m->data_len = seg_len;
+		remain -= seg_len;
+		if (i + 1 < nb_segs)
+			m->next = segs[i + 1];
+	}
+
+	m = segs[0];
+	m->nb_segs = (uint16_t)nb_segs;
+	m->pkt_len = pkt_len;
+
+	return m;
+}
+
+/* allocate chained packet mbufs of a given length */
+int __rte_experimental
+rte_pktmbuf_alloc_chain_bulk(struct rte_mempool *mp, struct rte_mbuf **pkts,
+	unsigned int count, uint32_t pkt_len)
+{
+	struct rte_mbuf *segs[RTE_PKTMBUF_CHAIN_BULK_MAX];
+	uint16_t room, seg_room;
+	unsigned int nb_segs, pkts_per_get, done, n, i;
+	int ret;
+
+	room = rte_pktmbuf_data_room_size(mp);
+	seg_room = room - RTE_MIN((uint16_t)RTE_PKTMBUF_HEADROOM, room);
+	if (seg_room == 0)
+		return -EINVAL;
+
+	/* reject lengths a chain cannot hold before rounding up */
+	if (pkt_len > (uint32_t)seg_room * RTE_PKTMBUF_CHAIN_BULK_MAX)
+		return -EINVAL;
+
+	nb_segs = ((uint64_t)pkt_len + seg_room - 1) / seg_room;
+	if (nb_segs == 0)
+		nb_segs = 1;
+
+	/* get the segments of as many packets as possible at once */
+	pkts_per_get = RTE_PKTMBUF_CHAIN_BULK_MAX / nb_segs;
+
+	for (done = 0; done < count; done += n) {
+		n = RTE_MIN(pkts_per_get, count - done);
+
+		ret = rte_mempool_get_bulk(mp, (void **)segs, n * nb_segs);
+		if (unlikely(ret != 0)) {
+			rte_pktmbuf_free_chain_bulk(pkts, done);
+			return -ENOENT;
+		}
+
+		for (i = 0; i < n; i++)
+			pkts[done + i] = pktmbuf_chain_build(&segs[i * nb_segs],
+					nb_segs, pkt_len);
+	}
+
+	return 0;
+}
+
+/* allocate a chained packet mbuf of a given length */
+struct rte_mbuf * __rte_experimental
+rte_pktmbuf_alloc_chain(struct rte_mempool *mp, uint32_t pkt_len)
+{
+	struct rte_mbuf *m;
+
+	if (rte_pktmbuf_alloc_chain_bulk(mp, &m, 1, pkt_len) != 0)
+		return NULL;
+	return m;
+}
+
+/* free chained packet mbufs */
+void __rte_experimental
+rte_pktmbuf_free_chain_bulk(struct rte_mbuf **pkts, unsigned int count)
+{
+	rte_pktmbuf_free_bulk(pkts, count);
+}
+
+/* number of pools for which freed mbufs are accumulated at the same time */
+#define MBUF_FREE_BULK_POOLS 4
+
+/* mbufs pending to be put back in a pool */
+struct mbuf_free_bulk_cache {
+	struct rte_mempool *pool;
+	unsigned int n;
+	void *objs[RTE_PKTMBUF_CHAIN_BULK_MAX];
+};
+
+/* add a mbuf ready to be recycled to the cache of its pool */
+static inline void
+mbuf_free_bulk_cache_add(struct mbuf_free_bulk_cache *caches,
+	unsigned int *nb_caches, struct rte_mbuf *m)
+{
+	struct mbuf_free_bulk_cache *c;
+	unsigned int i;
+
+	for (i = 0; i < *nb_caches; i++) {
+		if (caches[i].pool == m->pool)
+			break;
+	}
+
+	c = &caches[i];
+	if (unlikely(i == *nb_caches)) {
+		if (*nb_caches < MBUF_FREE_BULK_POOLS) {
+			(*nb_caches)++;
+		} else {
+			/* too many pools, recycle the last cache */
+			c = &caches[MBUF_FREE_BULK_POOLS - 1];
+			rte_mempool_put_bulk(c->pool, c->objs, c->n);
+		}
+		c->pool = m->pool;
+		c->n = 0;
+	} else if (unlikely(c->n == RTE_DIM(c->objs))) {
+		rte_mempool_put_bulk(c->pool, c->objs, c->n);
+		c->n = 0;
+	}
+
+	c->objs[c->n++] = m;
+}
+
+/* free all the segments of a packet through rte_pktmbuf_prefree_seg() */
+static inline void
+mbuf_free_bulk_slow(struct mbuf_free_bulk_cache *caches,
+	unsigned int *nb_caches, struct rte_mbuf *m)
+{
+	struct rte_mbuf *m_next;
+
+	__rte_mbuf_sanity_check(m, 1);
+
+	for (; m != NULL; m = m_next) {
+		m_next = m->next;
+		m = rte_pktmbuf_prefree_seg(m);
+		if (likely(m != NULL))
+			mbuf_free_bulk_cache_add(caches, nb_caches, m);
+	}
+}
+
+/*
+ * Mask and expected value of the 16 bytes starting at rearm_data, for an
+ * mbuf that can be put back in its pool without any other processing:
+ * refcnt is 1, only one segment, direct and no external buffer.
+ */
+#define MBUF_FAST_FREE_MASK_LO  0x0000ffffffff0000ULL
+#define MBUF_FAST_FREE_VALUE_LO 0x0000000100010000ULL
+#define MBUF_FAST_FREE_MASK_HI  (IND_ATTACHED_MBUF | EXT_ATTACHED_MBUF)
+#define MBUF_FAST_FREE_VALUE_HI 0ULL
+
+#if defined(RTE_ARCH_X86)
+/* check 4 mbufs at once, return non-zero if all of them are simple */
+static inline int
+mbuf_free_bulk_fast_x4(struct rte_mbuf **m)
+{
+	const __m128i mask = _mm_set_epi64x(MBUF_FAST_FREE_MASK_HI,
+		MBUF_FAST_FREE_MASK_LO);
+	const __m128i value = _mm_set_epi64x(MBUF_FAST_FREE_VALUE_HI,
+		MBUF_FAST_FREE_VALUE_LO);
+	__m128i v0, v1, v2, v3;
+
+	v0 = _mm_loadu_si128((const __m128i *)&m[0]->rearm_data);
+	v1 = _mm_loadu_si128((const __m128i *)&m[1]->rearm_data);
+	v2 = _mm_loadu_si128((const __m128i *)&m[2]->rearm_data);
+	v3 = _mm_loadu_si128((const __m128i *)&m[3]->rearm_data);
+
+	v0 = _mm_cmpeq_epi32(_mm_and_si128(v0, mask), value);
+	v1 = _mm_cmpeq_epi32(_mm_and_si128(v1, mask), value);
+	v2 = _mm_cmpeq_epi32(_mm_and_si128(v2, mask), value);
+	v3 = _mm_cmpeq_epi32(_mm_and_si128(v3, mask), value);
+
+	v0 = _mm_and_si128(_mm_and_si128(v0, v1), _mm_and_si128(v2, v3));
+
+	return _mm_movemask_epi8(v0) == 0xffff;
+}
+#else
+static inline int
+mbuf_free_bulk_fast_x4(struct rte_mbuf **m)
+{
+	unsigned int i;
+
+	for (i = 0; i < 4; i++) {
+		if (rte_mbuf_refcnt_read(m[i]) != 1 || m[i]->nb_segs != 1 ||
+				(m[i]->ol_flags & MBUF_FAST_FREE_MASK_HI) != 0)
+			return 0;
+	}
+
+	return 1;
+}
+#endif
+
+/* free packet mbufs, one mempool put per pool */
+void __rte_experimental
+rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned int count)
+{
+	struct mbuf_free_bulk_cache caches[MBUF_FREE_BULK_POOLS];
+	unsigned int nb_caches = 0;
+	unsigned int i, j;
+
+	/* the fast check loads rearm_data and ol_flags at once */
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, ol_flags) !=
+		offsetof(struct rte_mbuf, rearm_data) + 8);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, refcnt) !=
+		offsetof(struct rte_mbuf, rearm_data) + 2);
+	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, nb_segs) !=
+		offsetof(struct rte_mbuf, rearm_data) + 4);
+
+	for (i = 0; i + 4 <= count; i += 4) {
+		if (mbufs[i] == NULL || mbufs[i + 1] == NULL ||
+				mbufs[i + 2] == NULL || mbufs[i + 3] == NULL)
+			break;
+
+		if (likely(mbuf_free_bulk_fast_x4(&mbufs[i]))) {
+			for (j = i; j < i + 4; j++) {
+				__rte_mbuf_sanity_check(mbufs[j], 1);
+				mbuf_free_bulk_cache_add(caches, &nb_caches,
+					mbufs[j]);
+			}
+		} else {
+			for (j = i; j < i + 4; j++)
+				mbuf_free_bulk_slow(caches, &nb_caches,
+					mbufs[j]);
+		}
+	}
+
+	for (; i < count; i++) {
+		if (mbufs[i] != NULL)
+			mbuf_free_bulk_slow(caches, &nb_caches, mbufs[i]);
+	}
+
+	for (j = 0; j < nb_caches; j++) {
+		if (caches[j].n != 0)
+			rte_mempool_put_bulk(caches[j].pool, caches[j].objs,
+				caches[j].n);
+	}
+}
+
 /* do some sanity checks on a mbuf: panic if it fails */
 void
 rte_mbuf_sanity_check(const struct rte_mbuf *m, int is_header)
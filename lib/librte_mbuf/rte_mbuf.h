@@ -41,6 +41,7 @@
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
 #include <rte_mbuf_ptype.h>
+#include <rte_mbuf_dyn.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -197,9 +198,12 @@ extern "C" {
 #define PKT_RX_OUTER_L4_CKSUM_GOOD	(1ULL << 22)
 #define PKT_RX_OUTER_L4_CKSUM_INVALID	((1ULL << 21) | (1ULL << 22))
 
-/* add new RX flags here */
+/* add new RX flags here, don't forget to update PKT_FIRST_FREE */
 
-/* add new TX flags here */
+#define PKT_FIRST_FREE (1ULL << 23)
+#define PKT_LAST_FREE (1ULL << 40)
+
+/* add new TX flags here, don't forget to update PKT_LAST_FREE */
 
 /**
  * Outer UDP checksum offload flag. This flag is used for enabling
@@ -635,6 +639,9 @@ struct rte_mbuf {
 	 */
 	struct rte_mbuf_ext_shared_info *shinfo;
 
+	/** Reserved for dynamic fields. See rte_mbuf_dynfield_register(). */
+	uint64_t dynfield1[2];
+
 } __rte_cache_aligned;
 
 /**
@@ -1363,6 +1370,66 @@ static inline int rte_pktmbuf_alloc_bulk(struct rte_mempool *pool,
 	return 0;
 }
 
+/**
+ * Maximum number of segments handled in one mempool operation by
+ * rte_pktmbuf_alloc_chain_bulk() and rte_pktmbuf_free_chain_bulk(). It is
+ * also the maximum number of segments of a packet allocated by
+ * rte_pktmbuf_alloc_chain_bulk().
+ */
+#define RTE_PKTMBUF_CHAIN_BULK_MAX 64
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Allocate a bulk of chained packet mbufs able to store pkt_len bytes.
+ *
+ * The number of segments of each packet is the minimum required to store
+ * pkt_len bytes, keeping the default headroom in each segment. The
+ * segments of several packets are retrieved from the mempool at once,
+ * then their fields are reset to default values and they are linked
+ * together. On return, pkt_len, nb_segs and the data_len of each segment
+ * are set, so that the packet data only has to be written: this is
+ * intended for builders of multi-segment packets (GSO, IP fragmentation,
+ * packet copies).
+ *
+ * @param mp
+ *   The mempool from which segments are allocated.
+ * @param pkts
+ *   Array of pointers filled with the first segment of each packet.
+ * @param count
+ *   Number of packets to allocate.
+ * @param pkt_len
+ *   Length of each packet.
+ * @return
+ *   - 0: Success
+ *   - -EINVAL: pkt_len requires more than RTE_PKTMBUF_CHAIN_BULK_MAX
+ *     segments, or the mbufs of the pool have no data room.
+ *   - -ENOENT: Not enough entries in the mempool; no mbufs are retrieved.
+ */
+int __rte_experimental
+rte_pktmbuf_alloc_chain_bulk(struct rte_mempool *mp, struct rte_mbuf **pkts,
+	unsigned int count, uint32_t pkt_len);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Allocate a chained packet mbuf able to store pkt_len bytes.
+ *
+ * See rte_pktmbuf_alloc_chain_bulk().
+ *
+ * @param mp
+ *   The mempool from which segments are allocated.
+ * @param pkt_len
+ *   Length of the packet.
+ * @return
+ *   - The pointer to the first segment of the packet on success.
+ *   - NULL if allocation failed.
+ */
+struct rte_mbuf * __rte_experimental
+rte_pktmbuf_alloc_chain(struct rte_mempool *mp, uint32_t pkt_len);
+
 /**
  * Initialize shared data at the end of an external buffer before attaching
  * to a mbuf by ``rte_pktmbuf_attach_extbuf()``. This is not a mandatory
@@ -1732,6 +1799,47 @@ static inline void rte_pktmbuf_free(struct rte_mbuf *m)
 	}
 }
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Free a bulk of packet mbufs back into their original mempool.
+ *
+ * Free each mbuf and all its segments in case of chained buffers, like
+ * rte_pktmbuf_free(). The segments that can be recycled are grouped by
+ * pool, and put back in their mempool with one rte_mempool_put_bulk() per
+ * pool instead of one put per segment.
+ *
+ * The common case (direct mbuf, no external buffer, refcnt is 1 and only
+ * one segment) is detected on several mbufs at once, and skips the
+ * processing done by rte_pktmbuf_prefree_seg(). Other mbufs are freed
+ * through rte_pktmbuf_prefree_seg().
+ *
+ * @param mbufs
+ *   Array of packet mbufs to be freed. NULL entries are ignored.
+ * @param count
+ *   Array size.
+ */
+void __rte_experimental
+rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned int count);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Free a bulk of chained packet mbufs back into their original mempool.
+ *
+ * This is the counterpart of rte_pktmbuf_alloc_chain_bulk(), it behaves
+ * like rte_pktmbuf_free_bulk().
+ *
+ * @param pkts
+ *   Array of packet mbufs to be freed. NULL entries are ignored.
+ * @param count
+ *   Array size.
+ */
+void __rte_experimental
+rte_pktmbuf_free_chain_bulk(struct rte_mbuf **pkts, unsigned int count);
+
 /**
  * Creates a "clone" of the given packet mbuf.
  *
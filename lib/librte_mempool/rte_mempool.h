@@ -477,11 +477,9 @@ typedef ssize_t (*rte_mempool_calc_mem_size_t)(const struct rte_mempool *mp,
  * that pages are grouped in subsets of physically continuous pages big
  * enough to store at least one object.
  *
- * Minimum size of memory chunk is a maximum of the page size and total
- * element size.
+ * Minimum size of memory chunk is the total element size.
  *
- * Required memory chunk alignment is a maximum of page size and cache
- * line size.
+ * Required memory chunk alignment is the cache line size.
  */
 ssize_t rte_mempool_op_calc_mem_size_default(const struct rte_mempool *mp,
 		uint32_t obj_num, uint32_t pg_shift,
@@ -512,6 +510,10 @@ typedef void (rte_mempool_populate_obj_cb_t)(struct rte_mempool *mp,
  * the chunk doesn't need to be physically contiguous (only virtually),
  * and allocated objects may span two pages.
  *
+ * The default implementation never places an object across a boundary
+ * of the page size returned by rte_mempool_get_page_size(), unless the
+ * object is bigger than a page.
+ *
  * @param[in] mp
  *   A pointer to the mempool structure.
  * @param[in] max_objs
@@ -536,8 +538,56 @@ typedef int (*rte_mempool_populate_t)(struct rte_mempool *mp,
 		rte_mempool_populate_obj_cb_t *obj_cb, void *obj_cb_arg);
 
 /**
- * Default way to populate memory pool object using provided memory
- * chunk: just slice objects one by one.
+ * Align objects on addresses multiple of total_elt_sz.
+ */
+#define RTE_MEMPOOL_POPULATE_F_ALIGN_OBJ 0x0001
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Helper to populate memory pool object using provided memory
+ * chunk: just slice objects one by one, taking care of not
+ * crossing page boundaries.
+ *
+ * If RTE_MEMPOOL_POPULATE_F_ALIGN_OBJ is set in flags, the addresses
+ * of object headers will be aligned on a multiple of total_elt_sz.
+ * This feature is used by octeontx hardware.
+ *
+ * This function is internal to mempool library and mempool drivers.
+ *
+ * @param[in] mp
+ *   A pointer to the mempool structure.
+ * @param[in] flags
+ *   Logical OR of following flags:
+ *   - RTE_MEMPOOL_POPULATE_F_ALIGN_OBJ: align objects on addresses
+ *     multiple of total_elt_sz.
+ * @param[in] max_objs
+ *   Maximum number of objects to be added in mempool.
+ * @param[in] vaddr
+ *   The virtual address of memory that should be used to store objects.
+ * @param[in] iova
+ *   The IO address corresponding to vaddr, or RTE_BAD_IOVA.
+ * @param[in] len
+ *   The length of memory in bytes.
+ * @param[in] obj_cb
+ *   Callback function to be executed for each populated object.
+ * @param[in] obj_cb_arg
+ *   An opaque pointer passed to the callback function.
+ * @return
+ *   The number of objects added in mempool.
+ */
+int __rte_experimental
+rte_mempool_op_populate_helper(struct rte_mempool *mp, unsigned int flags,
+		unsigned int max_objs, void *vaddr, rte_iova_t iova,
+		size_t len, rte_mempool_populate_obj_cb_t *obj_cb,
+		void *obj_cb_arg);
+
+/**
+ * Default way to populate memory pool object using provided memory chunk.
+ *
+ * Equivalent to rte_mempool_op_populate_helper(mp, 0, max_objs, vaddr, iova,
+ * len, obj_cb, obj_cb_arg).
  */
 int rte_mempool_op_populate_default(struct rte_mempool *mp,
 		unsigned int max_objs,
@@ -1043,9 +1093,8 @@ int rte_mempool_populate_iova(struct rte_mempool *mp, char *vaddr,
  *   A pointer to the mempool structure.
  * @param addr
  *   The virtual address of memory that should be used to store objects.
- *   Must be page-aligned.
  * @param len
- *   The length of memory in bytes. Must be page-aligned.
+ *   The length of memory in bytes.
  * @param pg_sz
  *   The size of memory pages in this virtual area.
  * @param free_cb
@@ -1092,6 +1141,27 @@ int rte_mempool_populate_default(struct rte_mempool *mp);
  */
 int rte_mempool_populate_anon(struct rte_mempool *mp);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the page size used by the mempool to place its objects.
+ *
+ * The populate functions do not place an object across a boundary of
+ * this page size, unless the object is bigger than a page. This is the
+ * smallest page size of the memory the mempool is allocated from, or 0
+ * if the mempool does not require IOVA-contiguous objects.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param pg_sz
+ *   Pointer to the returned page size.
+ * @return
+ *   0 on success, or -EINVAL if the mempool socket is invalid.
+ */
+int __rte_experimental
+rte_mempool_get_page_size(struct rte_mempool *mp, size_t *pg_sz);
+
 /**
  * Call a function for each mempool element
  *
@@ -9,6 +9,11 @@
 #include <rte_common.h>
 #include <rte_log.h>
 #include <rte_cycles.h>
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+#if defined(RTE_ARCH_X86)
+#include <rte_vect.h>
+#endif
 
 #include "rte_meter.h"
 
@@ -16,10 +21,26 @@
 #define RTE_METER_TB_PERIOD_MIN      100
 #endif
 
+/* Number of packets between the packet whose meter is prefetched and the
+ * packet being metered in the bulk functions.
+ */
+#ifndef RTE_METER_BULK_PREFETCH_OFFSET
+#define RTE_METER_BULK_PREFETCH_OFFSET 8
+#endif
+
 static void
 rte_meter_get_tb_params(uint64_t hz, uint64_t rate, uint64_t *tb_period, uint64_t *tb_bytes_per_period)
 {
-	double period = ((double) hz) / ((double) rate);
+	double period;
+
+	/* Disabled token bucket: never gets any token */
+	if (rate == 0) {
+		*tb_bytes_per_period = 0;
+		*tb_period = RTE_METER_TB_PERIOD_MIN;
+		return;
+	}
+
+	period = ((double) hz) / ((double) rate);
 
 	if (period >= RTE_METER_TB_PERIOD_MIN) {
 		*tb_bytes_per_period = 1;
@@ -110,3 +131,340 @@ rte_meter_trtcm_config(struct rte_meter_trtcm *m,
 
 	return 0;
 }
+
+int __rte_experimental
+rte_meter_trtcm_rfc4115_profile_config(
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	struct rte_meter_trtcm_rfc4115_params *params)
+{
+	uint64_t hz = rte_get_tsc_hz();
+
+	/* Check input parameters */
+	if ((p == NULL) ||
+		(params == NULL) ||
+		((params->cir == 0) && (params->eir == 0)) ||
+		((params->cir != 0) && (params->cbs == 0)) ||
+		((params->eir != 0) && (params->ebs == 0)))
+		return -EINVAL;
+
+	/* Initialize RFC 4115 trTCM run-time structure */
+	p->cbs = params->cbs;
+	p->ebs = params->ebs;
+	rte_meter_get_tb_params(hz, params->cir, &p->cir_period,
+		&p->cir_bytes_per_period);
+	rte_meter_get_tb_params(hz, params->eir, &p->eir_period,
+		&p->eir_bytes_per_period);
+
+	return 0;
+}
+
+int __rte_experimental
+rte_meter_trtcm_rfc4115_config(struct rte_meter_trtcm_rfc4115 *m,
+	struct rte_meter_trtcm_rfc4115_profile *p)
+{
+	/* Check input parameters */
+	if ((m == NULL) || (p == NULL))
+		return -EINVAL;
+
+	/* Initialize RFC 4115 trTCM run-time structure */
+	m->time_tc = m->time_te = rte_get_tsc_cycles();
+	m->tc = p->cbs;
+	m->te = p->ebs;
+
+	return 0;
+}
+
+/*
+ * Bulk metering
+ *
+ * The run-time cost of the single packet functions is dominated by the 64-bit
+ * divisions computing the number of token bucket update periods elapsed since
+ * the last update. As all the meters of a bulk call share the same profile, the
+ * bulk functions compute the inverse of each update period once per call and
+ * replace the divisions by a floating point multiplication, followed by a
+ * fix-up of the rounding error that makes the result exactly the same as the
+ * one of the integer division.
+ *
+ * The burst is processed in groups of 4 packets. When the 4 packets of a group
+ * hit 4 different meter objects, the 4 meter states are copied to local
+ * storage, updated independently of each other and written back, which lets
+ * the compiler and the CPU overlap the 4 token bucket updates. When some
+ * packets of the group share a meter object, the group is metered one packet
+ * at a time, in burst order, directly on the meter objects.
+ *
+ * The meter object of each packet is prefetched
+ * RTE_METER_BULK_PREFETCH_OFFSET packets in advance.
+ */
+
+/* Time differences up to this value are exactly represented as double */
+#define RTE_METER_BULK_TIME_DIFF_MAX (1LLU << 52)
+
+/* Number of update periods elapsed in time_diff, i.e. time_diff / period */
+static __rte_always_inline uint64_t
+rte_meter_bulk_n_periods(uint64_t time_diff, uint64_t period,
+	double period_inv)
+{
+	uint64_t n_periods;
+
+	if (unlikely(time_diff >= RTE_METER_BULK_TIME_DIFF_MAX))
+		return time_diff / period;
+
+	/* The estimate is off by at most one period */
+	n_periods = (uint64_t)((double)time_diff * period_inv);
+	if (n_periods * period > time_diff)
+		n_periods--;
+	else if ((n_periods + 1) * period <= time_diff)
+		n_periods++;
+
+	return n_periods;
+}
+
+/* Returns non-zero when the 4 meter indices are pairwise different */
+static inline int
+rte_meter_bulk_ids_distinct4(const uint32_t *id)
+{
+#if defined(RTE_ARCH_X86)
+	__m128i v, v_rot1, v_rot2, eq;
+
+	/* Comparing the vector with itself rotated by one and by two lanes
+	 * covers all the 6 lane pairs.
+	 */
+	v = _mm_loadu_si128((const __m128i *)id);
+	v_rot1 = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 3, 2, 1));
+	v_rot2 = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+	eq = _mm_or_si128(_mm_cmpeq_epi32(v, v_rot1),
+		_mm_cmpeq_epi32(v, v_rot2));
+
+	return _mm_movemask_epi8(eq) == 0;
+#else
+	return (id[0] != id[1]) && (id[0] != id[2]) && (id[0] != id[3]) &&
+		(id[1] != id[2]) && (id[1] != id[3]) && (id[2] != id[3]);
+#endif
+}
+
+/*
+ * Per packet metering for the bulk functions. Same as the color aware single
+ * packet functions, with the color blind mode being the color aware mode with
+ * green input color. The output color is computed without branches, as the
+ * colors of consecutive packets of a burst hitting different flows are not
+ * predictable.
+ */
+static __rte_always_inline enum rte_meter_color
+rte_meter_srtcm_bulk_check(struct rte_meter_srtcm *m,
+	struct rte_meter_srtcm_profile *p,
+	const double *period_inv,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color)
+{
+	uint64_t n_periods, tc, te, green, yellow;
+
+	/* Bucket update */
+	n_periods = rte_meter_bulk_n_periods(time - m->time, p->cir_period,
+		period_inv[0]);
+	m->time += n_periods * p->cir_period;
+
+	/* Put the tokens overflowing from tc into te bucket */
+	tc = m->tc + n_periods * p->cir_bytes_per_period;
+	te = m->te;
+	if (tc > p->cbs) {
+		te += (tc - p->cbs);
+		if (te > p->ebs)
+			te = p->ebs;
+		tc = p->cbs;
+	}
+
+	/* Color logic */
+	green = (pkt_color == e_RTE_METER_GREEN) & (tc >= pkt_len);
+	yellow = (green ^ 1) & (pkt_color != e_RTE_METER_RED) &
+		(te >= pkt_len);
+
+	m->tc = tc - (pkt_len & -green);
+	m->te = te - (pkt_len & -yellow);
+	return (enum rte_meter_color)(e_RTE_METER_RED - 2 * green - yellow);
+}
+
+static __rte_always_inline enum rte_meter_color
+rte_meter_trtcm_bulk_check(struct rte_meter_trtcm *m,
+	struct rte_meter_trtcm_profile *p,
+	const double *period_inv,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color)
+{
+	uint64_t n_periods_tc, n_periods_tp, tc, tp, red, green;
+
+	/* Bucket update */
+	n_periods_tc = rte_meter_bulk_n_periods(time - m->time_tc,
+		p->cir_period, period_inv[0]);
+	n_periods_tp = rte_meter_bulk_n_periods(time - m->time_tp,
+		p->pir_period, period_inv[1]);
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_tp += n_periods_tp * p->pir_period;
+
+	tc = m->tc + n_periods_tc * p->cir_bytes_per_period;
+	if (tc > p->cbs)
+		tc = p->cbs;
+
+	tp = m->tp + n_periods_tp * p->pir_bytes_per_period;
+	if (tp > p->pbs)
+		tp = p->pbs;
+
+	/* Color logic */
+	red = (pkt_color == e_RTE_METER_RED) | (tp < pkt_len);
+	green = (red ^ 1) & (pkt_color == e_RTE_METER_GREEN) &
+		(tc >= pkt_len);
+
+	m->tc = tc - (pkt_len & -green);
+	m->tp = tp - (pkt_len & (red - 1));
+	return (enum rte_meter_color)(e_RTE_METER_YELLOW + red - green);
+}
+
+static __rte_always_inline enum rte_meter_color
+rte_meter_trtcm_rfc4115_bulk_check(struct rte_meter_trtcm_rfc4115 *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	const double *period_inv,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color)
+{
+	uint64_t n_periods_tc, n_periods_te, tc, te, green, yellow;
+
+	/* Bucket update */
+	n_periods_tc = rte_meter_bulk_n_periods(time - m->time_tc,
+		p->cir_period, period_inv[0]);
+	n_periods_te = rte_meter_bulk_n_periods(time - m->time_te,
+		p->eir_period, period_inv[1]);
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_te += n_periods_te * p->eir_period;
+
+	tc = m->tc + n_periods_tc * p->cir_bytes_per_period;
+	if (tc > p->cbs)
+		tc = p->cbs;
+
+	te = m->te + n_periods_te * p->eir_bytes_per_period;
+	if (te > p->ebs)
+		te = p->ebs;
+
+	/* Color logic */
+	green = (pkt_color == e_RTE_METER_GREEN) & (tc >= pkt_len);
+	yellow = (green ^ 1) & (pkt_color != e_RTE_METER_RED) &
+		(te >= pkt_len);
+
+	m->tc = tc - (pkt_len & -green);
+	m->te = te - (pkt_len & -yellow);
+	return (enum rte_meter_color)(e_RTE_METER_RED - 2 * green - yellow);
+}
+
+#define RTE_METER_BULK_PKT_COLOR(pkt_color, i)				\
+	(((pkt_color) != NULL) ? (pkt_color)[i] : e_RTE_METER_GREEN)
+
+#define RTE_METER_BULK_PREFETCH(m, meter_id, i, n_pkts)			\
+do {									\
+	if ((i) < (n_pkts))						\
+		rte_prefetch0(&(m)[(meter_id)[i]]);			\
+} while (0)
+
+#define RTE_METER_BULK_CHECK(m, p, period_inv, time, meter_id, pkt_len,	\
+	pkt_color, color, n_pkts, meter_type, check)			\
+do {									\
+	meter_type s[4];						\
+	uint32_t i, j;							\
+									\
+	for (i = 0; i < RTE_METER_BULK_PREFETCH_OFFSET; i++)		\
+		RTE_METER_BULK_PREFETCH(m, meter_id, i, n_pkts);	\
+									\
+	for (i = 0; i + 4 <= (n_pkts); i += 4) {			\
+		for (j = 0; j < 4; j++)					\
+			RTE_METER_BULK_PREFETCH(m, meter_id,		\
+				i + j + RTE_METER_BULK_PREFETCH_OFFSET,	\
+				n_pkts);				\
+									\
+		if (unlikely(!rte_meter_bulk_ids_distinct4(		\
+			&(meter_id)[i]))) {				\
+			for (j = i; j < i + 4; j++)			\
+				(color)[j] = check(&(m)[(meter_id)[j]],	\
+					p, period_inv, time,		\
+					(pkt_len)[j],			\
+					RTE_METER_BULK_PKT_COLOR(	\
+						pkt_color, j));		\
+			continue;					\
+		}							\
+									\
+		for (j = 0; j < 4; j++)					\
+			s[j] = (m)[(meter_id)[i + j]];			\
+									\
+		for (j = 0; j < 4; j++)					\
+			(color)[i + j] = check(&s[j], p, period_inv,	\
+				time, (pkt_len)[i + j],			\
+				RTE_METER_BULK_PKT_COLOR(pkt_color,	\
+					i + j));			\
+									\
+		for (j = 0; j < 4; j++)					\
+			(m)[(meter_id)[i + j]] = s[j];			\
+	}								\
+									\
+	for ( ; i < (n_pkts); i++)					\
+		(color)[i] = check(&(m)[(meter_id)[i]], p, period_inv,	\
+			time, (pkt_len)[i],				\
+			RTE_METER_BULK_PKT_COLOR(pkt_color, i));	\
+} while (0)
+
+void __rte_experimental
+rte_meter_srtcm_color_check_bulk(struct rte_meter_srtcm *m,
+	struct rte_meter_srtcm_profile *p,
+	uint64_t time,
+	const uint32_t *meter_id,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	double period_inv[1];
+
+	period_inv[0] = 1.0 / (double)p->cir_period;
+
+	RTE_METER_BULK_CHECK(m, p, period_inv, time, meter_id, pkt_len,
+		pkt_color, color, n_pkts, struct rte_meter_srtcm,
+		rte_meter_srtcm_bulk_check);
+}
+
+void __rte_experimental
+rte_meter_trtcm_color_check_bulk(struct rte_meter_trtcm *m,
+	struct rte_meter_trtcm_profile *p,
+	uint64_t time,
+	const uint32_t *meter_id,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	double period_inv[2];
+
+	period_inv[0] = 1.0 / (double)p->cir_period;
+	period_inv[1] = 1.0 / (double)p->pir_period;
+
+	RTE_METER_BULK_CHECK(m, p, period_inv, time, meter_id, pkt_len,
+		pkt_color, color, n_pkts, struct rte_meter_trtcm,
+		rte_meter_trtcm_bulk_check);
+}
+
+void __rte_experimental
+rte_meter_trtcm_rfc4115_color_check_bulk(struct rte_meter_trtcm_rfc4115 *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	const uint32_t *meter_id,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts)
+{
+	double period_inv[2];
+
+	period_inv[0] = 1.0 / (double)p->cir_period;
+	period_inv[1] = 1.0 / (double)p->eir_period;
+
+	RTE_METER_BULK_CHECK(m, p, period_inv, time, meter_id, pkt_len,
+		pkt_color, color, n_pkts, struct rte_meter_trtcm_rfc4115,
+		rte_meter_trtcm_rfc4115_bulk_check);
+}
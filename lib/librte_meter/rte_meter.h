@@ -16,11 +16,14 @@ extern "C" {
  * Traffic metering algorithms:
  *    1. Single Rate Three Color Marker (srTCM): defined by IETF RFC 2697
  *    2. Two Rate Three Color Marker (trTCM): defined by IETF RFC 2698
+ *    3. Two Rate Three Color Marker (trTCM): defined by IETF RFC 4115
  *
  ***/
 
 #include <stdint.h>
 
+#include <rte_compat.h>
+
 /*
  * Application Programmer's Interface (API)
  *
@@ -53,6 +56,23 @@ struct rte_meter_trtcm_params {
 	uint64_t pbs; /**< Peak Burst Size (PBS). Measured in bytes. */
 };
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM parameters per metered traffic flow. The CIR, EIR, CBS and
+ * EBS parameters only count bytes of IP packets and do not include link
+ * specific headers. Unlike RFC 2698, the excess rate is not required to be
+ * greater than or equal to the committed rate. Either of the two token buckets
+ * can be disabled by setting both its rate and its burst size to zero.
+ */
+struct rte_meter_trtcm_rfc4115_params {
+	uint64_t cir; /**< Committed Information Rate (CIR). Measured in bytes per second. */
+	uint64_t eir; /**< Excess Information Rate (EIR). Measured in bytes per second. */
+	uint64_t cbs; /**< Committed Burst Size (CBS). Measured in bytes. */
+	uint64_t ebs; /**< Excess Burst Size (EBS). Measured in bytes. */
+};
+
 /**
  * Internal data structure storing the srTCM configuration profile. Typically
  * shared by multiple srTCM objects.
@@ -65,12 +85,24 @@ struct rte_meter_srtcm_profile;
  */
 struct rte_meter_trtcm_profile;
 
+/**
+ * Internal data structure storing the RFC 4115 trTCM configuration profile.
+ * Typically shared by multiple RFC 4115 trTCM objects.
+ */
+struct rte_meter_trtcm_rfc4115_profile;
+
 /** Internal data structure storing the srTCM run-time context per metered traffic flow. */
 struct rte_meter_srtcm;
 
 /** Internal data structure storing the trTCM run-time context per metered traffic flow. */
 struct rte_meter_trtcm;
 
+/**
+ * Internal data structure storing the RFC 4115 trTCM run-time context per
+ * metered traffic flow.
+ */
+struct rte_meter_trtcm_rfc4115;
+
 /**
  * srTCM profile configuration
  *
@@ -99,6 +131,24 @@ int
 rte_meter_trtcm_profile_config(struct rte_meter_trtcm_profile *p,
 	struct rte_meter_trtcm_params *params);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM profile configuration
+ *
+ * @param p
+ *    Pointer to pre-allocated RFC 4115 trTCM profile data structure
+ * @param params
+ *    RFC 4115 trTCM profile parameters
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int __rte_experimental
+rte_meter_trtcm_rfc4115_profile_config(
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	struct rte_meter_trtcm_rfc4115_params *params);
+
 /**
  * srTCM configuration per metered traffic flow
  *
@@ -127,6 +177,23 @@ int
 rte_meter_trtcm_config(struct rte_meter_trtcm *m,
 	struct rte_meter_trtcm_profile *p);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM configuration per metered traffic flow
+ *
+ * @param m
+ *    Pointer to pre-allocated RFC 4115 trTCM data structure
+ * @param p
+ *    RFC 4115 trTCM profile. Needs to be valid.
+ * @return
+ *    0 upon success, error code otherwise
+ */
+int __rte_experimental
+rte_meter_trtcm_rfc4115_config(struct rte_meter_trtcm_rfc4115 *m,
+	struct rte_meter_trtcm_rfc4115_profile *p);
+
 /**
  * srTCM color blind traffic metering
  *
@@ -213,6 +280,175 @@ rte_meter_trtcm_color_aware_check(struct rte_meter_trtcm *m,
 	uint32_t pkt_len,
 	enum rte_meter_color pkt_color);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM color blind traffic metering
+ *
+ * @param m
+ *    Handle to RFC 4115 trTCM instance
+ * @param p
+ *    RFC 4115 trTCM profile specified at RFC 4115 trTCM object creation time
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Length of the current IP packet (measured in bytes)
+ * @return
+ *    Color assigned to the current IP packet
+ */
+static inline enum rte_meter_color __rte_experimental
+rte_meter_trtcm_rfc4115_color_blind_check(
+	struct rte_meter_trtcm_rfc4115 *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	uint32_t pkt_len);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM color aware traffic metering
+ *
+ * @param m
+ *    Handle to RFC 4115 trTCM instance
+ * @param p
+ *    RFC 4115 trTCM profile specified at RFC 4115 trTCM object creation time
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param pkt_len
+ *    Length of the current IP packet (measured in bytes)
+ * @param pkt_color
+ *    Input color of the current IP packet
+ * @return
+ *    Color assigned to the current IP packet
+ */
+static inline enum rte_meter_color __rte_experimental
+rte_meter_trtcm_rfc4115_color_aware_check(
+	struct rte_meter_trtcm_rfc4115 *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color);
+
+/*
+ * Bulk metering
+ *
+ * The bulk functions meter a burst of packets against an array of meter
+ * objects sharing the same profile, e.g. all the subscriber flows of one
+ * service tier. Packet i is metered by meter object m[meter_id[i]]. Several
+ * packets of the burst may hit the same meter object, in which case they are
+ * metered in their order within the burst, so the output colors are always
+ * the same as the ones produced by calling the single packet functions above
+ * for each packet in turn.
+ *
+ * When pkt_color is NULL, the burst is metered in color blind mode, otherwise
+ * pkt_color[i] is the input color of packet i (color aware mode).
+ *
+ ***/
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * srTCM bulk traffic metering
+ *
+ * @param m
+ *    Array of srTCM instances
+ * @param p
+ *    srTCM profile shared by all the instances of array *m*
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param meter_id
+ *    Array of *n_pkts* indices into array *m*, one per packet
+ * @param pkt_len
+ *    Array of *n_pkts* IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of *n_pkts* input packet colors, or NULL for color blind mode
+ * @param color
+ *    Array of *n_pkts* entries, filled in with the color assigned to each
+ *    packet
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+void __rte_experimental
+rte_meter_srtcm_color_check_bulk(struct rte_meter_srtcm *m,
+	struct rte_meter_srtcm_profile *p,
+	uint64_t time,
+	const uint32_t *meter_id,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * trTCM bulk traffic metering
+ *
+ * @param m
+ *    Array of trTCM instances
+ * @param p
+ *    trTCM profile shared by all the instances of array *m*
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param meter_id
+ *    Array of *n_pkts* indices into array *m*, one per packet
+ * @param pkt_len
+ *    Array of *n_pkts* IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of *n_pkts* input packet colors, or NULL for color blind mode
+ * @param color
+ *    Array of *n_pkts* entries, filled in with the color assigned to each
+ *    packet
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+void __rte_experimental
+rte_meter_trtcm_color_check_bulk(struct rte_meter_trtcm *m,
+	struct rte_meter_trtcm_profile *p,
+	uint64_t time,
+	const uint32_t *meter_id,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * RFC 4115 trTCM bulk traffic metering
+ *
+ * @param m
+ *    Array of RFC 4115 trTCM instances
+ * @param p
+ *    RFC 4115 trTCM profile shared by all the instances of array *m*
+ * @param time
+ *    Current CPU time stamp (measured in CPU cycles)
+ * @param meter_id
+ *    Array of *n_pkts* indices into array *m*, one per packet
+ * @param pkt_len
+ *    Array of *n_pkts* IP packet lengths (measured in bytes)
+ * @param pkt_color
+ *    Array of *n_pkts* input packet colors, or NULL for color blind mode
+ * @param color
+ *    Array of *n_pkts* entries, filled in with the color assigned to each
+ *    packet
+ * @param n_pkts
+ *    Number of packets in the burst
+ */
+void __rte_experimental
+rte_meter_trtcm_rfc4115_color_check_bulk(struct rte_meter_trtcm_rfc4115 *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	const uint32_t *meter_id,
+	const uint32_t *pkt_len,
+	const enum rte_meter_color *pkt_color,
+	enum rte_meter_color *color,
+	uint32_t n_pkts);
+
 /*
  * Inline implementation of run-time methods
  *
@@ -266,6 +502,36 @@ struct rte_meter_trtcm {
 	/**< Number of bytes currently available in the peak(P) token bucket */
 };
 
+struct rte_meter_trtcm_rfc4115_profile {
+	uint64_t cbs;
+	/**< Upper limit for C token bucket */
+	uint64_t ebs;
+	/**< Upper limit for E token bucket */
+	uint64_t cir_period;
+	/**< Number of CPU cycles for one update of C token bucket */
+	uint64_t cir_bytes_per_period;
+	/**< Number of bytes to add to C token bucket on each update */
+	uint64_t eir_period;
+	/**< Number of CPU cycles for one update of E token bucket */
+	uint64_t eir_bytes_per_period;
+	/**< Number of bytes to add to E token bucket on each update */
+};
+
+/**
+ * Internal data structure storing the RFC 4115 trTCM run-time context per
+ * metered traffic flow.
+ */
+struct rte_meter_trtcm_rfc4115 {
+	uint64_t time_tc;
+	/**< Time of latest update of C token bucket */
+	uint64_t time_te;
+	/**< Time of latest update of E token bucket */
+	uint64_t tc;
+	/**< Number of bytes currently available in committed(C) token bucket */
+	uint64_t te;
+	/**< Number of bytes currently available in the excess(E) token bucket */
+};
+
 static inline enum rte_meter_color
 rte_meter_srtcm_color_blind_check(struct rte_meter_srtcm *m,
 	struct rte_meter_srtcm_profile *p,
@@ -434,6 +700,93 @@ rte_meter_trtcm_color_aware_check(struct rte_meter_trtcm *m,
 	return e_RTE_METER_GREEN;
 }
 
+static inline enum rte_meter_color __rte_experimental
+rte_meter_trtcm_rfc4115_color_blind_check(
+	struct rte_meter_trtcm_rfc4115 *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	uint32_t pkt_len)
+{
+	uint64_t time_diff_tc, time_diff_te, n_periods_tc, n_periods_te, tc, te;
+
+	/* Bucket update */
+	time_diff_tc = time - m->time_tc;
+	time_diff_te = time - m->time_te;
+	n_periods_tc = time_diff_tc / p->cir_period;
+	n_periods_te = time_diff_te / p->eir_period;
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_te += n_periods_te * p->eir_period;
+
+	tc = m->tc + n_periods_tc * p->cir_bytes_per_period;
+	if (tc > p->cbs)
+		tc = p->cbs;
+
+	te = m->te + n_periods_te * p->eir_bytes_per_period;
+	if (te > p->ebs)
+		te = p->ebs;
+
+	/* Color logic */
+	if (tc >= pkt_len) {
+		m->tc = tc - pkt_len;
+		m->te = te;
+		return e_RTE_METER_GREEN;
+	}
+
+	if (te >= pkt_len) {
+		m->tc = tc;
+		m->te = te - pkt_len;
+		return e_RTE_METER_YELLOW;
+	}
+
+	m->tc = tc;
+	m->te = te;
+	return e_RTE_METER_RED;
+}
+
+static inline enum rte_meter_color __rte_experimental
+rte_meter_trtcm_rfc4115_color_aware_check(
+	struct rte_meter_trtcm_rfc4115 *m,
+	struct rte_meter_trtcm_rfc4115_profile *p,
+	uint64_t time,
+	uint32_t pkt_len,
+	enum rte_meter_color pkt_color)
+{
+	uint64_t time_diff_tc, time_diff_te, n_periods_tc, n_periods_te, tc, te;
+
+	/* Bucket update */
+	time_diff_tc = time - m->time_tc;
+	time_diff_te = time - m->time_te;
+	n_periods_tc = time_diff_tc / p->cir_period;
+	n_periods_te = time_diff_te / p->eir_period;
+	m->time_tc += n_periods_tc * p->cir_period;
+	m->time_te += n_periods_te * p->eir_period;
+
+	tc = m->tc + n_periods_tc * p->cir_bytes_per_period;
+	if (tc > p->cbs)
+		tc = p->cbs;
+
+	te = m->te + n_periods_te * p->eir_bytes_per_period;
+	if (te > p->ebs)
+		te = p->ebs;
+
+	/* Color logic */
+	if ((pkt_color == e_RTE_METER_GREEN) && (tc >= pkt_len)) {
+		m->tc = tc - pkt_len;
+		m->te = te;
+		return e_RTE_METER_GREEN;
+	}
+
+	if ((pkt_color != e_RTE_METER_RED) && (te >= pkt_len)) {
+		m->tc = tc;
+		m->te = te - pkt_len;
+		return e_RTE_METER_YELLOW;
+	}
+
+	m->tc = tc;
+	m->te = te;
+	return e_RTE_METER_RED;
+}
+
 #ifdef __cplusplus
 }
 #endif
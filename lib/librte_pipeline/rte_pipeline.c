@@ -12,126 +12,15 @@
 #include <rte_branch_prediction.h>
 #include <rte_mbuf.h>
 #include <rte_malloc.h>
+#include <rte_atomic.h>
+#include <rte_pause.h>
 #include <rte_string_fns.h>
 
 #include "rte_pipeline.h"
+#include "rte_pipeline_internal.h"
 
 #define RTE_TABLE_INVALID                                 UINT32_MAX
 
-#ifdef RTE_PIPELINE_STATS_COLLECT
-
-#define RTE_PIPELINE_STATS_AH_DROP_WRITE(p, mask)			\
-	({ (p)->n_pkts_ah_drop = __builtin_popcountll(mask); })
-
-#define RTE_PIPELINE_STATS_AH_DROP_READ(p, counter)			\
-	({ (counter) += (p)->n_pkts_ah_drop; (p)->n_pkts_ah_drop = 0; })
-
-#define RTE_PIPELINE_STATS_TABLE_DROP0(p)				\
-	({ (p)->pkts_drop_mask = (p)->action_mask0[RTE_PIPELINE_ACTION_DROP]; })
-
-#define RTE_PIPELINE_STATS_TABLE_DROP1(p, counter)			\
-({									\
-	uint64_t mask = (p)->action_mask0[RTE_PIPELINE_ACTION_DROP];	\
-	mask ^= (p)->pkts_drop_mask;					\
-	(counter) += __builtin_popcountll(mask);			\
-})
-
-#else
-
-#define RTE_PIPELINE_STATS_AH_DROP_WRITE(p, mask)
-#define RTE_PIPELINE_STATS_AH_DROP_READ(p, counter)
-#define RTE_PIPELINE_STATS_TABLE_DROP0(p)
-#define RTE_PIPELINE_STATS_TABLE_DROP1(p, counter)
-
-#endif
-
-struct rte_port_in {
-	/* Input parameters */
-	struct rte_port_in_ops ops;
-	rte_pipeline_port_in_action_handler f_action;
-	void *arg_ah;
-	uint32_t burst_size;
-
-	/* The table to which this port is connected */
-	uint32_t table_id;
-
-	/* Handle to low-level port */
-	void *h_port;
-
-	/* List of enabled ports */
-	struct rte_port_in *next;
-
-	/* Statistics */
-	uint64_t n_pkts_dropped_by_ah;
-};
-
-struct rte_port_out {
-	/* Input parameters */
-	struct rte_port_out_ops ops;
-	rte_pipeline_port_out_action_handler f_action;
-	void *arg_ah;
-
-	/* Handle to low-level port */
-	void *h_port;
-
-	/* Statistics */
-	uint64_t n_pkts_dropped_by_ah;
-};
-
-struct rte_table {
-	/* Input parameters */
-	struct rte_table_ops ops;
-	rte_pipeline_table_action_handler_hit f_action_hit;
-	rte_pipeline_table_action_handler_miss f_action_miss;
-	void *arg_ah;
-	struct rte_pipeline_table_entry *default_entry;
-	uint32_t entry_size;
-
-	uint32_t table_next_id;
-	uint32_t table_next_id_valid;
-
-	/* Handle to the low-level table object */
-	void *h_table;
-
-	/* Statistics */
-	uint64_t n_pkts_dropped_by_lkp_hit_ah;
-	uint64_t n_pkts_dropped_by_lkp_miss_ah;
-	uint64_t n_pkts_dropped_lkp_hit;
-	uint64_t n_pkts_dropped_lkp_miss;
-};
-
-#define RTE_PIPELINE_MAX_NAME_SZ                           124
-
-struct rte_pipeline {
-	/* Input parameters */
-	char name[RTE_PIPELINE_MAX_NAME_SZ];
-	int socket_id;
-	uint32_t offset_port_id;
-
-	/* Internal tables */
-	struct rte_port_in ports_in[RTE_PIPELINE_PORT_IN_MAX];
-	struct rte_port_out ports_out[RTE_PIPELINE_PORT_OUT_MAX];
-	struct rte_table tables[RTE_PIPELINE_TABLE_MAX];
-
-	/* Occupancy of internal tables */
-	uint32_t num_ports_in;
-	uint32_t num_ports_out;
-	uint32_t num_tables;
-
-	/* List of enabled ports */
-	uint64_t enabled_port_in_mask;
-	struct rte_port_in *port_in_next;
-
-	/* Pipeline run structures */
-	struct rte_mbuf *pkts[RTE_PORT_IN_BURST_SIZE_MAX];
-	struct rte_pipeline_table_entry *entries[RTE_PORT_IN_BURST_SIZE_MAX];
-	uint64_t action_mask0[RTE_PIPELINE_ACTIONS];
-	uint64_t action_mask1[RTE_PIPELINE_ACTIONS];
-	uint64_t pkts_mask;
-	uint64_t n_pkts_ah_drop;
-	uint64_t pkts_drop_mask;
-} __rte_cache_aligned;
-
 static inline uint32_t
 rte_mask_get_next(uint64_t mask, uint32_t pos)
 {
@@ -157,6 +46,41 @@ rte_pipeline_port_in_free(struct rte_port_in *port);
 static void
 rte_pipeline_port_out_free(struct rte_port_out *port);
 
+/* The generated run function is only valid for the pipeline topology it was
+ * generated for, so fall back to the generic one on any topology change.
+ */
+static void
+rte_pipeline_topology_update(struct rte_pipeline *p)
+{
+	if (p->f_run == NULL)
+		return;
+
+	RTE_LOG(NOTICE, PIPELINE,
+		"%s: Pipeline %s topology changed, generated run function "
+		"disabled\n", __func__, p->name);
+	p->f_run = NULL;
+}
+
+/* Wait for the completion of the rte_pipeline_run() call in progress, if any,
+ * i.e. for the lookups in progress to complete and their entries to be no
+ * longer in use.
+ */
+static void
+rte_pipeline_sync(struct rte_pipeline *p)
+{
+	uint64_t run_seq;
+
+	/* Make the table updates visible before reading run_seq */
+	rte_smp_mb();
+
+	run_seq = __atomic_load_n(&p->run_seq, __ATOMIC_ACQUIRE);
+	if ((run_seq & 1) == 0)
+		return;
+
+	while (__atomic_load_n(&p->run_seq, __ATOMIC_ACQUIRE) == run_seq)
+		rte_pause();
+}
+
 /*
  * Pipeline
  *
@@ -224,6 +148,9 @@ rte_pipeline_create(struct rte_pipeline_params *params)
 	p->num_tables = 0;
 	p->enabled_port_in_mask = 0;
 	p->port_in_next = NULL;
+	p->f_run = NULL;
+	p->n_tables_lf = 0;
+	p->run_seq = 0;
 	p->pkts_mask = 0;
 	p->n_pkts_ah_drop = 0;
 
@@ -383,6 +310,11 @@ rte_pipeline_table_create(struct rte_pipeline *p,
 	table->table_next_id = 0;
 	table->table_next_id_valid = 0;
 
+	if (table->ops.f_reclaim != NULL)
+		p->n_tables_lf++;
+
+	rte_pipeline_topology_update(p);
+
 	return 0;
 }
 
@@ -437,6 +369,7 @@ rte_pipeline_table_default_entry_add(struct rte_pipeline *p,
 		(table->table_next_id_valid == 0)) {
 		table->table_next_id = default_entry->table_id;
 		table->table_next_id_valid = 1;
+		rte_pipeline_topology_update(p);
 	}
 
 	memcpy(table->default_entry, default_entry, table->entry_size);
@@ -478,6 +411,33 @@ rte_pipeline_table_default_entry_delete(struct rte_pipeline *p,
 	return 0;
 }
 
+/* For a lock-free table, the memory released by the previous entry add and
+ * delete operations is reclaimed when the table runs out of free memory.
+ */
+static int
+rte_pipeline_table_add(struct rte_pipeline *p,
+	struct rte_table *table,
+	void *key,
+	struct rte_pipeline_table_entry *entry,
+	int *key_found,
+	struct rte_pipeline_table_entry **entry_ptr)
+{
+	int status;
+
+	status = (table->ops.f_add)(table->h_table, key, (void *) entry,
+		key_found, (void **) entry_ptr);
+	if ((status != -ENOSPC) || (table->ops.f_reclaim == NULL))
+		return status;
+
+	rte_pipeline_sync(p);
+	status = (table->ops.f_reclaim)(table->h_table);
+	if (status)
+		return status;
+
+	return (table->ops.f_add)(table->h_table, key, (void *) entry,
+		key_found, (void **) entry_ptr);
+}
+
 int
 rte_pipeline_table_entry_add(struct rte_pipeline *p,
 		uint32_t table_id,
@@ -533,10 +493,11 @@ rte_pipeline_table_entry_add(struct rte_pipeline *p,
 		(table->table_next_id_valid == 0)) {
 		table->table_next_id = entry->table_id;
 		table->table_next_id_valid = 1;
+		rte_pipeline_topology_update(p);
 	}
 
-	return (table->ops.f_add)(table->h_table, key, (void *) entry,
-		key_found, (void **) entry_ptr);
+	return rte_pipeline_table_add(p, table, key, entry, key_found,
+		entry_ptr);
 }
 
 int
@@ -637,11 +598,28 @@ int rte_pipeline_table_entry_add_bulk(struct rte_pipeline *p,
 			(table->table_next_id_valid == 0)) {
 			table->table_next_id = entries[i]->table_id;
 			table->table_next_id_valid = 1;
+			rte_pipeline_topology_update(p);
 		}
 	}
 
-	return (table->ops.f_add_bulk)(table->h_table, keys, (void **) entries,
-		n_keys, key_found, (void **) entries_ptr);
+	if (table->ops.f_reclaim == NULL)
+		return (table->ops.f_add_bulk)(table->h_table, keys,
+			(void **) entries, n_keys, key_found,
+			(void **) entries_ptr);
+
+	/* Lock-free table: the keys are added one by one, so that the table
+	 * can be reclaimed in the middle of the bulk
+	 */
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = rte_pipeline_table_add(p, table, keys[i], entries[i],
+			&key_found[i], &entries_ptr[i]);
+		if (status)
+			return status;
+	}
+
+	return 0;
 }
 
 int rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
@@ -684,6 +662,37 @@ int rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
 			(void **) entries);
 }
 
+int __rte_experimental
+rte_pipeline_table_reclaim(struct rte_pipeline *p, uint32_t table_id)
+{
+	struct rte_table *table;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table_id %d out of range\n", __func__, table_id);
+		return -EINVAL;
+	}
+
+	table = &p->tables[table_id];
+
+	if (table->ops.f_reclaim == NULL) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: f_reclaim function pointer NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	rte_pipeline_sync(p);
+
+	return (table->ops.f_reclaim)(table->h_table);
+}
+
 /*
  * Port
  *
@@ -842,6 +851,8 @@ rte_pipeline_port_in_create(struct rte_pipeline *p,
 	port->h_port = h_port;
 	port->next = NULL;
 
+	rte_pipeline_topology_update(p);
+
 	return 0;
 }
 
@@ -889,6 +900,8 @@ rte_pipeline_port_out_create(struct rte_pipeline *p,
 	/* Initialize port internal data structure */
 	port->h_port = h_port;
 
+	rte_pipeline_topology_update(p);
+
 	return 0;
 }
 
@@ -930,6 +943,8 @@ rte_pipeline_port_in_connect_to_table(struct rte_pipeline *p,
 	port = &p->ports_in[port_id];
 	port->table_id = table_id;
 
+	rte_pipeline_topology_update(p);
+
 	return 0;
 }
 
@@ -1081,240 +1096,15 @@ rte_pipeline_check(struct rte_pipeline *p)
 	return 0;
 }
 
-static inline void
-rte_pipeline_compute_masks(struct rte_pipeline *p, uint64_t pkts_mask)
-{
-	p->action_mask1[RTE_PIPELINE_ACTION_DROP] = 0;
-	p->action_mask1[RTE_PIPELINE_ACTION_PORT] = 0;
-	p->action_mask1[RTE_PIPELINE_ACTION_PORT_META] = 0;
-	p->action_mask1[RTE_PIPELINE_ACTION_TABLE] = 0;
-
-	if ((pkts_mask & (pkts_mask + 1)) == 0) {
-		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
-		uint32_t i;
-
-		for (i = 0; i < n_pkts; i++) {
-			uint64_t pkt_mask = 1LLU << i;
-			uint32_t pos = p->entries[i]->action;
-
-			p->action_mask1[pos] |= pkt_mask;
-		}
-	} else {
-		uint32_t i;
-
-		for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
-			uint64_t pkt_mask = 1LLU << i;
-			uint32_t pos;
-
-			if ((pkt_mask & pkts_mask) == 0)
-				continue;
-
-			pos = p->entries[i]->action;
-			p->action_mask1[pos] |= pkt_mask;
-		}
-	}
-}
-
-static inline void
-rte_pipeline_action_handler_port_bulk(struct rte_pipeline *p,
-	uint64_t pkts_mask, uint32_t port_id)
-{
-	struct rte_port_out *port_out = &p->ports_out[port_id];
-
-	p->pkts_mask = pkts_mask;
-
-	/* Output port user actions */
-	if (port_out->f_action != NULL) {
-		port_out->f_action(p, p->pkts, pkts_mask, port_out->arg_ah);
-
-		RTE_PIPELINE_STATS_AH_DROP_READ(p,
-			port_out->n_pkts_dropped_by_ah);
-	}
-
-	/* Output port TX */
-	if (p->pkts_mask != 0)
-		port_out->ops.f_tx_bulk(port_out->h_port,
-			p->pkts,
-			p->pkts_mask);
-}
-
-static inline void
-rte_pipeline_action_handler_port(struct rte_pipeline *p, uint64_t pkts_mask)
-{
-	p->pkts_mask = pkts_mask;
-
-	if ((pkts_mask & (pkts_mask + 1)) == 0) {
-		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
-		uint32_t i;
-
-		for (i = 0; i < n_pkts; i++) {
-			struct rte_mbuf *pkt = p->pkts[i];
-			uint32_t port_out_id = p->entries[i]->port_id;
-			struct rte_port_out *port_out =
-				&p->ports_out[port_out_id];
-
-			/* Output port user actions */
-			if (port_out->f_action == NULL) /* Output port TX */
-				port_out->ops.f_tx(port_out->h_port, pkt);
-			else {
-				uint64_t pkt_mask = 1LLU << i;
-
-				port_out->f_action(p,
-					p->pkts,
-					pkt_mask,
-					port_out->arg_ah);
-
-				RTE_PIPELINE_STATS_AH_DROP_READ(p,
-					port_out->n_pkts_dropped_by_ah);
-
-				/* Output port TX */
-				if (pkt_mask & p->pkts_mask)
-					port_out->ops.f_tx(port_out->h_port,
-						pkt);
-			}
-		}
-	} else {
-		uint32_t i;
-
-		for (i = 0;  i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
-			uint64_t pkt_mask = 1LLU << i;
-			struct rte_mbuf *pkt;
-			struct rte_port_out *port_out;
-			uint32_t port_out_id;
-
-			if ((pkt_mask & pkts_mask) == 0)
-				continue;
-
-			pkt = p->pkts[i];
-			port_out_id = p->entries[i]->port_id;
-			port_out = &p->ports_out[port_out_id];
-
-			/* Output port user actions */
-			if (port_out->f_action == NULL) /* Output port TX */
-				port_out->ops.f_tx(port_out->h_port, pkt);
-			else {
-				port_out->f_action(p,
-					p->pkts,
-					pkt_mask,
-					port_out->arg_ah);
-
-				RTE_PIPELINE_STATS_AH_DROP_READ(p,
-					port_out->n_pkts_dropped_by_ah);
-
-				/* Output port TX */
-				if (pkt_mask & p->pkts_mask)
-					port_out->ops.f_tx(port_out->h_port,
-						pkt);
-			}
-		}
-	}
-}
-
-static inline void
-rte_pipeline_action_handler_port_meta(struct rte_pipeline *p,
-	uint64_t pkts_mask)
-{
-	p->pkts_mask = pkts_mask;
-
-	if ((pkts_mask & (pkts_mask + 1)) == 0) {
-		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
-		uint32_t i;
-
-		for (i = 0; i < n_pkts; i++) {
-			struct rte_mbuf *pkt = p->pkts[i];
-			uint32_t port_out_id =
-				RTE_MBUF_METADATA_UINT32(pkt,
-					p->offset_port_id);
-			struct rte_port_out *port_out = &p->ports_out[
-				port_out_id];
-
-			/* Output port user actions */
-			if (port_out->f_action == NULL) /* Output port TX */
-				port_out->ops.f_tx(port_out->h_port, pkt);
-			else {
-				uint64_t pkt_mask = 1LLU << i;
-
-				port_out->f_action(p,
-					p->pkts,
-					pkt_mask,
-					port_out->arg_ah);
-
-				RTE_PIPELINE_STATS_AH_DROP_READ(p,
-					port_out->n_pkts_dropped_by_ah);
-
-				/* Output port TX */
-				if (pkt_mask & p->pkts_mask)
-					port_out->ops.f_tx(port_out->h_port,
-						pkt);
-			}
-		}
-	} else {
-		uint32_t i;
-
-		for (i = 0;  i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
-			uint64_t pkt_mask = 1LLU << i;
-			struct rte_mbuf *pkt;
-			struct rte_port_out *port_out;
-			uint32_t port_out_id;
-
-			if ((pkt_mask & pkts_mask) == 0)
-				continue;
-
-			pkt = p->pkts[i];
-			port_out_id = RTE_MBUF_METADATA_UINT32(pkt,
-				p->offset_port_id);
-			port_out = &p->ports_out[port_out_id];
-
-			/* Output port user actions */
-			if (port_out->f_action == NULL) /* Output port TX */
-				port_out->ops.f_tx(port_out->h_port, pkt);
-			else {
-				port_out->f_action(p,
-					p->pkts,
-					pkt_mask,
-					port_out->arg_ah);
-
-				RTE_PIPELINE_STATS_AH_DROP_READ(p,
-					port_out->n_pkts_dropped_by_ah);
-
-				/* Output port TX */
-				if (pkt_mask & p->pkts_mask)
-					port_out->ops.f_tx(port_out->h_port,
-						pkt);
-			}
-		}
-	}
-}
-
-static inline void
-rte_pipeline_action_handler_drop(struct rte_pipeline *p, uint64_t pkts_mask)
-{
-	if ((pkts_mask & (pkts_mask + 1)) == 0) {
-		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
-		uint32_t i;
-
-		for (i = 0; i < n_pkts; i++)
-			rte_pktmbuf_free(p->pkts[i]);
-	} else {
-		uint32_t i;
-
-		for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
-			uint64_t pkt_mask = 1LLU << i;
-
-			if ((pkt_mask & pkts_mask) == 0)
-				continue;
-
-			rte_pktmbuf_free(p->pkts[i]);
-		}
-	}
-}
-
-int
-rte_pipeline_run(struct rte_pipeline *p)
+static inline int
+rte_pipeline_run_burst(struct rte_pipeline *p)
 {
 	struct rte_port_in *port_in = p->port_in_next;
 	uint32_t n_pkts, table_id;
 
+	if (p->f_run != NULL)
+		return p->f_run(p);
+
 	if (port_in == NULL)
 		return 0;
 
@@ -1326,126 +1116,56 @@ rte_pipeline_run(struct rte_pipeline *p)
 		return 0;
 	}
 
-	p->pkts_mask = RTE_LEN2MASK(n_pkts, uint64_t);
-	p->action_mask0[RTE_PIPELINE_ACTION_DROP] = 0;
-	p->action_mask0[RTE_PIPELINE_ACTION_PORT] = 0;
-	p->action_mask0[RTE_PIPELINE_ACTION_PORT_META] = 0;
-	p->action_mask0[RTE_PIPELINE_ACTION_TABLE] = 0;
-
-	/* Input port user actions */
-	if (port_in->f_action != NULL) {
-		port_in->f_action(p, p->pkts, n_pkts, port_in->arg_ah);
-
-		RTE_PIPELINE_STATS_AH_DROP_READ(p,
-			port_in->n_pkts_dropped_by_ah);
-	}
+	rte_pipeline_port_in_start(p, port_in, n_pkts, 1);
 
 	/* Table */
 	for (table_id = port_in->table_id; p->pkts_mask != 0; ) {
-		struct rte_table *table;
-		uint64_t lookup_hit_mask, lookup_miss_mask;
-
-		/* Lookup */
-		table = &p->tables[table_id];
-		table->ops.f_lookup(table->h_table, p->pkts, p->pkts_mask,
-			&lookup_hit_mask, (void **) p->entries);
-		lookup_miss_mask = p->pkts_mask & (~lookup_hit_mask);
-
-		/* Lookup miss */
-		if (lookup_miss_mask != 0) {
-			struct rte_pipeline_table_entry *default_entry =
-				table->default_entry;
-
-			p->pkts_mask = lookup_miss_mask;
-
-			/* Table user actions */
-			if (table->f_action_miss != NULL) {
-				table->f_action_miss(p,
-					p->pkts,
-					lookup_miss_mask,
-					default_entry,
-					table->arg_ah);
-
-				RTE_PIPELINE_STATS_AH_DROP_READ(p,
-					table->n_pkts_dropped_by_lkp_miss_ah);
-			}
-
-			/* Table reserved actions */
-			if ((default_entry->action == RTE_PIPELINE_ACTION_PORT) &&
-				(p->pkts_mask != 0))
-				rte_pipeline_action_handler_port_bulk(p,
-					p->pkts_mask,
-					default_entry->port_id);
-			else {
-				uint32_t pos = default_entry->action;
-
-				RTE_PIPELINE_STATS_TABLE_DROP0(p);
-
-				p->action_mask0[pos] |= p->pkts_mask;
-
-				RTE_PIPELINE_STATS_TABLE_DROP1(p,
-					table->n_pkts_dropped_lkp_miss);
-			}
-		}
-
-		/* Lookup hit */
-		if (lookup_hit_mask != 0) {
-			p->pkts_mask = lookup_hit_mask;
-
-			/* Table user actions */
-			if (table->f_action_hit != NULL) {
-				table->f_action_hit(p,
-					p->pkts,
-					lookup_hit_mask,
-					p->entries,
-					table->arg_ah);
-
-				RTE_PIPELINE_STATS_AH_DROP_READ(p,
-					table->n_pkts_dropped_by_lkp_hit_ah);
-			}
-
-			/* Table reserved actions */
-			RTE_PIPELINE_STATS_TABLE_DROP0(p);
-			rte_pipeline_compute_masks(p, p->pkts_mask);
-			p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
-				p->action_mask1[
-					RTE_PIPELINE_ACTION_DROP];
-			p->action_mask0[RTE_PIPELINE_ACTION_PORT] |=
-				p->action_mask1[
-					RTE_PIPELINE_ACTION_PORT];
-			p->action_mask0[RTE_PIPELINE_ACTION_PORT_META] |=
-				p->action_mask1[
-					RTE_PIPELINE_ACTION_PORT_META];
-			p->action_mask0[RTE_PIPELINE_ACTION_TABLE] |=
-				p->action_mask1[
-					RTE_PIPELINE_ACTION_TABLE];
-
-			RTE_PIPELINE_STATS_TABLE_DROP1(p,
-				table->n_pkts_dropped_lkp_hit);
-		}
+		struct rte_table *table = &p->tables[table_id];
 
-		/* Prepare for next iteration */
-		p->pkts_mask = p->action_mask0[RTE_PIPELINE_ACTION_TABLE];
+		rte_pipeline_table_run(p, table, 1, 1, 1);
 		table_id = table->table_next_id;
-		p->action_mask0[RTE_PIPELINE_ACTION_TABLE] = 0;
 	}
 
-	/* Table reserved action PORT */
-	rte_pipeline_action_handler_port(p,
-		p->action_mask0[RTE_PIPELINE_ACTION_PORT]);
+	rte_pipeline_port_in_end(p, port_in, 1);
 
-	/* Table reserved action PORT META */
-	rte_pipeline_action_handler_port_meta(p,
-		p->action_mask0[RTE_PIPELINE_ACTION_PORT_META]);
+	return (int) n_pkts;
+}
 
-	/* Table reserved action DROP */
-	rte_pipeline_action_handler_drop(p,
-		p->action_mask0[RTE_PIPELINE_ACTION_DROP]);
+int
+rte_pipeline_run(struct rte_pipeline *p)
+{
+	uint64_t run_seq = p->run_seq;
+	int n_pkts;
 
-	/* Pick candidate for next port IN to serve */
-	p->port_in_next = port_in->next;
+	if (p->n_tables_lf == 0)
+		return rte_pipeline_run_burst(p);
 
-	return (int) n_pkts;
+	/* Let the control thread know that lookups are in progress, see
+	 * rte_pipeline_sync()
+	 */
+	__atomic_store_n(&p->run_seq, run_seq + 1, __ATOMIC_RELAXED);
+	rte_smp_mb();
+
+	n_pkts = rte_pipeline_run_burst(p);
+
+	__atomic_store_n(&p->run_seq, run_seq + 2, __ATOMIC_RELEASE);
+
+	return n_pkts;
+}
+
+int
+rte_pipeline_run_fn_set(struct rte_pipeline *p, rte_pipeline_run_fn f_run)
+{
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	p->f_run = f_run;
+
+	return 0;
 }
 
 int
@@ -52,13 +52,36 @@ extern "C" {
  * the same CPU core, but it is not allowed (for thread safety reasons) to have
  * multiple CPU cores running the same pipeline instance.
  *
+ * <B>Lock-free tables.</B> The table entries are normally added and deleted
+ * by the thread running the pipeline. For the tables of a lock-free type
+ * (i.e. whose operations include the reclaim operation), a single control
+ * thread can add and delete entries with rte_pipeline_table_entry_add(),
+ * rte_pipeline_table_entry_delete() and their bulk versions while another
+ * thread runs the pipeline with rte_pipeline_run(). The memory released by
+ * these operations is reclaimed once the rte_pipeline_run() call in progress,
+ * if any, completes: automatically when the table runs out of free memory,
+ * or through rte_pipeline_table_reclaim(). The default entries and the
+ * pipeline topology are still updated by the thread running the pipeline:
+ * the control thread must not add an entry with action
+ * RTE_PIPELINE_ACTION_TABLE to a table whose next table is not set yet, as
+ * this changes the topology and drops the generated run function, if any.
+ *
+ * <B>Code generation.</B> The generic run function finds out at run-time the
+ * next table of each table, which user action handlers are present, etc.
+ * Once its topology is final, the pipeline can be translated into C code by
+ * rte_pipeline_codegen(), with all these decisions taken at generation time.
+ * The generated code is compiled ahead of time with the application or at
+ * run-time as a shared object, then installed with rte_pipeline_run_fn_set().
+ *
  ***/
 
 #include <stdint.h>
+#include <stdio.h>
 
 #include <rte_port.h>
 #include <rte_table.h>
 #include <rte_common.h>
+#include <rte_compat.h>
 
 struct rte_mbuf;
 
@@ -156,6 +179,11 @@ int rte_pipeline_check(struct rte_pipeline *p);
 /**
  * Pipeline run
  *
+ * Runs the function installed with rte_pipeline_run_fn_set(), if any, or the
+ * generic one otherwise. When the pipeline has lock-free tables, the run
+ * function has to be called through this function for their entries to be
+ * updated by another thread.
+ *
  * @param p
  *   Handle to pipeline instance
  * @return
@@ -163,6 +191,66 @@ int rte_pipeline_check(struct rte_pipeline *p);
  */
 int rte_pipeline_run(struct rte_pipeline *p);
 
+/**
+ * Pipeline run function, as generated by rte_pipeline_codegen()
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @return
+ *   Number of packets read and processed
+ */
+typedef int (*rte_pipeline_run_fn)(struct rte_pipeline *p);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Pipeline code generation
+ *
+ * Writes the C source code of a run function specialized for the current
+ * pipeline topology: for each input port, the burst size, the chain of
+ * tables and the presence of the input port, table and output port user
+ * action handlers are resolved at generation time. The table entries and the
+ * default entries can still be updated once the code is generated.
+ *
+ * The generated code includes rte_pipeline_internal.h, so it has to be built
+ * with the headers of the DPDK version used by the application.
+ *
+ * @param p
+ *   Handle to pipeline instance, which has to pass rte_pipeline_check()
+ * @param f
+ *   Output file
+ * @param name
+ *   Name of the generated run function, which has to be a valid C identifier.
+ *   Its helper functions are prefixed with it.
+ * @return
+ *   0 on success, error code otherwise
+ */
+int __rte_experimental
+rte_pipeline_codegen(struct rte_pipeline *p, FILE *f, const char *name);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Pipeline run function set
+ *
+ * Installs the run function generated for this pipeline by
+ * rte_pipeline_codegen(). Creating a new port or table, connecting an input
+ * port or adding the first entry that sends packets to another table changes
+ * the pipeline topology, which uninstalls it.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param f_run
+ *   Run function generated for this pipeline, NULL to go back to the generic
+ *   run function
+ * @return
+ *   0 on success, error code otherwise
+ */
+int __rte_experimental
+rte_pipeline_run_fn_set(struct rte_pipeline *p, rte_pipeline_run_fn f_run);
+
 /**
  * Pipeline flush
  *
@@ -391,6 +479,11 @@ int rte_pipeline_table_default_entry_delete(struct rte_pipeline *p,
 /**
  * Pipeline table entry add
  *
+ * The first entry with action RTE_PIPELINE_ACTION_TABLE added to a table sets
+ * the next table of the table, which changes the pipeline topology. Such an
+ * entry cannot be added while another thread runs the pipeline, even for a
+ * lock-free table.
+ *
  * @param p
  *   Handle to pipeline instance
  * @param table_id
@@ -508,6 +601,27 @@ int rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
 	int *key_found,
 	struct rte_pipeline_table_entry **entries);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Pipeline table reclaim
+ *
+ * Waits for the rte_pipeline_run() call in progress on another thread, if
+ * any, to complete, then reclaims the table memory released by the previous
+ * entry add and delete operations. The table has to be of a lock-free type.
+ * This function cannot be called by a table action handler.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @return
+ *   0 on success, error code otherwise
+ */
+int __rte_experimental
+rte_pipeline_table_reclaim(struct rte_pipeline *p, uint32_t table_id);
+
 /**
  * Read pipeline table stats.
  *
@@ -0,0 +1,235 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+
+#include "rte_pipeline.h"
+#include "rte_pipeline_internal.h"
+
+static int
+codegen_name_check(const char *name)
+{
+	uint32_t i;
+
+	if ((name == NULL) ||
+		((isalpha((unsigned char)name[0]) == 0) && (name[0] != '_')))
+		return -EINVAL;
+
+	for (i = 1; name[i] != '\0'; i++)
+		if ((isalnum((unsigned char)name[i]) == 0) && (name[i] != '_'))
+			return -EINVAL;
+
+	return 0;
+}
+
+/* Tables that can be reached from the input ports */
+static uint64_t
+codegen_tables_mask(struct rte_pipeline *p)
+{
+	uint64_t tables_mask = 0;
+	uint32_t i;
+
+	for (i = 0; i < p->num_ports_in; i++) {
+		uint32_t table_id = p->ports_in[i].table_id;
+
+		while ((tables_mask & (1LLU << table_id)) == 0) {
+			struct rte_table *table = &p->tables[table_id];
+
+			tables_mask |= 1LLU << table_id;
+			if (table->table_next_id_valid == 0)
+				break;
+
+			table_id = table->table_next_id;
+		}
+	}
+
+	return tables_mask;
+}
+
+static int
+codegen_port_out_ah(struct rte_pipeline *p)
+{
+	uint32_t i;
+
+	for (i = 0; i < p->num_ports_out; i++)
+		if (p->ports_out[i].f_action != NULL)
+			return 1;
+
+	return 0;
+}
+
+static void
+codegen_table(struct rte_pipeline *p,
+	FILE *f,
+	const char *name,
+	uint32_t table_id,
+	int port_out_ah)
+{
+	struct rte_table *table = &p->tables[table_id];
+
+	fprintf(f,
+		"static void\n"
+		"%s_table_%u(struct rte_pipeline *p)\n"
+		"{\n"
+		"\trte_pipeline_table_run(p, &p->tables[%u], %d, %d, %d);\n",
+		name, table_id,
+		table_id,
+		table->f_action_hit != NULL,
+		table->f_action_miss != NULL,
+		port_out_ah);
+
+	if (table->table_next_id_valid)
+		fprintf(f,
+			"\n"
+			"\t/* Next table */\n"
+			"\tif (p->pkts_mask != 0)\n"
+			"\t\t%s_table_%u(p);\n",
+			name, table->table_next_id);
+
+	fprintf(f, "}\n\n");
+}
+
+static void
+codegen_port_in(struct rte_pipeline *p,
+	FILE *f,
+	const char *name,
+	uint32_t port_id,
+	int port_out_ah)
+{
+	struct rte_port_in *port_in = &p->ports_in[port_id];
+
+	fprintf(f,
+		"static int\n"
+		"%s_port_in_%u(struct rte_pipeline *p)\n"
+		"{\n"
+		"\tstruct rte_port_in *port_in = &p->ports_in[%u];\n"
+		"\tuint32_t n_pkts;\n"
+		"\n"
+		"\t/* Input port RX */\n"
+		"\tn_pkts = port_in->ops.f_rx(port_in->h_port, p->pkts, %u);\n"
+		"\tif (n_pkts == 0) {\n"
+		"\t\tp->port_in_next = port_in->next;\n"
+		"\t\treturn 0;\n"
+		"\t}\n"
+		"\n"
+		"\trte_pipeline_port_in_start(p, port_in, n_pkts, %d);\n"
+		"\n"
+		"\t/* Table */\n"
+		"\tif (p->pkts_mask != 0)\n"
+		"\t\t%s_table_%u(p);\n"
+		"\n"
+		"\trte_pipeline_port_in_end(p, port_in, %d);\n"
+		"\n"
+		"\treturn (int) n_pkts;\n"
+		"}\n\n",
+		name, port_id,
+		port_id,
+		port_in->burst_size,
+		port_in->f_action != NULL,
+		name, port_in->table_id,
+		port_out_ah);
+}
+
+int __rte_experimental
+rte_pipeline_codegen(struct rte_pipeline *p, FILE *f, const char *name)
+{
+	uint64_t tables_mask;
+	uint32_t i;
+	int port_out_ah, status;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (f == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: f parameter NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	if (codegen_name_check(name) != 0) {
+		RTE_LOG(ERR, PIPELINE, "%s: Invalid function name\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	status = rte_pipeline_check(p);
+	if (status != 0)
+		return status;
+
+	tables_mask = codegen_tables_mask(p);
+	port_out_ah = codegen_port_out_ah(p);
+
+	/* File header */
+	fprintf(f,
+		"/*\n"
+		" * Run function of pipeline \"%s\", generated by "
+		"rte_pipeline_codegen().\n"
+		" * Input ports: %u, tables: %u, output ports: %u.\n"
+		" */\n"
+		"\n"
+		"#include <rte_config.h>\n"
+		"#include <rte_pipeline_internal.h>\n"
+		"\n"
+		"int %s(struct rte_pipeline *p);\n"
+		"\n",
+		p->name, p->num_ports_in, p->num_tables, p->num_ports_out,
+		name);
+
+	/* Tables */
+	for (i = 0; i < p->num_tables; i++)
+		if (tables_mask & (1LLU << i))
+			fprintf(f,
+				"static void\n"
+				"%s_table_%u(struct rte_pipeline *p);\n",
+				name, i);
+	fprintf(f, "\n");
+
+	for (i = 0; i < p->num_tables; i++)
+		if (tables_mask & (1LLU << i))
+			codegen_table(p, f, name, i, port_out_ah);
+
+	/* Input ports */
+	for (i = 0; i < p->num_ports_in; i++)
+		codegen_port_in(p, f, name, i, port_out_ah);
+
+	/* Run function */
+	fprintf(f,
+		"int\n"
+		"%s(struct rte_pipeline *p)\n"
+		"{\n"
+		"\tstruct rte_port_in *port_in = p->port_in_next;\n"
+		"\n"
+		"\tif (port_in == NULL)\n"
+		"\t\treturn 0;\n"
+		"\n"
+		"\tswitch (port_in - p->ports_in) {\n",
+		name);
+
+	for (i = 0; i < p->num_ports_in; i++)
+		fprintf(f,
+			"\tcase %u:\n"
+			"\t\treturn %s_port_in_%u(p);\n",
+			i, name, i);
+
+	fprintf(f,
+		"\tdefault:\n"
+		"\t\treturn 0;\n"
+		"\t}\n"
+		"}\n");
+
+	if (ferror(f)) {
+		RTE_LOG(ERR, PIPELINE, "%s: Write error\n", __func__);
+		return -EIO;
+	}
+
+	return 0;
+}
@@ -0,0 +1,537 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2010-2018 Intel Corporation
+ */
+
+#ifndef __INCLUDE_RTE_PIPELINE_INTERNAL_H__
+#define __INCLUDE_RTE_PIPELINE_INTERNAL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE Pipeline internals
+ *
+ * Pipeline data structures and run-time building blocks, shared by the
+ * generic rte_pipeline_run() and by the run functions generated by
+ * rte_pipeline_codegen(). This header is not part of the public API: its
+ * content may change at any time, so the generated code has to be built
+ * against the headers of the DPDK version that runs it.
+ *
+ ***/
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+#include <rte_mbuf.h>
+
+#include "rte_pipeline.h"
+
+#ifdef RTE_PIPELINE_STATS_COLLECT
+
+#define RTE_PIPELINE_STATS_AH_DROP_WRITE(p, mask)			\
+	({ (p)->n_pkts_ah_drop = __builtin_popcountll(mask); })
+
+#define RTE_PIPELINE_STATS_AH_DROP_READ(p, counter)			\
+	({ (counter) += (p)->n_pkts_ah_drop; (p)->n_pkts_ah_drop = 0; })
+
+#define RTE_PIPELINE_STATS_TABLE_DROP0(p)				\
+	({ (p)->pkts_drop_mask = (p)->action_mask0[RTE_PIPELINE_ACTION_DROP]; })
+
+#define RTE_PIPELINE_STATS_TABLE_DROP1(p, counter)			\
+({									\
+	uint64_t mask = (p)->action_mask0[RTE_PIPELINE_ACTION_DROP];	\
+	mask ^= (p)->pkts_drop_mask;					\
+	(counter) += __builtin_popcountll(mask);			\
+})
+
+#else
+
+#define RTE_PIPELINE_STATS_AH_DROP_WRITE(p, mask)
+#define RTE_PIPELINE_STATS_AH_DROP_READ(p, counter)
+#define RTE_PIPELINE_STATS_TABLE_DROP0(p)
+#define RTE_PIPELINE_STATS_TABLE_DROP1(p, counter)
+
+#endif
+
+struct rte_port_in {
+	/* Input parameters */
+	struct rte_port_in_ops ops;
+	rte_pipeline_port_in_action_handler f_action;
+	void *arg_ah;
+	uint32_t burst_size;
+
+	/* The table to which this port is connected */
+	uint32_t table_id;
+
+	/* Handle to low-level port */
+	void *h_port;
+
+	/* List of enabled ports */
+	struct rte_port_in *next;
+
+	/* Statistics */
+	uint64_t n_pkts_dropped_by_ah;
+};
+
+struct rte_port_out {
+	/* Input parameters */
+	struct rte_port_out_ops ops;
+	rte_pipeline_port_out_action_handler f_action;
+	void *arg_ah;
+
+	/* Handle to low-level port */
+	void *h_port;
+
+	/* Statistics */
+	uint64_t n_pkts_dropped_by_ah;
+};
+
+struct rte_table {
+	/* Input parameters */
+	struct rte_table_ops ops;
+	rte_pipeline_table_action_handler_hit f_action_hit;
+	rte_pipeline_table_action_handler_miss f_action_miss;
+	void *arg_ah;
+	struct rte_pipeline_table_entry *default_entry;
+	uint32_t entry_size;
+
+	uint32_t table_next_id;
+	uint32_t table_next_id_valid;
+
+	/* Handle to the low-level table object */
+	void *h_table;
+
+	/* Statistics */
+	uint64_t n_pkts_dropped_by_lkp_hit_ah;
+	uint64_t n_pkts_dropped_by_lkp_miss_ah;
+	uint64_t n_pkts_dropped_lkp_hit;
+	uint64_t n_pkts_dropped_lkp_miss;
+};
+
+#define RTE_PIPELINE_MAX_NAME_SZ                           124
+
+struct rte_pipeline {
+	/* Input parameters */
+	char name[RTE_PIPELINE_MAX_NAME_SZ];
+	int socket_id;
+	uint32_t offset_port_id;
+
+	/* Internal tables */
+	struct rte_port_in ports_in[RTE_PIPELINE_PORT_IN_MAX];
+	struct rte_port_out ports_out[RTE_PIPELINE_PORT_OUT_MAX];
+	struct rte_table tables[RTE_PIPELINE_TABLE_MAX];
+
+	/* Occupancy of internal tables */
+	uint32_t num_ports_in;
+	uint32_t num_ports_out;
+	uint32_t num_tables;
+
+	/* List of enabled ports */
+	uint64_t enabled_port_in_mask;
+	struct rte_port_in *port_in_next;
+
+	/* Run function generated by rte_pipeline_codegen(), NULL if none */
+	rte_pipeline_run_fn f_run;
+
+	/* Number of lock-free tables. When non-zero, run_seq is odd while
+	 * rte_pipeline_run() is in progress.
+	 */
+	uint32_t n_tables_lf;
+	uint64_t run_seq;
+
+	/* Pipeline run structures */
+	struct rte_mbuf *pkts[RTE_PORT_IN_BURST_SIZE_MAX];
+	struct rte_pipeline_table_entry *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t action_mask0[RTE_PIPELINE_ACTIONS];
+	uint64_t action_mask1[RTE_PIPELINE_ACTIONS];
+	uint64_t pkts_mask;
+	uint64_t n_pkts_ah_drop;
+	uint64_t pkts_drop_mask;
+} __rte_cache_aligned;
+
+static inline void
+rte_pipeline_compute_masks(struct rte_pipeline *p, uint64_t pkts_mask)
+{
+	p->action_mask1[RTE_PIPELINE_ACTION_DROP] = 0;
+	p->action_mask1[RTE_PIPELINE_ACTION_PORT] = 0;
+	p->action_mask1[RTE_PIPELINE_ACTION_PORT_META] = 0;
+	p->action_mask1[RTE_PIPELINE_ACTION_TABLE] = 0;
+
+	if ((pkts_mask & (pkts_mask + 1)) == 0) {
+		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+		uint32_t i;
+
+		for (i = 0; i < n_pkts; i++) {
+			uint64_t pkt_mask = 1LLU << i;
+			uint32_t pos = p->entries[i]->action;
+
+			p->action_mask1[pos] |= pkt_mask;
+		}
+	} else {
+		uint32_t i;
+
+		for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+			uint64_t pkt_mask = 1LLU << i;
+			uint32_t pos;
+
+			if ((pkt_mask & pkts_mask) == 0)
+				continue;
+
+			pos = p->entries[i]->action;
+			p->action_mask1[pos] |= pkt_mask;
+		}
+	}
+}
+
+static __rte_always_inline void
+rte_pipeline_action_handler_port_bulk(struct rte_pipeline *p,
+	uint64_t pkts_mask, uint32_t port_id, const int port_out_ah)
+{
+	struct rte_port_out *port_out = &p->ports_out[port_id];
+
+	p->pkts_mask = pkts_mask;
+
+	/* Output port user actions */
+	if (port_out_ah && (port_out->f_action != NULL)) {
+		port_out->f_action(p, p->pkts, pkts_mask, port_out->arg_ah);
+
+		RTE_PIPELINE_STATS_AH_DROP_READ(p,
+			port_out->n_pkts_dropped_by_ah);
+	}
+
+	/* Output port TX */
+	if (p->pkts_mask != 0)
+		port_out->ops.f_tx_bulk(port_out->h_port,
+			p->pkts,
+			p->pkts_mask);
+}
+
+static __rte_always_inline void
+rte_pipeline_action_handler_port(struct rte_pipeline *p, uint64_t pkts_mask,
+	const int port_out_ah)
+{
+	p->pkts_mask = pkts_mask;
+
+	if ((pkts_mask & (pkts_mask + 1)) == 0) {
+		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+		uint32_t i;
+
+		for (i = 0; i < n_pkts; i++) {
+			struct rte_mbuf *pkt = p->pkts[i];
+			uint32_t port_out_id = p->entries[i]->port_id;
+			struct rte_port_out *port_out =
+				&p->ports_out[port_out_id];
+
+			/* Output port user actions, if any */
+			if (!port_out_ah || (port_out->f_action == NULL))
+				/* Output port TX */
+				port_out->ops.f_tx(port_out->h_port, pkt);
+			else {
+				uint64_t pkt_mask = 1LLU << i;
+
+				port_out->f_action(p,
+					p->pkts,
+					pkt_mask,
+					port_out->arg_ah);
+
+				RTE_PIPELINE_STATS_AH_DROP_READ(p,
+					port_out->n_pkts_dropped_by_ah);
+
+				/* Output port TX */
+				if (pkt_mask & p->pkts_mask)
+					port_out->ops.f_tx(port_out->h_port,
+						pkt);
+			}
+		}
+	} else {
+		uint32_t i;
+
+		for (i = 0;  i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+			uint64_t pkt_mask = 1LLU << i;
+			struct rte_mbuf *pkt;
+			struct rte_port_out *port_out;
+			uint32_t port_out_id;
+
+			if ((pkt_mask & pkts_mask) == 0)
+				continue;
+
+			pkt = p->pkts[i];
+			port_out_id = p->entries[i]->port_id;
+			port_out = &p->ports_out[port_out_id];
+
+			/* Output port user actions, if any */
+			if (!port_out_ah || (port_out->f_action == NULL))
+				/* Output port TX */
+				port_out->ops.f_tx(port_out->h_port, pkt);
+			else {
+				port_out->f_action(p,
+					p->pkts,
+					pkt_mask,
+					port_out->arg_ah);
+
+				RTE_PIPELINE_STATS_AH_DROP_READ(p,
+					port_out->n_pkts_dropped_by_ah);
+
+				/* Output port TX */
+				if (pkt_mask & p->pkts_mask)
+					port_out->ops.f_tx(port_out->h_port,
+						pkt);
+			}
+		}
+	}
+}
+
+static __rte_always_inline void
+rte_pipeline_action_handler_port_meta(struct rte_pipeline *p,
+	uint64_t pkts_mask, const int port_out_ah)
+{
+	p->pkts_mask = pkts_mask;
+
+	if ((pkts_mask & (pkts_mask + 1)) == 0) {
+		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+		uint32_t i;
+
+		for (i = 0; i < n_pkts; i++) {
+			struct rte_mbuf *pkt = p->pkts[i];
+			uint32_t port_out_id =
+				RTE_MBUF_METADATA_UINT32(pkt,
+					p->offset_port_id);
+			struct rte_port_out *port_out = &p->ports_out[
+				port_out_id];
+
+			/* Output port user actions, if any */
+			if (!port_out_ah || (port_out->f_action == NULL))
+				/* Output port TX */
+				port_out->ops.f_tx(port_out->h_port, pkt);
+			else {
+				uint64_t pkt_mask = 1LLU << i;
+
+				port_out->f_action(p,
+					p->pkts,
+					pkt_mask,
+					port_out->arg_ah);
+
+				RTE_PIPELINE_STATS_AH_DROP_READ(p,
+					port_out->n_pkts_dropped_by_ah);
+
+				/* Output port TX */
+				if (pkt_mask & p->pkts_mask)
+					port_out->ops.f_tx(port_out->h_port,
+						pkt);
+			}
+		}
+	} else {
+		uint32_t i;
+
+		for (i = 0;  i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+			uint64_t pkt_mask = 1LLU << i;
+			struct rte_mbuf *pkt;
+			struct rte_port_out *port_out;
+			uint32_t port_out_id;
+
+			if ((pkt_mask & pkts_mask) == 0)
+				continue;
+
+			pkt = p->pkts[i];
+			port_out_id = RTE_MBUF_METADATA_UINT32(pkt,
+				p->offset_port_id);
+			port_out = &p->ports_out[port_out_id];
+
+			/* Output port user actions, if any */
+			if (!port_out_ah || (port_out->f_action == NULL))
+				/* Output port TX */
+				port_out->ops.f_tx(port_out->h_port, pkt);
+			else {
+				port_out->f_action(p,
+					p->pkts,
+					pkt_mask,
+					port_out->arg_ah);
+
+				RTE_PIPELINE_STATS_AH_DROP_READ(p,
+					port_out->n_pkts_dropped_by_ah);
+
+				/* Output port TX */
+				if (pkt_mask & p->pkts_mask)
+					port_out->ops.f_tx(port_out->h_port,
+						pkt);
+			}
+		}
+	}
+}
+
+static inline void
+rte_pipeline_action_handler_drop(struct rte_pipeline *p, uint64_t pkts_mask)
+{
+	if ((pkts_mask & (pkts_mask + 1)) == 0) {
+		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
+		uint32_t i;
+
+		for (i = 0; i < n_pkts; i++)
+			rte_pktmbuf_free(p->pkts[i]);
+	} else {
+		uint32_t i;
+
+		for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+			uint64_t pkt_mask = 1LLU << i;
+
+			if ((pkt_mask & pkts_mask) == 0)
+				continue;
+
+			rte_pktmbuf_free(p->pkts[i]);
+		}
+	}
+}
+
+/*
+ * Pipeline run stages
+ *
+ * The run function stages take the pipeline configuration flags (presence of
+ * user action handlers) as compile-time constants when invoked from the code
+ * generated by rte_pipeline_codegen(), so that the unused branches are
+ * removed. The generic run function passes them through unchanged, at the
+ * cost of testing them at run-time.
+ */
+static __rte_always_inline void
+rte_pipeline_port_in_start(struct rte_pipeline *p,
+	struct rte_port_in *port_in,
+	uint32_t n_pkts,
+	const int port_in_ah)
+{
+	p->pkts_mask = RTE_LEN2MASK(n_pkts, uint64_t);
+	p->action_mask0[RTE_PIPELINE_ACTION_DROP] = 0;
+	p->action_mask0[RTE_PIPELINE_ACTION_PORT] = 0;
+	p->action_mask0[RTE_PIPELINE_ACTION_PORT_META] = 0;
+	p->action_mask0[RTE_PIPELINE_ACTION_TABLE] = 0;
+
+	/* Input port user actions */
+	if (port_in_ah && (port_in->f_action != NULL)) {
+		port_in->f_action(p, p->pkts, n_pkts, port_in->arg_ah);
+
+		RTE_PIPELINE_STATS_AH_DROP_READ(p,
+			port_in->n_pkts_dropped_by_ah);
+	}
+}
+
+static __rte_always_inline void
+rte_pipeline_table_run(struct rte_pipeline *p,
+	struct rte_table *table,
+	const int lkp_hit_ah,
+	const int lkp_miss_ah,
+	const int port_out_ah)
+{
+	uint64_t lookup_hit_mask, lookup_miss_mask;
+
+	/* Lookup */
+	table->ops.f_lookup(table->h_table, p->pkts, p->pkts_mask,
+		&lookup_hit_mask, (void **) p->entries);
+	lookup_miss_mask = p->pkts_mask & (~lookup_hit_mask);
+
+	/* Lookup miss */
+	if (lookup_miss_mask != 0) {
+		struct rte_pipeline_table_entry *default_entry =
+			table->default_entry;
+
+		p->pkts_mask = lookup_miss_mask;
+
+		/* Table user actions */
+		if (lkp_miss_ah && (table->f_action_miss != NULL)) {
+			table->f_action_miss(p,
+				p->pkts,
+				lookup_miss_mask,
+				default_entry,
+				table->arg_ah);
+
+			RTE_PIPELINE_STATS_AH_DROP_READ(p,
+				table->n_pkts_dropped_by_lkp_miss_ah);
+		}
+
+		/* Table reserved actions */
+		if ((default_entry->action == RTE_PIPELINE_ACTION_PORT) &&
+			(p->pkts_mask != 0))
+			rte_pipeline_action_handler_port_bulk(p,
+				p->pkts_mask,
+				default_entry->port_id,
+				port_out_ah);
+		else {
+			uint32_t pos = default_entry->action;
+
+			RTE_PIPELINE_STATS_TABLE_DROP0(p);
+
+			p->action_mask0[pos] |= p->pkts_mask;
+
+			RTE_PIPELINE_STATS_TABLE_DROP1(p,
+				table->n_pkts_dropped_lkp_miss);
+		}
+	}
+
+	/* Lookup hit */
+	if (lookup_hit_mask != 0) {
+		p->pkts_mask = lookup_hit_mask;
+
+		/* Table user actions */
+		if (lkp_hit_ah && (table->f_action_hit != NULL)) {
+			table->f_action_hit(p,
+				p->pkts,
+				lookup_hit_mask,
+				p->entries,
+				table->arg_ah);
+
+			RTE_PIPELINE_STATS_AH_DROP_READ(p,
+				table->n_pkts_dropped_by_lkp_hit_ah);
+		}
+
+		/* Table reserved actions */
+		RTE_PIPELINE_STATS_TABLE_DROP0(p);
+		rte_pipeline_compute_masks(p, p->pkts_mask);
+		p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
+			p->action_mask1[
+				RTE_PIPELINE_ACTION_DROP];
+		p->action_mask0[RTE_PIPELINE_ACTION_PORT] |=
+			p->action_mask1[
+				RTE_PIPELINE_ACTION_PORT];
+		p->action_mask0[RTE_PIPELINE_ACTION_PORT_META] |=
+			p->action_mask1[
+				RTE_PIPELINE_ACTION_PORT_META];
+		p->action_mask0[RTE_PIPELINE_ACTION_TABLE] |=
+			p->action_mask1[
+				RTE_PIPELINE_ACTION_TABLE];
+
+		RTE_PIPELINE_STATS_TABLE_DROP1(p,
+			table->n_pkts_dropped_lkp_hit);
+	}
+
+	/* Prepare for next iteration */
+	p->pkts_mask = p->action_mask0[RTE_PIPELINE_ACTION_TABLE];
+	p->action_mask0[RTE_PIPELINE_ACTION_TABLE] = 0;
+}
+
+static __rte_always_inline void
+rte_pipeline_port_in_end(struct rte_pipeline *p,
+	struct rte_port_in *port_in,
+	const int port_out_ah)
+{
+	/* Table reserved action PORT */
+	rte_pipeline_action_handler_port(p,
+		p->action_mask0[RTE_PIPELINE_ACTION_PORT],
+		port_out_ah);
+
+	/* Table reserved action PORT META */
+	rte_pipeline_action_handler_port_meta(p,
+		p->action_mask0[RTE_PIPELINE_ACTION_PORT_META],
+		port_out_ah);
+
+	/* Table reserved action DROP */
+	rte_pipeline_action_handler_drop(p,
+		p->action_mask0[RTE_PIPELINE_ACTION_DROP]);
+
+	/* Pick candidate for next port IN to serve */
+	p->port_in_next = port_in->next;
+}
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_RTE_PIPELINE_INTERNAL_H__ */
@@ -9,6 +9,7 @@
 #include <rte_cycles.h>
 #include <rte_malloc.h>
 #include <rte_memcpy.h>
+#include <rte_pause.h>
 #include <rte_ether.h>
 #include <rte_ip.h>
 #include <rte_esp.h>
@@ -109,11 +110,11 @@ mtr_cfg_check(struct rte_table_action_mtr_config *mtr)
 
 #define MBUF_SCHED_QUEUE_TC_COLOR(queue, tc, color)        \
 	((uint16_t)((((uint64_t)(queue)) & 0x3) |          \
-	((((uint64_t)(tc)) & 0x3) << 2) |                  \
-	((((uint64_t)(color)) & 0x3) << 4)))
+	((((uint64_t)(tc)) & 0xF) << 2) |                  \
+	((((uint64_t)(color)) & 0x3) << 6)))
 
 #define MBUF_SCHED_COLOR(sched, color)                     \
-	(((sched) & (~0x30LLU)) | ((color) << 4))
+	(((sched) & (~0xC0LLU)) | ((color) << 6))
 
 struct mtr_trtcm_data {
 	struct rte_meter_trtcm trtcm;
@@ -1531,17 +1532,29 @@ stats_cfg_check(struct rte_table_action_stats_config *stats)
 	return 0;
 }
 
+/*
+ * The counters are only written by the data path. The sequence number is odd
+ * while they are being updated, so the control path can take a consistent
+ * snapshot of them, and their values at the time of the last clear operation
+ * are only written by the control path.
+ */
 struct stats_data {
+	uint64_t seq;
 	uint64_t n_packets;
 	uint64_t n_bytes;
+	uint64_t n_packets_clear;
+	uint64_t n_bytes_clear;
 } __attribute__((__packed__));
 
 static int
 stats_apply(struct stats_data *data,
 	struct rte_table_action_stats_params *p)
 {
+	data->seq = 0;
 	data->n_packets = p->n_packets;
 	data->n_bytes = p->n_bytes;
+	data->n_packets_clear = 0;
+	data->n_bytes_clear = 0;
 
 	return 0;
 }
@@ -1550,8 +1563,41 @@ static __rte_always_inline void
 pkt_work_stats(struct stats_data *data,
 	uint16_t total_length)
 {
+	uint64_t seq = data->seq;
+
+	data->seq = seq + 1;
+	rte_smp_wmb();
+
 	data->n_packets++;
 	data->n_bytes += total_length;
+
+	rte_smp_wmb();
+	data->seq = seq + 2;
+}
+
+static void
+stats_snapshot(struct stats_data *data,
+	uint64_t *n_packets,
+	uint64_t *n_bytes)
+{
+	volatile struct stats_data *d = data;
+	uint64_t seq;
+
+	for ( ; ; ) {
+		seq = d->seq;
+		if (seq & 1) {
+			rte_pause();
+			continue;
+		}
+
+		rte_smp_rmb();
+		*n_packets = d->n_packets;
+		*n_bytes = d->n_bytes;
+		rte_smp_rmb();
+
+		if (d->seq == seq)
+			break;
+	}
 }
 
 /**
@@ -2132,6 +2178,47 @@ pkt4_work_decap(struct rte_mbuf *mbuf0,
 	mbuf3->pkt_len = pkt_len3 - n3;
 }
 
+/**
+ * RTE_TABLE_ACTION_AGE
+ */
+static int
+age_cfg_check(struct rte_table_action_age_config *age)
+{
+	if (age->n_slots == 0)
+		return -EINVAL;
+
+	return 0;
+}
+
+struct age_data {
+	uint32_t slot_id;
+} __attribute__((__packed__));
+
+static int
+age_apply(struct age_data *data,
+	struct rte_table_action_age_params *p,
+	struct rte_table_action_age_config *cfg,
+	uint64_t *age_time,
+	uint64_t *age_timeout)
+{
+	if (p->slot_id >= cfg->n_slots)
+		return -EINVAL;
+
+	data->slot_id = p->slot_id;
+	age_time[p->slot_id] = rte_rdtsc();
+	age_timeout[p->slot_id] = p->timeout;
+
+	return 0;
+}
+
+static __rte_always_inline void
+pkt_work_age(struct age_data *data,
+	uint64_t *age_time,
+	uint64_t time)
+{
+	age_time[data->slot_id] = time;
+}
+
 /**
  * Action profile
  */
@@ -2151,6 +2238,7 @@ action_valid(enum rte_table_action_type action)
 	case RTE_TABLE_ACTION_SYM_CRYPTO:
 	case RTE_TABLE_ACTION_TAG:
 	case RTE_TABLE_ACTION_DECAP:
+	case RTE_TABLE_ACTION_AGE:
 		return 1;
 	default:
 		return 0;
@@ -2171,6 +2259,7 @@ struct ap_config {
 	struct rte_table_action_ttl_config ttl;
 	struct rte_table_action_stats_config stats;
 	struct rte_table_action_sym_crypto_config sym_crypto;
+	struct rte_table_action_age_config age;
 };
 
 static size_t
@@ -2193,6 +2282,8 @@ action_cfg_size(enum rte_table_action_type action)
 		return sizeof(struct rte_table_action_stats_config);
 	case RTE_TABLE_ACTION_SYM_CRYPTO:
 		return sizeof(struct rte_table_action_sym_crypto_config);
+	case RTE_TABLE_ACTION_AGE:
+		return sizeof(struct rte_table_action_age_config);
 	default:
 		return 0;
 	}
@@ -2226,6 +2317,9 @@ action_cfg_get(struct ap_config *ap_config,
 
 	case RTE_TABLE_ACTION_SYM_CRYPTO:
 		return &ap_config->sym_crypto;
+
+	case RTE_TABLE_ACTION_AGE:
+		return &ap_config->age;
 	default:
 		return NULL;
 	}
@@ -2291,6 +2385,9 @@ action_data_size(enum rte_table_action_type action,
 	case RTE_TABLE_ACTION_DECAP:
 		return sizeof(struct decap_data);
 
+	case RTE_TABLE_ACTION_AGE:
+		return sizeof(struct age_data);
+
 	default:
 		return 0;
 	}
@@ -2394,6 +2491,10 @@ rte_table_action_profile_action_register(struct rte_table_action_profile *profil
 		status = sym_crypto_cfg_check(action_config);
 		break;
 
+	case RTE_TABLE_ACTION_AGE:
+		status = age_cfg_check(action_config);
+		break;
+
 	default:
 		status = 0;
 		break;
@@ -2441,6 +2542,14 @@ struct rte_table_action {
 	struct ap_data data;
 	struct dscp_table_data dscp_table;
 	struct meter_profile_data mp[METER_PROFILES_MAX];
+
+	/* Age slots: last hit time and timeout. The last hit time is set to the
+	 * current time by the control path when the aging action is applied,
+	 * then written by the data path on every hit of the rule. The timeout
+	 * is only written by the control path.
+	 */
+	uint64_t *age_time;
+	uint64_t *age_timeout;
 };
 
 struct rte_table_action *
@@ -2466,6 +2575,26 @@ rte_table_action_create(struct rte_table_action_profile *profile,
 	memcpy(&action->cfg, &profile->cfg, sizeof(profile->cfg));
 	memcpy(&action->data, &profile->data, sizeof(profile->data));
 
+	if (action->cfg.action_mask & (1LLU << RTE_TABLE_ACTION_AGE)) {
+		uint32_t n_slots = action->cfg.age.n_slots;
+
+		action->age_time = rte_zmalloc_socket(NULL,
+			n_slots * sizeof(uint64_t),
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+		action->age_timeout = rte_zmalloc_socket(NULL,
+			n_slots * sizeof(uint64_t),
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+		if ((action->age_time == NULL) ||
+			(action->age_timeout == NULL)) {
+			rte_free(action->age_time);
+			rte_free(action->age_timeout);
+			rte_free(action);
+			return NULL;
+		}
+	}
+
 	return action;
 }
 
@@ -2556,6 +2685,13 @@ rte_table_action_apply(struct rte_table_action *action,
 		return decap_apply(action_data,
 			action_params);
 
+	case RTE_TABLE_ACTION_AGE:
+		return age_apply(action_data,
+			action_params,
+			&action->cfg.age,
+			action->age_time,
+			action->age_timeout);
+
 	default:
 		return -EINVAL;
 	}
@@ -2757,6 +2893,7 @@ rte_table_action_stats_read(struct rte_table_action *action,
 	int clear)
 {
 	struct stats_data *stats_data;
+	uint64_t n_packets, n_bytes;
 
 	/* Check input arguments */
 	if ((action == NULL) ||
@@ -2768,18 +2905,20 @@ rte_table_action_stats_read(struct rte_table_action *action,
 	stats_data = action_data_get(data, action,
 		RTE_TABLE_ACTION_STATS);
 
+	stats_snapshot(stats_data, &n_packets, &n_bytes);
+
 	/* Read */
 	if (stats) {
-		stats->n_packets = stats_data->n_packets;
-		stats->n_bytes = stats_data->n_bytes;
+		stats->n_packets = n_packets - stats_data->n_packets_clear;
+		stats->n_bytes = n_bytes - stats_data->n_bytes_clear;
 		stats->n_packets_valid = 1;
 		stats->n_bytes_valid = 1;
 	}
 
 	/* Clear */
 	if (clear) {
-		stats_data->n_packets = 0;
-		stats_data->n_bytes = 0;
+		stats_data->n_packets_clear = n_packets;
+		stats_data->n_bytes_clear = n_bytes;
 	}
 
 	return 0;
@@ -2808,6 +2947,69 @@ rte_table_action_time_read(struct rte_table_action *action,
 	return 0;
 }
 
+int
+rte_table_action_age_scan(struct rte_table_action *action,
+	uint64_t time,
+	uint32_t *pos,
+	uint32_t n_slots,
+	uint32_t *slot_ids,
+	uint32_t n_slot_ids)
+{
+	volatile uint64_t *age_time;
+	uint32_t slot_id, n_slots_max, n_expired, i;
+
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_AGE)) == 0) ||
+		(pos == NULL) ||
+		(*pos >= action->cfg.age.n_slots) ||
+		(slot_ids == NULL))
+		return -EINVAL;
+
+	age_time = action->age_time;
+	n_slots_max = action->cfg.age.n_slots;
+	slot_id = *pos;
+	n_expired = 0;
+
+	for (i = 0; (i < n_slots) && (n_expired < n_slot_ids); i++) {
+		uint64_t timeout = action->age_timeout[slot_id];
+
+		/* The data path may have written a hit time more recent
+		 * than the scan time
+		 */
+		if (timeout && ((int64_t)(time - age_time[slot_id]) >
+			(int64_t)timeout)) {
+			action->age_timeout[slot_id] = 0;
+			slot_ids[n_expired++] = slot_id;
+		}
+
+		slot_id++;
+		if (slot_id == n_slots_max)
+			slot_id = 0;
+	}
+
+	*pos = slot_id;
+
+	return n_expired;
+}
+
+int
+rte_table_action_age_disarm(struct rte_table_action *action,
+	uint32_t slot_id)
+{
+	/* Check input arguments */
+	if ((action == NULL) ||
+		((action->cfg.action_mask &
+		(1LLU << RTE_TABLE_ACTION_AGE)) == 0) ||
+		(slot_id >= action->cfg.age.n_slots))
+		return -EINVAL;
+
+	action->age_timeout[slot_id] = 0;
+
+	return 0;
+}
+
 struct rte_cryptodev_sym_session *
 rte_table_action_crypto_sym_session_get(struct rte_table_action *action,
 	void *data)
@@ -2832,7 +3034,8 @@ pkt_work(struct rte_mbuf *mbuf,
 	struct rte_pipeline_table_entry *table_entry,
 	uint64_t time,
 	struct rte_table_action *action,
-	struct ap_config *cfg)
+	struct ap_config *cfg,
+	const uint64_t action_mask)
 {
 	uint64_t drop_mask = 0;
 
@@ -2855,7 +3058,7 @@ pkt_work(struct rte_mbuf *mbuf,
 			rte_ntohs(hdr->payload_len) + sizeof(struct ipv6_hdr);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_LB)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_LB)) {
 		void *data =
 			action_data_get(table_entry, action, RTE_TABLE_ACTION_LB);
 
@@ -2863,7 +3066,7 @@ pkt_work(struct rte_mbuf *mbuf,
 			data,
 			&cfg->lb);
 	}
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_MTR)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_MTR)) {
 		void *data =
 			action_data_get(table_entry, action, RTE_TABLE_ACTION_MTR);
 
@@ -2876,7 +3079,7 @@ pkt_work(struct rte_mbuf *mbuf,
 			total_length);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_TM)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TM)) {
 		void *data =
 			action_data_get(table_entry, action, RTE_TABLE_ACTION_TM);
 
@@ -2886,7 +3089,7 @@ pkt_work(struct rte_mbuf *mbuf,
 			dscp);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_DECAP)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_DECAP)) {
 		void *data = action_data_get(table_entry,
 			action,
 			RTE_TABLE_ACTION_DECAP);
@@ -2894,7 +3097,7 @@ pkt_work(struct rte_mbuf *mbuf,
 		pkt_work_decap(mbuf, data);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_ENCAP)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_ENCAP)) {
 		void *data =
 			action_data_get(table_entry, action, RTE_TABLE_ACTION_ENCAP);
 
@@ -2906,7 +3109,7 @@ pkt_work(struct rte_mbuf *mbuf,
 			ip_offset);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_NAT)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_NAT)) {
 		void *data =
 			action_data_get(table_entry, action, RTE_TABLE_ACTION_NAT);
 
@@ -2916,7 +3119,7 @@ pkt_work(struct rte_mbuf *mbuf,
 			pkt_ipv6_work_nat(ip, data, &cfg->nat);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_TTL)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TTL)) {
 		void *data =
 			action_data_get(table_entry, action, RTE_TABLE_ACTION_TTL);
 
@@ -2926,21 +3129,28 @@ pkt_work(struct rte_mbuf *mbuf,
 			drop_mask |= pkt_ipv6_work_ttl(ip, data);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_STATS)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_STATS)) {
 		void *data =
 			action_data_get(table_entry, action, RTE_TABLE_ACTION_STATS);
 
 		pkt_work_stats(data, total_length);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_TIME)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TIME)) {
 		void *data =
 			action_data_get(table_entry, action, RTE_TABLE_ACTION_TIME);
 
 		pkt_work_time(data, time);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_SYM_CRYPTO)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_AGE)) {
+		void *data =
+			action_data_get(table_entry, action, RTE_TABLE_ACTION_AGE);
+
+		pkt_work_age(data, action->age_time, time);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_SYM_CRYPTO)) {
 		void *data = action_data_get(table_entry, action,
 				RTE_TABLE_ACTION_SYM_CRYPTO);
 
@@ -2948,7 +3158,7 @@ pkt_work(struct rte_mbuf *mbuf,
 				ip_offset);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_TAG)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TAG)) {
 		void *data = action_data_get(table_entry,
 			action,
 			RTE_TABLE_ACTION_TAG);
@@ -2964,7 +3174,8 @@ pkt4_work(struct rte_mbuf **mbufs,
 	struct rte_pipeline_table_entry **table_entries,
 	uint64_t time,
 	struct rte_table_action *action,
-	struct ap_config *cfg)
+	struct ap_config *cfg,
+	const uint64_t action_mask)
 {
 	uint64_t drop_mask0 = 0;
 	uint64_t drop_mask1 = 0;
@@ -3026,7 +3237,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 			rte_ntohs(hdr3->payload_len) + sizeof(struct ipv6_hdr);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_LB)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_LB)) {
 		void *data0 =
 			action_data_get(table_entry0, action, RTE_TABLE_ACTION_LB);
 		void *data1 =
@@ -3053,7 +3264,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 			&cfg->lb);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_MTR)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_MTR)) {
 		void *data0 =
 			action_data_get(table_entry0, action, RTE_TABLE_ACTION_MTR);
 		void *data1 =
@@ -3096,7 +3307,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 			total_length3);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_TM)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TM)) {
 		void *data0 =
 			action_data_get(table_entry0, action, RTE_TABLE_ACTION_TM);
 		void *data1 =
@@ -3127,7 +3338,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 			dscp3);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_DECAP)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_DECAP)) {
 		void *data0 = action_data_get(table_entry0,
 			action,
 			RTE_TABLE_ACTION_DECAP);
@@ -3145,7 +3356,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 			data0, data1, data2, data3);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_ENCAP)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_ENCAP)) {
 		void *data0 =
 			action_data_get(table_entry0, action, RTE_TABLE_ACTION_ENCAP);
 		void *data1 =
@@ -3184,7 +3395,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 			ip_offset);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_NAT)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_NAT)) {
 		void *data0 =
 			action_data_get(table_entry0, action, RTE_TABLE_ACTION_NAT);
 		void *data1 =
@@ -3207,7 +3418,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 		}
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_TTL)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TTL)) {
 		void *data0 =
 			action_data_get(table_entry0, action, RTE_TABLE_ACTION_TTL);
 		void *data1 =
@@ -3230,7 +3441,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 		}
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_STATS)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_STATS)) {
 		void *data0 =
 			action_data_get(table_entry0, action, RTE_TABLE_ACTION_STATS);
 		void *data1 =
@@ -3246,7 +3457,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 		pkt_work_stats(data3, total_length3);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_TIME)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TIME)) {
 		void *data0 =
 			action_data_get(table_entry0, action, RTE_TABLE_ACTION_TIME);
 		void *data1 =
@@ -3262,7 +3473,23 @@ pkt4_work(struct rte_mbuf **mbufs,
 		pkt_work_time(data3, time);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_SYM_CRYPTO)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_AGE)) {
+		void *data0 =
+			action_data_get(table_entry0, action, RTE_TABLE_ACTION_AGE);
+		void *data1 =
+			action_data_get(table_entry1, action, RTE_TABLE_ACTION_AGE);
+		void *data2 =
+			action_data_get(table_entry2, action, RTE_TABLE_ACTION_AGE);
+		void *data3 =
+			action_data_get(table_entry3, action, RTE_TABLE_ACTION_AGE);
+
+		pkt_work_age(data0, action->age_time, time);
+		pkt_work_age(data1, action->age_time, time);
+		pkt_work_age(data2, action->age_time, time);
+		pkt_work_age(data3, action->age_time, time);
+	}
+
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_SYM_CRYPTO)) {
 		void *data0 = action_data_get(table_entry0, action,
 				RTE_TABLE_ACTION_SYM_CRYPTO);
 		void *data1 = action_data_get(table_entry1, action,
@@ -3282,7 +3509,7 @@ pkt4_work(struct rte_mbuf **mbufs,
 				ip_offset);
 	}
 
-	if (cfg->action_mask & (1LLU << RTE_TABLE_ACTION_TAG)) {
+	if (action_mask & (1LLU << RTE_TABLE_ACTION_TAG)) {
 		void *data0 = action_data_get(table_entry0,
 			action,
 			RTE_TABLE_ACTION_TAG);
@@ -3312,13 +3539,15 @@ ah(struct rte_pipeline *p,
 	uint64_t pkts_mask,
 	struct rte_pipeline_table_entry **entries,
 	struct rte_table_action *action,
-	struct ap_config *cfg)
+	struct ap_config *cfg,
+	const uint64_t action_mask)
 {
 	uint64_t pkts_drop_mask = 0;
 	uint64_t time = 0;
 
-	if (cfg->action_mask & ((1LLU << RTE_TABLE_ACTION_MTR) |
-		(1LLU << RTE_TABLE_ACTION_TIME)))
+	if (action_mask & ((1LLU << RTE_TABLE_ACTION_MTR) |
+		(1LLU << RTE_TABLE_ACTION_TIME) |
+		(1LLU << RTE_TABLE_ACTION_AGE)))
 		time = rte_rdtsc();
 
 	if ((pkts_mask & (pkts_mask + 1)) == 0) {
@@ -3332,7 +3561,8 @@ ah(struct rte_pipeline *p,
 				&entries[i],
 				time,
 				action,
-				cfg);
+				cfg,
+				action_mask);
 
 			pkts_drop_mask |= drop_mask << i;
 		}
@@ -3344,7 +3574,8 @@ ah(struct rte_pipeline *p,
 				entries[i],
 				time,
 				action,
-				cfg);
+				cfg,
+				action_mask);
 
 			pkts_drop_mask |= drop_mask << i;
 		}
@@ -3358,7 +3589,8 @@ ah(struct rte_pipeline *p,
 				entries[pos],
 				time,
 				action,
-				cfg);
+				cfg,
+				action_mask);
 
 			pkts_mask &= ~pkt_mask;
 			pkts_drop_mask |= drop_mask << pos;
@@ -3383,15 +3615,73 @@ ah_default(struct rte_pipeline *p,
 		pkts_mask,
 		entries,
 		action,
-		&action->cfg);
+		&action->cfg,
+		action->cfg.action_mask);
 }
 
+/*
+ * Action handlers specialized for the most common action profiles: with the
+ * set of actions known at build time, the checks of the actions that are not
+ * part of the profile are removed from the packet processing.
+ */
+#define AH_SPECIALIZED(name, mask)					\
+static int								\
+ah_##name(struct rte_pipeline *p,					\
+	struct rte_mbuf **pkts,						\
+	uint64_t pkts_mask,						\
+	struct rte_pipeline_table_entry **entries,			\
+	void *arg)							\
+{									\
+	struct rte_table_action *action = arg;				\
+									\
+	return ah(p,							\
+		pkts,							\
+		pkts_mask,						\
+		entries,						\
+		action,							\
+		&action->cfg,						\
+		mask);							\
+}
+
+#define AP_MASK(a)                   (1LLU << RTE_TABLE_ACTION_##a)
+
+#define AP_FWD_LB                    (AP_MASK(FWD) | AP_MASK(LB))
+#define AP_FWD_STATS                 (AP_MASK(FWD) | AP_MASK(STATS))
+#define AP_FWD_ENCAP                 (AP_MASK(FWD) | AP_MASK(ENCAP))
+#define AP_FWD_ENCAP_TTL_STATS       (AP_FWD_ENCAP | AP_MASK(TTL) | \
+	AP_MASK(STATS))
+#define AP_FWD_MTR_TM_STATS          (AP_FWD_STATS | AP_MASK(MTR) | \
+	AP_MASK(TM))
+
+AH_SPECIALIZED(fwd_lb, AP_FWD_LB)
+AH_SPECIALIZED(fwd_stats, AP_FWD_STATS)
+AH_SPECIALIZED(fwd_encap, AP_FWD_ENCAP)
+AH_SPECIALIZED(fwd_encap_ttl_stats, AP_FWD_ENCAP_TTL_STATS)
+AH_SPECIALIZED(fwd_mtr_tm_stats, AP_FWD_MTR_TM_STATS)
+
+static const struct {
+	uint64_t action_mask;
+	rte_pipeline_table_action_handler_hit f_action;
+} ah_specialized[] = {
+	{AP_FWD_LB, ah_fwd_lb},
+	{AP_FWD_STATS, ah_fwd_stats},
+	{AP_FWD_ENCAP, ah_fwd_encap},
+	{AP_FWD_ENCAP_TTL_STATS, ah_fwd_encap_ttl_stats},
+	{AP_FWD_MTR_TM_STATS, ah_fwd_mtr_tm_stats},
+};
+
 static rte_pipeline_table_action_handler_hit
 ah_selector(struct rte_table_action *action)
 {
+	uint32_t i;
+
 	if (action->cfg.action_mask == (1LLU << RTE_TABLE_ACTION_FWD))
 		return NULL;
 
+	for (i = 0; i < RTE_DIM(ah_specialized); i++)
+		if (action->cfg.action_mask == ah_specialized[i].action_mask)
+			return ah_specialized[i].f_action;
+
 	return ah_default;
 }
 
@@ -3426,6 +3716,8 @@ rte_table_action_free(struct rte_table_action *action)
 	if (action == NULL)
 		return 0;
 
+	rte_free(action->age_time);
+	rte_free(action->age_timeout);
 	rte_free(action);
 
 	return 0;
@@ -102,6 +102,9 @@ enum rte_table_action_type {
 
 	/** Packet decapsulations. */
 	RTE_TABLE_ACTION_DECAP,
+
+	/** Rule aging. */
+	RTE_TABLE_ACTION_AGE,
 };
 
 /** Common action configuration (per table action profile). */
@@ -665,7 +668,12 @@ struct rte_table_action_stats_params {
 	uint64_t n_bytes;
 };
 
-/** Stats action counters (per table rule). */
+/** Stats action counters (per table rule).
+ *
+ * The counters are read as a consistent snapshot while the data path keeps
+ * updating them, and they are cleared by the control path without writing the
+ * data path counters, so no packets are lost from the counters.
+ */
 struct rte_table_action_stats_counters {
 	/** Number of packets. Valid only when *n_packets_valid* is non-zero. */
 	uint64_t n_packets;
@@ -689,6 +697,31 @@ struct rte_table_action_time_params {
 	uint64_t time;
 };
 
+/**
+ * RTE_TABLE_ACTION_AGE
+ */
+/** Aging action configuration (per table action profile). */
+struct rte_table_action_age_config {
+	/** Number of age slots. Each rule with the aging action has its own
+	 * age slot, so this is the maximum number of rules to be aged. Has to
+	 * be non-zero.
+	 */
+	uint32_t n_slots;
+};
+
+/** Aging action parameters (per table rule). */
+struct rte_table_action_age_params {
+	/** Age slot of the rule. Has to be smaller than the *n_slots* of the
+	 * aging action configuration.
+	 */
+	uint32_t slot_id;
+
+	/** Timeout (in CPU cycles). The rule expires when it is not hit for
+	 * more than *timeout* cycles. When zero, the rule never expires.
+	 */
+	uint64_t timeout;
+};
+
 /**
  * RTE_TABLE_ACTION_CRYPTO
  */
@@ -1087,6 +1120,67 @@ rte_table_action_time_read(struct rte_table_action *action,
 	void *data,
 	uint64_t *timestamp);
 
+/**
+ * Table action age scan.
+ *
+ * Scans the age slots of the *action* object for expired rules, so the rules
+ * to be aged out are found without walking through the table. The age slot
+ * of a rule is set to the current time when the aging action is applied on
+ * the rule, then the thread running the pipeline records the last hit time
+ * of the rule into it. The age slots are only read by this function. A hit
+ * time more recent than *time* never makes a rule expire. The age slots are
+ * scanned in batches: up to *n_slots* age slots are scanned per call,
+ * starting with age slot **pos*, and **pos* is updated for the next call to
+ * continue from where this one stopped, wrapping around to the first age slot
+ * after the last one.
+ *
+ * Every expired age slot is reported once: its timeout is cleared, so it is
+ * no longer scanned until the aging action is applied again on a rule using
+ * it.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @param[in] time
+ *   Current time (in CPU cycles), typically read with rte_rdtsc().
+ * @param[inout] pos
+ *   Age slot to start the scan with.
+ * @param[in] n_slots
+ *   Maximum number of age slots to scan.
+ * @param[out] slot_ids
+ *   Pre-allocated array where the IDs of the expired age slots are saved.
+ * @param[in] n_slot_ids
+ *   Number of elements of *slot_ids*. The scan stops once *slot_ids* is full.
+ * @return
+ *   Number of expired age slots saved to *slot_ids* on success, negative
+ *   error code otherwise.
+ */
+int __rte_experimental
+rte_table_action_age_scan(struct rte_table_action *action,
+	uint64_t time,
+	uint32_t *pos,
+	uint32_t n_slots,
+	uint32_t *slot_ids,
+	uint32_t n_slot_ids);
+
+/**
+ * Table action age disarm.
+ *
+ * Stops the aging of the rule using age slot *slot_id*, typically when the
+ * rule is deleted from the table, so that the age slot is no longer reported
+ * by rte_table_action_age_scan(). The age slot can be used by another rule
+ * once the aging action is applied on it.
+ *
+ * @param[in] action
+ *   Handle to table action object (needs to be valid).
+ * @param[in] slot_id
+ *   Age slot to disarm.
+ * @return
+ *   Zero on success, non-zero error code otherwise.
+ */
+int __rte_experimental
+rte_table_action_age_disarm(struct rte_table_action *action,
+	uint32_t slot_id);
+
 /**
  * Table action cryptodev symmetric session get.
  *
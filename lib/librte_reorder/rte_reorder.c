@@ -3,13 +3,17 @@
  */
 
 #include <inttypes.h>
+#include <stddef.h>
 #include <string.h>
 
+#include <rte_atomic.h>
 #include <rte_log.h>
 #include <rte_mbuf.h>
 #include <rte_eal_memconfig.h>
 #include <rte_errno.h>
 #include <rte_malloc.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_pause.h>
 
 #include "rte_reorder.h"
 
@@ -27,6 +31,9 @@ EAL_REGISTER_TAILQ(rte_reorder_tailq)
 /* Macros for printing using RTE_LOG */
 #define RTE_LOGTYPE_REORDER	RTE_LOGTYPE_USER1
 
+/* is_initialized state while the first MP inserter sets min_seqn */
+#define REORDER_INITIALIZING 2
+
 /* A generic circular buffer */
 struct cir_buffer {
 	unsigned int size;   /**< Number of entries that can be stored */
@@ -44,8 +51,19 @@ struct rte_reorder_buffer {
 	struct cir_buffer ready_buf; /**< temp buffer for dequeued entries */
 	struct cir_buffer order_buf; /**< buffer used to reorder entries */
 	int is_initialized;
+	uint32_t flags; /**< RTE_REORDER_F_* flags */
+	int seqn_offset; /**< offset of the sequence number in the mbuf */
+	uint32_t skip_seqn; /**< MP: drain skips gaps up to this seq. number */
+	uint64_t dropped; /**< seq. numbers skipped without a packet */
+	rte_atomic64_t late; /**< packets behind the window */
 } __rte_cache_aligned;
 
+static inline uint32_t
+reorder_seqn(const struct rte_reorder_buffer *b, const struct rte_mbuf *mbuf)
+{
+	return *RTE_MBUF_DYNFIELD(mbuf, b->seqn_offset, const uint32_t *);
+}
+
 static void
 rte_reorder_free_mbufs(struct rte_reorder_buffer *b);
 
@@ -84,6 +102,7 @@ rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
 	memset(b, 0, bufsize);
 	snprintf(b->name, sizeof(b->name), "%s", name);
 	b->memsize = bufsize;
+	b->seqn_offset = offsetof(struct rte_mbuf, seqn);
 	b->order_buf.size = b->ready_buf.size = size;
 	b->order_buf.mask = b->ready_buf.mask = size - 1;
 	b->ready_buf.entries = (void *)&b[1];
@@ -93,18 +112,42 @@ rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
 	return b;
 }
 
-struct rte_reorder_buffer*
-rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
+struct rte_reorder_buffer* __rte_experimental
+rte_reorder_create_with_params(const struct rte_reorder_params *params)
 {
 	struct rte_reorder_buffer *b = NULL;
 	struct rte_tailq_entry *te;
 	struct rte_reorder_list *reorder_list;
-	const unsigned int bufsize = sizeof(struct rte_reorder_buffer) +
-					(2 * size * sizeof(struct rte_mbuf *));
+	const char *name;
+	unsigned int size, bufsize;
 
 	reorder_list = RTE_TAILQ_CAST(rte_reorder_tailq.head, rte_reorder_list);
 
 	/* Check user arguments. */
+	if (params == NULL) {
+		RTE_LOG(ERR, REORDER, "Invalid reorder buffer parameters:"
+					" NULL\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	name = params->name;
+	size = params->size;
+	bufsize = sizeof(struct rte_reorder_buffer) +
+			(2 * size * sizeof(struct rte_mbuf *));
+
+	if (params->flags & ~RTE_REORDER_F_MP_INSERT) {
+		RTE_LOG(ERR, REORDER, "Invalid reorder buffer flags: %#x\n",
+				params->flags);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (params->seqn_offset >= 0 && (size_t)params->seqn_offset +
+			sizeof(uint32_t) > sizeof(struct rte_mbuf)) {
+		RTE_LOG(ERR, REORDER, "Invalid sequence number offset: %d\n",
+				params->seqn_offset);
+		rte_errno = EINVAL;
+		return NULL;
+	}
 	if (!rte_is_power_of_2(size)) {
 		RTE_LOG(ERR, REORDER, "Invalid reorder buffer size"
 				" - Not a power of 2\n");
@@ -139,13 +182,17 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 	}
 
 	/* Allocate memory to store the reorder buffer structure. */
-	b = rte_zmalloc_socket("REORDER_BUFFER", bufsize, 0, socket_id);
+	b = rte_zmalloc_socket("REORDER_BUFFER", bufsize, 0,
+			params->socket_id);
 	if (b == NULL) {
 		RTE_LOG(ERR, REORDER, "Memzone allocation failed\n");
 		rte_errno = ENOMEM;
 		rte_free(te);
 	} else {
 		rte_reorder_init(b, bufsize, name, size);
+		b->flags = params->flags;
+		if (params->seqn_offset >= 0)
+			b->seqn_offset = params->seqn_offset;
 		te->data = (void *)b;
 		TAILQ_INSERT_TAIL(reorder_list, te, next);
 	}
@@ -155,15 +202,33 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 	return b;
 }
 
+struct rte_reorder_buffer*
+rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
+{
+	struct rte_reorder_params params = {
+		.name = name,
+		.socket_id = socket_id,
+		.size = size,
+		.flags = 0,
+		.seqn_offset = -1,
+	};
+
+	return rte_reorder_create_with_params(&params);
+}
+
 void
 rte_reorder_reset(struct rte_reorder_buffer *b)
 {
 	char name[RTE_REORDER_NAMESIZE];
+	uint32_t flags = b->flags;
+	int seqn_offset = b->seqn_offset;
 
 	rte_reorder_free_mbufs(b);
 	snprintf(name, sizeof(name), "%s", b->name);
 	/* No error checking as current values should be valid */
 	rte_reorder_init(b, b->memsize, name, b->order_buf.size);
+	b->flags = flags;
+	b->seqn_offset = seqn_offset;
 }
 
 static void
@@ -175,9 +240,11 @@ rte_reorder_free_mbufs(struct rte_reorder_buffer *b)
 	for (i = 0; i < b->order_buf.size; i++) {
 		if (b->order_buf.entries[i])
 			rte_pktmbuf_free(b->order_buf.entries[i]);
-		if (b->ready_buf.entries[i])
-			rte_pktmbuf_free(b->ready_buf.entries[i]);
 	}
+	/* drained entries of the ready buffer are not cleared */
+	for (i = b->ready_buf.tail; i != b->ready_buf.head;
+			i = (i + 1) & b->ready_buf.mask)
+		rte_pktmbuf_free(b->ready_buf.entries[i]);
 }
 
 void
@@ -266,6 +333,7 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 		if (order_buf->entries[order_buf->head] == NULL) {
 			order_buf->head = (order_buf->head + 1) & order_buf->mask;
 			order_head_adv++;
+			b->dropped++;
 		}
 
 		/* Move all ready entries that fit to the ready_buf */
@@ -290,14 +358,108 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 	return order_head_adv;
 }
 
+/*
+ * The first inserter sets the start of the sequence, the others wait for
+ * it to be published.
+ */
+static void
+reorder_mp_init_seqn(struct rte_reorder_buffer *b, uint32_t seqn)
+{
+	int state = 0;
+
+	if (__atomic_compare_exchange_n(&b->is_initialized, &state,
+			REORDER_INITIALIZING, 0, __ATOMIC_ACQUIRE,
+			__ATOMIC_RELAXED)) {
+		b->min_seqn = seqn;
+		b->skip_seqn = seqn;
+		__atomic_store_n(&b->is_initialized, 1, __ATOMIC_RELEASE);
+		return;
+	}
+
+	while (__atomic_load_n(&b->is_initialized, __ATOMIC_ACQUIRE) != 1)
+		rte_pause();
+}
+
+/*
+ * Multi-producer insert: the mbuf goes to the slot of its sequence number
+ * in order_buf, claimed with a compare-and-swap. Only the consumer moves
+ * the window, so an early mbuf records how far the window must move and
+ * is rejected until the next drain.
+ */
+static int
+reorder_mp_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+{
+	struct cir_buffer *order_buf = &b->order_buf;
+	const uint32_t seqn = reorder_seqn(b, mbuf);
+	struct rte_mbuf *expected = NULL;
+	struct rte_mbuf **slot;
+	uint32_t offset, skip, cur;
+
+	if (unlikely(__atomic_load_n(&b->is_initialized,
+			__ATOMIC_ACQUIRE) != 1))
+		reorder_mp_init_seqn(b, seqn);
+
+	/* The subtraction takes care of the sequence number wrapping */
+	offset = seqn - __atomic_load_n(&b->min_seqn, __ATOMIC_ACQUIRE);
+
+	if ((int32_t)offset < 0) {
+		rte_atomic64_inc(&b->late);
+		rte_errno = ERANGE;
+		return -1;
+	} else if (offset >= 2 * order_buf->size) {
+		rte_errno = ERANGE;
+		return -1;
+	} else if (offset >= order_buf->size) {
+		skip = seqn - order_buf->size + 1;
+		cur = __atomic_load_n(&b->skip_seqn, __ATOMIC_RELAXED);
+		while ((int32_t)(skip - cur) > 0 &&
+				!__atomic_compare_exchange_n(&b->skip_seqn,
+					&cur, skip, 0, __ATOMIC_RELEASE,
+					__ATOMIC_RELAXED))
+			;
+		rte_errno = ENOSPC;
+		return -1;
+	}
+
+	slot = &order_buf->entries[seqn & order_buf->mask];
+	if (!__atomic_compare_exchange_n(slot, &expected, mbuf, 0,
+			__ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+		rte_errno = EEXIST;
+		return -1;
+	}
+
+	/*
+	 * If the consumer skipped this sequence number meanwhile, take the
+	 * mbuf back unless it was drained already. The consumer looks at the
+	 * slot again once it has published the skip, so a mbuf is never
+	 * left behind in a slot it has moved past.
+	 */
+	offset = seqn - __atomic_load_n(&b->min_seqn, __ATOMIC_SEQ_CST);
+	if (unlikely((int32_t)offset < 0)) {
+		expected = mbuf;
+		if (__atomic_compare_exchange_n(slot, &expected, NULL, 0,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			rte_atomic64_inc(&b->late);
+			rte_errno = ERANGE;
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 int
 rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 {
-	uint32_t offset, position;
+	uint32_t offset, position, seqn;
 	struct cir_buffer *order_buf = &b->order_buf;
 
+	if (b->flags & RTE_REORDER_F_MP_INSERT)
+		return reorder_mp_insert(b, mbuf);
+
+	seqn = reorder_seqn(b, mbuf);
 	if (!b->is_initialized) {
-		b->min_seqn = mbuf->seqn;
+		b->min_seqn = seqn;
 		b->is_initialized = 1;
 	}
 
@@ -309,7 +471,7 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 	 *	mbuf_seqn = 0x0010
 	 *	offset    = 0x0010 - 0xFFFD = 0x13
 	 */
-	offset = mbuf->seqn - b->min_seqn;
+	offset = seqn - b->min_seqn;
 
 	/*
 	 * action to take depends on offset.
@@ -339,17 +501,82 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 			rte_errno = ENOSPC;
 			return -1;
 		}
-		offset = mbuf->seqn - b->min_seqn;
+		offset = seqn - b->min_seqn;
 		position = (order_buf->head + offset) & order_buf->mask;
 		order_buf->entries[position] = mbuf;
 	} else {
 		/* Put in handling for enqueue straight to output */
+		if ((int32_t)offset < 0)
+			rte_atomic64_inc(&b->late);
 		rte_errno = ERANGE;
 		return -1;
 	}
 	return 0;
 }
 
+/*
+ * Single consumer drain of a multi-producer buffer: take mbufs from the
+ * slot of the next sequence number, skipping empty slots as long as an
+ * early insert asked the window to move. A skip is published before the
+ * skipped slot is cleared a second time, so an insert racing with it
+ * either takes its mbuf back or has it drained here as late. A mbuf whose
+ * sequence number is not the one of the slot is drained as late as well,
+ * without moving the window.
+ */
+static unsigned int
+reorder_mp_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
+		unsigned int max_mbufs)
+{
+	struct cir_buffer *order_buf = &b->order_buf;
+	uint32_t min_seqn = b->min_seqn;
+	unsigned int drain_cnt = 0;
+	struct rte_mbuf **slot;
+	struct rte_mbuf *mbuf;
+	uint32_t skip_seqn;
+
+	if (__atomic_load_n(&b->is_initialized, __ATOMIC_ACQUIRE) != 1)
+		return 0;
+
+	skip_seqn = __atomic_load_n(&b->skip_seqn, __ATOMIC_ACQUIRE);
+
+	while (drain_cnt < max_mbufs) {
+		slot = &order_buf->entries[min_seqn & order_buf->mask];
+		mbuf = __atomic_exchange_n(slot, NULL, __ATOMIC_ACQUIRE);
+		if (mbuf != NULL) {
+			mbufs[drain_cnt++] = mbuf;
+			if (unlikely(reorder_seqn(b, mbuf) != min_seqn)) {
+				/*
+				 * inserted by a producer that stalled while
+				 * the window moved a full size past its
+				 * sequence number: return it as late and look
+				 * at the slot again
+				 */
+				rte_atomic64_inc(&b->late);
+				continue;
+			}
+			min_seqn++;
+			continue;
+		}
+
+		if ((int32_t)(skip_seqn - min_seqn) <= 0)
+			break;
+
+		b->dropped++;
+		min_seqn++;
+		__atomic_store_n(&b->min_seqn, min_seqn, __ATOMIC_SEQ_CST);
+		mbuf = __atomic_exchange_n(slot, NULL, __ATOMIC_SEQ_CST);
+		if (unlikely(mbuf != NULL)) {
+			/* inserted while the sequence number was skipped */
+			rte_atomic64_inc(&b->late);
+			mbufs[drain_cnt++] = mbuf;
+		}
+	}
+
+	__atomic_store_n(&b->min_seqn, min_seqn, __ATOMIC_SEQ_CST);
+
+	return drain_cnt;
+}
+
 unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs)
@@ -359,6 +586,9 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 	struct cir_buffer *order_buf = &b->order_buf,
 			*ready_buf = &b->ready_buf;
 
+	if (b->flags & RTE_REORDER_F_MP_INSERT)
+		return reorder_mp_drain(b, mbufs, max_mbufs);
+
 	/* Try to fetch requested number of mbufs from ready buffer */
 	while ((drain_cnt < max_mbufs) && (ready_buf->tail != ready_buf->head)) {
 		mbufs[drain_cnt++] = ready_buf->entries[ready_buf->tail];
@@ -379,3 +609,16 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 
 	return drain_cnt;
 }
+
+int __rte_experimental
+rte_reorder_stats_get(struct rte_reorder_buffer *b,
+		struct rte_reorder_stats *stats)
+{
+	if (b == NULL || stats == NULL)
+		return -EINVAL;
+
+	stats->late = rte_atomic64_read(&b->late);
+	stats->dropped = b->dropped;
+
+	return 0;
+}
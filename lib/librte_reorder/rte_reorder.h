@@ -15,6 +15,7 @@
  *
  */
 
+#include <rte_compat.h>
 #include <rte_mbuf.h>
 
 #ifdef __cplusplus
@@ -23,6 +24,36 @@ extern "C" {
 
 struct rte_reorder_buffer;
 
+/**
+ * Reorder buffer flag: several lcores may call rte_reorder_insert()
+ * concurrently, while a single lcore drains the buffer.
+ */
+#define RTE_REORDER_F_MP_INSERT 0x1
+
+/** Parameters of rte_reorder_create_with_params() */
+struct rte_reorder_params {
+	const char *name;      /**< Name of the reorder buffer instance */
+	int socket_id;         /**< NUMA node to allocate the buffer on */
+	unsigned int size;     /**< Number of elements, a power of 2 */
+	uint32_t flags;        /**< RTE_REORDER_F_* flags */
+	int seqn_offset;
+	/**< Offset in the mbuf of the 32-bit sequence number, e.g. as
+	 * returned by rte_mbuf_dynfield_register(). A negative value
+	 * selects the mbuf seqn field.
+	 */
+};
+
+/** Reorder buffer statistics */
+struct rte_reorder_stats {
+	uint64_t late;
+	/**< Packets that arrived after the window moved past them. They
+	 * are rejected by rte_reorder_insert() or, with
+	 * RTE_REORDER_F_MP_INSERT, possibly drained out of order.
+	 */
+	uint64_t dropped;
+	/**< Sequence numbers the window skipped without a packet */
+};
+
 /**
  * Create a new reorder buffer instance
  *
@@ -45,6 +76,32 @@ struct rte_reorder_buffer;
 struct rte_reorder_buffer *
 rte_reorder_create(const char *name, unsigned socket_id, unsigned int size);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a new reorder buffer instance, selecting where the sequence
+ * number is read from and whether inserts may be concurrent.
+ *
+ * With RTE_REORDER_F_MP_INSERT, packets are stored in a slot array
+ * indexed by sequence number with atomic operations, so any number of
+ * lcores may insert while one lcore drains. The window only moves on
+ * drain: an early packet makes rte_reorder_insert() fail with ENOSPC
+ * and the next drain skips the missing sequence numbers it waits for,
+ * after which the insert can be retried. The first inserted packet sets
+ * the start of the sequence.
+ *
+ * @param params
+ *   Parameters of the reorder buffer
+ * @return
+ *   The initialized reorder buffer instance, or NULL on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ *    - EINVAL - invalid parameters
+ */
+struct rte_reorder_buffer * __rte_experimental
+rte_reorder_create_with_params(const struct rte_reorder_params *params);
+
 /**
  * Initializes given reorder buffer instance
  *
@@ -121,6 +178,8 @@ rte_reorder_free(struct rte_reorder_buffer *b);
  *      early mbuf, but it can be accommodated by performing drain and then insert.
  *    - ERANGE - Too early or late mbuf which is vastly out of range of expected
  *      window should be ignored without any handling.
+ *    - EEXIST - Another mbuf holds the same slot (RTE_REORDER_F_MP_INSERT
+ *      only), e.g. a duplicate sequence number.
  */
 int
 rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf);
@@ -146,6 +205,24 @@ unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve the late and dropped packet counts of a reorder buffer. They
+ * are cleared by rte_reorder_reset().
+ *
+ * @param b
+ *   Reorder buffer instance
+ * @param stats
+ *   Pointer to the structure filled with the statistics
+ * @return
+ *   0 on success, -EINVAL on invalid parameters
+ */
+int __rte_experimental
+rte_reorder_stats_get(struct rte_reorder_buffer *b,
+		struct rte_reorder_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,45 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <string.h>
+
+#include <rte_common.h>
+
+#include "rte_pie.h"
+
+int __rte_experimental
+rte_pie_rt_data_init(struct rte_pie *pie)
+{
+	if (pie == NULL)
+		return -1;
+
+	memset(pie, 0, sizeof(*pie));
+	return 0;
+}
+
+int __rte_experimental
+rte_pie_config_init(struct rte_pie_config *pie_cfg,
+	const struct rte_pie_params *params,
+	uint64_t time_hz)
+{
+	if ((pie_cfg == NULL) || (params == NULL))
+		return -1;
+	if (params->qdelay_ref == 0)
+		return -2;
+	if (params->dp_update_interval == 0)
+		return -3;
+	if (params->max_burst == 0)
+		return -4;
+	if (time_hz == 0)
+		return -5;
+
+	pie_cfg->qdelay_ref = (time_hz * params->qdelay_ref) / 1000;
+	pie_cfg->dp_update_interval =
+		(time_hz * params->dp_update_interval) / 1000;
+	pie_cfg->max_burst = (time_hz * params->max_burst) / 1000;
+	pie_cfg->alpha = RTE_PIE_ALPHA / (double)time_hz;
+	pie_cfg->beta = RTE_PIE_BETA / (double)time_hz;
+
+	return 0;
+}
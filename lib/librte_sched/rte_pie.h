@@ -0,0 +1,306 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#ifndef __RTE_PIE_H_INCLUDED__
+#define __RTE_PIE_H_INCLUDED__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE Proportional Integral controller Enhanced (PIE)
+ *
+ * Active queue management algorithm defined by IETF RFC 8033. Packets are
+ * dropped at enqueue time with a probability that is periodically updated
+ * from the queue delay. The queue delay is estimated from the queue length
+ * (in bytes) and from the queue dequeue rate, measured at dequeue time, so no
+ * per packet timestamp is needed.
+ *
+ * The time passed to the run-time functions can use any monotonic time base,
+ * e.g. CPU cycles or bytes of output port line rate, whose frequency is
+ * provided at configuration time.
+ *
+ * The run-time data is split between the fields written at enqueue time and
+ * the ones written at dequeue time, so the enqueue and the dequeue of a queue
+ * can run on different lcores.
+ *
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ ***/
+
+#include <stdint.h>
+#include <rte_common.h>
+#include <rte_compat.h>
+#include <rte_random.h>
+#include <rte_branch_prediction.h>
+
+#define RTE_PIE_DQ_THRESHOLD         (1 << 14) /**< Bytes dequeued per dequeue rate measurement */
+#define RTE_PIE_DQ_THRESHOLD_LOG2    14        /**< log2 of RTE_PIE_DQ_THRESHOLD */
+#define RTE_PIE_DQ_TIME_WEIGHT_LOG2  3         /**< Negated log2 of the dequeue time filter weight */
+#define RTE_PIE_ALPHA                0.125     /**< Weight of the queue delay error (Hz) */
+#define RTE_PIE_BETA                 1.25      /**< Weight of the queue delay variation (Hz) */
+#define RTE_PIE_DROP_PROB_DECAY      0.98      /**< Drop probability decay factor when the queue is idle */
+#define RTE_PIE_ACCU_PROB_MIN        0.85      /**< No drop below this accumulated drop probability */
+#define RTE_PIE_ACCU_PROB_MAX        8.5       /**< Drop above this accumulated drop probability */
+#define RTE_PIE_QLEN_MIN             2         /**< No drop when the queue is not longer than this (packets) */
+#define RTE_PIE_RAND_MASK            0x7FFFFFFF /**< Random bits used for the drop decision */
+
+/**
+ * PIE configuration parameters passed by user
+ *
+ */
+struct rte_pie_params {
+	uint16_t qdelay_ref;         /**< Target queue delay (milliseconds) */
+	uint16_t dp_update_interval; /**< Drop probability update interval (milliseconds) */
+	uint16_t max_burst;          /**< Burst allowance (milliseconds) */
+};
+
+/**
+ * PIE configuration parameters
+ */
+struct rte_pie_config {
+	uint64_t qdelay_ref;         /**< Target queue delay (time units) */
+	uint64_t dp_update_interval; /**< Drop probability update interval (time units) */
+	uint64_t max_burst;          /**< Burst allowance (time units) */
+	double alpha;                /**< Weight of the queue delay error (per time unit) */
+	double beta;                 /**< Weight of the queue delay variation (per time unit) */
+};
+
+/**
+ * PIE run-time data
+ */
+struct rte_pie {
+	/* Written at enqueue time */
+	uint64_t enq_bytes;     /**< Number of bytes enqueued */
+	uint64_t last_update;   /**< Time of the latest drop probability update */
+	uint64_t burst_time;    /**< Time spent congested since the latest reset of the burst allowance */
+	uint64_t qdelay_old;    /**< Queue delay at the latest drop probability update */
+	double drop_prob;       /**< Current drop probability */
+	double accu_prob;       /**< Drop probability accumulated since the latest drop */
+
+	/* Written at dequeue time */
+	uint64_t deq_bytes;     /**< Number of bytes dequeued */
+	uint64_t dq_start_time; /**< Start time of the current dequeue rate measurement */
+	uint64_t dq_start_bytes; /**< deq_bytes at the start of the current dequeue rate measurement */
+	uint64_t avg_dq_time;   /**< Average time to dequeue RTE_PIE_DQ_THRESHOLD bytes, 0 until measured */
+	uint32_t in_measurement; /**< Dequeue rate measurement in progress */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * @brief Initialises run-time data
+ *
+ * @param pie [in,out] data pointer to PIE runtime data
+ *
+ * @return Operation status
+ * @retval 0 success
+ * @retval !0 error
+ */
+int __rte_experimental
+rte_pie_rt_data_init(struct rte_pie *pie);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * @brief Configures a single PIE configuration parameter structure.
+ *
+ * @param pie_cfg [in,out] config pointer to a PIE configuration parameter structure
+ * @param params [in] PIE parameters, all of them have to be non-zero
+ * @param time_hz [in] number of time units per second of the time base used at run-time
+ *
+ * @return Operation status
+ * @retval 0 success
+ * @retval !0 error
+ */
+int __rte_experimental
+rte_pie_config_init(struct rte_pie_config *pie_cfg,
+	const struct rte_pie_params *params,
+	uint64_t time_hz);
+
+/**
+ * @brief Returns the current queue delay estimate
+ *
+ * @param pie [in] data pointer to PIE runtime data
+ *
+ * @return Queue delay (time units)
+ */
+static inline uint64_t
+__rte_pie_qdelay(const struct rte_pie *pie)
+{
+	uint64_t qlen_bytes = pie->enq_bytes - pie->deq_bytes;
+
+	return (qlen_bytes * pie->avg_dq_time) >> RTE_PIE_DQ_THRESHOLD_LOG2;
+}
+
+/**
+ * @brief Updates the drop probability, as described in section 4.2 of
+ *        RFC 8033, once per update interval
+ *
+ * @param pie_cfg [in] config pointer to a PIE configuration parameter structure
+ * @param pie [in,out] data pointer to PIE runtime data
+ * @param time [in] current time
+ */
+static inline void
+__rte_pie_drop_prob_update(const struct rte_pie_config *pie_cfg,
+	struct rte_pie *pie, uint64_t time)
+{
+	uint64_t qdelay = __rte_pie_qdelay(pie);
+	double drop_prob = pie->drop_prob;
+	double p;
+
+	p = pie_cfg->alpha * ((double)qdelay - (double)pie_cfg->qdelay_ref) +
+		pie_cfg->beta * ((double)qdelay - (double)pie->qdelay_old);
+
+	/* Scale the adjustment down while the drop probability is low */
+	if (drop_prob < 0.000001)
+		p /= 2048;
+	else if (drop_prob < 0.00001)
+		p /= 512;
+	else if (drop_prob < 0.0001)
+		p /= 128;
+	else if (drop_prob < 0.001)
+		p /= 32;
+	else if (drop_prob < 0.01)
+		p /= 8;
+	else if (drop_prob < 0.1)
+		p /= 2;
+	else if (p > 0.02)
+		p = 0.02;
+
+	drop_prob += p;
+
+	/* Decay the drop probability once the congestion is gone */
+	if ((qdelay == 0) && (pie->qdelay_old == 0))
+		drop_prob *= RTE_PIE_DROP_PROB_DECAY;
+
+	if (drop_prob < 0)
+		drop_prob = 0;
+	if (drop_prob > 1)
+		drop_prob = 1;
+
+	/* Restore the burst allowance when the queue is back to normal */
+	if ((drop_prob == 0) &&
+		(qdelay < pie_cfg->qdelay_ref / 2) &&
+		(pie->qdelay_old < pie_cfg->qdelay_ref / 2))
+		pie->burst_time = 0;
+	else if (pie->burst_time < pie_cfg->max_burst)
+		pie->burst_time += pie_cfg->dp_update_interval;
+
+	pie->drop_prob = drop_prob;
+	pie->qdelay_old = qdelay;
+	pie->last_update = time;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * @brief Decides if a new packet should be enqueued or dropped
+ *
+ * The drop probability is updated when at least one update interval elapsed
+ * since the previous update, an idle period counting as a single interval.
+ *
+ * @param pie_cfg [in] config pointer to a PIE configuration parameter structure
+ * @param pie [in,out] data pointer to PIE runtime data
+ * @param qlen [in] current queue length (packets)
+ * @param pkt_len [in] length of the packet (bytes)
+ * @param time [in] current time
+ *
+ * @return Operation status
+ * @retval 0 enqueue the packet
+ * @retval 1 drop the packet
+ */
+static inline int __rte_experimental
+rte_pie_enqueue(const struct rte_pie_config *pie_cfg,
+	struct rte_pie *pie,
+	uint32_t qlen,
+	uint32_t pkt_len,
+	uint64_t time)
+{
+	if (unlikely(time - pie->last_update >= pie_cfg->dp_update_interval))
+		__rte_pie_drop_prob_update(pie_cfg, pie, time);
+
+	/* Accept the packet while within the burst allowance, when the queue
+	 * delay is low or when the queue is short
+	 */
+	if ((pie->burst_time < pie_cfg->max_burst) ||
+		((pie->qdelay_old < pie_cfg->qdelay_ref / 2) &&
+		 (pie->drop_prob < 0.2)) ||
+		(qlen <= RTE_PIE_QLEN_MIN))
+		goto enqueue;
+
+	/* De-randomized drop decision */
+	if (pie->drop_prob == 0)
+		pie->accu_prob = 0;
+	pie->accu_prob += pie->drop_prob;
+
+	if (pie->accu_prob < RTE_PIE_ACCU_PROB_MIN)
+		goto enqueue;
+
+	if ((pie->accu_prob < RTE_PIE_ACCU_PROB_MAX) &&
+		((double)(rte_rand() & RTE_PIE_RAND_MASK) >=
+		 pie->drop_prob * ((double)RTE_PIE_RAND_MASK + 1)))
+		goto enqueue;
+
+	pie->accu_prob = 0;
+	return 1;
+
+enqueue:
+	pie->enq_bytes += pkt_len;
+	return 0;
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * @brief Updates the dequeue rate estimate when a packet leaves the queue
+ *
+ * @param pie [in,out] data pointer to PIE runtime data
+ * @param pkt_len [in] length of the packet (bytes)
+ * @param time [in] current time
+ */
+static inline void __rte_experimental
+rte_pie_dequeue(struct rte_pie *pie,
+	uint32_t pkt_len,
+	uint64_t time)
+{
+	/* Only measure the dequeue rate while the queue is long enough for
+	 * the measurement to complete without the queue getting empty
+	 */
+	if ((pie->in_measurement == 0) &&
+		(pie->enq_bytes - pie->deq_bytes >= RTE_PIE_DQ_THRESHOLD)) {
+		pie->in_measurement = 1;
+		pie->dq_start_time = time;
+		pie->dq_start_bytes = pie->deq_bytes;
+	}
+
+	pie->deq_bytes += pkt_len;
+
+	if ((pie->in_measurement != 0) &&
+		(pie->deq_bytes - pie->dq_start_bytes >= RTE_PIE_DQ_THRESHOLD)) {
+		uint64_t dq_time = time - pie->dq_start_time;
+
+		if (pie->avg_dq_time == 0)
+			pie->avg_dq_time = dq_time;
+		else
+			pie->avg_dq_time = pie->avg_dq_time -
+				(pie->avg_dq_time >> RTE_PIE_DQ_TIME_WEIGHT_LOG2) +
+				(dq_time >> RTE_PIE_DQ_TIME_WEIGHT_LOG2);
+
+		pie->in_measurement = 0;
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTE_PIE_H_INCLUDED__ */
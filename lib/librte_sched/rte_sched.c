@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
 #include <rte_common.h>
 #include <rte_log.h>
@@ -37,7 +38,8 @@
 
 #define RTE_SCHED_TB_RATE_CONFIG_ERR          (1e-7)
 #define RTE_SCHED_WRR_SHIFT                   3
-#define RTE_SCHED_GRINDER_PCACHE_SIZE         (64 / RTE_SCHED_QUEUES_PER_PIPE)
+#define RTE_SCHED_QUEUES_PER_PIPE_MIN         4
+#define RTE_SCHED_GRINDER_PCACHE_SIZE         (64 / RTE_SCHED_QUEUES_PER_PIPE_MIN)
 #define RTE_SCHED_PIPE_INVALID                UINT32_MAX
 #define RTE_SCHED_BMP_POS_INVALID             UINT32_MAX
 
@@ -56,8 +58,8 @@ struct rte_sched_subport {
 
 	/* Traffic classes (TCs) */
 	uint64_t tc_time; /* time of next update */
-	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
+	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	uint32_t tc_period;
 
 	/* TC oversubscription */
@@ -71,6 +73,19 @@ struct rte_sched_subport {
 
 	/* Statistics */
 	struct rte_sched_subport_stats stats;
+
+	/* Pipes and queues, allocated on first configuration. The pipe
+	 * profile table is either the port one or owned by the subport.
+	 */
+	uint32_t n_pipes;
+	uint32_t n_pipe_profiles;
+	uint32_t pipe_tc_be_rate_max;
+	struct rte_sched_pipe *pipe;
+	struct rte_sched_queue *queue;
+	struct rte_sched_queue_extra *queue_extra;
+	struct rte_sched_pipe_profile *pipe_profiles;
+	struct rte_mbuf **queue_array;
+	uint8_t *memory;
 };
 
 struct rte_sched_pipe_profile {
@@ -81,7 +96,7 @@ struct rte_sched_pipe_profile {
 
 	/* Pipe traffic classes */
 	uint32_t tc_period;
-	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	uint8_t tc_ov_weight;
 
 	/* Pipe queues */
@@ -95,10 +110,11 @@ struct rte_sched_pipe {
 
 	/* Pipe profile and flags */
 	uint32_t profile;
+	uint32_t enabled;
 
 	/* Traffic classes (TCs) */
 	uint64_t tc_time; /* time of next update */
-	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 
 	/* Weighted Round Robin (WRR) */
 	uint8_t wrr_tokens[RTE_SCHED_QUEUES_PER_PIPE];
@@ -114,11 +130,28 @@ struct rte_sched_queue {
 	uint16_t qr;
 };
 
+/*
+ * Pipe shape: the queues of a pipe are laid out traffic class after traffic
+ * class, the number of queue positions per pipe being rounded up to a power
+ * of 2 so that the pipe of a queue is found with a shift.
+ */
+struct rte_sched_pipe_shape {
+	uint32_t n_tcs;
+	uint32_t n_queues;
+	uint32_t n_queues_log2;
+	uint8_t tc_n_queues[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
+	uint8_t tc_qpos[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
+	uint8_t queue_tc[RTE_SCHED_QUEUES_PER_PIPE];
+};
+
 struct rte_sched_queue_extra {
 	struct rte_sched_queue_stats stats;
 #ifdef RTE_SCHED_RED
 	struct rte_red red;
 #endif
+#ifdef RTE_SCHED_PIE
+	struct rte_pie pie;
+#endif
 };
 
 enum grinder_state {
@@ -137,9 +170,9 @@ enum grinder_state {
  */
 struct rte_sched_port_hierarchy {
 	uint16_t queue:2;                /**< Queue ID (0 .. 3) */
-	uint16_t traffic_class:2;        /**< Traffic class ID (0 .. 3)*/
+	uint16_t traffic_class:4;        /**< Traffic class ID (0 .. 15)*/
 	uint32_t color:2;                /**< Color */
-	uint16_t unused:10;
+	uint16_t unused:8;
 	uint16_t subport;                /**< Subport ID */
 	uint32_t pipe;		         /**< Pipe ID */
 };
@@ -160,16 +193,18 @@ struct rte_sched_grinder {
 	struct rte_sched_pipe_profile *pipe_params;
 
 	/* TC cache */
-	uint8_t tccache_qmask[4];
-	uint32_t tccache_qindex[4];
+	uint8_t tccache_qmask[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
+	uint32_t tccache_qindex[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
+	uint8_t tccache_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	uint32_t tccache_w;
 	uint32_t tccache_r;
 
 	/* Current TC */
 	uint32_t tc_index;
-	struct rte_sched_queue *queue[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	struct rte_mbuf **qbase[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t qindex[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_n_queues;
+	struct rte_sched_queue *queue[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
+	struct rte_mbuf **qbase[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
+	uint32_t qindex[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
 	uint16_t qsize;
 	uint32_t qmask;
 	uint32_t qpos;
@@ -188,11 +223,16 @@ struct rte_sched_port {
 	uint32_t rate;
 	uint32_t mtu;
 	uint32_t frame_overhead;
-	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	uint32_t n_pipe_profiles;
-	uint32_t pipe_tc3_rate_max;
+	uint32_t n_max_pipe_profiles;
+	uint32_t pipe_tc_be_rate_max;
+	struct rte_sched_pipe_shape shape;
 #ifdef RTE_SCHED_RED
-	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS];
+	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX][e_RTE_METER_COLORS];
+#endif
+#ifdef RTE_SCHED_PIE
+	struct rte_pie_config pie_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 #endif
 
 	/* Timing */
@@ -219,65 +259,170 @@ struct rte_sched_port {
 	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE];
 	uint32_t qsize_sum;
 
+	/* Subport of a queue: the queue index space of each subport is sized
+	 * for n_pipes_per_subport pipes, whatever its actual number of pipes.
+	 */
+	uint32_t n_pipes_per_subport_log2;
+	uint32_t subport_qshift;
+	uint32_t subport_qmask;
+
+	/* Multi-core mode: dequeue shards of the port, each of them being a
+	 * port whose large data structures point to a slice of the ones of
+	 * the port they belong to.
+	 */
+	int socket;
+	uint32_t n_shards;
+	uint32_t shard_qshift;
+	uint32_t shard_qmask;
+	struct rte_sched_port *shards[RTE_SCHED_PORT_N_SHARDS_MAX];
+	struct rte_sched_port *parent;
+
 	/* Large data structures */
 	struct rte_sched_subport *subport;
-	struct rte_sched_pipe *pipe;
-	struct rte_sched_queue *queue;
-	struct rte_sched_queue_extra *queue_extra;
 	struct rte_sched_pipe_profile *pipe_profiles;
 	uint8_t *bmp_array;
-	struct rte_mbuf **queue_array;
 	uint8_t memory[0] __rte_cache_aligned;
 } __rte_cache_aligned;
 
 enum rte_sched_port_array {
 	e_RTE_SCHED_PORT_ARRAY_SUBPORT = 0,
-	e_RTE_SCHED_PORT_ARRAY_PIPE,
-	e_RTE_SCHED_PORT_ARRAY_QUEUE,
-	e_RTE_SCHED_PORT_ARRAY_QUEUE_EXTRA,
 	e_RTE_SCHED_PORT_ARRAY_PIPE_PROFILES,
 	e_RTE_SCHED_PORT_ARRAY_BMP_ARRAY,
-	e_RTE_SCHED_PORT_ARRAY_QUEUE_ARRAY,
 	e_RTE_SCHED_PORT_ARRAY_TOTAL,
 };
 
-#ifdef RTE_SCHED_COLLECT_STATS
+enum rte_sched_subport_array {
+	e_RTE_SCHED_SUBPORT_ARRAY_PIPE = 0,
+	e_RTE_SCHED_SUBPORT_ARRAY_QUEUE,
+	e_RTE_SCHED_SUBPORT_ARRAY_QUEUE_EXTRA,
+	e_RTE_SCHED_SUBPORT_ARRAY_PIPE_PROFILES,
+	e_RTE_SCHED_SUBPORT_ARRAY_QUEUE_ARRAY,
+	e_RTE_SCHED_SUBPORT_ARRAY_TOTAL,
+};
 
 static inline uint32_t
-rte_sched_port_queues_per_subport(struct rte_sched_port *port)
+rte_sched_port_queues_per_port(struct rte_sched_port *port)
 {
-	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport;
+	return port->shape.n_queues * port->n_pipes_per_subport * port->n_subports_per_port;
 }
 
-#endif
-
 static inline uint32_t
-rte_sched_port_queues_per_port(struct rte_sched_port *port)
+rte_sched_port_queue_tc(struct rte_sched_port *port, uint32_t qindex)
+{
+	return port->shape.queue_tc[qindex & (port->shape.n_queues - 1)];
+}
+
+static inline struct rte_sched_subport *
+rte_sched_port_subport(struct rte_sched_port *port, uint32_t qindex)
+{
+	return port->subport + (qindex >> port->subport_qshift);
+}
+
+/* Queue of the subport, NULL when beyond the pipes of the subport */
+static inline struct rte_sched_queue *
+rte_sched_port_queue(struct rte_sched_port *port, uint32_t qindex)
 {
-	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport * port->n_subports_per_port;
+	struct rte_sched_subport *s = rte_sched_port_subport(port, qindex);
+	uint32_t sqindex = qindex & port->subport_qmask;
+
+	if (unlikely((sqindex >> port->shape.n_queues_log2) >= s->n_pipes))
+		return NULL;
+
+	return s->queue + sqindex;
+}
+
+static inline struct rte_sched_queue_extra *
+rte_sched_port_queue_extra(struct rte_sched_port *port, uint32_t qindex)
+{
+	struct rte_sched_subport *s = rte_sched_port_subport(port, qindex);
+
+	return s->queue_extra + (qindex & port->subport_qmask);
 }
 
 static inline struct rte_mbuf **
 rte_sched_port_qbase(struct rte_sched_port *port, uint32_t qindex)
 {
-	uint32_t pindex = qindex >> 4;
-	uint32_t qpos = qindex & 0xF;
+	struct rte_sched_subport *s = rte_sched_port_subport(port, qindex);
+	uint32_t pindex = (qindex & port->subport_qmask) >>
+		port->shape.n_queues_log2;
+	uint32_t qpos = qindex & (port->shape.n_queues - 1);
 
-	return (port->queue_array + pindex *
+	return (s->queue_array + pindex *
 		port->qsize_sum + port->qsize_add[qpos]);
 }
 
 static inline uint16_t
 rte_sched_port_qsize(struct rte_sched_port *port, uint32_t qindex)
 {
-	uint32_t tc = (qindex >> 2) & 0x3;
+	return port->qsize[rte_sched_port_queue_tc(port, qindex)];
+}
+
+static inline struct rte_bitmap *
+rte_sched_port_shard_bmp(struct rte_sched_port *port, uint32_t *qindex)
+{
+	struct rte_sched_port *shard = port->shards[*qindex >>
+						    port->shard_qshift];
+
+	*qindex &= port->shard_qmask;
+
+	return shard->bmp;
+}
+
+static int
+rte_sched_pipe_shape_init(struct rte_sched_pipe_shape *shape,
+	const uint8_t *n_queues_per_tc)
+{
+	static const uint8_t default_shape[
+			RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX] = {
+		[0 ... RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE - 1] =
+			RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS,
+	};
+	uint32_t tc, qpos, n_queues;
+
+	if (n_queues_per_tc[0] == 0)
+		n_queues_per_tc = default_shape;
+
+	memset(shape, 0, sizeof(*shape));
+
+	qpos = 0;
+	for (tc = 0; tc < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX; tc++) {
+		uint32_t n = n_queues_per_tc[tc];
+		uint32_t i;
+
+		if (n == 0)
+			break;
+
+		/* 1, 2 or 4 queues, fitting into the pipe */
+		if (n > RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS ||
+		    !rte_is_power_of_2(n) ||
+		    qpos + n > RTE_SCHED_QUEUES_PER_PIPE)
+			return -1;
+
+		shape->tc_n_queues[tc] = n;
+		shape->tc_qpos[tc] = qpos;
+		for (i = 0; i < n; i++)
+			shape->queue_tc[qpos++] = tc;
+	}
 
-	return port->qsize[tc];
+	shape->n_tcs = tc;
+
+	/* Queue positions left over belong to the last TC, but have no
+	 * storage and never get any packet.
+	 */
+	n_queues = RTE_MAX(rte_align32pow2(qpos),
+			   (uint32_t)RTE_SCHED_QUEUES_PER_PIPE_MIN);
+	for (; qpos < n_queues; qpos++)
+		shape->queue_tc[qpos] = tc - 1;
+
+	shape->n_queues = n_queues;
+	shape->n_queues_log2 = rte_bsf32(n_queues);
+
+	return 0;
 }
 
 static int
 pipe_profile_check(struct rte_sched_pipe_params *params,
-	uint32_t rate)
+	uint32_t rate, const struct rte_sched_pipe_shape *shape)
 {
 	uint32_t i;
 
@@ -295,7 +440,7 @@ pipe_profile_check(struct rte_sched_pipe_params *params,
 		return -12;
 
 	/* TC rate: non-zero, less than pipe rate */
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < shape->n_tcs; i++) {
 		if (params->tc_rate[i] == 0 ||
 			params->tc_rate[i] > params->tb_rate)
 			return -13;
@@ -306,23 +451,37 @@ pipe_profile_check(struct rte_sched_pipe_params *params,
 		return -14;
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-	/* TC3 oversubscription weight: non-zero */
+	/* Lowest priority TC oversubscription weight: non-zero */
 	if (params->tc_ov_weight == 0)
 		return -15;
 #endif
 
-	/* Queue WRR weights: non-zero */
+	/* Queue WRR weights: non-zero for the TCs with several queues */
 	for (i = 0; i < RTE_SCHED_QUEUES_PER_PIPE; i++) {
-		if (params->wrr_weights[i] == 0)
+		uint32_t tc = shape->queue_tc[i];
+
+		if (i < shape->tc_qpos[tc] + shape->tc_n_queues[tc] &&
+		    shape->tc_n_queues[tc] > 1 &&
+		    params->wrr_weights[i] == 0)
 			return -16;
 	}
 
 	return 0;
 }
 
+static inline uint32_t
+rte_sched_port_n_max_pipe_profiles(struct rte_sched_port_params *params)
+{
+	if (params->n_max_pipe_profiles == 0)
+		return RTE_SCHED_PIPE_PROFILES_PER_PORT;
+
+	return params->n_max_pipe_profiles;
+}
+
 static int
 rte_sched_port_check_params(struct rte_sched_port_params *params)
 {
+	struct rte_sched_pipe_shape shape;
 	uint32_t i;
 
 	if (params == NULL)
@@ -351,31 +510,53 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 	    !rte_is_power_of_2(params->n_pipes_per_subport))
 		return -7;
 
+	/* pipe shape: 1, 2 or 4 queues per TC, 16 queues per pipe at most */
+	if (rte_sched_pipe_shape_init(&shape, params->n_queues_per_tc) != 0)
+		return -17;
+
 	/* qsize: non-zero, power of 2,
 	 * no bigger than 32K (due to 16-bit read/write pointers)
 	 */
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < shape.n_tcs; i++) {
 		uint16_t qsize = params->qsize[i];
 
 		if (qsize == 0 || !rte_is_power_of_2(qsize))
 			return -8;
 	}
 
-	/* pipe_profiles and n_pipe_profiles */
+	/* pipe_profiles, n_pipe_profiles and n_max_pipe_profiles */
 	if (params->pipe_profiles == NULL ||
 	    params->n_pipe_profiles == 0 ||
-	    params->n_pipe_profiles > RTE_SCHED_PIPE_PROFILES_PER_PORT)
+	    params->n_pipe_profiles >
+			rte_sched_port_n_max_pipe_profiles(params) ||
+	    rte_sched_port_n_max_pipe_profiles(params) >
+			RTE_SCHED_PIPE_PROFILES_PER_PORT_MAX)
 		return -9;
 
 	for (i = 0; i < params->n_pipe_profiles; i++) {
 		struct rte_sched_pipe_params *p = params->pipe_profiles + i;
 		int status;
 
-		status = pipe_profile_check(p, params->rate);
+		status = pipe_profile_check(p, params->rate, &shape);
 		if (status != 0)
 			return status;
 	}
 
+#if defined(RTE_SCHED_RED) && defined(RTE_SCHED_PIE)
+	/* A traffic class runs either RED or PIE */
+	for (i = 0; i < shape.n_tcs; i++) {
+		uint32_t j;
+
+		if (params->pie_params[i].qdelay_ref == 0)
+			continue;
+
+		for (j = 0; j < e_RTE_METER_COLORS; j++)
+			if ((params->red_params[i][j].min_th |
+			     params->red_params[i][j].max_th) != 0)
+				return -18;
+	}
+#endif
+
 	return 0;
 }
 
@@ -385,26 +566,19 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 	uint32_t n_subports_per_port = params->n_subports_per_port;
 	uint32_t n_pipes_per_subport = params->n_pipes_per_subport;
 	uint32_t n_pipes_per_port = n_pipes_per_subport * n_subports_per_port;
-	uint32_t n_queues_per_port = RTE_SCHED_QUEUES_PER_PIPE * n_pipes_per_subport * n_subports_per_port;
+	uint32_t n_queues_per_port;
 
 	uint32_t size_subport = n_subports_per_port * sizeof(struct rte_sched_subport);
-	uint32_t size_pipe = n_pipes_per_port * sizeof(struct rte_sched_pipe);
-	uint32_t size_queue = n_queues_per_port * sizeof(struct rte_sched_queue);
-	uint32_t size_queue_extra
-		= n_queues_per_port * sizeof(struct rte_sched_queue_extra);
-	uint32_t size_pipe_profiles
-		= RTE_SCHED_PIPE_PROFILES_PER_PORT * sizeof(struct rte_sched_pipe_profile);
-	uint32_t size_bmp_array = rte_bitmap_get_memory_footprint(n_queues_per_port);
-	uint32_t size_per_pipe_queue_array, size_queue_array;
+	uint32_t size_pipe_profiles = rte_sched_port_n_max_pipe_profiles(params)
+		* sizeof(struct rte_sched_pipe_profile);
+	uint32_t size_bmp_array;
+	struct rte_sched_pipe_shape shape;
 
-	uint32_t base, i;
+	uint32_t base;
 
-	size_per_pipe_queue_array = 0;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
-		size_per_pipe_queue_array += RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS
-			* params->qsize[i] * sizeof(struct rte_mbuf *);
-	}
-	size_queue_array = n_pipes_per_port * size_per_pipe_queue_array;
+	rte_sched_pipe_shape_init(&shape, params->n_queues_per_tc);
+	n_queues_per_port = shape.n_queues * n_pipes_per_port;
+	size_bmp_array = rte_bitmap_get_memory_footprint(n_queues_per_port);
 
 	base = 0;
 
@@ -412,27 +586,59 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 		return base;
 	base += RTE_CACHE_LINE_ROUNDUP(size_subport);
 
-	if (array == e_RTE_SCHED_PORT_ARRAY_PIPE)
+	if (array == e_RTE_SCHED_PORT_ARRAY_PIPE_PROFILES)
+		return base;
+	base += RTE_CACHE_LINE_ROUNDUP(size_pipe_profiles);
+
+	if (array == e_RTE_SCHED_PORT_ARRAY_BMP_ARRAY)
+		return base;
+	base += RTE_CACHE_LINE_ROUNDUP(size_bmp_array);
+
+	return base;
+}
+
+/*
+ * The subport memory depends on its number of pipes and of pipe profiles
+ * owned, and on the port pipe shape and queue sizes, qsize_sum being the
+ * number of mbuf pointers of the queues of one pipe.
+ */
+static uint32_t
+rte_sched_subport_get_array_base(uint32_t n_pipes, uint32_t n_queues_per_pipe,
+	uint32_t qsize_sum, uint32_t n_pipe_profiles,
+	enum rte_sched_subport_array array)
+{
+	uint32_t n_queues = n_pipes * n_queues_per_pipe;
+
+	uint32_t size_pipe = n_pipes * sizeof(struct rte_sched_pipe);
+	uint32_t size_queue = n_queues * sizeof(struct rte_sched_queue);
+	uint32_t size_queue_extra
+		= n_queues * sizeof(struct rte_sched_queue_extra);
+	uint32_t size_pipe_profiles
+		= n_pipe_profiles * sizeof(struct rte_sched_pipe_profile);
+	uint32_t size_queue_array
+		= n_pipes * qsize_sum * sizeof(struct rte_mbuf *);
+
+	uint32_t base;
+
+	base = 0;
+
+	if (array == e_RTE_SCHED_SUBPORT_ARRAY_PIPE)
 		return base;
 	base += RTE_CACHE_LINE_ROUNDUP(size_pipe);
 
-	if (array == e_RTE_SCHED_PORT_ARRAY_QUEUE)
+	if (array == e_RTE_SCHED_SUBPORT_ARRAY_QUEUE)
 		return base;
 	base += RTE_CACHE_LINE_ROUNDUP(size_queue);
 
-	if (array == e_RTE_SCHED_PORT_ARRAY_QUEUE_EXTRA)
+	if (array == e_RTE_SCHED_SUBPORT_ARRAY_QUEUE_EXTRA)
 		return base;
 	base += RTE_CACHE_LINE_ROUNDUP(size_queue_extra);
 
-	if (array == e_RTE_SCHED_PORT_ARRAY_PIPE_PROFILES)
+	if (array == e_RTE_SCHED_SUBPORT_ARRAY_PIPE_PROFILES)
 		return base;
 	base += RTE_CACHE_LINE_ROUNDUP(size_pipe_profiles);
 
-	if (array == e_RTE_SCHED_PORT_ARRAY_BMP_ARRAY)
-		return base;
-	base += RTE_CACHE_LINE_ROUNDUP(size_bmp_array);
-
-	if (array == e_RTE_SCHED_PORT_ARRAY_QUEUE_ARRAY)
+	if (array == e_RTE_SCHED_SUBPORT_ARRAY_QUEUE_ARRAY)
 		return base;
 	base += RTE_CACHE_LINE_ROUNDUP(size_queue_array);
 
@@ -442,7 +648,8 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 uint32_t
 rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params)
 {
-	uint32_t size0, size1;
+	struct rte_sched_pipe_shape shape;
+	uint32_t size0, size1, size2, qsize_sum, i;
 	int status;
 
 	status = rte_sched_port_check_params(params);
@@ -453,46 +660,47 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params)
 		return 0;
 	}
 
+	/* Only the queues of the pipe shape get some storage */
+	rte_sched_pipe_shape_init(&shape, params->n_queues_per_tc);
+	qsize_sum = 0;
+	for (i = 0; i < shape.n_tcs; i++)
+		qsize_sum += shape.tc_n_queues[i] * params->qsize[i];
+
 	size0 = sizeof(struct rte_sched_port);
 	size1 = rte_sched_port_get_array_base(params, e_RTE_SCHED_PORT_ARRAY_TOTAL);
+	size2 = params->n_subports_per_port *
+		rte_sched_subport_get_array_base(params->n_pipes_per_subport,
+			shape.n_queues, qsize_sum, 0,
+			e_RTE_SCHED_SUBPORT_ARRAY_TOTAL);
 
-	return size0 + size1;
+	return size0 + size1 + size2;
 }
 
 static void
 rte_sched_port_config_qsize(struct rte_sched_port *port)
 {
-	/* TC 0 */
-	port->qsize_add[0] = 0;
-	port->qsize_add[1] = port->qsize_add[0] + port->qsize[0];
-	port->qsize_add[2] = port->qsize_add[1] + port->qsize[0];
-	port->qsize_add[3] = port->qsize_add[2] + port->qsize[0];
+	struct rte_sched_pipe_shape *shape = &port->shape;
+	uint32_t qpos, qsize_sum = 0;
 
-	/* TC 1 */
-	port->qsize_add[4] = port->qsize_add[3] + port->qsize[0];
-	port->qsize_add[5] = port->qsize_add[4] + port->qsize[1];
-	port->qsize_add[6] = port->qsize_add[5] + port->qsize[1];
-	port->qsize_add[7] = port->qsize_add[6] + port->qsize[1];
-
-	/* TC 2 */
-	port->qsize_add[8] = port->qsize_add[7] + port->qsize[1];
-	port->qsize_add[9] = port->qsize_add[8] + port->qsize[2];
-	port->qsize_add[10] = port->qsize_add[9] + port->qsize[2];
-	port->qsize_add[11] = port->qsize_add[10] + port->qsize[2];
+	/* The queue positions left over at the end of the pipe have no
+	 * storage, they all start where the pipe ends.
+	 */
+	for (qpos = 0; qpos < shape->n_queues; qpos++) {
+		uint32_t tc = shape->queue_tc[qpos];
 
-	/* TC 3 */
-	port->qsize_add[12] = port->qsize_add[11] + port->qsize[2];
-	port->qsize_add[13] = port->qsize_add[12] + port->qsize[3];
-	port->qsize_add[14] = port->qsize_add[13] + port->qsize[3];
-	port->qsize_add[15] = port->qsize_add[14] + port->qsize[3];
+		port->qsize_add[qpos] = qsize_sum;
+		if (qpos < shape->tc_qpos[tc] + shape->tc_n_queues[tc])
+			qsize_sum += port->qsize[tc];
+	}
 
-	port->qsize_sum = port->qsize_add[15] + port->qsize[3];
+	port->qsize_sum = qsize_sum;
 }
 
 static void
-rte_sched_port_log_pipe_profile(struct rte_sched_port *port, uint32_t i)
+rte_sched_port_log_pipe_profile(struct rte_sched_pipe_profile *pipe_profiles,
+	uint32_t i)
 {
-	struct rte_sched_pipe_profile *p = port->pipe_profiles + i;
+	struct rte_sched_pipe_profile *p = pipe_profiles + i;
 
 	RTE_LOG(DEBUG, SCHED, "Low level config for pipe profile %u:\n"
 		"    Token bucket: period = %u, credits per period = %u, size = %u\n"
@@ -536,7 +744,7 @@ rte_sched_time_ms_to_bytes(uint32_t time_ms, uint32_t rate)
 static void
 rte_sched_pipe_profile_convert(struct rte_sched_pipe_params *src,
 	struct rte_sched_pipe_profile *dst,
-	uint32_t rate)
+	uint32_t rate, const struct rte_sched_pipe_shape *shape)
 {
 	uint32_t i;
 
@@ -559,7 +767,7 @@ rte_sched_pipe_profile_convert(struct rte_sched_pipe_params *src,
 	dst->tc_period = rte_sched_time_ms_to_bytes(src->tc_period,
 						rate);
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+	for (i = 0; i < shape->n_tcs; i++)
 		dst->tc_credits_per_period[i]
 			= rte_sched_time_ms_to_bytes(src->tc_period,
 				src->tc_rate[i]);
@@ -569,56 +777,51 @@ rte_sched_pipe_profile_convert(struct rte_sched_pipe_params *src,
 #endif
 
 	/* WRR */
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
-		uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-		uint32_t lcd, lcd1, lcd2;
-		uint32_t qindex;
-
-		qindex = i * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
-
-		wrr_cost[0] = src->wrr_weights[qindex];
-		wrr_cost[1] = src->wrr_weights[qindex + 1];
-		wrr_cost[2] = src->wrr_weights[qindex + 2];
-		wrr_cost[3] = src->wrr_weights[qindex + 3];
-
-		lcd1 = rte_get_lcd(wrr_cost[0], wrr_cost[1]);
-		lcd2 = rte_get_lcd(wrr_cost[2], wrr_cost[3]);
-		lcd = rte_get_lcd(lcd1, lcd2);
+	for (i = 0; i < shape->n_tcs; i++) {
+		uint32_t n_queues = shape->tc_n_queues[i];
+		uint32_t qindex = shape->tc_qpos[i];
+		uint32_t lcd, j;
+
+		/* Single queue TCs have no WRR */
+		if (n_queues == 1) {
+			dst->wrr_cost[qindex] = 1;
+			continue;
+		}
 
-		wrr_cost[0] = lcd / wrr_cost[0];
-		wrr_cost[1] = lcd / wrr_cost[1];
-		wrr_cost[2] = lcd / wrr_cost[2];
-		wrr_cost[3] = lcd / wrr_cost[3];
+		lcd = 1;
+		for (j = 0; j < n_queues; j++)
+			lcd = rte_get_lcd(lcd, src->wrr_weights[qindex + j]);
 
-		dst->wrr_cost[qindex] = (uint8_t) wrr_cost[0];
-		dst->wrr_cost[qindex + 1] = (uint8_t) wrr_cost[1];
-		dst->wrr_cost[qindex + 2] = (uint8_t) wrr_cost[2];
-		dst->wrr_cost[qindex + 3] = (uint8_t) wrr_cost[3];
+		for (j = 0; j < n_queues; j++)
+			dst->wrr_cost[qindex + j] =
+				(uint8_t) (lcd / src->wrr_weights[qindex + j]);
 	}
 }
 
-static void
+/* Returns the highest lowest priority TC rate of the table */
+static uint32_t
 rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port,
-	struct rte_sched_port_params *params)
+	struct rte_sched_pipe_params *src,
+	struct rte_sched_pipe_profile *dst,
+	uint32_t n_pipe_profiles)
 {
-	uint32_t i;
+	uint32_t pipe_tc_be_rate_max, i;
 
-	for (i = 0; i < port->n_pipe_profiles; i++) {
-		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
-		struct rte_sched_pipe_profile *dst = port->pipe_profiles + i;
-
-		rte_sched_pipe_profile_convert(src, dst, params->rate);
-		rte_sched_port_log_pipe_profile(port, i);
+	for (i = 0; i < n_pipe_profiles; i++) {
+		rte_sched_pipe_profile_convert(src + i, dst + i, port->rate,
+					       &port->shape);
+		rte_sched_port_log_pipe_profile(dst, i);
 	}
 
-	port->pipe_tc3_rate_max = 0;
-	for (i = 0; i < port->n_pipe_profiles; i++) {
-		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
-		uint32_t pipe_tc3_rate = src->tc_rate[3];
+	pipe_tc_be_rate_max = 0;
+	for (i = 0; i < n_pipe_profiles; i++) {
+		uint32_t pipe_tc_be_rate = src[i].tc_rate[port->shape.n_tcs - 1];
 
-		if (port->pipe_tc3_rate_max < pipe_tc3_rate)
-			port->pipe_tc3_rate_max = pipe_tc3_rate;
+		if (pipe_tc_be_rate_max < pipe_tc_be_rate)
+			pipe_tc_be_rate_max = pipe_tc_be_rate;
 	}
+
+	return pipe_tc_be_rate_max;
 }
 
 struct rte_sched_port *
@@ -626,11 +829,22 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 {
 	struct rte_sched_port *port = NULL;
 	uint32_t mem_size, bmp_mem_size, n_queues_per_port, i, cycles_per_byte;
+	int status;
 
-	/* Check user parameters. Determine the amount of memory to allocate */
-	mem_size = rte_sched_port_get_memory_footprint(params);
-	if (mem_size == 0)
+	/* Check user parameters */
+	status = rte_sched_port_check_params(params);
+	if (status != 0) {
+		RTE_LOG(NOTICE, SCHED,
+			"Port scheduler params check failed (%d)\n", status);
 		return NULL;
+	}
+
+	/* Determine the amount of memory to allocate, the pipes and queues
+	 * being allocated with their subport
+	 */
+	mem_size = sizeof(struct rte_sched_port) +
+		rte_sched_port_get_array_base(params,
+					      e_RTE_SCHED_PORT_ARRAY_TOTAL);
 
 	/* Allocate memory to store the data structures */
 	port = rte_zmalloc_socket("qos_params", mem_size, RTE_CACHE_LINE_SIZE,
@@ -650,9 +864,16 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->frame_overhead = params->frame_overhead;
 	memcpy(port->qsize, params->qsize, sizeof(params->qsize));
 	port->n_pipe_profiles = params->n_pipe_profiles;
+	port->n_max_pipe_profiles = rte_sched_port_n_max_pipe_profiles(params);
+	port->socket = params->socket;
+	rte_sched_pipe_shape_init(&port->shape, params->n_queues_per_tc);
+	port->n_pipes_per_subport_log2 = rte_bsf32(port->n_pipes_per_subport);
+	port->subport_qshift = port->n_pipes_per_subport_log2 +
+		port->shape.n_queues_log2;
+	port->subport_qmask = (1u << port->subport_qshift) - 1;
 
 #ifdef RTE_SCHED_RED
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->shape.n_tcs; i++) {
 		uint32_t j;
 
 		for (j = 0; j < e_RTE_METER_COLORS; j++) {
@@ -673,6 +894,23 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	}
 #endif
 
+#ifdef RTE_SCHED_PIE
+	/* The PIE time base is the port time, measured in bytes */
+	for (i = 0; i < port->shape.n_tcs; i++) {
+		/* if qdelay_ref is zero, then PIE is disabled */
+		if (params->pie_params[i].qdelay_ref == 0)
+			continue;
+
+		if (rte_pie_config_init(&port->pie_config[i],
+			&params->pie_params[i], params->rate) != 0) {
+			RTE_LOG(NOTICE, SCHED,
+				"Invalid PIE parameters for TC %u\n", i);
+			rte_free(port);
+			return NULL;
+		}
+	}
+#endif
+
 	/* Timing */
 	port->time_cpu_cycles = rte_get_tsc_cycles();
 	port->time_cpu_bytes = 0;
@@ -698,26 +936,16 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->subport = (struct rte_sched_subport *)
 		(port->memory + rte_sched_port_get_array_base(params,
 							      e_RTE_SCHED_PORT_ARRAY_SUBPORT));
-	port->pipe = (struct rte_sched_pipe *)
-		(port->memory + rte_sched_port_get_array_base(params,
-							      e_RTE_SCHED_PORT_ARRAY_PIPE));
-	port->queue = (struct rte_sched_queue *)
-		(port->memory + rte_sched_port_get_array_base(params,
-							      e_RTE_SCHED_PORT_ARRAY_QUEUE));
-	port->queue_extra = (struct rte_sched_queue_extra *)
-		(port->memory + rte_sched_port_get_array_base(params,
-							      e_RTE_SCHED_PORT_ARRAY_QUEUE_EXTRA));
 	port->pipe_profiles = (struct rte_sched_pipe_profile *)
 		(port->memory + rte_sched_port_get_array_base(params,
 							      e_RTE_SCHED_PORT_ARRAY_PIPE_PROFILES));
 	port->bmp_array =  port->memory
 		+ rte_sched_port_get_array_base(params, e_RTE_SCHED_PORT_ARRAY_BMP_ARRAY);
-	port->queue_array = (struct rte_mbuf **)
-		(port->memory + rte_sched_port_get_array_base(params,
-							      e_RTE_SCHED_PORT_ARRAY_QUEUE_ARRAY));
 
 	/* Pipe profile table */
-	rte_sched_port_config_pipe_profile_table(port, params);
+	port->pipe_tc_be_rate_max = rte_sched_port_config_pipe_profile_table(
+		port, params->pipe_profiles, port->pipe_profiles,
+		port->n_pipe_profiles);
 
 	/* Bitmap */
 	n_queues_per_port = rte_sched_port_queues_per_port(port);
@@ -736,34 +964,318 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	return port;
 }
 
+/* Drop the packets queued on the pipes pipe_start to pipe_end - 1 */
+static void
+rte_sched_subport_drop_pipes(struct rte_sched_port *port, uint32_t subport_id,
+	uint32_t pipe_start, uint32_t pipe_end)
+{
+	struct rte_sched_subport *s = port->subport + subport_id;
+	uint32_t n_queues = port->shape.n_queues;
+	uint32_t sqindex;
+
+	for (sqindex = pipe_start * n_queues; sqindex < pipe_end * n_queues;
+	     sqindex++) {
+		struct rte_sched_queue *queue = s->queue + sqindex;
+		uint32_t qindex = (subport_id << port->subport_qshift) + sqindex;
+		struct rte_mbuf **mbufs = rte_sched_port_qbase(port, qindex);
+		uint16_t qsize = rte_sched_port_qsize(port, qindex);
+		uint16_t n_pkts = queue->qw - queue->qr;
+		uint16_t i;
+
+		if (n_pkts == 0)
+			continue;
+
+		for (i = 0; i < n_pkts; i++)
+			rte_pktmbuf_free(mbufs[(queue->qr + i) & (qsize - 1)]);
+		queue->qr = queue->qw;
+
+		if (port->n_shards == 0) {
+			rte_bitmap_clear(port->bmp, qindex);
+		} else {
+			struct rte_bitmap *bmp =
+				rte_sched_port_shard_bmp(port, &qindex);
+
+			rte_bitmap_clear(bmp, qindex);
+		}
+	}
+}
+
+/*
+ * Return the grinders of a port or shard to idle, so that none of them
+ * references a pipe or queue. The active pipes are found again in the
+ * bitmap, the WRR round of the traffic class being served restarting from
+ * the tokens last stored in the pipe.
+ */
+static void
+rte_sched_port_grinders_flush(struct rte_sched_port *port)
+{
+	uint32_t i;
+
+	memset(port->grinder, 0, sizeof(port->grinder));
+	for (i = 0; i < RTE_SCHED_PORT_N_GRINDERS; i++)
+		port->grinder_base_bmp_pos[i] = RTE_SCHED_PIPE_INVALID;
+	port->busy_grinders = 0;
+	port->pipe_loop = RTE_SCHED_PIPE_INVALID;
+	port->pipe_exhaustion = 0;
+}
+
+/*
+ * (Re)allocate the pipes and queues of a subport, the first pipes of its
+ * current memory, if any, being moved along with their queued packets. The
+ * pipe profile table is converted from pipe_profiles when not NULL, moved
+ * when owned by the subport, and shared with the port otherwise.
+ */
+static int
+rte_sched_subport_config_pipes(struct rte_sched_port *port,
+	uint32_t subport_id, uint32_t n_pipes,
+	struct rte_sched_pipe_params *pipe_profiles, uint32_t n_pipe_profiles)
+{
+	struct rte_sched_subport *s = port->subport + subport_id;
+	struct rte_sched_pipe_profile *profiles;
+	struct rte_sched_pipe *pipe;
+	struct rte_sched_queue *queue;
+	struct rte_sched_queue_extra *queue_extra;
+	struct rte_mbuf **queue_array;
+	uint32_t n_queues = port->shape.n_queues;
+	uint32_t n_own_profiles, n_pipes_kept, mem_size;
+	uint8_t *memory;
+
+	if (pipe_profiles != NULL)
+		n_own_profiles = n_pipe_profiles;
+	else if (s->memory != NULL && s->pipe_profiles != port->pipe_profiles)
+		n_own_profiles = s->n_pipe_profiles;
+	else
+		n_own_profiles = 0;
+
+	mem_size = rte_sched_subport_get_array_base(n_pipes, n_queues,
+		port->qsize_sum, n_own_profiles,
+		e_RTE_SCHED_SUBPORT_ARRAY_TOTAL);
+	memory = rte_zmalloc_socket("qos_subport", mem_size,
+				    RTE_CACHE_LINE_SIZE, port->socket);
+	if (memory == NULL)
+		return -1;
+
+	pipe = (struct rte_sched_pipe *)
+		(memory + rte_sched_subport_get_array_base(n_pipes, n_queues,
+			port->qsize_sum, n_own_profiles,
+			e_RTE_SCHED_SUBPORT_ARRAY_PIPE));
+	queue = (struct rte_sched_queue *)
+		(memory + rte_sched_subport_get_array_base(n_pipes, n_queues,
+			port->qsize_sum, n_own_profiles,
+			e_RTE_SCHED_SUBPORT_ARRAY_QUEUE));
+	queue_extra = (struct rte_sched_queue_extra *)
+		(memory + rte_sched_subport_get_array_base(n_pipes, n_queues,
+			port->qsize_sum, n_own_profiles,
+			e_RTE_SCHED_SUBPORT_ARRAY_QUEUE_EXTRA));
+	profiles = (struct rte_sched_pipe_profile *)
+		(memory + rte_sched_subport_get_array_base(n_pipes, n_queues,
+			port->qsize_sum, n_own_profiles,
+			e_RTE_SCHED_SUBPORT_ARRAY_PIPE_PROFILES));
+	queue_array = (struct rte_mbuf **)
+		(memory + rte_sched_subport_get_array_base(n_pipes, n_queues,
+			port->qsize_sum, n_own_profiles,
+			e_RTE_SCHED_SUBPORT_ARRAY_QUEUE_ARRAY));
+
+	/* Pipe profile table */
+	if (pipe_profiles != NULL) {
+		s->pipe_tc_be_rate_max =
+			rte_sched_port_config_pipe_profile_table(port,
+				pipe_profiles, profiles, n_pipe_profiles);
+		s->n_pipe_profiles = n_pipe_profiles;
+		s->pipe_profiles = profiles;
+	} else if (n_own_profiles != 0) {
+		memcpy(profiles, s->pipe_profiles,
+		       n_own_profiles * sizeof(struct rte_sched_pipe_profile));
+		s->pipe_profiles = profiles;
+	} else {
+		s->n_pipe_profiles = port->n_pipe_profiles;
+		s->pipe_tc_be_rate_max = port->pipe_tc_be_rate_max;
+		s->pipe_profiles = port->pipe_profiles;
+	}
+
+	/* Pipes removed */
+	if (n_pipes < s->n_pipes)
+		rte_sched_subport_drop_pipes(port, subport_id, n_pipes,
+					     s->n_pipes);
+
+	/* Pipes kept */
+	n_pipes_kept = RTE_MIN(n_pipes, s->n_pipes);
+	if (n_pipes_kept != 0) {
+		memcpy(pipe, s->pipe,
+		       n_pipes_kept * sizeof(struct rte_sched_pipe));
+		memcpy(queue, s->queue,
+		       n_pipes_kept * n_queues * sizeof(struct rte_sched_queue));
+		memcpy(queue_extra, s->queue_extra, n_pipes_kept * n_queues *
+		       sizeof(struct rte_sched_queue_extra));
+		memcpy(queue_array, s->queue_array, n_pipes_kept *
+		       port->qsize_sum * sizeof(struct rte_mbuf *));
+	}
+
+	rte_free(s->memory);
+	s->n_pipes = n_pipes;
+	s->pipe = pipe;
+	s->queue = queue;
+	s->queue_extra = queue_extra;
+	s->queue_array = queue_array;
+	s->memory = memory;
+
+	return 0;
+}
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+
+/* Subport lowest priority TC oversubscription, from the pipes enabled */
+static void
+rte_sched_subport_config_tc_ov(struct rte_sched_port *port,
+	struct rte_sched_subport *s)
+{
+	uint32_t tc_be = port->shape.n_tcs - 1;
+	double subport_tc_be_rate =
+		(double) s->tc_credits_per_period[tc_be]
+		/ (double) s->tc_period;
+	uint32_t i;
+
+	s->tc_ov_n = 0;
+	s->tc_ov_rate = 0;
+
+	for (i = 0; i < s->n_pipes; i++) {
+		struct rte_sched_pipe *p = s->pipe + i;
+		struct rte_sched_pipe_profile *params;
+
+		if (!p->enabled)
+			continue;
+
+		params = s->pipe_profiles + p->profile;
+		s->tc_ov_n += params->tc_ov_weight;
+		s->tc_ov_rate += (double) params->tc_credits_per_period[tc_be]
+			/ (double) params->tc_period;
+	}
+
+	s->tc_ov = s->tc_ov_rate > subport_tc_be_rate;
+}
+
+#endif
+
 void
 rte_sched_port_free(struct rte_sched_port *port)
 {
-	uint32_t qindex;
-	uint32_t n_queues_per_port;
+	uint32_t i;
 
 	/* Check user parameters */
 	if (port == NULL)
 		return;
 
-	n_queues_per_port = rte_sched_port_queues_per_port(port);
+	/* Free enqueued mbufs and subport memory */
+	for (i = 0; i < port->n_subports_per_port; i++) {
+		struct rte_sched_subport *s = port->subport + i;
 
-	/* Free enqueued mbufs */
-	for (qindex = 0; qindex < n_queues_per_port; qindex++) {
-		struct rte_mbuf **mbufs = rte_sched_port_qbase(port, qindex);
-		uint16_t qsize = rte_sched_port_qsize(port, qindex);
-		struct rte_sched_queue *queue = port->queue + qindex;
-		uint16_t qr = queue->qr & (qsize - 1);
-		uint16_t qw = queue->qw & (qsize - 1);
+		if (s->memory == NULL)
+			continue;
 
-		for (; qr != qw; qr = (qr + 1) & (qsize - 1))
-			rte_pktmbuf_free(mbufs[qr]);
+		rte_sched_subport_drop_pipes(port, i, 0, s->n_pipes);
+		rte_free(s->memory);
+	}
+
+	for (i = 0; i < port->n_shards; i++) {
+		rte_bitmap_free(port->shards[i]->bmp);
+		rte_free(port->shards[i]);
 	}
 
 	rte_bitmap_free(port->bmp);
 	rte_free(port);
 }
 
+int __rte_experimental
+rte_sched_port_shards_config(struct rte_sched_port *port, uint32_t n_shards)
+{
+	uint32_t n_subports, n_pipes, n_queues, bmp_mem_size, bmp_pos, i;
+	uint64_t bmp_slab;
+
+	/* Check user parameters */
+	if (port == NULL || port->parent != NULL || port->n_shards != 0)
+		return -1;
+
+	if (n_shards == 0 ||
+	    !rte_is_power_of_2(n_shards) ||
+	    n_shards > port->n_subports_per_port ||
+	    n_shards > RTE_SCHED_PORT_N_SHARDS_MAX)
+		return -2;
+
+	/* No packet enqueued yet */
+	if (rte_bitmap_scan(port->bmp, &bmp_pos, &bmp_slab))
+		return -3;
+
+	/* The AQM state of a queue is updated by both the enqueue and the
+	 * dequeue, so it cannot be split between two lcores.
+	 */
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX; i++) {
+#ifdef RTE_SCHED_RED
+		uint32_t j;
+
+		for (j = 0; j < e_RTE_METER_COLORS; j++)
+			if (port->red_config[i][j].min_th != 0 ||
+			    port->red_config[i][j].max_th != 0)
+				return -5;
+#endif
+#ifdef RTE_SCHED_PIE
+		if (port->pie_config[i].qdelay_ref != 0)
+			return -5;
+#endif
+	}
+
+	n_subports = port->n_subports_per_port / n_shards;
+	n_pipes = n_subports * port->n_pipes_per_subport;
+	n_queues = n_pipes * port->shape.n_queues;
+	bmp_mem_size = rte_bitmap_get_memory_footprint(n_queues);
+
+	for (i = 0; i < n_shards; i++) {
+		struct rte_sched_port *shard;
+
+		shard = rte_zmalloc_socket("qos_shard",
+			sizeof(struct rte_sched_port) + bmp_mem_size,
+			RTE_CACHE_LINE_SIZE, port->socket);
+		if (shard == NULL)
+			goto error;
+
+		/* The shard is a port made of a slice of the subports */
+		memcpy(shard, port, sizeof(struct rte_sched_port));
+		shard->n_subports_per_port = n_subports;
+		shard->parent = port;
+
+		shard->subport = port->subport + i * n_subports;
+
+		/* Each shard has its own bitmap and grinders */
+		shard->bmp_array = shard->memory;
+		shard->bmp = rte_bitmap_init(n_queues, shard->bmp_array,
+					     bmp_mem_size);
+		if (shard->bmp == NULL) {
+			RTE_LOG(ERR, SCHED, "Bitmap init error\n");
+			rte_free(shard);
+			goto error;
+		}
+
+		rte_sched_port_grinders_flush(shard);
+		shard->pkts_out = NULL;
+		shard->n_pkts_out = 0;
+
+		port->shards[i] = shard;
+	}
+
+	port->shard_qshift = rte_bsf32(n_queues);
+	port->shard_qmask = n_queues - 1;
+	port->n_shards = n_shards;
+
+	return 0;
+
+error:
+	while (i-- > 0) {
+		rte_free(port->shards[i]);
+		port->shards[i] = NULL;
+	}
+
+	return -4;
+}
+
 static void
 rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 {
@@ -812,7 +1324,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	if (params->tb_size == 0)
 		return -3;
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->shape.n_tcs; i++) {
 		if (params->tc_rate[i] == 0 ||
 		    params->tc_rate[i] > params->tb_rate)
 			return -4;
@@ -823,6 +1335,12 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 	s = port->subport + subport_id;
 
+	/* Pipes and queues, allocated on first configuration */
+	if (s->memory == NULL &&
+	    rte_sched_subport_config_pipes(port, subport_id,
+			port->n_pipes_per_subport, NULL, 0) != 0)
+		return -6;
+
 	/* Token Bucket (TB) */
 	if (params->tb_rate == port->rate) {
 		s->tb_credits_per_period = 1;
@@ -840,25 +1358,25 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	s->tc_period = rte_sched_time_ms_to_bytes(params->tc_period, port->rate);
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->shape.n_tcs; i++) {
 		s->tc_credits_per_period[i]
 			= rte_sched_time_ms_to_bytes(params->tc_period,
 						     params->tc_rate[i]);
 	}
 	s->tc_time = port->time + s->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+	for (i = 0; i < port->shape.n_tcs; i++)
 		s->tc_credits[i] = s->tc_credits_per_period[i];
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	/* TC oversubscription */
 	s->tc_ov_wm_min = port->mtu;
 	s->tc_ov_wm_max = rte_sched_time_ms_to_bytes(params->tc_period,
-						     port->pipe_tc3_rate_max);
+						     s->pipe_tc_be_rate_max);
 	s->tc_ov_wm = s->tc_ov_wm_max;
 	s->tc_ov_period_id = 0;
-	s->tc_ov = 0;
-	s->tc_ov_n = 0;
-	s->tc_ov_rate = 0;
+
+	/* Pipes already enabled, when the subport rates change */
+	rte_sched_subport_config_tc_ov(port, s);
 #endif
 
 	rte_sched_port_log_subport_config(port, subport_id);
@@ -876,6 +1394,9 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	struct rte_sched_pipe *p;
 	struct rte_sched_pipe_profile *params;
 	uint32_t deactivate, profile, i;
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	uint32_t tc_be = port->shape.n_tcs - 1;
+#endif
 
 	/* Check user parameters */
 	profile = (uint32_t) pipe_profile;
@@ -883,8 +1404,7 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 
 	if (port == NULL ||
 	    subport_id >= port->n_subports_per_port ||
-	    pipe_id >= port->n_pipes_per_subport ||
-	    (!deactivate && profile >= port->n_pipe_profiles))
+	    pipe_id >= port->n_pipes_per_subport)
 		return -1;
 
 
@@ -893,28 +1413,36 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	if (s->tb_period == 0)
 		return -2;
 
-	p = port->pipe + (subport_id * port->n_pipes_per_subport + pipe_id);
+	/* Pipe and profile within the subport ones */
+	if (pipe_id >= s->n_pipes ||
+	    (!deactivate && profile >= s->n_pipe_profiles))
+		return -3;
+
+	p = s->pipe + pipe_id;
 
 	/* Handle the case when pipe already has a valid configuration */
-	if (p->tb_time) {
-		params = port->pipe_profiles + p->profile;
+	if (p->enabled) {
+		params = s->pipe_profiles + p->profile;
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		double subport_tc3_rate = (double) s->tc_credits_per_period[3]
+		double subport_tc_be_rate =
+			(double) s->tc_credits_per_period[tc_be]
 			/ (double) s->tc_period;
-		double pipe_tc3_rate = (double) params->tc_credits_per_period[3]
+		double pipe_tc_be_rate =
+			(double) params->tc_credits_per_period[tc_be]
 			/ (double) params->tc_period;
-		uint32_t tc3_ov = s->tc_ov;
+		uint32_t tc_be_ov = s->tc_ov;
 
 		/* Unplug pipe from its subport */
 		s->tc_ov_n -= params->tc_ov_weight;
-		s->tc_ov_rate -= pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate -= pipe_tc_be_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_be_rate;
 
-		if (s->tc_ov != tc3_ov) {
+		if (s->tc_ov != tc_be_ov) {
 			RTE_LOG(DEBUG, SCHED,
-				"Subport %u TC3 oversubscription is OFF (%.4lf >= %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+				"Subport %u TC%u oversubscription is OFF (%.4lf >= %.4lf)\n",
+				subport_id, tc_be, subport_tc_be_rate,
+				s->tc_ov_rate);
 		}
 #endif
 
@@ -927,7 +1455,8 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 
 	/* Apply the new pipe configuration */
 	p->profile = profile;
-	params = port->pipe_profiles + p->profile;
+	p->enabled = 1;
+	params = s->pipe_profiles + p->profile;
 
 	/* Token Bucket (TB) */
 	p->tb_time = port->time;
@@ -935,26 +1464,29 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	p->tc_time = port->time + params->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+	for (i = 0; i < port->shape.n_tcs; i++)
 		p->tc_credits[i] = params->tc_credits_per_period[i];
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	{
-		/* Subport TC3 oversubscription */
-		double subport_tc3_rate = (double) s->tc_credits_per_period[3]
+		/* Subport lowest priority TC oversubscription */
+		double subport_tc_be_rate =
+			(double) s->tc_credits_per_period[tc_be]
 			/ (double) s->tc_period;
-		double pipe_tc3_rate = (double) params->tc_credits_per_period[3]
+		double pipe_tc_be_rate =
+			(double) params->tc_credits_per_period[tc_be]
 			/ (double) params->tc_period;
-		uint32_t tc3_ov = s->tc_ov;
+		uint32_t tc_be_ov = s->tc_ov;
 
 		s->tc_ov_n += params->tc_ov_weight;
-		s->tc_ov_rate += pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate += pipe_tc_be_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_be_rate;
 
-		if (s->tc_ov != tc3_ov) {
+		if (s->tc_ov != tc_be_ov) {
 			RTE_LOG(DEBUG, SCHED,
-				"Subport %u TC3 oversubscription is ON (%.4lf < %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+				"Subport %u TC%u oversubscription is ON (%.4lf < %.4lf)\n",
+				subport_id, tc_be, subport_tc_be_rate,
+				s->tc_ov_rate);
 		}
 		p->tc_ov_period_id = s->tc_ov_period_id;
 		p->tc_ov_credits = s->tc_ov_wm;
@@ -978,16 +1510,16 @@ rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
 		return -1;
 
 	/* Pipe profiles not exceeds the max limit */
-	if (port->n_pipe_profiles >= RTE_SCHED_PIPE_PROFILES_PER_PORT)
+	if (port->n_pipe_profiles >= port->n_max_pipe_profiles)
 		return -2;
 
 	/* Pipe params */
-	status = pipe_profile_check(params, port->rate);
+	status = pipe_profile_check(params, port->rate, &port->shape);
 	if (status != 0)
 		return status;
 
 	pp = &port->pipe_profiles[port->n_pipe_profiles];
-	rte_sched_pipe_profile_convert(params, pp, port->rate);
+	rte_sched_pipe_profile_convert(params, pp, port->rate, &port->shape);
 
 	/* Pipe profile not exists */
 	for (i = 0; i < port->n_pipe_profiles; i++)
@@ -998,10 +1530,96 @@ rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
 	*pipe_profile_id = port->n_pipe_profiles;
 	port->n_pipe_profiles++;
 
-	if (port->pipe_tc3_rate_max < params->tc_rate[3])
-		port->pipe_tc3_rate_max = params->tc_rate[3];
+	if (port->pipe_tc_be_rate_max < params->tc_rate[port->shape.n_tcs - 1])
+		port->pipe_tc_be_rate_max = params->tc_rate[port->shape.n_tcs - 1];
+
+	/* Subports sharing the port pipe profile table */
+	for (i = 0; i < port->n_subports_per_port; i++) {
+		struct rte_sched_subport *s = port->subport + i;
+
+		if (s->pipe_profiles != port->pipe_profiles)
+			continue;
 
-	rte_sched_port_log_pipe_profile(port, *pipe_profile_id);
+		s->n_pipe_profiles = port->n_pipe_profiles;
+		s->pipe_tc_be_rate_max = port->pipe_tc_be_rate_max;
+	}
+
+	rte_sched_port_log_pipe_profile(port->pipe_profiles, *pipe_profile_id);
+
+	return 0;
+}
+
+int __rte_experimental
+rte_sched_subport_pipes_config(struct rte_sched_port *port,
+	uint32_t subport_id,
+	struct rte_sched_subport_pipes_params *params)
+{
+	struct rte_sched_subport *s;
+	uint32_t n_pipe_profiles, n_pipes_kept, i;
+	int status;
+
+	/* Check user parameters */
+	if (port == NULL ||
+	    subport_id >= port->n_subports_per_port ||
+	    params == NULL)
+		return -1;
+
+	s = port->subport + subport_id;
+	if (s->tb_period == 0)
+		return -2;
+
+	if (params->n_pipes == 0 ||
+	    params->n_pipes > port->n_pipes_per_subport)
+		return -3;
+
+	n_pipe_profiles = s->n_pipe_profiles;
+	if (params->pipe_profiles != NULL) {
+		if (params->n_pipe_profiles == 0 ||
+		    params->n_pipe_profiles >
+				RTE_SCHED_PIPE_PROFILES_PER_PORT_MAX)
+			return -4;
+
+		for (i = 0; i < params->n_pipe_profiles; i++) {
+			status = pipe_profile_check(params->pipe_profiles + i,
+						    port->rate, &port->shape);
+			if (status != 0)
+				return status;
+		}
+
+		n_pipe_profiles = params->n_pipe_profiles;
+	}
+
+	/* The pipes kept keep their profile ID */
+	n_pipes_kept = RTE_MIN(params->n_pipes, s->n_pipes);
+	for (i = 0; i < n_pipes_kept; i++) {
+		struct rte_sched_pipe *p = s->pipe + i;
+
+		if (p->enabled && p->profile >= n_pipe_profiles)
+			return -5;
+	}
+
+	/* No grinder is to reference the pipes and queues being moved */
+	if (port->n_shards == 0)
+		rte_sched_port_grinders_flush(port);
+	else
+		rte_sched_port_grinders_flush(port->shards[subport_id /
+			port->shards[0]->n_subports_per_port]);
+
+	if (rte_sched_subport_config_pipes(port, subport_id, params->n_pipes,
+			params->pipe_profiles, params->n_pipe_profiles) != 0)
+		return -6;
+
+#ifdef RTE_SCHED_SUBPORT_TC_OV
+	/* Lowest priority TC oversubscription of the pipes left */
+	s->tc_ov_wm_max = (uint64_t) s->tc_period * s->pipe_tc_be_rate_max /
+		port->rate;
+	if (s->tc_ov_wm > s->tc_ov_wm_max)
+		s->tc_ov_wm = s->tc_ov_wm_max;
+	rte_sched_subport_config_tc_ov(port, s);
+#endif
+
+	RTE_LOG(DEBUG, SCHED, "Subport %u: %u pipes, %u pipe profiles\n",
+		subport_id, s->n_pipes, s->n_pipe_profiles);
 
 	return 0;
 }
@@ -1087,12 +1705,17 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 		(qlen == NULL)) {
 		return -1;
 	}
-	q = port->queue + queue_id;
-	qe = port->queue_extra + queue_id;
+	q = rte_sched_port_queue(port, queue_id);
+	if (q == NULL)
+		return -1;
+	qe = rte_sched_port_queue_extra(port, queue_id);
 
 	/* Copy queue stats and clear */
 	memcpy(stats, &qe->stats, sizeof(struct rte_sched_queue_stats));
 	memset(&qe->stats, 0, sizeof(struct rte_sched_queue_stats));
+#ifdef RTE_SCHED_PIE
+	stats->pie_drop_prob = qe->pie.drop_prob;
+#endif
 
 	/* Queue length */
 	*qlen = q->qw - q->qr;
@@ -1103,21 +1726,49 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 static inline uint32_t
 rte_sched_port_qindex(struct rte_sched_port *port, uint32_t subport, uint32_t pipe, uint32_t traffic_class, uint32_t queue)
 {
+	struct rte_sched_pipe_shape *shape = &port->shape;
 	uint32_t result;
 
+#ifdef RTE_SCHED_DEBUG
+	if (traffic_class >= shape->n_tcs ||
+	    queue >= shape->tc_n_queues[traffic_class])
+		rte_panic("TC %u queue %u out of the pipe shape\n",
+			  traffic_class, queue);
+#endif
+
 	result = subport * port->n_pipes_per_subport + pipe;
-	result = result * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE + traffic_class;
-	result = result * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + queue;
+	result = (result << shape->n_queues_log2) + shape->tc_qpos[traffic_class] +
+		(queue & (shape->tc_n_queues[traffic_class] - 1));
 
 	return result;
 }
 
+int __rte_experimental
+rte_sched_port_queue_id(struct rte_sched_port *port,
+	uint32_t subport, uint32_t pipe, uint32_t traffic_class,
+	uint32_t queue, uint32_t *queue_id)
+{
+	/* Check user parameters */
+	if (port == NULL ||
+	    subport >= port->n_subports_per_port ||
+	    pipe >= port->n_pipes_per_subport ||
+	    traffic_class >= port->shape.n_tcs ||
+	    queue >= port->shape.tc_n_queues[traffic_class] ||
+	    queue_id == NULL)
+		return -1;
+
+	*queue_id = rte_sched_port_qindex(port, subport, pipe, traffic_class,
+					  queue);
+
+	return 0;
+}
+
 #ifdef RTE_SCHED_DEBUG
 
 static inline int
 rte_sched_port_queue_is_empty(struct rte_sched_port *port, uint32_t qindex)
 {
-	struct rte_sched_queue *queue = port->queue + qindex;
+	struct rte_sched_queue *queue = rte_sched_port_queue(port, qindex);
 
 	return queue->qr == queue->qw;
 }
@@ -1129,66 +1780,81 @@ rte_sched_port_queue_is_empty(struct rte_sched_port *port, uint32_t qindex)
 static inline void
 rte_sched_port_update_subport_stats(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
 {
-	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	struct rte_sched_subport *s = rte_sched_port_subport(port, qindex);
+	uint32_t tc_index = rte_sched_port_queue_tc(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc[tc_index] += 1;
 	s->stats.n_bytes_tc[tc_index] += pkt_len;
 }
 
-#ifdef RTE_SCHED_RED
+#if defined(RTE_SCHED_RED) || defined(RTE_SCHED_PIE)
 static inline void
 rte_sched_port_update_subport_stats_on_drop(struct rte_sched_port *port,
 						uint32_t qindex,
-						struct rte_mbuf *pkt, uint32_t red)
+						struct rte_mbuf *pkt, uint32_t aqm)
 #else
 static inline void
 rte_sched_port_update_subport_stats_on_drop(struct rte_sched_port *port,
 						uint32_t qindex,
-						struct rte_mbuf *pkt, __rte_unused uint32_t red)
+						struct rte_mbuf *pkt, __rte_unused uint32_t aqm)
 #endif
 {
-	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	struct rte_sched_subport *s = rte_sched_port_subport(port, qindex);
+	uint32_t tc_index = rte_sched_port_queue_tc(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc_dropped[tc_index] += 1;
 	s->stats.n_bytes_tc_dropped[tc_index] += pkt_len;
+#ifdef RTE_SCHED_PIE
+	if (port->pie_config[tc_index].qdelay_ref != 0) {
+		s->stats.n_pkts_pie_dropped[tc_index] += aqm;
+		return;
+	}
+#endif
 #ifdef RTE_SCHED_RED
-	s->stats.n_pkts_red_dropped[tc_index] += red;
+	s->stats.n_pkts_red_dropped[tc_index] += aqm;
 #endif
 }
 
 static inline void
 rte_sched_port_update_queue_stats(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
 {
-	struct rte_sched_queue_extra *qe = port->queue_extra + qindex;
+	struct rte_sched_queue_extra *qe =
+		rte_sched_port_queue_extra(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	qe->stats.n_pkts += 1;
 	qe->stats.n_bytes += pkt_len;
 }
 
-#ifdef RTE_SCHED_RED
+#if defined(RTE_SCHED_RED) || defined(RTE_SCHED_PIE)
 static inline void
 rte_sched_port_update_queue_stats_on_drop(struct rte_sched_port *port,
 						uint32_t qindex,
-						struct rte_mbuf *pkt, uint32_t red)
+						struct rte_mbuf *pkt, uint32_t aqm)
 #else
 static inline void
 rte_sched_port_update_queue_stats_on_drop(struct rte_sched_port *port,
 						uint32_t qindex,
-						struct rte_mbuf *pkt, __rte_unused uint32_t red)
+						struct rte_mbuf *pkt, __rte_unused uint32_t aqm)
 #endif
 {
-	struct rte_sched_queue_extra *qe = port->queue_extra + qindex;
+	struct rte_sched_queue_extra *qe =
+		rte_sched_port_queue_extra(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	qe->stats.n_pkts_dropped += 1;
 	qe->stats.n_bytes_dropped += pkt_len;
+#ifdef RTE_SCHED_PIE
+	if (port->pie_config[rte_sched_port_queue_tc(port, qindex)].qdelay_ref
+	    != 0) {
+		qe->stats.n_pkts_pie_dropped += aqm;
+		return;
+	}
+#endif
 #ifdef RTE_SCHED_RED
-	qe->stats.n_pkts_red_dropped += red;
+	qe->stats.n_pkts_red_dropped += aqm;
 #endif
 }
 
@@ -1205,14 +1871,14 @@ rte_sched_port_red_drop(struct rte_sched_port *port, struct rte_mbuf *pkt, uint3
 	uint32_t tc_index;
 	enum rte_meter_color color;
 
-	tc_index = (qindex >> 2) & 0x3;
+	tc_index = rte_sched_port_queue_tc(port, qindex);
 	color = rte_sched_port_pkt_read_color(pkt);
 	red_cfg = &port->red_config[tc_index][color];
 
 	if ((red_cfg->min_th | red_cfg->max_th) == 0)
 		return 0;
 
-	qe = port->queue_extra + qindex;
+	qe = rte_sched_port_queue_extra(port, qindex);
 	red = &qe->red;
 
 	return rte_red_enqueue(red_cfg, red, qlen, port->time);
@@ -1221,7 +1887,8 @@ rte_sched_port_red_drop(struct rte_sched_port *port, struct rte_mbuf *pkt, uint3
 static inline void
 rte_sched_port_set_queue_empty_timestamp(struct rte_sched_port *port, uint32_t qindex)
 {
-	struct rte_sched_queue_extra *qe = port->queue_extra + qindex;
+	struct rte_sched_queue_extra *qe =
+		rte_sched_port_queue_extra(port, qindex);
 	struct rte_red *red = &qe->red;
 
 	rte_red_mark_queue_empty(red, port->time);
@@ -1235,6 +1902,51 @@ rte_sched_port_set_queue_empty_timestamp(struct rte_sched_port *port, uint32_t q
 
 #endif /* RTE_SCHED_RED */
 
+#ifdef RTE_SCHED_PIE
+
+static inline int
+rte_sched_port_pie_drop(struct rte_sched_port *port, struct rte_mbuf *pkt,
+			uint32_t qindex, uint16_t qlen)
+{
+	struct rte_sched_queue_extra *qe;
+	struct rte_pie_config *pie_cfg;
+	uint32_t tc_index;
+
+	tc_index = rte_sched_port_queue_tc(port, qindex);
+	pie_cfg = &port->pie_config[tc_index];
+
+	if (pie_cfg->qdelay_ref == 0)
+		return 0;
+
+	qe = rte_sched_port_queue_extra(port, qindex);
+
+	return rte_pie_enqueue(pie_cfg, &qe->pie, qlen,
+			       pkt->pkt_len + port->frame_overhead, port->time);
+}
+
+static inline void
+rte_sched_port_pie_dequeue(struct rte_sched_port *port, uint32_t qindex,
+			   uint32_t pkt_len)
+{
+	struct rte_sched_queue_extra *qe;
+	uint32_t tc_index;
+
+	tc_index = rte_sched_port_queue_tc(port, qindex);
+	if (port->pie_config[tc_index].qdelay_ref == 0)
+		return;
+
+	qe = rte_sched_port_queue_extra(port, qindex);
+	rte_pie_dequeue(&qe->pie, pkt_len, port->time);
+}
+
+#else
+
+#define rte_sched_port_pie_drop(port, pkt, qindex, qlen)             0
+
+#define rte_sched_port_pie_dequeue(port, qindex, pkt_len)
+
+#endif /* RTE_SCHED_PIE */
+
 #ifdef RTE_SCHED_DEBUG
 
 static inline void
@@ -1264,6 +1976,110 @@ debug_check_queue_slab(struct rte_sched_port *port, uint32_t bmp_pos,
 
 #endif /* RTE_SCHED_DEBUG */
 
+/*
+ * Multi-core mode: the enqueue lcore sets the bit of a queue after making the
+ * packets of the queue visible, while the lcore of the shard clears it once
+ * the queue is drained, so bitmap slabs are updated with atomic operations.
+ */
+static inline void
+rte_sched_bitmap_set_mt(struct rte_bitmap *bmp, uint32_t pos)
+{
+	uint64_t *slab1, *slab2;
+	uint32_t index1, index2, offset1, offset2;
+
+	index2 = pos >> RTE_BITMAP_SLAB_BIT_SIZE_LOG2;
+	offset2 = pos & RTE_BITMAP_SLAB_BIT_MASK;
+	index1 = pos >> (RTE_BITMAP_SLAB_BIT_SIZE_LOG2 +
+			 RTE_BITMAP_CL_BIT_SIZE_LOG2);
+	offset1 = (pos >> RTE_BITMAP_CL_BIT_SIZE_LOG2) &
+		RTE_BITMAP_SLAB_BIT_MASK;
+	slab2 = bmp->array2 + index2;
+	slab1 = bmp->array1 + index1;
+
+	__atomic_fetch_or(slab2, 1llu << offset2, __ATOMIC_SEQ_CST);
+
+	/* A clear of the array1 bit racing with this check sees the array2
+	 * bit set above, and sets the array1 bit back.
+	 */
+	if ((__atomic_load_n(slab1, __ATOMIC_SEQ_CST) &
+	     (1llu << offset1)) == 0)
+		__atomic_fetch_or(slab1, 1llu << offset1, __ATOMIC_SEQ_CST);
+}
+
+static inline void
+rte_sched_bitmap_clear_mt(struct rte_bitmap *bmp, uint32_t pos)
+{
+	uint64_t *slab1, *slab2;
+	uint32_t index1, index2, offset1, offset2;
+
+	/* Clear bit in array2 slab */
+	index2 = pos >> RTE_BITMAP_SLAB_BIT_SIZE_LOG2;
+	offset2 = pos & RTE_BITMAP_SLAB_BIT_MASK;
+	slab2 = bmp->array2 + index2;
+
+	if (__atomic_and_fetch(slab2, ~(1llu << offset2), __ATOMIC_SEQ_CST))
+		return;
+
+	/* Check the entire cache line of array2 for all-zeros */
+	index2 &= ~RTE_BITMAP_CL_SLAB_MASK;
+	slab2 = bmp->array2 + index2;
+	if (__rte_bitmap_line_not_empty(slab2))
+		return;
+
+	/* Clear bit in array1 slab, then set it back if another bit of the
+	 * array2 cache line was set in the meantime.
+	 */
+	index1 = pos >> (RTE_BITMAP_SLAB_BIT_SIZE_LOG2 +
+			 RTE_BITMAP_CL_BIT_SIZE_LOG2);
+	offset1 = (pos >> RTE_BITMAP_CL_BIT_SIZE_LOG2) &
+		RTE_BITMAP_SLAB_BIT_MASK;
+	slab1 = bmp->array1 + index1;
+
+	__atomic_fetch_and(slab1, ~(1llu << offset1), __ATOMIC_SEQ_CST);
+	if (__rte_bitmap_line_not_empty(slab2))
+		__atomic_fetch_or(slab1, 1llu << offset1, __ATOMIC_SEQ_CST);
+}
+
+/* Read pointer of a queue, as seen by the enqueue operation */
+static inline uint16_t
+rte_sched_port_queue_qr(struct rte_sched_port *port,
+			struct rte_sched_queue *q)
+{
+	if (likely(port->n_shards == 0))
+		return q->qr;
+
+	return __atomic_load_n(&q->qr, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Deactivate a queue the dequeue operation just read a packet from, if that
+ * was the last one. In multi-core mode, a packet enqueued after the queue was
+ * found empty may have seen the bit of the queue still set, so the queue is
+ * checked again once the bit is cleared.
+ */
+static inline int
+rte_sched_port_queue_deactivate(struct rte_sched_port *port,
+				struct rte_sched_queue *q, uint32_t qindex)
+{
+	if (likely(port->parent == NULL)) {
+		if (q->qr != q->qw)
+			return 0;
+
+		rte_bitmap_clear(port->bmp, qindex);
+		return 1;
+	}
+
+	if (q->qr != __atomic_load_n(&q->qw, __ATOMIC_ACQUIRE))
+		return 0;
+
+	rte_sched_bitmap_clear_mt(port->bmp, qindex);
+	if (q->qr == __atomic_load_n(&q->qw, __ATOMIC_SEQ_CST))
+		return 1;
+
+	rte_sched_bitmap_set_mt(port->bmp, qindex);
+	return 0;
+}
+
 static inline uint32_t
 rte_sched_port_enqueue_qptrs_prefetch0(struct rte_sched_port *port,
 				       struct rte_mbuf *pkt)
@@ -1277,10 +2093,13 @@ rte_sched_port_enqueue_qptrs_prefetch0(struct rte_sched_port *port,
 	rte_sched_port_pkt_read_tree_path(pkt, &subport, &pipe, &traffic_class, &queue);
 
 	qindex = rte_sched_port_qindex(port, subport, pipe, traffic_class, queue);
-	q = port->queue + qindex;
+	q = rte_sched_port_queue(port, qindex);
+	if (unlikely(q == NULL))
+		return qindex;
+
 	rte_prefetch0(q);
 #ifdef RTE_SCHED_COLLECT_STATS
-	qe = port->queue_extra + qindex;
+	qe = rte_sched_port_queue_extra(port, qindex);
 	rte_prefetch0(qe);
 #endif
 
@@ -1295,12 +2114,19 @@ rte_sched_port_enqueue_qwa_prefetch0(struct rte_sched_port *port,
 	struct rte_mbuf **q_qw;
 	uint16_t qsize;
 
-	q = port->queue + qindex;
+	q = rte_sched_port_queue(port, qindex);
+	if (unlikely(q == NULL))
+		return;
+
 	qsize = rte_sched_port_qsize(port, qindex);
 	q_qw = qbase + (q->qw & (qsize - 1));
 
 	rte_prefetch0(q_qw);
-	rte_bitmap_prefetch0(port->bmp, qindex);
+	if (likely(port->n_shards == 0))
+		rte_bitmap_prefetch0(port->bmp, qindex);
+	else
+		rte_bitmap_prefetch0(rte_sched_port_shard_bmp(port, &qindex),
+				     qindex);
 }
 
 static inline int
@@ -1311,13 +2137,24 @@ rte_sched_port_enqueue_qwa(struct rte_sched_port *port, uint32_t qindex,
 	uint16_t qsize;
 	uint16_t qlen;
 
-	q = port->queue + qindex;
+	/* Drop the packet when its pipe is beyond the subport ones */
+	q = rte_sched_port_queue(port, qindex);
+	if (unlikely(q == NULL)) {
+		rte_pktmbuf_free(pkt);
+		return 0;
+	}
+
 	qsize = rte_sched_port_qsize(port, qindex);
-	qlen = q->qw - q->qr;
+	qlen = q->qw - rte_sched_port_queue_qr(port, q);
 
-	/* Drop the packet (and update drop stats) when queue is full */
+	/* Drop the packet (and update drop stats) when queue is full or
+	 * when the AQM of the traffic class decides so. PIE only sees the
+	 * packets that fit in the queue, as it tracks the queue length in
+	 * bytes.
+	 */
 	if (unlikely(rte_sched_port_red_drop(port, pkt, qindex, qlen) ||
-		     (qlen >= qsize))) {
+		     (qlen >= qsize) ||
+		     rte_sched_port_pie_drop(port, pkt, qindex, qlen))) {
 		rte_pktmbuf_free(pkt);
 #ifdef RTE_SCHED_COLLECT_STATS
 		rte_sched_port_update_subport_stats_on_drop(port, qindex, pkt,
@@ -1330,10 +2167,20 @@ rte_sched_port_enqueue_qwa(struct rte_sched_port *port, uint32_t qindex,
 
 	/* Enqueue packet */
 	qbase[q->qw & (qsize - 1)] = pkt;
-	q->qw++;
 
 	/* Activate queue in the port bitmap */
-	rte_bitmap_set(port->bmp, qindex);
+	if (likely(port->n_shards == 0)) {
+		q->qw++;
+		rte_bitmap_set(port->bmp, qindex);
+	} else {
+		uint32_t shard_qindex = qindex;
+		struct rte_bitmap *bmp =
+			rte_sched_port_shard_bmp(port, &shard_qindex);
+
+		/* Publish the packet before activating the queue */
+		__atomic_store_n(&q->qw, q->qw + 1, __ATOMIC_RELEASE);
+		rte_sched_bitmap_set_mt(bmp, shard_qindex);
+	}
 
 	/* Statistics */
 #ifdef RTE_SCHED_COLLECT_STATS
@@ -1540,19 +2387,15 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Subport TCs */
 	if (unlikely(port->time >= subport->tc_time)) {
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		memcpy(subport->tc_credits, subport->tc_credits_per_period,
+		       port->shape.n_tcs * sizeof(uint32_t));
 		subport->tc_time = port->time + subport->tc_period;
 	}
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		memcpy(pipe->tc_credits, params->tc_credits_per_period,
+		       port->shape.n_tcs * sizeof(uint32_t));
 		pipe->tc_time = port->time + params->tc_period;
 	}
 }
@@ -1564,22 +2407,24 @@ grinder_tc_ov_credits_update(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_subport *subport = grinder->subport;
-	uint32_t tc_ov_consumption[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_ov_consumption[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	uint32_t tc_ov_consumption_max;
 	uint32_t tc_ov_wm = subport->tc_ov_wm;
+	uint32_t tc_be = port->shape.n_tcs - 1;
+	uint32_t i;
 
 	if (subport->tc_ov == 0)
 		return subport->tc_ov_wm_max;
 
-	tc_ov_consumption[0] = subport->tc_credits_per_period[0] - subport->tc_credits[0];
-	tc_ov_consumption[1] = subport->tc_credits_per_period[1] - subport->tc_credits[1];
-	tc_ov_consumption[2] = subport->tc_credits_per_period[2] - subport->tc_credits[2];
-	tc_ov_consumption[3] = subport->tc_credits_per_period[3] - subport->tc_credits[3];
+	for (i = 0; i <= tc_be; i++)
+		tc_ov_consumption[i] = subport->tc_credits_per_period[i] -
+			subport->tc_credits[i];
 
-	tc_ov_consumption_max = subport->tc_credits_per_period[3] -
-		(tc_ov_consumption[0] + tc_ov_consumption[1] + tc_ov_consumption[2]);
+	tc_ov_consumption_max = subport->tc_credits_per_period[tc_be];
+	for (i = 0; i < tc_be; i++)
+		tc_ov_consumption_max -= tc_ov_consumption[i];
 
-	if (tc_ov_consumption[3] > (tc_ov_consumption_max - port->mtu)) {
+	if (tc_ov_consumption[tc_be] > (tc_ov_consumption_max - port->mtu)) {
 		tc_ov_wm  -= tc_ov_wm >> 7;
 		if (tc_ov_wm < subport->tc_ov_wm_min)
 			tc_ov_wm = subport->tc_ov_wm_min;
@@ -1619,10 +2464,8 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 	if (unlikely(port->time >= subport->tc_time)) {
 		subport->tc_ov_wm = grinder_tc_ov_credits_update(port, pos);
 
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		memcpy(subport->tc_credits, subport->tc_credits_per_period,
+		       port->shape.n_tcs * sizeof(uint32_t));
 
 		subport->tc_time = port->time + subport->tc_period;
 		subport->tc_ov_period_id++;
@@ -1630,10 +2473,8 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		memcpy(pipe->tc_credits, params->tc_credits_per_period,
+		       port->shape.n_tcs * sizeof(uint32_t));
 		pipe->tc_time = port->time + params->tc_period;
 	}
 
@@ -1698,9 +2539,8 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	uint32_t subport_tc_credits = subport->tc_credits[tc_index];
 	uint32_t pipe_tb_credits = pipe->tb_credits;
 	uint32_t pipe_tc_credits = pipe->tc_credits[tc_index];
-	uint32_t pipe_tc_ov_mask1[] = {UINT32_MAX, UINT32_MAX, UINT32_MAX, pipe->tc_ov_credits};
-	uint32_t pipe_tc_ov_mask2[] = {0, 0, 0, UINT32_MAX};
-	uint32_t pipe_tc_ov_credits = pipe_tc_ov_mask1[tc_index];
+	uint32_t tc_be = tc_index == port->shape.n_tcs - 1;
+	uint32_t pipe_tc_ov_credits = tc_be ? pipe->tc_ov_credits : UINT32_MAX;
 	int enough_credits;
 
 	/* Check pipe and subport credits */
@@ -1718,7 +2558,7 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	subport->tc_credits[tc_index] -= pkt_len;
 	pipe->tb_credits -= pkt_len;
 	pipe->tc_credits[tc_index] -= pkt_len;
-	pipe->tc_ov_credits -= pipe_tc_ov_mask2[tc_index] & pkt_len;
+	pipe->tc_ov_credits -= tc_be ? pkt_len : 0;
 
 	return 1;
 }
@@ -1731,6 +2571,7 @@ grinder_schedule(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_queue *queue = grinder->queue[grinder->qpos];
+	uint32_t qindex = grinder->qindex[grinder->qpos];
 	struct rte_mbuf *pkt = grinder->pkt;
 	uint32_t pkt_len = pkt->pkt_len + port->frame_overhead;
 
@@ -1739,15 +2580,17 @@ grinder_schedule(struct rte_sched_port *port, uint32_t pos)
 
 	/* Advance port time */
 	port->time += pkt_len;
+	rte_sched_port_pie_dequeue(port, qindex, pkt_len);
 
 	/* Send packet */
 	port->pkts_out[port->n_pkts_out++] = pkt;
-	queue->qr++;
+	if (likely(port->parent == NULL))
+		queue->qr++;
+	else
+		/* Hand the slot back to the enqueue lcore */
+		__atomic_store_n(&queue->qr, queue->qr + 1, __ATOMIC_RELEASE);
 	grinder->wrr_tokens[grinder->qpos] += pkt_len * grinder->wrr_cost[grinder->qpos];
-	if (queue->qr == queue->qw) {
-		uint32_t qindex = grinder->qindex[grinder->qpos];
-
-		rte_bitmap_clear(port->bmp, qindex);
+	if (rte_sched_port_queue_deactivate(port, queue, qindex)) {
 		grinder->qmask &= ~(1 << grinder->qpos);
 		grinder->wrr_mask[grinder->qpos] = 0;
 		rte_sched_port_set_queue_empty_timestamp(port, qindex);
@@ -1820,62 +2663,44 @@ static inline void
 grinder_pcache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t bmp_pos, uint64_t bmp_slab)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint16_t w[4];
+	uint32_t n_queues = port->shape.n_queues;
+	uint64_t pipe_mask = (1llu << n_queues) - 1;
+	uint32_t i;
 
 	grinder->pcache_w = 0;
 	grinder->pcache_r = 0;
 
-	w[0] = (uint16_t) bmp_slab;
-	w[1] = (uint16_t) (bmp_slab >> 16);
-	w[2] = (uint16_t) (bmp_slab >> 32);
-	w[3] = (uint16_t) (bmp_slab >> 48);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[0];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos;
-	grinder->pcache_w += (w[0] != 0);
+	/* One slab covers 64 / n_queues pipes */
+	for (i = 0; i < 64; i += n_queues) {
+		uint16_t w = (uint16_t) ((bmp_slab >> i) & pipe_mask);
 
-	grinder->pcache_qmask[grinder->pcache_w] = w[1];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 16;
-	grinder->pcache_w += (w[1] != 0);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[2];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 32;
-	grinder->pcache_w += (w[2] != 0);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[3];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 48;
-	grinder->pcache_w += (w[3] != 0);
+		grinder->pcache_qmask[grinder->pcache_w] = w;
+		grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + i;
+		grinder->pcache_w += (w != 0);
+	}
 }
 
 static inline void
 grinder_tccache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t qindex, uint16_t qmask)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint8_t b[4];
+	struct rte_sched_pipe_shape *shape = &port->shape;
+	uint32_t tc;
 
 	grinder->tccache_w = 0;
 	grinder->tccache_r = 0;
 
-	b[0] = (uint8_t) (qmask & 0xF);
-	b[1] = (uint8_t) ((qmask >> 4) & 0xF);
-	b[2] = (uint8_t) ((qmask >> 8) & 0xF);
-	b[3] = (uint8_t) ((qmask >> 12) & 0xF);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[0];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex;
-	grinder->tccache_w += (b[0] != 0);
+	/* Only the queues of the pipe shape are looked at */
+	for (tc = 0; tc < shape->n_tcs; tc++) {
+		uint32_t qpos = shape->tc_qpos[tc];
+		uint8_t b = (uint8_t) ((qmask >> qpos) &
+				       ((1 << shape->tc_n_queues[tc]) - 1));
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[1];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 4;
-	grinder->tccache_w += (b[1] != 0);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[2];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 8;
-	grinder->tccache_w += (b[2] != 0);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[3];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 12;
-	grinder->tccache_w += (b[3] != 0);
+		grinder->tccache_qmask[grinder->tccache_w] = b;
+		grinder->tccache_qindex[grinder->tccache_w] = qindex + qpos;
+		grinder->tccache_tc[grinder->tccache_w] = tc;
+		grinder->tccache_w += (b != 0);
+	}
 }
 
 static inline int
@@ -1883,34 +2708,28 @@ grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_mbuf **qbase;
-	uint32_t qindex;
+	uint32_t qindex, tc_index, i;
 	uint16_t qsize;
 
 	if (grinder->tccache_r == grinder->tccache_w)
 		return 0;
 
 	qindex = grinder->tccache_qindex[grinder->tccache_r];
+	tc_index = grinder->tccache_tc[grinder->tccache_r];
 	qbase = rte_sched_port_qbase(port, qindex);
-	qsize = rte_sched_port_qsize(port, qindex);
+	qsize = port->qsize[tc_index];
 
-	grinder->tc_index = (qindex >> 2) & 0x3;
+	grinder->tc_index = tc_index;
+	grinder->tc_n_queues = port->shape.tc_n_queues[tc_index];
 	grinder->qmask = grinder->tccache_qmask[grinder->tccache_r];
 	grinder->qsize = qsize;
 
-	grinder->qindex[0] = qindex;
-	grinder->qindex[1] = qindex + 1;
-	grinder->qindex[2] = qindex + 2;
-	grinder->qindex[3] = qindex + 3;
-
-	grinder->queue[0] = port->queue + qindex;
-	grinder->queue[1] = port->queue + qindex + 1;
-	grinder->queue[2] = port->queue + qindex + 2;
-	grinder->queue[3] = port->queue + qindex + 3;
-
-	grinder->qbase[0] = qbase;
-	grinder->qbase[1] = qbase + qsize;
-	grinder->qbase[2] = qbase + 2 * qsize;
-	grinder->qbase[3] = qbase + 3 * qsize;
+	for (i = 0; i < grinder->tc_n_queues; i++) {
+		grinder->qindex[i] = qindex + i;
+		grinder->queue[i] = grinder->subport->queue +
+			(qindex & port->subport_qmask) + i;
+		grinder->qbase[i] = qbase + i * qsize;
+	}
 
 	grinder->tccache_r++;
 	return 1;
@@ -1935,6 +2754,10 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 		if (unlikely(rte_bitmap_scan(port->bmp, &bmp_pos, &bmp_slab) <= 0))
 			return 0;
 
+		/* Packets of the active queues were written by another lcore */
+		if (port->parent != NULL)
+			rte_smp_rmb();
+
 #ifdef RTE_SCHED_DEBUG
 		debug_check_queue_slab(port, bmp_pos, bmp_slab);
 #endif
@@ -1955,9 +2778,11 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 	}
 
 	/* Install new pipe in the grinder */
-	grinder->pindex = pipe_qindex >> 4;
-	grinder->subport = port->subport + (grinder->pindex / port->n_pipes_per_subport);
-	grinder->pipe = port->pipe + grinder->pindex;
+	grinder->pindex = pipe_qindex >> port->shape.n_queues_log2;
+	grinder->subport = port->subport +
+		(grinder->pindex >> port->n_pipes_per_subport_log2);
+	grinder->pipe = grinder->subport->pipe +
+		(grinder->pindex & (port->n_pipes_per_subport - 1));
 	grinder->pipe_params = NULL; /* to be set after the pipe structure is prefetched */
 	grinder->productive = 0;
 
@@ -1982,9 +2807,25 @@ grinder_wrr_load(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_pipe_profile *pipe_params = grinder->pipe_params;
 	uint32_t tc_index = grinder->tc_index;
 	uint32_t qmask = grinder->qmask;
-	uint32_t qindex;
+	uint32_t qindex, i;
+
+	qindex = port->shape.tc_qpos[tc_index];
 
-	qindex = tc_index * 4;
+	/* TC with 2 queues, the queues 2 and 3 are never picked */
+	if (unlikely(grinder->tc_n_queues != RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)) {
+		for (i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
+			uint32_t exists = i < grinder->tc_n_queues;
+
+			grinder->wrr_tokens[i] = exists ?
+				((uint16_t) pipe->wrr_tokens[qindex + i]) <<
+				RTE_SCHED_WRR_SHIFT : 0;
+			grinder->wrr_mask[i] = ((qmask >> i) & 0x1) * 0xFFFF;
+			grinder->wrr_cost[i] = exists ?
+				pipe_params->wrr_cost[qindex + i] : 0;
+		}
+
+		return;
+	}
 
 	grinder->wrr_tokens[0] = ((uint16_t) pipe->wrr_tokens[qindex]) << RTE_SCHED_WRR_SHIFT;
 	grinder->wrr_tokens[1] = ((uint16_t) pipe->wrr_tokens[qindex + 1]) << RTE_SCHED_WRR_SHIFT;
@@ -2008,9 +2849,22 @@ grinder_wrr_store(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	uint32_t tc_index = grinder->tc_index;
-	uint32_t qindex;
+	uint32_t qindex, i;
 
-	qindex = tc_index * 4;
+	/* Single queue TC: no WRR */
+	if (grinder->tc_n_queues == 1)
+		return;
+
+	qindex = port->shape.tc_qpos[tc_index];
+
+	if (unlikely(grinder->tc_n_queues != RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)) {
+		for (i = 0; i < grinder->tc_n_queues; i++)
+			pipe->wrr_tokens[qindex + i] =
+				(grinder->wrr_tokens[i] & grinder->wrr_mask[i])
+				>> RTE_SCHED_WRR_SHIFT;
+
+		return;
+	}
 
 	pipe->wrr_tokens[qindex] = (grinder->wrr_tokens[0] & grinder->wrr_mask[0])
 		>> RTE_SCHED_WRR_SHIFT;
@@ -2028,6 +2882,10 @@ grinder_wrr(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	uint16_t wrr_tokens_min;
 
+	/* Single queue TC: no WRR */
+	if (grinder->tc_n_queues == 1)
+		return;
+
 	grinder->wrr_tokens[0] |= ~grinder->wrr_mask[0];
 	grinder->wrr_tokens[1] |= ~grinder->wrr_mask[1];
 	grinder->wrr_tokens[2] |= ~grinder->wrr_mask[2];
@@ -2061,6 +2919,27 @@ grinder_prefetch_tc_queue_arrays(struct rte_sched_port *port, uint32_t pos)
 	uint16_t qsize, qr[4];
 
 	qsize = grinder->qsize;
+
+	/* Only the queues of the TC are prefetched */
+	if (grinder->tc_n_queues == 1) {
+		qr[0] = grinder->queue[0]->qr & (qsize - 1);
+		rte_prefetch0(grinder->qbase[0] + qr[0]);
+		grinder->qpos = 0;
+		return;
+	}
+
+	if (unlikely(grinder->tc_n_queues != RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)) {
+		qr[0] = grinder->queue[0]->qr & (qsize - 1);
+		qr[1] = grinder->queue[1]->qr & (qsize - 1);
+
+		rte_prefetch0(grinder->qbase[0] + qr[0]);
+		rte_prefetch0(grinder->qbase[1] + qr[1]);
+
+		grinder_wrr_load(port, pos);
+		grinder_wrr(port, pos);
+		return;
+	}
+
 	qr[0] = grinder->queue[0]->qr & (qsize - 1);
 	qr[1] = grinder->queue[1]->qr & (qsize - 1);
 	qr[2] = grinder->queue[2]->qr & (qsize - 1);
@@ -2118,7 +2997,8 @@ grinder_handle(struct rte_sched_port *port, uint32_t pos)
 	{
 		struct rte_sched_pipe *pipe = grinder->pipe;
 
-		grinder->pipe_params = port->pipe_profiles + pipe->profile;
+		grinder->pipe_params = grinder->subport->pipe_profiles +
+			pipe->profile;
 		grinder_prefetch_tc_queue_arrays(port, pos);
 		grinder_credits_update(port, pos);
 
@@ -2220,16 +3100,15 @@ rte_sched_port_exceptions(struct rte_sched_port *port, int second_pass)
 	return exceptions;
 }
 
-int
-rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+static inline uint32_t
+rte_sched_port_grind(struct rte_sched_port *port, struct rte_mbuf **pkts,
+		     uint32_t n_pkts)
 {
 	uint32_t i, count;
 
 	port->pkts_out = pkts;
 	port->n_pkts_out = 0;
 
-	rte_sched_port_time_resync(port);
-
 	/* Take each queue in the grinder one step further */
 	for (i = 0, count = 0; ; i++)  {
 		count += grinder_handle(port, i & (RTE_SCHED_PORT_N_GRINDERS - 1));
@@ -2241,3 +3120,57 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 
 	return count;
 }
+
+static inline uint32_t
+rte_sched_port_shard_grind(struct rte_sched_port *port,
+	struct rte_sched_port *shard, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	uint64_t time, time_start, n_bytes;
+	uint32_t count;
+
+	rte_sched_port_time_resync(shard);
+
+	/* Catch up with the bytes sent by the other shards */
+	time = __atomic_load_n(&port->time, __ATOMIC_RELAXED);
+	if (shard->time < time)
+		shard->time = time;
+	time_start = shard->time;
+
+	count = rte_sched_port_grind(shard, pkts, n_pkts);
+
+	/* Add the bytes sent by this shard to the port time */
+	n_bytes = shard->time - time_start;
+	if (n_bytes == 0)
+		return count;
+
+	time = __atomic_load_n(&port->time, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&port->time, &time,
+			RTE_MAX(time, time_start) + n_bytes, 0,
+			__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+
+	return count;
+}
+
+int
+rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	if (unlikely(port->n_shards != 0))
+		return rte_sched_port_shard_grind(port, port->shards[0], pkts,
+						  n_pkts);
+
+	rte_sched_port_time_resync(port);
+
+	return rte_sched_port_grind(port, pkts, n_pkts);
+}
+
+int __rte_experimental
+rte_sched_port_shard_dequeue(struct rte_sched_port *port, uint32_t shard_id,
+	struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	if (unlikely(shard_id >= port->n_shards))
+		return -EINVAL;
+
+	return rte_sched_port_shard_grind(port, port->shards[shard_id], pkts,
+					  n_pkts);
+}
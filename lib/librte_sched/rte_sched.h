@@ -41,6 +41,8 @@ extern "C" {
  *           - Traffic shaping using the token bucket algorithm
  *	    (one bucket per pipe);
  *     4. Traffic class:
+ *           - Number of traffic classes and of queues per traffic
+ *	    class set per port (pipe shape);
  *           - Traffic classes of the same pipe handled in strict
  *	    priority order;
  *           - Upper limit enforced per traffic class at the pipe level;
@@ -66,26 +68,51 @@ extern "C" {
 #include "rte_red.h"
 #endif
 
-/** Number of traffic classes per pipe (as well as subport).
- * Cannot be changed.
+/** Proportional Integral controller Enhanced (PIE) */
+#ifdef RTE_SCHED_PIE
+#include "rte_pie.h"
+#endif
+
+/** Number of traffic classes per pipe (as well as subport) of the default
+ * pipe shape, see struct rte_sched_port_params.
  */
 #define RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE    4
 
-/** Number of queues per pipe traffic class. Cannot be changed. */
+/** Maximum number of traffic classes per pipe (as well as subport), sizing
+ * the per traffic class arrays. Cannot be changed.
+ */
+#define RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX 16
+
+/** Maximum number of queues per pipe traffic class, which is also the number
+ * of queues per traffic class of the default pipe shape. Cannot be changed.
+ */
 #define RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS    4
 
-/** Number of queues per pipe. */
+/** Maximum number of queues per pipe, which is also the number of queues per
+ * pipe of the default pipe shape.
+ */
 #define RTE_SCHED_QUEUES_PER_PIPE             \
 	(RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE *     \
 	RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)
 
-/** Maximum number of pipe profiles that can be defined per port.
+/** Default number of pipe profiles that can be defined per port, see
+ * n_max_pipe_profiles of struct rte_sched_port_params.
  * Compile-time configurable.
  */
 #ifndef RTE_SCHED_PIPE_PROFILES_PER_PORT
 #define RTE_SCHED_PIPE_PROFILES_PER_PORT      256
 #endif
 
+/** Maximum number of pipe profiles of a port or subport pipe profile table. */
+#define RTE_SCHED_PIPE_PROFILES_PER_PORT_MAX  (1 << 16)
+
+/** Maximum number of dequeue shards per port, see
+ * rte_sched_port_shards_config(). Compile-time configurable.
+ */
+#ifndef RTE_SCHED_PORT_N_SHARDS_MAX
+#define RTE_SCHED_PORT_N_SHARDS_MAX           16
+#endif
+
 /*
  * Ethernet framing overhead. Overhead fields per Ethernet frame:
  * 1. Preamble:                             7 bytes;
@@ -115,7 +142,7 @@ struct rte_sched_subport_params {
 	uint32_t tb_size;                /**< Size (measured in credits) */
 
 	/* Subport traffic classes */
-	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	/**< Traffic class rates (measured in bytes per second) */
 	uint32_t tc_period;
 	/**< Enforcement period for rates (measured in milliseconds) */
@@ -124,21 +151,26 @@ struct rte_sched_subport_params {
 /** Subport statistics */
 struct rte_sched_subport_stats {
 	/* Packets */
-	uint32_t n_pkts_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pkts_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	/**< Number of packets successfully written */
-	uint32_t n_pkts_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pkts_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	/**< Number of packets dropped */
 
 	/* Bytes */
-	uint32_t n_bytes_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_bytes_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	/**< Number of bytes successfully written for each traffic class */
-	uint32_t n_bytes_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_bytes_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	/**< Number of bytes dropped for each traffic class */
 
 #ifdef RTE_SCHED_RED
-	uint32_t n_pkts_red_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pkts_red_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	/**< Number of packets dropped by red */
 #endif
+
+#ifdef RTE_SCHED_PIE
+	uint32_t n_pkts_pie_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
+	/**< Number of packets dropped by PIE */
+#endif
 };
 
 /*
@@ -156,16 +188,19 @@ struct rte_sched_pipe_params {
 	uint32_t tb_size;                /**< Size (measured in credits) */
 
 	/* Pipe traffic classes */
-	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	/**< Traffic class rates (measured in bytes per second) */
 	uint32_t tc_period;
 	/**< Enforcement period (measured in milliseconds) */
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-	uint8_t tc_ov_weight;		 /**< Weight Traffic class 3 oversubscription */
+	uint8_t tc_ov_weight;
+	/**< Weight of the oversubscription of the lowest priority traffic class */
 #endif
 
 	/* Pipe queues */
-	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE]; /**< WRR weights */
+	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE];
+	/**< WRR weights, indexed by the position of the queue in the pipe.
+	 * Only used by the traffic classes having several queues. */
 };
 
 /** Queue statistics */
@@ -176,10 +211,19 @@ struct rte_sched_queue_stats {
 #ifdef RTE_SCHED_RED
 	uint32_t n_pkts_red_dropped;	 /**< Packets dropped by RED */
 #endif
+#ifdef RTE_SCHED_PIE
+	uint32_t n_pkts_pie_dropped;     /**< Packets dropped by PIE */
+#endif
 
 	/* Bytes */
 	uint32_t n_bytes;                /**< Bytes successfully written */
 	uint32_t n_bytes_dropped;        /**< Bytes dropped */
+
+#ifdef RTE_SCHED_PIE
+	/* PIE */
+	double pie_drop_prob;
+	/**< Current PIE drop probability, not cleared by the stats read */
+#endif
 };
 
 /** Port configuration parameters. */
@@ -194,8 +238,11 @@ struct rte_sched_port_params {
 	uint32_t frame_overhead;         /**< Framing overhead per packet
 					  * (measured in bytes) */
 	uint32_t n_subports_per_port;    /**< Number of subports */
-	uint32_t n_pipes_per_subport;    /**< Number of pipes per subport */
-	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t n_pipes_per_subport;
+	/**< Number of pipes per subport. This is also the maximum number of
+	 * pipes a subport can be resized to at run-time, see
+	 * rte_sched_subport_pipes_config(). */
+	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
 	/**< Packet queue size for each traffic class.
 	 * All queues within the same pipe traffic class have the same
 	 * size. Queues from different pipes serving the same traffic
@@ -204,9 +251,46 @@ struct rte_sched_port_params {
 	/**< Pipe profile table.
 	 * Every pipe is configured using one of the profiles from this table. */
 	uint32_t n_pipe_profiles;        /**< Profiles in the pipe profile table */
+	uint32_t n_max_pipe_profiles;
+	/**< Size of the port pipe profile table, up to which profiles can be
+	 * added with rte_sched_port_pipe_profile_add(). Needs to be no smaller
+	 * than n_pipe_profiles and no bigger than
+	 * RTE_SCHED_PIPE_PROFILES_PER_PORT_MAX. Zero selects
+	 * RTE_SCHED_PIPE_PROFILES_PER_PORT. */
+	uint8_t n_queues_per_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
+	/**< Pipe shape: number of queues of each traffic class (1, 2 or 4),
+	 * the first zero ending the list of traffic classes. The queues of
+	 * a pipe are laid out traffic class after traffic class, and their
+	 * number is rounded up to a power of 2, at least 4 and at most
+	 * RTE_SCHED_QUEUES_PER_PIPE. For instance, {1, 1, 1, 1, 1, 1, 1, 1,
+	 * 1, 1, 1, 1, 4} gives 12 strict priority traffic classes of one
+	 * queue plus a best effort traffic class of 4 WRR queues. All zeros
+	 * select the default shape of RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE
+	 * traffic classes of RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS queues. */
 #ifdef RTE_SCHED_RED
-	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS]; /**< RED parameters */
+	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX][e_RTE_METER_COLORS]; /**< RED parameters */
 #endif
+#ifdef RTE_SCHED_PIE
+	struct rte_pie_params pie_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE_MAX];
+	/**< PIE parameters for each traffic class. PIE is enabled for the
+	 * traffic classes with a non-zero qdelay_ref, which cannot have RED
+	 * enabled at the same time. The queue delay is measured with the port
+	 * time, i.e. in bytes of output port line rate. A port with PIE
+	 * enabled on any traffic class cannot be sharded, see
+	 * rte_sched_port_shards_config(). */
+#endif
+};
+
+/** Subport pipes configuration parameters, see
+ * rte_sched_subport_pipes_config().
+ */
+struct rte_sched_subport_pipes_params {
+	uint32_t n_pipes;
+	/**< Number of pipes of the subport, non-zero and no bigger than the
+	 * n_pipes_per_subport of the port */
+	struct rte_sched_pipe_params *pipe_profiles;
+	/**< Pipe profile table of the subport. NULL keeps the current table */
+	uint32_t n_pipe_profiles;        /**< Profiles in the pipe profile table */
 };
 
 /*
@@ -240,6 +324,10 @@ rte_sched_port_free(struct rte_sched_port *port);
  *
  * Hierarchical scheduler pipe profile add
  *
+ * The profile is added to the port pipe profile table, which is shared by
+ * the subports that were not given their own table with
+ * rte_sched_subport_pipes_config().
+ *
  * @param port
  *   Handle to port scheduler instance
  * @param params
@@ -254,9 +342,57 @@ rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
 	struct rte_sched_pipe_params *params,
 	uint32_t *pipe_profile_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler port multi-core configuration
+ *
+ * Switches the port to a mode where the enqueue and the dequeue operations
+ * can run on different lcores without any external lock: each queue becomes
+ * a lock-free single producer single consumer ring, and the bitmap of active
+ * queues is updated with atomic operations.
+ *
+ * The subports of the port are also split into n_shards groups of
+ * consecutive subports, shard i handling subports i * N / n_shards to
+ * (i + 1) * N / n_shards - 1, N being the number of subports of the port.
+ * Each shard is dequeued with rte_sched_port_shard_dequeue(), possibly on
+ * its own lcore. The shards share the port time, so the subport and pipe
+ * rates remain relative to the output rate of the whole port. A subport,
+ * and thus its pipes, always belongs to a single shard, so its token
+ * buckets and traffic class credits are only updated by that shard.
+ *
+ * As the RED and PIE state of a queue is updated by both the enqueue and
+ * the dequeue operations, a port using RED or PIE on any traffic class
+ * cannot be sharded.
+ *
+ * The enqueue operation stays single producer: rte_sched_port_enqueue()
+ * must not be called concurrently for the same port. Likewise, a given
+ * shard must not be dequeued from several lcores at the same time.
+ *
+ * This function must be called once the port is configured, and before any
+ * packet is enqueued. The mode cannot be reverted.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param n_shards
+ *   Number of dequeue shards. Needs to be a power of 2, no bigger than the
+ *   number of subports of the port and RTE_SCHED_PORT_N_SHARDS_MAX.
+ * @return
+ *   0 upon success, error code otherwise. -5 when RED or PIE is enabled
+ *   for the port.
+ */
+int __rte_experimental
+rte_sched_port_shards_config(struct rte_sched_port *port, uint32_t n_shards);
+
 /**
  * Hierarchical scheduler subport configuration
  *
+ * The first configuration of a subport allocates its pipes and queues, the
+ * subport getting n_pipes_per_subport pipes and the port pipe profile table.
+ * A subport can be configured again at any time to change its rates, without
+ * affecting its pipes and their queues.
+ *
  * @param port
  *   Handle to port scheduler instance
  * @param subport_id
@@ -271,6 +407,40 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	uint32_t subport_id,
 	struct rte_sched_subport_params *params);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler subport pipes configuration
+ *
+ * Changes the number of pipes of a configured subport and/or replaces its
+ * pipe profile table, while packets are queued on the port. The pipes kept
+ * retain their configuration, credits and queued packets, and their pipe
+ * profile ID, which needs to exist in the new table. When the number of
+ * pipes decreases, the packets queued on the pipes removed are dropped. The
+ * queues of the other subports are not affected.
+ *
+ * The queue IDs of the subport do not change, as the n_pipes_per_subport
+ * of the port sets the size of the queue ID space of each subport. Packets
+ * enqueued to a pipe beyond the number of pipes of its subport are dropped.
+ *
+ * This function must not be called while the port is being enqueued or
+ * dequeued.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID
+ * @param params
+ *   Subport pipes configuration parameters
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int __rte_experimental
+rte_sched_subport_pipes_config(struct rte_sched_port *port,
+	uint32_t subport_id,
+	struct rte_sched_subport_pipes_params *params);
+
 /**
  * Hierarchical scheduler pipe configuration
  *
@@ -281,7 +451,9 @@ rte_sched_subport_config(struct rte_sched_port *port,
  * @param pipe_id
  *   Pipe ID within subport
  * @param pipe_profile
- *   ID of port-level pre-configured pipe profile
+ *   ID of pre-configured pipe profile in the pipe profile table of the
+ *   subport, which is the port table unless replaced by
+ *   rte_sched_subport_pipes_config()
  * @return
  *   0 upon success, error code otherwise
  */
@@ -294,6 +466,9 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 /**
  * Hierarchical scheduler memory footprint size per port
  *
+ * The memory of each subport is allocated separately by
+ * rte_sched_subport_config() and included in the footprint.
+ *
  * @param params
  *   Port scheduler configuration parameter structure
  * @return
@@ -335,7 +510,7 @@ rte_sched_subport_read_stats(struct rte_sched_port *port,
  * @param port
  *   Handle to port scheduler instance
  * @param queue_id
- *   Queue ID within port scheduler
+ *   Queue ID within port scheduler, see rte_sched_port_queue_id()
  * @param stats
  *   Pointer to pre-allocated subport statistics structure where the statistics
  *   counters should be stored
@@ -351,10 +526,43 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 	struct rte_sched_queue_stats *stats,
 	uint16_t *qlen);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler queue ID, as used by rte_sched_queue_read_stats(),
+ * of a scheduler hierarchy path. The ID depends on the pipe shape of the
+ * port: it is only equal to ((subport * n_pipes_per_subport + pipe) * 16 +
+ * traffic_class * 4 + queue) for the default pipe shape.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport
+ *   Subport ID
+ * @param pipe
+ *   Pipe ID within subport
+ * @param traffic_class
+ *   Traffic class ID within pipe
+ * @param queue
+ *   Queue ID within pipe traffic class
+ * @param queue_id
+ *   Pointer to pre-allocated variable where the queue ID should be stored
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int __rte_experimental
+rte_sched_port_queue_id(struct rte_sched_port *port,
+	uint32_t subport, uint32_t pipe, uint32_t traffic_class,
+	uint32_t queue, uint32_t *queue_id);
+
 /**
  * Scheduler hierarchy path write to packet descriptor. Typically
  * called by the packet classification stage.
  *
+ * The traffic class and queue are not checked against the pipe shape of
+ * the port by the enqueue operation, except when RTE_SCHED_DEBUG is set,
+ * and have to be validated beforehand, e.g. with rte_sched_port_queue_id().
+ *
  * @param pkt
  *   Packet descriptor handle
  * @param subport
@@ -362,9 +570,11 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
  * @param pipe
  *   Pipe ID within subport
  * @param traffic_class
- *   Traffic class ID within pipe (0 .. 3)
+ *   Traffic class ID within pipe (0 .. 15), lower than the number of
+ *   traffic classes of the pipe shape of the port
  * @param queue
- *   Queue ID within pipe traffic class (0 .. 3)
+ *   Queue ID within pipe traffic class (0 .. 3), lower than the number of
+ *   queues of the traffic class
  * @param color
  *   Packet color set
  */
@@ -386,9 +596,11 @@ rte_sched_port_pkt_write(struct rte_mbuf *pkt,
  * @param pipe
  *   Pipe ID within subport
  * @param traffic_class
- *   Traffic class ID within pipe (0 .. 3)
+ *   Traffic class ID within pipe (0 .. 15), lower than the number of
+ *   traffic classes of the pipe shape of the port
  * @param queue
- *   Queue ID within pipe traffic class (0 .. 3)
+ *   Queue ID within pipe traffic class (0 .. 3), lower than the number of
+ *   queues of the traffic class
  *
  */
 void
@@ -436,10 +648,42 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
  *   Number of packets to dequeue from the port scheduler
  * @return
  *   Number of packets successfully dequeued and placed in the pkts array
+ *
+ * @note
+ *   Once rte_sched_port_shards_config() was called for the port, this
+ *   function only dequeues packets from shard 0.
  */
 int
 rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler port shard dequeue. Reads up to n_pkts from the
+ * subports of one shard of the port scheduler, see
+ * rte_sched_port_shards_config(), and stores them in the pkts array.
+ * Different shards of the same port can be dequeued from different lcores
+ * at the same time, and concurrently with the port enqueue.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param shard_id
+ *   Shard ID, lower than the number of shards of the port
+ * @param pkts
+ *   Pre-allocated packet descriptor array where the packets dequeued
+ *   from the shard should be stored
+ * @param n_pkts
+ *   Number of packets to dequeue from the shard
+ * @return
+ *   Number of packets successfully dequeued and placed in the pkts array,
+ *   -EINVAL when shard_id is not lower than the number of shards of the
+ *   port, including when the port is not sharded.
+ */
+int __rte_experimental
+rte_sched_port_shard_dequeue(struct rte_sched_port *port, uint32_t shard_id,
+	struct rte_mbuf **pkts, uint32_t n_pkts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,6 +23,17 @@ extern "C" {
  * identifies a traffic flow, while data represents actions and action
  * meta-data associated with the same traffic flow.
  *
+ * The entry add and delete operations of a lookup table are not thread safe
+ * with respect to its lookup operation, unless the table is of a lock-free
+ * type, i.e. it implements the reclaim operation. For a lock-free table, one
+ * thread is allowed to add and delete entries while another thread performs
+ * lookups. The add and delete operations never modify the keys and the
+ * entries that are visible to the lookups in progress: a new or modified entry
+ * is written to free memory and only then made visible to the lookups, while
+ * the memory released by the add and delete operations is kept aside until the
+ * reclaim operation returns it to the table. Once released, an entry handle
+ * is only valid for the lookups already in progress.
+ *
  ***/
 
 #include <stdint.h>
@@ -253,6 +264,26 @@ typedef int (*rte_table_op_stats_read)(
 	struct rte_table_stats *stats,
 	int clear);
 
+/**
+ * Lookup table reclaim
+ *
+ * Returns to the table the memory released by the entry add and delete
+ * operations performed since the previous reclaim, e.g. the entries replaced
+ * or deleted. The caller has to make sure that none of the lookup operations
+ * in progress at the time of these entry add and delete operations is still
+ * in progress and that the entry handles they produced are no longer in use.
+ *
+ * Until reclaimed, the released memory cannot be reused, so the entry add
+ * operation of a lock-free table may fail with -ENOSPC when there is no other
+ * free memory left.
+ *
+ * @param table
+ *   Handle to lookup table instance
+ * @return
+ *   0 on success, error code otherwise
+ */
+typedef int (*rte_table_op_reclaim)(void *table);
+
 /** Lookup table interface defining the lookup table operation */
 struct rte_table_ops {
 	rte_table_op_create f_create;                 /**< Create */
@@ -263,6 +294,7 @@ struct rte_table_ops {
 	rte_table_op_entry_delete_bulk f_delete_bulk; /**< Delete entry bulk */
 	rte_table_op_lookup f_lookup;                 /**< Lookup */
 	rte_table_op_stats_read f_stats;              /**< Stats */
+	rte_table_op_reclaim f_reclaim;               /**< Reclaim (lock-free tables only) */
 };
 
 #ifdef __cplusplus
@@ -9,6 +9,7 @@
 #include <rte_mbuf.h>
 #include <rte_memory.h>
 #include <rte_malloc.h>
+#include <rte_atomic.h>
 #include <rte_log.h>
 
 #include "rte_table_array.h"
@@ -37,17 +38,28 @@ struct rte_table_array {
 
 	/* Internal fields */
 	uint32_t entry_pos_mask;
+	uint32_t lock_free;
+
+	/* Lock-free mode: each array entry has two copies, the lookup uses the
+	 * one selected by entry_index, while the other one gets written by the
+	 * next entry add, provided that it is not pending reclaim.
+	 */
+	uint32_t *entry_index;
+	uint8_t *entry_pending;
+	uint32_t *pending;
+	uint32_t n_pending;
 
 	/* Internal table */
 	uint8_t array[0] __rte_cache_aligned;
 } __rte_cache_aligned;
 
 static void *
-rte_table_array_create(void *params, int socket_id, uint32_t entry_size)
+table_array_create(void *params, int socket_id, uint32_t entry_size,
+	uint32_t lock_free)
 {
 	struct rte_table_array_params *p = params;
 	struct rte_table_array *t;
-	uint32_t total_cl_size, total_size;
+	uint32_t total_cl_size, total_size, array_size, n_copies, i;
 
 	/* Check input parameters */
 	if ((p == NULL) ||
@@ -56,10 +68,16 @@ rte_table_array_create(void *params, int socket_id, uint32_t entry_size)
 		return NULL;
 
 	/* Memory allocation */
+	n_copies = lock_free ? 2 : 1;
+	array_size = n_copies * p->n_entries * entry_size;
 	total_cl_size = (sizeof(struct rte_table_array) +
 			RTE_CACHE_LINE_SIZE) / RTE_CACHE_LINE_SIZE;
-	total_cl_size += (p->n_entries * entry_size +
+	total_cl_size += (array_size +
 			RTE_CACHE_LINE_SIZE) / RTE_CACHE_LINE_SIZE;
+	if (lock_free)
+		total_cl_size += (p->n_entries * (2 * sizeof(uint32_t) +
+			sizeof(uint8_t)) + RTE_CACHE_LINE_SIZE) /
+			RTE_CACHE_LINE_SIZE;
 	total_size = total_cl_size * RTE_CACHE_LINE_SIZE;
 	t = rte_zmalloc_socket("TABLE", total_size, RTE_CACHE_LINE_SIZE, socket_id);
 	if (t == NULL) {
@@ -74,10 +92,32 @@ rte_table_array_create(void *params, int socket_id, uint32_t entry_size)
 	t->n_entries = p->n_entries;
 	t->offset = p->offset;
 	t->entry_pos_mask = t->n_entries - 1;
+	t->lock_free = lock_free;
+
+	if (lock_free) {
+		t->entry_index = (uint32_t *) &t->array[array_size];
+		t->pending = &t->entry_index[t->n_entries];
+		t->entry_pending = (uint8_t *) &t->pending[t->n_entries];
+
+		for (i = 0; i < t->n_entries; i++)
+			t->entry_index[i] = 2 * i;
+	}
 
 	return t;
 }
 
+static void *
+rte_table_array_create(void *params, int socket_id, uint32_t entry_size)
+{
+	return table_array_create(params, socket_id, entry_size, 0);
+}
+
+static void *
+rte_table_array_create_lf(void *params, int socket_id, uint32_t entry_size)
+{
+	return table_array_create(params, socket_id, entry_size, 1);
+}
+
 static int
 rte_table_array_free(void *table)
 {
@@ -131,14 +171,63 @@ rte_table_array_entry_add(
 		return -EINVAL;
 	}
 
-	table_entry = &t->array[k->pos * t->entry_size];
-	memcpy(table_entry, entry, t->entry_size);
+	if (t->lock_free) {
+		uint32_t entry_index = t->entry_index[k->pos] ^ 1;
+
+		/* The other copy may still be in use by the lookups */
+		if (t->entry_pending[k->pos])
+			return -ENOSPC;
+
+		table_entry = &t->array[entry_index * t->entry_size];
+		memcpy(table_entry, entry, t->entry_size);
+
+		/* Switch the lookups to the new copy */
+		rte_smp_wmb();
+		t->entry_index[k->pos] = entry_index;
+
+		t->entry_pending[k->pos] = 1;
+		t->pending[t->n_pending++] = k->pos;
+	} else {
+		table_entry = &t->array[k->pos * t->entry_size];
+		memcpy(table_entry, entry, t->entry_size);
+	}
+
 	*key_found = 1;
 	*entry_ptr = (void *) table_entry;
 
 	return 0;
 }
 
+static int
+rte_table_array_entry_add_bulk(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((keys == NULL) || (entries == NULL) || (key_found == NULL) ||
+		(entries_ptr == NULL)) {
+		RTE_LOG(ERR, TABLE, "%s: Invalid parameters\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = rte_table_array_entry_add(table, keys[i], entries[i],
+			&key_found[i], &entries_ptr[i]);
+		if (status)
+			return status;
+	}
+
+	return 0;
+}
+
 static int
 rte_table_array_lookup(
 	void *table,
@@ -181,6 +270,54 @@ rte_table_array_lookup(
 	return 0;
 }
 
+static int
+rte_table_array_lookup_lf(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	struct rte_table_array *t = (struct rte_table_array *) table;
+	__rte_unused uint32_t n_pkts_in = __builtin_popcountll(pkts_mask);
+	RTE_TABLE_ARRAY_STATS_PKTS_IN_ADD(t, n_pkts_in);
+	*lookup_hit_mask = pkts_mask;
+
+	for ( ; pkts_mask; ) {
+		uint32_t pkt_index = __builtin_ctzll(pkts_mask);
+		uint64_t pkt_mask = 1LLU << pkt_index;
+		struct rte_mbuf *pkt = pkts[pkt_index];
+		uint32_t entry_pos = RTE_MBUF_METADATA_UINT32(pkt,
+			t->offset) & t->entry_pos_mask;
+		uint32_t entry_index = t->entry_index[entry_pos];
+
+		entries[pkt_index] = (void *) &t->array[entry_index *
+			t->entry_size];
+		pkts_mask &= ~pkt_mask;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_array_reclaim(void *table)
+{
+	struct rte_table_array *t = table;
+	uint32_t i;
+
+	/* Check input parameters */
+	if (t == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < t->n_pending; i++)
+		t->entry_pending[t->pending[i]] = 0;
+	t->n_pending = 0;
+
+	return 0;
+}
+
 static int
 rte_table_array_stats_read(void *table, struct rte_table_stats *stats, int clear)
 {
@@ -200,8 +337,20 @@ struct rte_table_ops rte_table_array_ops = {
 	.f_free = rte_table_array_free,
 	.f_add = rte_table_array_entry_add,
 	.f_delete = NULL,
-	.f_add_bulk = NULL,
+	.f_add_bulk = rte_table_array_entry_add_bulk,
 	.f_delete_bulk = NULL,
 	.f_lookup = rte_table_array_lookup,
 	.f_stats = rte_table_array_stats_read,
 };
+
+struct rte_table_ops rte_table_array_lf_ops = {
+	.f_create = rte_table_array_create_lf,
+	.f_free = rte_table_array_free,
+	.f_add = rte_table_array_entry_add,
+	.f_delete = NULL,
+	.f_add_bulk = rte_table_array_entry_add_bulk,
+	.f_delete_bulk = NULL,
+	.f_lookup = rte_table_array_lookup_lf,
+	.f_stats = rte_table_array_stats_read,
+	.f_reclaim = rte_table_array_reclaim,
+};
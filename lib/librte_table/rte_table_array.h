@@ -40,6 +40,16 @@ struct rte_table_array_key {
 /** Array table operations */
 extern struct rte_table_ops rte_table_array_ops;
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Lock-free array table operations. Each array entry is stored twice, so
+ * that it can be updated while the lookups use the other copy. An entry can
+ * be updated once between two reclaim operations.
+ */
+extern struct rte_table_ops rte_table_array_lf_ops;
+
 #ifdef __cplusplus
 }
 #endif
@@ -45,7 +45,10 @@ extern "C" {
  *        per table and per each bucket. Use-cases: flow table, etc.
  * 2. Key size:
  *     a. Configurable key size
- *     b. Single key size (8-byte, 16-byte or 32-byte key size)
+ *     b. Single key size (8-byte, 16-byte, 32-byte or 64-byte key size). The
+ *        64-byte key tables compare the keys with AVX2 or AVX-512 instructions
+ *        when available. Shorter keys (e.g. 40 to 64 bytes) can use them, with
+ *        the key mask clearing the padding bytes.
  *
  ***/
 #include <stdint.h>
@@ -91,6 +94,7 @@ extern struct rte_table_ops rte_table_hash_ext_ops;
 extern struct rte_table_ops rte_table_hash_key8_ext_ops;
 extern struct rte_table_ops rte_table_hash_key16_ext_ops;
 extern struct rte_table_ops rte_table_hash_key32_ext_ops;
+extern struct rte_table_ops rte_table_hash_key64_ext_ops;
 
 /** LRU hash table operations */
 extern struct rte_table_ops rte_table_hash_lru_ops;
@@ -98,6 +102,21 @@ extern struct rte_table_ops rte_table_hash_lru_ops;
 extern struct rte_table_ops rte_table_hash_key8_lru_ops;
 extern struct rte_table_ops rte_table_hash_key16_lru_ops;
 extern struct rte_table_ops rte_table_hash_key32_lru_ops;
+extern struct rte_table_ops rte_table_hash_key64_lru_ops;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Lock-free extendible bucket and LRU hash table operations. The memory for
+ * the keys and their data is doubled, so that every key can be updated once
+ * between two reclaim operations. The LRU order of a lock-free LRU table is
+ * only updated by the add operations: the lookups do not update it, as they
+ * would race with the control thread writing the same bucket, so the key
+ * replaced in a full bucket is the least recently added one.
+ */
+extern struct rte_table_ops rte_table_hash_ext_lf_ops;
+extern struct rte_table_ops rte_table_hash_lru_lf_ops;
 
 #ifdef __cplusplus
 }
@@ -9,6 +9,7 @@
 #include <rte_mbuf.h>
 #include <rte_memory.h>
 #include <rte_malloc.h>
+#include <rte_atomic.h>
 #include <rte_log.h>
 
 #include "rte_table_hash.h"
@@ -85,6 +86,14 @@ struct rte_table_hash {
 	uint32_t data_size_shl;
 	uint32_t key_stack_tos;
 	uint32_t bkt_ext_stack_tos;
+	uint32_t n_keys_used;
+
+	/* Lock-free mode: the keys and the bucket extensions released by the
+	 * add and delete operations are pending reclaim
+	 */
+	uint32_t lock_free;
+	uint32_t key_pending_tos;
+	uint32_t bkt_ext_pending_tos;
 
 	/* Grinder */
 	struct grinder grinders[RTE_PORT_IN_BURST_SIZE_MAX];
@@ -97,6 +106,8 @@ struct rte_table_hash {
 	uint8_t *data_mem;
 	uint32_t *key_stack;
 	uint32_t *bkt_ext_stack;
+	uint32_t *key_pending;
+	uint32_t *bkt_ext_pending;
 
 	/* Table memory */
 	uint8_t memory[0] __rte_cache_aligned;
@@ -164,15 +175,18 @@ check_params_create(struct rte_table_hash_params *params)
 }
 
 static void *
-rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
+table_hash_ext_create(void *params, int socket_id, uint32_t entry_size,
+	uint32_t lock_free)
 {
 	struct rte_table_hash_params *p = params;
 	struct rte_table_hash *t;
 	uint64_t table_meta_sz, key_mask_sz, bucket_sz, bucket_ext_sz, key_sz;
 	uint64_t key_stack_sz, bkt_ext_stack_sz, data_sz, total_size;
+	uint64_t key_pending_sz, bkt_ext_pending_sz;
 	uint64_t key_mask_offset, bucket_offset, bucket_ext_offset, key_offset;
 	uint64_t key_stack_offset, bkt_ext_stack_offset, data_offset;
-	uint32_t n_buckets_ext, i;
+	uint64_t key_pending_offset, bkt_ext_pending_offset;
+	uint32_t n_buckets_ext, n_key_slots, i;
 
 	/* Check input parameters */
 	if ((check_params_create(p) != 0) ||
@@ -198,19 +212,29 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 	 */
 	n_buckets_ext = p->n_keys / KEYS_PER_BUCKET + KEYS_PER_BUCKET - 1;
 
+	/*
+	 * In lock-free mode, a key is always updated by writing a new copy of
+	 * it, so the number of key slots is doubled for every key to be
+	 * updated once between two reclaim operations.
+	 */
+	n_key_slots = lock_free ? 2 * p->n_keys : p->n_keys;
+
 	/* Memory allocation */
 	table_meta_sz = RTE_CACHE_LINE_ROUNDUP(sizeof(struct rte_table_hash));
 	key_mask_sz = RTE_CACHE_LINE_ROUNDUP(p->key_size);
 	bucket_sz = RTE_CACHE_LINE_ROUNDUP(p->n_buckets * sizeof(struct bucket));
 	bucket_ext_sz =
 		RTE_CACHE_LINE_ROUNDUP(n_buckets_ext * sizeof(struct bucket));
-	key_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * p->key_size);
-	key_stack_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * sizeof(uint32_t));
+	key_sz = RTE_CACHE_LINE_ROUNDUP((uint64_t)n_key_slots * p->key_size);
+	key_stack_sz = RTE_CACHE_LINE_ROUNDUP(n_key_slots * sizeof(uint32_t));
 	bkt_ext_stack_sz =
 		RTE_CACHE_LINE_ROUNDUP(n_buckets_ext * sizeof(uint32_t));
-	data_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * entry_size);
+	data_sz = RTE_CACHE_LINE_ROUNDUP((uint64_t)n_key_slots * entry_size);
+	key_pending_sz = lock_free ? key_stack_sz : 0;
+	bkt_ext_pending_sz = lock_free ? bkt_ext_stack_sz : 0;
 	total_size = table_meta_sz + key_mask_sz + bucket_sz + bucket_ext_sz +
-		key_sz + key_stack_sz + bkt_ext_stack_sz + data_sz;
+		key_sz + key_stack_sz + bkt_ext_stack_sz + data_sz +
+		key_pending_sz + bkt_ext_pending_sz;
 
 	if (total_size > SIZE_MAX) {
 		RTE_LOG(ERR, TABLE, "%s: Cannot allocate %" PRIu64 " bytes"
@@ -247,6 +271,7 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 	t->bucket_mask = t->n_buckets - 1;
 	t->key_size_shl = __builtin_ctzl(p->key_size);
 	t->data_size_shl = __builtin_ctzl(entry_size);
+	t->lock_free = lock_free;
 
 	/* Tables */
 	key_mask_offset = 0;
@@ -256,6 +281,8 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 	key_stack_offset = key_offset + key_sz;
 	bkt_ext_stack_offset = key_stack_offset + key_stack_sz;
 	data_offset = bkt_ext_stack_offset + bkt_ext_stack_sz;
+	key_pending_offset = data_offset + data_sz;
+	bkt_ext_pending_offset = key_pending_offset + key_pending_sz;
 
 	t->key_mask = (uint64_t *) &t->memory[key_mask_offset];
 	t->buckets = (struct bucket *) &t->memory[bucket_offset];
@@ -264,6 +291,8 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 	t->key_stack = (uint32_t *) &t->memory[key_stack_offset];
 	t->bkt_ext_stack = (uint32_t *) &t->memory[bkt_ext_stack_offset];
 	t->data_mem = &t->memory[data_offset];
+	t->key_pending = (uint32_t *) &t->memory[key_pending_offset];
+	t->bkt_ext_pending = (uint32_t *) &t->memory[bkt_ext_pending_offset];
 
 	/* Key mask */
 	if (p->key_mask == NULL)
@@ -272,9 +301,9 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 		memcpy(t->key_mask, p->key_mask, p->key_size);
 
 	/* Key stack */
-	for (i = 0; i < t->n_keys; i++)
-		t->key_stack[i] = t->n_keys - 1 - i;
-	t->key_stack_tos = t->n_keys;
+	for (i = 0; i < n_key_slots; i++)
+		t->key_stack[i] = n_key_slots - 1 - i;
+	t->key_stack_tos = n_key_slots;
 
 	/* Bucket ext stack */
 	for (i = 0; i < t->n_buckets_ext; i++)
@@ -284,6 +313,18 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 	return t;
 }
 
+static void *
+rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
+{
+	return table_hash_ext_create(params, socket_id, entry_size, 0);
+}
+
+static void *
+rte_table_hash_ext_create_lf(void *params, int socket_id, uint32_t entry_size)
+{
+	return table_hash_ext_create(params, socket_id, entry_size, 1);
+}
+
 static int
 rte_table_hash_ext_free(void *table)
 {
@@ -297,6 +338,15 @@ rte_table_hash_ext_free(void *table)
 	return 0;
 }
 
+static void
+key_release(struct rte_table_hash *t, uint32_t key_index)
+{
+	if (t->lock_free)
+		t->key_pending[t->key_pending_tos++] = key_index;
+	else
+		t->key_stack[t->key_stack_tos++] = key_index;
+}
+
 static int
 rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 	int *key_found, void **entry_ptr)
@@ -321,10 +371,35 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 
 			if ((sig == bkt_sig) && (keycmp(bkt_key, key, t->key_mask,
 				t->key_size) == 0)) {
-				uint8_t *data = &t->data_mem[bkt_key_index <<
-					t->data_size_shl];
+				uint8_t *data;
+
+				/* Lock-free: replace the key with a new copy */
+				if (t->lock_free) {
+					uint32_t key_index;
+
+					if (t->key_stack_tos == 0)
+						return -ENOSPC;
+
+					key_index = t->key_stack[
+						--t->key_stack_tos];
+					bkt_key = &t->key_mem[key_index <<
+						t->key_size_shl];
+					data = &t->data_mem[key_index <<
+						t->data_size_shl];
+
+					keycpy(bkt_key, key, t->key_mask,
+						t->key_size);
+					memcpy(data, entry, t->entry_size);
+
+					rte_smp_wmb();
+					bkt->key_pos[i] = key_index;
+					key_release(t, bkt_key_index);
+				} else {
+					data = &t->data_mem[bkt_key_index <<
+						t->data_size_shl];
+					memcpy(data, entry, t->entry_size);
+				}
 
-				memcpy(data, entry, t->entry_size);
 				*key_found = 1;
 				*entry_ptr = (void *) data;
 				return 0;
@@ -332,6 +407,9 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 		}
 
 	/* Key is not present in the bucket */
+	if (t->n_keys_used == t->n_keys)
+		return -ENOSPC;
+
 	for (bkt_prev = NULL, bkt = bkt0; bkt != NULL; bkt_prev = bkt,
 		bkt = BUCKET_NEXT(bkt))
 		for (i = 0; i < KEYS_PER_BUCKET; i++) {
@@ -354,10 +432,12 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 				data = &t->data_mem[bkt_key_index <<
 					t->data_size_shl];
 
-				bkt->sig[i] = (uint16_t) sig;
-				bkt->key_pos[i] = bkt_key_index;
 				keycpy(bkt_key, key, t->key_mask, t->key_size);
 				memcpy(data, entry, t->entry_size);
+				bkt->key_pos[i] = bkt_key_index;
+				rte_smp_wmb();
+				bkt->sig[i] = (uint16_t) sig;
+				t->n_keys_used++;
 
 				*key_found = 0;
 				*entry_ptr = (void *) data;
@@ -374,10 +454,6 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 		bkt_index = t->bkt_ext_stack[--t->bkt_ext_stack_tos];
 		bkt = &t->buckets_ext[bkt_index];
 
-		/* Chain the new bucket ext */
-		BUCKET_NEXT_SET(bkt_prev, bkt);
-		BUCKET_NEXT_SET_NULL(bkt);
-
 		/* Allocate new key */
 		bkt_key_index = t->key_stack[--t->key_stack_tos];
 		bkt_key = &t->key_mem[bkt_key_index << t->key_size_shl];
@@ -385,10 +461,16 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 		data = &t->data_mem[bkt_key_index << t->data_size_shl];
 
 		/* Install new key into bucket */
-		bkt->sig[0] = (uint16_t) sig;
-		bkt->key_pos[0] = bkt_key_index;
 		keycpy(bkt_key, key, t->key_mask, t->key_size);
 		memcpy(data, entry, t->entry_size);
+		bkt->sig[0] = (uint16_t) sig;
+		bkt->key_pos[0] = bkt_key_index;
+		BUCKET_NEXT_SET_NULL(bkt);
+
+		/* Chain the new bucket ext */
+		rte_smp_wmb();
+		BUCKET_NEXT_SET(bkt_prev, bkt);
+		t->n_keys_used++;
 
 		*key_found = 0;
 		*entry_ptr = (void *) data;
@@ -433,8 +515,8 @@ void *entry)
 					memcpy(entry, data, t->entry_size);
 
 				/* Free key */
-				t->key_stack[t->key_stack_tos++] =
-					bkt_key_index;
+				key_release(t, bkt_key_index);
+				t->n_keys_used--;
 
 				/*Check if bucket is unused */
 				if ((bkt_prev != NULL) &&
@@ -442,12 +524,22 @@ void *entry)
 				    (bkt->sig[2] == 0) && (bkt->sig[3] == 0)) {
 					/* Unchain bucket */
 					BUCKET_NEXT_COPY(bkt_prev, bkt);
+					bkt_index = bkt - t->buckets_ext;
+
+					/* Lock-free: the lookups in progress
+					 * may still walk through this bucket
+					 */
+					if (t->lock_free) {
+						t->bkt_ext_pending[
+						t->bkt_ext_pending_tos++] =
+							bkt_index;
+						return 0;
+					}
 
 					/* Clear bucket */
 					memset(bkt, 0, sizeof(struct bucket));
 
 					/* Free bucket back to buckets ext */
-					bkt_index = bkt - t->buckets_ext;
 					t->bkt_ext_stack[t->bkt_ext_stack_tos++]
 						= bkt_index;
 				}
@@ -461,6 +553,93 @@ void *entry)
 	return 0;
 }
 
+static int
+rte_table_hash_ext_entry_add_bulk(void *table, void **keys, void **entries,
+	uint32_t n_keys, int *key_found, void **entries_ptr)
+{
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((table == NULL) || (keys == NULL) || (entries == NULL) ||
+		(key_found == NULL) || (entries_ptr == NULL)) {
+		RTE_LOG(ERR, TABLE, "%s: Invalid parameters\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++)
+		if ((keys[i] == NULL) || (entries[i] == NULL)) {
+			RTE_LOG(ERR, TABLE, "%s: Key or entry %u is NULL\n",
+				__func__, i);
+			return -EINVAL;
+		}
+
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = rte_table_hash_ext_entry_add(table, keys[i],
+			entries[i], &key_found[i], &entries_ptr[i]);
+		if (status)
+			return status;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_hash_ext_entry_delete_bulk(void *table, void **keys,
+	uint32_t n_keys, int *key_found, void **entries)
+{
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((table == NULL) || (keys == NULL) || (key_found == NULL)) {
+		RTE_LOG(ERR, TABLE, "%s: Invalid parameters\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++)
+		if (keys[i] == NULL) {
+			RTE_LOG(ERR, TABLE, "%s: Key %u is NULL\n",
+				__func__, i);
+			return -EINVAL;
+		}
+
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = rte_table_hash_ext_entry_delete(table, keys[i],
+			&key_found[i], entries ? entries[i] : NULL);
+		if (status)
+			return status;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_hash_ext_reclaim(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	/* Check input parameters */
+	if (t == NULL)
+		return -EINVAL;
+
+	while (t->key_pending_tos > 0)
+		t->key_stack[t->key_stack_tos++] =
+			t->key_pending[--t->key_pending_tos];
+
+	while (t->bkt_ext_pending_tos > 0) {
+		uint32_t bkt_index =
+			t->bkt_ext_pending[--t->bkt_ext_pending_tos];
+
+		memset(&t->buckets_ext[bkt_index], 0, sizeof(struct bucket));
+		t->bkt_ext_stack[t->bkt_ext_stack_tos++] = bkt_index;
+	}
+
+	return 0;
+}
+
 static int rte_table_hash_ext_lookup_unoptimized(
 	void *table,
 	struct rte_mbuf **pkts,
@@ -1004,8 +1183,20 @@ struct rte_table_ops rte_table_hash_ext_ops	 = {
 	.f_free = rte_table_hash_ext_free,
 	.f_add = rte_table_hash_ext_entry_add,
 	.f_delete = rte_table_hash_ext_entry_delete,
-	.f_add_bulk = NULL,
-	.f_delete_bulk = NULL,
+	.f_add_bulk = rte_table_hash_ext_entry_add_bulk,
+	.f_delete_bulk = rte_table_hash_ext_entry_delete_bulk,
+	.f_lookup = rte_table_hash_ext_lookup,
+	.f_stats = rte_table_hash_ext_stats_read,
+};
+
+struct rte_table_ops rte_table_hash_ext_lf_ops = {
+	.f_create = rte_table_hash_ext_create_lf,
+	.f_free = rte_table_hash_ext_free,
+	.f_add = rte_table_hash_ext_entry_add,
+	.f_delete = rte_table_hash_ext_entry_delete,
+	.f_add_bulk = rte_table_hash_ext_entry_add_bulk,
+	.f_delete_bulk = rte_table_hash_ext_entry_delete_bulk,
 	.f_lookup = rte_table_hash_ext_lookup,
 	.f_stats = rte_table_hash_ext_stats_read,
+	.f_reclaim = rte_table_hash_ext_reclaim,
 };
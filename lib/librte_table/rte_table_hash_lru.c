@@ -9,6 +9,7 @@
 #include <rte_mbuf.h>
 #include <rte_memory.h>
 #include <rte_malloc.h>
+#include <rte_atomic.h>
 #include <rte_log.h>
 
 #include "rte_table_hash.h"
@@ -64,6 +65,13 @@ struct rte_table_hash {
 	uint32_t key_size_shl;
 	uint32_t data_size_shl;
 	uint32_t key_stack_tos;
+	uint32_t n_keys_used;
+
+	/* Lock-free mode: the keys released by the add and delete operations
+	 * are pending reclaim
+	 */
+	uint32_t lock_free;
+	uint32_t key_pending_tos;
 
 	/* Grinder */
 	struct grinder grinders[RTE_PORT_IN_BURST_SIZE_MAX];
@@ -74,6 +82,7 @@ struct rte_table_hash {
 	uint8_t *key_mem;
 	uint8_t *data_mem;
 	uint32_t *key_stack;
+	uint32_t *key_pending;
 
 	/* Table memory */
 	uint8_t memory[0] __rte_cache_aligned;
@@ -141,15 +150,16 @@ check_params_create(struct rte_table_hash_params *params)
 }
 
 static void *
-rte_table_hash_lru_create(void *params, int socket_id, uint32_t entry_size)
+table_hash_lru_create(void *params, int socket_id, uint32_t entry_size,
+	uint32_t lock_free)
 {
 	struct rte_table_hash_params *p = params;
 	struct rte_table_hash *t;
 	uint64_t table_meta_sz, key_mask_sz, bucket_sz, key_sz, key_stack_sz;
-	uint64_t data_sz, total_size;
+	uint64_t data_sz, key_pending_sz, total_size;
 	uint64_t key_mask_offset, bucket_offset, key_offset, key_stack_offset;
-	uint64_t data_offset;
-	uint32_t n_buckets, i;
+	uint64_t data_offset, key_pending_offset;
+	uint32_t n_buckets, n_key_slots, i;
 
 	/* Check input parameters */
 	if ((check_params_create(p) != 0) ||
@@ -178,15 +188,23 @@ rte_table_hash_lru_create(void *params, int socket_id, uint32_t entry_size)
 		(p->n_keys + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET);
 	n_buckets = RTE_MAX(n_buckets, p->n_buckets);
 
+	/*
+	 * In lock-free mode, a key is always updated by writing a new copy of
+	 * it, so the number of key slots is doubled for every key to be
+	 * updated once between two reclaim operations.
+	 */
+	n_key_slots = lock_free ? 2 * p->n_keys : p->n_keys;
+
 	/* Memory allocation */
 	table_meta_sz = RTE_CACHE_LINE_ROUNDUP(sizeof(struct rte_table_hash));
 	key_mask_sz = RTE_CACHE_LINE_ROUNDUP(p->key_size);
 	bucket_sz = RTE_CACHE_LINE_ROUNDUP(n_buckets * sizeof(struct bucket));
-	key_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * p->key_size);
-	key_stack_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * sizeof(uint32_t));
-	data_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * entry_size);
+	key_sz = RTE_CACHE_LINE_ROUNDUP((uint64_t)n_key_slots * p->key_size);
+	key_stack_sz = RTE_CACHE_LINE_ROUNDUP(n_key_slots * sizeof(uint32_t));
+	data_sz = RTE_CACHE_LINE_ROUNDUP((uint64_t)n_key_slots * entry_size);
+	key_pending_sz = lock_free ? key_stack_sz : 0;
 	total_size = table_meta_sz + key_mask_sz + bucket_sz + key_sz +
-		key_stack_sz + data_sz;
+		key_stack_sz + data_sz + key_pending_sz;
 
 	if (total_size > SIZE_MAX) {
 		RTE_LOG(ERR, TABLE,
@@ -224,6 +242,7 @@ rte_table_hash_lru_create(void *params, int socket_id, uint32_t entry_size)
 	t->bucket_mask = t->n_buckets - 1;
 	t->key_size_shl = __builtin_ctzl(p->key_size);
 	t->data_size_shl = __builtin_ctzl(entry_size);
+	t->lock_free = lock_free;
 
 	/* Tables */
 	key_mask_offset = 0;
@@ -231,12 +250,14 @@ rte_table_hash_lru_create(void *params, int socket_id, uint32_t entry_size)
 	key_offset = bucket_offset + bucket_sz;
 	key_stack_offset = key_offset + key_sz;
 	data_offset = key_stack_offset + key_stack_sz;
+	key_pending_offset = data_offset + data_sz;
 
 	t->key_mask = (uint64_t *) &t->memory[key_mask_offset];
 	t->buckets = (struct bucket *) &t->memory[bucket_offset];
 	t->key_mem = &t->memory[key_offset];
 	t->key_stack = (uint32_t *) &t->memory[key_stack_offset];
 	t->data_mem = &t->memory[data_offset];
+	t->key_pending = (uint32_t *) &t->memory[key_pending_offset];
 
 	/* Key mask */
 	if (p->key_mask == NULL)
@@ -245,9 +266,9 @@ rte_table_hash_lru_create(void *params, int socket_id, uint32_t entry_size)
 		memcpy(t->key_mask, p->key_mask, p->key_size);
 
 	/* Key stack */
-	for (i = 0; i < t->n_keys; i++)
-		t->key_stack[i] = t->n_keys - 1 - i;
-	t->key_stack_tos = t->n_keys;
+	for (i = 0; i < n_key_slots; i++)
+		t->key_stack[i] = n_key_slots - 1 - i;
+	t->key_stack_tos = n_key_slots;
 
 	/* LRU */
 	for (i = 0; i < t->n_buckets; i++) {
@@ -259,6 +280,18 @@ rte_table_hash_lru_create(void *params, int socket_id, uint32_t entry_size)
 	return t;
 }
 
+static void *
+rte_table_hash_lru_create(void *params, int socket_id, uint32_t entry_size)
+{
+	return table_hash_lru_create(params, socket_id, entry_size, 0);
+}
+
+static void *
+rte_table_hash_lru_create_lf(void *params, int socket_id, uint32_t entry_size)
+{
+	return table_hash_lru_create(params, socket_id, entry_size, 1);
+}
+
 static int
 rte_table_hash_lru_free(void *table)
 {
@@ -272,6 +305,48 @@ rte_table_hash_lru_free(void *table)
 	return 0;
 }
 
+static void
+key_release(struct rte_table_hash *t, uint32_t key_index)
+{
+	if (t->lock_free)
+		t->key_pending[t->key_pending_tos++] = key_index;
+	else
+		t->key_stack[t->key_stack_tos++] = key_index;
+}
+
+/* Lock-free: install a new copy of the key into the bucket, as the lookups in
+ * progress may still use the current one
+ */
+static int
+key_replace(struct rte_table_hash *t, struct bucket *bkt, uint32_t pos,
+	uint64_t sig, void *key, void *entry, int key_found, int *key_found_out,
+	void **entry_ptr)
+{
+	uint32_t bkt_key_index;
+	uint8_t *bkt_key, *data;
+
+	if (t->key_stack_tos == 0)
+		return -ENOSPC;
+
+	bkt_key_index = t->key_stack[--t->key_stack_tos];
+	bkt_key = &t->key_mem[bkt_key_index << t->key_size_shl];
+	data = &t->data_mem[bkt_key_index << t->data_size_shl];
+
+	keycpy(bkt_key, key, t->key_mask, t->key_size);
+	memcpy(data, entry, t->entry_size);
+
+	rte_smp_wmb();
+	key_release(t, bkt->key_pos[pos]);
+	bkt->key_pos[pos] = bkt_key_index;
+	rte_smp_wmb();
+	bkt->sig[pos] = (uint16_t) sig;
+	lru_update(bkt, pos);
+
+	*key_found_out = key_found;
+	*entry_ptr = (void *) data;
+	return 0;
+}
+
 static int
 rte_table_hash_lru_entry_add(void *table, void *key, void *entry,
 	int *key_found, void **entry_ptr)
@@ -298,6 +373,10 @@ rte_table_hash_lru_entry_add(void *table, void *key, void *entry,
 			uint8_t *data = &t->data_mem[bkt_key_index <<
 				t->data_size_shl];
 
+			if (t->lock_free)
+				return key_replace(t, bkt, i, sig, key, entry,
+					1, key_found, entry_ptr);
+
 			memcpy(data, entry, t->entry_size);
 			lru_update(bkt, i);
 			*key_found = 1;
@@ -315,7 +394,8 @@ rte_table_hash_lru_entry_add(void *table, void *key, void *entry,
 			uint8_t *bkt_key, *data;
 
 			/* Allocate new key */
-			if (t->key_stack_tos == 0) {
+			if ((t->n_keys_used == t->n_keys) ||
+				(t->key_stack_tos == 0)) {
 				/* No keys available */
 				return -ENOSPC;
 			}
@@ -325,11 +405,13 @@ rte_table_hash_lru_entry_add(void *table, void *key, void *entry,
 			bkt_key = &t->key_mem[bkt_key_index << t->key_size_shl];
 			data = &t->data_mem[bkt_key_index << t->data_size_shl];
 
-			bkt->sig[i] = (uint16_t) sig;
-			bkt->key_pos[i] = bkt_key_index;
 			keycpy(bkt_key, key, t->key_mask, t->key_size);
 			memcpy(data, entry, t->entry_size);
+			bkt->key_pos[i] = bkt_key_index;
+			rte_smp_wmb();
+			bkt->sig[i] = (uint16_t) sig;
 			lru_update(bkt, i);
+			t->n_keys_used++;
 
 			*key_found = 0;
 			*entry_ptr = (void *) data;
@@ -338,6 +420,10 @@ rte_table_hash_lru_entry_add(void *table, void *key, void *entry,
 	}
 
 	/* Bucket full */
+	if (t->lock_free)
+		return key_replace(t, bkt, lru_pos(bkt), sig, key, entry,
+			0, key_found, entry_ptr);
+
 	{
 		uint64_t pos = lru_pos(bkt);
 		uint32_t bkt_key_index = bkt->key_pos[pos];
@@ -383,7 +469,8 @@ rte_table_hash_lru_entry_delete(void *table, void *key, int *key_found,
 				t->data_size_shl];
 
 			bkt->sig[i] = 0;
-			t->key_stack[t->key_stack_tos++] = bkt_key_index;
+			key_release(t, bkt_key_index);
+			t->n_keys_used--;
 			*key_found = 1;
 			if (entry)
 				memcpy(entry, data, t->entry_size);
@@ -396,6 +483,85 @@ rte_table_hash_lru_entry_delete(void *table, void *key, int *key_found,
 	return 0;
 }
 
+static int
+rte_table_hash_lru_entry_add_bulk(void *table, void **keys, void **entries,
+	uint32_t n_keys, int *key_found, void **entries_ptr)
+{
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((table == NULL) || (keys == NULL) || (entries == NULL) ||
+		(key_found == NULL) || (entries_ptr == NULL)) {
+		RTE_LOG(ERR, TABLE, "%s: Invalid parameters\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++)
+		if ((keys[i] == NULL) || (entries[i] == NULL)) {
+			RTE_LOG(ERR, TABLE, "%s: Key or entry %u is NULL\n",
+				__func__, i);
+			return -EINVAL;
+		}
+
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = rte_table_hash_lru_entry_add(table, keys[i],
+			entries[i], &key_found[i], &entries_ptr[i]);
+		if (status)
+			return status;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_hash_lru_entry_delete_bulk(void *table, void **keys,
+	uint32_t n_keys, int *key_found, void **entries)
+{
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((table == NULL) || (keys == NULL) || (key_found == NULL)) {
+		RTE_LOG(ERR, TABLE, "%s: Invalid parameters\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++)
+		if (keys[i] == NULL) {
+			RTE_LOG(ERR, TABLE, "%s: Key %u is NULL\n",
+				__func__, i);
+			return -EINVAL;
+		}
+
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = rte_table_hash_lru_entry_delete(table, keys[i],
+			&key_found[i], entries ? entries[i] : NULL);
+		if (status)
+			return status;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_hash_lru_reclaim(void *table)
+{
+	struct rte_table_hash *t = table;
+
+	/* Check input parameters */
+	if (t == NULL)
+		return -EINVAL;
+
+	while (t->key_pending_tos > 0)
+		t->key_stack[t->key_stack_tos++] =
+			t->key_pending[--t->key_pending_tos];
+
+	return 0;
+}
+
 static int rte_table_hash_lru_lookup_unoptimized(
 	void *table,
 	struct rte_mbuf **pkts,
@@ -440,7 +606,11 @@ static int rte_table_hash_lru_lookup_unoptimized(
 				uint8_t *data = &t->data_mem[bkt_key_index <<
 					t->data_size_shl];
 
-				lru_update(bkt, i);
+				/* Lock-free: the LRU list is only updated by
+				 * the control thread
+				 */
+				if (!t->lock_free)
+					lru_update(bkt, i);
 				pkts_mask_out |= pkt_mask;
 				entries[pkt_index] = (void *) data;
 				break;
@@ -775,13 +945,15 @@ static int rte_table_hash_lru_lookup_unoptimized(
 	match_keys = match_key30 | match_key31;			\
 	pkts_mask_out |= match_keys;				\
 								\
-	if (match_key30 == 0)					\
-		match_pos30 = 4;				\
-	lru_update(bkt30, match_pos30);				\
+	if (!t->lock_free) {					\
+		if (match_key30 == 0)				\
+			match_pos30 = 4;			\
+		lru_update(bkt30, match_pos30);			\
 								\
-	if (match_key31 == 0)					\
-		match_pos31 = 4;				\
-	lru_update(bkt31, match_pos31);				\
+		if (match_key31 == 0)				\
+			match_pos31 = 4;			\
+		lru_update(bkt31, match_pos31);			\
+	}							\
 }
 
 /***
@@ -952,8 +1124,20 @@ struct rte_table_ops rte_table_hash_lru_ops = {
 	.f_free = rte_table_hash_lru_free,
 	.f_add = rte_table_hash_lru_entry_add,
 	.f_delete = rte_table_hash_lru_entry_delete,
-	.f_add_bulk = NULL,
-	.f_delete_bulk = NULL,
+	.f_add_bulk = rte_table_hash_lru_entry_add_bulk,
+	.f_delete_bulk = rte_table_hash_lru_entry_delete_bulk,
+	.f_lookup = rte_table_hash_lru_lookup,
+	.f_stats = rte_table_hash_lru_stats_read,
+};
+
+struct rte_table_ops rte_table_hash_lru_lf_ops = {
+	.f_create = rte_table_hash_lru_create_lf,
+	.f_free = rte_table_hash_lru_free,
+	.f_add = rte_table_hash_lru_entry_add,
+	.f_delete = rte_table_hash_lru_entry_delete,
+	.f_add_bulk = rte_table_hash_lru_entry_add_bulk,
+	.f_delete_bulk = rte_table_hash_lru_entry_delete_bulk,
 	.f_lookup = rte_table_hash_lru_lookup,
 	.f_stats = rte_table_hash_lru_stats_read,
+	.f_reclaim = rte_table_hash_lru_reclaim,
 };
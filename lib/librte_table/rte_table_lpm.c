@@ -10,6 +10,7 @@
 #include <rte_memory.h>
 #include <rte_malloc.h>
 #include <rte_byteorder.h>
+#include <rte_atomic.h>
 #include <rte_log.h>
 #include <rte_lpm.h>
 
@@ -19,6 +20,11 @@
 #define RTE_TABLE_LPM_MAX_NEXT_HOPS                        65536
 #endif
 
+/* Lock-free mode: NHT entry no longer used by any rule, but possibly still
+ * used by the lookups in progress
+ */
+#define NHT_USERS_PENDING                                  UINT32_MAX
+
 #ifdef RTE_TABLE_STATS_COLLECT
 
 #define RTE_TABLE_LPM_STATS_PKTS_IN_ADD(table, val) \
@@ -41,6 +47,8 @@ struct rte_table_lpm {
 	uint32_t entry_unique_size;
 	uint32_t n_rules;
 	uint32_t offset;
+	uint32_t lock_free;
+	uint32_t n_nht_pending;
 
 	/* Handle to low-level LPM table */
 	struct rte_lpm *lpm;
@@ -51,7 +59,8 @@ struct rte_table_lpm {
 };
 
 static void *
-rte_table_lpm_create(void *params, int socket_id, uint32_t entry_size)
+table_lpm_create(void *params, int socket_id, uint32_t entry_size,
+	uint32_t lock_free)
 {
 	struct rte_table_lpm_params *p = params;
 	struct rte_table_lpm *lpm;
@@ -118,10 +127,23 @@ rte_table_lpm_create(void *params, int socket_id, uint32_t entry_size)
 	lpm->entry_unique_size = p->entry_unique_size;
 	lpm->n_rules = p->n_rules;
 	lpm->offset = p->offset;
+	lpm->lock_free = lock_free;
 
 	return lpm;
 }
 
+static void *
+rte_table_lpm_create(void *params, int socket_id, uint32_t entry_size)
+{
+	return table_lpm_create(params, socket_id, entry_size, 0);
+}
+
+static void *
+rte_table_lpm_create_lf(void *params, int socket_id, uint32_t entry_size)
+{
+	return table_lpm_create(params, socket_id, entry_size, 1);
+}
+
 static int
 rte_table_lpm_free(void *table)
 {
@@ -163,7 +185,9 @@ nht_find_existing(struct rte_table_lpm *lpm, void *entry, uint32_t *pos)
 	for (i = 0; i < RTE_TABLE_LPM_MAX_NEXT_HOPS; i++) {
 		uint8_t *nht_entry = &lpm->nht[i * lpm->entry_size];
 
-		if ((lpm->nht_users[i] > 0) && (memcmp(nht_entry, entry,
+		if ((lpm->nht_users[i] > 0) &&
+			(lpm->nht_users[i] != NHT_USERS_PENDING) &&
+			(memcmp(nht_entry, entry,
 			lpm->entry_unique_size) == 0)) {
 			*pos = i;
 			return 1;
@@ -173,6 +197,17 @@ nht_find_existing(struct rte_table_lpm *lpm, void *entry, uint32_t *pos)
 	return 0;
 }
 
+static void
+nht_put(struct rte_table_lpm *lpm, uint32_t pos)
+{
+	lpm->nht_users[pos]--;
+
+	if (lpm->lock_free && (lpm->nht_users[pos] == 0)) {
+		lpm->nht_users[pos] = NHT_USERS_PENDING;
+		lpm->n_nht_pending++;
+	}
+}
+
 static int
 rte_table_lpm_entry_add(
 	void *table,
@@ -219,11 +254,14 @@ rte_table_lpm_entry_add(
 
 		if (nht_find_free(lpm, &nht_pos) == 0) {
 			RTE_LOG(ERR, TABLE, "%s: NHT full\n", __func__);
-			return -1;
+			return -ENOSPC;
 		}
 
 		nht_entry = &lpm->nht[nht_pos * lpm->entry_size];
 		memcpy(nht_entry, entry, lpm->entry_size);
+
+		/* Write the NHT entry before the rule pointing to it */
+		rte_smp_wmb();
 	}
 
 	/* Add rule to low level LPM table */
@@ -234,7 +272,8 @@ rte_table_lpm_entry_add(
 
 	/* Commit NHT changes */
 	lpm->nht_users[nht_pos]++;
-	lpm->nht_users[nht_pos0] -= nht_pos0_valid;
+	if (nht_pos0_valid)
+		nht_put(lpm, nht_pos0);
 
 	*key_found = nht_pos0_valid;
 	*entry_ptr = (void *) &lpm->nht[nht_pos * lpm->entry_size];
@@ -289,7 +328,7 @@ rte_table_lpm_entry_delete(
 	}
 
 	/* Commit NHT changes */
-	lpm->nht_users[nht_pos]--;
+	nht_put(lpm, nht_pos);
 
 	*key_found = 1;
 	if (entry)
@@ -299,6 +338,87 @@ rte_table_lpm_entry_delete(
 	return 0;
 }
 
+static int
+rte_table_lpm_entry_add_bulk(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr)
+{
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((keys == NULL) || (entries == NULL) || (key_found == NULL) ||
+		(entries_ptr == NULL)) {
+		RTE_LOG(ERR, TABLE, "%s: Invalid parameters\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = rte_table_lpm_entry_add(table, keys[i], entries[i],
+			&key_found[i], &entries_ptr[i]);
+		if (status)
+			return status;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_lpm_entry_delete_bulk(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries)
+{
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((keys == NULL) || (key_found == NULL)) {
+		RTE_LOG(ERR, TABLE, "%s: Invalid parameters\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++) {
+		int status;
+
+		status = rte_table_lpm_entry_delete(table, keys[i],
+			&key_found[i], entries ? entries[i] : NULL);
+		if (status)
+			return status;
+	}
+
+	return 0;
+}
+
+static int
+rte_table_lpm_reclaim(void *table)
+{
+	struct rte_table_lpm *lpm = table;
+	uint32_t i;
+
+	/* Check input parameters */
+	if (lpm == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	if (lpm->n_nht_pending == 0)
+		return 0;
+
+	for (i = 0; i < RTE_TABLE_LPM_MAX_NEXT_HOPS; i++)
+		if (lpm->nht_users[i] == NHT_USERS_PENDING)
+			lpm->nht_users[i] = 0;
+	lpm->n_nht_pending = 0;
+
+	return 0;
+}
+
 static int
 rte_table_lpm_lookup(
 	void *table,
@@ -359,8 +479,20 @@ struct rte_table_ops rte_table_lpm_ops = {
 	.f_free = rte_table_lpm_free,
 	.f_add = rte_table_lpm_entry_add,
 	.f_delete = rte_table_lpm_entry_delete,
-	.f_add_bulk = NULL,
-	.f_delete_bulk = NULL,
+	.f_add_bulk = rte_table_lpm_entry_add_bulk,
+	.f_delete_bulk = rte_table_lpm_entry_delete_bulk,
+	.f_lookup = rte_table_lpm_lookup,
+	.f_stats = rte_table_lpm_stats_read,
+};
+
+struct rte_table_ops rte_table_lpm_lf_ops = {
+	.f_create = rte_table_lpm_create_lf,
+	.f_free = rte_table_lpm_free,
+	.f_add = rte_table_lpm_entry_add,
+	.f_delete = rte_table_lpm_entry_delete,
+	.f_add_bulk = rte_table_lpm_entry_add_bulk,
+	.f_delete_bulk = rte_table_lpm_entry_delete_bulk,
 	.f_lookup = rte_table_lpm_lookup,
 	.f_stats = rte_table_lpm_stats_read,
+	.f_reclaim = rte_table_lpm_reclaim,
 };
@@ -88,6 +88,17 @@ struct rte_table_lpm_key {
 /** LPM table operations */
 extern struct rte_table_ops rte_table_lpm_ops;
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Lock-free LPM table operations. The NHT entries no longer used by any rule
+ * are only reused once reclaimed. The tbl8 groups of the low-level LPM table
+ * are reused as soon as released, so a lookup racing with the delete of a rule
+ * and the add of another one can return the next hop of a neighbour rule.
+ */
+extern struct rte_table_ops rte_table_lpm_lf_ops;
+
 #ifdef __cplusplus
 }
 #endif
@@ -224,6 +224,12 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Pie autotest",
+        "Command": "pie_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "PMD ring autotest",
         "Command": "ring_pmd_autotest",
@@ -652,6 +658,24 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Sched perf autotest",
+        "Command": "sched_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Meter perf autotest",
+        "Command": "meter_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Table perf autotest",
+        "Command": "table_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Reciprocal division perf",
         "Command": "reciprocal_division_perf",
@@ -537,6 +537,7 @@ int test_error_distributor_create_numworkers(void)
 {
 	struct rte_distributor *ds = NULL;
 	struct rte_distributor *db = NULL;
+	struct rte_distributor *dh = NULL;
 
 	ds = rte_distributor_create("test_numworkers", rte_socket_id(),
 			RTE_MAX_LCORE + 10,
@@ -554,6 +555,14 @@ int test_error_distributor_create_numworkers(void)
 		return -1;
 	}
 
+	dh = rte_distributor_create("test_numworkers", rte_socket_id(),
+			RTE_DIST_HASH_MAX_WORKERS + 1,
+			RTE_DIST_ALG_BURST_HASH);
+	if (dh != NULL || rte_errno != EINVAL) {
+		printf("ERROR: No error on create() num_workers > MAX\n");
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -588,7 +597,8 @@ test_distributor(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
-	static struct rte_distributor *dist[2];
+	static struct rte_distributor *dh;
+	static struct rte_distributor *dist[3];
 	static struct rte_mempool *p;
 	int i;
 
@@ -624,6 +634,19 @@ test_distributor(void)
 		rte_distributor_clear_returns(ds);
 	}
 
+	if (dh == NULL) {
+		dh = rte_distributor_create("Test_dist_hash", rte_socket_id(),
+				rte_lcore_count() - 1,
+				RTE_DIST_ALG_BURST_HASH);
+		if (dh == NULL) {
+			printf("Error creating hash distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_flush(dh);
+		rte_distributor_clear_returns(dh);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -637,11 +660,14 @@ test_distributor(void)
 
 	dist[0] = ds;
 	dist[1] = db;
+	dist[2] = dh;
 
-	for (i = 0; i < 2; i++) {
+	for (i = 0; i < 3; i++) {
 
 		worker_params.dist = dist[i];
-		if (i)
+		if (i == 2)
+			sprintf(worker_params.name, "hash");
+		else if (i)
 			sprintf(worker_params.name, "burst");
 		else
 			sprintf(worker_params.name, "single");
@@ -112,9 +112,9 @@ handle_work(void *arg)
 	unsigned int num = 0;
 	int i;
 	unsigned int id = __sync_fetch_and_add(&worker_idx, 1);
-	struct rte_mbuf *buf[8] __rte_cache_aligned;
+	struct rte_mbuf *buf[RTE_DIST_MAX_BURST_SIZE] __rte_cache_aligned;
 
-	for (i = 0; i < 8; i++)
+	for (i = 0; i < RTE_DIST_MAX_BURST_SIZE; i++)
 		buf[i] = NULL;
 
 	num = rte_distributor_get_pkt(d, id, buf, buf, num);
@@ -179,9 +179,9 @@ perf_test(struct rte_distributor *d, struct rte_mempool *p)
 
 /* Useful function which ensures that all worker functions terminate */
 static void
-quit_workers(struct rte_distributor *d, struct rte_mempool *p)
+quit_workers(struct rte_distributor *d, struct rte_mempool *p,
+		unsigned int num_workers)
 {
-	const unsigned int num_workers = rte_lcore_count() - 1;
 	unsigned int i;
 	struct rte_mbuf *bufs[RTE_MAX_LCORE];
 
@@ -200,6 +200,57 @@ quit_workers(struct rte_distributor *d, struct rte_mempool *p)
 	worker_idx = 0;
 }
 
+/*
+ * Run the perf test on flow table distributors with an increasing number
+ * of workers, each of them taking bursts of RTE_DIST_MAX_BURST_SIZE packets.
+ */
+static int
+perf_test_hash_scaling(struct rte_mempool *p)
+{
+	static struct rte_distributor *dh[RTE_MAX_LCORE];
+	char name[RTE_MEMZONE_NAMESIZE];
+	unsigned int num_workers, i, lcore_id;
+
+	for (num_workers = 1; num_workers < rte_lcore_count();
+			num_workers <<= 1) {
+		if (dh[num_workers] == NULL) {
+			snprintf(name, sizeof(name), "Test_hash_%u",
+					num_workers);
+			dh[num_workers] = rte_distributor_create(name,
+					rte_socket_id(), num_workers,
+					RTE_DIST_ALG_BURST_HASH);
+			if (dh[num_workers] == NULL) {
+				printf("Error creating hash distributor\n");
+				return -1;
+			}
+		} else {
+			rte_distributor_clear_returns(dh[num_workers]);
+		}
+
+		for (i = 0; i < num_workers; i++)
+			if (rte_distributor_burst_size_set(dh[num_workers], i,
+					RTE_DIST_MAX_BURST_SIZE) != 0) {
+				printf("Error setting worker burst size\n");
+				return -1;
+			}
+
+		printf("=== Performance test of distributor (hash mode, %u workers) ===\n",
+				num_workers);
+		i = 0;
+		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+			if (i++ == num_workers)
+				break;
+			rte_eal_remote_launch(handle_work, dh[num_workers],
+					lcore_id);
+		}
+		if (perf_test(dh[num_workers], p) < 0)
+			return -1;
+		quit_workers(dh[num_workers], p, num_workers);
+	}
+
+	return 0;
+}
+
 static int
 test_distributor_perf(void)
 {
@@ -254,13 +305,16 @@ test_distributor_perf(void)
 	rte_eal_mp_remote_launch(handle_work, ds, SKIP_MASTER);
 	if (perf_test(ds, p) < 0)
 		return -1;
-	quit_workers(ds, p);
+	quit_workers(ds, p, rte_lcore_count() - 1);
 
 	printf("=== Performance test of distributor (burst mode) ===\n");
 	rte_eal_mp_remote_launch(handle_work, db, SKIP_MASTER);
 	if (perf_test(db, p) < 0)
 		return -1;
-	quit_workers(db, p);
+	quit_workers(db, p, rte_lcore_count() - 1);
+
+	if (perf_test_hash_scaling(p) < 0)
+		return -1;
 
 	return 0;
 }
@@ -864,6 +864,26 @@ test_misc_flags(void)
 	const char *argv15[] = {prgname, "--file-prefix=intr",
 			"-c", "1", "-n", "2", "--vfio-intr=invalid"};
 
+	/* try running with --huge-prefault flag */
+	const char *argv16[] = {prgname, "--file-prefix=prefault",
+			"-c", "1", "-n", "2", "-m", DEFAULT_MEM_SIZE,
+			"--huge-prefault", "2"};
+
+	/* try running with --huge-prefault invalid number of threads */
+	const char *argv17[] = {prgname, "--file-prefix=prefault",
+			"-c", "1", "-n", "2", "-m", DEFAULT_MEM_SIZE,
+			"--huge-prefault", "0"};
+
+	/* try running with --huge-prefault in legacy memory mode */
+	const char *argv18[] = {prgname, "--file-prefix=prefault",
+			"-c", "1", "-n", "2", "-m", DEFAULT_MEM_SIZE,
+			"--legacy-mem", "--huge-prefault", "2"};
+
+	/* try running with --huge-prefault without hugepages */
+	const char *argv19[] = {prgname, "--file-prefix=prefault",
+			"-c", "1", "-n", "2", "-m", DEFAULT_MEM_SIZE,
+			no_huge, "--huge-prefault", "2"};
+
 	/* run all tests also applicable to FreeBSD first */
 
 	if (launch_proc(argv0) == 0) {
@@ -940,6 +960,26 @@ test_misc_flags(void)
 				"--vfio-intr invalid parameter\n");
 		return -1;
 	}
+	if (launch_proc(argv16) != 0) {
+		printf("Error - process did not run ok with "
+				"--huge-prefault parameter\n");
+		return -1;
+	}
+	if (launch_proc(argv17) == 0) {
+		printf("Error - process run ok with "
+				"--huge-prefault invalid parameter\n");
+		return -1;
+	}
+	if (launch_proc(argv18) == 0) {
+		printf("Error - process run ok with "
+				"--huge-prefault and --legacy-mem\n");
+		return -1;
+	}
+	if (launch_proc(argv19) == 0) {
+		printf("Error - process run ok with "
+				"--huge-prefault and --no-huge\n");
+		return -1;
+	}
 	return 0;
 }
 
@@ -5,6 +5,7 @@
 
 #include <string.h>
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
 #include <rte_cryptodev.h>
@@ -16,6 +17,7 @@
 
 #define PKT_TRACE                  0
 #define NUM                        1
+#define NUM_FWD_OPS                8
 #define DEFAULT_NUM_XFORMS        (2)
 #define NUM_MBUFS                 (8191)
 #define MBUF_CACHE_SIZE           (256)
@@ -77,6 +79,12 @@ struct rte_event_crypto_request request_info = {
 	.queue_pair_id = TEST_CDEV_QP_ID
 };
 
+static struct rte_event_port_conf adapter_port_conf = {
+	.dequeue_depth = 8,
+	.enqueue_depth = 8,
+	.new_event_threshold = 1200,
+};
+
 static struct event_crypto_adapter_test_params params;
 static uint8_t crypto_adapter_setup_done;
 static uint32_t slcore_id;
@@ -321,6 +329,124 @@ test_session_with_op_forward_mode(void)
 	return TEST_SUCCESS;
 }
 
+static struct rte_crypto_op *
+sessionless_op_alloc(struct rte_crypto_sym_xform *xform,
+		union rte_event_crypto_metadata *m_data)
+{
+	struct rte_crypto_op *op;
+	struct rte_mbuf *m;
+	uint32_t len;
+
+	m = alloc_fill_mbuf(params.mbuf_pool, text_64B, PACKET_LENGTH, 0);
+	if (m == NULL)
+		return NULL;
+
+	op = rte_crypto_op_alloc(params.op_mpool,
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+	if (op == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+
+	rte_crypto_op_sym_xforms_alloc(op, NUM);
+	op->sess_type = RTE_CRYPTO_OP_SESSIONLESS;
+	op->sym->xform = xform;
+	len = IV_OFFSET + MAXIMUM_IV_LENGTH +
+		(sizeof(struct rte_crypto_sym_xform) * 2);
+	op->private_data_offset = len;
+	rte_memcpy((uint8_t *)op + len, m_data, sizeof(*m_data));
+
+	op->sym->m_src = m;
+	op->sym->cipher.data.offset = 0;
+	op->sym->cipher.data.length = PACKET_LENGTH;
+
+	return op;
+}
+
+static int
+test_op_forward_mode_release(void)
+{
+	char name[RTE_EVENT_DEV_XSTATS_NAME_SIZE];
+	struct rte_crypto_sym_xform cipher_xform;
+	union rte_event_crypto_metadata m_data;
+	struct rte_event ev[NUM_FWD_OPS];
+	struct rte_crypto_op *op;
+	unsigned int i, n, nb_crypto, id;
+	uint64_t inflight;
+	int ret;
+
+	map_adapter_service_core();
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_start(TEST_ADAPTER_ID),
+				"Failed to start event crypto adapter");
+
+	memset(&cipher_xform, 0, sizeof(cipher_xform));
+	cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	cipher_xform.cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+	cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+
+	memset(&m_data, 0, sizeof(m_data));
+	rte_memcpy(&m_data.response_info, &response_info,
+		   sizeof(response_info));
+	rte_memcpy(&m_data.request_info, &request_info,
+		   sizeof(request_info));
+
+	memset(ev, 0, sizeof(ev));
+	for (i = 0; i < NUM_FWD_OPS; i++) {
+		op = sessionless_op_alloc(&cipher_xform, &m_data);
+		TEST_ASSERT_NOT_NULL(op, "Failed to allocate crypto op\n");
+
+		ev[i].queue_id = TEST_CRYPTO_EV_QUEUE_ID;
+		ev[i].sched_type = RTE_SCHED_TYPE_ATOMIC;
+		ev[i].flow_id = TEST_APP_EV_FLOWID;
+		ev[i].event_ptr = op;
+	}
+
+	ret = rte_event_enqueue_burst(evdev, TEST_APP_PORT_ID, ev,
+				NUM_FWD_OPS);
+	TEST_ASSERT_EQUAL(ret, NUM_FWD_OPS,
+			  "Failed to send events to crypto adapter\n");
+
+	/* The adapter port may not inject new events, the completions only
+	 * get through if they are forwarded in place of the dequeued events
+	 */
+	n = 0;
+	for (i = 0; i < 1000 && n < NUM_FWD_OPS; i++) {
+		n += rte_event_dequeue_burst(evdev, TEST_APP_PORT_ID, &ev[n],
+					NUM_FWD_OPS - n, 0);
+		rte_delay_ms(1);
+	}
+
+	nb_crypto = 0;
+	for (i = 0; i < n; i++) {
+		nb_crypto += ev[i].event_type == RTE_EVENT_TYPE_CRYPTODEV;
+		op = ev[i].event_ptr;
+		rte_pktmbuf_free(op->sym->m_src);
+		rte_crypto_op_free(op);
+	}
+
+	TEST_ASSERT_EQUAL(n, NUM_FWD_OPS, "Expected %u completions, got %u\n",
+			  NUM_FWD_OPS, n);
+	TEST_ASSERT_EQUAL(nb_crypto, n,
+			  "Completions with an unexpected event type\n");
+
+	/* The forwarded completions released the events the adapter
+	 * dequeued
+	 */
+	snprintf(name, sizeof(name), "port_%u_inflight",
+		 params.crypto_event_port_id);
+	inflight = rte_event_dev_xstats_by_name_get(evdev, name, &id);
+	for (i = 0; i < 1000 && id != (unsigned int)-1 && inflight; i++) {
+		rte_delay_ms(1);
+		inflight = rte_event_dev_xstats_by_name_get(evdev, name, &id);
+	}
+	TEST_ASSERT(id == (unsigned int)-1 || inflight == 0,
+		    "Adapter port holds %" PRIu64 " unreleased events\n",
+		    inflight);
+
+	return TEST_SUCCESS;
+}
+
 static int
 send_op_recv_ev(struct rte_crypto_op *op)
 {
@@ -696,21 +822,72 @@ test_crypto_adapter_qp_add_del(void)
 }
 
 static int
-configure_event_crypto_adapter(enum rte_event_crypto_adapter_mode mode)
+test_crypto_adapter_nb_services(void)
 {
-	struct rte_event_port_conf conf = {
-		.dequeue_depth = 8,
-		.enqueue_depth = 8,
-		.new_event_threshold = 1200,
-	};
+	uint8_t port0, port1;
+	uint32_t cap;
+	int ret;
+
+	ret = rte_event_crypto_adapter_caps_get(TEST_ADAPTER_ID, evdev, &cap);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get adapter capabilities\n");
+
+	if (!(cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_SESSION_PRIVATE_DATA) ||
+	    (cap & (RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_NEW |
+		    RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_FWD |
+		    RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_QP_EV_BIND)))
+		return TEST_SKIPPED;
+
+	ret = rte_event_crypto_adapter_nb_services_set(TEST_ADAPTER_ID, 0);
+	TEST_ASSERT(ret == -EINVAL, "Expected -EINVAL got %d", ret);
+
+	ret = rte_event_crypto_adapter_nb_services_set(TEST_ADAPTER_ID,
+				RTE_EVENT_CRYPTO_ADAPTER_MAX_SERVICES + 1);
+	TEST_ASSERT(ret == -EINVAL, "Expected -EINVAL got %d", ret);
+
+	ret = rte_event_crypto_adapter_service_event_port_get(TEST_ADAPTER_ID,
+				0, &port0);
+	TEST_ASSERT(ret == -ESRCH, "Expected -ESRCH got %d", ret);
+
+	ret = rte_event_crypto_adapter_nb_services_set(TEST_ADAPTER_ID, 2);
+	TEST_ASSERT_SUCCESS(ret, "Failed to set number of services\n");
+
+	ret = rte_event_crypto_adapter_queue_pair_add(TEST_ADAPTER_ID,
+				TEST_CDEV_ID, -1, NULL);
+	TEST_ASSERT_SUCCESS(ret, "Failed to add queue pairs\n");
+
+	ret = rte_event_crypto_adapter_nb_services_set(TEST_ADAPTER_ID, 1);
+	TEST_ASSERT(ret == -EBUSY, "Expected -EBUSY got %d", ret);
+
+	ret = rte_event_crypto_adapter_service_event_port_get(TEST_ADAPTER_ID,
+				0, &port0);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get event port\n");
+	ret = rte_event_crypto_adapter_service_event_port_get(TEST_ADAPTER_ID,
+				1, &port1);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get event port\n");
+	TEST_ASSERT(port0 != port1, "Services share event port %u", port0);
+
+	ret = rte_event_crypto_adapter_service_event_port_get(TEST_ADAPTER_ID,
+				2, &port0);
+	TEST_ASSERT(ret == -EINVAL, "Expected -EINVAL got %d", ret);
+
+	ret = rte_event_crypto_adapter_queue_pair_del(TEST_ADAPTER_ID,
+				TEST_CDEV_ID, -1);
+	TEST_ASSERT_SUCCESS(ret, "Failed to delete queue pairs\n");
+
+	return TEST_SUCCESS;
+}
 
+static int
+configure_event_crypto_adapter(enum rte_event_crypto_adapter_mode mode,
+			struct rte_event_port_conf *conf)
+{
 	uint32_t cap;
 	int ret;
 
 	/* Create adapter with default port creation callback */
 	ret = rte_event_crypto_adapter_create(TEST_ADAPTER_ID,
 					      TEST_CDEV_ID,
-					      &conf, mode);
+					      conf, mode);
 	TEST_ASSERT_SUCCESS(ret, "Failed to create event crypto adapter\n");
 
 	ret = rte_event_crypto_adapter_caps_get(TEST_ADAPTER_ID, evdev, &cap);
@@ -755,14 +932,15 @@ test_crypto_adapter_stop(void)
 }
 
 static int
-test_crypto_adapter_conf(enum rte_event_crypto_adapter_mode mode)
+test_crypto_adapter_conf(enum rte_event_crypto_adapter_mode mode,
+			struct rte_event_port_conf *conf)
 {
 	uint32_t evdev_service_id;
 	uint8_t qid;
 	int ret;
 
 	if (!crypto_adapter_setup_done) {
-		ret = configure_event_crypto_adapter(mode);
+		ret = configure_event_crypto_adapter(mode, conf);
 		if (!ret) {
 			qid = TEST_CRYPTO_EV_QUEUE_ID;
 			ret = rte_event_port_link(evdev,
@@ -804,18 +982,65 @@ test_crypto_adapter_conf_op_forward_mode(void)
 	enum rte_event_crypto_adapter_mode mode;
 
 	mode = RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD;
-	test_crypto_adapter_conf(mode);
+	test_crypto_adapter_conf(mode, &adapter_port_conf);
 
 	return TEST_SUCCESS;
 }
 
+static int
+test_crypto_adapter_conf_op_forward_release(void)
+{
+	struct rte_event_port_conf conf = {
+		.dequeue_depth = 8,
+		.enqueue_depth = 8,
+		/* completions forwarded in place of the events dequeued by
+		 * the adapter don't take new event credits
+		 */
+		.new_event_threshold = 1,
+		.disable_implicit_release = 1,
+	};
+	struct rte_event_dev_info info;
+	uint32_t cap;
+	int ret;
+
+	ret = rte_event_dev_info_get(evdev, &info);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get event dev info\n");
+
+	ret = rte_event_crypto_adapter_caps_get(evdev, TEST_CDEV_ID, &cap);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get adapter capabilities\n");
+
+	if (!(info.event_dev_cap &
+	      RTE_EVENT_DEV_CAP_IMPLICIT_RELEASE_DISABLE) ||
+	    (cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_FWD))
+		return -ENOTSUP;
+
+	return test_crypto_adapter_conf(RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD,
+					&conf);
+}
+
+static void
+test_crypto_adapter_stop_free(void)
+{
+	uint8_t qid = TEST_CRYPTO_EV_QUEUE_ID;
+
+	if (!crypto_adapter_setup_done)
+		return;
+
+	test_crypto_adapter_stop();
+	rte_event_crypto_adapter_queue_pair_del(TEST_ADAPTER_ID, TEST_CDEV_ID,
+						TEST_CDEV_QP_ID);
+	rte_event_port_unlink(evdev, params.crypto_event_port_id, &qid, 1);
+	rte_event_crypto_adapter_free(TEST_ADAPTER_ID);
+	crypto_adapter_setup_done = 0;
+}
+
 static int
 test_crypto_adapter_conf_op_new_mode(void)
 {
 	enum rte_event_crypto_adapter_mode mode;
 
 	mode = RTE_EVENT_CRYPTO_ADAPTER_OP_NEW;
-	test_crypto_adapter_conf(mode);
+	test_crypto_adapter_conf(mode, &adapter_port_conf);
 	return TEST_SUCCESS;
 }
 
@@ -898,6 +1123,14 @@ static struct unit_test_suite functional_testsuite = {
 				test_crypto_adapter_free,
 				test_crypto_adapter_stats),
 
+		TEST_CASE_ST(test_crypto_adapter_create,
+				test_crypto_adapter_free,
+				test_crypto_adapter_nb_services),
+
+		TEST_CASE_ST(test_crypto_adapter_conf_op_forward_release,
+				test_crypto_adapter_stop_free,
+				test_op_forward_mode_release),
+
 		TEST_CASE_ST(test_crypto_adapter_conf_op_forward_mode,
 				test_crypto_adapter_stop,
 				test_session_with_op_forward_mode),
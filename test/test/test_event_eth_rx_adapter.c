@@ -7,7 +7,10 @@
 #include <rte_mbuf.h>
 #include <rte_ethdev.h>
 #include <rte_eventdev.h>
+#include <rte_eth_ring.h>
 #include <rte_bus_vdev.h>
+#include <rte_service.h>
+#include <rte_cycles.h>
 
 #include <rte_event_eth_rx_adapter.h>
 
@@ -20,6 +23,9 @@
 #define TEST_INST_ID		0
 #define TEST_DEV_ID		0
 #define TEST_ETHDEV_ID		0
+#define TEST_RING_SIZE		1024
+#define TEST_VECTOR_SZ		16
+#define TEST_VECTOR_TMO_US	10000
 
 struct event_eth_rx_adapter_test_params {
 	struct rte_mempool *mp;
@@ -27,6 +33,7 @@ struct event_eth_rx_adapter_test_params {
 	uint32_t caps;
 	int rx_intr_port_inited;
 	uint16_t rx_intr_port;
+	struct rte_mempool *vector_mp;
 };
 
 static struct event_eth_rx_adapter_test_params default_params;
@@ -303,6 +310,87 @@ testsuite_teardown_rx_intr(void)
 	rte_mempool_free(default_params.mp);
 }
 
+/* Create an ethdev receiving the mbufs enqueued to a ring */
+static int
+ring_port_create(const char *name, struct rte_ring **r, uint16_t *port_id)
+{
+	uint16_t rx_rings = default_params.rx_rings;
+	uint16_t tx_rings = default_params.tx_rings;
+	int p, err;
+
+	*r = rte_ring_create(name, TEST_RING_SIZE, rte_socket_id(),
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (*r == NULL)
+		return -ENOMEM;
+
+	p = rte_eth_from_ring(*r);
+	if (p < 0) {
+		rte_ring_free(*r);
+		return p;
+	}
+
+	err = port_init(p, default_params.mp);
+	default_params.rx_rings = rx_rings;
+	default_params.tx_rings = tx_rings;
+	if (err) {
+		rte_ring_free(*r);
+		return err;
+	}
+
+	*port_id = p;
+	return 0;
+}
+
+static void
+ring_port_free(uint16_t port_id, struct rte_ring *r)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+	void *m;
+
+	rte_eth_dev_stop(port_id);
+	rte_eth_dev_get_name_by_port(port_id, name);
+	rte_vdev_uninit(name);
+
+	while (rte_ring_dequeue(r, &m) == 0)
+		rte_pktmbuf_free(m);
+	rte_ring_free(r);
+}
+
+/* Make nb_pkts packets available to the Rx queue of a ring port */
+static unsigned int
+ring_port_feed(struct rte_ring *r, unsigned int nb_pkts)
+{
+	struct rte_mbuf *mbufs[64];
+	unsigned int n;
+
+	nb_pkts = RTE_MIN(nb_pkts, RTE_DIM(mbufs));
+	if (rte_pktmbuf_alloc_bulk(default_params.mp, mbufs, nb_pkts))
+		return 0;
+
+	n = rte_ring_enqueue_burst(r, (void **)mbufs, nb_pkts, NULL);
+	rte_pktmbuf_free_bulk(&mbufs[n], nb_pkts - n);
+
+	return n;
+}
+
+/* Let the adapter service function run on the application lcore */
+static int
+adapter_service_setup(uint32_t *service_id)
+{
+	int err;
+
+	err = rte_event_eth_rx_adapter_service_id_get(TEST_INST_ID,
+						service_id);
+	if (err)
+		return err;
+
+	err = rte_service_runstate_set(*service_id, 1);
+	if (err)
+		return err;
+
+	return rte_service_set_runstate_mapped_check(*service_id, 0);
+}
+
 static int
 adapter_create(void)
 {
@@ -331,6 +419,26 @@ adapter_free(void)
 	rte_event_eth_rx_adapter_free(TEST_INST_ID);
 }
 
+static int
+adapter_vector_create(void)
+{
+	default_params.vector_mp = rte_event_vector_pool_create(
+				"test_vector_pool", 64, 0, TEST_VECTOR_SZ,
+				rte_socket_id());
+	TEST_ASSERT(default_params.vector_mp != NULL,
+		"Failed to create vector pool");
+
+	return adapter_create();
+}
+
+static void
+adapter_vector_free(void)
+{
+	adapter_free();
+	rte_mempool_free(default_params.vector_mp);
+	default_params.vector_mp = NULL;
+}
+
 static int
 adapter_create_free(void)
 {
@@ -383,6 +491,7 @@ adapter_queue_add_del(void)
 	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
 	ev.priority = 0;
 
+	memset(&queue_config, 0, sizeof(queue_config));
 	queue_config.rx_queue_flags = 0;
 	if (cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_OVERRIDE_FLOW_ID) {
 		ev.flow_id = 1;
@@ -446,6 +555,16 @@ adapter_queue_add_del(void)
 						&queue_config);
 	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
 
+	if (!(cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT)) {
+		/* Rx interrupts are not enabled for the test port */
+		queue_config.rx_queue_flags |=
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_INTR_ADAPTIVE;
+		err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID,
+							TEST_ETHDEV_ID, -1,
+							&queue_config);
+		TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+	}
+
 	err = rte_event_eth_rx_adapter_queue_del(1, TEST_ETHDEV_ID, -1);
 	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
 
@@ -467,6 +586,7 @@ adapter_multi_eth_add_del(void)
 	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
 	ev.priority = 0;
 
+	memset(&queue_config, 0, sizeof(queue_config));
 	queue_config.rx_queue_flags = 0;
 	queue_config.ev = ev;
 	queue_config.servicing_weight = 1;
@@ -529,6 +649,7 @@ adapter_intr_queue_add_del(void)
 	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
 	ev.priority = 0;
 
+	memset(&queue_config, 0, sizeof(queue_config));
 	queue_config.rx_queue_flags = 0;
 	queue_config.ev = ev;
 
@@ -599,6 +720,62 @@ adapter_intr_queue_add_del(void)
 	return TEST_SUCCESS;
 }
 
+static int
+adapter_intr_adaptive_queue_add_del(void)
+{
+	int err;
+	struct rte_event ev;
+	uint16_t eth_port;
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+
+	if (!default_params.rx_intr_port_inited)
+		return 0;
+
+	eth_port = default_params.rx_intr_port;
+
+	ev.queue_id = 0;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	ev.priority = 0;
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.rx_queue_flags =
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_INTR_ADAPTIVE;
+	queue_config.ev = ev;
+
+	/* adaptive queues are polled queues */
+	queue_config.servicing_weight = 0;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, eth_port, 0,
+						&queue_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	queue_config.servicing_weight = 1;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, eth_port, -1,
+						&queue_config);
+	if (err == -ENOTSUP)
+		return TEST_SKIPPED;
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* adaptive -> interrupt mode queue */
+	queue_config.rx_queue_flags = 0;
+	queue_config.servicing_weight = 0;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, eth_port, -1,
+						&queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* interrupt mode -> adaptive queue */
+	queue_config.rx_queue_flags =
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_INTR_ADAPTIVE;
+	queue_config.servicing_weight = 1;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, eth_port, -1,
+						&queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, eth_port, -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
 static int
 adapter_start_stop(void)
 {
@@ -611,6 +788,7 @@ adapter_start_stop(void)
 
 	struct rte_event_eth_rx_adapter_queue_conf queue_config;
 
+	memset(&queue_config, 0, sizeof(queue_config));
 	queue_config.rx_queue_flags = 0;
 	if (default_params.caps &
 		RTE_EVENT_ETH_RX_ADAPTER_CAP_OVERRIDE_FLOW_ID) {
@@ -669,6 +847,389 @@ adapter_stats(void)
 	return TEST_SUCCESS;
 }
 
+static int
+adapter_queue_stats(void)
+{
+	int err;
+	struct rte_event ev;
+	struct rte_event_eth_rx_adapter_queue_stats stats;
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+
+	if (default_params.caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT)
+		return TEST_SKIPPED;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.queue_id = 0;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.ev = ev;
+	queue_config.servicing_weight = 1;
+	queue_config.burst_size = 8;
+
+	/* queue not added */
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID,
+						TEST_ETHDEV_ID, 0, &stats);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						-1, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID,
+						TEST_ETHDEV_ID, 0, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID,
+				TEST_ETHDEV_ID,
+				rte_eth_devices[TEST_ETHDEV_ID].data->nb_rx_queues,
+				&stats);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID,
+						TEST_ETHDEV_ID, 0, &stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT(stats.rx_poll_count == 0 && stats.rx_packets == 0,
+		"Expected zeroed stats for an idle adapter");
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						-1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_queue_event_vector(void)
+{
+	int err;
+	struct rte_event ev;
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+
+	if (!(default_params.caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR))
+		return TEST_SKIPPED;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.queue_id = 0;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.ev = ev;
+	queue_config.servicing_weight = 1;
+	queue_config.rx_queue_flags =
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	queue_config.vector_sz = TEST_VECTOR_SZ;
+	queue_config.vector_timeout_ns = TEST_VECTOR_TMO_US * 1000;
+
+	/* no vector mempool */
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						-1, &queue_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	/* vector size larger than the mempool vectors */
+	queue_config.vector_mp = default_params.vector_mp;
+	queue_config.vector_sz = 2 * TEST_VECTOR_SZ;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						-1, &queue_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	/* timeout that doesn't fit in 64 bits of TSC cycles */
+	queue_config.vector_sz = TEST_VECTOR_SZ;
+	if (rte_get_tsc_hz() > 1000000000ULL) {
+		queue_config.vector_timeout_ns = UINT64_MAX;
+		err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID,
+						TEST_ETHDEV_ID, -1,
+						&queue_config);
+		TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+	}
+
+	queue_config.vector_timeout_ns = TEST_VECTOR_TMO_US * 1000;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						-1, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						-1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+/* Configure event queue 0 and an event port linked to it, the adapter adds
+ * its own event port when the first Rx queue is added
+ */
+static int
+vector_evdev_setup(void)
+{
+	struct rte_event_dev_info dev_info;
+	struct rte_event_dev_config config;
+	uint8_t queue_id = 0;
+	int err;
+
+	err = rte_event_dev_info_get(TEST_DEV_ID, &dev_info);
+	if (err)
+		return err;
+
+	memset(&config, 0, sizeof(config));
+	config.nb_event_queues = 1;
+	config.nb_event_ports = 1;
+	config.nb_event_queue_flows = dev_info.max_event_queue_flows;
+	config.nb_event_port_dequeue_depth =
+			dev_info.max_event_port_dequeue_depth;
+	config.nb_event_port_enqueue_depth =
+			dev_info.max_event_port_enqueue_depth;
+	config.nb_events_limit = dev_info.max_num_events;
+	err = rte_event_dev_configure(TEST_DEV_ID, &config);
+	if (err)
+		return err;
+
+	err = rte_event_queue_setup(TEST_DEV_ID, queue_id, NULL);
+	if (err)
+		return err;
+
+	err = rte_event_port_setup(TEST_DEV_ID, 0, NULL);
+	if (err)
+		return err;
+
+	return rte_event_port_link(TEST_DEV_ID, 0, &queue_id, NULL, 1) == 1 ?
+		0 : -EIO;
+}
+
+/* Run the adapter and scheduler services and dequeue the vector events */
+static unsigned int
+vector_events_get(uint32_t rxa_service_id, struct rte_event *ev,
+		unsigned int nb_events)
+{
+	uint32_t evdev_service_id;
+	unsigned int n = 0;
+	int have_evdev_service;
+	int i;
+
+	have_evdev_service = rte_event_dev_service_id_get(TEST_DEV_ID,
+						&evdev_service_id) == 0;
+
+	/* the first run buffers the events, the second one, which receives
+	 * no packets, enqueues them to the event device
+	 */
+	rte_service_run_iter_on_app_lcore(rxa_service_id, 1);
+	rte_service_run_iter_on_app_lcore(rxa_service_id, 1);
+
+	for (i = 0; i < 16 && n < nb_events; i++) {
+		if (have_evdev_service)
+			rte_service_run_iter_on_app_lcore(evdev_service_id, 1);
+		n += rte_event_dequeue_burst(TEST_DEV_ID, 0, &ev[n],
+					nb_events - n, 0);
+	}
+
+	return n;
+}
+
+static void
+vector_event_free(struct rte_event *ev)
+{
+	struct rte_event_vector *vec = ev->vec;
+
+	rte_pktmbuf_free_bulk(vec->mbufs, vec->nb_elem);
+	rte_mempool_put(default_params.vector_mp, vec);
+}
+
+static int
+vector_event_check(struct rte_event *ev, uint16_t port, uint16_t nb_elem)
+{
+	struct rte_event_vector *vec = ev->vec;
+
+	TEST_ASSERT(ev->event_type == RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR,
+		"Expected a vector event, got event type %u",
+		ev->event_type);
+	TEST_ASSERT(vec->nb_elem == nb_elem,
+		"Expected %u mbufs in vector, got %u", nb_elem, vec->nb_elem);
+	TEST_ASSERT(vec->attr_valid && vec->port == port && vec->queue == 0,
+		"Expected vector attributes of port %u queue 0", port);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_queue_event_vector_datapath(void)
+{
+	int err;
+	uint32_t caps, service_id, evdev_service_id;
+	uint16_t port;
+	unsigned int n;
+	struct rte_ring *r;
+	struct rte_event ev[4];
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+
+	err = ring_port_create("rx_adapter_vec", &r, &port);
+	TEST_ASSERT(err == 0, "Ring port creation failed err %d", err);
+
+	err = rte_event_eth_rx_adapter_caps_get(TEST_DEV_ID, port, &caps);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	if (!(caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR) ||
+		(caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT)) {
+		ring_port_free(port, r);
+		return TEST_SKIPPED;
+	}
+
+	err = vector_evdev_setup();
+	TEST_ASSERT(err == 0, "Event device setup failed err %d", err);
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.ev.queue_id = 0;
+	queue_config.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	queue_config.servicing_weight = 1;
+	queue_config.rx_queue_flags =
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	queue_config.vector_sz = TEST_VECTOR_SZ;
+	queue_config.vector_timeout_ns = TEST_VECTOR_TMO_US * 1000;
+	queue_config.vector_mp = default_params.vector_mp;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, port, -1,
+						&queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = adapter_service_setup(&service_id);
+	TEST_ASSERT(err == 0, "Adapter service setup failed err %d", err);
+
+	if (rte_event_dev_service_id_get(TEST_DEV_ID, &evdev_service_id) == 0) {
+		rte_service_runstate_set(evdev_service_id, 1);
+		rte_service_set_runstate_mapped_check(evdev_service_id, 0);
+	}
+
+	err = rte_event_dev_start(TEST_DEV_ID);
+	TEST_ASSERT(err == 0, "Event device start failed err %d", err);
+
+	err = rte_event_eth_rx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* a full vector is enqueued as soon as it is formed, the remaining
+	 * mbufs are held until the vector timeout expires
+	 */
+	n = ring_port_feed(r, TEST_VECTOR_SZ + 4);
+	TEST_ASSERT(n == TEST_VECTOR_SZ + 4, "Failed to feed packets");
+
+	n = vector_events_get(service_id, ev, RTE_DIM(ev));
+	TEST_ASSERT(n == 1, "Expected 1 full vector, got %u events", n);
+	err = vector_event_check(&ev[0], port, TEST_VECTOR_SZ);
+	vector_event_free(&ev[0]);
+	TEST_ASSERT(err == TEST_SUCCESS, "Full vector check failed");
+
+	rte_delay_us(2 * TEST_VECTOR_TMO_US);
+
+	n = vector_events_get(service_id, ev, RTE_DIM(ev));
+	TEST_ASSERT(n == 1, "Expected 1 expired vector, got %u events", n);
+	err = vector_event_check(&ev[0], port, 4);
+	vector_event_free(&ev[0]);
+	TEST_ASSERT(err == TEST_SUCCESS, "Expired vector check failed");
+
+	err = rte_event_eth_rx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, port, -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	rte_event_dev_stop(TEST_DEV_ID);
+	ring_port_free(port, r);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_queue_stats_backpressure(void)
+{
+	int err;
+	unsigned int i;
+	uint32_t caps, service_id;
+	uint16_t port;
+	struct rte_ring *r;
+	struct rte_event_dev_info dev_info;
+	struct rte_event_port_conf rx_p_conf;
+	struct rte_event_eth_rx_adapter_stats stats;
+	struct rte_event_eth_rx_adapter_queue_stats q_stats;
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+
+	err = ring_port_create("rx_adapter_bp", &r, &port);
+	TEST_ASSERT(err == 0, "Ring port creation failed err %d", err);
+
+	err = rte_event_eth_rx_adapter_caps_get(TEST_DEV_ID, port, &caps);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	if (caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT) {
+		ring_port_free(port, r);
+		return TEST_SKIPPED;
+	}
+
+	/* the adapter's event port may only hold a few new events, so the
+	 * event device pushes back once they are enqueued
+	 */
+	err = rte_event_dev_info_get(TEST_DEV_ID, &dev_info);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	memset(&rx_p_conf, 0, sizeof(rx_p_conf));
+	rx_p_conf.new_event_threshold = 64;
+	rx_p_conf.dequeue_depth = dev_info.max_event_port_dequeue_depth;
+	rx_p_conf.enqueue_depth = dev_info.max_event_port_enqueue_depth;
+	err = rte_event_eth_rx_adapter_create(TEST_INST_ID, TEST_DEV_ID,
+					&rx_p_conf);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.ev.queue_id = 0;
+	queue_config.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	queue_config.servicing_weight = 1;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, port, -1,
+						&queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = adapter_service_setup(&service_id);
+	TEST_ASSERT(err == 0, "Adapter service setup failed err %d", err);
+
+	err = rte_event_eth_rx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	for (i = 0; i < TEST_RING_SIZE / 64; i++) {
+		ring_port_feed(r, 64);
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+
+		err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID,
+							port, 0, &q_stats);
+		TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+		if (q_stats.rx_enq_retry)
+			break;
+	}
+
+	err = rte_event_eth_rx_adapter_stats_get(TEST_INST_ID, &stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	TEST_ASSERT(q_stats.rx_poll_count > 0 && q_stats.rx_packets > 0,
+		"Expected the queue to be polled");
+	TEST_ASSERT(q_stats.rx_enq_retry > 0,
+		"Expected deferred polls of the queue under back-pressure");
+	TEST_ASSERT(stats.rx_enq_retry > 0,
+		"Expected event enqueue retries under back-pressure");
+	TEST_ASSERT(stats.rx_enq_count < stats.rx_packets,
+		"Expected packets to be held back by the event device");
+
+	err = rte_event_eth_rx_adapter_stats_reset(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_stats_get(TEST_INST_ID, port, 0,
+						&q_stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT(q_stats.rx_poll_count == 0 && q_stats.rx_packets == 0 &&
+		q_stats.rx_enq_retry == 0,
+		"Expected queue stats to be reset");
+
+	err = rte_event_eth_rx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, port, -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	rte_event_eth_rx_adapter_free(TEST_INST_ID);
+	ring_port_free(port, r);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite event_eth_rx_tests = {
 	.suite_name = "rx event eth adapter test suite",
 	.setup = testsuite_setup,
@@ -681,6 +1242,12 @@ static struct unit_test_suite event_eth_rx_tests = {
 					adapter_multi_eth_add_del),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_start_stop),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_stats),
+		TEST_CASE_ST(adapter_create, adapter_free, adapter_queue_stats),
+		TEST_CASE_ST(NULL, NULL, adapter_queue_stats_backpressure),
+		TEST_CASE_ST(adapter_vector_create, adapter_vector_free,
+					adapter_queue_event_vector),
+		TEST_CASE_ST(adapter_vector_create, adapter_vector_free,
+					adapter_queue_event_vector_datapath),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
@@ -692,6 +1259,8 @@ static struct unit_test_suite event_eth_rx_intr_tests = {
 	.unit_test_cases = {
 		TEST_CASE_ST(adapter_create, adapter_free,
 			adapter_intr_queue_add_del),
+		TEST_CASE_ST(adapter_create, adapter_free,
+			adapter_intr_adaptive_queue_add_del),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
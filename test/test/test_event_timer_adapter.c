@@ -1701,6 +1701,103 @@ adapter_tick_resolution(void)
 	return TEST_SUCCESS;
 }
 
+/* Measure the cost of arming and canceling event timers in bursts, then let
+ * a burst of timers expire and report the expiry latency percentiles tracked
+ * by the adapter.
+ */
+static int
+adapter_arm_cancel_perf(void)
+{
+	int i, events = 0;
+	uint16_t n;
+	uint64_t start, arm_cycles, cancel_cycles, wait_end;
+	struct rte_event_timer_adapter_stats stats;
+	struct rte_event_timer *evtims[MAX_TIMERS];
+	struct rte_event evs[BATCH_SIZE];
+	const struct rte_event_timer init_tim = {
+		.ev.op = RTE_EVENT_OP_NEW,
+		.ev.queue_id = TEST_QUEUE_ID,
+		.ev.sched_type = RTE_SCHED_TYPE_ATOMIC,
+		.ev.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.ev.event_type =  RTE_EVENT_TYPE_TIMER,
+		.state = RTE_EVENT_TIMER_NOT_ARMED,
+		.timeout_ticks = 50,	// expire in 5 secs
+	};
+
+	/* Only run this test in the software driver case */
+	if (!using_services)
+		return -ENOTSUP;
+
+	TEST_ASSERT_SUCCESS(rte_mempool_get_bulk(eventdev_test_mempool,
+						 (void **)evtims, MAX_TIMERS),
+			    "Failed to get event timers");
+
+	for (i = 0; i < MAX_TIMERS; i++) {
+		*evtims[i] = init_tim;
+		evtims[i]->ev.event_ptr = evtims[i];
+	}
+
+	start = rte_rdtsc();
+	for (i = 0; i < MAX_TIMERS; i += BATCH_SIZE) {
+		n = rte_event_timer_arm_burst(timdev, &evtims[i], BATCH_SIZE);
+		TEST_ASSERT_EQUAL(n, BATCH_SIZE, "Failed to arm event timers: "
+				  "%s", rte_strerror(rte_errno));
+	}
+	arm_cycles = rte_rdtsc() - start;
+
+	start = rte_rdtsc();
+	for (i = 0; i < MAX_TIMERS; i += BATCH_SIZE) {
+		n = rte_event_timer_cancel_burst(timdev, &evtims[i],
+						 BATCH_SIZE);
+		TEST_ASSERT_EQUAL(n, BATCH_SIZE, "Failed to cancel event "
+				  "timers: %s", rte_strerror(rte_errno));
+	}
+	cancel_cycles = rte_rdtsc() - start;
+
+	/* Re-arm every timer one tick out and collect the expiry events */
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_stats_reset(timdev),
+			    "Failed to reset stats");
+
+	for (i = 0; i < MAX_TIMERS; i += BATCH_SIZE) {
+		n = rte_event_timer_arm_tmo_tick_burst(timdev, &evtims[i], 1,
+						       BATCH_SIZE);
+		TEST_ASSERT_EQUAL(n, BATCH_SIZE, "Failed to arm event timers: "
+				  "%s", rte_strerror(rte_errno));
+	}
+
+	wait_end = rte_get_timer_cycles() + rte_get_timer_hz() * 5;
+	while (events < MAX_TIMERS && rte_get_timer_cycles() < wait_end)
+		events += rte_event_dequeue_burst(evdev, TEST_PORT_ID, evs,
+						  RTE_DIM(evs), 0);
+
+	TEST_ASSERT_EQUAL(events, MAX_TIMERS, "Dequeued incorrect number (%d) "
+			  "of timer expiry events", events);
+
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_stats_get(timdev,
+			&stats), "Failed to get adapter stats");
+	TEST_ASSERT_EQUAL(stats.evtim_exp_count, MAX_TIMERS, "Expected %d "
+			  "expired timers, got %"PRIu64, MAX_TIMERS,
+			  stats.evtim_exp_count);
+	TEST_ASSERT(stats.evtim_exp_lat_p50_ns <= stats.evtim_exp_lat_p99_ns &&
+		    stats.evtim_exp_lat_p99_ns <= stats.evtim_exp_lat_p999_ns &&
+		    stats.evtim_exp_lat_p999_ns <= stats.evtim_exp_lat_max_ns,
+		    "Expiry latency percentiles out of order");
+
+	printf("Event timer arm: %.1f cycles/timer, cancel: %.1f cycles/timer "
+	       "(burst size %d)\n",
+	       (double)arm_cycles / MAX_TIMERS,
+	       (double)cancel_cycles / MAX_TIMERS, BATCH_SIZE);
+	printf("Event timer expiry latency: p50 %"PRIu64" ns, p99 %"PRIu64
+	       " ns, p99.9 %"PRIu64" ns, max %"PRIu64" ns\n",
+	       stats.evtim_exp_lat_p50_ns, stats.evtim_exp_lat_p99_ns,
+	       stats.evtim_exp_lat_p999_ns, stats.evtim_exp_lat_max_ns);
+
+	rte_mempool_put_bulk(eventdev_test_mempool, (void **)evtims,
+			     MAX_TIMERS);
+
+	return TEST_SUCCESS;
+}
+
 static int
 adapter_create_max(void)
 {
@@ -1816,6 +1913,8 @@ static struct unit_test_suite event_timer_adptr_functional_testsuite  = {
 				event_timer_cancel_double),
 		TEST_CASE_ST(timdev_setup_msec, timdev_teardown,
 				adapter_tick_resolution),
+		TEST_CASE_ST(timdev_setup_msec, timdev_teardown,
+				adapter_arm_cancel_perf),
 		TEST_CASE(adapter_create_max),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
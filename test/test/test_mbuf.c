@@ -27,6 +27,7 @@
 #include <rte_mbuf.h>
 #include <rte_random.h>
 #include <rte_cycles.h>
+#include <rte_errno.h>
 
 #include "test.h"
 
@@ -49,6 +50,9 @@
 
 #define MAGIC_DATA              0x42424242
 
+#define MBUF_FREE_BULK_NB       32
+#define MBUF_FREE_BULK_ITER     1000
+
 #define MAKE_STRING(x)          # x
 
 #ifdef RTE_MBUF_REFCNT_ATOMIC
@@ -501,6 +505,314 @@ test_attach_from_different_pool(struct rte_mempool *pktmbuf_pool,
 		rte_pktmbuf_free(clone2);
 	return -1;
 }
+
+static int
+test_mbuf_dyn(struct rte_mempool *pktmbuf_pool)
+{
+	const struct rte_mbuf_dynfield dynfield = {
+		.name = "test-dynfield",
+		.size = sizeof(uint8_t),
+		.align = __alignof__(uint8_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield2 = {
+		.name = "test-dynfield2",
+		.size = sizeof(uint16_t),
+		.align = __alignof__(uint16_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield3 = {
+		.name = "test-dynfield3",
+		.size = sizeof(uint8_t),
+		.align = __alignof__(uint8_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield_fail_big = {
+		.name = "test-dynfield-fail-big",
+		.size = 256,
+		.align = 1,
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield_fail_align = {
+		.name = "test-dynfield-fail-align",
+		.size = 1,
+		.align = 3,
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield_fail_busy = {
+		.name = "test-dynfield-fail-busy",
+		.size = 1,
+		.align = 1,
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag = {
+		.name = "test-dynflag",
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag2 = {
+		.name = "test-dynflag2",
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag3 = {
+		.name = "test-dynflag3",
+		.flags = 0,
+	};
+	struct rte_mbuf *m = NULL;
+	int offset, offset2, offset3;
+	int flag, flag2, flag3;
+	int ret;
+
+	printf("Test mbuf dynamic fields and flags\n");
+	rte_mbuf_dyn_dump(stdout);
+
+	offset = rte_mbuf_dynfield_register(&dynfield);
+	if (offset == -1)
+		GOTO_FAIL("failed to register dynamic field, offset=%d: %s",
+			offset, rte_strerror(rte_errno));
+
+	ret = rte_mbuf_dynfield_register(&dynfield);
+	if (ret != offset)
+		GOTO_FAIL("failed to lookup dynamic field, ret=%d: %s",
+			ret, rte_strerror(rte_errno));
+
+	offset2 = rte_mbuf_dynfield_register(&dynfield2);
+	if (offset2 == -1 || offset2 == offset || (offset2 & 1))
+		GOTO_FAIL("failed to register dynamic field 2, offset2=%d: %s",
+			offset2, rte_strerror(rte_errno));
+
+	offset3 = rte_mbuf_dynfield_register_offset(&dynfield3,
+				offsetof(struct rte_mbuf, dynfield1[1]));
+	if (offset3 != (int)offsetof(struct rte_mbuf, dynfield1[1]))
+		GOTO_FAIL("failed to register dynamic field 3, offset=%d: %s",
+			offset3, rte_strerror(rte_errno));
+
+	printf("dynfield: offset=%d, offset2=%d, offset3=%d\n",
+		offset, offset2, offset3);
+
+	ret = rte_mbuf_dynfield_register(&dynfield_fail_big);
+	if (ret != -1)
+		GOTO_FAIL("dynamic field creation should fail (too big)");
+
+	ret = rte_mbuf_dynfield_register(&dynfield_fail_align);
+	if (ret != -1)
+		GOTO_FAIL("dynamic field creation should fail (bad alignment)");
+
+	ret = rte_mbuf_dynfield_register_offset(&dynfield_fail_busy,
+				offsetof(struct rte_mbuf, ol_flags));
+	if (ret != -1)
+		GOTO_FAIL("dynamic field creation should fail (not avail)");
+
+	if (rte_mbuf_dynfield_lookup(dynfield2.name, NULL) != offset2)
+		GOTO_FAIL("failed to lookup dynamic field 2");
+
+	flag = rte_mbuf_dynflag_register(&dynflag);
+	if (flag == -1)
+		GOTO_FAIL("failed to register dynamic flag, flag=%d: %s",
+			flag, rte_strerror(rte_errno));
+
+	ret = rte_mbuf_dynflag_register(&dynflag);
+	if (ret != flag)
+		GOTO_FAIL("failed to lookup dynamic flag, ret=%d: %s",
+			ret, rte_strerror(rte_errno));
+
+	flag2 = rte_mbuf_dynflag_register(&dynflag2);
+	if (flag2 == -1 || flag2 == flag)
+		GOTO_FAIL("failed to register dynamic flag 2, flag2=%d: %s",
+			flag2, rte_strerror(rte_errno));
+
+	flag3 = rte_mbuf_dynflag_register_bitnum(&dynflag3,
+						__builtin_ctzll(PKT_LAST_FREE));
+	if (flag3 != __builtin_ctzll(PKT_LAST_FREE))
+		GOTO_FAIL("failed to register dynamic flag 3, flag3=%d: %s",
+			flag3, rte_strerror(rte_errno));
+
+	printf("dynflag: flag=%d, flag2=%d, flag3=%d\n", flag, flag2, flag3);
+
+	/* set, get dynamic field */
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("Cannot allocate mbuf");
+
+	*RTE_MBUF_DYNFIELD(m, offset, uint8_t *) = 1;
+	if (*RTE_MBUF_DYNFIELD(m, offset, uint8_t *) != 1)
+		GOTO_FAIL("failed to read dynamic field");
+	*RTE_MBUF_DYNFIELD(m, offset2, uint16_t *) = 1000;
+	if (*RTE_MBUF_DYNFIELD(m, offset2, uint16_t *) != 1000)
+		GOTO_FAIL("failed to read dynamic field");
+
+	/* set a dynamic flag */
+	m->ol_flags |= (1ULL << flag);
+
+	rte_mbuf_dyn_dump(stdout);
+	rte_pktmbuf_free(m);
+	return 0;
+fail:
+	rte_pktmbuf_free(m);
+	return -1;
+}
+
+static int
+test_pktmbuf_alloc_chain_bulk(struct rte_mempool *pktmbuf_pool)
+{
+	static const uint32_t pkt_lens[] = {
+		0, 100, MBUF_DATA_SIZE - RTE_PKTMBUF_HEADROOM,
+		MBUF_DATA_SIZE - RTE_PKTMBUF_HEADROOM + 1, 9000,
+	};
+	const uint32_t seg_room = MBUF_DATA_SIZE - RTE_PKTMBUF_HEADROOM;
+	struct rte_mbuf *pkts[8];
+	struct rte_mbuf *clone = NULL;
+	struct rte_mbuf *seg;
+	unsigned int avail, i, j, nb_segs;
+	uint32_t len;
+	int ret;
+
+	printf("Test chained mbuf bulk allocation\n");
+
+	memset(pkts, 0, sizeof(pkts));
+	avail = rte_mempool_avail_count(pktmbuf_pool);
+
+	for (i = 0; i < RTE_DIM(pkt_lens); i++) {
+		ret = rte_pktmbuf_alloc_chain_bulk(pktmbuf_pool, pkts,
+				RTE_DIM(pkts), pkt_lens[i]);
+		if (ret != 0)
+			GOTO_FAIL("cannot allocate chains of %u bytes",
+				pkt_lens[i]);
+
+		nb_segs = RTE_MAX(1u, (pkt_lens[i] + seg_room - 1) / seg_room);
+		for (j = 0; j < RTE_DIM(pkts); j++) {
+			if (pkts[j]->nb_segs != nb_segs)
+				GOTO_FAIL("bad nb_segs %u, expected %u",
+					pkts[j]->nb_segs, nb_segs);
+			if (pkts[j]->pkt_len != pkt_lens[i])
+				GOTO_FAIL("bad pkt_len %u", pkts[j]->pkt_len);
+			rte_mbuf_sanity_check(pkts[j], 1);
+
+			len = 0;
+			for (seg = pkts[j]; seg != NULL; seg = seg->next) {
+				memset(rte_pktmbuf_mtod(seg, char *), 0xaa,
+					seg->data_len);
+				len += seg->data_len;
+			}
+			if (len != pkt_lens[i])
+				GOTO_FAIL("bad sum of data_len %u", len);
+		}
+
+		/* segments referenced by a clone must not be freed */
+		clone = rte_pktmbuf_clone(pkts[0], pktmbuf_pool);
+		if (clone == NULL)
+			GOTO_FAIL("cannot clone chain");
+
+		rte_pktmbuf_free_chain_bulk(pkts, RTE_DIM(pkts));
+		memset(pkts, 0, sizeof(pkts));
+		if (pkt_lens[i] != 0 &&
+				rte_pktmbuf_read(clone, 0, 1, &len) == NULL)
+			GOTO_FAIL("cannot read clone");
+		rte_pktmbuf_free_chain_bulk(&clone, 1);
+		clone = NULL;
+
+		if (rte_mempool_avail_count(pktmbuf_pool) != avail)
+			GOTO_FAIL("mbufs leaked after freeing %u bytes chains",
+				pkt_lens[i]);
+	}
+
+	ret = rte_pktmbuf_alloc_chain_bulk(pktmbuf_pool, pkts, 1,
+			seg_room * RTE_PKTMBUF_CHAIN_BULK_MAX + 1);
+	if (ret != -EINVAL)
+		GOTO_FAIL("allocation of too many segments should fail");
+
+	ret = rte_pktmbuf_alloc_chain_bulk(pktmbuf_pool, pkts, 1, UINT32_MAX);
+	if (ret != -EINVAL)
+		GOTO_FAIL("allocation of a UINT32_MAX bytes chain should fail");
+
+	ret = rte_pktmbuf_alloc_chain_bulk(pktmbuf_pool, pkts, RTE_DIM(pkts),
+			seg_room * RTE_PKTMBUF_CHAIN_BULK_MAX);
+	if (ret != -ENOENT)
+		GOTO_FAIL("allocation of more mbufs than the pool should fail");
+	if (rte_mempool_avail_count(pktmbuf_pool) != avail)
+		GOTO_FAIL("mbufs leaked after a failed allocation");
+
+	return 0;
+fail:
+	rte_pktmbuf_free(clone);
+	rte_pktmbuf_free_chain_bulk(pkts, RTE_DIM(pkts));
+	return -1;
+}
+
+static int
+test_pktmbuf_free_bulk(struct rte_mempool *pktmbuf_pool,
+		struct rte_mempool *pktmbuf_pool2)
+{
+	struct rte_mbuf *mbufs[MBUF_FREE_BULK_NB];
+	unsigned int avail, avail2, i;
+	uint64_t start, free_cycles, bulk_cycles;
+
+	printf("Test mbuf bulk free\n");
+
+	memset(mbufs, 0, sizeof(mbufs));
+	avail = rte_mempool_avail_count(pktmbuf_pool);
+	avail2 = rte_mempool_avail_count(pktmbuf_pool2);
+
+	/* mix simple, chained, cloned mbufs from two pools, and NULLs */
+	for (i = 0; i < MBUF_FREE_BULK_NB; i++) {
+		if (i % 8 == 5)
+			continue;
+		if (i % 8 == 6)
+			mbufs[i] = rte_pktmbuf_alloc(pktmbuf_pool2);
+		else if (i % 8 == 7)
+			mbufs[i] = rte_pktmbuf_alloc_chain(pktmbuf_pool,
+					2 * MBUF_DATA_SIZE);
+		else
+			mbufs[i] = rte_pktmbuf_alloc(pktmbuf_pool);
+		if (mbufs[i] == NULL)
+			GOTO_FAIL("cannot allocate mbuf %u", i);
+	}
+	for (i = 0; i < MBUF_FREE_BULK_NB; i += 8) {
+		mbufs[i + 5] = rte_pktmbuf_clone(mbufs[i + 7], pktmbuf_pool);
+		if (mbufs[i + 5] == NULL)
+			GOTO_FAIL("cannot clone mbuf %u", i + 7);
+	}
+
+	rte_pktmbuf_free_bulk(mbufs, MBUF_FREE_BULK_NB);
+	memset(mbufs, 0, sizeof(mbufs));
+
+	if (rte_mempool_avail_count(pktmbuf_pool) != avail ||
+			rte_mempool_avail_count(pktmbuf_pool2) != avail2)
+		GOTO_FAIL("mbufs leaked after bulk free");
+
+	/* compare the cost of the common case with rte_pktmbuf_free() */
+	free_cycles = 0;
+	bulk_cycles = 0;
+	for (i = 0; i < MBUF_FREE_BULK_ITER; i++) {
+		unsigned int j;
+
+		if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, mbufs,
+				MBUF_FREE_BULK_NB) != 0)
+			GOTO_FAIL("cannot allocate mbufs");
+		start = rte_rdtsc_precise();
+		for (j = 0; j < MBUF_FREE_BULK_NB; j++)
+			rte_pktmbuf_free(mbufs[j]);
+		free_cycles += rte_rdtsc_precise() - start;
+
+		if (rte_pktmbuf_alloc_bulk(pktmbuf_pool, mbufs,
+				MBUF_FREE_BULK_NB) != 0)
+			GOTO_FAIL("cannot allocate mbufs");
+		start = rte_rdtsc_precise();
+		rte_pktmbuf_free_bulk(mbufs, MBUF_FREE_BULK_NB);
+		bulk_cycles += rte_rdtsc_precise() - start;
+	}
+	memset(mbufs, 0, sizeof(mbufs));
+
+	printf("rte_pktmbuf_free: %.2f cycles/mbuf, "
+		"rte_pktmbuf_free_bulk: %.2f cycles/mbuf\n",
+		(double)free_cycles / (MBUF_FREE_BULK_ITER * MBUF_FREE_BULK_NB),
+		(double)bulk_cycles / (MBUF_FREE_BULK_ITER * MBUF_FREE_BULK_NB));
+
+	return 0;
+fail:
+	rte_pktmbuf_free_bulk(mbufs, MBUF_FREE_BULK_NB);
+	return -1;
+}
+
 #undef GOTO_FAIL
 
 /*
@@ -1126,6 +1438,21 @@ test_mbuf(void)
 		printf("test_mbuf_linearize_check() failed\n");
 		goto err;
 	}
+
+	if (test_pktmbuf_alloc_chain_bulk(pktmbuf_pool) < 0) {
+		printf("test_pktmbuf_alloc_chain_bulk() failed\n");
+		goto err;
+	}
+
+	if (test_pktmbuf_free_bulk(pktmbuf_pool, pktmbuf_pool2) < 0) {
+		printf("test_pktmbuf_free_bulk() failed\n");
+		goto err;
+	}
+
+	if (test_mbuf_dyn(pktmbuf_pool) < 0) {
+		printf("test_mbuf_dyn() failed\n");
+		goto err;
+	}
 	ret = 0;
 
 err:
@@ -447,6 +447,90 @@ test_mempool_same_name_twice_creation(void)
 	return 0;
 }
 
+struct page_bounds_arg {
+	size_t pg_sz;
+	unsigned int crossing;
+};
+
+static void
+check_obj_page_bounds(struct rte_mempool *mp, void *opaque, void *obj,
+		      unsigned int obj_idx __rte_unused)
+{
+	struct page_bounds_arg *arg = opaque;
+	size_t total_elt_sz = mp->header_size + mp->elt_size +
+		mp->trailer_size;
+	char *start = (char *)obj - mp->header_size;
+	char *end = start + total_elt_sz - 1;
+
+	if (RTE_PTR_ALIGN_FLOOR(start, arg->pg_sz) !=
+			RTE_PTR_ALIGN_FLOOR(end, arg->pg_sz))
+		arg->crossing++;
+}
+
+static void
+sum_chunk_len(struct rte_mempool *mp __rte_unused, void *opaque,
+	      struct rte_mempool_memhdr *memhdr,
+	      unsigned int mem_idx __rte_unused)
+{
+	size_t *mem_len = opaque;
+
+	*mem_len += memhdr->len;
+}
+
+/*
+ * check that no object of a mempool is placed across a page boundary,
+ * with an object size that does not divide the page size
+ */
+static int
+test_mempool_page_bounds(void)
+{
+	struct page_bounds_arg arg;
+	struct rte_mempool *mp;
+	size_t total_elt_sz;
+	size_t mem_len = 0;
+	int ret = -1;
+
+	mp = rte_mempool_create("test_page_bounds", MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE - 548, 0, 0,
+		NULL, NULL,
+		NULL, NULL,
+		SOCKET_ID_ANY, 0);
+	if (mp == NULL)
+		RET_ERR();
+
+	memset(&arg, 0, sizeof(arg));
+	if (rte_mempool_get_page_size(mp, &arg.pg_sz) < 0)
+		GOTO_ERR(ret, exit);
+
+	total_elt_sz = mp->header_size + mp->elt_size + mp->trailer_size;
+	rte_mempool_mem_iter(mp, sum_chunk_len, &mem_len);
+	printf("mempool <%s>: page size %zu, %u objects of %zu bytes in %zu bytes (%zu%% used)\n",
+		mp->name, arg.pg_sz, mp->populated_size, total_elt_sz,
+		mem_len, mem_len == 0 ? 0 :
+		mp->populated_size * total_elt_sz * 100 / mem_len);
+
+	if (mp->populated_size != mp->size)
+		GOTO_ERR(ret, exit);
+
+	/* page boundaries are ignored for this pool */
+	if (arg.pg_sz == 0 || total_elt_sz > arg.pg_sz) {
+		ret = 0;
+		goto exit;
+	}
+
+	rte_mempool_obj_iter(mp, check_obj_page_bounds, &arg);
+	if (arg.crossing != 0) {
+		printf("%u objects cross a page boundary\n", arg.crossing);
+		GOTO_ERR(ret, exit);
+	}
+
+	ret = 0;
+
+exit:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 static void
 walk_cb(struct rte_mempool *mp, void *userdata __rte_unused)
 {
@@ -571,6 +655,9 @@ test_mempool(void)
 	if (test_mempool_same_name_twice_creation() < 0)
 		goto err;
 
+	if (test_mempool_page_bounds() < 0)
+		goto err;
+
 	/* test the stack handler */
 	if (test_mempool_basic(mp_stack, 1) < 0)
 		goto err;
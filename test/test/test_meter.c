@@ -11,6 +11,8 @@
 #include "test.h"
 
 #include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
 #include <rte_meter.h>
 
 #define mlog(format, ...) do{\
@@ -35,6 +37,11 @@
 #define TM_TEST_TRTCM_CBS_DF 2048
 #define TM_TEST_TRTCM_PBS_DF 4096
 
+#define TM_TEST_RFC4115_CIR_DF 46000000
+#define TM_TEST_RFC4115_EIR_DF 69000000
+#define TM_TEST_RFC4115_CBS_DF 2048
+#define TM_TEST_RFC4115_EBS_DF 4096
+
 static struct rte_meter_srtcm_params sparams =
 				{.cir = TM_TEST_SRTCM_CIR_DF,
 				 .cbs = TM_TEST_SRTCM_CBS_DF,
@@ -46,6 +53,12 @@ static struct	rte_meter_trtcm_params tparams=
 				 .cbs = TM_TEST_TRTCM_CBS_DF,
 				 .pbs = TM_TEST_TRTCM_PBS_DF,};
 
+static struct rte_meter_trtcm_rfc4115_params rparams =
+				{.cir = TM_TEST_RFC4115_CIR_DF,
+				 .eir = TM_TEST_RFC4115_EIR_DF,
+				 .cbs = TM_TEST_RFC4115_CBS_DF,
+				 .ebs = TM_TEST_RFC4115_EBS_DF,};
+
 /**
  * functional test for rte_meter_srtcm_config
  */
@@ -148,6 +161,68 @@ tm_test_trtcm_config(void)
 	return 0;
 }
 
+/**
+ * functional test for rte_meter_trtcm_rfc4115_config
+ */
+static inline int
+tm_test_trtcm_rfc4115_config(void)
+{
+	struct rte_meter_trtcm_rfc4115_profile rp;
+	struct rte_meter_trtcm_rfc4115_params rparams1;
+#define RFC4115_CFG_MSG "trtcm_rfc4115_config"
+
+	/* invalid parameter test */
+	if (rte_meter_trtcm_rfc4115_profile_config(NULL, NULL) == 0)
+		melog(RFC4115_CFG_MSG);
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, NULL) == 0)
+		melog(RFC4115_CFG_MSG);
+	if (rte_meter_trtcm_rfc4115_profile_config(NULL, &rparams) == 0)
+		melog(RFC4115_CFG_MSG);
+
+	/* cir and eir can't both be zero */
+	rparams1 = rparams;
+	rparams1.cir = 0;
+	rparams1.eir = 0;
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) == 0)
+		melog(RFC4115_CFG_MSG);
+
+	/* an enabled bucket can't have a zero size */
+	rparams1 = rparams;
+	rparams1.cbs = 0;
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) == 0)
+		melog(RFC4115_CFG_MSG);
+
+	rparams1 = rparams;
+	rparams1.ebs = 0;
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) == 0)
+		melog(RFC4115_CFG_MSG);
+
+	/* one of the buckets can be disabled, should be successful */
+	rparams1 = rparams;
+	rparams1.cir = 0;
+	rparams1.cbs = 0;
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) != 0)
+		melog(RFC4115_CFG_MSG);
+
+	rparams1 = rparams;
+	rparams1.eir = 0;
+	rparams1.ebs = 0;
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) != 0)
+		melog(RFC4115_CFG_MSG);
+
+	/* eir can be lower than cir, should be successful */
+	rparams1 = rparams;
+	rparams1.eir = rparams1.cir - 1;
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) != 0)
+		melog(RFC4115_CFG_MSG" eir < cir test");
+
+	/* usual parameter, should be successful */
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams) != 0)
+		melog(RFC4115_CFG_MSG);
+
+	return 0;
+}
+
 /**
  * functional test for rte_meter_srtcm_color_blind_check
  */
@@ -265,6 +340,79 @@ tm_test_trtcm_color_blind_check(void)
 	return 0;
 }
 
+/**
+ * functional test for rte_meter_trtcm_rfc4115_color_blind_check
+ */
+static inline int
+tm_test_trtcm_rfc4115_color_blind_check(void)
+{
+#define RFC4115_BLIND_CHECK_MSG "trtcm_rfc4115_blind_check"
+
+	uint64_t time;
+	struct rte_meter_trtcm_rfc4115_profile rp;
+	struct rte_meter_trtcm_rfc4115 rm;
+	struct rte_meter_trtcm_rfc4115_params rparams1;
+	uint64_t hz = rte_get_tsc_hz();
+
+	/* Test green */
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	if (rte_meter_trtcm_rfc4115_config(&rm, &rp) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if (rte_meter_trtcm_rfc4115_color_blind_check(
+		&rm, &rp, time, TM_TEST_RFC4115_CBS_DF - 1)
+		!= e_RTE_METER_GREEN)
+		melog(RFC4115_BLIND_CHECK_MSG" GREEN");
+
+	/* Test yellow */
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	if (rte_meter_trtcm_rfc4115_config(&rm, &rp) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if (rte_meter_trtcm_rfc4115_color_blind_check(
+		&rm, &rp, time, TM_TEST_RFC4115_CBS_DF + 1)
+		!= e_RTE_METER_YELLOW)
+		melog(RFC4115_BLIND_CHECK_MSG" YELLOW");
+
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	if (rte_meter_trtcm_rfc4115_config(&rm, &rp) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if (rte_meter_trtcm_rfc4115_color_blind_check(
+		&rm, &rp, time, TM_TEST_RFC4115_EBS_DF - 1)
+		!= e_RTE_METER_YELLOW)
+		melog(RFC4115_BLIND_CHECK_MSG" YELLOW");
+
+	/* Test red */
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	if (rte_meter_trtcm_rfc4115_config(&rm, &rp) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if (rte_meter_trtcm_rfc4115_color_blind_check(
+		&rm, &rp, time, TM_TEST_RFC4115_EBS_DF + 1)
+		!= e_RTE_METER_RED)
+		melog(RFC4115_BLIND_CHECK_MSG" RED");
+
+	/* Test disabled C bucket, packets are never green */
+	rparams1 = rparams;
+	rparams1.cir = 0;
+	rparams1.cbs = 0;
+	if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams1) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	if (rte_meter_trtcm_rfc4115_config(&rm, &rp) != 0)
+		melog(RFC4115_BLIND_CHECK_MSG);
+	time = rte_get_tsc_cycles() + hz;
+	if (rte_meter_trtcm_rfc4115_color_blind_check(
+		&rm, &rp, time, 1) != e_RTE_METER_YELLOW)
+		melog(RFC4115_BLIND_CHECK_MSG" disabled C bucket");
+
+	return 0;
+}
+
 
 /**
  * @in[4] : the flags packets carries.
@@ -473,6 +621,182 @@ tm_test_trtcm_color_aware_check(void)
 	return 0;
 }
 
+/**
+ * @in[4] : the flags packets carries.
+ * @in[4] : the flags function expect to return.
+ * It will do blind check at the time of 1 second from beginning.
+ * At the time, it will use packets length of cbs -1, cbs + 1,
+ * ebs -1 and ebs +1 with flag in[0], in[1], in[2] and in[3] to do
+ * aware check, expect flag out[0], out[1], out[2] and out[3]
+ */
+static inline int
+tm_test_trtcm_rfc4115_aware_check
+(enum rte_meter_color in[4], enum rte_meter_color out[4])
+{
+#define RFC4115_AWARE_CHECK_MSG "trtcm_rfc4115_aware_check"
+	struct rte_meter_trtcm_rfc4115_profile rp;
+	struct rte_meter_trtcm_rfc4115 rm;
+	uint64_t time;
+	uint64_t hz = rte_get_tsc_hz();
+	uint32_t pkt_len[4] = {
+		TM_TEST_RFC4115_CBS_DF - 1,
+		TM_TEST_RFC4115_CBS_DF + 1,
+		TM_TEST_RFC4115_EBS_DF - 1,
+		TM_TEST_RFC4115_EBS_DF + 1,
+	};
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		if (rte_meter_trtcm_rfc4115_profile_config(&rp, &rparams) != 0)
+			melog(RFC4115_AWARE_CHECK_MSG);
+		if (rte_meter_trtcm_rfc4115_config(&rm, &rp) != 0)
+			melog(RFC4115_AWARE_CHECK_MSG);
+		time = rte_get_tsc_cycles() + hz;
+		if (rte_meter_trtcm_rfc4115_color_aware_check(
+			&rm, &rp, time, pkt_len[i], in[i]) != out[i])
+			melog(RFC4115_AWARE_CHECK_MSG" %u:%u", in[i], out[i]);
+	}
+
+	return 0;
+}
+
+/**
+ * functional test for rte_meter_trtcm_rfc4115_color_aware_check
+ */
+static inline int
+tm_test_trtcm_rfc4115_color_aware_check(void)
+{
+	enum rte_meter_color in[4], out[4];
+
+	/* previously have a green, test points should keep unchanged */
+	in[0] = in[1] = in[2] = in[3] = e_RTE_METER_GREEN;
+	out[0] = e_RTE_METER_GREEN;
+	out[1] = e_RTE_METER_YELLOW;
+	out[2] = e_RTE_METER_YELLOW;
+	out[3] = e_RTE_METER_RED;
+	if (tm_test_trtcm_rfc4115_aware_check(in, out) != 0)
+		return -1;
+
+	in[0] = in[1] = in[2] = in[3] = e_RTE_METER_YELLOW;
+	out[0] = e_RTE_METER_YELLOW;
+	out[1] = e_RTE_METER_YELLOW;
+	out[2] = e_RTE_METER_YELLOW;
+	out[3] = e_RTE_METER_RED;
+	if (tm_test_trtcm_rfc4115_aware_check(in, out) != 0)
+		return -1;
+
+	in[0] = in[1] = in[2] = in[3] = e_RTE_METER_RED;
+	out[0] = e_RTE_METER_RED;
+	out[1] = e_RTE_METER_RED;
+	out[2] = e_RTE_METER_RED;
+	out[3] = e_RTE_METER_RED;
+	if (tm_test_trtcm_rfc4115_aware_check(in, out) != 0)
+		return -1;
+
+	return 0;
+}
+
+#define TM_TEST_BULK_N_METERS 16
+#define TM_TEST_BULK_N_PKTS 61
+#define TM_TEST_BULK_N_ROUNDS 64
+
+/* Burst shared by the bulk tests */
+static uint32_t bulk_meter_id[TM_TEST_BULK_N_PKTS];
+static uint32_t bulk_pkt_len[TM_TEST_BULK_N_PKTS];
+static enum rte_meter_color bulk_pkt_color[TM_TEST_BULK_N_PKTS];
+
+/**
+ * Generate a burst where about half of the 4 packet groups hit 4 different
+ * meters and the other half have at least two packets sharing a meter.
+ */
+static void
+tm_test_bulk_burst_gen(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < TM_TEST_BULK_N_PKTS; i++) {
+		if ((i / 4) & 1)
+			bulk_meter_id[i] = rte_rand() % 4;
+		else
+			bulk_meter_id[i] = (i % 4) * 4 + rte_rand() % 4;
+		bulk_pkt_len[i] = 64 + rte_rand() % 1455;
+		bulk_pkt_color[i] = rte_rand() % e_RTE_METER_COLORS;
+	}
+}
+
+/**
+ * Meter the same bursts with the single packet API on a copy of the meters
+ * and with the bulk API, then compare the colors and the meter states.
+ */
+#define TM_TEST_BULK(name, meter_type, profile_type, params, profile_config,\
+	config, blind_check, aware_check, bulk_check)			\
+static int								\
+tm_test_##name##_bulk(void)						\
+{									\
+	meter_type m[TM_TEST_BULK_N_METERS], m_ref[TM_TEST_BULK_N_METERS];\
+	profile_type p;							\
+	enum rte_meter_color color[TM_TEST_BULK_N_PKTS], color_ref;	\
+	uint64_t time, hz = rte_get_tsc_hz();				\
+	uint32_t i, j, aware;						\
+									\
+	if (profile_config(&p, &params) != 0)				\
+		melog(#name "_bulk");					\
+									\
+	for (aware = 0; aware < 2; aware++) {				\
+		for (i = 0; i < TM_TEST_BULK_N_METERS; i++)		\
+			if (config(&m[i], &p) != 0)			\
+				melog(#name "_bulk");			\
+		memcpy(m_ref, m, sizeof(m));				\
+		time = rte_get_tsc_cycles();				\
+									\
+		for (j = 0; j < TM_TEST_BULK_N_ROUNDS; j++) {		\
+			tm_test_bulk_burst_gen();			\
+			time += hz / 100000;				\
+									\
+			bulk_check(m, &p, time, bulk_meter_id,		\
+				bulk_pkt_len,				\
+				aware ? bulk_pkt_color : NULL,		\
+				color, TM_TEST_BULK_N_PKTS);		\
+									\
+			for (i = 0; i < TM_TEST_BULK_N_PKTS; i++) {	\
+				color_ref = aware ?			\
+					aware_check(&m_ref[bulk_meter_id[i]],\
+						&p, time, bulk_pkt_len[i],\
+						bulk_pkt_color[i]) :	\
+					blind_check(&m_ref[bulk_meter_id[i]],\
+						&p, time, bulk_pkt_len[i]);\
+				if (color[i] != color_ref)		\
+					melog(#name "_bulk round %u pkt %u",\
+						j, i);			\
+			}						\
+									\
+			if (memcmp(m, m_ref, sizeof(m)) != 0)		\
+				melog(#name "_bulk round %u state", j);	\
+		}							\
+	}								\
+									\
+	return 0;							\
+}
+
+TM_TEST_BULK(srtcm, struct rte_meter_srtcm,
+	struct rte_meter_srtcm_profile, sparams,
+	rte_meter_srtcm_profile_config, rte_meter_srtcm_config,
+	rte_meter_srtcm_color_blind_check, rte_meter_srtcm_color_aware_check,
+	rte_meter_srtcm_color_check_bulk)
+
+TM_TEST_BULK(trtcm, struct rte_meter_trtcm,
+	struct rte_meter_trtcm_profile, tparams,
+	rte_meter_trtcm_profile_config, rte_meter_trtcm_config,
+	rte_meter_trtcm_color_blind_check, rte_meter_trtcm_color_aware_check,
+	rte_meter_trtcm_color_check_bulk)
+
+TM_TEST_BULK(trtcm_rfc4115, struct rte_meter_trtcm_rfc4115,
+	struct rte_meter_trtcm_rfc4115_profile, rparams,
+	rte_meter_trtcm_rfc4115_profile_config, rte_meter_trtcm_rfc4115_config,
+	rte_meter_trtcm_rfc4115_color_blind_check,
+	rte_meter_trtcm_rfc4115_color_aware_check,
+	rte_meter_trtcm_rfc4115_color_check_bulk)
+
 /**
  * test main entrance for library meter
  */
@@ -485,20 +809,154 @@ test_meter(void)
 	if (tm_test_trtcm_config() != 0)
 		return -1;
 
+	if (tm_test_trtcm_rfc4115_config() != 0)
+		return -1;
+
 	if (tm_test_srtcm_color_blind_check() != 0)
 		return -1;
 
 	if (tm_test_trtcm_color_blind_check() != 0)
 		return -1;
 
+	if (tm_test_trtcm_rfc4115_color_blind_check() != 0)
+		return -1;
+
 	if (tm_test_srtcm_color_aware_check() != 0)
 		return -1;
 
 	if (tm_test_trtcm_color_aware_check() != 0)
 		return -1;
 
+	if (tm_test_trtcm_rfc4115_color_aware_check() != 0)
+		return -1;
+
+	if (tm_test_srtcm_bulk() != 0)
+		return -1;
+
+	if (tm_test_trtcm_bulk() != 0)
+		return -1;
+
+	if (tm_test_trtcm_rfc4115_bulk() != 0)
+		return -1;
+
 	return 0;
 
 }
 
 REGISTER_TEST_COMMAND(meter_autotest, test_meter);
+
+#define TM_PERF_N_METERS (1 << 16)
+#define TM_PERF_N_PKTS (1 << 20)
+#define TM_PERF_BURST 32
+
+/**
+ * Meter TM_PERF_N_PKTS packets spread over TM_PERF_N_METERS flows, in bursts
+ * of TM_PERF_BURST packets, once with the single packet API and once with the
+ * bulk API, and report the cycles spent per packet.
+ */
+#define TM_PERF(name, meter_type, profile_type, params, profile_config,	\
+	config, aware_check, bulk_check)				\
+static int								\
+tm_perf_##name(const uint32_t *meter_id, const uint32_t *pkt_len,	\
+	const enum rte_meter_color *pkt_color)				\
+{									\
+	meter_type *m;							\
+	profile_type p;							\
+	enum rte_meter_color color[TM_PERF_BURST];			\
+	uint64_t start, scalar, bulk, time;				\
+	uint32_t i, j;							\
+									\
+	m = rte_malloc(NULL, sizeof(*m) * TM_PERF_N_METERS,		\
+		RTE_CACHE_LINE_SIZE);					\
+	if (m == NULL)							\
+		melog(#name "_perf");					\
+	if (profile_config(&p, &params) != 0)				\
+		melog(#name "_perf");					\
+	for (i = 0; i < TM_PERF_N_METERS; i++)				\
+		config(&m[i], &p);					\
+									\
+	start = rte_rdtsc();						\
+	for (i = 0; i < TM_PERF_N_PKTS; i += TM_PERF_BURST) {		\
+		time = rte_rdtsc();					\
+		for (j = 0; j < TM_PERF_BURST; j++)			\
+			color[j] = aware_check(&m[meter_id[i + j]], &p,	\
+				time, pkt_len[i + j], pkt_color[i + j]);\
+	}								\
+	scalar = rte_rdtsc() - start;					\
+									\
+	start = rte_rdtsc();						\
+	for (i = 0; i < TM_PERF_N_PKTS; i += TM_PERF_BURST) {		\
+		time = rte_rdtsc();					\
+		bulk_check(m, &p, time, &meter_id[i], &pkt_len[i],	\
+			&pkt_color[i], color, TM_PERF_BURST);		\
+	}								\
+	bulk = rte_rdtsc() - start;					\
+									\
+	printf("%-14s %10.2f %10.2f cycles/pkt (last color %u)\n",	\
+		#name, (double)scalar / TM_PERF_N_PKTS,			\
+		(double)bulk / TM_PERF_N_PKTS, color[0]);		\
+									\
+	rte_free(m);							\
+	return 0;							\
+}
+
+TM_PERF(srtcm, struct rte_meter_srtcm, struct rte_meter_srtcm_profile,
+	sparams, rte_meter_srtcm_profile_config, rte_meter_srtcm_config,
+	rte_meter_srtcm_color_aware_check, rte_meter_srtcm_color_check_bulk)
+
+TM_PERF(trtcm, struct rte_meter_trtcm, struct rte_meter_trtcm_profile,
+	tparams, rte_meter_trtcm_profile_config, rte_meter_trtcm_config,
+	rte_meter_trtcm_color_aware_check, rte_meter_trtcm_color_check_bulk)
+
+TM_PERF(trtcm_rfc4115, struct rte_meter_trtcm_rfc4115,
+	struct rte_meter_trtcm_rfc4115_profile, rparams,
+	rte_meter_trtcm_rfc4115_profile_config, rte_meter_trtcm_rfc4115_config,
+	rte_meter_trtcm_rfc4115_color_aware_check,
+	rte_meter_trtcm_rfc4115_color_check_bulk)
+
+/**
+ * performance test entrance for library meter
+ */
+static int
+test_meter_perf(void)
+{
+	uint32_t *meter_id, *pkt_len;
+	enum rte_meter_color *pkt_color;
+	uint32_t i;
+	int ret = -1;
+
+	meter_id = rte_malloc(NULL, sizeof(*meter_id) * TM_PERF_N_PKTS, 0);
+	pkt_len = rte_malloc(NULL, sizeof(*pkt_len) * TM_PERF_N_PKTS, 0);
+	pkt_color = rte_malloc(NULL, sizeof(*pkt_color) * TM_PERF_N_PKTS, 0);
+	if ((meter_id == NULL) || (pkt_len == NULL) || (pkt_color == NULL)) {
+		mlog("meter_perf: out of memory");
+		goto exit;
+	}
+
+	for (i = 0; i < TM_PERF_N_PKTS; i++) {
+		meter_id[i] = rte_rand() % TM_PERF_N_METERS;
+		pkt_len[i] = 64 + rte_rand() % 1455;
+		pkt_color[i] = rte_rand() % e_RTE_METER_COLORS;
+	}
+
+	printf("%u flows, bursts of %u packets\n",
+		TM_PERF_N_METERS, TM_PERF_BURST);
+	printf("%-14s %10s %10s\n", "algorithm", "single", "bulk");
+
+	if (tm_perf_srtcm(meter_id, pkt_len, pkt_color) != 0)
+		goto exit;
+	if (tm_perf_trtcm(meter_id, pkt_len, pkt_color) != 0)
+		goto exit;
+	if (tm_perf_trtcm_rfc4115(meter_id, pkt_len, pkt_color) != 0)
+		goto exit;
+
+	ret = 0;
+
+exit:
+	rte_free(meter_id);
+	rte_free(pkt_len);
+	rte_free(pkt_color);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(meter_perf_autotest, test_meter_perf);
@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "test.h"
+
+#include <rte_pie.h>
+
+/*
+ * The queue is simulated the way the hierarchical scheduler drives PIE: the
+ * time base is the output port line rate in bytes per second, so the time
+ * advances by the length of each dequeued packet.
+ */
+#define TEST_PIE_TIME_HZ        1250000 /**< 10 Mbps line rate, in bytes/s */
+#define TEST_PIE_PKT_LEN        1000    /**< Bytes */
+#define TEST_PIE_QDELAY_REF     15      /**< ms */
+#define TEST_PIE_UPDATE_INTERVAL 15     /**< ms */
+#define TEST_PIE_MAX_BURST      150     /**< ms */
+#define TEST_PIE_QSIZE          4096    /**< Tail drop threshold (packets) */
+
+struct test_pie_queue {
+	struct rte_pie_config cfg;
+	struct rte_pie pie;
+	uint64_t time;
+	uint32_t qlen;
+	uint32_t n_enqueued;
+	uint32_t n_dropped;
+	uint64_t qdelay_sum;
+	uint32_t n_samples;
+};
+
+static int
+test_pie_queue_init(struct test_pie_queue *q)
+{
+	struct rte_pie_params params = {
+		.qdelay_ref = TEST_PIE_QDELAY_REF,
+		.dp_update_interval = TEST_PIE_UPDATE_INTERVAL,
+		.max_burst = TEST_PIE_MAX_BURST,
+	};
+
+	memset(q, 0, sizeof(*q));
+
+	if (rte_pie_config_init(&q->cfg, &params, TEST_PIE_TIME_HZ) != 0)
+		return -1;
+
+	return rte_pie_rt_data_init(&q->pie);
+}
+
+static void
+test_pie_queue_stats_reset(struct test_pie_queue *q)
+{
+	q->n_enqueued = 0;
+	q->n_dropped = 0;
+	q->qdelay_sum = 0;
+	q->n_samples = 0;
+}
+
+/*
+ * Run the queue for n_slots packet transmission times, with n_arrivals
+ * packets arriving in each of them.
+ */
+static void
+test_pie_queue_run(struct test_pie_queue *q, uint32_t n_slots,
+	uint32_t n_arrivals)
+{
+	uint32_t i, j;
+
+	for (i = 0; i < n_slots; i++) {
+		for (j = 0; j < n_arrivals; j++) {
+			if ((q->qlen >= TEST_PIE_QSIZE) ||
+				rte_pie_enqueue(&q->cfg, &q->pie, q->qlen,
+					TEST_PIE_PKT_LEN, q->time)) {
+				q->n_dropped++;
+				continue;
+			}
+
+			q->qlen++;
+			q->n_enqueued++;
+		}
+
+		q->qdelay_sum += (uint64_t)q->qlen * TEST_PIE_PKT_LEN;
+		q->n_samples++;
+
+		if (q->qlen == 0) {
+			/* Idle link */
+			q->time += TEST_PIE_PKT_LEN;
+			continue;
+		}
+
+		q->time += TEST_PIE_PKT_LEN;
+		rte_pie_dequeue(&q->pie, TEST_PIE_PKT_LEN, q->time);
+		q->qlen--;
+	}
+}
+
+static uint32_t
+test_pie_ms_to_slots(uint32_t ms)
+{
+	return (uint32_t)(((uint64_t)TEST_PIE_TIME_HZ * ms) /
+		(1000 * TEST_PIE_PKT_LEN));
+}
+
+static int
+test_pie_invalid_parameters(void)
+{
+	struct rte_pie_config cfg;
+	struct rte_pie_params params = {
+		.qdelay_ref = TEST_PIE_QDELAY_REF,
+		.dp_update_interval = TEST_PIE_UPDATE_INTERVAL,
+		.max_burst = TEST_PIE_MAX_BURST,
+	};
+	struct rte_pie_params p;
+
+	TEST_ASSERT(rte_pie_rt_data_init(NULL) != 0,
+		"NULL run-time data accepted");
+	TEST_ASSERT(rte_pie_config_init(NULL, &params, TEST_PIE_TIME_HZ) != 0,
+		"NULL config accepted");
+	TEST_ASSERT(rte_pie_config_init(&cfg, NULL, TEST_PIE_TIME_HZ) != 0,
+		"NULL parameters accepted");
+	TEST_ASSERT(rte_pie_config_init(&cfg, &params, 0) != 0,
+		"Zero time frequency accepted");
+
+	p = params;
+	p.qdelay_ref = 0;
+	TEST_ASSERT(rte_pie_config_init(&cfg, &p, TEST_PIE_TIME_HZ) != 0,
+		"Zero qdelay_ref accepted");
+
+	p = params;
+	p.dp_update_interval = 0;
+	TEST_ASSERT(rte_pie_config_init(&cfg, &p, TEST_PIE_TIME_HZ) != 0,
+		"Zero dp_update_interval accepted");
+
+	p = params;
+	p.max_burst = 0;
+	TEST_ASSERT(rte_pie_config_init(&cfg, &p, TEST_PIE_TIME_HZ) != 0,
+		"Zero max_burst accepted");
+
+	TEST_ASSERT_SUCCESS(rte_pie_config_init(&cfg, &params,
+		TEST_PIE_TIME_HZ), "Valid parameters rejected");
+	TEST_ASSERT_EQUAL(cfg.qdelay_ref,
+		(uint64_t)TEST_PIE_TIME_HZ * TEST_PIE_QDELAY_REF / 1000,
+		"Wrong qdelay_ref conversion");
+
+	return 0;
+}
+
+/* A standing queue below the target delay is never subject to PIE drops */
+static int
+test_pie_below_target(void)
+{
+	struct test_pie_queue q;
+
+	TEST_ASSERT_SUCCESS(test_pie_queue_init(&q), "PIE init failed");
+
+	/* Build a standing queue of 17 packets, i.e. 13.6 ms of delay, long
+	 * enough for the dequeue rate to be measured, then run at line rate
+	 * for 5 s
+	 */
+	test_pie_queue_run(&q, 17, 2);
+	test_pie_queue_run(&q, test_pie_ms_to_slots(5000), 1);
+
+	TEST_ASSERT_EQUAL(q.n_dropped, 0, "%u packets dropped", q.n_dropped);
+	TEST_ASSERT(q.pie.drop_prob == 0, "Drop probability %f",
+		q.pie.drop_prob);
+	TEST_ASSERT(q.pie.avg_dq_time != 0, "Dequeue rate not measured");
+
+	return 0;
+}
+
+/*
+ * An overloaded queue is allowed a burst of max_burst, then gets its delay
+ * controlled around the target by dropping the excess traffic. Once the
+ * overload is gone, the drop probability decays back to zero.
+ */
+static int
+test_pie_overload(void)
+{
+	struct test_pie_queue q;
+	double drop_rate, qdelay, qdelay_ref;
+
+	TEST_ASSERT_SUCCESS(test_pie_queue_init(&q), "PIE init failed");
+
+	/* Twice the line rate: no drop during the burst allowance */
+	test_pie_queue_run(&q, test_pie_ms_to_slots(TEST_PIE_MAX_BURST / 2), 2);
+	TEST_ASSERT_EQUAL(q.n_dropped, 0,
+		"%u packets dropped within the burst allowance", q.n_dropped);
+
+	/* Let the controller converge, then measure */
+	test_pie_queue_run(&q, test_pie_ms_to_slots(10000), 2);
+	test_pie_queue_stats_reset(&q);
+	test_pie_queue_run(&q, test_pie_ms_to_slots(10000), 2);
+
+	drop_rate = (double)q.n_dropped / (q.n_dropped + q.n_enqueued);
+	qdelay = (double)q.qdelay_sum / q.n_samples;
+	qdelay_ref = (double)q.cfg.qdelay_ref;
+
+	printf("Overload: drop rate %.3f, drop probability %.3f, "
+		"queue delay %.1f ms (target %u ms)\n",
+		drop_rate, q.pie.drop_prob,
+		qdelay * 1000 / TEST_PIE_TIME_HZ, TEST_PIE_QDELAY_REF);
+
+	TEST_ASSERT((drop_rate > 0.4) && (drop_rate < 0.6),
+		"Drop rate %f, expected 0.5", drop_rate);
+	TEST_ASSERT((qdelay > qdelay_ref / 4) && (qdelay < qdelay_ref * 3),
+		"Queue delay %f, target %f", qdelay, qdelay_ref);
+	TEST_ASSERT(q.qlen < TEST_PIE_QSIZE, "Queue reached the tail drop");
+
+	/* Drain the queue, then run at the line rate */
+	test_pie_queue_run(&q, test_pie_ms_to_slots(10000), 0);
+	test_pie_queue_stats_reset(&q);
+	test_pie_queue_run(&q, test_pie_ms_to_slots(10000), 1);
+
+	TEST_ASSERT(q.pie.drop_prob < 0.01,
+		"Drop probability %f after the overload", q.pie.drop_prob);
+
+	return 0;
+}
+
+static int
+test_pie(void)
+{
+	if (test_pie_invalid_parameters() < 0)
+		return -1;
+	if (test_pie_below_target() < 0)
+		return -1;
+	if (test_pie_overload() < 0)
+		return -1;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(pie_autotest, test_pie);
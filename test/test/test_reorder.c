@@ -9,6 +9,8 @@
 #include <rte_cycles.h>
 #include <rte_errno.h>
 #include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+#include <rte_pause.h>
 #include <rte_reorder.h>
 #include <rte_lcore.h>
 #include <rte_malloc.h>
@@ -268,8 +270,10 @@ test_reorder_drain(void)
 		ret = -1;
 		goto exit;
 	}
-	if (robufs[0] != NULL)
-		rte_pktmbuf_free(robufs[i]);
+	if (robufs[0] != NULL) {
+		rte_pktmbuf_free(robufs[0]);
+		robufs[0] = NULL;
+	}
 
 	/* Insert more packets
 	 * RB[] = {NULL, NULL, NULL, NULL}
@@ -303,8 +307,10 @@ test_reorder_drain(void)
 		goto exit;
 	}
 	for (i = 0; i < 3; i++) {
-		if (robufs[i] != NULL)
+		if (robufs[i] != NULL) {
 			rte_pktmbuf_free(robufs[i]);
+			robufs[i] = NULL;
+		}
 	}
 
 	/*
@@ -330,6 +336,247 @@ test_reorder_drain(void)
 	return ret;
 }
 
+static int
+test_reorder_seqn_offset(void)
+{
+	static const struct rte_mbuf_dynfield seqn_desc = {
+		.name = "test_reorder_seqn",
+		.size = sizeof(uint32_t),
+		.align = __alignof__(uint32_t),
+	};
+
+	return rte_mbuf_dynfield_register(&seqn_desc);
+}
+
+static inline void
+test_reorder_set_seqn(struct rte_mbuf *m, int offset, uint32_t seqn)
+{
+	*RTE_MBUF_DYNFIELD(m, offset, uint32_t *) = seqn;
+}
+
+static int
+test_reorder_mp_insert_drain(void)
+{
+	struct rte_reorder_params params = {
+		.name = "test_mp",
+		.socket_id = rte_socket_id(),
+		.size = 8,
+		.flags = RTE_REORDER_F_MP_INSERT,
+	};
+	/* start right before the sequence number wraps */
+	const uint32_t start = UINT32_MAX - 2;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int num_bufs = 8;
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	struct rte_reorder_stats stats;
+	struct rte_reorder_buffer *b;
+	static const uint32_t order[] = { 0, 3, 1, 2 };
+	unsigned int i, cnt;
+	int offset, ret;
+
+	offset = test_reorder_seqn_offset();
+	TEST_ASSERT(offset >= 0, "Failed to register sequence number field");
+	params.seqn_offset = offset;
+
+	b = rte_reorder_create_with_params(&params);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(p);
+		TEST_ASSERT_NOT_NULL(bufs[i], "Packet allocation failed\n");
+		test_reorder_set_seqn(bufs[i], offset, start + i);
+	}
+
+	/* the first packet sets the window start, the others come out of
+	 * order across the wrap and are drained in order
+	 */
+	for (i = 0; i < RTE_DIM(order); i++) {
+		ret = rte_reorder_insert(b, bufs[order[i]]);
+		TEST_ASSERT_SUCCESS(ret, "Error inserting packet %u", order[i]);
+	}
+	cnt = rte_reorder_drain(b, robufs, num_bufs);
+	TEST_ASSERT_EQUAL(cnt, 4, "Drained %u packets instead of 4", cnt);
+	for (i = 0; i < cnt; i++)
+		TEST_ASSERT_EQUAL(robufs[i], bufs[i],
+				"Packet %u drained out of order", i);
+
+	/* duplicate sequence number */
+	TEST_ASSERT_SUCCESS(rte_reorder_insert(b, bufs[5]),
+			"Error inserting packet 5");
+	test_reorder_set_seqn(bufs[6], offset, start + 5);
+	ret = rte_reorder_insert(b, bufs[6]);
+	TEST_ASSERT(ret == -1 && rte_errno == EEXIST,
+			"No error inserting duplicate packet");
+
+	/* seqn 4 is missing: nothing to drain until an early packet */
+	cnt = rte_reorder_drain(b, robufs, num_bufs);
+	TEST_ASSERT_EQUAL(cnt, 0, "Drained %u packets past a gap", cnt);
+
+	test_reorder_set_seqn(bufs[6], offset, start + 4 + params.size);
+	ret = rte_reorder_insert(b, bufs[6]);
+	TEST_ASSERT(ret == -1 && rte_errno == ENOSPC,
+			"No error inserting early packet");
+
+	cnt = rte_reorder_drain(b, robufs, num_bufs);
+	TEST_ASSERT_EQUAL(cnt, 1, "Drained %u packets instead of 1", cnt);
+	TEST_ASSERT_EQUAL(robufs[0], bufs[5], "Wrong packet drained");
+
+	/* the window moved past seqn 4 */
+	ret = rte_reorder_insert(b, bufs[4]);
+	TEST_ASSERT(ret == -1 && rte_errno == ERANGE,
+			"No error inserting late packet");
+
+	TEST_ASSERT_SUCCESS(rte_reorder_stats_get(b, &stats),
+			"Error getting stats");
+	TEST_ASSERT_EQUAL(stats.late, 1, "Late count %"PRIu64" not 1",
+			stats.late);
+	TEST_ASSERT_EQUAL(stats.dropped, 1, "Dropped count %"PRIu64" not 1",
+			stats.dropped);
+
+	/* a producer that stalled while the window moved a full size past
+	 * its seqn left a packet in the slot of seqn 6: it is drained as
+	 * late and the window stays at seqn 6
+	 */
+	test_reorder_set_seqn(bufs[4], offset, start + 6);
+	TEST_ASSERT_SUCCESS(rte_reorder_insert(b, bufs[4]),
+			"Error inserting packet 6");
+	test_reorder_set_seqn(bufs[4], offset, start + 6 - params.size);
+	cnt = rte_reorder_drain(b, robufs, num_bufs);
+	TEST_ASSERT_EQUAL(cnt, 1, "Drained %u packets instead of 1", cnt);
+	TEST_ASSERT_EQUAL(robufs[0], bufs[4], "Wrong packet drained");
+
+	TEST_ASSERT_SUCCESS(rte_reorder_stats_get(b, &stats),
+			"Error getting stats");
+	TEST_ASSERT_EQUAL(stats.late, 2, "Late count %"PRIu64" not 2",
+			stats.late);
+
+	test_reorder_set_seqn(bufs[7], offset, start + 6);
+	TEST_ASSERT_SUCCESS(rte_reorder_insert(b, bufs[7]),
+			"Stale packet moved the window");
+	cnt = rte_reorder_drain(b, robufs, num_bufs);
+	TEST_ASSERT_EQUAL(cnt, 1, "Drained %u packets instead of 1", cnt);
+	TEST_ASSERT_EQUAL(robufs[0], bufs[7], "Packet 6 not drained in order");
+
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++)
+		rte_pktmbuf_free(bufs[i]);
+
+	return 0;
+}
+
+#define MP_NUM_PKTS 8192
+
+static struct rte_reorder_buffer *mp_buffer;
+static struct rte_mbuf *mp_bufs[MP_NUM_PKTS];
+static volatile unsigned int mp_worker_idx;
+static volatile int mp_worker_failed;
+static unsigned int mp_num_workers;
+
+/* Each worker inserts the packets whose seqn is its index modulo workers */
+static int
+test_reorder_mp_worker(void *arg __rte_unused)
+{
+	unsigned int id = __sync_fetch_and_add(&mp_worker_idx, 1);
+	unsigned int i;
+
+	for (i = id; i < MP_NUM_PKTS; i += mp_num_workers) {
+		if (rte_reorder_insert(mp_buffer, mp_bufs[i]) != 0) {
+			printf("Worker %u failed to insert packet %u: %s\n",
+					id, i, rte_strerror(rte_errno));
+			mp_worker_failed = 1;
+			/* the packets left out are never drained */
+			for (; i < MP_NUM_PKTS; i += mp_num_workers)
+				rte_pktmbuf_free(mp_bufs[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+test_reorder_mp_concurrent(void)
+{
+	struct rte_reorder_params params = {
+		.name = "test_mp_concurrent",
+		.socket_id = rte_socket_id(),
+		.size = REORDER_BUFFER_SIZE,
+		.flags = RTE_REORDER_F_MP_INSERT,
+		.seqn_offset = -1,
+	};
+	struct rte_mempool *p = test_params->p;
+	struct rte_mbuf *robufs[BURST];
+	struct rte_reorder_stats stats;
+	unsigned int i, cnt, drained = 0;
+	unsigned int lcore_id;
+	uint64_t deadline;
+	int ret = 0;
+
+	if (rte_lcore_count() < 3) {
+		printf("Not enough cores for concurrent insert test\n");
+		return -ENOTSUP;
+	}
+
+	mp_buffer = rte_reorder_create_with_params(&params);
+	TEST_ASSERT_NOT_NULL(mp_buffer, "Failed to create reorder buffer");
+
+	TEST_ASSERT_SUCCESS(rte_mempool_get_bulk(p, (void *)mp_bufs,
+			MP_NUM_PKTS), "Packet allocation failed");
+	for (i = 0; i < MP_NUM_PKTS; i++)
+		mp_bufs[i]->seqn = i;
+
+	/* the first inserted packet sets the start of the sequence */
+	TEST_ASSERT_SUCCESS(rte_reorder_insert(mp_buffer, mp_bufs[0]),
+			"Error inserting first packet");
+
+	mp_worker_idx = 1;
+	mp_worker_failed = 0;
+	mp_num_workers = rte_lcore_count() - 1;
+	rte_eal_mp_remote_launch(test_reorder_mp_worker, NULL, SKIP_MASTER);
+
+	/* Drained packets go back to the pool as they come out, the ones
+	 * still held by the buffer on failure are freed with it
+	 */
+	deadline = rte_get_timer_cycles() + 10 * rte_get_timer_hz();
+	while (drained < MP_NUM_PKTS) {
+		cnt = rte_reorder_drain(mp_buffer, robufs, BURST);
+		for (i = 0; i < cnt; i++) {
+			if (robufs[i]->seqn != drained + i && ret == 0) {
+				printf("Packet %u drained at %u\n",
+						robufs[i]->seqn, drained + i);
+				ret = -1;
+			}
+			rte_pktmbuf_free(robufs[i]);
+		}
+		drained += cnt;
+		if (cnt != 0)
+			continue;
+		if (mp_worker_failed) {
+			ret = -1;
+			break;
+		}
+		if (rte_get_timer_cycles() > deadline) {
+			printf("Timed out with %u packets drained\n", drained);
+			ret = -1;
+			break;
+		}
+		rte_pause();
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) != 0)
+			ret = -1;
+
+	rte_reorder_stats_get(mp_buffer, &stats);
+	if (stats.late != 0 || stats.dropped != 0)
+		ret = -1;
+
+	rte_reorder_free(mp_buffer);
+
+	return ret;
+}
+
 static int
 test_setup(void)
 {
@@ -380,6 +627,8 @@ static struct unit_test_suite reorder_test_suite  = {
 		TEST_CASE(test_reorder_free),
 		TEST_CASE(test_reorder_insert),
 		TEST_CASE(test_reorder_drain),
+		TEST_CASE(test_reorder_mp_insert_drain),
+		TEST_CASE(test_reorder_mp_concurrent),
 		TEST_CASES_END()
 	}
 };
@@ -14,6 +14,8 @@
 #include <rte_ether.h>
 #include <rte_ip.h>
 #include <rte_byteorder.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
 #include <rte_sched.h>
 
 
@@ -103,6 +105,348 @@ prepare_pkt(struct rte_mbuf *mbuf)
 }
 
 
+#define SHARDS_N_SUBPORTS   4
+#define SHARDS_N_PIPES      64
+#define SHARDS_N_PKTS       8
+
+/* Each dequeue shard only returns the packets of its own subports */
+static int
+test_sched_shards(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[SHARDS_N_PKTS];
+	struct rte_mbuf *out_mbufs[SHARDS_N_PKTS];
+	uint32_t subport, pipe, tc, queue, shard;
+	int err, i;
+
+	params.name = "test_sched_shards";
+	params.n_subports_per_port = SHARDS_N_SUBPORTS;
+	params.n_pipes_per_subport = SHARDS_N_PIPES;
+
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	for (subport = 0; subport < SHARDS_N_SUBPORTS; subport++) {
+		err = rte_sched_subport_config(port, subport, subport_param);
+		TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+		for (pipe = 0; pipe < SHARDS_N_PIPES; pipe++) {
+			err = rte_sched_pipe_config(port, subport, pipe, 0);
+			TEST_ASSERT_SUCCESS(err,
+				"Error config sched pipe %u, err=%d\n",
+				pipe, err);
+		}
+	}
+
+	err = rte_sched_port_shard_dequeue(port, 0, out_mbufs, SHARDS_N_PKTS);
+	TEST_ASSERT_EQUAL(err, -EINVAL, "Unsharded port dequeued, err=%d\n",
+			  err);
+
+	err = rte_sched_port_shards_config(port, 3);
+	TEST_ASSERT_FAIL(err, "Non power of 2 shard count accepted\n");
+	err = rte_sched_port_shards_config(port, 2 * SHARDS_N_SUBPORTS);
+	TEST_ASSERT_FAIL(err, "More shards than subports accepted\n");
+	err = rte_sched_port_shards_config(port, 2);
+	TEST_ASSERT_SUCCESS(err, "Error config shards, err=%d\n", err);
+	err = rte_sched_port_shards_config(port, 2);
+	TEST_ASSERT_FAIL(err, "Port sharded twice\n");
+
+	/* Two packets per subport */
+	for (i = 0; i < SHARDS_N_PKTS; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		rte_sched_port_pkt_write(in_mbufs[i], i % SHARDS_N_SUBPORTS,
+			PIPE, TC, QUEUE, e_RTE_METER_GREEN);
+		in_mbufs[i]->pkt_len = 60;
+		in_mbufs[i]->data_len = 60;
+	}
+
+	err = rte_sched_port_enqueue(port, in_mbufs, SHARDS_N_PKTS);
+	TEST_ASSERT_EQUAL(err, SHARDS_N_PKTS, "Wrong enqueue, err=%d\n", err);
+
+	for (shard = 0; shard < 2; shard++) {
+		err = rte_sched_port_shard_dequeue(port, shard, out_mbufs,
+						   SHARDS_N_PKTS);
+		TEST_ASSERT_EQUAL(err, SHARDS_N_PKTS / 2,
+			"Wrong dequeue from shard %u, err=%d\n", shard, err);
+
+		for (i = 0; i < err; i++) {
+			rte_sched_port_pkt_read_tree_path(out_mbufs[i],
+				&subport, &pipe, &tc, &queue);
+			TEST_ASSERT_EQUAL(subport / (SHARDS_N_SUBPORTS / 2),
+				shard, "Subport %u dequeued from shard %u\n",
+				subport, shard);
+			rte_pktmbuf_free(out_mbufs[i]);
+		}
+	}
+
+	err = rte_sched_port_shard_dequeue(port, 0, out_mbufs, SHARDS_N_PKTS);
+	TEST_ASSERT_EQUAL(err, 0, "Wrong dequeue, err=%d\n", err);
+	err = rte_sched_port_shard_dequeue(port, 2, out_mbufs, SHARDS_N_PKTS);
+	TEST_ASSERT_EQUAL(err, -EINVAL, "Invalid shard dequeued, err=%d\n",
+			  err);
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+#define SHAPE_N_TCS        13
+#define SHAPE_TC_BE        (SHAPE_N_TCS - 1)
+
+/* 12 strict priority TCs of one queue, plus a best effort TC of 4 queues */
+static int
+test_sched_pipe_shape(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_subport_params subport_params = subport_param[0];
+	struct rte_sched_pipe_params pipe_params = pipe_profile[0];
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[SHAPE_N_TCS];
+	struct rte_mbuf *out_mbufs[SHAPE_N_TCS];
+	uint32_t footprint_default, footprint, queue_id;
+	uint32_t subport, pipe, tc, queue, prev_tc;
+	int err, i;
+
+	params.name = "test_sched_pipe_shape";
+	params.n_pipes_per_subport = 64;
+
+	/* Invalid shapes */
+	params.n_queues_per_tc[0] = 3;
+	TEST_ASSERT_NULL(rte_sched_port_config(&params),
+			 "TC with 3 queues accepted\n");
+	for (i = 0; i < 5; i++)
+		params.n_queues_per_tc[i] = 4;
+	TEST_ASSERT_NULL(rte_sched_port_config(&params),
+			 "Pipe with 20 queues accepted\n");
+
+	/* 4 strict priority queues take less than half the default memory */
+	memset(params.n_queues_per_tc, 0, sizeof(params.n_queues_per_tc));
+	footprint_default = rte_sched_port_get_memory_footprint(&params);
+	for (i = 0; i < 4; i++)
+		params.n_queues_per_tc[i] = 1;
+	footprint = rte_sched_port_get_memory_footprint(&params);
+	TEST_ASSERT(footprint != 0 && footprint < footprint_default / 2,
+		    "Wrong footprint %u, default %u\n",
+		    footprint, footprint_default);
+
+	for (i = 0; i < SHAPE_N_TCS; i++) {
+		params.n_queues_per_tc[i] = (i == SHAPE_TC_BE) ? 4 : 1;
+		params.qsize[i] = 32;
+		subport_params.tc_rate[i] = subport_params.tc_rate[0];
+		pipe_params.tc_rate[i] = pipe_params.tc_rate[0];
+	}
+	params.pipe_profiles = &pipe_params;
+
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	err = rte_sched_subport_config(port, SUBPORT, &subport_params);
+	TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+	for (pipe = 0; pipe < params.n_pipes_per_subport; pipe++) {
+		err = rte_sched_pipe_config(port, SUBPORT, pipe, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n",
+				    pipe, err);
+	}
+
+	/* 16 queues per pipe, the best effort ones last */
+	err = rte_sched_port_queue_id(port, SUBPORT, PIPE, SHAPE_TC_BE, 3,
+				      &queue_id);
+	TEST_ASSERT_SUCCESS(err, "Error getting queue ID, err=%d\n", err);
+	TEST_ASSERT_EQUAL(queue_id, PIPE * 16 + 15, "Wrong queue ID %u\n",
+			  queue_id);
+	err = rte_sched_port_queue_id(port, SUBPORT, PIPE, 0, 1, &queue_id);
+	TEST_ASSERT_FAIL(err, "Queue 1 of a single queue TC accepted\n");
+	err = rte_sched_port_queue_id(port, SUBPORT, PIPE, SHAPE_N_TCS, 0,
+				      &queue_id);
+	TEST_ASSERT_FAIL(err, "Out of shape TC accepted\n");
+
+	/* Lowest priority first */
+	for (i = 0; i < SHAPE_N_TCS; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		rte_sched_port_pkt_write(in_mbufs[i], SUBPORT, PIPE,
+			SHAPE_TC_BE - i, i % 4, e_RTE_METER_GREEN);
+		in_mbufs[i]->pkt_len = 60;
+		in_mbufs[i]->data_len = 60;
+	}
+
+	err = rte_sched_port_enqueue(port, in_mbufs, SHAPE_N_TCS);
+	TEST_ASSERT_EQUAL(err, SHAPE_N_TCS, "Wrong enqueue, err=%d\n", err);
+
+	err = rte_sched_port_dequeue(port, out_mbufs, SHAPE_N_TCS);
+	TEST_ASSERT_EQUAL(err, SHAPE_N_TCS, "Wrong dequeue, err=%d\n", err);
+
+	/* Strict priority order */
+	for (i = 0, prev_tc = 0; i < SHAPE_N_TCS; i++) {
+		rte_sched_port_pkt_read_tree_path(out_mbufs[i],
+			&subport, &pipe, &tc, &queue);
+		TEST_ASSERT(tc >= prev_tc, "TC %u dequeued after TC %u\n",
+			    tc, prev_tc);
+		TEST_ASSERT_EQUAL(pipe, PIPE, "Wrong pipe\n");
+		prev_tc = tc;
+		rte_pktmbuf_free(out_mbufs[i]);
+	}
+	TEST_ASSERT_EQUAL(prev_tc, SHAPE_TC_BE, "Wrong last TC %u\n", prev_tc);
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+#define PIPES_N_PIPES        64
+#define PIPES_N_PROFILES     300
+
+static void
+pipes_pkt_write(struct rte_mbuf *mbuf, uint32_t subport, uint32_t pipe)
+{
+	rte_sched_port_pkt_write(mbuf, subport, pipe, TC, QUEUE,
+				 e_RTE_METER_GREEN);
+	mbuf->pkt_len = 60;
+	mbuf->data_len = 60;
+}
+
+/* Subports resized and given new pipe profiles at run-time */
+static int
+test_sched_subport_pipes(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_subport_pipes_params pipes_params;
+	struct rte_sched_pipe_params profiles[2];
+	struct rte_sched_queue_stats stats;
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[5];
+	struct rte_mbuf *out_mbufs[5];
+	uint32_t subport, pipe, tc, queue, queue_id, profile_id, i;
+	uint16_t qlen;
+	int err;
+
+	params.name = "test_sched_subport_pipes";
+	params.n_subports_per_port = 2;
+	params.n_pipes_per_subport = PIPES_N_PIPES;
+	params.n_max_pipe_profiles = PIPES_N_PROFILES;
+
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	/* More profiles than RTE_SCHED_PIPE_PROFILES_PER_PORT */
+	profiles[0] = pipe_profile[0];
+	for (i = 1; i < PIPES_N_PROFILES; i++) {
+		profiles[0].tb_size = pipe_profile[0].tb_size + i;
+		err = rte_sched_port_pipe_profile_add(port, &profiles[0],
+						      &profile_id);
+		TEST_ASSERT_SUCCESS(err, "Error adding profile %u, err=%d\n",
+				    i, err);
+		TEST_ASSERT_EQUAL(profile_id, i, "Wrong profile ID %u\n",
+				  profile_id);
+	}
+	profiles[0].tb_size++;
+	err = rte_sched_port_pipe_profile_add(port, &profiles[0], &profile_id);
+	TEST_ASSERT_FAIL(err, "Profile added to a full table\n");
+
+	err = rte_sched_subport_config(port, 0, subport_param);
+	TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+	for (pipe = 0; pipe < PIPES_N_PIPES; pipe++) {
+		err = rte_sched_pipe_config(port, 0, pipe,
+					    PIPES_N_PROFILES - 1);
+		TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n",
+				    pipe, err);
+	}
+
+	/* Subport 1 is not configured, its packet is dropped */
+	for (i = 0; i < RTE_DIM(in_mbufs); i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+	}
+	pipes_pkt_write(in_mbufs[0], 0, 5);
+	pipes_pkt_write(in_mbufs[1], 0, 5);
+	pipes_pkt_write(in_mbufs[2], 0, 40);
+	pipes_pkt_write(in_mbufs[3], 0, 40);
+	pipes_pkt_write(in_mbufs[4], 1, 5);
+
+	err = rte_sched_port_enqueue(port, in_mbufs, RTE_DIM(in_mbufs));
+	TEST_ASSERT_EQUAL(err, 4, "Wrong enqueue, err=%d\n", err);
+
+	/* Replace the table of subport 0 and remove its pipes from 32 */
+	profiles[0] = pipe_profile[0];
+	profiles[1] = pipe_profile[0];
+	profiles[1].tb_size *= 2;
+
+	pipes_params.n_pipes = PIPES_N_PIPES / 2;
+	pipes_params.pipe_profiles = profiles;
+	pipes_params.n_pipe_profiles = RTE_DIM(profiles);
+	err = rte_sched_subport_pipes_config(port, 0, &pipes_params);
+	TEST_ASSERT_FAIL(err, "Pipes kept without their profile\n");
+
+	for (pipe = 0; pipe < PIPES_N_PIPES; pipe++) {
+		err = rte_sched_pipe_config(port, 0, pipe, pipe % 2);
+		TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n",
+				    pipe, err);
+	}
+
+	err = rte_sched_subport_pipes_config(port, 0, &pipes_params);
+	TEST_ASSERT_SUCCESS(err, "Error config subport pipes, err=%d\n", err);
+
+	err = rte_sched_pipe_config(port, 0, 40, 0);
+	TEST_ASSERT_FAIL(err, "Removed pipe configured\n");
+	err = rte_sched_pipe_config(port, 0, 5, RTE_DIM(profiles));
+	TEST_ASSERT_FAIL(err, "Pipe configured with a removed profile\n");
+
+	err = rte_sched_port_queue_id(port, 0, 40, TC, QUEUE, &queue_id);
+	TEST_ASSERT_SUCCESS(err, "Error getting queue ID, err=%d\n", err);
+	err = rte_sched_queue_read_stats(port, queue_id, &stats, &qlen);
+	TEST_ASSERT_FAIL(err, "Stats read from a removed queue\n");
+
+	/* Only the packets of pipe 5 are left */
+	err = rte_sched_port_dequeue(port, out_mbufs, RTE_DIM(out_mbufs));
+	TEST_ASSERT_EQUAL(err, 2, "Wrong dequeue, err=%d\n", err);
+
+	for (i = 0; i < 2; i++) {
+		rte_sched_port_pkt_read_tree_path(out_mbufs[i],
+			&subport, &pipe, &tc, &queue);
+		TEST_ASSERT_EQUAL(pipe, 5, "Wrong pipe %u\n", pipe);
+		rte_pktmbuf_free(out_mbufs[i]);
+	}
+
+	/* Grow the subport back, keeping its table */
+	pipes_params.n_pipes = PIPES_N_PIPES;
+	pipes_params.pipe_profiles = NULL;
+	err = rte_sched_subport_pipes_config(port, 0, &pipes_params);
+	TEST_ASSERT_SUCCESS(err, "Error config subport pipes, err=%d\n", err);
+
+	err = rte_sched_pipe_config(port, 0, 40, 1);
+	TEST_ASSERT_SUCCESS(err, "Error config sched pipe, err=%d\n", err);
+
+	/* Subport 1 added with the port table */
+	err = rte_sched_subport_config(port, 1, subport_param);
+	TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+	err = rte_sched_pipe_config(port, 1, 5, PIPES_N_PROFILES - 1);
+	TEST_ASSERT_SUCCESS(err, "Error config sched pipe, err=%d\n", err);
+
+	for (i = 0; i < 2; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+	}
+	pipes_pkt_write(in_mbufs[0], 0, 40);
+	pipes_pkt_write(in_mbufs[1], 1, 5);
+
+	err = rte_sched_port_enqueue(port, in_mbufs, 2);
+	TEST_ASSERT_EQUAL(err, 2, "Wrong enqueue, err=%d\n", err);
+
+	err = rte_sched_port_dequeue(port, out_mbufs, RTE_DIM(out_mbufs));
+	TEST_ASSERT_EQUAL(err, 2, "Wrong dequeue, err=%d\n", err);
+
+	for (i = 0; i < 2; i++)
+		rte_pktmbuf_free(out_mbufs[i]);
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
 /**
  * test main entrance for library sched
  */
@@ -181,7 +525,271 @@ test_sched(void)
 
 	rte_sched_port_free(port);
 
-	return 0;
+	err = test_sched_shards(mp);
+	if (err != 0)
+		return err;
+
+	err = test_sched_pipe_shape(mp);
+	if (err != 0)
+		return err;
+
+	return test_sched_subport_pipes(mp);
 }
 
 REGISTER_TEST_COMMAND(sched_autotest, test_sched);
+
+/*
+ * Multi-core throughput benchmark: the master lcore enqueues into the port,
+ * while each dequeue shard of the port is drained by its own slave lcore.
+ */
+#define PERF_N_SUBPORTS      8U
+#define PERF_N_PIPES         256U
+#define PERF_QSIZE           64
+#define PERF_NB_MBUF         8191
+#define PERF_MEMPOOL_CACHE   256
+#define PERF_BURST           32
+#define PERF_DURATION_MS     200
+
+/* 25 Gbps, so that the credits do not limit the dequeue rate */
+#define PERF_RATE            3125000000U
+
+static struct rte_sched_subport_params perf_subport_param = {
+	.tb_rate = PERF_RATE,
+	.tb_size = 1000000,
+
+	.tc_rate = {PERF_RATE, PERF_RATE, PERF_RATE, PERF_RATE},
+	.tc_period = 10,
+};
+
+static struct rte_sched_pipe_params perf_pipe_profile[] = {
+	{
+		.tb_rate = PERF_RATE,
+		.tb_size = 1000000,
+
+		.tc_rate = {PERF_RATE, PERF_RATE, PERF_RATE, PERF_RATE},
+		.tc_period = 40,
+
+		.wrr_weights = {1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1,  1, 1, 1, 1},
+	},
+};
+
+static struct rte_sched_port_params perf_port_param = {
+	.name = "sched_perf",
+	.socket = SOCKET,
+	.rate = PERF_RATE,
+	.mtu = 1522,
+	.frame_overhead = RTE_SCHED_FRAME_OVERHEAD_DEFAULT,
+	.n_subports_per_port = PERF_N_SUBPORTS,
+	.n_pipes_per_subport = PERF_N_PIPES,
+	.qsize = {PERF_QSIZE, PERF_QSIZE, PERF_QSIZE, PERF_QSIZE},
+	.pipe_profiles = perf_pipe_profile,
+	.n_pipe_profiles = 1,
+};
+
+static struct rte_sched_port *perf_port;
+static volatile int perf_stop;
+static uint64_t perf_deq_count[RTE_MAX_LCORE];
+
+static struct rte_sched_port *
+perf_port_create(void)
+{
+	struct rte_sched_port *port;
+	uint32_t subport, pipe;
+
+	port = rte_sched_port_config(&perf_port_param);
+	if (port == NULL)
+		return NULL;
+
+	for (subport = 0; subport < PERF_N_SUBPORTS; subport++) {
+		if (rte_sched_subport_config(port, subport,
+				&perf_subport_param) != 0)
+			goto error;
+
+		for (pipe = 0; pipe < PERF_N_PIPES; pipe++)
+			if (rte_sched_pipe_config(port, subport, pipe, 0) != 0)
+				goto error;
+	}
+
+	return port;
+
+error:
+	rte_sched_port_free(port);
+	return NULL;
+}
+
+/* Spread the packets of the pool over all the queues of the port once, the
+ * tree path and length then survive the recycling through the mempool.
+ */
+static int
+perf_mempool_prepare(struct rte_mempool *mp)
+{
+	static struct rte_mbuf *mbufs[PERF_NB_MBUF];
+	uint32_t i;
+
+	if (rte_pktmbuf_alloc_bulk(mp, mbufs, PERF_NB_MBUF) != 0)
+		return -1;
+
+	for (i = 0; i < PERF_NB_MBUF; i++) {
+		uint32_t subport = i % PERF_N_SUBPORTS;
+		uint32_t pipe = (i / PERF_N_SUBPORTS) % PERF_N_PIPES;
+		uint32_t tc = (i / 7) % RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE;
+		uint32_t queue = (i / 3) % RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
+
+		rte_sched_port_pkt_write(mbufs[i], subport, pipe, tc, queue,
+					 e_RTE_METER_GREEN);
+		mbufs[i]->pkt_len = 60;
+		mbufs[i]->data_len = 60;
+	}
+
+	rte_pktmbuf_free_bulk(mbufs, PERF_NB_MBUF);
+
+	return 0;
+}
+
+static int
+perf_shard_dequeue(void *arg)
+{
+	uint32_t shard_id = (uint32_t)(uintptr_t)arg;
+	struct rte_mbuf *mbufs[PERF_BURST];
+	uint64_t count = 0;
+	int n;
+
+	while (!perf_stop) {
+		n = rte_sched_port_shard_dequeue(perf_port, shard_id, mbufs,
+						 PERF_BURST);
+		if (n == 0)
+			continue;
+
+		rte_pktmbuf_free_bulk(mbufs, n);
+		count += n;
+	}
+
+	perf_deq_count[rte_lcore_id()] = count;
+
+	return 0;
+}
+
+static int
+perf_enqueue_burst(struct rte_mempool *mp)
+{
+	struct rte_mbuf *mbufs[PERF_BURST];
+
+	if (rte_mempool_get_bulk(mp, (void **)mbufs, PERF_BURST) != 0)
+		return 0;
+
+	/* Packets dropped on a full queue go back to the pool */
+	rte_sched_port_enqueue(perf_port, mbufs, PERF_BURST);
+
+	return 1;
+}
+
+/* Enqueue and dequeue on the master lcore only, the reference point */
+static double
+perf_single_core(struct rte_mempool *mp)
+{
+	struct rte_mbuf *mbufs[PERF_BURST];
+	uint64_t count = 0, start, end;
+	int n;
+
+	start = rte_get_timer_cycles();
+	end = start + rte_get_timer_hz() * PERF_DURATION_MS / 1000;
+
+	while (rte_get_timer_cycles() < end) {
+		perf_enqueue_burst(mp);
+
+		n = rte_sched_port_dequeue(perf_port, mbufs, PERF_BURST);
+		rte_pktmbuf_free_bulk(mbufs, n);
+		count += n;
+	}
+
+	return (double)count * rte_get_timer_hz() /
+		(rte_get_timer_cycles() - start) / 1000000;
+}
+
+static double
+perf_multi_core(struct rte_mempool *mp, uint32_t n_shards)
+{
+	uint64_t count = 0, start, end;
+	uint32_t lcore_id, shard_id = 0;
+
+	perf_stop = 0;
+	memset(perf_deq_count, 0, sizeof(perf_deq_count));
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (shard_id == n_shards)
+			break;
+		rte_eal_remote_launch(perf_shard_dequeue,
+			(void *)(uintptr_t)shard_id++, lcore_id);
+	}
+
+	start = rte_get_timer_cycles();
+	end = start + rte_get_timer_hz() * PERF_DURATION_MS / 1000;
+
+	while (rte_get_timer_cycles() < end)
+		perf_enqueue_burst(mp);
+
+	perf_stop = 1;
+	end = rte_get_timer_cycles();
+
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		count += perf_deq_count[lcore_id];
+
+	return (double)count * rte_get_timer_hz() / (end - start) / 1000000;
+}
+
+static int
+test_sched_perf(void)
+{
+	struct rte_mempool *mp;
+	uint32_t n_shards, n_slaves;
+	int err;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough cores for sched_perf_autotest, expecting at least 2\n");
+		return TEST_SKIPPED;
+	}
+	n_slaves = rte_lcore_count() - 1;
+
+	/* The packets are only prepared once, as some of them stay in the
+	 * mempool caches of the slave lcores between two runs.
+	 */
+	mp = rte_mempool_lookup("test_sched_perf");
+	if (mp == NULL) {
+		mp = rte_pktmbuf_pool_create("test_sched_perf", PERF_NB_MBUF,
+			PERF_MEMPOOL_CACHE, 0, MBUF_DATA_SZ, SOCKET);
+		TEST_ASSERT_NOT_NULL(mp, "Error creating mempool\n");
+
+		err = perf_mempool_prepare(mp);
+		TEST_ASSERT_SUCCESS(err, "Error preparing packets\n");
+	}
+
+	perf_port = perf_port_create();
+	TEST_ASSERT_NOT_NULL(perf_port, "Error config sched port\n");
+	printf("%u subports, %u pipes per subport, %u byte packets\n",
+	       PERF_N_SUBPORTS, PERF_N_PIPES, 60);
+	printf("Single core enqueue and dequeue: %.2f Mpps\n",
+	       perf_single_core(mp));
+	rte_sched_port_free(perf_port);
+
+	for (n_shards = 1; n_shards <= RTE_MIN(n_slaves, PERF_N_SUBPORTS);
+	     n_shards <<= 1) {
+		perf_port = perf_port_create();
+		TEST_ASSERT_NOT_NULL(perf_port, "Error config sched port\n");
+
+		err = rte_sched_port_shards_config(perf_port, n_shards);
+		TEST_ASSERT_SUCCESS(err, "Error config %u shards, err=%d\n",
+				    n_shards, err);
+
+		printf("1 enqueue core, %u dequeue core(s): %.2f Mpps\n",
+		       n_shards, perf_multi_core(mp, n_shards));
+		rte_sched_port_free(perf_port);
+	}
+
+	perf_port = NULL;
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(sched_perf_autotest, test_sched_perf);
@@ -194,4 +194,21 @@ test_table(void)
 	return ret;
 }
 
+static int
+test_table_perf(void)
+{
+	int ret = TEST_SUCCESS;
+
+	app_init_mbuf_pools();
+
+	printf("\n\n\n\n************Table perf tests************\n");
+	if (test_table_hash_perf_all() < 0)
+		ret = TEST_FAILED;
+
+	rte_mempool_free(pool);
+
+	return ret;
+}
+
 REGISTER_TEST_COMMAND(table_autotest, test_table);
+REGISTER_TEST_COMMAND(table_perf_autotest, test_table_perf);
@@ -2,11 +2,18 @@
  * Copyright(c) 2010-2014 Intel Corporation
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <rte_pipeline.h>
 #include <rte_log.h>
 #include <inttypes.h>
 #include <rte_hexdump.h>
+#include <rte_byteorder.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_ip.h>
+#include <rte_table_action.h>
 #include "test_table.h"
 #include "test_table_pipeline.h"
 
@@ -498,6 +505,694 @@ test_pipeline_single_filter(int test_type, int expected_count)
 
 }
 
+static int test_run_fn_calls;
+
+static int
+test_run_fn(__attribute__((unused)) struct rte_pipeline *p)
+{
+	test_run_fn_calls++;
+	return 0;
+}
+
+#define CODEGEN_N_PKTS	12
+
+/*
+ * Feed CODEGEN_N_PKTS packets to each input port, run the pipeline until
+ * they are all processed, and record the output port of each packet, or -1
+ * when the packet is dropped.
+ */
+static int
+codegen_pkts_run(int *pkts_port)
+{
+	struct rte_mbuf *pkts[N_PORTS * CODEGEN_N_PKTS];
+	int i, j, k, n;
+
+	for (i = 0; i < N_PORTS; i++)
+		for (j = 0; j < CODEGEN_N_PKTS; j++) {
+			struct rte_mbuf *m;
+			uint32_t *k32;
+
+			m = rte_pktmbuf_alloc(pool);
+			if (m == NULL)
+				return -1;
+
+			k32 = RTE_MBUF_METADATA_UINT32_PTR(m,
+				APP_METADATA_OFFSET(32));
+			k32[0] = 0xadadadad >> (j % 2);
+
+			pkts[i * CODEGEN_N_PKTS + j] = m;
+			pkts_port[i * CODEGEN_N_PKTS + j] = -1;
+			rte_ring_enqueue(rings_rx[i], m);
+		}
+
+	/* Each run serves one burst of one input port */
+	for (i = 0; i < 2 * N_PORTS * CODEGEN_N_PKTS; i++)
+		rte_pipeline_run(p);
+	rte_pipeline_flush(p);
+
+	for (i = 0; i < N_PORTS; i++) {
+		void *objs[RING_TX_SIZE];
+
+		n = rte_ring_sc_dequeue_burst(rings_tx[i], objs, RING_TX_SIZE,
+			NULL);
+		for (j = 0; j < n; j++) {
+			for (k = 0; k < N_PORTS * CODEGEN_N_PKTS; k++)
+				if (objs[j] == pkts[k])
+					pkts_port[k] = i;
+			rte_pktmbuf_free(objs[j]);
+		}
+	}
+
+	return 0;
+}
+
+/* The generated run function forwards the packets as the generic one */
+static int
+test_pipeline_codegen_run(void)
+{
+	int pkts_port[N_PORTS * CODEGEN_N_PKTS];
+	int pkts_port_codegen[N_PORTS * CODEGEN_N_PKTS];
+	int i;
+
+	if (codegen_pkts_run(pkts_port) != 0)
+		return -1;
+
+	if (rte_pipeline_run_fn_set(p, test_table_pipeline_run) != 0)
+		return -1;
+
+	if (codegen_pkts_run(pkts_port_codegen) != 0)
+		return -1;
+
+	rte_pipeline_run_fn_set(p, NULL);
+
+	for (i = 0; i < N_PORTS * CODEGEN_N_PKTS; i++)
+		if ((pkts_port[i] == -1) ||
+			(pkts_port_codegen[i] != pkts_port[i])) {
+			RTE_LOG(INFO, PIPELINE,
+				"%s: Packet %d sent to port %d, expected %d\n",
+				__func__, i, pkts_port_codegen[i],
+				pkts_port[i]);
+			return -1;
+		}
+
+	return 0;
+}
+
+static int
+test_pipeline_codegen(void)
+{
+	char *code = NULL;
+	size_t code_size = 0;
+	FILE *f;
+	int ret;
+
+	RTE_LOG(INFO, PIPELINE, "%s: **** Running codegen test\n", __func__);
+
+	f = open_memstream(&code, &code_size);
+	if (f == NULL)
+		goto fail;
+
+	ret = rte_pipeline_codegen(p, f, "0run");
+	if (ret != -EINVAL) {
+		RTE_LOG(INFO, PIPELINE, "%s: Invalid name accepted (%d)\n",
+			__func__, ret);
+		goto fail_close;
+	}
+
+	ret = rte_pipeline_codegen(p, f, "test_table_pipeline_run");
+	fclose(f);
+	if (ret != 0) {
+		RTE_LOG(INFO, PIPELINE, "%s: Code generation failed (%d)\n",
+			__func__, ret);
+		goto fail;
+	}
+
+	/* Run function and chain of tables, as in test_table_pipeline_run.c */
+	if ((strstr(code, "\nint\ntest_table_pipeline_run("
+			"struct rte_pipeline *p)\n") == NULL) ||
+		(strstr(code, "rte_pipeline_table_run(p, &p->tables[0], "
+			"0, 0, 0);\n\n\t/* Next table */\n"
+			"\tif (p->pkts_mask != 0)\n"
+			"\t\ttest_table_pipeline_run_table_1(p);\n") == NULL)) {
+		RTE_LOG(INFO, PIPELINE, "%s: Unexpected code:\n%s\n",
+			__func__, code);
+		goto fail;
+	}
+	free(code);
+
+	/* Same packet outcomes with the ahead of time generated code */
+	if (test_pipeline_codegen_run() != 0)
+		goto fail_cleanup;
+
+	/* The run function is used until the next topology change */
+	test_run_fn_calls = 0;
+	if (rte_pipeline_run_fn_set(p, test_run_fn) != 0)
+		goto fail_cleanup;
+
+	rte_pipeline_run(p);
+	rte_pipeline_port_in_connect_to_table(p, port_in_id[0], table_id[0]);
+	rte_pipeline_run(p);
+
+	if (test_run_fn_calls != 1) {
+		RTE_LOG(INFO, PIPELINE, "%s: Run function called %d times\n",
+			__func__, test_run_fn_calls);
+		goto fail_cleanup;
+	}
+
+	cleanup_pipeline();
+
+	return 0;
+
+fail_close:
+	fclose(f);
+fail:
+	free(code);
+fail_cleanup:
+	cleanup_pipeline();
+	return -1;
+}
+
+static int
+test_pipeline_lock_free(void)
+{
+	struct rte_pipeline_params pipeline_params = {
+		.name = "PIPELINE_LF",
+		.socket_id = 0,
+	};
+	struct rte_table_array_params array_params = {
+		.n_entries = 16,
+		.offset = APP_METADATA_OFFSET(0),
+	};
+	struct rte_pipeline_table_params table_params = {
+		.ops = &rte_table_array_lf_ops,
+		.arg_create = &array_params,
+		.f_action_hit = NULL,
+		.f_action_miss = NULL,
+		.arg_ah = NULL,
+		.action_data_size = 0,
+	};
+	struct rte_pipeline_table_params stub_table_params = {
+		.ops = &rte_table_stub_ops,
+		.arg_create = NULL,
+		.f_action_hit = NULL,
+		.f_action_miss = NULL,
+		.arg_ah = NULL,
+		.action_data_size = 0,
+	};
+	struct rte_table_array_key array_key = {
+		.pos = 3,
+	};
+	struct rte_pipeline_table_entry entry = {
+		.action = RTE_PIPELINE_ACTION_DROP,
+	};
+	struct rte_pipeline_table_entry *entry_ptr[3];
+	struct rte_pipeline *p_lf;
+	uint32_t table_lf_id, table_stub_id;
+	int key_found, ret, i;
+
+	RTE_LOG(INFO, PIPELINE, "%s: **** Running lock-free table test\n",
+		__func__);
+
+	p_lf = rte_pipeline_create(&pipeline_params);
+	if (p_lf == NULL)
+		return -1;
+
+	if ((rte_pipeline_table_create(p_lf, &table_params,
+			&table_lf_id) != 0) ||
+		(rte_pipeline_table_create(p_lf, &stub_table_params,
+			&table_stub_id) != 0))
+		goto fail;
+
+	/* The table runs out of free entries on the second update, so the
+	 * pipeline reclaims it
+	 */
+	for (i = 0; i < 3; i++) {
+		ret = rte_pipeline_table_entry_add(p_lf, table_lf_id,
+			&array_key, &entry, &key_found, &entry_ptr[i]);
+		if (ret != 0) {
+			RTE_LOG(INFO, PIPELINE, "%s: Entry add failed (%d)\n",
+				__func__, ret);
+			goto fail;
+		}
+	}
+
+	if ((entry_ptr[0] == entry_ptr[1]) || (entry_ptr[2] != entry_ptr[0]))
+		goto fail;
+
+	rte_pipeline_run(p_lf);
+
+	if (rte_pipeline_table_reclaim(p_lf, table_lf_id) != 0)
+		goto fail;
+
+	if (rte_pipeline_table_reclaim(p_lf, table_stub_id) == 0) {
+		RTE_LOG(INFO, PIPELINE, "%s: Stub table reclaimed\n",
+			__func__);
+		goto fail;
+	}
+
+	rte_pipeline_free(p_lf);
+	return 0;
+
+fail:
+	rte_pipeline_free(p_lf);
+	return -1;
+}
+
+#define MT_N_KEYS	8
+#define MT_N_UPDATES	20000
+#define MT_BURST	BURST_SIZE
+
+struct mt_entry {
+	struct rte_pipeline_table_entry head;
+	uint32_t key;
+};
+
+static struct rte_pipeline *p_mt;
+static uint32_t mt_table_id;
+static uint32_t mt_port_out_id;
+static int mt_writer_done;
+static uint64_t mt_n_hits;
+static uint64_t mt_n_errors;
+
+/* Every entry found by a lookup still holds the key of the packet */
+static int
+mt_action_hit(__attribute__((unused)) struct rte_pipeline *p,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	struct rte_pipeline_table_entry **entries,
+	__attribute__((unused)) void *arg)
+{
+	for ( ; pkts_mask != 0; pkts_mask &= pkts_mask - 1) {
+		uint32_t pos = __builtin_ctzll(pkts_mask);
+		struct mt_entry *e = (struct mt_entry *) entries[pos];
+		uint32_t key = RTE_MBUF_METADATA_UINT32(pkts[pos],
+			APP_METADATA_OFFSET(32));
+
+		mt_n_hits++;
+		if (e->key != key)
+			mt_n_errors++;
+	}
+
+	return 0;
+}
+
+/* Control thread: update the entries in place, deleting some of them, so
+ * that the table runs out of free keys and reclaims the old copies
+ */
+static int
+mt_writer(__attribute__((unused)) void *arg)
+{
+	int status = 0;
+	uint32_t i;
+
+	for (i = 0; i < MT_N_UPDATES; i++) {
+		struct mt_entry entry = {
+			.head = {
+				.action = RTE_PIPELINE_ACTION_PORT,
+				{.port_id = mt_port_out_id},
+			},
+		};
+		struct rte_pipeline_table_entry *entry_ptr;
+		uint64_t key = 0;
+		uint32_t *k32 = (uint32_t *) &key;
+		int key_found;
+
+		k32[0] = rte_cpu_to_be_32(i % MT_N_KEYS);
+		entry.key = k32[0];
+
+		if ((i % 3) == 0) {
+			status = rte_pipeline_table_entry_delete(p_mt,
+				mt_table_id, &key, &key_found, NULL);
+			if (status != 0)
+				break;
+		}
+
+		status = rte_pipeline_table_entry_add(p_mt, mt_table_id, &key,
+			&entry.head, &key_found, &entry_ptr);
+		if (status != 0)
+			break;
+	}
+
+	__atomic_store_n(&mt_writer_done, 1, __ATOMIC_RELEASE);
+	return status;
+}
+
+/* One lcore runs the pipeline while another one updates its lock-free table */
+static int
+test_pipeline_lock_free_mt(void)
+{
+	struct rte_pipeline_params pipeline_params = {
+		.name = "PIPELINE_LF_MT",
+		.socket_id = 0,
+	};
+	struct rte_port_ring_reader_params ring_in_params = {
+		.ring = rings_rx[0],
+	};
+	struct rte_pipeline_port_in_params port_in_params = {
+		.ops = &rte_port_ring_reader_ops,
+		.arg_create = &ring_in_params,
+		.f_action = NULL,
+		.arg_ah = NULL,
+		.burst_size = MT_BURST,
+	};
+	struct rte_port_ring_writer_params ring_out_params = {
+		.ring = rings_tx[0],
+		.tx_burst_sz = MT_BURST,
+	};
+	struct rte_pipeline_port_out_params port_out_params = {
+		.ops = &rte_port_ring_writer_ops,
+		.arg_create = &ring_out_params,
+		.f_action = NULL,
+		.arg_ah = NULL,
+	};
+	struct rte_table_hash_params hash_params = {
+		.name = "TABLE_LF_MT",
+		.key_size = 8,
+		.key_offset = APP_METADATA_OFFSET(32),
+		.key_mask = NULL,
+		.n_keys = 4 * MT_N_KEYS,
+		.n_buckets = MT_N_KEYS,
+		.f_hash = pipeline_test_hash,
+		.seed = 0,
+	};
+	struct rte_pipeline_table_params table_params = {
+		.ops = &rte_table_hash_ext_lf_ops,
+		.arg_create = &hash_params,
+		.f_action_hit = mt_action_hit,
+		.f_action_miss = NULL,
+		.arg_ah = NULL,
+		.action_data_size = sizeof(uint32_t),
+	};
+	uint32_t port_in_id_mt, lcore_id, i;
+	int status;
+
+	if (rte_lcore_count() < 2) {
+		RTE_LOG(INFO, PIPELINE, "%s: Need at least 2 lcores, "
+			"skipping\n", __func__);
+		return 0;
+	}
+
+	RTE_LOG(INFO, PIPELINE, "%s: **** Running lock-free table MT test\n",
+		__func__);
+
+	p_mt = rte_pipeline_create(&pipeline_params);
+	if (p_mt == NULL)
+		return -1;
+
+	if ((rte_pipeline_port_in_create(p_mt, &port_in_params,
+			&port_in_id_mt) != 0) ||
+		(rte_pipeline_port_out_create(p_mt, &port_out_params,
+			&mt_port_out_id) != 0) ||
+		(rte_pipeline_table_create(p_mt, &table_params,
+			&mt_table_id) != 0) ||
+		(rte_pipeline_port_in_connect_to_table(p_mt, port_in_id_mt,
+			mt_table_id) != 0) ||
+		(rte_pipeline_port_in_enable(p_mt, port_in_id_mt) != 0) ||
+		(rte_pipeline_check(p_mt) != 0))
+		goto fail;
+
+	mt_writer_done = 0;
+	mt_n_hits = 0;
+	mt_n_errors = 0;
+
+	lcore_id = rte_get_next_lcore(-1, 1, 0);
+	if (rte_eal_remote_launch(mt_writer, NULL, lcore_id) != 0)
+		goto fail;
+
+	/* Run the pipeline until the writer is done: packets of all the keys
+	 * plus one that is never added
+	 */
+	for (i = 0; __atomic_load_n(&mt_writer_done, __ATOMIC_ACQUIRE) == 0;
+		i++) {
+		struct rte_mbuf *mbufs[MT_BURST];
+		void *objs[MT_BURST];
+		uint32_t j, n;
+
+		for (j = 0; j < MT_BURST; j++) {
+			mbufs[j] = rte_pktmbuf_alloc(pool);
+			if (mbufs[j] == NULL)
+				break;
+
+			RTE_MBUF_METADATA_UINT32(mbufs[j],
+				APP_METADATA_OFFSET(32)) =
+				rte_cpu_to_be_32((i + j) % (MT_N_KEYS + 1));
+			RTE_MBUF_METADATA_UINT32(mbufs[j],
+				APP_METADATA_OFFSET(36)) = 0;
+		}
+
+		n = rte_ring_sp_enqueue_burst(rings_rx[0], (void **) mbufs, j,
+			NULL);
+		for ( ; n < j; n++)
+			rte_pktmbuf_free(mbufs[n]);
+
+		rte_pipeline_run(p_mt);
+		rte_pipeline_flush(p_mt);
+
+		n = rte_ring_sc_dequeue_burst(rings_tx[0], objs, MT_BURST,
+			NULL);
+		for (j = 0; j < n; j++)
+			rte_pktmbuf_free(objs[j]);
+	}
+
+	status = rte_eal_wait_lcore(lcore_id);
+	if (status != 0) {
+		RTE_LOG(INFO, PIPELINE, "%s: Table update failed (%d)\n",
+			__func__, status);
+		goto fail;
+	}
+
+	if ((mt_n_hits == 0) || (mt_n_errors != 0)) {
+		RTE_LOG(INFO, PIPELINE, "%s: %" PRIu64 " hits, %" PRIu64
+			" with the entry of another key\n", __func__,
+			mt_n_hits, mt_n_errors);
+		goto fail;
+	}
+
+	rte_pipeline_free(p_mt);
+	return 0;
+
+fail:
+	rte_pipeline_free(p_mt);
+	return -1;
+}
+
+#define AGE_N_SLOTS	4
+#define AGE_SLOT	1
+#define AGE_PKT_LEN	100
+#define AGE_N_HITS	100000
+
+static struct rte_pipeline *p_age;
+static struct rte_table_action *age_action;
+static rte_pipeline_table_action_handler_hit age_action_hit;
+static struct rte_pipeline_table_entry *age_entry;
+static struct rte_mbuf *age_mbuf;
+static int age_hits_done;
+
+/* Hit the rule, as the pipeline does on a table lookup hit */
+static void
+age_rule_hit(void)
+{
+	age_action_hit(p_age, &age_mbuf, 1LLU, &age_entry, age_action);
+}
+
+static int
+age_hitter(__attribute__((unused)) void *arg)
+{
+	uint32_t i;
+
+	for (i = 0; i < AGE_N_HITS; i++)
+		age_rule_hit();
+
+	__atomic_store_n(&age_hits_done, 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+static int
+age_scan(uint64_t time, uint32_t *slot_ids)
+{
+	uint32_t pos = 0;
+
+	return rte_table_action_age_scan(age_action, time, &pos, AGE_N_SLOTS,
+		slot_ids, AGE_N_SLOTS);
+}
+
+/* Rule aging and stats snapshot of the table action API */
+static int
+test_table_action_age(void)
+{
+	struct rte_pipeline_params pipeline_params = {
+		.name = "PIPELINE_AGE",
+		.socket_id = 0,
+	};
+	struct rte_table_action_common_config common = {
+		.ip_version = 1,
+		.ip_offset = APP_METADATA_OFFSET(0),
+	};
+	struct rte_table_action_stats_config stats_config = {
+		.n_packets_enabled = 1,
+		.n_bytes_enabled = 1,
+	};
+	struct rte_table_action_age_config age_config = {
+		.n_slots = AGE_N_SLOTS,
+	};
+	struct rte_table_action_fwd_params fwd_params = {
+		.action = RTE_PIPELINE_ACTION_DROP,
+	};
+	struct rte_table_action_stats_params stats_params = {
+		.n_packets = 0,
+		.n_bytes = 0,
+	};
+	struct rte_table_action_age_params age_params = {
+		.slot_id = AGE_SLOT,
+	};
+	struct rte_table_action_stats_counters stats;
+	struct rte_pipeline_table_params table_params;
+	struct rte_table_action_profile *profile;
+	struct ipv4_hdr *ip;
+	uint64_t data[64];
+	uint32_t slot_ids[AGE_N_SLOTS], lcore_id;
+	int n, status = -1;
+
+	RTE_LOG(INFO, PIPELINE, "%s: **** Running table action age test\n",
+		__func__);
+
+	/* Timeout long enough for a hit to always be more recent */
+	age_params.timeout = 10 * rte_get_tsc_hz();
+
+	p_age = rte_pipeline_create(&pipeline_params);
+	profile = rte_table_action_profile_create(&common);
+	age_mbuf = rte_pktmbuf_alloc(pool);
+	age_action = NULL;
+	if ((p_age == NULL) || (profile == NULL) || (age_mbuf == NULL))
+		goto end;
+
+	if ((rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_FWD, NULL) != 0) ||
+		(rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_STATS, &stats_config) != 0) ||
+		(rte_table_action_profile_action_register(profile,
+			RTE_TABLE_ACTION_AGE, &age_config) != 0) ||
+		(rte_table_action_profile_freeze(profile) != 0))
+		goto end;
+
+	age_action = rte_table_action_create(profile, 0);
+	if ((age_action == NULL) ||
+		(rte_table_action_table_params_get(age_action,
+			&table_params) != 0) ||
+		(table_params.f_action_hit == NULL) ||
+		(sizeof(struct rte_pipeline_table_entry) +
+			table_params.action_data_size > sizeof(data)))
+		goto end;
+
+	age_action_hit = table_params.f_action_hit;
+	age_entry = (struct rte_pipeline_table_entry *) data;
+
+	if ((rte_table_action_apply(age_action, data, RTE_TABLE_ACTION_FWD,
+			&fwd_params) != 0) ||
+		(rte_table_action_apply(age_action, data,
+			RTE_TABLE_ACTION_STATS, &stats_params) != 0) ||
+		(rte_table_action_apply(age_action, data, RTE_TABLE_ACTION_AGE,
+			&age_params) != 0))
+		goto end;
+
+	ip = (struct ipv4_hdr *) RTE_MBUF_METADATA_UINT8_PTR(age_mbuf,
+		APP_METADATA_OFFSET(0));
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(AGE_PKT_LEN);
+
+	/* No expiry before the timeout, nor for a scan time older than the
+	 * last hit time
+	 */
+	if ((age_scan(rte_rdtsc(), slot_ids) != 0) ||
+		(age_scan(0, slot_ids) != 0)) {
+		RTE_LOG(INFO, PIPELINE, "%s: Rule expired too early\n",
+			__func__);
+		goto end;
+	}
+
+	/* A hit restarts the timeout */
+	age_rule_hit();
+	if ((rte_table_action_stats_read(age_action, data, &stats, 0) != 0) ||
+		(stats.n_packets != 1) || (stats.n_bytes != AGE_PKT_LEN) ||
+		(age_scan(rte_rdtsc() + age_params.timeout / 2,
+			slot_ids) != 0))
+		goto end;
+
+	/* Expiry, reported once */
+	n = age_scan(rte_rdtsc() + 2 * age_params.timeout, slot_ids);
+	if ((n != 1) || (slot_ids[0] != AGE_SLOT) ||
+		(age_scan(rte_rdtsc() + 2 * age_params.timeout,
+			slot_ids) != 0)) {
+		RTE_LOG(INFO, PIPELINE, "%s: Wrong expiry (%d)\n",
+			__func__, n);
+		goto end;
+	}
+
+	/* A disarmed slot does not expire */
+	if ((rte_table_action_apply(age_action, data, RTE_TABLE_ACTION_AGE,
+			&age_params) != 0) ||
+		(rte_table_action_age_disarm(age_action, AGE_SLOT) != 0) ||
+		(rte_table_action_age_disarm(age_action, AGE_N_SLOTS) == 0) ||
+		(age_scan(rte_rdtsc() + 2 * age_params.timeout,
+			slot_ids) != 0)) {
+		RTE_LOG(INFO, PIPELINE, "%s: Disarmed rule expired\n",
+			__func__);
+		goto end;
+	}
+
+	if (rte_lcore_count() < 2) {
+		RTE_LOG(INFO, PIPELINE, "%s: Need at least 2 lcores, "
+			"skipping the concurrent hits\n", __func__);
+		status = 0;
+		goto end;
+	}
+
+	/* Hits racing with the scans and the stats reads */
+	if ((rte_table_action_apply(age_action, data, RTE_TABLE_ACTION_AGE,
+			&age_params) != 0) ||
+		(rte_table_action_stats_read(age_action, data, NULL, 1) != 0))
+		goto end;
+
+	age_hits_done = 0;
+	lcore_id = rte_get_next_lcore(-1, 1, 0);
+	if (rte_eal_remote_launch(age_hitter, NULL, lcore_id) != 0)
+		goto end;
+
+	while (__atomic_load_n(&age_hits_done, __ATOMIC_ACQUIRE) == 0) {
+		n = age_scan(rte_rdtsc(), slot_ids);
+		rte_table_action_stats_read(age_action, data, &stats, 0);
+
+		if ((n != 0) ||
+			(stats.n_bytes != stats.n_packets * AGE_PKT_LEN)) {
+			RTE_LOG(INFO, PIPELINE, "%s: %d expired, %" PRIu64
+				" packets, %" PRIu64 " bytes\n", __func__,
+				n, stats.n_packets, stats.n_bytes);
+			rte_eal_wait_lcore(lcore_id);
+			goto end;
+		}
+	}
+
+	rte_eal_wait_lcore(lcore_id);
+
+	if ((rte_table_action_stats_read(age_action, data, &stats, 0) != 0) ||
+		(stats.n_packets != AGE_N_HITS))
+		goto end;
+
+	status = 0;
+
+end:
+	if (status != 0)
+		RTE_LOG(INFO, PIPELINE, "%s: Failed\n", __func__);
+
+	rte_table_action_free(age_action);
+	rte_table_action_profile_free(profile);
+	rte_pktmbuf_free(age_mbuf);
+	rte_pipeline_free(p_age);
+
+	return status;
+}
+
 int
 test_table_pipeline(void)
 {
@@ -559,6 +1254,27 @@ test_table_pipeline(void)
 		return -1;
 	connect_miss_action_to_table = 0;
 
+	/* TEST - code generation for the two table pipeline */
+	connect_miss_action_to_table = 1;
+	table_entry_default_action = RTE_PIPELINE_ACTION_TABLE;
+	action_handler_hit = NULL;
+	action_handler_miss = NULL;
+	setup_pipeline(e_TEST_STUB);
+	if (test_pipeline_codegen() < 0)
+		return -1;
+	connect_miss_action_to_table = 0;
+
+	/* TEST - lock-free table updates */
+	if (test_pipeline_lock_free() < 0)
+		return -1;
+
+	if (test_pipeline_lock_free_mt() < 0)
+		return -1;
+
+	/* TEST - table action rule aging */
+	if (test_table_action_age() < 0)
+		return -1;
+
 	if (check_pipeline_invalid_params()) {
 		RTE_LOG(INFO, PIPELINE, "%s: Check pipeline invalid params "
 			"failed.\n", __func__);
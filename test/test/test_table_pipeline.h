@@ -4,3 +4,6 @@
 
 /* Test prototypes */
 int test_table_pipeline(void);
+
+/* Generated with rte_pipeline_codegen() for the two table pipeline */
+int test_table_pipeline_run(struct rte_pipeline *p);
@@ -0,0 +1,120 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+/*
+ * Run function of pipeline "PIPELINE", generated by rte_pipeline_codegen().
+ * Input ports: 2, tables: 4, output ports: 2.
+ */
+
+#include <rte_config.h>
+#include <rte_pipeline_internal.h>
+
+int test_table_pipeline_run(struct rte_pipeline *p);
+
+static void
+test_table_pipeline_run_table_0(struct rte_pipeline *p);
+static void
+test_table_pipeline_run_table_1(struct rte_pipeline *p);
+static void
+test_table_pipeline_run_table_2(struct rte_pipeline *p);
+static void
+test_table_pipeline_run_table_3(struct rte_pipeline *p);
+
+static void
+test_table_pipeline_run_table_0(struct rte_pipeline *p)
+{
+	rte_pipeline_table_run(p, &p->tables[0], 0, 0, 0);
+
+	/* Next table */
+	if (p->pkts_mask != 0)
+		test_table_pipeline_run_table_1(p);
+}
+
+static void
+test_table_pipeline_run_table_1(struct rte_pipeline *p)
+{
+	rte_pipeline_table_run(p, &p->tables[1], 0, 0, 0);
+}
+
+static void
+test_table_pipeline_run_table_2(struct rte_pipeline *p)
+{
+	rte_pipeline_table_run(p, &p->tables[2], 0, 0, 0);
+
+	/* Next table */
+	if (p->pkts_mask != 0)
+		test_table_pipeline_run_table_3(p);
+}
+
+static void
+test_table_pipeline_run_table_3(struct rte_pipeline *p)
+{
+	rte_pipeline_table_run(p, &p->tables[3], 0, 0, 0);
+}
+
+static int
+test_table_pipeline_run_port_in_0(struct rte_pipeline *p)
+{
+	struct rte_port_in *port_in = &p->ports_in[0];
+	uint32_t n_pkts;
+
+	/* Input port RX */
+	n_pkts = port_in->ops.f_rx(port_in->h_port, p->pkts, 8);
+	if (n_pkts == 0) {
+		p->port_in_next = port_in->next;
+		return 0;
+	}
+
+	rte_pipeline_port_in_start(p, port_in, n_pkts, 0);
+
+	/* Table */
+	if (p->pkts_mask != 0)
+		test_table_pipeline_run_table_0(p);
+
+	rte_pipeline_port_in_end(p, port_in, 0);
+
+	return (int) n_pkts;
+}
+
+static int
+test_table_pipeline_run_port_in_1(struct rte_pipeline *p)
+{
+	struct rte_port_in *port_in = &p->ports_in[1];
+	uint32_t n_pkts;
+
+	/* Input port RX */
+	n_pkts = port_in->ops.f_rx(port_in->h_port, p->pkts, 8);
+	if (n_pkts == 0) {
+		p->port_in_next = port_in->next;
+		return 0;
+	}
+
+	rte_pipeline_port_in_start(p, port_in, n_pkts, 0);
+
+	/* Table */
+	if (p->pkts_mask != 0)
+		test_table_pipeline_run_table_2(p);
+
+	rte_pipeline_port_in_end(p, port_in, 0);
+
+	return (int) n_pkts;
+}
+
+int
+test_table_pipeline_run(struct rte_pipeline *p)
+{
+	struct rte_port_in *port_in = p->port_in_next;
+
+	if (port_in == NULL)
+		return 0;
+
+	switch (port_in - p->ports_in) {
+	case 0:
+		return test_table_pipeline_run_port_in_0(p);
+	case 1:
+		return test_table_pipeline_run_port_in_1(p);
+	default:
+		return 0;
+	}
+}
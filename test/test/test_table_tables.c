@@ -18,20 +18,24 @@ table_test table_tests[] = {
 	test_table_hash_lru,
 	test_table_hash_ext,
 	test_table_hash_cuckoo,
+	test_table_lock_free,
+};
+
+/* Packet key, large enough for the keys of all the tables */
+struct test_table_key {
+	uint32_t k32[16];
 };
 
 #define PREPARE_PACKET(mbuf, value) do {				\
-	uint32_t *k32, *signature;					\
-	uint8_t *key;							\
+	struct test_table_key *key;					\
+	uint32_t *signature;						\
 	mbuf = rte_pktmbuf_alloc(pool);					\
 	signature = RTE_MBUF_METADATA_UINT32_PTR(mbuf,			\
 			APP_METADATA_OFFSET(0));			\
-	key = RTE_MBUF_METADATA_UINT8_PTR(mbuf,			\
-			APP_METADATA_OFFSET(32));			\
-	memset(key, 0, 32);						\
-	k32 = (uint32_t *) key;						\
-	k32[0] = (value);						\
-	*signature = pipeline_test_hash(key, NULL, 0, 0);			\
+	key = (struct test_table_key *) RTE_MBUF_METADATA_UINT8_PTR(	\
+			mbuf, APP_METADATA_OFFSET(32));			\
+	*key = (struct test_table_key) { .k32 = { (value) } };		\
+	*signature = pipeline_test_hash(key, NULL, 0, 0);		\
 } while (0)
 
 unsigned n_table_tests = RTE_DIM(table_tests);
@@ -41,6 +45,9 @@ static int
 test_table_hash_lru_generic(struct rte_table_ops *ops, uint32_t key_size);
 static int
 test_table_hash_ext_generic(struct rte_table_ops *ops, uint32_t key_size);
+static int
+test_table_hash_perf(const char *name, struct rte_table_ops *ops,
+	uint32_t key_size);
 
 struct rte_bucket_4_8 {
 	/* Cache line 0 */
@@ -678,10 +685,10 @@ test_table_hash_lru_generic(struct rte_table_ops *ops, uint32_t key_size)
 		return -7;
 
 	/* Add */
-	uint8_t key[32];
+	uint8_t key[64];
 	uint32_t *k32 = (uint32_t *) &key;
 
-	memset(key, 0, 32);
+	memset(key, 0, 64);
 	k32[0] = rte_be_to_cpu_32(0xadadadad);
 
 	table = ops->f_create(&hash_params, 0, 1);
@@ -788,10 +795,10 @@ test_table_hash_ext_generic(struct rte_table_ops *ops, uint32_t key_size)
 		return -7;
 
 	/* Add */
-	uint8_t key[32];
+	uint8_t key[64];
 	uint32_t *k32 = (uint32_t *) &key;
 
-	memset(key, 0, 32);
+	memset(key, 0, 64);
 	k32[0] = rte_be_to_cpu_32(0xadadadad);
 
 	table = ops->f_create(&hash_params, 0, 1);
@@ -838,6 +845,100 @@ test_table_hash_ext_generic(struct rte_table_ops *ops, uint32_t key_size)
 	return 0;
 }
 
+#define TEST_TABLE_HASH_PERF_N_KEYS			(1 << 12)
+#define TEST_TABLE_HASH_PERF_ITERATIONS			(1 << 16)
+
+/* Lookup performance of a hash table, every lookup burst is a full hit */
+static int
+test_table_hash_perf(const char *name, struct rte_table_ops *ops,
+	uint32_t key_size)
+{
+	struct rte_table_hash_params hash_params = {
+		.name = "TABLE_PERF",
+		.key_size = key_size,
+		.key_offset = APP_METADATA_OFFSET(32),
+		.key_mask = NULL,
+		.n_keys = TEST_TABLE_HASH_PERF_N_KEYS,
+		.n_buckets = TEST_TABLE_HASH_PERF_N_KEYS / 4,
+		.f_hash = pipeline_test_hash,
+		.seed = 0,
+	};
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	char *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t result_mask, sc_start, sc_end, j;
+	uint8_t key[64];
+	uint32_t *k32 = (uint32_t *) &key;
+	void *entry_ptr, *table;
+	int key_found, status, i;
+	char entry = 'A';
+
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table == NULL)
+		return -1;
+
+	memset(key, 0, 64);
+	for (i = 0; i < TEST_TABLE_HASH_PERF_N_KEYS; i++) {
+		k32[0] = rte_be_to_cpu_32(i);
+		status = ops->f_add(table, &key, &entry, &key_found,
+			&entry_ptr);
+		if (status != 0)
+			return -2;
+	}
+
+	/* Keys spread across the table, so the buckets are not all cached */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		PREPARE_PACKET(mbufs[i], rte_cpu_to_be_32((i * 61) %
+			TEST_TABLE_HASH_PERF_N_KEYS));
+
+	sc_start = rte_rdtsc();
+	for (j = 0; j < TEST_TABLE_HASH_PERF_ITERATIONS; j++) {
+		ops->f_lookup(table, mbufs, -1, &result_mask,
+			(void **)entries);
+		if (result_mask != UINT64_MAX)
+			return -3;
+	}
+	sc_end = rte_rdtsc();
+
+	printf("%s: %s table, %u-byte key: %lu cycles per lookup.\n",
+		__func__, name, key_size, (long unsigned int)
+		((sc_end - sc_start) / (TEST_TABLE_HASH_PERF_ITERATIONS *
+		RTE_PORT_IN_BURST_SIZE_MAX)));
+
+	/* Free resources */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		rte_pktmbuf_free(mbufs[i]);
+
+	ops->f_free(table);
+
+	return 0;
+}
+
+int
+test_table_hash_perf_all(void)
+{
+	int status;
+
+	status = test_table_hash_perf("key64_lru",
+		&rte_table_hash_key64_lru_ops, 64);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_perf("lru", &rte_table_hash_lru_ops, 64);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_perf("key64_ext",
+		&rte_table_hash_key64_ext_ops, 64);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_perf("ext", &rte_table_hash_ext_ops, 64);
+	if (status < 0)
+		return status;
+
+	return 0;
+}
+
 int
 test_table_hash_lru(void)
 {
@@ -861,6 +962,12 @@ test_table_hash_lru(void)
 	if (status < 0)
 		return status;
 
+	status = test_table_hash_lru_generic(
+		&rte_table_hash_key64_lru_ops,
+		64);
+	if (status < 0)
+		return status;
+
 	status = test_lru_update();
 	if (status < 0)
 		return status;
@@ -885,6 +992,10 @@ test_table_hash_ext(void)
 	if (status < 0)
 		return status;
 
+	status = test_table_hash_ext_generic(&rte_table_hash_key64_ext_ops, 64);
+	if (status < 0)
+		return status;
+
 	return 0;
 }
 
@@ -1052,3 +1163,320 @@ test_table_hash_cuckoo(void)
 	return 0;
 }
 
+static int
+test_table_array_lf(void)
+{
+	struct rte_table_array_params array_params = {
+		.n_entries = 16,
+		.offset = APP_METADATA_OFFSET(32),
+	};
+	struct rte_table_array_key array_key = {
+		.pos = 3,
+	};
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	char *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	char entry;
+	void *entry_ptr[3];
+	uint64_t result_mask;
+	int key_found, status, i;
+	void *table;
+
+	table = rte_table_array_lf_ops.f_create(&array_params, 0, 1);
+	if (table == NULL)
+		return -1;
+
+	/* Every update writes the copy of the entry not used by lookups */
+	entry = 'A';
+	status = rte_table_array_lf_ops.f_add(table, &array_key, &entry,
+		&key_found, &entry_ptr[0]);
+	if (status != 0)
+		return -2;
+
+	status = rte_table_array_lf_ops.f_reclaim(table);
+	if (status != 0)
+		return -2;
+
+	entry = 'B';
+	status = rte_table_array_lf_ops.f_add(table, &array_key, &entry,
+		&key_found, &entry_ptr[1]);
+	if ((status != 0) || (entry_ptr[1] == entry_ptr[0]) ||
+		(*(char *)entry_ptr[0] != 'A'))
+		return -3;
+
+	/* The old copy is pending reclaim */
+	entry = 'C';
+	status = rte_table_array_lf_ops.f_add(table, &array_key, &entry,
+		&key_found, &entry_ptr[2]);
+	if (status != -ENOSPC)
+		return -4;
+
+	status = rte_table_array_lf_ops.f_reclaim(table);
+	if (status != 0)
+		return -5;
+
+	status = rte_table_array_lf_ops.f_add(table, &array_key, &entry,
+		&key_found, &entry_ptr[2]);
+	if ((status != 0) || (entry_ptr[2] != entry_ptr[0]))
+		return -6;
+
+	/* Traffic flow */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		PREPARE_PACKET(mbufs[i], 3);
+
+	rte_table_array_lf_ops.f_lookup(table, mbufs, -1, &result_mask,
+		(void **)entries);
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		if (*entries[i] != 'C')
+			return -7;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		rte_pktmbuf_free(mbufs[i]);
+
+	rte_table_array_lf_ops.f_free(table);
+
+	return 0;
+}
+
+static int
+test_table_lpm_lf(void)
+{
+	struct rte_table_lpm_params lpm_params = {
+		.name = "LPM_LF",
+		.n_rules = 1 << 10,
+		.number_tbl8s = 1 << 8,
+		.flags = 0,
+		.entry_unique_size = 1,
+		.offset = APP_METADATA_OFFSET(32),
+	};
+	struct rte_table_lpm_key lpm_key = {
+		.ip = 0xadadadad,
+		.depth = 24,
+	};
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	char *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	char entry;
+	void *entry_ptr[4];
+	uint64_t result_mask;
+	int key_found, status, i;
+	void *table;
+
+	table = rte_table_lpm_lf_ops.f_create(&lpm_params, 0, 1);
+	if (table == NULL)
+		return -1;
+
+	entry = 'A';
+	status = rte_table_lpm_lf_ops.f_add(table, &lpm_key, &entry,
+		&key_found, &entry_ptr[0]);
+	if (status != 0)
+		return -2;
+
+	entry = 'B';
+	status = rte_table_lpm_lf_ops.f_add(table, &lpm_key, &entry,
+		&key_found, &entry_ptr[1]);
+	if ((status != 0) || (key_found == 0) ||
+		(entry_ptr[1] == entry_ptr[0]))
+		return -3;
+
+	/* Traffic flow */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		PREPARE_PACKET(mbufs[i], 0xadadadad);
+
+	rte_table_lpm_lf_ops.f_lookup(table, mbufs, -1, &result_mask,
+		(void **)entries);
+	if (result_mask != RTE_LEN2MASK(RTE_PORT_IN_BURST_SIZE_MAX, uint64_t))
+		return -4;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		if (*entries[i] != 'B')
+			return -5;
+
+	/* Both NHT entries are pending reclaim once the rule is deleted */
+	status = rte_table_lpm_lf_ops.f_delete(table, &lpm_key, &key_found,
+		NULL);
+	if ((status != 0) || (key_found == 0) ||
+		(*(char *)entry_ptr[0] != 'A') || (*(char *)entry_ptr[1] != 'B'))
+		return -6;
+
+	entry = 'C';
+	status = rte_table_lpm_lf_ops.f_add(table, &lpm_key, &entry,
+		&key_found, &entry_ptr[2]);
+	if ((status != 0) || (entry_ptr[2] == entry_ptr[0]) ||
+		(entry_ptr[2] == entry_ptr[1]))
+		return -7;
+
+	status = rte_table_lpm_lf_ops.f_reclaim(table);
+	if (status != 0)
+		return -8;
+
+	entry = 'D';
+	status = rte_table_lpm_lf_ops.f_add(table, &lpm_key, &entry,
+		&key_found, &entry_ptr[3]);
+	if ((status != 0) || (entry_ptr[3] != entry_ptr[0]))
+		return -9;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		rte_pktmbuf_free(mbufs[i]);
+
+	rte_table_lpm_lf_ops.f_free(table);
+
+	return 0;
+}
+
+#define TEST_TABLE_HASH_LF_N_KEYS 16
+
+static int
+test_table_hash_lf_generic(struct rte_table_ops *ops, int lru)
+{
+	struct rte_table_hash_params hash_params = {
+		.name = "TABLE_LF",
+		.key_size = 8,
+		.key_offset = APP_METADATA_OFFSET(32),
+		.key_mask = NULL,
+		.n_keys = TEST_TABLE_HASH_LF_N_KEYS,
+		.n_buckets = TEST_TABLE_HASH_LF_N_KEYS / 4,
+		.f_hash = pipeline_test_hash,
+		.seed = 0,
+	};
+	uint64_t keys[TEST_TABLE_HASH_LF_N_KEYS + 1];
+	void *key_ptrs[TEST_TABLE_HASH_LF_N_KEYS + 1];
+	char entry_data[TEST_TABLE_HASH_LF_N_KEYS + 1];
+	void *entry_data_ptrs[TEST_TABLE_HASH_LF_N_KEYS + 1];
+	int key_found[TEST_TABLE_HASH_LF_N_KEYS + 1];
+	void *entry_ptr[TEST_TABLE_HASH_LF_N_KEYS + 1];
+	void *old_entry_ptr[TEST_TABLE_HASH_LF_N_KEYS];
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	char *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t result_mask;
+	int status, i;
+	void *table;
+
+	for (i = 0; i <= TEST_TABLE_HASH_LF_N_KEYS; i++) {
+		uint32_t *k32 = (uint32_t *) &keys[i];
+
+		keys[i] = 0;
+		k32[0] = rte_cpu_to_be_32(i);
+		key_ptrs[i] = &keys[i];
+		entry_data[i] = 'a' + i;
+		entry_data_ptrs[i] = &entry_data[i];
+	}
+
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table == NULL)
+		return -1;
+
+	/* Fill the table */
+	status = ops->f_add_bulk(table, key_ptrs, entry_data_ptrs,
+		TEST_TABLE_HASH_LF_N_KEYS, key_found, entry_ptr);
+	if (status != 0)
+		return -2;
+
+	for (i = 0; i < TEST_TABLE_HASH_LF_N_KEYS; i++)
+		old_entry_ptr[i] = entry_ptr[i];
+
+	if (lru == 0) {
+		status = ops->f_add(table, key_ptrs[TEST_TABLE_HASH_LF_N_KEYS],
+			entry_data_ptrs[TEST_TABLE_HASH_LF_N_KEYS],
+			&key_found[0], &entry_ptr[0]);
+		if (status != -ENOSPC)
+			return -3;
+	}
+
+	/* Update every key: new copies, the old ones are left untouched */
+	for (i = 0; i < TEST_TABLE_HASH_LF_N_KEYS; i++)
+		entry_data[i] = 'A' + i;
+
+	status = ops->f_add_bulk(table, key_ptrs, entry_data_ptrs,
+		TEST_TABLE_HASH_LF_N_KEYS, key_found, entry_ptr);
+	if (status != 0)
+		return -4;
+
+	for (i = 0; i < TEST_TABLE_HASH_LF_N_KEYS; i++)
+		if ((key_found[i] == 0) ||
+			(entry_ptr[i] == old_entry_ptr[i]) ||
+			(*(char *)old_entry_ptr[i] != 'a' + i))
+			return -5;
+
+	/* No free key until the old copies are reclaimed */
+	key_found[0] = -1;
+	status = ops->f_add(table, key_ptrs[0], entry_data_ptrs[0],
+		&key_found[0], &entry_ptr[0]);
+	if ((status != -ENOSPC) || (key_found[0] != -1))
+		return -6;
+
+	status = ops->f_reclaim(table);
+	if (status != 0)
+		return -7;
+
+	status = ops->f_add(table, key_ptrs[0], entry_data_ptrs[0],
+		&key_found[0], &entry_ptr[0]);
+	if (status != 0)
+		return -8;
+
+	/* Delete */
+	status = ops->f_delete_bulk(table, &key_ptrs[1], 1, &key_found[1],
+		NULL);
+	if ((status != 0) || (key_found[1] == 0) ||
+		(*(char *)entry_ptr[1] != 'B'))
+		return -9;
+
+	/* Traffic flow */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		PREPARE_PACKET(mbufs[i],
+			rte_cpu_to_be_32(i % TEST_TABLE_HASH_LF_N_KEYS));
+
+	ops->f_lookup(table, mbufs, -1, &result_mask, (void **)entries);
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+		int k = i % TEST_TABLE_HASH_LF_N_KEYS;
+
+		if (k == 1) {
+			if (result_mask & (1LLU << i))
+				return -10;
+			continue;
+		}
+
+		if (((result_mask & (1LLU << i)) == 0) ||
+			(*entries[i] != 'A' + k))
+			return -11;
+	}
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		rte_pktmbuf_free(mbufs[i]);
+
+	ops->f_free(table);
+
+	return 0;
+}
+
+int
+test_table_lock_free(void)
+{
+	int status;
+
+	status = test_table_array_lf();
+	if (status < 0)
+		return status;
+
+	status = test_table_lpm_lf();
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_lf_generic(&rte_table_hash_ext_lf_ops, 0);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_lf_generic(&rte_table_hash_lru_lf_ops, 1);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_ext_generic(&rte_table_hash_ext_lf_ops, 8);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_lru_generic(&rte_table_hash_lru_lf_ops, 8);
+	if (status < 0)
+		return status;
+
+	return 0;
+}